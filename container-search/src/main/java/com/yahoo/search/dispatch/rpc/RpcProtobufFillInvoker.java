@@ -25,6 +25,7 @@ import com.yahoo.slime.BinaryFormat;
 import java.util.Iterator;
 import java.util.List;
 import java.util.Map;
+import java.util.Optional;
 import java.util.concurrent.BlockingQueue;
 import java.util.concurrent.LinkedBlockingQueue;
 import java.util.concurrent.TimeUnit;
@@ -129,7 +130,7 @@ public class RpcProtobufFillInvoker extends FillInvoker {
 
         Query query = result.getQuery();
         double timeoutSeconds = ((double) query.getTimeLeft() - 3.0) / 1000.0;
-        Compressor.Compression compressionResult = resourcePool.compressor().compress(compression, payload);
+        Compressor.Compression compressionResult = resourcePool.compressor().compress(compression, payload, Optional.empty());
         resourcePool.client().request(RPC_METHOD, node, compressionResult.type(), payload.length, compressionResult.data(),
                 roe -> receive(roe, hits), timeoutSeconds);
     }
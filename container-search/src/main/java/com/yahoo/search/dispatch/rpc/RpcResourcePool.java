@@ -16,7 +16,10 @@ import java.util.Map;
  * @author ollivir
  */
 public class RpcResourcePool {
-    /** The compression method which will be used with rpc dispatch. "lz4" (default) and "none" is supported. */
+    /**
+     * The compression method which will be used with rpc dispatch. "lz4" (default) and "none" is supported.
+     * "framed_lz4" sends protobuf requests as lz4 frames, which also asks the content nodes to frame their replies.
+     */
     public final static CompoundName dispatchCompression = new CompoundName("dispatch.compression");
 
     private final Compressor compressor = new Compressor();
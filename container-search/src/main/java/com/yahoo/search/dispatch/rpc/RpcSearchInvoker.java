@@ -60,7 +60,7 @@ public class RpcSearchInvoker extends SearchInvoker implements Client.ResponseRe
 
         var payload = ProtobufSerialization.serializeSearchRequest(query, searcher.getServerId());
         double timeoutSeconds = ((double) query.getTimeLeft() - 3.0) / 1000.0;
-        Compressor.Compression compressionResult = resourcePool.compressor().compress(compression, payload);
+        Compressor.Compression compressionResult = resourcePool.compressor().compress(compression, payload, Optional.empty());
         resourcePool.client().request(RPC_METHOD, nodeConnection, compressionResult.type(), payload.length, compressionResult.data(), this,
                 timeoutSeconds);
     }
@@ -50,6 +50,25 @@ public class RpcSearchInvokerTest {
         assertThat(request.getQueryTreeBlob().size(), greaterThan(0));
     }
 
+    @Test
+    public void testFramedLz4IsSentWhenRequested() throws IOException {
+        var compressionTypeHolder = new AtomicReference<CompressionType>();
+        var payloadHolder = new AtomicReference<byte[]>();
+        var lengthHolder = new AtomicInteger();
+        var mockClient = parameterCollectorClient(compressionTypeHolder, payloadHolder, lengthHolder);
+        var mockPool = new RpcResourcePool(mockClient, ImmutableMap.of(7, () -> {}));
+        @SuppressWarnings("resource")
+        var invoker = new RpcSearchInvoker(mockSearcher(), new Node(7, "seven", 77, 1), mockPool);
+
+        Query q = new Query("search/?query=test&hits=10&dispatch.compression=framed_lz4");
+        invoker.sendSearchRequest(q, null);
+
+        assertThat(compressionTypeHolder.get(), equalTo(CompressionType.FRAMED_LZ4));
+        var bytes = mockPool.compressor().decompress(payloadHolder.get(), compressionTypeHolder.get(), lengthHolder.get());
+        var request = SearchProtocol.SearchRequest.newBuilder().mergeFrom(bytes).build();
+        assertThat(request.getHits(), equalTo(10));
+    }
+
     private Client parameterCollectorClient(AtomicReference<CompressionType> compressionTypeHolder, AtomicReference<byte[]> payloadHolder,
             AtomicInteger lengthHolder) {
         return new Client() {
@@ -21,6 +21,7 @@ struct FieldSetTest : public CppUnit::TestFixture {
     void testParsing();
     void testContains();
     void testCopyDocumentFields();
+    void testCopyRawFields();
     void testDocumentSubsetCopy();
     void testStripFields();
     void testSerialize();
@@ -30,6 +31,7 @@ struct FieldSetTest : public CppUnit::TestFixture {
     CPPUNIT_TEST(testSerialize);
     CPPUNIT_TEST(testContains);
     CPPUNIT_TEST(testCopyDocumentFields);
+    CPPUNIT_TEST(testCopyRawFields);
     CPPUNIT_TEST(testDocumentSubsetCopy);
     CPPUNIT_TEST(testStripFields);
     CPPUNIT_TEST_SUITE_END();
@@ -251,6 +253,39 @@ FieldSetTest::testCopyDocumentFields()
     }
 }
 
+void
+FieldSetTest::testCopyRawFields()
+{
+    TestDocMan testDocMan;
+    const DocumentTypeRepo& repo = testDocMan.getTypeRepo();
+    Document::UP src(createTestDocument(testDocMan));
+    nbostream stream;
+    src->serialize(stream);
+    Document deserialized(repo, stream);
+
+    {
+        Document dest(src->getType(), DocumentId("doc:test:fieldsdest"));
+        CPPUNIT_ASSERT(dest.getFields().copyRawField(deserialized.getFields(),
+                                                     dest.getField("hstringval")));
+        CPPUNIT_ASSERT(!dest.getFields().copyRawField(deserialized.getFields(),
+                                                      dest.getField("title")));
+        CPPUNIT_ASSERT_EQUAL(std::string("hstringval: hello fantastic world\n"),
+                             stringifyFields(dest));
+    }
+
+    const char* fieldSets[] = {
+        "[all]",
+        "[none]",
+        "[header]",
+        "[body]",
+        "testdoctype1:hstringval,content"
+    };
+    for (size_t i = 0; i < sizeof(fieldSets) / sizeof(fieldSets[0]); ++i) {
+        CPPUNIT_ASSERT_EQUAL(doCopyFields(*src, repo, fieldSets[i]),
+                             doCopyFields(deserialized, repo, fieldSets[i]));
+    }
+}
+
 std::string
 FieldSetTest::doCopyDocument(const Document& src,
                              const DocumentTypeRepo& docRepo,
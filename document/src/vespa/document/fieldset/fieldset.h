@@ -49,8 +49,9 @@ public:
      * Copy all fields from src into dest that are contained within the
      * given field set. If any copied field pre-exists in dest, it will
      * be overwritten.
-     * NOTE: causes each field to be explicitly copied so thus not very
-     * efficient. Prefer using stripFields for cases where a document
+     * NOTE: fields are copied in serialized form when possible, but a
+     * field serialized with an older version must be deserialized and
+     * serialized again. Prefer using stripFields for cases where a document
      * needs to only contain fields matching a given field set and can
      * readily be modified in-place.
      */
@@ -141,7 +141,9 @@ FieldSet::copyFields(Document& dest,
         if (!fields.contains(f)) {
             continue;
         }
-        dest.setValue(f, *src.getValue(f));
+        if (!dest.getFields().copyRawField(src.getFields(), f)) {
+            dest.setValue(f, *src.getValue(f));
+        }
     }
 }
 
@@ -268,6 +268,28 @@ StructFieldValue::setFieldValue(const Field& field, FieldValue::UP value)
     _hasChanged = true;
 }
 
+bool
+StructFieldValue::copyRawField(const StructFieldValue &src, const Field &field)
+{
+    if ((src._version != Document::getNewestSerializationVersion()) ||
+        (src.getStructType().getId() != getStructType().getId()))
+    {
+        return false;
+    }
+    vespalib::ConstBufferRef buf = src.getRawField(field.getId());
+    if (buf.size() == 0) {
+        return false;
+    }
+    if (_chunks.empty()) {
+        _chunks.push_back(SerializableArray::UP(new SerializableArray()));
+    }
+
+    _chunks.back().set(field.getId(), buf.c_str(), buf.size());
+
+    _hasChanged = true;
+    return true;
+}
+
 void
 StructFieldValue::removeFieldValue(const Field& field)
 {
@@ -80,6 +80,15 @@ public:
     void getRawFieldIds(std::vector<int> &raw_ids) const;
     void getRawFieldIds(std::vector<int> &raw_ids, const FieldSet& fieldSet) const;
 
+    /**
+     * Copies the serialized value of the given field from another struct of
+     * the same type, without deserializing it. Returns false if the field is
+     * not set in src, or if it was serialized with an older version than
+     * setting the value would use, in which case the value must be copied
+     * explicitly.
+     */
+    bool copyRawField(const StructFieldValue &src, const Field &field);
+
     void accept(FieldValueVisitor &visitor) override { visitor.visit(*this); }
     void accept(ConstFieldValueVisitor &visitor) const override { visitor.visit(*this); }
 
@@ -3,6 +3,7 @@
 #include <vespa/eval/eval/llvm/compile_cache.h>
 #include <vespa/eval/eval/key_gen.h>
 #include <vespa/eval/eval/test/eval_spec.h>
+#include <vespa/vespalib/io/fileutil.h>
 #include <set>
 
 using namespace vespalib::eval;
@@ -146,4 +147,67 @@ TEST("require that cache usage works") {
 
 //-----------------------------------------------------------------------------
 
+struct DiskCacheFixture {
+    vespalib::string dir;
+    DiskCacheFixture() : dir("disk_cache_test_dir") {
+        vespalib::rmdir(dir, true);
+        CompileCache::attach_disk_cache(dir);
+    }
+    ~DiskCacheFixture() {
+        CompileCache::detach_disk_cache();
+        vespalib::rmdir(dir, true);
+    }
+};
+
+TEST_F("require that compiled functions are stored in and loaded from disk cache", DiskCacheFixture()) {
+    CompileCache::Token::UP token_a = CompileCache::compile(Function::parse("x+y+1"), PassParams::SEPARATE);
+    EXPECT_EQUAL(6.0, token_a->get().get_function<2>()(2.0, 3.0));
+    auto stats = CompileCache::disk_cache_stats();
+    EXPECT_EQUAL(1u, stats.num_compiled);
+    EXPECT_EQUAL(1u, stats.num_stored);
+    EXPECT_EQUAL(0u, stats.num_loaded);
+    token_a.reset();
+    TEST_DO(verify_cache(0, 0));
+    CompileCache::Token::UP token_b = CompileCache::compile(Function::parse("x+y+1"), PassParams::SEPARATE);
+    EXPECT_EQUAL(6.0, token_b->get().get_function<2>()(2.0, 3.0));
+    stats = CompileCache::disk_cache_stats();
+    EXPECT_EQUAL(1u, stats.num_compiled);
+    EXPECT_EQUAL(1u, stats.num_loaded);
+    EXPECT_EQUAL(0u, stats.num_failed);
+}
+
+TEST_F("require that different functions use different disk cache entries", DiskCacheFixture()) {
+    CompileCache::Token::UP token_a = CompileCache::compile(Function::parse("x+y"), PassParams::SEPARATE);
+    CompileCache::Token::UP token_b = CompileCache::compile(Function::parse("x*y"), PassParams::SEPARATE);
+    EXPECT_EQUAL(5.0, token_a->get().get_function<2>()(2.0, 3.0));
+    EXPECT_EQUAL(6.0, token_b->get().get_function<2>()(2.0, 3.0));
+    auto stats = CompileCache::disk_cache_stats();
+    EXPECT_EQUAL(2u, stats.num_compiled);
+    EXPECT_EQUAL(2u, stats.num_stored);
+    EXPECT_EQUAL(0u, stats.num_loaded);
+}
+
+TEST_F("require that functions with plugin state are linked against their own state when loaded from disk cache", DiskCacheFixture()) {
+    CompileCache::Token::UP token_a = CompileCache::compile(Function::parse("a in [1,2,3,4,5,6,7,8,9]"), PassParams::SEPARATE);
+    EXPECT_EQUAL(1.0, token_a->get().get_function<1>()(5.0));
+    EXPECT_EQUAL(0.0, token_a->get().get_function<1>()(15.0));
+    CompileCache::Token::UP token_b = CompileCache::compile(Function::parse("a in [11,12,13,14,15,16,17,18,19]"), PassParams::SEPARATE);
+    EXPECT_EQUAL(0.0, token_b->get().get_function<1>()(5.0));
+    EXPECT_EQUAL(1.0, token_b->get().get_function<1>()(15.0));
+    EXPECT_EQUAL(1.0, token_a->get().get_function<1>()(5.0));
+    auto stats = CompileCache::disk_cache_stats();
+    EXPECT_EQUAL(1u, stats.num_compiled);
+    EXPECT_EQUAL(1u, stats.num_stored);
+    EXPECT_EQUAL(1u, stats.num_loaded);
+}
+
+TEST("require that disk cache stats are empty when no disk cache is attached") {
+    CompileCache::Token::UP token_a = CompileCache::compile(Function::parse("x+y"), PassParams::SEPARATE);
+    auto stats = CompileCache::disk_cache_stats();
+    EXPECT_EQUAL(0u, stats.num_compiled);
+    EXPECT_EQUAL(0u, stats.num_loaded);
+}
+
+//-----------------------------------------------------------------------------
+
 TEST_MAIN() { TEST_RUN_ALL(); }
@@ -0,0 +1,109 @@
+// Copyright 2019 Oath Inc. Licensed under the terms of the Apache 2.0 license. See LICENSE in the project root.
+
+#include <vespa/vespalib/testkit/test_kit.h>
+#include <vespa/eval/eval/operation.h>
+#include <vespa/eval/eval/tensor_spec.h>
+#include <vespa/eval/tensor/default_tensor_engine.h>
+#include <vespa/eval/tensor/sparse/sparse_tensor.h>
+#include <vespa/eval/tensor/sparse/sparse_tensor_interned_cells.h>
+#include <vespa/eval/tensor/sparse/sparse_tensor_join_plan.h>
+#include <vespa/vespalib/test/insertion_operators.h>
+
+using namespace vespalib::tensor;
+using namespace vespalib::tensor::sparse;
+using vespalib::eval::TensorSpec;
+using vespalib::eval::ValueType;
+using vespalib::eval::Value;
+using vespalib::eval::operation::Add;
+using vespalib::eval::operation::Mul;
+
+Value::UP make_tensor(const TensorSpec &spec) {
+    return DefaultTensorEngine::ref().from_spec(spec);
+}
+
+const SparseTensor &as_sparse(const Value &value) {
+    return dynamic_cast<const SparseTensor &>(*value.as_tensor());
+}
+
+TensorSpec to_spec(const Tensor &tensor) {
+    return tensor.toSpec();
+}
+
+TEST("require that labels are interned to dense ids") {
+    SparseTensorLabelInterner interner;
+    EXPECT_EQUAL(0u, interner.intern("foo"));
+    EXPECT_EQUAL(1u, interner.intern("bar"));
+    EXPECT_EQUAL(0u, interner.intern("foo"));
+    EXPECT_EQUAL(2u, interner.intern(""));
+    EXPECT_EQUAL(3u, interner.size());
+    EXPECT_EQUAL("bar", interner.label(1));
+}
+
+TEST("require that join plan finds overlapping and output dimensions") {
+    JoinPlan plan(ValueType::from_spec("tensor(a{},c{})"), ValueType::from_spec("tensor(b{},c{},d{})"));
+    EXPECT_EQUAL(std::vector<uint32_t>({1}), plan.lhsOverlap);
+    EXPECT_EQUAL(std::vector<uint32_t>({1}), plan.rhsOverlap);
+    ASSERT_EQUAL(4u, plan.output.size());
+    EXPECT_TRUE(plan.output[0].fromLhs);
+    EXPECT_EQUAL(0u, plan.output[0].dim);
+    EXPECT_FALSE(plan.output[1].fromLhs);
+    EXPECT_EQUAL(0u, plan.output[1].dim);
+    EXPECT_TRUE(plan.output[2].fromLhs);
+    EXPECT_EQUAL(1u, plan.output[2].dim);
+    EXPECT_FALSE(plan.output[3].fromLhs);
+    EXPECT_EQUAL(2u, plan.output[3].dim);
+}
+
+TEST("require that interned index groups cells on key dimensions") {
+    auto value = make_tensor(TensorSpec("tensor(x{},y{})")
+                             .add({{"x","1"},{"y","a"}}, 1)
+                             .add({{"x","2"},{"y","a"}}, 2)
+                             .add({{"x","1"},{"y","b"}}, 3));
+    SparseTensorLabelInterner interner;
+    SparseTensorInternedCells cells(as_sparse(*value), interner);
+    EXPECT_EQUAL(3u, cells.size());
+    EXPECT_EQUAL(2u, cells.numDims());
+    SparseTensorInternedIndex index(cells, {1});
+    EXPECT_EQUAL(2u, index.numGroups());
+    uint32_t probe[] = { interner.intern("ignored"), interner.intern("a") };
+    uint32_t group = index.findGroup(probe, {1});
+    ASSERT_NOT_EQUAL(SparseTensorInternedIndex::npos, group);
+    double sum = 0.0;
+    for (uint32_t cell = index.first(group); cell != SparseTensorInternedIndex::npos; cell = index.next(cell)) {
+        sum += cells.value(cell);
+    }
+    EXPECT_EQUAL(3.0, sum);
+    uint32_t missing[] = { interner.intern("c") };
+    EXPECT_EQUAL(SparseTensorInternedIndex::npos, index.findGroup(missing, {0}));
+}
+
+TEST("require that join on overlapping dimensions matches cells by label") {
+    auto lhs = make_tensor(TensorSpec("tensor(x{},y{})")
+                           .add({{"x","1"},{"y","a"}}, 2)
+                           .add({{"x","2"},{"y","b"}}, 3)
+                           .add({{"x","3"},{"y","c"}}, 5));
+    auto rhs = make_tensor(TensorSpec("tensor(y{},z{})")
+                           .add({{"y","a"},{"z","1"}}, 7)
+                           .add({{"y","a"},{"z","2"}}, 11)
+                           .add({{"y","b"},{"z","1"}}, 13));
+    auto result = as_sparse(*lhs).join(Mul::f, as_sparse(*rhs));
+    auto expect = TensorSpec("tensor(x{},y{},z{})")
+                  .add({{"x","1"},{"y","a"},{"z","1"}}, 14)
+                  .add({{"x","1"},{"y","a"},{"z","2"}}, 22)
+                  .add({{"x","2"},{"y","b"},{"z","1"}}, 39);
+    EXPECT_EQUAL(expect, to_spec(*result));
+}
+
+TEST("require that reduce aggregates cells sharing kept labels") {
+    auto value = make_tensor(TensorSpec("tensor(x{},y{})")
+                             .add({{"x","1"},{"y","a"}}, 1)
+                             .add({{"x","2"},{"y","a"}}, 2)
+                             .add({{"x","1"},{"y","b"}}, 3));
+    auto result = as_sparse(*value).reduce(Add::f, {"x"});
+    auto expect = TensorSpec("tensor(y{})")
+                  .add({{"y","a"}}, 3)
+                  .add({{"y","b"}}, 3);
+    EXPECT_EQUAL(expect, to_spec(*result));
+}
+
+TEST_MAIN() { TEST_RUN_ALL(); }
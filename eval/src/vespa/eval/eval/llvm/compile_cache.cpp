@@ -47,6 +47,25 @@ CompileCache::count_refs()
     return refs;
 }
 
+void
+CompileCache::attach_disk_cache(const vespalib::string &dir)
+{
+    LLVMWrapper::set_object_cache(std::make_shared<DiskObjectCache>(dir));
+}
+
+void
+CompileCache::detach_disk_cache()
+{
+    LLVMWrapper::set_object_cache(std::shared_ptr<DiskObjectCache>());
+}
+
+DiskObjectCache::Stats
+CompileCache::disk_cache_stats()
+{
+    auto cache = LLVMWrapper::get_object_cache();
+    return cache ? cache->get_stats() : DiskObjectCache::Stats();
+}
+
 void
 CompileCache::do_compile(CompileContext &ctx) {
     vespalib::string key = gen_key(ctx.function, ctx.pass_params);
@@ -48,6 +48,15 @@ public:
     static size_t num_cached();
     static size_t count_refs();
 
+    /**
+     * Keep generated machine code in the given directory, making it
+     * possible to load (rather than compile) functions that were
+     * compiled by an earlier process on the same kind of host.
+     **/
+    static void attach_disk_cache(const vespalib::string &dir);
+    static void detach_disk_cache();
+    static DiskObjectCache::Stats disk_cache_stats();
+
 private:
     struct CompileContext {
         const Function &function;
@@ -0,0 +1,170 @@
+// Copyright 2019 Oath Inc. Licensed under the terms of the Apache 2.0 license. See LICENSE in the project root.
+
+#include "disk_object_cache.h"
+#include <vespa/vespalib/io/fileutil.h>
+#include <vespa/vespalib/util/stringfmt.h>
+#include <llvm/ADT/StringMap.h>
+#include <llvm/Config/llvm-config.h>
+#include <llvm/IR/Module.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/Host.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include <llvm/Support/SHA1.h>
+#include <llvm/Support/raw_ostream.h>
+#include <algorithm>
+#include <cstdio>
+#include <unistd.h>
+
+#include <vespa/log/log.h>
+LOG_SETUP(".eval.eval.llvm.disk_object_cache");
+
+namespace vespalib::eval {
+
+namespace {
+
+template <typename HASH>
+vespalib::string sha1_hex(const HASH &hash) {
+    vespalib::string hex;
+    for (uint8_t byte: hash) {
+        hex.append(make_string("%02x", byte));
+    }
+    return hex;
+}
+
+vespalib::string make_host_signature() {
+    std::string features_str;
+    llvm::StringMap<bool> features;
+    if (llvm::sys::getHostCPUFeatures(features)) {
+        std::vector<std::string> enabled;
+        for (const auto &feature: features) {
+            if (feature.getValue()) {
+                enabled.push_back(feature.getKey().str());
+            }
+        }
+        std::sort(enabled.begin(), enabled.end());
+        for (const auto &feature: enabled) {
+            features_str += "+" + feature;
+        }
+    }
+    llvm::SHA1 hasher;
+    hasher.update(LLVM_VERSION_STRING);
+    hasher.update(llvm::sys::getHostCPUName());
+    hasher.update(features_str);
+    return sha1_hex(hasher.final()).substr(0, 16);
+}
+
+} // namespace vespalib::eval::<unnamed>
+
+const vespalib::string DiskObjectCache::key_prefix("vespa-eval-");
+
+bool
+DiskObjectCache::is_cache_key(const vespalib::string &module_id) const
+{
+    return (module_id.size() > key_prefix.size()) &&
+        (module_id.substr(0, key_prefix.size()) == key_prefix);
+}
+
+vespalib::string
+DiskObjectCache::file_name(const vespalib::string &key) const
+{
+    return _dir + "/" + key + ".o";
+}
+
+DiskObjectCache::DiskObjectCache(const vespalib::string &dir)
+    : _dir(dir),
+      _host_signature(make_host_signature()),
+      _lock(),
+      _stats(),
+      _last_was_loaded(false)
+{
+    vespalib::mkdir(_dir, true);
+}
+
+DiskObjectCache::~DiskObjectCache() = default;
+
+vespalib::string
+DiskObjectCache::make_key(const llvm::Module &module) const
+{
+    std::string ir;
+    llvm::raw_string_ostream ir_stream(ir);
+    module.print(ir_stream, nullptr);
+    ir_stream.flush();
+    llvm::SHA1 hasher;
+    hasher.update(ir);
+    return key_prefix + _host_signature + "-" + sha1_hex(hasher.final());
+}
+
+void
+DiskObjectCache::notifyObjectCompiled(const llvm::Module *module, llvm::MemoryBufferRef obj)
+{
+    vespalib::string key = module->getModuleIdentifier();
+    if (!is_cache_key(key)) {
+        return;
+    }
+    vespalib::string name = file_name(key);
+    vespalib::string tmp_name = make_string("%s.%d.tmp", name.c_str(), getpid());
+    bool ok = false;
+    {
+        std::error_code error;
+        llvm::raw_fd_ostream out(tmp_name.c_str(), error, llvm::sys::fs::F_None);
+        if (!error) {
+            out << obj.getBuffer();
+            out.close();
+            ok = !out.has_error();
+            if (!ok) {
+                out.clear_error();
+            }
+        }
+    }
+    if (ok) {
+        ok = (std::rename(tmp_name.c_str(), name.c_str()) == 0);
+    }
+    std::lock_guard<std::mutex> guard(_lock);
+    if (ok) {
+        ++_stats.num_stored;
+    } else {
+        std::remove(tmp_name.c_str());
+        ++_stats.num_failed;
+        LOG(warning, "Failed to store compiled object in '%s'", name.c_str());
+    }
+}
+
+std::unique_ptr<llvm::MemoryBuffer>
+DiskObjectCache::getObject(const llvm::Module *module)
+{
+    vespalib::string key = module->getModuleIdentifier();
+    if (!is_cache_key(key)) {
+        return std::unique_ptr<llvm::MemoryBuffer>();
+    }
+    auto buffer = llvm::MemoryBuffer::getFile(file_name(key).c_str());
+    std::lock_guard<std::mutex> guard(_lock);
+    _last_was_loaded = bool(buffer);
+    if (!buffer) {
+        ++_stats.num_compiled;
+        return std::unique_ptr<llvm::MemoryBuffer>();
+    }
+    ++_stats.num_loaded;
+    // MCJIT takes ownership of the returned buffer; hand it a copy
+    // that is not backed by a mapping of a file that may be replaced.
+    return llvm::MemoryBuffer::getMemBufferCopy((*buffer)->getBuffer(), (*buffer)->getBufferIdentifier());
+}
+
+void
+DiskObjectCache::report_time(double seconds)
+{
+    std::lock_guard<std::mutex> guard(_lock);
+    if (_last_was_loaded) {
+        _stats.load_time_s += seconds;
+    } else {
+        _stats.compile_time_s += seconds;
+    }
+}
+
+DiskObjectCache::Stats
+DiskObjectCache::get_stats() const
+{
+    std::lock_guard<std::mutex> guard(_lock);
+    return _stats;
+}
+
+}
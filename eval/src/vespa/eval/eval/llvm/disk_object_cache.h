@@ -0,0 +1,76 @@
+// Copyright 2019 Oath Inc. Licensed under the terms of the Apache 2.0 license. See LICENSE in the project root.
+
+#pragma once
+
+#include <vespa/vespalib/stllike/string.h>
+#include <llvm/ExecutionEngine/ObjectCache.h>
+#include <mutex>
+
+namespace vespalib::eval {
+
+/**
+ * Counters and timings tracked by the DiskObjectCache.
+ **/
+struct DiskObjectCacheStats {
+    size_t num_loaded;
+    size_t num_compiled;
+    size_t num_stored;
+    size_t num_failed;
+    double load_time_s;
+    double compile_time_s;
+    DiskObjectCacheStats() : num_loaded(0), num_compiled(0), num_stored(0), num_failed(0),
+                             load_time_s(0.0), compile_time_s(0.0) {}
+};
+
+/**
+ * Persistent cache of machine code generated by LLVM. Object files
+ * are stored in a directory, named by a key derived from the IR of
+ * the compiled module, the LLVM version and the features of the host
+ * CPU. This lets a restarted process load previously generated code
+ * instead of running code generation again.
+ *
+ * Only modules without embedded process-local addresses may be
+ * cached; the LLVMWrapper is responsible for not tagging other
+ * modules with a cache key.
+ **/
+class DiskObjectCache : public llvm::ObjectCache
+{
+public:
+    using Stats = DiskObjectCacheStats;
+
+private:
+    static const vespalib::string key_prefix;
+
+    vespalib::string   _dir;
+    vespalib::string   _host_signature;
+    mutable std::mutex _lock;
+    Stats              _stats;
+    bool               _last_was_loaded;
+
+    bool is_cache_key(const vespalib::string &module_id) const;
+    vespalib::string file_name(const vespalib::string &key) const;
+
+public:
+    explicit DiskObjectCache(const vespalib::string &dir);
+    ~DiskObjectCache() override;
+
+    const vespalib::string &dir() const { return _dir; }
+
+    /**
+     * Create the cache key for a module. The key is to be used as
+     * the module identifier of the module before it is compiled.
+     **/
+    vespalib::string make_key(const llvm::Module &module) const;
+
+    void notifyObjectCompiled(const llvm::Module *module, llvm::MemoryBufferRef obj) override;
+    std::unique_ptr<llvm::MemoryBuffer> getObject(const llvm::Module *module) override;
+
+    /**
+     * Called after a cached module has been made executable to
+     * account for the time spent either loading or compiling it.
+     **/
+    void report_time(double seconds);
+    Stats get_stats() const;
+};
+
+}
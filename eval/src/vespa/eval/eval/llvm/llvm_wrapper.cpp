@@ -17,6 +17,7 @@
 #include <vespa/eval/eval/check_type.h>
 #include <vespa/vespalib/stllike/hash_set.h>
 #include <vespa/vespalib/util/approx.h>
+#include <chrono>
 
 double vespalib_eval_ldexp(double a, double b) { return std::ldexp(a, b); }
 double vespalib_eval_min(double a, double b) { return std::min(a, b); }
@@ -82,6 +83,7 @@ struct FunctionBuilder : public NodeVisitor, public NodeTraverser {
     const gbdt::Optimize::Chain &forest_optimizers;
     std::vector<gbdt::Forest::UP> &forests;
     std::vector<PluginState::UP> &plugin_state;
+    std::vector<InjectedSymbol> &injected;
 
     llvm::FunctionType *make_call_1_fun_t() {
         std::vector<llvm::Type*> param_types;
@@ -138,7 +140,8 @@ struct FunctionBuilder : public NodeVisitor, public NodeTraverser {
                     PassParams pass_params_in,
                     const gbdt::Optimize::Chain &forest_optimizers_in,
                     std::vector<gbdt::Forest::UP> &forests_out,
-                    std::vector<PluginState::UP> &plugin_state_out)
+                    std::vector<PluginState::UP> &plugin_state_out,
+                    std::vector<InjectedSymbol> &injected_out)
         : context(context_in),
           module(module_in),
           builder(context),
@@ -151,7 +154,8 @@ struct FunctionBuilder : public NodeVisitor, public NodeTraverser {
           forest_end(nullptr),
           forest_optimizers(forest_optimizers_in),
           forests(forests_out),
-          plugin_state(plugin_state_out)
+          plugin_state(plugin_state_out),
+          injected(injected_out)
     {
         std::vector<llvm::Type*> param_types;
         if (pass_params == PassParams::SEPARATE) {
@@ -227,6 +231,19 @@ struct FunctionBuilder : public NodeVisitor, public NodeTraverser {
 
     //-------------------------------------------------------------------------
 
+    // Process-local addresses are referenced through external symbols
+    // that are bound to the actual address when the module is linked.
+    // This keeps them out of the generated code, making it possible
+    // to reuse the code from the object cache.
+    llvm::Value *inject(void *addr, llvm::PointerType *type) {
+        vespalib::string name = vespalib::make_string("vespalib_eval_inject_%zu", injected.size());
+        injected.emplace_back(name, addr);
+        llvm::Constant *symbol = module.getOrInsertGlobal(name.c_str(), builder.getInt8Ty());
+        return builder.CreatePointerCast(symbol, type, "inject");
+    }
+
+    //-------------------------------------------------------------------------
+
     bool try_optimize_forest(const Node &item) {
         auto trees = gbdt::extract_trees(item);
         gbdt::ForestStats stats(trees);
@@ -238,14 +255,14 @@ struct FunctionBuilder : public NodeVisitor, public NodeTraverser {
         void *eval_ptr = (void *) optimize_result.eval;
         gbdt::Forest *forest = forests.back().get();
         llvm::PointerType *eval_funptr_t = make_eval_forest_funptr_t();
-        llvm::Value *eval_fun = builder.CreateIntToPtr(builder.getInt64((uint64_t)eval_ptr), eval_funptr_t, "inject_eval");
-        llvm::Value *ctx = builder.CreateIntToPtr(builder.getInt64((uint64_t)forest), builder.getVoidTy()->getPointerTo(), "inject_ctx");
+        llvm::Value *eval_fun = inject(eval_ptr, eval_funptr_t);
+        llvm::Value *ctx = inject(forest, builder.getVoidTy()->getPointerTo());
         if (pass_params == PassParams::ARRAY) {
 	    push(builder.CreateCall(eval_fun, {ctx, params[0]}, "call_eval"));
         } else {
             assert(pass_params == PassParams::LAZY);
             llvm::PointerType *proxy_funptr_t = make_eval_forest_proxy_funptr_t();
-            llvm::Value *proxy_fun = builder.CreateIntToPtr(builder.getInt64((uint64_t)vespalib_eval_forest_proxy), proxy_funptr_t, "inject_eval_proxy");
+            llvm::Value *proxy_fun = inject((void *) vespalib_eval_forest_proxy, proxy_funptr_t);
             push(builder.CreateCall(proxy_fun, {eval_fun, ctx, params[0], params[1], builder.getInt64(stats.num_params)}));
         }
         return true;
@@ -371,8 +388,8 @@ struct FunctionBuilder : public NodeVisitor, public NodeTraverser {
             void *call_ptr = (void *) SetMemberHash::check_membership;
             PluginState *state = plugin_state.back().get();
             llvm::PointerType *funptr_t = make_check_membership_funptr_t();
-            llvm::Value *call_fun = builder.CreateIntToPtr(builder.getInt64((uint64_t)call_ptr), funptr_t, "inject_call_addr");
-            llvm::Value *ctx = builder.CreateIntToPtr(builder.getInt64((uint64_t)state), builder.getVoidTy()->getPointerTo(), "inject_ctx");
+            llvm::Value *call_fun = inject(call_ptr, funptr_t);
+            llvm::Value *ctx = inject(state, builder.getVoidTy()->getPointerTo());
             push(builder.CreateCall(call_fun, {ctx, lhs}, "call_check_membership"));
         } else {
             // build explicit code to check all set members
@@ -621,6 +638,7 @@ struct InitializeNativeTarget {
 } initialize_native_target;
 
 std::recursive_mutex LLVMWrapper::_global_llvm_lock;
+std::shared_ptr<DiskObjectCache> LLVMWrapper::_global_object_cache;
 
 LLVMWrapper::LLVMWrapper()
     : _context(),
@@ -628,7 +646,9 @@ LLVMWrapper::LLVMWrapper()
       _engine(),
       _functions(),
       _forests(),
-      _plugin_state()
+      _plugin_state(),
+      _injected(),
+      _object_cache()
 {
     std::lock_guard<std::recursive_mutex> guard(_global_llvm_lock);
     _context = std::make_unique<llvm::LLVMContext>();
@@ -645,7 +665,7 @@ LLVMWrapper::make_function(size_t num_params, PassParams pass_params, const Node
     FunctionBuilder builder(*_context, *_module,
                             vespalib::make_string("f%zu", function_id),
                             num_params, pass_params,
-                            forest_optimizers, _forests, _plugin_state);
+                            forest_optimizers, _forests, _plugin_state, _injected);
     builder.build_root(root);
     _functions.push_back(builder.build());
     return function_id;
@@ -659,7 +679,7 @@ LLVMWrapper::make_forest_fragment(size_t num_params, const std::vector<const Nod
     FunctionBuilder builder(*_context, *_module,
                             vespalib::make_string("f%zu", function_id),
                             num_params, PassParams::ARRAY,
-                            gbdt::Optimize::none, _forests, _plugin_state);
+                            gbdt::Optimize::none, _forests, _plugin_state, _injected);
     builder.build_forest_fragment(fragment);
     _functions.push_back(builder.build());
     return function_id;
@@ -672,9 +692,28 @@ LLVMWrapper::compile(llvm::raw_ostream * dumpStream)
     if (dumpStream) {
         _module->print(*dumpStream, nullptr);
     }
-    _engine.reset(llvm::EngineBuilder(std::move(_module)).setOptLevel(llvm::CodeGenOpt::Aggressive).create());
+    if (_global_object_cache) {
+        _object_cache = _global_object_cache;
+        _module->setModuleIdentifier(_object_cache->make_key(*_module));
+    }
+    auto before = std::chrono::steady_clock::now();
+    // injected symbols may be bound to any address in the process
+    _engine.reset(llvm::EngineBuilder(std::move(_module))
+                  .setOptLevel(llvm::CodeGenOpt::Aggressive)
+                  .setCodeModel(llvm::CodeModel::Large)
+                  .create());
     assert(_engine && "llvm jit not available for your platform");
+    for (const auto &symbol: _injected) {
+        _engine->addGlobalMapping(symbol.first.c_str(), (uint64_t) symbol.second);
+    }
+    if (_object_cache) {
+        _engine->setObjectCache(_object_cache.get());
+    }
     _engine->finalizeObject();
+    if (_object_cache) {
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - before;
+        _object_cache->report_time(elapsed.count());
+    }
 }
 
 void *
@@ -686,12 +725,28 @@ LLVMWrapper::get_function_address(size_t function_id)
 
 LLVMWrapper::~LLVMWrapper() {
     std::lock_guard<std::recursive_mutex> guard(_global_llvm_lock);
+    _injected.clear();
     _plugin_state.clear();
     _forests.clear();
     _functions.clear();
     _engine.reset();
     _module.reset();
     _context.reset();
+    _object_cache.reset();
+}
+
+void
+LLVMWrapper::set_object_cache(std::shared_ptr<DiskObjectCache> cache)
+{
+    std::lock_guard<std::recursive_mutex> guard(_global_llvm_lock);
+    _global_object_cache = std::move(cache);
+}
+
+std::shared_ptr<DiskObjectCache>
+LLVMWrapper::get_object_cache()
+{
+    std::lock_guard<std::recursive_mutex> guard(_global_llvm_lock);
+    return _global_object_cache;
 }
 
 }
@@ -2,6 +2,7 @@
 
 #pragma once
 
+#include "disk_object_cache.h"
 #include <vespa/eval/eval/function.h>
 #include <vespa/eval/eval/gbdt.h>
 
@@ -35,6 +36,12 @@ struct PluginState {
     virtual ~PluginState() {}
 };
 
+/**
+ * A process-local address referenced by generated code. The name is
+ * bound to the address when the generated code is linked.
+ **/
+using InjectedSymbol = std::pair<vespalib::string, void *>;
+
 /**
  * Stuff related to LLVM code generation is wrapped in this
  * class. This is mostly used by the CompiledFunction class.
@@ -48,8 +55,11 @@ private:
     std::vector<llvm::Function*>           _functions;
     std::vector<gbdt::Forest::UP>          _forests;
     std::vector<PluginState::UP>           _plugin_state;
+    std::vector<InjectedSymbol>            _injected;
+    std::shared_ptr<DiskObjectCache>       _object_cache;
 
     static std::recursive_mutex _global_llvm_lock;
+    static std::shared_ptr<DiskObjectCache> _global_object_cache;
 
     void compile(llvm::raw_ostream * dumpStream);
 public:
@@ -64,6 +74,15 @@ public:
     void compile() { compile(nullptr); }
     void *get_function_address(size_t function_id);
     ~LLVMWrapper();
+
+    /**
+     * Set (or clear with nullptr) the persistent object cache used
+     * when compiling modules. Process-local state (forests and plugin
+     * state) is referenced through injected symbols, so cached code
+     * is linked against the state of the module loading it.
+     **/
+    static void set_object_cache(std::shared_ptr<DiskObjectCache> cache);
+    static std::shared_ptr<DiskObjectCache> get_object_cache();
 };
 
 }
@@ -3,6 +3,7 @@
 #include "sparse_tensor.h"
 #include "sparse_tensor_add.h"
 #include "sparse_tensor_address_builder.h"
+#include "sparse_tensor_address_decoder.h"
 #include "sparse_tensor_apply.hpp"
 #include "sparse_tensor_match.h"
 #include "sparse_tensor_modify.h"
@@ -4,22 +4,68 @@
 
 #include "sparse_tensor_apply.h"
 #include "sparse_tensor_address_combiner.h"
+#include "sparse_tensor_interned_cells.h"
+#include "sparse_tensor_join_plan.h"
 #include <vespa/eval/tensor/direct_tensor_builder.h>
 #include "direct_sparse_tensor_builder.h"
 
 namespace vespalib::tensor::sparse {
 
+/**
+ * Join cells sharing labels in the overlapping dimensions by building
+ * a hash index over the interned labels of the smaller tensor and
+ * probing it with the cells of the larger one.
+ */
 template <typename Function>
 std::unique_ptr<Tensor>
-apply(const SparseTensor &lhs, const SparseTensor &rhs, Function &&func)
+hashJoin(const SparseTensor &lhs, const SparseTensor &rhs, Function &&func)
 {
     DirectTensorBuilder<SparseTensor> builder(lhs.combineDimensionsWith(rhs));
+    JoinPlan plan(lhs.fast_type(), rhs.fast_type());
+    SparseTensorLabelInterner interner;
+    SparseTensorInternedCells lhsCells(lhs, interner);
+    SparseTensorInternedCells rhsCells(rhs, interner);
+    bool indexLhs = (lhsCells.size() < rhsCells.size());
+    const SparseTensorInternedCells &buildCells = indexLhs ? lhsCells : rhsCells;
+    const SparseTensorInternedCells &probeCells = indexLhs ? rhsCells : lhsCells;
+    SparseTensorInternedIndex index(buildCells, indexLhs ? plan.lhsOverlap : plan.rhsOverlap);
+    const std::vector<uint32_t> &probeDims = indexLhs ? plan.rhsOverlap : plan.lhsOverlap;
+    SparseTensorAddressBuilder address;
+    builder.reserve(std::min(lhsCells.size(), rhsCells.size())*2);
+    for (size_t probeCell = 0; probeCell < probeCells.size(); ++probeCell) {
+        const uint32_t *probeLabels = probeCells.labels(probeCell);
+        uint32_t group = index.findGroup(probeLabels, probeDims);
+        if (group == SparseTensorInternedIndex::npos) {
+            continue;
+        }
+        for (uint32_t buildCell = index.first(group);
+             buildCell != SparseTensorInternedIndex::npos;
+             buildCell = index.next(buildCell))
+        {
+            const uint32_t *lhsLabels = indexLhs ? buildCells.labels(buildCell) : probeLabels;
+            const uint32_t *rhsLabels = indexLhs ? probeLabels : buildCells.labels(buildCell);
+            address.clear();
+            for (const auto &source : plan.output) {
+                address.add(interner.label(source.fromLhs ? lhsLabels[source.dim] : rhsLabels[source.dim]));
+            }
+            double lhsValue = indexLhs ? buildCells.value(buildCell) : probeCells.value(probeCell);
+            double rhsValue = indexLhs ? probeCells.value(probeCell) : buildCells.value(buildCell);
+            builder.insertCell(address, func(lhsValue, rhsValue));
+        }
+    }
+    return builder.build();
+}
+
+template <typename Function>
+std::unique_ptr<Tensor>
+apply(const SparseTensor &lhs, const SparseTensor &rhs, Function &&func)
+{
     TensorAddressCombiner addressCombiner(lhs.fast_type(), rhs.fast_type());
-    size_t estimatedCells = (lhs.cells().size() * rhs.cells().size());
     if (addressCombiner.numOverlappingDimensions() != 0) {
-        estimatedCells = std::min(lhs.cells().size(), rhs.cells().size());
+        return hashJoin(lhs, rhs, func);
     }
-    builder.reserve(estimatedCells*2);
+    DirectTensorBuilder<SparseTensor> builder(lhs.combineDimensionsWith(rhs));
+    builder.reserve(lhs.cells().size() * rhs.cells().size() * 2);
     for (const auto &lhsCell : lhs.cells()) {
         for (const auto &rhsCell : rhs.cells()) {
             bool combineSuccess = addressCombiner.combine(lhsCell.first, rhsCell.first);
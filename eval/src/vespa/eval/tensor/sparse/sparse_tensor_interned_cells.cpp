@@ -0,0 +1,104 @@
+// Copyright 2019 Oath Inc. Licensed under the terms of the Apache 2.0 license. See LICENSE in the project root.
+
+#include "sparse_tensor_interned_cells.h"
+#include "sparse_tensor.h"
+#include "sparse_tensor_address_decoder.h"
+#include <cassert>
+
+namespace vespalib::tensor {
+
+SparseTensorInternedCells::SparseTensorInternedCells(const SparseTensor &tensor,
+                                                     SparseTensorLabelInterner &interner)
+    : _numDims(tensor.fast_type().dimensions().size()),
+      _labels(),
+      _values()
+{
+    _labels.reserve(tensor.cells().size() * _numDims);
+    _values.reserve(tensor.cells().size());
+    for (const auto &cell : tensor.cells()) {
+        SparseTensorAddressDecoder decoder(cell.first);
+        for (uint32_t dim = 0; dim < _numDims; ++dim) {
+            _labels.push_back(interner.intern(decoder.decodeLabel()));
+        }
+        assert(!decoder.valid());
+        _values.push_back(cell.second);
+    }
+}
+
+SparseTensorInternedCells::~SparseTensorInternedCells() = default;
+
+uint64_t
+SparseTensorInternedIndex::hashKey(const uint32_t *labels, const std::vector<uint32_t> &dims)
+{
+    uint64_t hash = 0;
+    for (uint32_t dim : dims) {
+        hash = (hash ^ labels[dim]) * 0x9e3779b97f4a7c15ul;
+        hash ^= (hash >> 29);
+    }
+    return hash;
+}
+
+bool
+SparseTensorInternedIndex::sameKey(uint32_t cell, const uint32_t *labels, const std::vector<uint32_t> &dims) const
+{
+    const uint32_t *cellLabels = _cells.labels(cell);
+    for (size_t i = 0; i < dims.size(); ++i) {
+        if (cellLabels[_dims[i]] != labels[dims[i]]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+SparseTensorInternedIndex::SparseTensorInternedIndex(const SparseTensorInternedCells &cells,
+                                                     std::vector<uint32_t> dims)
+    : _cells(cells),
+      _dims(std::move(dims)),
+      _table(),
+      _groupFirst(),
+      _next(cells.size(), npos),
+      _mask(0)
+{
+    size_t tableSize = 16;
+    while (tableSize < (cells.size() * 2)) {
+        tableSize *= 2;
+    }
+    _table.resize(tableSize, npos);
+    _mask = tableSize - 1;
+    std::vector<uint32_t> groupLast;
+    for (uint32_t cell = 0; cell < cells.size(); ++cell) {
+        const uint32_t *labels = cells.labels(cell);
+        uint32_t slot = hashKey(labels, _dims) & _mask;
+        while (_table[slot] != npos && !sameKey(_groupFirst[_table[slot]], labels, _dims)) {
+            slot = (slot + 1) & _mask;
+        }
+        uint32_t group = _table[slot];
+        if (group == npos) {
+            _table[slot] = _groupFirst.size();
+            _groupFirst.push_back(cell);
+            groupLast.push_back(cell);
+        } else {
+            _next[groupLast[group]] = cell;
+            groupLast[group] = cell;
+        }
+    }
+}
+
+SparseTensorInternedIndex::~SparseTensorInternedIndex() = default;
+
+uint32_t
+SparseTensorInternedIndex::findGroup(const uint32_t *labels, const std::vector<uint32_t> &dims) const
+{
+    assert(dims.size() == _dims.size());
+    uint32_t slot = hashKey(labels, dims) & _mask;
+    while (_table[slot] != npos) {
+        uint32_t group = _table[slot];
+        if (sameKey(_groupFirst[group], labels, dims)) {
+            return group;
+        }
+        slot = (slot + 1) & _mask;
+    }
+    return npos;
+}
+
+}
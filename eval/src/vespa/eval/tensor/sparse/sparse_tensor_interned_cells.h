@@ -0,0 +1,66 @@
+// Copyright 2019 Oath Inc. Licensed under the terms of the Apache 2.0 license. See LICENSE in the project root.
+
+#pragma once
+
+#include "sparse_tensor_label_interner.h"
+#include <limits>
+#include <vector>
+
+namespace vespalib::tensor {
+
+class SparseTensor;
+
+/**
+ * The cells of a sparse tensor with all address labels interned.
+ * Labels are stored in a flat block with one label id per dimension
+ * per cell, in the dimension order of the tensor type.
+ */
+class SparseTensorInternedCells
+{
+    uint32_t _numDims;
+    std::vector<uint32_t> _labels;
+    std::vector<double> _values;
+public:
+    SparseTensorInternedCells(const SparseTensor &tensor, SparseTensorLabelInterner &interner);
+    ~SparseTensorInternedCells();
+    uint32_t numDims() const { return _numDims; }
+    size_t size() const { return _values.size(); }
+    const uint32_t *labels(size_t cell) const { return &_labels[cell * _numDims]; }
+    double value(size_t cell) const { return _values[cell]; }
+};
+
+/**
+ * Groups interned cells by the label ids found in a subset of their
+ * dimensions, using an open addressing hash table over integer
+ * tuples. Used to hash join cells on overlapping dimensions and to
+ * aggregate cells sharing the dimensions kept by a reduce.
+ */
+class SparseTensorInternedIndex
+{
+public:
+    static constexpr uint32_t npos = std::numeric_limits<uint32_t>::max();
+private:
+    const SparseTensorInternedCells &_cells;
+    std::vector<uint32_t> _dims;
+    std::vector<uint32_t> _table;
+    std::vector<uint32_t> _groupFirst;
+    std::vector<uint32_t> _next;
+    uint32_t _mask;
+
+    static uint64_t hashKey(const uint32_t *labels, const std::vector<uint32_t> &dims);
+    bool sameKey(uint32_t cell, const uint32_t *labels, const std::vector<uint32_t> &dims) const;
+public:
+    SparseTensorInternedIndex(const SparseTensorInternedCells &cells, std::vector<uint32_t> dims);
+    ~SparseTensorInternedIndex();
+
+    /**
+     * Find the group whose key matches the labels found at the given
+     * dimension positions of a probe cell; returns npos if none.
+     */
+    uint32_t findGroup(const uint32_t *labels, const std::vector<uint32_t> &dims) const;
+    uint32_t numGroups() const { return _groupFirst.size(); }
+    uint32_t first(uint32_t group) const { return _groupFirst[group]; }
+    uint32_t next(uint32_t cell) const { return _next[cell]; }
+};
+
+}
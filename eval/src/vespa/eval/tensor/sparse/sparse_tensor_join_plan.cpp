@@ -0,0 +1,34 @@
+// Copyright 2019 Oath Inc. Licensed under the terms of the Apache 2.0 license. See LICENSE in the project root.
+
+#include "sparse_tensor_join_plan.h"
+#include <vespa/eval/eval/value_type.h>
+
+namespace vespalib::tensor::sparse {
+
+JoinPlan::JoinPlan(const eval::ValueType &lhs, const eval::ValueType &rhs)
+    : lhsOverlap(),
+      rhsOverlap(),
+      output()
+{
+    const auto &lhsDims = lhs.dimensions();
+    const auto &rhsDims = rhs.dimensions();
+    uint32_t lhsIdx = 0;
+    uint32_t rhsIdx = 0;
+    while (lhsIdx < lhsDims.size() || rhsIdx < rhsDims.size()) {
+        if (rhsIdx == rhsDims.size() ||
+            (lhsIdx < lhsDims.size() && lhsDims[lhsIdx].name < rhsDims[rhsIdx].name)) {
+            output.push_back({true, lhsIdx++});
+        } else if (lhsIdx == lhsDims.size() || rhsDims[rhsIdx].name < lhsDims[lhsIdx].name) {
+            output.push_back({false, rhsIdx++});
+        } else {
+            lhsOverlap.push_back(lhsIdx);
+            rhsOverlap.push_back(rhsIdx);
+            output.push_back({true, lhsIdx++});
+            ++rhsIdx;
+        }
+    }
+}
+
+JoinPlan::~JoinPlan() = default;
+
+}
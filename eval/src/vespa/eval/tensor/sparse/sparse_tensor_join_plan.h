@@ -0,0 +1,31 @@
+// Copyright 2019 Oath Inc. Licensed under the terms of the Apache 2.0 license. See LICENSE in the project root.
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace vespalib::eval { class ValueType; }
+namespace vespalib::tensor::sparse {
+
+/**
+ * Describes how the dimensions of two sparse tensors map onto the
+ * dimensions of their join. Dimensions are identified by their
+ * position in the (sorted) dimension list of each tensor type.
+ */
+struct JoinPlan
+{
+    struct Source {
+        bool fromLhs;
+        uint32_t dim;
+    };
+
+    std::vector<uint32_t> lhsOverlap;
+    std::vector<uint32_t> rhsOverlap;
+    std::vector<Source> output;
+
+    JoinPlan(const eval::ValueType &lhs, const eval::ValueType &rhs);
+    ~JoinPlan();
+};
+
+}
@@ -0,0 +1,28 @@
+// Copyright 2019 Oath Inc. Licensed under the terms of the Apache 2.0 license. See LICENSE in the project root.
+
+#include "sparse_tensor_label_interner.h"
+#include <vespa/vespalib/stllike/hash_map.hpp>
+
+namespace vespalib::tensor {
+
+SparseTensorLabelInterner::SparseTensorLabelInterner()
+    : _ids(),
+      _labels()
+{
+}
+
+SparseTensorLabelInterner::~SparseTensorLabelInterner() = default;
+
+uint32_t
+SparseTensorLabelInterner::intern(vespalib::stringref label)
+{
+    auto res = _ids.insert(std::make_pair(label, uint32_t(_labels.size())));
+    if (res.second) {
+        _labels.push_back(label);
+    }
+    return res.first->second;
+}
+
+}
+
+VESPALIB_HASH_MAP_INSTANTIATE(vespalib::stringref, uint32_t);
@@ -0,0 +1,31 @@
+// Copyright 2019 Oath Inc. Licensed under the terms of the Apache 2.0 license. See LICENSE in the project root.
+
+#pragma once
+
+#include <vespa/vespalib/stllike/hash_map.h>
+#include <vespa/vespalib/stllike/string.h>
+#include <vector>
+
+namespace vespalib::tensor {
+
+/**
+ * Maps address labels to dense integer ids, letting tensor operations
+ * compare and hash labels as integers instead of strings.
+ *
+ * Labels are stored by reference; the memory backing the interned
+ * labels (typically the address stash of the tensors being operated
+ * on) must outlive the interner.
+ */
+class SparseTensorLabelInterner
+{
+    hash_map<vespalib::stringref, uint32_t> _ids;
+    std::vector<vespalib::stringref> _labels;
+public:
+    SparseTensorLabelInterner();
+    ~SparseTensorLabelInterner();
+    uint32_t intern(vespalib::stringref label);
+    vespalib::stringref label(uint32_t id) const { return _labels[id]; }
+    size_t size() const { return _labels.size(); }
+};
+
+}
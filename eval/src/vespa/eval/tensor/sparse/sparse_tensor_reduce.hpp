@@ -2,9 +2,10 @@
 
 #pragma once
 
-#include "sparse_tensor_address_reducer.h"
+#include "sparse_tensor_interned_cells.h"
 #include <vespa/eval/tensor/direct_tensor_builder.h>
 #include "direct_sparse_tensor_builder.h"
+#include <algorithm>
 
 namespace vespalib::tensor::sparse {
 
@@ -47,11 +48,30 @@ reduce(const SparseTensor &tensor,
     if (builder.fast_type().dimensions().empty()) {
         return reduceAll(tensor, builder, func);
     }
-    TensorAddressReducer addressReducer(tensor.fast_type(), dimensions);
-    builder.reserve(tensor.cells().size()*2);
-    for (const auto &cell : tensor.cells()) {
-        addressReducer.reduce(cell.first);
-        builder.insertCell(addressReducer.getAddressRef(), cell.second, func);
+    std::vector<uint32_t> keepDims;
+    const auto &dims = tensor.fast_type().dimensions();
+    for (uint32_t dim = 0; dim < dims.size(); ++dim) {
+        if (std::find(dimensions.begin(), dimensions.end(), dims[dim].name) == dimensions.end()) {
+            keepDims.push_back(dim);
+        }
+    }
+    SparseTensorLabelInterner interner;
+    SparseTensorInternedCells cells(tensor, interner);
+    SparseTensorInternedIndex index(cells, keepDims);
+    SparseTensorAddressBuilder address;
+    builder.reserve(index.numGroups());
+    for (uint32_t group = 0; group < index.numGroups(); ++group) {
+        uint32_t cell = index.first(group);
+        const uint32_t *labels = cells.labels(cell);
+        double result = cells.value(cell);
+        for (cell = index.next(cell); cell != SparseTensorInternedIndex::npos; cell = index.next(cell)) {
+            result = func(result, cells.value(cell));
+        }
+        address.clear();
+        for (uint32_t dim : keepDims) {
+            address.add(interner.label(labels[dim]));
+        }
+        builder.insertCell(address, result);
     }
     return builder.build();
 }
@@ -3,6 +3,7 @@
 #include <vespa/vespalib/testkit/test_kit.h>
 #include <vespa/fnet/fnet.h>
 #include <vespa/vespalib/net/server_socket.h>
+#include <vespa/vespalib/net/socket_address.h>
 #include <vespa/vespalib/net/crypto_engine.h>
 #include <vespa/vespalib/util/sync.h>
 #include <vespa/vespalib/util/stringfmt.h>
@@ -73,6 +74,27 @@ struct BlockingCryptoEngine : public CryptoEngine {
 
 //-----------------------------------------------------------------------------
 
+struct BlobPacket : public FNET_Packet {
+    uint32_t len;
+    BlobPacket(uint32_t len_in) : len(len_in) {}
+    uint32_t GetPCODE() override { return 1; }
+    uint32_t GetLength() override { return len; }
+    void Encode(FNET_DataBuffer *dst) override {
+        dst->EnsureFree(len);
+        memset(dst->GetFree(), 0, len);
+        dst->FreeToData(len);
+    }
+    bool Decode(FNET_DataBuffer *, uint32_t) override { return false; }
+};
+
+void post_blobs(FNET_Connection *conn, size_t num_blobs) {
+    for (size_t i = 0; i < num_blobs; ++i) {
+        conn->PostPacket(new BlobPacket(64 * 1024), FNET_NOID);
+    }
+}
+
+//-----------------------------------------------------------------------------
+
 struct TransportFixture : FNET_IPacketHandler, FNET_IConnectionCleanupHandler {
     FNET_SimplePacketStreamer streamer;
     FastOS_ThreadPool pool;
@@ -136,6 +158,46 @@ TEST_MT_FFF("require that normal connect works", 2,
     }
 }
 
+TEST_MT_FFFF("require that connect to localhost uses the local transport when the server listens for it", 2,
+             ServerSocket("tcp/0"), ServerSocket(FNET_Transport::local_spec(f1.address().port())),
+             TransportFixture(), TimeBomb(60))
+{
+    if (thread_id == 0) {
+        SocketHandle socket = f2.accept();
+        EXPECT_TRUE(socket.valid());
+        EXPECT_TRUE(SocketAddress::address_of(socket.get()).is_ipc());
+        TEST_BARRIER();
+    } else {
+        vespalib::string spec = make_string("tcp/localhost:%d", f1.address().port());
+        FNET_Connection *conn = f3.connect(spec);
+        TEST_BARRIER();
+        conn->Owner()->Close(conn);
+        f3.conn_lost.await();
+        conn->SubRef();
+        f3.conn_deleted.await();
+    }
+}
+
+TEST_MT_FFFF("require that the local transport can be disabled", 2,
+             ServerSocket("tcp/0"), ServerSocket(FNET_Transport::local_spec(f1.address().port())),
+             TransportFixture(), TimeBomb(60))
+{
+    if (thread_id == 0) {
+        SocketHandle socket = f1.accept();
+        EXPECT_TRUE(socket.valid());
+        TEST_BARRIER();
+    } else {
+        f3.transport.SetLocalTransport(false);
+        vespalib::string spec = make_string("tcp/localhost:%d", f1.address().port());
+        FNET_Connection *conn = f3.connect(spec);
+        TEST_BARRIER();
+        conn->Owner()->Close(conn);
+        f3.conn_lost.await();
+        conn->SubRef();
+        f3.conn_deleted.await();
+    }
+}
+
 TEST_FF("require that bogus connect fail asynchronously", TransportFixture(), TimeBomb(60)) {
     FNET_Connection *conn = f1.connect("invalid");
     f1.conn_lost.await();
@@ -190,4 +252,57 @@ TEST_MT_FFFF("require that async close during async do_handshake_work works", 2,
     }
 }
 
+TEST_MT_FFF("require that transport stats track connections and slow consumers", 2,
+            ServerSocket("tcp/0"), TransportFixture(), TimeBomb(60))
+{
+    if (thread_id == 0) {
+        SocketHandle socket = f1.accept();
+        EXPECT_TRUE(socket.valid());
+        TEST_BARRIER(); // peer never reads anything
+    } else {
+        f2.transport.SetSlowConsumerLimit(1024 * 1024);
+        vespalib::string spec = make_string("tcp/localhost:%d", f1.address().port());
+        FNET_Connection *conn = f2.connect(spec);
+        post_blobs(conn, 512);
+        FNET_TransportStats stats = f2.transport.get_stats(true);
+        EXPECT_EQUAL(stats.num_connections, 1u);
+        EXPECT_EQUAL(stats.slow_consumer_events, 1u);
+        EXPECT_EQUAL(stats.shed_connections, 0u);
+        ASSERT_EQUAL(stats.connections.size(), 1u);
+        EXPECT_TRUE(stats.connections[0].slow_consumer);
+        EXPECT_GREATER(stats.connections[0].queued_bytes, 1024u * 1024u / 2);
+        EXPECT_EQUAL(stats.connections[0].spec, spec);
+        EXPECT_TRUE(f2.transport.get_stats(false).connections.empty());
+        TEST_BARRIER();
+        conn->Owner()->Close(conn);
+        f2.conn_lost.await();
+        conn->SubRef();
+        f2.conn_deleted.await();
+        EXPECT_EQUAL(f2.transport.get_stats(false).num_connections, 0u);
+    }
+}
+
+TEST_MT_FFF("require that slow consumers can be shed", 2,
+            ServerSocket("tcp/0"), TransportFixture(), TimeBomb(60))
+{
+    if (thread_id == 0) {
+        SocketHandle socket = f1.accept();
+        EXPECT_TRUE(socket.valid());
+        TEST_BARRIER(); // peer never reads anything
+    } else {
+        f2.transport.SetSlowConsumerLimit(1024 * 1024);
+        f2.transport.SetShedSlowConsumers(true);
+        vespalib::string spec = make_string("tcp/localhost:%d", f1.address().port());
+        FNET_Connection *conn = f2.connect(spec);
+        post_blobs(conn, 512);
+        f2.conn_lost.await();
+        FNET_TransportStats stats = f2.transport.get_stats(false);
+        EXPECT_EQUAL(stats.slow_consumer_events, 1u);
+        EXPECT_EQUAL(stats.shed_connections, 1u);
+        TEST_BARRIER();
+        conn->SubRef();
+        f2.conn_deleted.await();
+    }
+}
+
 TEST_MAIN() { TEST_RUN_ALL(); }
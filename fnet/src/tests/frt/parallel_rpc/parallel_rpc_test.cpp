@@ -10,12 +10,18 @@
 
 using namespace vespalib;
 
+FNET_Config make_config(SelectorBackend backend) {
+    FNET_Config config;
+    config._selectorBackend = backend;
+    return config;
+}
+
 struct Rpc : FRT_Invokable {
     FastOS_ThreadPool thread_pool;
     FNET_Transport    transport;
     FRT_Supervisor    orb;
-    Rpc(CryptoEngine::SP crypto, size_t num_threads)
-        : thread_pool(128 * 1024), transport(crypto, num_threads), orb(&transport, &thread_pool) {}
+    Rpc(CryptoEngine::SP crypto, size_t num_threads, SelectorBackend backend)
+        : thread_pool(128 * 1024), transport(vespalib::AsyncResolver::get_shared(), crypto, num_threads, make_config(backend)), orb(&transport, &thread_pool) {}
     void start() {
         ASSERT_TRUE(transport.Start(&thread_pool));
     }
@@ -34,7 +40,9 @@ struct Rpc : FRT_Invokable {
 
 struct Server : Rpc {
     uint32_t port;
-    Server(CryptoEngine::SP crypto, size_t num_threads) : Rpc(crypto, num_threads), port(listen()) {
+    Server(CryptoEngine::SP crypto, size_t num_threads, SelectorBackend backend = SelectorBackend::EPOLL)
+        : Rpc(crypto, num_threads, backend), port(listen())
+    {
         init_rpc();
         start();
     }
@@ -54,7 +62,10 @@ struct Server : Rpc {
 
 struct Client : Rpc {
     uint32_t port;
-    Client(CryptoEngine::SP crypto, size_t num_threads, const Server &server) : Rpc(crypto, num_threads), port(server.port) {
+    Client(CryptoEngine::SP crypto, size_t num_threads, const Server &server,
+           SelectorBackend backend = SelectorBackend::EPOLL)
+        : Rpc(crypto, num_threads, backend), port(server.port)
+    {
         start();
     }
     FRT_Target *connect() { return Rpc::connect(port); }
@@ -133,6 +144,14 @@ TEST_MT_FFF("parallel rpc with 1/1 transport threads and 128 user threads (tls e
 TEST_MT_FFF("parallel rpc with 8/8 transport threads and 128 user threads (no encryption)",
             128, Server(null_crypto, 8), Client(null_crypto, 8, f1), Result(num_threads)) { perform_test(thread_id, f2, f3); }
 
+TEST_MT_FFF("parallel rpc with 1/1 transport threads and 128 user threads (no encryption, io_uring)",
+            128, Server(null_crypto, 1, SelectorBackend::IO_URING), Client(null_crypto, 1, f1, SelectorBackend::IO_URING),
+            Result(num_threads)) { perform_test(thread_id, f2, f3); }
+
+TEST_MT_FFF("parallel rpc with 8/8 transport threads and 128 user threads (no encryption, io_uring)",
+            128, Server(null_crypto, 8, SelectorBackend::IO_URING), Client(null_crypto, 8, f1, SelectorBackend::IO_URING),
+            Result(num_threads)) { perform_test(thread_id, f2, f3); }
+
 TEST_MT_FFF("parallel rpc with 8/8 transport threads and 128 user threads (xor encryption)",
             128, Server(xor_crypto, 8), Client(xor_crypto, 8, f1), Result(num_threads)) { perform_test(thread_id, f2, f3); }
 
@@ -0,0 +1,157 @@
+// Copyright 2019 Oath Inc. Licensed under the terms of the Apache 2.0 license. See LICENSE in the project root.
+#include <vespa/vespalib/testkit/test_kit.h>
+#include <vespa/fnet/databuffer.h>
+#include <vespa/fnet/gatheroutput.h>
+#include <vespa/fnet/packet.h>
+#include <vespa/fnet/simplepacketstreamer.h>
+#include <vespa/fnet/frt/packets.h>
+#include <vespa/fnet/frt/rpcrequest.h>
+#include <vespa/vespalib/net/crypto_socket.h>
+#include <sys/uio.h>
+
+using vespalib::CryptoSocket;
+
+struct RecordingSocket : CryptoSocket {
+    std::string data;
+    size_t max_write;
+    size_t num_writes;
+    size_t num_writev;
+    RecordingSocket(size_t max_write_in) : data(), max_write(max_write_in), num_writes(0), num_writev(0) {}
+    int get_fd() const override { return -1; }
+    HandshakeResult handshake() override { return HandshakeResult::DONE; }
+    void do_handshake_work() override {}
+    size_t min_read_buffer_size() const override { return 1; }
+    ssize_t read(char *, size_t) override { return 0; }
+    ssize_t drain(char *, size_t) override { return 0; }
+    ssize_t write(const char *buf, size_t len) override {
+        ++num_writes;
+        size_t n = std::min(len, max_write);
+        data.append(buf, n);
+        return n;
+    }
+    ssize_t writev(const struct iovec *iov, int iovcnt) override {
+        ++num_writev;
+        size_t written = 0;
+        for (int i = 0; (i < iovcnt) && (written < max_write); ++i) {
+            size_t n = std::min(iov[i].iov_len, max_write - written);
+            data.append(static_cast<const char *>(iov[i].iov_base), n);
+            written += n;
+        }
+        return written;
+    }
+    ssize_t flush() override { return 0; }
+    ssize_t half_close() override { return 0; }
+};
+
+struct MyPacket : FNET_Packet {
+    std::string payload;
+    bool &freed;
+    MyPacket(std::string payload_in, bool &freed_in) : payload(std::move(payload_in)), freed(freed_in) {}
+    void Free() override { freed = true; delete this; }
+    uint32_t GetPCODE() override { return 42; }
+    uint32_t GetLength() override { return payload.size(); }
+    uint32_t GetRefLength() override { return payload.size(); }
+    void Encode(FNET_DataBuffer *dst) override { dst->WriteBytes(payload.data(), payload.size()); }
+    void EncodeGather(FNET_GatherOutput &dst) override { dst.AddRef(payload.data(), payload.size()); }
+    bool Decode(FNET_DataBuffer *, uint32_t) override { return false; }
+};
+
+size_t flush(FNET_GatherOutput &out, CryptoSocket &socket) {
+    size_t cnt = 0;
+    while (out.GetDataLen() > 0) {
+        if (!EXPECT_TRUE(out.Write(socket) > 0)) {
+            break;
+        }
+        ++cnt;
+    }
+    return cnt;
+}
+
+TEST("require that small data is copied into the output buffer") {
+    FNET_DataBuffer buf(64);
+    FNET_GatherOutput out(buf);
+    bool freed = false;
+    auto *packet = new MyPacket("small", freed);
+    buf.WriteInt32(5);
+    packet->EncodeGather(out);
+    out.EndPacket(packet);
+    EXPECT_TRUE(freed);
+    EXPECT_EQUAL(9u, out.GetDataLen());
+    RecordingSocket socket(1024);
+    EXPECT_EQUAL(1u, flush(out, socket));
+    EXPECT_EQUAL(0u, socket.num_writev);
+    EXPECT_EQUAL(std::string("\0\0\0\5small", 9), socket.data);
+}
+
+TEST("require that large data is referenced and the packet held until written") {
+    FNET_DataBuffer buf(64);
+    FNET_GatherOutput out(buf);
+    bool freed = false;
+    std::string payload(3 * FNET_GatherOutput::MIN_REF_SIZE, 'x');
+    auto *packet = new MyPacket(payload, freed);
+    buf.WriteBytes("head", 4);
+    packet->EncodeGather(out);
+    buf.WriteBytes("tail", 4);
+    out.EndPacket(packet);
+    EXPECT_FALSE(freed);
+    EXPECT_EQUAL(payload.size() + 8, out.GetDataLen());
+    EXPECT_EQUAL(8u, buf.GetDataLen());
+    RecordingSocket socket(1000);
+    out.Write(socket);
+    EXPECT_FALSE(freed);
+    flush(out, socket);
+    EXPECT_TRUE(freed);
+    EXPECT_EQUAL("head" + payload + "tail", socket.data);
+    EXPECT_EQUAL(0u, buf.GetDataLen());
+}
+
+TEST("require that discarding output frees held packets") {
+    FNET_DataBuffer buf(64);
+    FNET_GatherOutput out(buf);
+    bool freed = false;
+    auto *packet = new MyPacket(std::string(FNET_GatherOutput::MIN_REF_SIZE, 'x'), freed);
+    packet->EncodeGather(out);
+    out.EndPacket(packet);
+    EXPECT_FALSE(freed);
+    out.Discard();
+    EXPECT_TRUE(freed);
+    EXPECT_EQUAL(0u, out.GetDataLen());
+}
+
+struct DummyFactory : FNET_IPacketFactory {
+    FNET_Packet *CreatePacket(uint32_t, FNET_Context) override { return nullptr; }
+};
+
+TEST("require that gathered rpc request streams the same bytes as copied") {
+    FRT_RPCRequest *req = new FRT_RPCRequest();
+    req->SetMethodName("test");
+    req->GetParams()->AddInt32(7);
+    std::string big(2 * FNET_GatherOutput::MIN_REF_SIZE, 'b');
+    req->GetParams()->AddData(big.data(), big.size());
+    req->GetParams()->AddData("small", 5);
+    req->GetParams()->AddString("str");
+    DummyFactory factory;
+    FNET_SimplePacketStreamer streamer(&factory);
+
+    req->AddRef();
+    FNET_Packet *copy_packet = req->CreateRequestPacket(false);
+    FNET_DataBuffer copy_buf(64);
+    streamer.Encode(copy_packet, 5, &copy_buf);
+    std::string expect(copy_buf.GetData(), copy_buf.GetDataLen());
+    copy_packet->Free();
+
+    FNET_Packet *gather_packet = req->CreateRequestPacket(false);
+    EXPECT_EQUAL(big.size(), gather_packet->GetRefLength());
+    FNET_DataBuffer gather_buf(64);
+    FNET_GatherOutput out(gather_buf);
+    streamer.EncodeGather(gather_packet, 5, out);
+    out.EndPacket(gather_packet);
+    EXPECT_EQUAL(expect.size(), out.GetDataLen());
+    EXPECT_EQUAL(expect.size() - big.size(), gather_buf.GetDataLen());
+    RecordingSocket socket(4096);
+    flush(out, socket);
+    EXPECT_GREATER(socket.num_writev, 0u);
+    EXPECT_EQUAL(expect, socket.data);
+}
+
+TEST_MAIN() { TEST_RUN_ALL(); }
@@ -76,3 +76,9 @@ FNET_ChannelLookup::Unregister(FNET_Channel *channel)
     _map->erase(found);
     return true;
 }
+
+size_t
+FNET_ChannelLookup::size() const
+{
+    return _map->size();
+}
@@ -89,5 +89,10 @@ public:
      * @param channel the channel you want to unregister.
      **/
     bool Unregister(FNET_Channel *channel);
+
+    /**
+     * @return the number of registered channels.
+     **/
+    size_t size() const;
 };
 
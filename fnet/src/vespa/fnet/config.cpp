@@ -1,11 +1,43 @@
 // Copyright 2017 Yahoo Holdings. Licensed under the terms of the Apache 2.0 license. See LICENSE in the project root.
 
 #include "config.h"
+#include <vespa/vespalib/stllike/string.h>
+#include <cstdlib>
+
+#include <vespa/log/log.h>
+LOG_SETUP(".fnet.config");
+
+namespace {
+
+vespalib::SelectorBackend selector_backend_from_env() {
+    const char *env = getenv("VESPA_FNET_SELECTOR_BACKEND");
+    vespalib::string backend = env ? env : "";
+    if (backend == "io_uring") {
+        return vespalib::SelectorBackend::IO_URING;
+    } else if (!backend.empty() && (backend != "epoll")) {
+        LOG(warning, "VESPA_FNET_SELECTOR_BACKEND environment variable has "
+                     "an unsupported value (%s). Falling back to 'epoll'", backend.c_str());
+    }
+    return vespalib::SelectorBackend::EPOLL;
+}
+
+} // namespace <unnamed>
 
 FNET_Config::FNET_Config()
     : _iocTimeOut(0),
       _maxInputBufferSize(0x10000),
       _maxOutputBufferSize(0x10000),
-      _tcpNoDelay(true)
+      _tcpNoDelay(true),
+      _localTransport(true),
+      _slowConsumerLimit(0),
+      _shedSlowConsumers(false),
+      _selectorBackend(default_selector_backend())
+{
+}
+
+vespalib::SelectorBackend
+FNET_Config::default_selector_backend()
 {
+    static const vespalib::SelectorBackend backend = selector_backend_from_env();
+    return backend;
 }
@@ -2,6 +2,7 @@
 
 #pragma once
 
+#include <vespa/vespalib/net/selector.h>
 #include <cstdint>
 
 /**
@@ -15,6 +16,17 @@ public:
     uint32_t  _maxInputBufferSize;
     uint32_t  _maxOutputBufferSize;
     bool      _tcpNoDelay;
+    bool      _localTransport;
+    uint32_t  _slowConsumerLimit;
+    bool      _shedSlowConsumers;
+    vespalib::SelectorBackend _selectorBackend;
 
     FNET_Config();
+
+    /**
+     * The selector backend used when not configured. This is epoll,
+     * unless the VESPA_FNET_SELECTOR_BACKEND environment variable is
+     * set to 'io_uring'.
+     **/
+    static vespalib::SelectorBackend default_selector_backend();
 };
@@ -9,6 +9,8 @@
 #include "config.h"
 #include "transport_thread.h"
 #include "transport.h"
+#include <vespa/vespalib/net/shm_crypto_socket.h>
+#include <cinttypes>
 
 #include <vespa/log/log.h>
 LOG_SETUP(".fnet");
@@ -138,6 +140,13 @@ FNET_Connection::SetState(State state)
             guard.lock();
             _flags._discarding = false;
         }
+        if (_gather.GetDataLen() > 0) {
+            guard.unlock();
+            _gather.Discard();
+            guard.lock();
+        }
+        _queuedBytes = 0;
+        _flags._slowConsumer = false;
 
         BeforeCallback(guard, nullptr);
         toDelete = _channels.Broadcast(&FNET_ControlPacket::ChannelLost);
@@ -291,6 +300,7 @@ FNET_Connection::handle_packets()
                     &broken);
         }
         if (_flags._gotheader && (_input.GetDataLen() >= _packetLength)) {
+            ++_packetsRead;
             HandlePacket(_packetLength, _packetCode, _packetCHID);
             _flags._gotheader = false; // reset header flag.
         } else {
@@ -307,6 +317,8 @@ FNET_Connection::Read()
     int      readCnt     = 0;     // read count
     bool     broken      = false; // is this conn broken ?
     int      my_errno    = 0;     // sample and preserve errno
+    uint64_t oldBytes    = _bytesRead;
+    uint64_t oldPackets  = _packetsRead;
     ssize_t  res;                 // single read result
 
     _input.EnsureFree(chunk_size);
@@ -316,6 +328,7 @@ FNET_Connection::Read()
 
     while (res > 0) {
         _input.FreeToData((uint32_t)res);
+        _bytesRead += res;
         broken = !handle_packets();
         _input.resetIfEmpty();
         if (broken || ((_input.GetFreeLen() > 0) && !_flags._framed) || (readCnt >= FNET_READ_REDO)) {
@@ -335,6 +348,7 @@ done_read:
         my_errno = errno;
         if (res > 0) {
             _input.FreeToData((uint32_t)res);
+            _bytesRead += res;
             broken = !handle_packets();
             _input.resetIfEmpty();
         } else if (res == 0) { // fully drained -> EWOULDBLOCK
@@ -343,6 +357,7 @@ done_read:
         }
     }
 
+    Owner()->count_read(_packetsRead - oldPackets, _bytesRead - oldBytes);
     UpdateTimeOut();
     uint32_t maxSize = GetConfig()->_maxInputBufferSize;
     if (maxSize > 0 && _input.GetBufSize() > maxSize)
@@ -375,6 +390,10 @@ FNET_Connection::Write()
     int      writeCnt       = 0;     // write count
     bool     broken         = false; // is this conn broken ?
     int      my_errno       = 0;     // sample and preserve errno
+    uint64_t doneBytes      = 0;     // bytes removed from the queue
+    uint64_t oldBytes       = _bytesWritten;
+    uint64_t oldPackets     = _packetsWritten;
+    uint32_t slowConsumerLimit = GetConfig()->_slowConsumerLimit;
     ssize_t  res;                    // single write result
 
     FNET_Packet     *packet;
@@ -384,37 +403,40 @@ FNET_Connection::Write()
 
         // fill output buffer
 
-        while (_output.GetDataLen() < chunk_size) {
+        while (_gather.GetDataLen() < chunk_size) {
             if (_myQueue.IsEmpty_NoLock())
                 break;
 
             packet = _myQueue.DequeuePacket_NoLock(&context);
             if (packet->IsRegularPacket()) { // ignore non-regular packets
-                _streamer->Encode(packet, context._value.INT, &_output);
+                if (slowConsumerLimit > 0) {
+                    doneBytes += packet->GetLength();
+                }
+                ++_packetsWritten;
+                _streamer->EncodeGather(packet, context._value.INT, _gather);
             }
-            packet->Free();
+            _gather.EndPacket(packet);
         }
 
-        if (_output.GetDataLen() == 0) {
+        if (_gather.GetDataLen() == 0) {
             res = 0;
             break;
         }
 
-        // write data
+        // write data (buffered bytes and referenced payloads)
 
-        res = _socket->write(_output.GetData(), _output.GetDataLen());
+        res = _gather.Write(*_socket);
         my_errno = errno;
-        writeCnt++;
         if (res > 0) {
-            _output.DataToDead((uint32_t)res);
-            _output.resetIfEmpty();
+            _bytesWritten += res;
         }
+        writeCnt++;
     } while (res > 0 &&
-             _output.GetDataLen() == 0 &&
+             _gather.GetDataLen() == 0 &&
              !_myQueue.IsEmpty_NoLock() &&
              writeCnt < FNET_WRITE_REDO);
 
-    if ((_output.GetDataLen() > 0)) {
+    if ((_gather.GetDataLen() > 0)) {
         ++my_write_work;
     }
 
@@ -443,11 +465,20 @@ FNET_Connection::Write()
         }
     }
 
+    Owner()->count_written(_packetsWritten - oldPackets, _bytesWritten - oldBytes);
+
     std::unique_lock<std::mutex> guard(_ioc_lock);
     _writeWork = _queue.GetPacketCnt_NoLock()
                  + _myQueue.GetPacketCnt_NoLock()
                  + my_write_work;
     bool writePending = (_writeWork > 0);
+    _queuedBytes -= std::min(doneBytes, _queuedBytes);
+    if (_flags._slowConsumer && _queuedBytes <= slowConsumerLimit / 2) {
+        _flags._slowConsumer = false;
+    }
+    if (!writePending) {
+        _outputStallStart = std::chrono::steady_clock::time_point();
+    }
 
     guard.unlock();
     if (!writePending)
@@ -465,12 +496,15 @@ FNET_Connection::FNET_Connection(FNET_TransportThread *owner,
                                  FNET_IPacketStreamer *streamer,
                                  FNET_IServerAdapter *serverAdapter,
                                  vespalib::SocketHandle socket,
-                                 const char *spec)
+                                 const char *spec,
+                                 bool local)
     : FNET_IOComponent(owner, socket.get(), spec, /* time-out = */ true),
       _streamer(streamer),
       _serverAdapter(serverAdapter),
       _adminChannel(nullptr),
-      _socket(owner->owner().create_crypto_socket(std::move(socket), true)),
+      _socket(local
+              ? owner->owner().create_local_crypto_socket(std::move(socket), true)
+              : owner->owner().create_crypto_socket(std::move(socket), true)),
       _resolve_handler(nullptr),
       _context(),
       _state(FNET_CONNECTING),
@@ -484,8 +518,15 @@ FNET_Connection::FNET_Connection(FNET_TransportThread *owner,
       _queue(256),
       _myQueue(256),
       _output(FNET_WRITE_SIZE * 2),
+      _gather(_output),
       _channels(),
       _callbackTarget(nullptr),
+      _queuedBytes(0),
+      _outputStallStart(),
+      _bytesRead(0),
+      _bytesWritten(0),
+      _packetsRead(0),
+      _packetsWritten(0),
       _cleanup(nullptr)
 {
     assert(_socket && (_socket->get_fd() >= 0));
@@ -517,8 +558,15 @@ FNET_Connection::FNET_Connection(FNET_TransportThread *owner,
       _queue(256),
       _myQueue(256),
       _output(FNET_WRITE_SIZE * 2),
+      _gather(_output),
       _channels(),
       _callbackTarget(nullptr),
+      _queuedBytes(0),
+      _outputStallStart(),
+      _bytesRead(0),
+      _bytesWritten(0),
+      _packetsRead(0),
+      _packetsWritten(0),
       _cleanup(nullptr)
 {
     if (adminHandler != nullptr) {
@@ -574,7 +622,21 @@ FNET_Connection::handle_add_event()
 {
     if (_resolve_handler) {
         auto tweak = [this](vespalib::SocketHandle &handle) { return Owner()->tune(handle); };
-        _socket = Owner()->owner().create_crypto_socket(_resolve_handler->address.connect(tweak), false);
+        const vespalib::SocketAddress &address = _resolve_handler->address;
+        vespalib::SocketHandle handle;
+        if (GetConfig()->_localTransport && Owner()->owner().local_transport_allowed() && address.is_loopback()) {
+            // falls back to tcp when the server does not listen for local connections
+            handle = FNET_Transport::local_spec(address.port()).client_address().connect(tweak);
+            if (handle.valid() && !vespalib::ShmCryptoSocket::is_peer_same_user(handle.get())) {
+                // somebody else holds the local socket name; do not share memory with it
+                handle.reset();
+            }
+        }
+        if (handle.valid()) {
+            _socket = Owner()->owner().create_local_crypto_socket(std::move(handle), false);
+        } else {
+            _socket = Owner()->owner().create_crypto_socket(address.connect(tweak), false);
+        }
         _ioc_socket_fd = _socket->get_fd();
         _resolve_handler.reset();
     }
@@ -683,6 +745,9 @@ FNET_Connection::PostPacket(FNET_Packet *packet, uint32_t chid)
     uint32_t writeWork;
 
     assert(packet != nullptr);
+    uint32_t slowConsumerLimit = GetConfig()->_slowConsumerLimit;
+    // Queued packets are only measured when there is a limit to enforce.
+    uint32_t length = ((slowConsumerLimit > 0) && packet->IsRegularPacket()) ? packet->GetLength() : 0;
     std::unique_lock<std::mutex> guard(_ioc_lock);
     if (_state >= FNET_CLOSING) {
         if (_flags._discarding) {
@@ -696,15 +761,57 @@ FNET_Connection::PostPacket(FNET_Packet *packet, uint32_t chid)
     writeWork = _writeWork;
     _writeWork++;
     _queue.QueuePacket_NoLock(packet, FNET_Context(chid));
+    _queuedBytes += length;
+    if (writeWork == 0) {
+        _outputStallStart = std::chrono::steady_clock::now();
+    }
+    uint64_t slowConsumerBytes = 0;
+    if ((slowConsumerLimit > 0) && !_flags._slowConsumer && (_queuedBytes > slowConsumerLimit)) {
+        _flags._slowConsumer = true;
+        slowConsumerBytes = _queuedBytes;
+    }
     if ((writeWork == 0) && (_state == FNET_CONNECTED)) {
         AddRef_NoLock();
         guard.unlock();
         Owner()->EnableWrite(this, /* needRef = */ false);
+    } else {
+        guard.unlock();
+    }
+    if (slowConsumerBytes > 0) {
+        bool shed = GetConfig()->_shedSlowConsumers;
+        LOG(warning, "Connection(%s): slow consumer, %" PRIu64 " bytes queued for output%s",
+            GetSpec(), slowConsumerBytes, shed ? ", closing connection" : "");
+        Owner()->count_slow_consumer(shed);
+        if (shed) {
+            Owner()->Close(this);
+        }
     }
     return true;
 }
 
 
+FNET_ConnectionStats
+FNET_Connection::get_stats(std::chrono::steady_clock::time_point now)
+{
+    FNET_ConnectionStats stats;
+    stats.spec = GetSpec();
+    stats.server = IsServer();
+    stats.bytes_read = _bytesRead;
+    stats.bytes_written = _bytesWritten;
+    stats.packets_read = _packetsRead;
+    stats.packets_written = _packetsWritten;
+    std::lock_guard<std::mutex> guard(_ioc_lock);
+    stats.slow_consumer = _flags._slowConsumer;
+    stats.channels = _channels.size();
+    stats.queued_packets = _queue.GetPacketCnt_NoLock() + _myQueue.GetPacketCnt_NoLock();
+    stats.queued_bytes = _queuedBytes + _gather.GetDataLen();
+    if (_writeWork > 0 && _outputStallStart != std::chrono::steady_clock::time_point()) {
+        stats.output_stall_ms = std::chrono::duration<double, std::milli>(now - _outputStallStart).count();
+    }
+    return stats;
+}
+
+
 void
 FNET_Connection::Sync()
 {
@@ -4,12 +4,15 @@
 
 #include "iocomponent.h"
 #include "databuffer.h"
+#include "gatheroutput.h"
 #include "context.h"
 #include "channellookup.h"
 #include "packetqueue.h"
+#include "transport_stats.h"
 #include <vespa/vespalib/net/socket_handle.h>
 #include <vespa/vespalib/net/async_resolver.h>
 #include <vespa/vespalib/net/crypto_socket.h>
+#include <chrono>
 
 class FNET_IPacketStreamer;
 class FNET_IServerAdapter;
@@ -72,7 +75,8 @@ private:
             _callbackWait(false),
             _discarding(false),
             _framed(false),
-            _handshake_work_pending(false)
+            _handshake_work_pending(false),
+            _slowConsumer(false)
         { }
         bool _gotheader;
         bool _inCallback;
@@ -80,6 +84,7 @@ private:
         bool _discarding;
         bool _framed;
         bool _handshake_work_pending;
+        bool _slowConsumer;
     };
     struct ResolveHandler : public vespalib::AsyncResolver::ResultHandler {
         FNET_Connection *connection;
@@ -106,8 +111,15 @@ private:
     FNET_PacketQueue_NoLock  _queue;           // outer output queue
     FNET_PacketQueue_NoLock  _myQueue;         // inner output queue
     FNET_DataBuffer          _output;          // output buffer
+    FNET_GatherOutput        _gather;          // pending output incl. refs
     FNET_ChannelLookup       _channels;        // channel 'DB'
     FNET_Channel            *_callbackTarget;  // target of current callback
+    uint64_t                 _queuedBytes;     // bytes posted, not yet encoded
+    std::chrono::steady_clock::time_point _outputStallStart; // when output queue became non-empty
+    uint64_t                 _bytesRead;       // total bytes read
+    uint64_t                 _bytesWritten;    // total bytes written
+    uint64_t                 _packetsRead;     // total packets read
+    uint64_t                 _packetsWritten;  // total packets written
 
     FNET_IConnectionCleanupHandler *_cleanup;  // cleanup handler
 
@@ -247,12 +259,14 @@ public:
      * @param serverAdapter object for custom channel creation
      * @param socket the underlying socket used for IO
      * @param spec listen spec
+     * @param local whether the socket was accepted through the local transport
      **/
     FNET_Connection(FNET_TransportThread *owner,
                     FNET_IPacketStreamer *streamer,
                     FNET_IServerAdapter *serverAdapter,
                     vespalib::SocketHandle socket,
-                    const char *spec);
+                    const char *spec,
+                    bool local = false);
 
     /**
      * Construct a connection in client aspect.
@@ -517,5 +531,15 @@ public:
      */
     uint32_t getInputBufferSize() const { return _input.GetBufSize(); }
 
+    /**
+     * Take a snapshot of the output queue and traffic counters of
+     * this connection. NOTE: this method should only be called by the
+     * transport thread.
+     *
+     * @return connection statistics
+     * @param now current time, used to calculate the output stall time
+     **/
+    FNET_ConnectionStats get_stats(std::chrono::steady_clock::time_point now);
+
 };
 
@@ -16,15 +16,26 @@ FNET_Connector::FNET_Connector(FNET_TransportThread *owner,
                                FNET_IPacketStreamer *streamer,
                                FNET_IServerAdapter *serverAdapter,
                                const char *spec,
-                               vespalib::ServerSocket server_socket)
+                               vespalib::ServerSocket server_socket,
+                               bool local)
     : FNET_IOComponent(owner, server_socket.get_fd(), spec, /* time-out = */ false),
       _streamer(streamer),
       _serverAdapter(serverAdapter),
-      _server_socket(std::move(server_socket))
+      _server_socket(std::move(server_socket)),
+      _local(local),
+      _local_connector(nullptr)
 {
 }
 
 
+FNET_Connector::~FNET_Connector()
+{
+    if (_local_connector != nullptr) {
+        _local_connector->SubRef();
+    }
+}
+
+
 uint32_t
 FNET_Connector::GetPortNumber() const {
     return _server_socket.address().port();
@@ -37,6 +48,12 @@ FNET_Connector::Close()
     detach_selector();
     _ioc_socket_fd = -1;
     _server_socket = vespalib::ServerSocket();
+    if (_local_connector != nullptr) {
+        // served by the same transport thread as this connector
+        _local_connector->Close();
+        _local_connector->SubRef();
+        _local_connector = nullptr;
+    }
 }
 
 
@@ -48,7 +65,7 @@ FNET_Connector::HandleReadEvent()
         FNET_Transport &transport = Owner()->owner();
         FNET_TransportThread *thread = transport.select_thread(&handle, sizeof(handle));
         if (thread->tune(handle)) {
-            std::unique_ptr<FNET_Connection> conn = std::make_unique<FNET_Connection>(thread, _streamer, _serverAdapter, std::move(handle), GetSpec());
+            std::unique_ptr<FNET_Connection> conn = std::make_unique<FNET_Connection>(thread, _streamer, _serverAdapter, std::move(handle), GetSpec(), _local);
             if (conn->Init()) {
                 thread->Add(conn.release(), /*needRef = */ false);
             } else {
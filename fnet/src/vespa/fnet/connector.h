@@ -18,6 +18,8 @@ private:
     FNET_IPacketStreamer  *_streamer;
     FNET_IServerAdapter   *_serverAdapter;
     vespalib::ServerSocket _server_socket;
+    bool                   _local;
+    FNET_Connector        *_local_connector;
 
     FNET_Connector(const FNET_Connector &);
     FNET_Connector &operator=(const FNET_Connector &);
@@ -31,12 +33,26 @@ public:
      * @param serverAdapter object for custom channel creation
      * @param spec listen spec for this connector
      * @param server_socket the underlying server socket
+     * @param local whether this connector accepts connections
+     *              through the local transport
      **/
     FNET_Connector(FNET_TransportThread *owner,
                    FNET_IPacketStreamer *streamer,
                    FNET_IServerAdapter *serverAdapter,
                    const char *spec,
-                   vespalib::ServerSocket server_socket);
+                   vespalib::ServerSocket server_socket,
+                   bool local = false);
+    ~FNET_Connector();
+
+    /**
+     * Attach the connector listening for local transport connections
+     * on behalf of this connector. It is closed together with this
+     * connector. The connector takes over a reference to it. Both
+     * connectors must be served by the same transport thread.
+     *
+     * @param local connector for the local transport
+     **/
+    void SetLocalConnector(FNET_Connector *local) { _local_connector = local; }
 
     /**
      * Obtain the port number of the underlying server socket.
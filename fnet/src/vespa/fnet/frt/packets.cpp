@@ -4,6 +4,7 @@
 #include "rpcrequest.h"
 #include <vespa/fnet/info.h>
 #include <vespa/fnet/databuffer.h>
+#include <vespa/fnet/gatheroutput.h>
 #include <vespa/vespalib/util/stringfmt.h>
 
 
@@ -38,6 +39,27 @@ FRT_RPCRequestPacket::GetLength()
 
 void
 FRT_RPCRequestPacket::Encode(FNET_DataBuffer *dst)
+{
+    DoEncode(dst, nullptr);
+}
+
+
+uint32_t
+FRT_RPCRequestPacket::GetRefLength()
+{
+    return _req->GetParams()->GetRefLength();
+}
+
+
+void
+FRT_RPCRequestPacket::EncodeGather(FNET_GatherOutput &dst)
+{
+    DoEncode(&dst.GetBuffer(), &dst);
+}
+
+
+void
+FRT_RPCRequestPacket::DoEncode(FNET_DataBuffer *dst, FNET_GatherOutput *refs)
 {
     uint32_t packet_endian = ((_flags & FLAG_FRT_RPC_LITTLE_ENDIAN) != 0)
                              ? FNET_Info::ENDIAN_LITTLE : FNET_Info::ENDIAN_BIG;
@@ -48,13 +70,13 @@ FRT_RPCRequestPacket::Encode(FNET_DataBuffer *dst)
         dst->WriteBytesFast(&tmp, sizeof(tmp));
         dst->WriteBytesFast(_req->GetMethodName(),
                             _req->GetMethodNameLen());
-        _req->GetParams()->EncodeCopy(dst);
+        _req->GetParams()->EncodeCopy(dst, refs);
     } else {
         assert(packet_endian == FNET_Info::ENDIAN_BIG);
         dst->WriteInt32Fast(_req->GetMethodNameLen());
         dst->WriteBytesFast(_req->GetMethodName(),
                             _req->GetMethodNameLen());
-        _req->GetParams()->EncodeBig(dst);
+        _req->GetParams()->EncodeBig(dst, refs);
     }
 }
 
@@ -120,16 +142,37 @@ FRT_RPCReplyPacket::GetLength()
 
 void
 FRT_RPCReplyPacket::Encode(FNET_DataBuffer *dst)
+{
+    DoEncode(dst, nullptr);
+}
+
+
+uint32_t
+FRT_RPCReplyPacket::GetRefLength()
+{
+    return _req->GetReturn()->GetRefLength();
+}
+
+
+void
+FRT_RPCReplyPacket::EncodeGather(FNET_GatherOutput &dst)
+{
+    DoEncode(&dst.GetBuffer(), &dst);
+}
+
+
+void
+FRT_RPCReplyPacket::DoEncode(FNET_DataBuffer *dst, FNET_GatherOutput *refs)
 {
     uint32_t packet_endian = ((_flags & FLAG_FRT_RPC_LITTLE_ENDIAN) != 0)
                              ? FNET_Info::ENDIAN_LITTLE : FNET_Info::ENDIAN_BIG;
     uint32_t host_endian = FNET_Info::GetEndian();
 
     if (packet_endian == host_endian) {
-        _req->GetReturn()->EncodeCopy(dst);
+        _req->GetReturn()->EncodeCopy(dst, refs);
     } else {
         assert(packet_endian == FNET_Info::ENDIAN_BIG);
-        _req->GetReturn()->EncodeBig(dst);
+        _req->GetReturn()->EncodeBig(dst, refs);
     }
 }
 
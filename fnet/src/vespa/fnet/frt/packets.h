@@ -51,6 +51,9 @@ public:
 
 class FRT_RPCRequestPacket : public FRT_RPCPacket
 {
+private:
+    void DoEncode(FNET_DataBuffer *dst, FNET_GatherOutput *refs);
+
 public:
     FRT_RPCRequestPacket(FRT_RPCRequest *req,
                          uint32_t flags,
@@ -60,6 +63,8 @@ public:
     uint32_t GetPCODE() override;
     uint32_t GetLength() override;
     void Encode(FNET_DataBuffer *dst) override;
+    uint32_t GetRefLength() override;
+    void EncodeGather(FNET_GatherOutput &dst) override;
     bool Decode(FNET_DataBuffer *src, uint32_t len) override;
     vespalib::string Print(uint32_t indent = 0) override;
 };
@@ -67,6 +72,9 @@ public:
 
 class FRT_RPCReplyPacket : public FRT_RPCPacket
 {
+private:
+    void DoEncode(FNET_DataBuffer *dst, FNET_GatherOutput *refs);
+
 public:
     FRT_RPCReplyPacket(FRT_RPCRequest *req,
                        uint32_t flags,
@@ -76,6 +84,8 @@ public:
     uint32_t GetPCODE() override;
     uint32_t GetLength() override;
     void Encode(FNET_DataBuffer *dst) override;
+    uint32_t GetRefLength() override;
+    void EncodeGather(FNET_GatherOutput &dst) override;
     bool Decode(FNET_DataBuffer *src, uint32_t len) override;
     vespalib::string Print(uint32_t indent = 0) override;
 };
@@ -2,6 +2,7 @@
 
 #include "values.h"
 #include <vespa/fnet/databuffer.h>
+#include <vespa/fnet/gatheroutput.h>
 #include <vespa/vespalib/util/stringfmt.h>
 #include <cassert>
 
@@ -11,6 +12,22 @@ static_assert(sizeof(double)  == sizeof(uint64_t), "double must be same size as
 
 constexpr size_t SHARED_LIMIT = 1024;
 
+namespace {
+
+bool isRef(uint32_t len) {
+    return (len >= FNET_GatherOutput::MIN_REF_SIZE);
+}
+
+void writeData(FNET_DataBuffer *dst, FNET_GatherOutput *refs, const char *buf, uint32_t len) {
+    if ((refs != nullptr) && isRef(len)) {
+        refs->AddRef(buf, len);
+    } else {
+        dst->WriteBytesFast(buf, len);
+    }
+}
+
+}
+
 namespace fnet {
 
 char * copyString(char *dst, const char *src, size_t len) {
@@ -1222,8 +1239,30 @@ error:
 }
 
 
+uint32_t
+FRT_Values::GetRefLength()
+{
+    uint32_t len = 0;
+    for (uint32_t i = 0; i < _numValues; i++) {
+        if (_typeString[i] == FRT_VALUE_DATA) {
+            if (isRef(_values[i]._data._len)) {
+                len += _values[i]._data._len;
+            }
+        } else if (_typeString[i] == FRT_VALUE_DATA_ARRAY) {
+            const FRT_DataValue *pt = _values[i]._data_array._pt;
+            for (uint32_t j = 0; j < _values[i]._data_array._len; j++) {
+                if (isRef(pt[j]._len)) {
+                    len += pt[j]._len;
+                }
+            }
+        }
+    }
+    return len;
+}
+
+
 void
-FRT_Values::EncodeCopy(FNET_DataBuffer *dst)
+FRT_Values::EncodeCopy(FNET_DataBuffer *dst, FNET_GatherOutput *refs)
 {
     uint32_t numValues = _numValues;
     const char *p = _typeString;
@@ -1340,8 +1379,8 @@ FRT_Values::EncodeCopy(FNET_DataBuffer *dst)
 
         case FRT_VALUE_DATA:
             dst->WriteBytesFast(&(_values[i]._data._len), sizeof(uint32_t));
-            dst->WriteBytesFast(_values[i]._data._buf,
-                                _values[i]._data._len);
+            writeData(dst, refs, _values[i]._data._buf,
+                      _values[i]._data._len);
             break;
 
         case FRT_VALUE_DATA_ARRAY:
@@ -1352,7 +1391,7 @@ FRT_Values::EncodeCopy(FNET_DataBuffer *dst)
             dst->WriteBytesFast(&len, sizeof(len));
             for (; len > 0; len--, pt++) {
                 dst->WriteBytesFast(&(pt->_len), sizeof(uint32_t));
-                dst->WriteBytesFast(pt->_buf, pt->_len);
+                writeData(dst, refs, pt->_buf, pt->_len);
             }
         }
         break;
@@ -1365,7 +1404,7 @@ FRT_Values::EncodeCopy(FNET_DataBuffer *dst)
 
 
 void
-FRT_Values::EncodeBig(FNET_DataBuffer *dst)
+FRT_Values::EncodeBig(FNET_DataBuffer *dst, FNET_GatherOutput *refs)
 {
     uint32_t numValues = _numValues;
     const char *p = _typeString;
@@ -1487,8 +1526,8 @@ FRT_Values::EncodeBig(FNET_DataBuffer *dst)
 
         case FRT_VALUE_DATA:
             dst->WriteInt32Fast(_values[i]._data._len);
-            dst->WriteBytesFast(_values[i]._data._buf,
-                                _values[i]._data._len);
+            writeData(dst, refs, _values[i]._data._buf,
+                      _values[i]._data._len);
             break;
 
         case FRT_VALUE_DATA_ARRAY:
@@ -1499,7 +1538,7 @@ FRT_Values::EncodeBig(FNET_DataBuffer *dst)
             dst->WriteInt32Fast(len);
             for (; len > 0; len--, pt++) {
                 dst->WriteInt32Fast(pt->_len);
-                dst->WriteBytesFast(pt->_buf, pt->_len);
+                writeData(dst, refs, pt->_buf, pt->_len);
             }
         }
         break;
@@ -12,6 +12,7 @@ namespace fnet {
     struct BlobRef;
 }
 class FNET_DataBuffer;
+class FNET_GatherOutput;
 
 template <typename T>
 struct FRT_Array {
@@ -237,8 +238,9 @@ public:
     bool DecodeCopy(FNET_DataBuffer *dst, uint32_t len);
     bool DecodeBig(FNET_DataBuffer *dst, uint32_t len);
     bool DecodeLittle(FNET_DataBuffer *dst, uint32_t len);
-    void EncodeCopy(FNET_DataBuffer *dst);
-    void EncodeBig(FNET_DataBuffer *dst);
+    uint32_t GetRefLength();
+    void EncodeCopy(FNET_DataBuffer *dst, FNET_GatherOutput *refs = nullptr);
+    void EncodeBig(FNET_DataBuffer *dst, FNET_GatherOutput *refs = nullptr);
     bool Equals(FRT_Values *values);
     static void Print(FRT_Value value, uint32_t type, uint32_t indent = 0);
     static bool Equals(FRT_Value a, FRT_Value b, uint32_t type);
@@ -0,0 +1,142 @@
+// Copyright 2019 Oath Inc. Licensed under the terms of the Apache 2.0 license. See LICENSE in the project root.
+
+#include "gatheroutput.h"
+#include "databuffer.h"
+#include "packet.h"
+#include <vespa/vespalib/net/crypto_socket.h>
+#include <algorithm>
+#include <cassert>
+#include <sys/uio.h>
+
+void
+FNET_GatherOutput::addBufferedBytes()
+{
+    uint32_t len = _buf.GetDataLen() - _bufLen;
+    if (len == 0) {
+        return;
+    }
+    if (!_segments.empty() && (_segments.back().ref == nullptr) && (_segments.back().packet == nullptr)) {
+        _segments.back().len += len;
+    } else {
+        _segments.push_back(Segment{nullptr, len, nullptr});
+    }
+    _bufLen += len;
+    _dataLen += len;
+}
+
+
+void
+FNET_GatherOutput::consume(size_t len)
+{
+    while (len > 0) {
+        assert(!_segments.empty());
+        Segment &seg = _segments.front();
+        uint32_t n = std::min(size_t(seg.len), len);
+        if (seg.ref != nullptr) {
+            seg.ref += n;
+        } else {
+            _buf.DataToDead(n);
+            _bufLen -= n;
+        }
+        seg.len -= n;
+        _dataLen -= n;
+        len -= n;
+        if (seg.len == 0) {
+            if (seg.packet != nullptr) {
+                seg.packet->Free();
+            }
+            _segments.pop_front();
+        }
+    }
+    _buf.resetIfEmpty();
+}
+
+
+FNET_GatherOutput::FNET_GatherOutput(FNET_DataBuffer &buf)
+    : _buf(buf),
+      _segments(),
+      _bufLen(0),
+      _dataLen(0),
+      _hasRefs(false)
+{
+}
+
+
+FNET_GatherOutput::~FNET_GatherOutput()
+{
+    Discard();
+}
+
+
+void
+FNET_GatherOutput::AddRef(const void *data, uint32_t len)
+{
+    if (len < MIN_REF_SIZE) {
+        _buf.WriteBytes(data, len);
+        return;
+    }
+    addBufferedBytes();
+    _segments.push_back(Segment{static_cast<const char *>(data), len, nullptr});
+    _dataLen += len;
+    _hasRefs = true;
+}
+
+
+void
+FNET_GatherOutput::EndPacket(FNET_Packet *packet)
+{
+    addBufferedBytes();
+    if (_hasRefs) {
+        assert(_segments.back().packet == nullptr);
+        _segments.back().packet = packet;
+        _hasRefs = false;
+    } else {
+        packet->Free();
+    }
+}
+
+
+ssize_t
+FNET_GatherOutput::Write(vespalib::CryptoSocket &socket)
+{
+    struct iovec iov[MAX_IOV];
+    int cnt = 0;
+    const char *bufPos = _buf.GetData();
+    for (const Segment &seg : _segments) {
+        if (cnt == MAX_IOV) {
+            break;
+        }
+        if (seg.ref != nullptr) {
+            iov[cnt].iov_base = const_cast<char *>(seg.ref);
+        } else {
+            iov[cnt].iov_base = const_cast<char *>(bufPos);
+            bufPos += seg.len;
+        }
+        iov[cnt].iov_len = seg.len;
+        ++cnt;
+    }
+    ssize_t res = (cnt == 1)
+                  ? socket.write(static_cast<const char *>(iov[0].iov_base), iov[0].iov_len)
+                  : socket.writev(iov, cnt);
+    if (res > 0) {
+        consume(res);
+    }
+    return res;
+}
+
+
+void
+FNET_GatherOutput::Discard()
+{
+    for (const Segment &seg : _segments) {
+        if (seg.packet != nullptr) {
+            seg.packet->Free();
+        }
+    }
+    _segments.clear();
+    _buf.DataToDead(_bufLen);
+    _buf.resetIfEmpty();
+    _bufLen = 0;
+    _dataLen = 0;
+    _hasRefs = false;
+}
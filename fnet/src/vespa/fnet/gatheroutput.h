@@ -0,0 +1,111 @@
+// Copyright 2019 Oath Inc. Licensed under the terms of the Apache 2.0 license. See LICENSE in the project root.
+
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <sys/types.h>
+
+class FNET_DataBuffer;
+class FNET_Packet;
+
+namespace vespalib { struct CryptoSocket; }
+
+/**
+ * The pending output of a connection. Packets are encoded into a
+ * DataBuffer, but large payloads may be referenced in place instead
+ * of being copied. The output is written to the socket with a single
+ * gathering write covering both the buffered bytes and the
+ * referenced data. A packet referencing data is kept alive (not
+ * freed) until all its bytes have been written.
+ **/
+class FNET_GatherOutput
+{
+public:
+    /**
+     * Payloads smaller than this are copied into the output buffer
+     * rather than referenced.
+     **/
+    static constexpr uint32_t MIN_REF_SIZE = 8192;
+
+    /**
+     * Maximum number of buffers handed to a single gathering write.
+     **/
+    static constexpr uint32_t MAX_IOV = 64;
+
+private:
+    struct Segment {
+        const char  *ref;    // nullptr for bytes located in the output buffer
+        uint32_t     len;
+        FNET_Packet *packet; // packet to free when this segment is written
+    };
+
+    FNET_DataBuffer     &_buf;
+    std::deque<Segment>  _segments;
+    uint32_t             _bufLen;   // bytes in _buf covered by segments
+    size_t               _dataLen;  // total bytes covered by segments
+    bool                 _hasRefs;  // current packet has referenced data
+
+    void addBufferedBytes();
+    void consume(size_t len);
+
+public:
+    FNET_GatherOutput(const FNET_GatherOutput &) = delete;
+    FNET_GatherOutput &operator=(const FNET_GatherOutput &) = delete;
+
+    /**
+     * @param buf the buffer packets are encoded into. It must not be
+     *            touched by anyone else.
+     **/
+    FNET_GatherOutput(FNET_DataBuffer &buf);
+
+    /**
+     * Frees any packets still being held.
+     **/
+    ~FNET_GatherOutput();
+
+    /**
+     * @return the buffer packets are encoded into
+     **/
+    FNET_DataBuffer &GetBuffer() { return _buf; }
+
+    /**
+     * Add data to the output at the current position, after the
+     * bytes encoded into the buffer so far. Large data is referenced
+     * and must stay valid until the packet being encoded is freed;
+     * smaller data is copied into the buffer.
+     *
+     * @param data the data to add
+     * @param len number of bytes
+     **/
+    void AddRef(const void *data, uint32_t len);
+
+    /**
+     * Complete the encoding of a packet. The packet is freed
+     * immediately if no data was referenced while encoding it,
+     * otherwise it is freed when its bytes have been written.
+     *
+     * @param packet the packet just encoded (or skipped)
+     **/
+    void EndPacket(FNET_Packet *packet);
+
+    /**
+     * @return number of bytes waiting to be written
+     **/
+    size_t GetDataLen() const { return _dataLen; }
+
+    /**
+     * Write as much pending output as possible to the given socket
+     * with a single gathering write. The semantics of the return
+     * value are the same as for a normal socket write.
+     *
+     * @return number of bytes written or -1 on error (check errno)
+     * @param socket the socket to write to
+     **/
+    ssize_t Write(vespalib::CryptoSocket &socket);
+
+    /**
+     * Drop all pending output, freeing any packets being held.
+     **/
+    void Discard();
+};
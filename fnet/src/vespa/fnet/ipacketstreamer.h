@@ -3,6 +3,7 @@
 #pragma once
 
 #include "context.h"
+#include "gatheroutput.h"
 
 class FNET_DataBuffer;
 class FNET_Packet;
@@ -81,5 +82,24 @@ public:
      **/
     virtual void Encode(FNET_Packet *packet, uint32_t chid,
                         FNET_DataBuffer *dst) = 0;
+
+
+    /**
+     * This method is called to stream a packet to the output of a
+     * connection. Streamers that are able to let the packet reference
+     * its payload instead of copying it should override this method
+     * (see @ref FNET_Packet::EncodeGather). The default
+     * implementation streams the packet into the output buffer using
+     * @ref Encode.
+     *
+     * @param packet the packet to stream
+     * @param chid channel id for packet
+     * @param dst the target output
+     **/
+    virtual void EncodeGather(FNET_Packet *packet, uint32_t chid,
+                              FNET_GatherOutput &dst)
+    {
+        Encode(packet, chid, &dst.GetBuffer());
+    }
 };
 
@@ -1,8 +1,15 @@
 // Copyright 2017 Yahoo Holdings. Licensed under the terms of the Apache 2.0 license. See LICENSE in the project root.
 
 #include "packet.h"
+#include "gatheroutput.h"
 #include <vespa/vespalib/util/stringfmt.h>
 
+void
+FNET_Packet::EncodeGather(FNET_GatherOutput &dst)
+{
+    Encode(&dst.GetBuffer());
+}
+
 vespalib::string
 FNET_Packet::Print(uint32_t indent)
 {
@@ -5,6 +5,7 @@
 #include <vespa/vespalib/stllike/string.h>
 
 class FNET_DataBuffer;
+class FNET_GatherOutput;
 
 /**
  * This is a general superclass of all packets. Packets are used to
@@ -136,6 +137,27 @@ public:
     virtual void Encode(FNET_DataBuffer *dst) = 0;
 
 
+    /**
+     * @return number of encoded bytes that @ref EncodeGather will
+     *         reference rather than copy into the output buffer
+     **/
+    virtual uint32_t GetRefLength() { return 0; }
+
+
+    /**
+     * Encode this packet into the output of a connection. Packets
+     * with large payloads may override this method to let the output
+     * reference their data instead of copying it (see @ref
+     * FNET_GatherOutput::AddRef). Such packets are not freed until
+     * their data has been written. The output buffer will have room
+     * for the packet length minus the reference length. The default
+     * implementation copies the entire packet using @ref Encode.
+     *
+     * @param dst the target output
+     **/
+    virtual void EncodeGather(FNET_GatherOutput &dst);
+
+
     /**
      * Decode data from the given DataBuffer and store that information
      * in this object. This method may only be called on regular
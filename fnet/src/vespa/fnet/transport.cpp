@@ -3,6 +3,8 @@
 #include "transport.h"
 #include "transport_thread.h"
 #include "iocomponent.h"
+#include <vespa/vespalib/net/shm_crypto_socket.h>
+#include <vespa/vespalib/util/stringfmt.h>
 #include <chrono>
 #include <xxhash.h>
 
@@ -24,15 +26,18 @@ VESPA_THREAD_STACK_TAG(fnet_work_pool);
 
 } // namespace <unnamed>
 
-FNET_Transport::FNET_Transport(vespalib::AsyncResolver::SP resolver, vespalib::CryptoEngine::SP crypto, size_t num_threads)
+FNET_Transport::FNET_Transport(vespalib::AsyncResolver::SP resolver, vespalib::CryptoEngine::SP crypto, size_t num_threads,
+                               const FNET_Config &config)
     : _async_resolver(std::move(resolver)),
       _crypto_engine(std::move(crypto)),
+      _local_transport_allowed(vespalib::ShmCryptoSocket::is_supported() &&
+                               (dynamic_cast<vespalib::NullCryptoEngine *>(_crypto_engine.get()) != nullptr)),
       _work_pool(1, 128 * 1024, fnet_work_pool, 1024),
       _threads()
 {
     assert(num_threads >= 1);
     for (size_t i = 0; i < num_threads; ++i) {
-        _threads.emplace_back(new FNET_TransportThread(*this));
+        _threads.emplace_back(new FNET_TransportThread(*this, config));
     }
 }
 
@@ -63,6 +68,21 @@ FNET_Transport::create_crypto_socket(vespalib::SocketHandle socket, bool is_serv
     return _crypto_engine->create_crypto_socket(std::move(socket), is_server);
 }
 
+vespalib::CryptoSocket::UP
+FNET_Transport::create_local_crypto_socket(vespalib::SocketHandle socket, bool is_server)
+{
+    assert(_local_transport_allowed);
+    return is_server
+        ? vespalib::ShmCryptoSocket::create_server(std::move(socket))
+        : vespalib::ShmCryptoSocket::create_client(std::move(socket));
+}
+
+vespalib::SocketSpec
+FNET_Transport::local_spec(int port)
+{
+    return vespalib::SocketSpec::from_name(vespalib::make_string("vespa-fnet-local-%d", port));
+}
+
 FNET_TransportThread *
 FNET_Transport::select_thread(const void *key, size_t key_len) const
 {
@@ -131,6 +151,40 @@ FNET_Transport::SetTCPNoDelay(bool noDelay)
     }
 }
 
+void
+FNET_Transport::SetLocalTransport(bool enabled)
+{
+    for (const auto &thread: _threads) {
+        thread->SetLocalTransport(enabled);
+    }
+}
+
+void
+FNET_Transport::SetSlowConsumerLimit(uint32_t bytes)
+{
+    for (const auto &thread: _threads) {
+        thread->SetSlowConsumerLimit(bytes);
+    }
+}
+
+void
+FNET_Transport::SetShedSlowConsumers(bool shed)
+{
+    for (const auto &thread: _threads) {
+        thread->SetShedSlowConsumers(shed);
+    }
+}
+
+FNET_TransportStats
+FNET_Transport::get_stats(bool include_connections)
+{
+    FNET_TransportStats stats;
+    for (const auto &thread: _threads) {
+        stats.merge(thread->get_stats(include_connections));
+    }
+    return stats;
+}
+
 void
 FNET_Transport::sync()
 {
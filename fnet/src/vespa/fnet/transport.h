@@ -2,11 +2,15 @@
 
 #pragma once
 
+#include "config.h"
 #include "context.h"
+#include "transport_stats.h"
 #include <memory>
 #include <vector>
 #include <vespa/vespalib/net/async_resolver.h>
 #include <vespa/vespalib/net/crypto_engine.h>
+#include <vespa/vespalib/net/selector.h>
+#include <vespa/vespalib/net/socket_spec.h>
 #include <vespa/vespalib/util/threadstackexecutor.h>
 
 class FastOS_TimeInterface;
@@ -31,6 +35,7 @@ private:
 
     vespalib::AsyncResolver::SP _async_resolver;
     vespalib::CryptoEngine::SP _crypto_engine;
+    bool _local_transport_allowed;
     vespalib::ThreadStackExecutor _work_pool;
     Threads _threads;
 
@@ -40,9 +45,14 @@ public:
      * transport object you need to call either the Start method to
      * spawn a new thread(s) to handle IO, or the Main method to let
      * the current thread become the transport thread. Main may only
-     * be called for single-threaded transports.
+     * be called for single-threaded transports. All transport threads
+     * start out with the given config. Its selector backend decides
+     * how the transport threads wait for io events, and can only be
+     * chosen here; io_uring falls back to epoll when not supported by
+     * the kernel.
      **/
-    FNET_Transport(vespalib::AsyncResolver::SP resolver, vespalib::CryptoEngine::SP crypto, size_t num_threads);
+    FNET_Transport(vespalib::AsyncResolver::SP resolver, vespalib::CryptoEngine::SP crypto, size_t num_threads,
+                   const FNET_Config &config = FNET_Config());
 
     FNET_Transport(vespalib::AsyncResolver::SP resolver, size_t num_threads)
         : FNET_Transport(std::move(resolver), vespalib::CryptoEngine::get_default(), num_threads) {}
@@ -92,6 +102,30 @@ public:
      **/
     vespalib::CryptoSocket::UP create_crypto_socket(vespalib::SocketHandle socket, bool is_server);
 
+    /**
+     * Wrap a unix domain socket connected through the local
+     * transport in a CryptoSocket passing data through shared
+     * memory. The local transport is only allowed on platforms
+     * supporting sealed shared memory and when the CryptoEngine used
+     * by this Transport does not encrypt data.
+     *
+     * @return socket abstraction passing data through shared memory
+     * @param socket low-level unix domain socket
+     * @param is_server which end of the connection the socket represents
+     **/
+    vespalib::CryptoSocket::UP create_local_crypto_socket(vespalib::SocketHandle socket, bool is_server);
+    bool local_transport_allowed() const { return _local_transport_allowed; }
+
+    /**
+     * The spec of the unix domain socket a server listening on the
+     * given tcp port on the wildcard or loopback address also listens
+     * on when the local transport is enabled.
+     *
+     * @return local transport spec
+     * @param port tcp port
+     **/
+    static vespalib::SocketSpec local_spec(int port);
+
     /**
      * Select one of the underlying transport threads. The selection
      * is based on hashing the given key as well as the current stack
@@ -208,6 +242,56 @@ public:
      **/
     void SetTCPNoDelay(bool noDelay);
 
+    /**
+     * Enable or disable the local transport used between processes
+     * on the same host. When enabled, servers listening on a tcp
+     * port also listen on a unix domain socket named after the port,
+     * and connections to a spec resolving to a loopback address try
+     * that socket before falling back to tcp. Application data on
+     * such connections is passed through shared memory ring buffers.
+     * Both ends check that the peer runs as the same user, and a
+     * client falls back to tcp when it does not. Enabled by default,
+     * and only used on Linux when this transport does not encrypt
+     * data. Must be set before listening or connecting.
+     *
+     * @param enabled true if the local transport should be used.
+     **/
+    void SetLocalTransport(bool enabled);
+
+    /**
+     * Set the number of bytes that may be queued for output on a
+     * single connection before its peer is considered a slow
+     * consumer. A warning is logged each time a connection goes
+     * above the limit, and the connection is not flagged again until
+     * its queue has been drained to half the limit. A connection
+     * that is flagged may also be closed, see SetShedSlowConsumers.
+     *
+     * @param bytes output queue limit in bytes. 0 means unlimited,
+     *              which is the default.
+     **/
+    void SetSlowConsumerLimit(uint32_t bytes);
+
+    /**
+     * Close connections as soon as they are flagged as slow
+     * consumers, dropping everything queued for output on them. This
+     * protects the process from peers that do not read what they are
+     * sent. Disabled by default.
+     *
+     * @param shed true if slow consumers should be closed.
+     **/
+    void SetShedSlowConsumers(bool shed);
+
+    /**
+     * Obtain statistics for all connections served by this
+     * transport. Each transport thread takes a snapshot of its own
+     * connections; this method blocks until all of them are done and
+     * should not be called from a transport thread.
+     *
+     * @return transport statistics
+     * @param include_connections list each connection
+     **/
+    FNET_TransportStats get_stats(bool include_connections = false);
+
     /**
      * Synchronize with all transport threads. This method will block
      * until all events posted before this method was invoked has been
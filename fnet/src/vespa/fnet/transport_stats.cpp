@@ -0,0 +1,76 @@
+// Copyright 2019 Oath Inc. Licensed under the terms of the Apache 2.0 license. See LICENSE in the project root.
+
+#include "transport_stats.h"
+#include <algorithm>
+
+FNET_ConnectionStats::FNET_ConnectionStats()
+    : spec(),
+      server(false),
+      slow_consumer(false),
+      channels(0),
+      queued_packets(0),
+      queued_bytes(0),
+      output_stall_ms(0.0),
+      bytes_read(0),
+      bytes_written(0),
+      packets_read(0),
+      packets_written(0)
+{
+}
+
+FNET_ConnectionStats::FNET_ConnectionStats(const FNET_ConnectionStats &) = default;
+FNET_ConnectionStats &FNET_ConnectionStats::operator=(const FNET_ConnectionStats &) = default;
+FNET_ConnectionStats::~FNET_ConnectionStats() = default;
+
+FNET_TransportStats::FNET_TransportStats()
+    : num_connections(0),
+      queued_packets(0),
+      queued_bytes(0),
+      max_output_stall_ms(0.0),
+      slow_consumers(0),
+      slow_consumer_events(0),
+      shed_connections(0),
+      bytes_read(0),
+      bytes_written(0),
+      packets_read(0),
+      packets_written(0),
+      connections()
+{
+}
+
+FNET_TransportStats::FNET_TransportStats(const FNET_TransportStats &) = default;
+FNET_TransportStats &FNET_TransportStats::operator=(const FNET_TransportStats &) = default;
+FNET_TransportStats::~FNET_TransportStats() = default;
+
+void
+FNET_TransportStats::add(const FNET_ConnectionStats &conn, bool keep)
+{
+    ++num_connections;
+    queued_packets += conn.queued_packets;
+    queued_bytes += conn.queued_bytes;
+    max_output_stall_ms = std::max(max_output_stall_ms, conn.output_stall_ms);
+    if (conn.slow_consumer) {
+        ++slow_consumers;
+    }
+    if (keep) {
+        connections.push_back(conn);
+    }
+}
+
+FNET_TransportStats &
+FNET_TransportStats::merge(const FNET_TransportStats &rhs)
+{
+    num_connections += rhs.num_connections;
+    queued_packets += rhs.queued_packets;
+    queued_bytes += rhs.queued_bytes;
+    max_output_stall_ms = std::max(max_output_stall_ms, rhs.max_output_stall_ms);
+    slow_consumers += rhs.slow_consumers;
+    slow_consumer_events += rhs.slow_consumer_events;
+    shed_connections += rhs.shed_connections;
+    bytes_read += rhs.bytes_read;
+    bytes_written += rhs.bytes_written;
+    packets_read += rhs.packets_read;
+    packets_written += rhs.packets_written;
+    connections.insert(connections.end(), rhs.connections.begin(), rhs.connections.end());
+    return *this;
+}
@@ -0,0 +1,83 @@
+// Copyright 2019 Oath Inc. Licensed under the terms of the Apache 2.0 license. See LICENSE in the project root.
+
+#pragma once
+
+#include <vespa/vespalib/stllike/string.h>
+#include <vector>
+#include <cstdint>
+
+/**
+ * A snapshot of a single connection, taken by its transport
+ * thread. Queued packets and bytes have been posted on the connection
+ * but not yet written to the socket. The output stall time tells how
+ * long the output queue has been non-empty without interruption; a
+ * peer that does not keep up with what it is sent will have a stall
+ * time that keeps growing. Open channels on a server connection are
+ * requests that have not been completed yet. Bytes in packets that
+ * have not been encoded for output yet are only counted when a slow
+ * consumer limit is set.
+ **/
+struct FNET_ConnectionStats
+{
+    vespalib::string spec;
+    bool             server;
+    bool             slow_consumer;
+    uint32_t         channels;
+    uint32_t         queued_packets;
+    uint64_t         queued_bytes;
+    double           output_stall_ms;
+    uint64_t         bytes_read;
+    uint64_t         bytes_written;
+    uint64_t         packets_read;
+    uint64_t         packets_written;
+
+    FNET_ConnectionStats();
+    FNET_ConnectionStats(const FNET_ConnectionStats &);
+    FNET_ConnectionStats &operator=(const FNET_ConnectionStats &);
+    ~FNET_ConnectionStats();
+};
+
+/**
+ * Statistics for a transport thread, or for all the threads of a
+ * transport. The traffic and slow consumer counters are cumulative
+ * and include connections that have since been closed. The other
+ * values sum up the current state of the open connections, which are
+ * also listed one by one if requested.
+ **/
+struct FNET_TransportStats
+{
+    uint32_t num_connections;
+    uint32_t queued_packets;
+    uint64_t queued_bytes;
+    double   max_output_stall_ms;
+    uint32_t slow_consumers;
+    uint64_t slow_consumer_events;
+    uint64_t shed_connections;
+    uint64_t bytes_read;
+    uint64_t bytes_written;
+    uint64_t packets_read;
+    uint64_t packets_written;
+    std::vector<FNET_ConnectionStats> connections;
+
+    FNET_TransportStats();
+    FNET_TransportStats(const FNET_TransportStats &);
+    FNET_TransportStats &operator=(const FNET_TransportStats &);
+    ~FNET_TransportStats();
+
+    /**
+     * Add the state of a single connection to these statistics.
+     *
+     * @param conn connection snapshot
+     * @param keep also list the connection itself
+     **/
+    void add(const FNET_ConnectionStats &conn, bool keep);
+
+    /**
+     * Add the given statistics to these, used to aggregate over
+     * transport threads.
+     *
+     * @return this object
+     * @param rhs statistics for another transport thread
+     **/
+    FNET_TransportStats &merge(const FNET_TransportStats &rhs);
+};
@@ -31,6 +31,20 @@ struct Sync : public FNET_IExecutable
 
 } // namespace<unnamed>
 
+struct FNET_TransportThread::StatsCollector : public FNET_IExecutable
+{
+    FNET_TransportThread &thread;
+    bool                  include_connections;
+    FNET_TransportStats   stats;
+    vespalib::Gate        gate;
+    StatsCollector(FNET_TransportThread &thread_in, bool include_connections_in)
+        : thread(thread_in), include_connections(include_connections_in), stats(), gate() {}
+    void execute() override {
+        thread.collect_stats(stats, include_connections);
+        gate.countDown();
+    }
+};
+
 void
 FNET_TransportThread::AddComponent(FNET_IOComponent *comp)
 {
@@ -207,18 +221,18 @@ extern "C" {
 
 } // extern "C"
 
-FNET_TransportThread::FNET_TransportThread(FNET_Transport &owner_in)
+FNET_TransportThread::FNET_TransportThread(FNET_Transport &owner_in, const FNET_Config &config)
     : _owner(owner_in),
       _startTime(),
       _now(),
       _scheduler(&_now),
-      _config(),
+      _config(config),
       _componentsHead(nullptr),
       _timeOutHead(nullptr),
       _componentsTail(nullptr),
       _componentCnt(0),
       _deleteList(nullptr),
-      _selector(),
+      _selector(config._selectorBackend),
       _queue(),
       _myQueue(),
       _lock(),
@@ -228,10 +242,16 @@ FNET_TransportThread::FNET_TransportThread(FNET_Transport &owner_in)
       _shutdown(false),
       _finished(false),
       _waitFinished(false),
-      _deleted(false)
+      _deleted(false),
+      _ioStats(),
+      _slowConsumerEvents(0),
+      _shedConnections(0)
 {
     _now.SetNow();
     trapsigpipe();
+    if ((config._selectorBackend == vespalib::SelectorBackend::IO_URING) && !_selector.uses_io_uring()) {
+        LOG(info, "io_uring is not supported by the kernel, transport thread uses epoll");
+    }
 }
 
 
@@ -265,7 +285,20 @@ FNET_TransportThread::Listen(const char *spec, FNET_IPacketStreamer *streamer,
 {
     ServerSocket server_socket{SocketSpec(spec)};
     if (server_socket.valid() && server_socket.set_blocking(false)) {
+        vespalib::SocketAddress address = server_socket.address();
         FNET_Connector *connector = new FNET_Connector(this, streamer, serverAdapter, spec, std::move(server_socket));
+        if (_config._localTransport && owner().local_transport_allowed() &&
+            (address.is_wildcard() || address.is_loopback()))
+        {
+            ServerSocket local_socket{FNET_Transport::local_spec(address.port())};
+            if (local_socket.valid() && local_socket.set_blocking(false)) {
+                FNET_Connector *local = new FNET_Connector(this, streamer, serverAdapter, spec, std::move(local_socket), true);
+                local->EnableReadEvent(true);
+                local->AddRef_NoLock();
+                Add(local, /* needRef = */ false);
+                connector->SetLocalConnector(local);
+            }
+        }
         connector->EnableReadEvent(true);
         connector->AddRef_NoLock();
         Add(connector, /* needRef = */ false);
@@ -373,6 +406,40 @@ FNET_TransportThread::execute(FNET_IExecutable *exe)
 }
 
 
+void
+FNET_TransportThread::collect_stats(FNET_TransportStats &stats, bool include_connections)
+{
+    stats.bytes_read = _ioStats.bytes_read;
+    stats.bytes_written = _ioStats.bytes_written;
+    stats.packets_read = _ioStats.packets_read;
+    stats.packets_written = _ioStats.packets_written;
+    stats.slow_consumer_events = _slowConsumerEvents.load(std::memory_order_relaxed);
+    stats.shed_connections = _shedConnections.load(std::memory_order_relaxed);
+    auto now = std::chrono::steady_clock::now();
+    for (FNET_IOComponent *comp = _componentsHead; comp != nullptr; comp = comp->_ioc_next) {
+        auto *conn = dynamic_cast<FNET_Connection *>(comp);
+        if (conn != nullptr) {
+            stats.add(conn->get_stats(now), include_connections);
+        }
+    }
+}
+
+
+FNET_TransportStats
+FNET_TransportThread::get_stats(bool include_connections)
+{
+    StatsCollector collector(*this, include_connections);
+    if (execute(&collector)) {
+        collector.gate.await();
+    } else {
+        WaitFinished();
+        std::lock_guard guard(_pseudo_thread); // be the thread
+        collect_stats(collector.stats, include_connections);
+    }
+    return collector.stats;
+}
+
+
 void
 FNET_TransportThread::sync()
 {
@@ -6,6 +6,7 @@
 #include "config.h"
 #include "task.h"
 #include "packetqueue.h"
+#include "transport_stats.h"
 #include <vespa/fastos/thread.h>
 #include <vespa/fastos/time.h>
 #include <vespa/vespalib/net/socket_handle.h>
@@ -53,6 +54,11 @@ private:
     bool                     _finished;       // event loop stopped ?
     bool                     _waitFinished;   // someone is waiting for _finished
     bool                     _deleted;        // destructor called ?
+    FNET_TransportStats      _ioStats;        // traffic counters [transport thread]
+    std::atomic<uint64_t>    _slowConsumerEvents; // connections flagged as slow consumers
+    std::atomic<uint64_t>    _shedConnections;    // slow consumers closed
+
+    struct StatsCollector;
 
     FNET_TransportThread(const FNET_TransportThread &);
     FNET_TransportThread &operator=(const FNET_TransportThread &);
@@ -172,6 +178,16 @@ private:
      **/
     bool EventLoopIteration();
 
+    /**
+     * Take a snapshot of the connections served by this transport
+     * thread. This method should only be called in the transport
+     * thread.
+     *
+     * @param stats where to store the snapshot
+     * @param include_connections list each connection
+     **/
+    void collect_stats(FNET_TransportStats &stats, bool include_connections);
+
     bool IsShutDown() const noexcept {
         return _shutdown.load(std::memory_order_relaxed);
     }
@@ -184,8 +200,9 @@ public:
      * current thread become the transport thread.
      *
      * @param owner owning transport layer
+     * @param config initial config, including how to wait for io events
      **/
-    FNET_TransportThread(FNET_Transport &owner_in);
+    FNET_TransportThread(FNET_Transport &owner_in, const FNET_Config &config = FNET_Config());
 
 
     /**
@@ -322,6 +339,78 @@ public:
      **/
     void SetTCPNoDelay(bool noDelay) { _config._tcpNoDelay = noDelay; }
 
+    /**
+     * Enable or disable the local transport used between processes
+     * on the same host. See FNET_Transport::SetLocalTransport.
+     *
+     * @param enabled true if the local transport should be used.
+     **/
+    void SetLocalTransport(bool enabled) { _config._localTransport = enabled; }
+
+    /**
+     * Set the number of bytes that may be queued for output on a
+     * connection before its peer is flagged as a slow consumer. See
+     * FNET_Transport::SetSlowConsumerLimit.
+     *
+     * @param bytes output queue limit in bytes. 0 means unlimited.
+     **/
+    void SetSlowConsumerLimit(uint32_t bytes) { _config._slowConsumerLimit = bytes; }
+
+    /**
+     * Close connections when they are flagged as slow consumers. See
+     * FNET_Transport::SetShedSlowConsumers.
+     *
+     * @param shed true if slow consumers should be closed.
+     **/
+    void SetShedSlowConsumers(bool shed) { _config._shedSlowConsumers = shed; }
+
+    /**
+     * Account for data read by a connection. This method should only
+     * be called in the transport thread.
+     *
+     * @param packets number of packets read
+     * @param bytes number of bytes read
+     **/
+    void count_read(uint64_t packets, uint64_t bytes) {
+        _ioStats.packets_read += packets;
+        _ioStats.bytes_read += bytes;
+    }
+
+    /**
+     * Account for data written by a connection. This method should
+     * only be called in the transport thread.
+     *
+     * @param packets number of packets written
+     * @param bytes number of bytes written
+     **/
+    void count_written(uint64_t packets, uint64_t bytes) {
+        _ioStats.packets_written += packets;
+        _ioStats.bytes_written += bytes;
+    }
+
+    /**
+     * Account for a connection that was flagged as a slow consumer.
+     *
+     * @param shed whether the connection was closed because of it
+     **/
+    void count_slow_consumer(bool shed) {
+        _slowConsumerEvents.fetch_add(1, std::memory_order_relaxed);
+        if (shed) {
+            _shedConnections.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    /**
+     * Obtain statistics for this transport thread. The snapshot is
+     * taken by the transport thread, and this method blocks until it
+     * is done. Invoking this method from the transport thread is not
+     * a good idea.
+     *
+     * @return transport thread statistics
+     * @param include_connections list each connection
+     **/
+    FNET_TransportStats get_stats(bool include_connections);
+
 
     /**
      * Add an I/O component to the working set of this transport
@@ -0,0 +1,72 @@
+// Copyright 2019 Oath Inc. Licensed under the terms of the Apache 2.0 license. See LICENSE in the project root.
+
+#include <vespa/messagebus/messenger.h>
+#include <vespa/messagebus/testlib/simplemessage.h>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+using namespace mbus;
+
+/**
+ * A session handler that spends a little time on every message, standing
+ * in for the work done by the destination sessions of a busy node.
+ */
+class WorkHandler : public IMessageHandler {
+private:
+    std::atomic<uint64_t> &_handled;
+    uint64_t               _sum;
+
+public:
+    WorkHandler(std::atomic<uint64_t> &handled) : _handled(handled), _sum(0) {}
+
+    void handleMessage(Message::UP msg) override {
+        const string &value = static_cast<SimpleMessage &>(*msg).getValue();
+        for (uint32_t i = 0; i < 200; ++i) {
+            for (char c : value) {
+                _sum = (_sum * 31) + c + i;
+            }
+        }
+        _handled.fetch_add(1, std::memory_order_relaxed);
+    }
+};
+
+double
+benchmark(uint32_t numThreads, uint32_t numSessions, uint32_t numMessages)
+{
+    std::atomic<uint64_t> handled(0);
+    std::vector<std::unique_ptr<WorkHandler>> sessions;
+    for (uint32_t i = 0; i < numSessions; ++i) {
+        sessions.push_back(std::make_unique<WorkHandler>(handled));
+    }
+    Messenger msn(numThreads);
+    if (!msn.start()) {
+        fprintf(stderr, "could not start messenger threads\n");
+        exit(1);
+    }
+    auto start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < numMessages; ++i) {
+        msn.deliverSessionMessage(std::make_unique<SimpleMessage>("benchmark message payload"), *sessions[i % numSessions]);
+    }
+    msn.sync();
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    if (handled.load() != numMessages) {
+        fprintf(stderr, "expected %u handled messages, got %zu\n", numMessages, size_t(handled.load()));
+        exit(1);
+    }
+    return ms;
+}
+
+int
+main(int argc, char **argv)
+{
+    uint32_t numSessions = (argc > 1) ? atoi(argv[1]) : 64;
+    uint32_t numMessages = (argc > 2) ? atoi(argv[2]) : 1000000;
+    for (uint32_t numThreads : {1, 2, 4, 8}) {
+        double ms = benchmark(numThreads, numSessions, numMessages);
+        fprintf(stdout, "threads=%u sessions=%u: %u messages in %.1f ms (%.0f msg/s)\n",
+                numThreads, numSessions, numMessages, ms, (numMessages * 1000.0) / ms);
+    }
+    return 0;
+}
@@ -0,0 +1,288 @@
+// Copyright 2019 Oath Inc. Licensed under the terms of the Apache 2.0 license. See LICENSE in the project root.
+package com.yahoo.messagebus;
+
+import com.yahoo.concurrent.SystemTimer;
+import com.yahoo.concurrent.Timer;
+import com.yahoo.log.LogLevel;
+import java.util.logging.Logger;
+
+/**
+ * This is an implementation of the {@link ThrottlePolicy} that limits the number of pending messages a
+ * {@link SourceSession} is allowed to have based on the round-trip time of its messages. It keeps track of the lowest
+ * round-trip time seen, and shrinks the window in proportion to how far the current round-trip time exceeds it by
+ * more than a given tolerance. As long as the round-trip time stays within the tolerance, the window grows by the
+ * square root of its size for every sample.
+ *
+ * The round-trip time is estimated per sample using Little's law, as the time integral of the number of pending
+ * messages divided by the number of replies received during the sample. A sample ends when (at least) as many
+ * replies as the current window size have been received.
+ *
+ * The lowest round-trip time is only allowed to increase at the end of a time window, when it is reset to the lowest
+ * round-trip time seen during that window. A window lasts until both its time has passed and it holds enough
+ * samples, so a single slow sample can never become the baseline on its own.
+ *
+ * This is the Java counterpart of the C++ GradientThrottlePolicy, and the two must be kept in sync.
+ *
+ * <b>NOTE:</b> By context, "pending" is refering to the number of sent messages that have not been replied to yet.
+ */
+public class GradientThrottlePolicy extends StaticThrottlePolicy {
+
+    private static final int MIN_RTT_WINDOW_SAMPLES = 10;
+    private static final Logger log = Logger.getLogger(GradientThrottlePolicy.class.getName());
+    private final Timer timer;
+    private int numPending = 0;
+    private int numReplies = 0;
+    private int numErrors = 0;
+    private long timeOfLastEvent;
+    private double pendingTime = 0;
+    private double rtt = 0;
+    private double minRtt = 0;
+    private double windowMinRtt = 0;
+    private int numWindowSamples = 0;
+    private long minRttWindowStart;
+    private long minRttWindow = 30000;
+    private double rttTolerance = 1.5;
+    private double smoothing = 0.2;
+    private double errorBackOff = 0.9;
+    private double windowSize = 20;
+    private double maxWindowSize = Integer.MAX_VALUE;
+    private double minWindowSize = 1;
+
+    /**
+     * Constructs a new instance of this policy and sets the appropriate default values of member data.
+     */
+    public GradientThrottlePolicy() {
+        this(SystemTimer.INSTANCE);
+    }
+
+    /**
+     * Constructs a new instance of this class using the given clock to measure round-trip times.
+     *
+     * @param timer the timer to use
+     */
+    public GradientThrottlePolicy(Timer timer) {
+        this.timer = timer;
+        this.timeOfLastEvent = timer.milliTime();
+        this.minRttWindowStart = timeOfLastEvent;
+    }
+
+    @Override
+    public boolean canSend(Message message, int pendingCount) {
+        if ( ! super.canSend(message, pendingCount)) {
+            return false;
+        }
+        return pendingCount < windowSize;
+    }
+
+    @Override
+    public void processMessage(Message message) {
+        super.processMessage(message);
+        advance(timer.milliTime());
+        ++numPending;
+    }
+
+    @Override
+    public void processReply(Reply reply) {
+        super.processReply(reply);
+        advance(timer.milliTime());
+        if (numPending > 0) {
+            --numPending;
+        }
+        ++numReplies;
+        if (reply.hasErrors()) {
+            ++numErrors;
+        }
+        if (numReplies >= windowSize && pendingTime > 0) {
+            resize();
+        }
+    }
+
+    private void advance(long time) {
+        if (time > timeOfLastEvent) {
+            pendingTime += (double)numPending * (time - timeOfLastEvent);
+            timeOfLastEvent = time;
+        }
+    }
+
+    private void updateMinRtt() {
+        if (minRtt == 0 || rtt < minRtt) {
+            minRtt = rtt;
+        }
+        if (windowMinRtt == 0 || rtt < windowMinRtt) {
+            windowMinRtt = rtt;
+        }
+        ++numWindowSamples;
+        if (timeOfLastEvent - minRttWindowStart >= minRttWindow && numWindowSamples >= MIN_RTT_WINDOW_SAMPLES) {
+            minRtt = windowMinRtt;
+            windowMinRtt = 0;
+            numWindowSamples = 0;
+            minRttWindowStart = timeOfLastEvent;
+        }
+    }
+
+    private void resize() {
+        rtt = pendingTime / numReplies;
+        updateMinRtt();
+
+        double gradient = Math.max(0.5, Math.min(1.0, minRtt * rttTolerance / rtt));
+        double newSize = windowSize * gradient;
+        if (numErrors > 0) {
+            newSize *= errorBackOff;
+        } else if (gradient >= 1.0) {
+            newSize += Math.sqrt(windowSize);
+        }
+        if (gradient > 0.5) {
+            windowSize += (newSize - windowSize) * smoothing;
+        } else {
+            windowSize = newSize;
+        }
+        windowSize = Math.max(minWindowSize, windowSize);
+        windowSize = Math.min(maxWindowSize, windowSize);
+        if (log.isLoggable(LogLevel.DEBUG)) {
+            log.log(LogLevel.DEBUG, "windowSize " + windowSize + " rtt " + rtt + " minRtt " + minRtt +
+                                    " gradient " + gradient + " errors " + numErrors);
+        }
+
+        pendingTime = 0;
+        numReplies = 0;
+        numErrors = 0;
+    }
+
+    /**
+     * Sets how much the round-trip time may exceed the lowest round-trip time seen before the window shrinks. A value
+     * of 1.5 allows the time messages spend queued to be half of the lowest round-trip time. This value is capped to be
+     * at least 1.
+     *
+     * @param tolerance the tolerance to set
+     * @return this, to allow chaining
+     */
+    public GradientThrottlePolicy setRttTolerance(double tolerance) {
+        this.rttTolerance = Math.max(1, tolerance);
+        return this;
+    }
+
+    /**
+     * Sets the length in milliseconds of the time windows that the lowest round-trip time is tracked over. At the end
+     * of each window, the lowest round-trip time is reset to the lowest one seen during that window. A window is
+     * extended until it holds at least 10 samples. This value is capped to be at least 1.
+     *
+     * @param windowMillis the window to set
+     * @return this, to allow chaining
+     */
+    public GradientThrottlePolicy setMinRttWindow(long windowMillis) {
+        this.minRttWindow = Math.max(1, windowMillis);
+        return this;
+    }
+
+    /**
+     * Sets the weight given to a new window size when growing or moderately shrinking the window. The window is
+     * shrunk without smoothing when the round-trip time is more than twice the target. This value is capped to the
+     * (0, 1] range.
+     *
+     * @param smoothing the smoothing to set
+     * @return this, to allow chaining
+     */
+    public GradientThrottlePolicy setSmoothing(double smoothing) {
+        this.smoothing = Math.min(1, Math.max(0.01, smoothing));
+        return this;
+    }
+
+    /**
+     * Sets the factor the window size is multiplied with when a sample contains replies with errors. This value is
+     * capped to the [0, 1] range.
+     *
+     * @param backOff the back off to set
+     * @return this, to allow chaining
+     */
+    public GradientThrottlePolicy setErrorBackOff(double backOff) {
+        this.errorBackOff = Math.min(1, Math.max(0, backOff));
+        return this;
+    }
+
+    /**
+     * Sets the maximium number of pending operations allowed at any time, in
+     * order to avoid using too much resources.
+     *
+     * @param max the max to set
+     * @return this, to allow chaining
+     */
+    public GradientThrottlePolicy setMaxWindowSize(double max) {
+        this.maxWindowSize = max;
+        this.windowSize = Math.min(maxWindowSize, windowSize);
+        return this;
+    }
+
+    /**
+     * Get the maximum number of pending operations allowed at any time.
+     *
+     * @return the maximum number of operations
+     */
+    public double getMaxWindowSize() {
+        return maxWindowSize;
+    }
+
+    /**
+     * Sets the minimium number of pending operations allowed at any time, in
+     * order to keep a level of performance.
+     *
+     * @param min the min to set
+     * @return this, to allow chaining
+     */
+    public GradientThrottlePolicy setMinWindowSize(double min) {
+        this.minWindowSize = min;
+        this.windowSize = Math.max(minWindowSize, windowSize);
+        return this;
+    }
+
+    /**
+     * Get the minimum number of pending operations allowed at any time.
+     *
+     * @return the minimum number of operations
+     */
+    public double getMinWindowSize() {
+        return minWindowSize;
+    }
+
+    public GradientThrottlePolicy setMaxPendingCount(int maxCount) {
+        super.setMaxPendingCount(maxCount);
+        return setMaxWindowSize(maxCount);
+    }
+
+    /**
+     * Returns the current window size, before truncation to a pending count.
+     *
+     * @return the window size
+     */
+    public double getWindowSize() {
+        return windowSize;
+    }
+
+    /**
+     * Returns the round-trip time in milliseconds estimated for the last sample, or 0 if no sample has completed yet.
+     *
+     * @return the round-trip time
+     */
+    public double getRtt() {
+        return rtt;
+    }
+
+    /**
+     * Returns the lowest round-trip time in milliseconds seen since the start of the previous time window, or 0 if no
+     * sample has completed yet.
+     *
+     * @return the lowest round-trip time
+     */
+    public double getMinRtt() {
+        return minRtt;
+    }
+
+    /**
+     * Returns the maximum number of pending messages allowed.
+     *
+     * @return the max limit
+     */
+    public int getMaxPendingCount() {
+        return (int)windowSize;
+    }
+
+}
@@ -204,7 +204,107 @@ public class ThrottlerTestCase {
         assertTrue(windowSize >= 40 && windowSize <= 50);
     }
 
-    private int getWindowSize(DynamicThrottlePolicy policy, CustomTimer timer, int maxPending) {
+    @Test
+    public void testGradientWindowSize() {
+        CustomTimer timer = new CustomTimer();
+        GradientThrottlePolicy policy = new GradientThrottlePolicy(timer);
+
+        double windowSize = getWindowSize(policy, timer, 100);
+        assertTrue(windowSize >= 50 && windowSize <= 105);
+        assertEquals(1000.0, policy.getMinRtt(), 50.0);
+
+        windowSize = getWindowSize(policy, timer, 200);
+        assertTrue(windowSize >= 100 && windowSize <= 205);
+
+        windowSize = getWindowSize(policy, timer, 50);
+        assertTrue(windowSize >= 25 && windowSize <= 55);
+
+        windowSize = getWindowSize(policy, timer, 500);
+        assertTrue(windowSize >= 250 && windowSize <= 505);
+
+        windowSize = getWindowSize(policy, timer, 100);
+        assertTrue(windowSize >= 50 && windowSize <= 105);
+
+        windowSize = getWindowSize(policy, timer, 5);
+        assertTrue(windowSize >= 1 && windowSize <= 7);
+        assertEquals(1000.0, policy.getMinRtt(), 50.0);
+    }
+
+    @Test
+    public void testGradientMinMaxWindowSize() {
+        CustomTimer timer = new CustomTimer();
+        GradientThrottlePolicy policy = new GradientThrottlePolicy(timer);
+
+        policy.setMaxWindowSize(50);
+        assertEquals(50, getWindowSize(policy, timer, 100));
+
+        policy.setMaxPendingCount(15);
+        assertEquals(15, getWindowSize(policy, timer, 100));
+
+        timer = new CustomTimer();
+        GradientThrottlePolicy minPolicy = new GradientThrottlePolicy(timer);
+        minPolicy.setMinWindowSize(150);
+        assertEquals(150, getWindowSize(minPolicy, timer, 100));
+    }
+
+    @Test
+    public void testGradientErrorBackOff() {
+        CustomTimer timer = new CustomTimer();
+        GradientThrottlePolicy policy = new GradientThrottlePolicy(timer);
+
+        Reply reply = new SimpleReply("bar");
+        reply.setContext(1);
+        reply.addError(new Error(ErrorCode.TRANSIENT_ERROR, "baz"));
+        for (int i = 0; i < 10; ++i) {
+            runGradientSample(policy, timer, reply, 1000);
+        }
+        assertEquals(1000.0, policy.getRtt(), 0.0);
+        assertTrue(policy.getWindowSize() < 20);
+    }
+
+    @Test
+    public void testGradientMinRttWindow() {
+        CustomTimer timer = new CustomTimer();
+        GradientThrottlePolicy policy = new GradientThrottlePolicy(timer);
+        policy.setMinRttWindow(30000);
+
+        Reply reply = new SimpleReply("bar");
+        reply.setContext(1);
+        runGradientSample(policy, timer, reply, 1000);
+        assertEquals(1000.0, policy.getMinRtt(), 0.0);
+
+        // A sustained higher round-trip time does not move the baseline within a window.
+        for (int i = 0; i < 20; ++i) {
+            runGradientSample(policy, timer, reply, 1400);
+        }
+        assertEquals(1400.0, policy.getRtt(), 0.0);
+        assertEquals(1000.0, policy.getMinRtt(), 0.0);
+
+        // Once a full window has passed without seeing it, the old baseline is forgotten.
+        for (int i = 0; i < 45; ++i) {
+            runGradientSample(policy, timer, reply, 1400);
+        }
+        assertEquals(1400.0, policy.getMinRtt(), 0.0);
+
+        // A single slow sample spanning a whole window does not become the baseline.
+        runGradientSample(policy, timer, reply, 100000);
+        assertEquals(1400.0, policy.getMinRtt(), 0.0);
+    }
+
+    private void runGradientSample(GradientThrottlePolicy policy, CustomTimer timer, Reply reply, long tripTime) {
+        Message msg = new SimpleMessage("foo");
+        int numPending = 0;
+        while (policy.canSend(msg, numPending)) {
+            policy.processMessage(msg);
+            ++numPending;
+        }
+        timer.millis += tripTime;
+        while (--numPending >= 0) {
+            policy.processReply(reply);
+        }
+    }
+
+    private int getWindowSize(StaticThrottlePolicy policy, CustomTimer timer, int maxPending) {
         Message msg = new SimpleMessage("foo");
         Reply reply = new SimpleReply("bar");
         reply.setContext(1);
@@ -1,8 +1,15 @@
 // Copyright 2017 Yahoo Holdings. Licensed under the terms of the Apache 2.0 license. See LICENSE in the project root.
 
 #include <vespa/messagebus/messenger.h>
+#include <vespa/messagebus/testlib/simplemessage.h>
+#include <vespa/messagebus/testlib/simplereply.h>
 #include <vespa/vespalib/util/barrier.h>
 #include <vespa/vespalib/testkit/testapp.h>
+#include <vespa/vespalib/util/stringfmt.h>
+#include <map>
+#include <mutex>
+#include <set>
+#include <thread>
 
 using namespace mbus;
 
@@ -39,11 +46,33 @@ public:
     }
 };
 
-int
-Test::Main()
-{
-    TEST_INIT("messenger_test");
+class OrderHandler : public IMessageHandler {
+private:
+    std::mutex                _lock;
+    std::vector<string>       _values;
+    std::set<std::thread::id> _threads;
+
+public:
+    void handleMessage(Message::UP msg) override {
+        std::lock_guard<std::mutex> guard(_lock);
+        _values.push_back(static_cast<SimpleMessage &>(*msg).getValue());
+        _threads.insert(std::this_thread::get_id());
+    }
 
+    std::vector<string> getValues() {
+        std::lock_guard<std::mutex> guard(_lock);
+        return _values;
+    }
+
+    size_t getNumThreads() {
+        std::lock_guard<std::mutex> guard(_lock);
+        return _threads.size();
+    }
+};
+
+void
+testTaskExceptions()
+{
     Messenger msn;
     msn.start();
 
@@ -53,6 +82,160 @@ Test::Main()
 
     barrier.await();
     ASSERT_TRUE(msn.isEmpty());
+}
+
+void
+testSessionOrdering()
+{
+    Messenger msn(4);
+    EXPECT_EQUAL(4u, msn.getNumThreads());
+    ASSERT_TRUE(msn.start());
+
+    std::vector<std::unique_ptr<OrderHandler>> handlers;
+    for (uint32_t i = 0; i < 16; ++i) {
+        handlers.push_back(std::make_unique<OrderHandler>());
+    }
+    for (uint32_t i = 0; i < 1000; ++i) {
+        for (auto &handler : handlers) {
+            msn.deliverSessionMessage(std::make_unique<SimpleMessage>(vespalib::make_string("%u", i)), *handler);
+        }
+    }
+    msn.sync();
+    EXPECT_TRUE(msn.isEmpty());
+    for (auto &handler : handlers) {
+        std::vector<string> values = handler->getValues();
+        ASSERT_EQUAL(1000u, values.size());
+        for (uint32_t i = 0; i < values.size(); ++i) {
+            EXPECT_EQUAL(vespalib::make_string("%u", i), values[i]);
+        }
+        EXPECT_EQUAL(1u, handler->getNumThreads());
+    }
+}
+
+class KeyOrderHandler : public IMessageHandler {
+private:
+    std::mutex                                    _lock;
+    std::map<uint64_t, std::vector<string>>       _values;
+    std::map<uint64_t, std::set<std::thread::id>> _keyThreads;
+    std::set<std::thread::id>                     _threads;
+
+public:
+    void handleMessage(Message::UP msg) override {
+        std::lock_guard<std::mutex> guard(_lock);
+        _values[msg->getDeliveryKey()].push_back(static_cast<SimpleMessage &>(*msg).getValue());
+        _keyThreads[msg->getDeliveryKey()].insert(std::this_thread::get_id());
+        _threads.insert(std::this_thread::get_id());
+    }
+
+    std::map<uint64_t, std::vector<string>> getValues() {
+        std::lock_guard<std::mutex> guard(_lock);
+        return _values;
+    }
+
+    size_t getNumKeyThreads(uint64_t key) {
+        std::lock_guard<std::mutex> guard(_lock);
+        return _keyThreads[key].size();
+    }
+
+    size_t getNumThreads() {
+        std::lock_guard<std::mutex> guard(_lock);
+        return _threads.size();
+    }
+};
+
+void
+testKeyOrdering()
+{
+    Messenger msn(4);
+    ASSERT_TRUE(msn.start());
+
+    KeyOrderHandler session;
+    for (uint32_t i = 0; i < 100; ++i) {
+        for (uint64_t key = 0; key < 64; ++key) {
+            msn.deliverSessionMessage(std::make_unique<SimpleMessage>(vespalib::make_string("%u", i), true, key),
+                                      session);
+        }
+    }
+    msn.sync();
+    EXPECT_TRUE(msn.isEmpty());
+    EXPECT_TRUE(session.getNumThreads() > 1u);
+    auto values = session.getValues();
+    ASSERT_EQUAL(64u, values.size());
+    for (const auto &entry : values) {
+        ASSERT_EQUAL(100u, entry.second.size());
+        for (uint32_t i = 0; i < entry.second.size(); ++i) {
+            EXPECT_EQUAL(vespalib::make_string("%u", i), entry.second[i]);
+        }
+        EXPECT_EQUAL(1u, session.getNumKeyThreads(entry.first));
+    }
+}
+
+class ThreadTracker : public IMessageHandler, public IReplyHandler {
+private:
+    std::mutex                &_lock;
+    std::set<std::thread::id> &_threads;
+
+    void track() {
+        std::lock_guard<std::mutex> guard(_lock);
+        _threads.insert(std::this_thread::get_id());
+    }
+
+public:
+    ThreadTracker(std::mutex &lock, std::set<std::thread::id> &threads) : _lock(lock), _threads(threads) {}
+    void handleMessage(Message::UP) override { track(); }
+    void handleReply(Reply::UP) override { track(); }
+};
+
+void
+testRoutingThread()
+{
+    Messenger msn(4);
+    ASSERT_TRUE(msn.start());
+
+    std::mutex lock;
+    std::set<std::thread::id> threads;
+    std::vector<std::unique_ptr<ThreadTracker>> handlers;
+    for (uint32_t i = 0; i < 16; ++i) {
+        handlers.push_back(std::make_unique<ThreadTracker>(lock, threads));
+    }
+    for (uint32_t i = 0; i < 100; ++i) {
+        for (auto &handler : handlers) {
+            msn.deliverMessage(std::make_unique<SimpleMessage>("msg"), *handler);
+            msn.deliverReply(std::make_unique<SimpleReply>("reply"), *handler);
+        }
+    }
+    msn.sync();
+    std::lock_guard<std::mutex> guard(lock);
+    EXPECT_EQUAL(1u, threads.size());
+}
+
+void
+testSessionReplies()
+{
+    Messenger msn(4);
+    ASSERT_TRUE(msn.start());
+
+    std::mutex lock;
+    std::set<std::thread::id> threads;
+    ThreadTracker network(lock, threads);
+    for (uint32_t i = 0; i < 100; ++i) {
+        msn.deliverSessionReply(std::make_unique<SimpleReply>("reply"), network);
+    }
+    msn.sync();
+    std::lock_guard<std::mutex> guard(lock);
+    EXPECT_EQUAL(4u, threads.size());
+}
+
+int
+Test::Main()
+{
+    TEST_INIT("messenger_test");
+
+    testTaskExceptions();  TEST_FLUSH();
+    testSessionOrdering(); TEST_FLUSH();
+    testKeyOrdering();     TEST_FLUSH();
+    testRoutingThread();   TEST_FLUSH();
+    testSessionReplies();  TEST_FLUSH();
 
     TEST_DONE();
 }
@@ -2,12 +2,23 @@
 
 #include <vespa/messagebus/testlib/receptor.h>
 #include <vespa/messagebus/testlib/simpleprotocol.h>
+#include <vespa/messagebus/testlib/simplemessage.h>
 #include <vespa/messagebus/testlib/simplereply.h>
 #include <vespa/messagebus/testlib/slobrok.h>
 #include <vespa/messagebus/testlib/testserver.h>
 #include <vespa/messagebus/network/rpcsendv1.h>
 #include <vespa/messagebus/network/rpcsendv2.h>
+#include <vespa/messagebus/network/rpcsendbatch.h>
+#include <vespa/messagebus/errorcode.h>
+#include <vespa/messagebus/routablequeue.h>
+#include <vespa/fnet/frt/frt.h>
+#include <vespa/vespalib/data/simple_buffer.h>
+#include <vespa/vespalib/data/slime/slime.h>
 #include <vespa/vespalib/testkit/testapp.h>
+#include <vespa/vespalib/util/stringfmt.h>
+#include <cstring>
+#include <map>
+#include <set>
 
 #include <vespa/log/log.h>
 LOG_SETUP("sendadapter_test");
@@ -224,4 +235,141 @@ TEST("test that we can send between multiple versions") {
     TEST_DO(testSendAdapters(data, {vespalib::Version(5, 0), vespalib::Version(6, 148), vespalib::Version(6, 149), vespalib::Version(9, 999)}));
 }
 
+TEST("test that the batch send adapter is only used when enabled") {
+    Slobrok slobrok;
+    TestServer plain(MessageBusParams(), RPCNetworkParams(slobrok.config()));
+    TestServer batched(MessageBusParams(), RPCNetworkParams(slobrok.config()).setMaxSendBatchSize(16));
+    EXPECT_TRUE(dynamic_cast<mbus::RPCSendV2 *>(plain.net.getSendAdapter(vespalib::Version(9, 999))) != nullptr);
+    EXPECT_TRUE(dynamic_cast<mbus::RPCSendV1 *>(batched.net.getSendAdapter(vespalib::Version(6, 148))) != nullptr);
+    EXPECT_TRUE(dynamic_cast<mbus::RPCSendBatch *>(batched.net.getSendAdapter(vespalib::Version(6, 149))) != nullptr);
+    EXPECT_TRUE(dynamic_cast<mbus::RPCSendBatch *>(batched.net.getSendAdapter(vespalib::Version(9, 999))) != nullptr);
+}
+
+void
+testBatchedReplies(bool dstBatching)
+{
+    Slobrok slobrok;
+    TestServer src(MessageBusParams().setRetryPolicy(IRetryPolicy::SP()).addProtocol(std::make_shared<SimpleProtocol>()),
+                   RPCNetworkParams(slobrok.config()).setMaxSendBatchSize(16));
+    TestServer dst(MessageBusParams().addProtocol(std::make_shared<SimpleProtocol>()),
+                   RPCNetworkParams(slobrok.config()).setIdentity(Identity("dst"))
+                                                     .setMaxSendBatchSize(dstBatching ? 16 : 1));
+    src.net.setVersion(vespalib::Version(9, 999));
+    dst.net.setVersion(vespalib::Version(9, 999));
+    RoutableQueue srcQ;
+    RoutableQueue dstQ;
+    SourceSession::UP ss = src.mb.createSourceSession(SourceSessionParams().setReplyHandler(srcQ)
+                                                                           .setThrottlePolicy(IThrottlePolicy::SP()));
+    DestinationSession::UP ds = dst.mb.createDestinationSession("session", true, dstQ);
+    ASSERT_TRUE(src.waitSlobrok("dst/session", 1u));
+
+    const uint32_t numMessages = 100;
+    for (uint32_t i = 0; i < numMessages; ++i) {
+        auto msg = std::make_unique<SimpleMessage>(vespalib::make_string("msg%u", i));
+        EXPECT_TRUE(ss->send(std::move(msg), Route::parse("dst/session")).isAccepted());
+    }
+    for (uint32_t i = 0; i < numMessages; ++i) {
+        Routable::UP routable = dstQ.dequeue(TIMEOUT_SECS * 1000);
+        ASSERT_TRUE(routable);
+        auto &msg = dynamic_cast<SimpleMessage&>(*routable);
+        Reply::UP reply(new SimpleReply(msg.getValue()));
+        reply->swapState(msg);
+        ds->reply(std::move(reply));
+    }
+    std::set<string> values;
+    for (uint32_t i = 0; i < numMessages; ++i) {
+        Routable::UP routable = srcQ.dequeue(TIMEOUT_SECS * 1000);
+        ASSERT_TRUE(routable);
+        auto &reply = dynamic_cast<SimpleReply&>(*routable);
+        EXPECT_FALSE(reply.hasErrors());
+        values.insert(reply.getValue());
+    }
+    EXPECT_EQUAL(numMessages, values.size());
+}
+
+TEST("test that batched messages get their own replies") {
+    TEST_DO(testBatchedReplies(true));
+}
+
+TEST("test that messages are sent one by one to a target that does not serve batches") {
+    TEST_DO(testBatchedReplies(false));
+}
+
+TEST("test that batched replies are returned as they become ready") {
+    Slobrok slobrok;
+    TestServer src(MessageBusParams().setRetryPolicy(IRetryPolicy::SP()).addProtocol(std::make_shared<SimpleProtocol>()),
+                   RPCNetworkParams(slobrok.config()).setMaxSendBatchSize(3));
+    TestServer dst(MessageBusParams().addProtocol(std::make_shared<SimpleProtocol>()),
+                   RPCNetworkParams(slobrok.config()).setIdentity(Identity("dst")).setMaxSendBatchSize(3));
+    RoutableQueue srcQ;
+    RoutableQueue dstQ;
+    SourceSession::UP ss = src.mb.createSourceSession(SourceSessionParams().setReplyHandler(srcQ)
+                                                                           .setThrottlePolicy(IThrottlePolicy::SP()));
+    DestinationSession::UP ds = dst.mb.createDestinationSession("session", true, dstQ);
+    ASSERT_TRUE(src.waitSlobrok("dst/session", 1u));
+
+    // All three messages fill a single batch. The one with a short deadline is never replied to.
+    for (const char *value : {"first", "second", "expiring"}) {
+        auto msg = std::make_unique<SimpleMessage>(value);
+        msg->setTimeRemaining(strcmp(value, "expiring") == 0 ? 1000 : TIMEOUT_SECS * 1000);
+        EXPECT_TRUE(ss->send(std::move(msg), Route::parse("dst/session")).isAccepted());
+    }
+    std::map<string, Message::UP> received;
+    for (uint32_t i = 0; i < 3; ++i) {
+        Routable::UP routable = dstQ.dequeue(TIMEOUT_SECS * 1000);
+        ASSERT_TRUE(routable);
+        auto &msg = dynamic_cast<SimpleMessage&>(*routable);
+        string value = msg.getValue();
+        routable.release();
+        received[value].reset(&msg);
+    }
+    auto replyTo = [&](const string &value) {
+        Reply::UP reply(new SimpleReply(value));
+        reply->swapState(*received[value]);
+        ds->reply(std::move(reply));
+    };
+
+    replyTo("first");
+    Routable::UP routable = srcQ.dequeue(TIMEOUT_SECS * 1000);
+    ASSERT_TRUE(routable);
+    EXPECT_EQUAL(string("first"), dynamic_cast<SimpleReply&>(*routable).getValue());
+
+    routable = srcQ.dequeue(TIMEOUT_SECS * 1000);
+    ASSERT_TRUE(routable);
+    auto &expired = dynamic_cast<Reply&>(*routable);
+    ASSERT_TRUE(expired.hasErrors());
+    EXPECT_EQUAL((uint32_t)ErrorCode::TIMEOUT, expired.getError(0).getCode());
+
+    replyTo("second");
+    routable = srcQ.dequeue(TIMEOUT_SECS * 1000);
+    ASSERT_TRUE(routable);
+    EXPECT_EQUAL(string("second"), dynamic_cast<SimpleReply&>(*routable).getValue());
+
+    replyTo("expiring");
+}
+
+TEST("test that a batch without messages is rejected") {
+    Slobrok slobrok;
+    TestServer dst(MessageBusParams().addProtocol(std::make_shared<SimpleProtocol>()),
+                   RPCNetworkParams(slobrok.config()).setIdentity(Identity("dst")).setMaxSendBatchSize(3));
+    vespalib::Slime batch;
+    vespalib::slime::Cursor &root = batch.setObject();
+    root.setLong("batch", 17);
+    root.setArray("messages");
+    vespalib::SimpleBuffer buf;
+    vespalib::slime::BinaryFormat::encode(batch, buf);
+
+    FRT_Supervisor &orb = dst.net.getSupervisor();
+    FRT_Target *target = orb.GetTarget(dst.net.getConnectionSpec().c_str());
+    FRT_RPCRequest *req = orb.AllocRPCRequest();
+    req->SetMethodName("mbus.slime.batch");
+    req->GetParams()->AddInt8(vespalib::compression::CompressionConfig::NONE);
+    req->GetParams()->AddInt32(buf.get().size);
+    req->GetParams()->AddData(buf.get().data, buf.get().size);
+    target->InvokeSync(req, TIMEOUT_SECS);
+    EXPECT_EQUAL((uint32_t)FRTE_RPC_BAD_REQUEST, req->GetErrorCode());
+    req->SubRef();
+    target->SubRef();
+}
+
 TEST_MAIN() { TEST_RUN_ALL(); }
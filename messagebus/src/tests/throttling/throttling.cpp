@@ -3,6 +3,8 @@
 #include <vespa/vespalib/testkit/testapp.h>
 #include <vespa/messagebus/destinationsession.h>
 #include <vespa/messagebus/dynamicthrottlepolicy.h>
+#include <vespa/messagebus/errorcode.h>
+#include <vespa/messagebus/gradientthrottlepolicy.h>
 #include <vespa/messagebus/messagebus.h>
 #include <vespa/messagebus/routablequeue.h>
 #include <vespa/messagebus/routing/retrytransienterrorspolicy.h>
@@ -75,7 +77,9 @@ bool waitPending(SourceSession& session, uint32_t size)
 
 class Test : public vespalib::TestApp {
 private:
-    uint32_t getWindowSize(DynamicThrottlePolicy &policy, DynamicTimer &timer, uint32_t maxPending);
+    template <typename Policy>
+    uint32_t getWindowSize(Policy &policy, DynamicTimer &timer, uint32_t maxPending);
+    void runGradientSample(GradientThrottlePolicy &policy, DynamicTimer &timer, uint64_t tripTime);
 
 protected:
     void testMaxPendingCount();
@@ -85,6 +89,10 @@ protected:
     void testIdleTimePeriod();
     void testMinWindowSize();
     void testMaxWindowSize();
+    void testGradientWindowSize();
+    void testGradientMinMaxWindowSize();
+    void testGradientErrorBackOff();
+    void testGradientMinRttWindow();
 
 public:
     int Main() override;
@@ -102,6 +110,10 @@ Test::Main()
     testIdleTimePeriod();    TEST_FLUSH();
     testMinWindowSize();     TEST_FLUSH();
     testMaxWindowSize();     TEST_FLUSH();
+    testGradientWindowSize();       TEST_FLUSH();
+    testGradientMinMaxWindowSize(); TEST_FLUSH();
+    testGradientErrorBackOff();     TEST_FLUSH();
+    testGradientMinRttWindow();     TEST_FLUSH();
 
     TEST_DONE();
 }
@@ -334,8 +346,132 @@ Test::testMaxWindowSize()
 
 }
 
+void
+Test::testGradientWindowSize()
+{
+    ITimer::UP ptr(new DynamicTimer());
+    DynamicTimer *timer = static_cast<DynamicTimer*>(ptr.get());
+    GradientThrottlePolicy policy(std::move(ptr));
+
+    double windowSize = getWindowSize(policy, *timer, 100);
+    ASSERT_TRUE(windowSize >= 50 && windowSize <= 105);
+    EXPECT_APPROX(1000.0, policy.getMinRtt(), 50.0);
+
+    windowSize = getWindowSize(policy, *timer, 200);
+    ASSERT_TRUE(windowSize >= 100 && windowSize <= 205);
+
+    windowSize = getWindowSize(policy, *timer, 50);
+    ASSERT_TRUE(windowSize >= 25 && windowSize <= 55);
+
+    windowSize = getWindowSize(policy, *timer, 500);
+    ASSERT_TRUE(windowSize >= 250 && windowSize <= 505);
+
+    windowSize = getWindowSize(policy, *timer, 100);
+    ASSERT_TRUE(windowSize >= 50 && windowSize <= 105);
+
+    windowSize = getWindowSize(policy, *timer, 5);
+    ASSERT_TRUE(windowSize >= 1 && windowSize <= 7);
+    EXPECT_APPROX(1000.0, policy.getMinRtt(), 50.0);
+}
+
+void
+Test::testGradientMinRttWindow()
+{
+    ITimer::UP ptr(new DynamicTimer());
+    DynamicTimer *timer = static_cast<DynamicTimer*>(ptr.get());
+    GradientThrottlePolicy policy(std::move(ptr));
+    policy.setMinRttWindow(30000);
+
+    runGradientSample(policy, *timer, 1000);
+    EXPECT_EQUAL(1000.0, policy.getMinRtt());
+
+    // A sustained higher round-trip time does not move the baseline within a window.
+    for (uint32_t i = 0; i < 20; ++i) {
+        runGradientSample(policy, *timer, 1400);
+    }
+    EXPECT_EQUAL(1400.0, policy.getRtt());
+    EXPECT_EQUAL(1000.0, policy.getMinRtt());
+
+    // Once a full window has passed without seeing it, the old baseline is forgotten.
+    for (uint32_t i = 0; i < 45; ++i) {
+        runGradientSample(policy, *timer, 1400);
+    }
+    EXPECT_EQUAL(1400.0, policy.getMinRtt());
+
+    // A single slow sample spanning a whole window does not become the baseline.
+    runGradientSample(policy, *timer, 100000);
+    EXPECT_EQUAL(1400.0, policy.getMinRtt());
+}
+
+void
+Test::testGradientMinMaxWindowSize()
+{
+    ITimer::UP ptr(new DynamicTimer());
+    DynamicTimer *timer = static_cast<DynamicTimer*>(ptr.get());
+    GradientThrottlePolicy policy(std::move(ptr));
+
+    policy.setMaxWindowSize(50);
+    double windowSize = getWindowSize(policy, *timer, 100);
+    EXPECT_EQUAL(50.0, windowSize);
+
+    policy.setMaxPendingCount(15);
+    windowSize = getWindowSize(policy, *timer, 100);
+    EXPECT_EQUAL(15.0, windowSize);
+
+    ptr.reset(new DynamicTimer());
+    timer = static_cast<DynamicTimer*>(ptr.get());
+    GradientThrottlePolicy minPolicy(std::move(ptr));
+
+    minPolicy.setMinWindowSize(150);
+    windowSize = getWindowSize(minPolicy, *timer, 100);
+    EXPECT_EQUAL(150.0, windowSize);
+}
+
+void
+Test::testGradientErrorBackOff()
+{
+    ITimer::UP ptr(new DynamicTimer());
+    DynamicTimer *timer = static_cast<DynamicTimer*>(ptr.get());
+    GradientThrottlePolicy policy(std::move(ptr));
+
+    SimpleMessage msg("foo");
+    SimpleReply reply("bar");
+    reply.addError(Error(ErrorCode::TRANSIENT_ERROR, "baz"));
+    for (uint32_t i = 0; i < 10; ++i) {
+        uint32_t numPending = 0;
+        while (policy.canSend(msg, numPending)) {
+            policy.processMessage(msg);
+            ++numPending;
+        }
+        timer->_millis += 1000;
+        for ( ; numPending > 0; --numPending) {
+            policy.processReply(reply);
+        }
+    }
+    EXPECT_EQUAL(1000.0, policy.getRtt());
+    EXPECT_LESS(policy.getWindowSize(), 20.0);
+}
+
+void
+Test::runGradientSample(GradientThrottlePolicy &policy, DynamicTimer &timer, uint64_t tripTime)
+{
+    SimpleMessage msg("foo");
+    SimpleReply reply("bar");
+
+    uint32_t numPending = 0;
+    while (policy.canSend(msg, numPending)) {
+        policy.processMessage(msg);
+        ++numPending;
+    }
+    timer._millis += tripTime;
+    for ( ; numPending > 0; --numPending) {
+        policy.processReply(reply);
+    }
+}
+
+template <typename Policy>
 uint32_t
-Test::getWindowSize(DynamicThrottlePolicy &policy, DynamicTimer &timer, uint32_t maxPending)
+Test::getWindowSize(Policy &policy, DynamicTimer &timer, uint32_t maxPending)
 {
     SimpleMessage msg("foo");
     SimpleReply reply("bar");
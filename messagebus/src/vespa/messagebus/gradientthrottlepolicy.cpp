@@ -0,0 +1,185 @@
+// Copyright 2019 Oath Inc. Licensed under the terms of the Apache 2.0 license. See LICENSE in the project root.
+#include "gradientthrottlepolicy.h"
+#include "reply.h"
+#include "systemtimer.h"
+#include <algorithm>
+#include <climits>
+#include <cmath>
+
+#include <vespa/log/log.h>
+LOG_SETUP(".gradientthrottlepolicy");
+
+namespace mbus {
+
+namespace {
+
+const uint32_t MIN_RTT_WINDOW_SAMPLES = 10;
+
+}
+
+GradientThrottlePolicy::GradientThrottlePolicy() :
+    GradientThrottlePolicy(std::make_unique<SystemTimer>())
+{ }
+
+GradientThrottlePolicy::GradientThrottlePolicy(ITimer::UP timer) :
+    _timer(std::move(timer)),
+    _numPending(0),
+    _numReplies(0),
+    _numErrors(0),
+    _timeOfLastEvent(_timer->getMilliTime()),
+    _pendingTime(0),
+    _rtt(0),
+    _minRtt(0),
+    _windowMinRtt(0),
+    _numWindowSamples(0),
+    _minRttWindowStart(_timeOfLastEvent),
+    _minRttWindow(30000),
+    _rttTolerance(1.5),
+    _smoothing(0.2),
+    _errorBackOff(0.9),
+    _windowSize(20),
+    _maxWindowSize(INT_MAX),
+    _minWindowSize(1)
+{ }
+
+GradientThrottlePolicy &
+GradientThrottlePolicy::setRttTolerance(double tolerance)
+{
+    _rttTolerance = std::max(1.0, tolerance);
+    return *this;
+}
+
+GradientThrottlePolicy &
+GradientThrottlePolicy::setMinRttWindow(uint64_t windowMillis)
+{
+    _minRttWindow = std::max(uint64_t(1), windowMillis);
+    return *this;
+}
+
+GradientThrottlePolicy &
+GradientThrottlePolicy::setSmoothing(double smoothing)
+{
+    _smoothing = std::min(1.0, std::max(0.01, smoothing));
+    return *this;
+}
+
+GradientThrottlePolicy &
+GradientThrottlePolicy::setErrorBackOff(double backOff)
+{
+    _errorBackOff = std::min(1.0, std::max(0.0, backOff));
+    return *this;
+}
+
+GradientThrottlePolicy &
+GradientThrottlePolicy::setMaxWindowSize(double max)
+{
+    _maxWindowSize = max;
+    _windowSize = std::min(_maxWindowSize, _windowSize);
+    return *this;
+}
+
+GradientThrottlePolicy &
+GradientThrottlePolicy::setMaxPendingCount(uint32_t maxCount)
+{
+    StaticThrottlePolicy::setMaxPendingCount(maxCount);
+    return setMaxWindowSize(maxCount);
+}
+
+GradientThrottlePolicy &
+GradientThrottlePolicy::setMinWindowSize(double min)
+{
+    _minWindowSize = min;
+    _windowSize = std::max(_minWindowSize, _windowSize);
+    return *this;
+}
+
+void
+GradientThrottlePolicy::advance(uint64_t time)
+{
+    if (time > _timeOfLastEvent) {
+        _pendingTime += double(_numPending) * (time - _timeOfLastEvent);
+        _timeOfLastEvent = time;
+    }
+}
+
+void
+GradientThrottlePolicy::updateMinRtt()
+{
+    if (_minRtt == 0 || _rtt < _minRtt) {
+        _minRtt = _rtt;
+    }
+    if (_windowMinRtt == 0 || _rtt < _windowMinRtt) {
+        _windowMinRtt = _rtt;
+    }
+    ++_numWindowSamples;
+    if (_timeOfLastEvent - _minRttWindowStart >= _minRttWindow && _numWindowSamples >= MIN_RTT_WINDOW_SAMPLES) {
+        _minRtt = _windowMinRtt;
+        _windowMinRtt = 0;
+        _numWindowSamples = 0;
+        _minRttWindowStart = _timeOfLastEvent;
+    }
+}
+
+void
+GradientThrottlePolicy::resize()
+{
+    _rtt = _pendingTime / _numReplies;
+    updateMinRtt();
+
+    double gradient = std::max(0.5, std::min(1.0, _minRtt * _rttTolerance / _rtt));
+    double newSize = _windowSize * gradient;
+    if (_numErrors > 0) {
+        newSize *= _errorBackOff;
+    } else if (gradient >= 1.0) {
+        newSize += std::sqrt(_windowSize);
+    }
+    if (gradient > 0.5) {
+        _windowSize += (newSize - _windowSize) * _smoothing;
+    } else {
+        _windowSize = newSize;
+    }
+    _windowSize = std::max(_minWindowSize, _windowSize);
+    _windowSize = std::min(_maxWindowSize, _windowSize);
+    LOG(debug, "WindowSize = %.2f, Rtt = %.2f, MinRtt = %.2f, Gradient = %.2f, Errors = %u",
+        _windowSize, _rtt, _minRtt, gradient, _numErrors);
+
+    _pendingTime = 0;
+    _numReplies = 0;
+    _numErrors = 0;
+}
+
+bool
+GradientThrottlePolicy::canSend(const Message &msg, uint32_t pendingCount)
+{
+    if (!StaticThrottlePolicy::canSend(msg, pendingCount)) {
+        return false;
+    }
+    return pendingCount < _windowSize;
+}
+
+void
+GradientThrottlePolicy::processMessage(Message &msg)
+{
+    StaticThrottlePolicy::processMessage(msg);
+    advance(_timer->getMilliTime());
+    ++_numPending;
+}
+
+void
+GradientThrottlePolicy::processReply(Reply &reply)
+{
+    StaticThrottlePolicy::processReply(reply);
+    advance(_timer->getMilliTime());
+    if (_numPending > 0) {
+        --_numPending;
+    }
+    ++_numReplies;
+    if (reply.hasErrors()) {
+        ++_numErrors;
+    }
+    if (_numReplies >= _windowSize && _pendingTime > 0) {
+        resize();
+    }
+}
+
+} // namespace mbus
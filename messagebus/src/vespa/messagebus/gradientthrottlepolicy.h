@@ -0,0 +1,176 @@
+// Copyright 2019 Oath Inc. Licensed under the terms of the Apache 2.0 license. See LICENSE in the project root.
+#pragma once
+
+#include "itimer.h"
+#include "staticthrottlepolicy.h"
+
+namespace mbus {
+
+/**
+ * This is an implementation of the {@link ThrottlePolicy} that limits the number of pending messages a
+ * {@link SourceSession} is allowed to have based on the round-trip time of its messages. It keeps track of
+ * the lowest round-trip time seen, and shrinks the window in proportion to how far the current round-trip
+ * time exceeds it by more than a given tolerance. As long as the round-trip time stays within the tolerance,
+ * the window grows by the square root of its size for every sample.
+ *
+ * The round-trip time is estimated per sample using Little's law, as the time integral of the number of
+ * pending messages divided by the number of replies received during the sample. A sample ends when
+ * (at least) as many replies as the current window size have been received.
+ *
+ * The lowest round-trip time is only allowed to increase at the end of a time window, when it is reset to the
+ * lowest round-trip time seen during that window. A window lasts until both its time has passed and it holds
+ * enough samples, so a single slow sample can never become the baseline on its own. This lets the policy adapt
+ * to a recipient that has become permanently slower, without letting a sustained queue push the baseline
+ * upwards sample by sample.
+ *
+ * <b>NOTE:</b> By context, "pending" is refering to the number of sent messages that have not been replied to
+ * yet.
+ */
+class GradientThrottlePolicy: public StaticThrottlePolicy {
+private:
+    ITimer::UP  _timer;
+    uint32_t    _numPending;
+    uint32_t    _numReplies;
+    uint32_t    _numErrors;
+    uint64_t    _timeOfLastEvent;
+    double      _pendingTime;
+    double      _rtt;
+    double      _minRtt;
+    double      _windowMinRtt;
+    uint32_t    _numWindowSamples;
+    uint64_t    _minRttWindowStart;
+    uint64_t    _minRttWindow;
+    double      _rttTolerance;
+    double      _smoothing;
+    double      _errorBackOff;
+    double      _windowSize;
+    double      _maxWindowSize;
+    double      _minWindowSize;
+
+    void advance(uint64_t time);
+    void updateMinRtt();
+    void resize();
+
+public:
+    /**
+     * Convenience typedefs.
+     */
+    typedef std::unique_ptr<GradientThrottlePolicy> UP;
+    typedef std::shared_ptr<GradientThrottlePolicy> SP;
+
+    /**
+     * Constructs a new instance of this policy and sets the appropriate default values of member data.
+     */
+    GradientThrottlePolicy();
+
+    /**
+     * Constructs a new instance of this class using the given clock to measure round-trip times.
+     *
+     * @param timer The timer to use.
+     */
+    GradientThrottlePolicy(ITimer::UP timer);
+
+    /**
+     * Sets how much the round-trip time may exceed the lowest round-trip time seen before the window
+     * shrinks. A value of 1.5 allows the time messages spend queued to be half of the lowest round-trip
+     * time. This value is capped to be at least 1.
+     *
+     * @param tolerance The tolerance to set.
+     * @return This, to allow chaining.
+     */
+    GradientThrottlePolicy &setRttTolerance(double tolerance);
+
+    /**
+     * Sets the length in milliseconds of the time windows that the lowest round-trip time is tracked over.
+     * At the end of each window, the lowest round-trip time is reset to the lowest one seen during that
+     * window. A window is extended until it holds at least 10 samples. This value is capped to be at least 1.
+     *
+     * @param windowMillis The window to set.
+     * @return This, to allow chaining.
+     */
+    GradientThrottlePolicy &setMinRttWindow(uint64_t windowMillis);
+
+    /**
+     * Sets the weight given to a new window size when growing or moderately shrinking the window. The
+     * window is shrunk without smoothing when the round-trip time is more than twice the target.
+     * This value is capped to the (0, 1] range.
+     *
+     * @param smoothing The smoothing to set.
+     * @return This, to allow chaining.
+     */
+    GradientThrottlePolicy &setSmoothing(double smoothing);
+
+    /**
+     * Sets the factor the window size is multiplied with when a sample contains replies with errors.
+     * This value is capped to the [0, 1] range.
+     *
+     * @param backOff The back off to set.
+     * @return This, to allow chaining.
+     */
+    GradientThrottlePolicy &setErrorBackOff(double backOff);
+
+    /**
+     * Sets the maximium number of pending operations allowed at any time, in
+     * order to avoid using too much resources.
+     *
+     * @param max The max to set.
+     * @return This, to allow chaining.
+     */
+    GradientThrottlePolicy &setMaxWindowSize(double max);
+
+    /**
+     * Sets the maximum number of pending messages allowed.
+     *
+     * @param maxCount The max count.
+     * @return This, to allow chaining.
+     */
+    GradientThrottlePolicy &setMaxPendingCount(uint32_t maxCount);
+
+    /**
+     * Sets the minimium number of pending operations allowed at any time, in
+     * order to keep a level of performance.
+     *
+     * @param min The min to set.
+     * @return This, to allow chaining.
+     */
+    GradientThrottlePolicy &setMinWindowSize(double min);
+
+    double getMaxWindowSize() const { return _maxWindowSize; }
+    double getMinWindowSize() const { return _minWindowSize; }
+
+    /**
+     * Returns the current window size, before truncation to a pending count.
+     *
+     * @return The window size.
+     */
+    double getWindowSize() const { return _windowSize; }
+
+    /**
+     * Returns the round-trip time in milliseconds estimated for the last sample, or 0 if no sample has
+     * completed yet.
+     *
+     * @return The round-trip time.
+     */
+    double getRtt() const { return _rtt; }
+
+    /**
+     * Returns the lowest round-trip time in milliseconds seen since the start of the previous time window,
+     * or 0 if no sample has completed yet.
+     *
+     * @return The lowest round-trip time.
+     */
+    double getMinRtt() const { return _minRtt; }
+
+    /**
+     * Returns the maximum number of pending messages allowed.
+     *
+     * @return The max limit.
+     */
+    uint32_t getMaxPendingCount() const { return (uint32_t)_windowSize; }
+
+    bool canSend(const Message &msg, uint32_t pendingCount) override;
+    void processMessage(Message &msg) override;
+    void processReply(Reply &reply) override;
+};
+
+} // namespace mbus
@@ -180,6 +180,26 @@ public:
      */
     virtual uint64_t getBucketSequence() { return 0; }
 
+    /**
+     * Returns whether or not this message has a key that decides which
+     * messenger thread delivers it to its destination session. Messages with
+     * the same key are delivered in order by the same thread, while messages
+     * without a key are delivered in order by the thread of the session. By
+     * default, sequenced messages are keyed by their sequence id.
+     *
+     * @return True if the message has a delivery key.
+     */
+    virtual bool hasDeliveryKey() const { return hasSequenceId(); }
+
+    /**
+     * Returns the key that decides which messenger thread delivers this
+     * message to its destination session. This value is only respected if the
+     * {@link #hasDeliveryKey()} method returns true.
+     *
+     * @return The delivery key.
+     */
+    virtual uint64_t getDeliveryKey() const { return getSequenceId(); }
+
     /**
      * Obtain the approximate size of this message object in bytes. This enables
      * messagebus to track the size of the send queue in both memory usage and
@@ -111,7 +111,7 @@ MessageBus::MessageBus(INetwork &net, const MessageBusParams &params) :
     _routingTables(),
     _sessions(),
     _protocolRepository(std::make_unique<ProtocolRepository>()),
-    _msn(std::make_unique<Messenger>()),
+    _msn(std::make_unique<Messenger>(params.getNumMessengerThreads())),
     _resender(),
     _maxPendingCount(params.getMaxPendingCount()),
     _maxPendingSize(params.getMaxPendingSize()),
@@ -346,8 +346,9 @@ MessageBus::handleReply(Reply::UP reply)
     _pendingCount.fetch_sub(1, std::memory_order_relaxed);
     _pendingSize.fetch_sub(reply->getContext().value.UINT64,
                            std::memory_order_relaxed);
+    // The reply leaves a session towards the network, which accepts replies from any thread.
     IReplyHandler &handler = reply->getCallStack().pop(*reply);
-    deliverReply(std::move(reply), handler);
+    _msn->deliverSessionReply(std::move(reply), handler);
 }
 
 void
@@ -375,7 +376,7 @@ MessageBus::deliverMessage(Message::UP msg, const string &session)
         deliverError(std::move(msg), ErrorCode::SESSION_BUSY,
                      make_string("Session '%s' is busy, try again later.", session.c_str()));
     } else {
-        _msn->deliverMessage(std::move(msg), *msgHandler);
+        _msn->deliverSessionMessage(std::move(msg), *msgHandler);
     }
 }
 
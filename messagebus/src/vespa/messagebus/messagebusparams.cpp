@@ -8,7 +8,8 @@ MessageBusParams::MessageBusParams() :
     _protocols(),
     _retryPolicy(new RetryTransientErrorsPolicy()),
     _maxPendingCount(1024),
-    _maxPendingSize(128 * 1024 * 1024)
+    _maxPendingSize(128 * 1024 * 1024),
+    _numMessengerThreads(1)
 { }
 
 MessageBusParams::~MessageBusParams() {}
@@ -21,6 +21,7 @@ private:
     IRetryPolicy::SP           _retryPolicy;
     uint32_t                   _maxPendingCount;
     uint32_t                   _maxPendingSize;
+    uint32_t                   _numMessengerThreads;
 
 public:
     /**
@@ -96,6 +97,23 @@ public:
      * @return This, to allow chaining.
      */
     MessageBusParams &setMaxPendingSize(int maxSize) { _maxPendingSize = maxSize; return *this; }
+
+    /**
+     * Returns the number of threads used by the messenger to deliver messages and replies.
+     *
+     * @return The number of threads.
+     */
+    uint32_t getNumMessengerThreads() const { return _numMessengerThreads; }
+
+    /**
+     * Sets the number of threads used by the messenger to deliver messages and replies. Routing and
+     * reply delivery always run on a single thread; the additional threads deliver incoming messages to
+     * destination and intermediate sessions, with each session always called by the same thread.
+     *
+     * @param numThreads The number of threads to set.
+     * @return This, to allow chaining.
+     */
+    MessageBusParams &setNumMessengerThreads(uint32_t numThreads) { _numMessengerThreads = numThreads; return *this; }
 };
 
 } // namespace mbus
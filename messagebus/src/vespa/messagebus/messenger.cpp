@@ -85,10 +85,10 @@ public:
 
 class SyncTask : public mbus::Messenger::ITask {
 private:
-    vespalib::Gate &_gate;
+    vespalib::CountDownLatch &_gate;
 
 public:
-    SyncTask(vespalib::Gate &gate)
+    SyncTask(vespalib::CountDownLatch &gate)
         : _gate(gate)
     {
         // empty
@@ -152,36 +152,52 @@ public:
     }
 };
 
+thread_local const void *_currentShard = nullptr;
+
 } // anonymous
 
 namespace mbus {
 
-Messenger::Messenger() :
-    _monitor(),
+Messenger::Shard::Shard() :
+    monitor(),
+    queue(),
+    closed(false),
+    busy(false)
+{
+    // empty
+}
+
+Messenger::Shard::~Shard() = default;
+
+Messenger::Messenger(uint32_t numThreads) :
     _pool(128000),
     _children(),
-    _queue(),
-    _closed(false)
+    _shards(),
+    _nextReplyShard(0)
 {
-    // empty
+    for (uint32_t i = 0; i < std::max(1u, numThreads); ++i) {
+        _shards.push_back(std::make_unique<Shard>());
+    }
 }
 
 Messenger::~Messenger()
 {
-    {
-        vespalib::MonitorGuard guard(_monitor);
-        _closed = true;
+    for (auto &shard : _shards) {
+        vespalib::MonitorGuard guard(shard->monitor);
+        shard->closed = true;
         guard.broadcast();
     }
     _pool.Close();
     std::for_each(_children.begin(), _children.end(), DeleteFunctor<ITask>());
-    if ( ! _queue.empty()) {
-        LOG(warning,
-            "Messenger shut down with pending tasks, "
-            "please review shutdown logic.");
-        while (!_queue.empty()) {
-            delete _queue.front();
-            _queue.pop();
+    for (auto &shard : _shards) {
+        if ( ! shard->queue.empty()) {
+            LOG(warning,
+                "Messenger shut down with pending tasks, "
+                "please review shutdown logic.");
+            while (!shard->queue.empty()) {
+                delete shard->queue.front();
+                shard->queue.pop();
+            }
         }
     }
 }
@@ -190,20 +206,24 @@ void
 Messenger::Run(FastOS_ThreadInterface *thread, void *arg)
 {
     (void)thread;
-    (void)arg;
+    Shard &shard = *static_cast<Shard *>(arg);
+    bool runChildren = (&shard == _shards[0].get());
+    _currentShard = &shard;
     while (true) {
         ITask::UP task;
         {
-            vespalib::MonitorGuard guard(_monitor);
-            if (_closed) {
+            vespalib::MonitorGuard guard(shard.monitor);
+            shard.busy = false;
+            if (shard.closed) {
                 break;
             }
-            if (_queue.empty()) {
+            if (shard.queue.empty()) {
                 guard.wait(100);
             }
-            if (!_queue.empty()) {
-                task.reset(_queue.front());
-                _queue.pop();
+            if (!shard.queue.empty()) {
+                task.reset(shard.queue.front());
+                shard.queue.pop();
+                shard.busy = true;
             }
         }
         if (task.get() != nullptr) {
@@ -214,10 +234,13 @@ Messenger::Run(FastOS_ThreadInterface *thread, void *arg)
                     "a task; %s", e.what());
             }
         }
-        for (ITask * itask : _children) {
-            itask->run();
+        if (runChildren) {
+            for (ITask * itask : _children) {
+                itask->run();
+            }
         }
     }
+    _currentShard = nullptr;
 }
 
 void
@@ -239,31 +262,69 @@ Messenger::discardRecurrentTasks()
 bool
 Messenger::start()
 {
-    if (_pool.NewThread(this) == 0) {
-        return false;
+    for (auto &shard : _shards) {
+        if (_pool.NewThread(this, shard.get()) == 0) {
+            return false;
+        }
     }
     return true;
 }
 
+Messenger::Shard &
+Messenger::getShard(uint64_t key)
+{
+    if (_shards.size() == 1) {
+        return *_shards[0];
+    }
+    key ^= (key >> 33);
+    key *= 0xff51afd7ed558ccdul;
+    key ^= (key >> 33);
+    return *_shards[key % _shards.size()];
+}
+
 void
 Messenger::deliverMessage(Message::UP msg, IMessageHandler &handler)
 {
-    enqueue(ITask::UP(new MessageTask(std::move(msg), handler)));
+    enqueue(*_shards[0], ITask::UP(new MessageTask(std::move(msg), handler)));
+}
+
+void
+Messenger::deliverSessionMessage(Message::UP msg, IMessageHandler &session)
+{
+    uint64_t key = reinterpret_cast<uintptr_t>(&session);
+    if (msg->hasDeliveryKey()) {
+        key ^= msg->getDeliveryKey();
+    }
+    Shard &shard = getShard(key);
+    enqueue(shard, ITask::UP(new MessageTask(std::move(msg), session)));
 }
 
 void
 Messenger::deliverReply(Reply::UP reply, IReplyHandler &handler)
 {
-    enqueue(ITask::UP(new ReplyTask(std::move(reply), handler)));
+    enqueue(*_shards[0], ITask::UP(new ReplyTask(std::move(reply), handler)));
+}
+
+void
+Messenger::deliverSessionReply(Reply::UP reply, IReplyHandler &handler)
+{
+    Shard &shard = *_shards[_nextReplyShard.fetch_add(1, std::memory_order_relaxed) % _shards.size()];
+    enqueue(shard, ITask::UP(new ReplyTask(std::move(reply), handler)));
 }
 
 void
 Messenger::enqueue(ITask::UP task)
 {
-    vespalib::MonitorGuard guard(_monitor);
-    if (!_closed) {
-        _queue.push(task.release());
-        if (_queue.size() == 1) {
+    enqueue(*_shards[0], std::move(task));
+}
+
+void
+Messenger::enqueue(Shard &shard, ITask::UP task)
+{
+    vespalib::MonitorGuard guard(shard.monitor);
+    if (!shard.closed) {
+        shard.queue.push(task.release());
+        if (shard.queue.size() == 1) {
             guard.signal();
         }
     }
@@ -272,16 +333,26 @@ Messenger::enqueue(ITask::UP task)
 void
 Messenger::sync()
 {
-    vespalib::Gate gate;
-    enqueue(ITask::UP(new SyncTask(gate)));
-    gate.await();
+    vespalib::CountDownLatch latch(_shards.size());
+    for (auto &shard : _shards) {
+        enqueue(*shard, ITask::UP(new SyncTask(latch)));
+    }
+    latch.await();
 }
 
 bool
 Messenger::isEmpty() const
 {
-    vespalib::MonitorGuard guard(_monitor);
-    return _queue.empty();
+    for (const auto &shard : _shards) {
+        vespalib::MonitorGuard guard(shard->monitor);
+        if (!shard->queue.empty()) {
+            return false;
+        }
+        if (shard->busy && (shard.get() != _currentShard)) {
+            return false;
+        }
+    }
+    return true;
 }
 
 } // namespace mbus
@@ -9,13 +9,25 @@
 #include <vespa/vespalib/util/sync.h>
 #include <vespa/vespalib/util/arrayqueue.hpp>
 #include <vespa/fastos/thread.h>
+#include <atomic>
 
 namespace mbus {
 
 /**
- * This class implements a single thread that is able to process arbitrary
+ * This class implements a set of threads that are able to process arbitrary
  * tasks. Tasks are enqueued using the synchronized {@link #enqueue(Task)}
  * method, and are run in the order they were enqueued.
+ *
+ * Each thread owns a queue of its own. The first thread is the routing
+ * thread; it runs control tasks, recurrent tasks (the resender), all routing
+ * of outgoing messages and all reply delivery. Routing policies, source
+ * sessions and application reply handlers are therefore only ever called by
+ * a single thread, as they were written for. Messages delivered to a
+ * destination or intermediate session are spread across the threads by their
+ * delivery key (see Message::getDeliveryKey()), so that messages with the
+ * same key are still seen in order from a single thread. Replies from those
+ * sessions are spread across the threads as well, as they are returned to
+ * the network, which handles them concurrently anyway.
  */
 class Messenger : public FastOS_Runnable {
 public:
@@ -40,11 +52,22 @@ public:
     };
 
 private:
-    vespalib::Monitor   _monitor;
-    FastOS_ThreadPool   _pool;
-    std::vector<ITask*> _children;
-    vespalib::ArrayQueue<ITask*>  _queue;
-    bool                _closed;
+    struct Shard {
+        vespalib::Monitor            monitor;
+        vespalib::ArrayQueue<ITask*> queue;
+        bool                         closed;
+        bool                         busy;
+        Shard();
+        ~Shard();
+    };
+
+    FastOS_ThreadPool                   _pool;
+    std::vector<ITask*>                 _children;
+    std::vector<std::unique_ptr<Shard>> _shards;
+    std::atomic<uint32_t>               _nextReplyShard;
+
+    Shard &getShard(uint64_t key);
+    static void enqueue(Shard &shard, ITask::UP task);
 
 protected:
     void Run(FastOS_ThreadInterface *thread, void *arg) override;
@@ -52,8 +75,10 @@ protected:
 public:
     /**
      * Constructs a new messenger object.
+     *
+     * @param numThreads The number of threads to run tasks in.
      */
-    Messenger();
+    Messenger(uint32_t numThreads = 1);
 
     /**
      * Frees any allocated resources. Also destroys all queued tasks.
@@ -76,32 +101,54 @@ public:
     void discardRecurrentTasks();
 
     /**
-     * Starts the internal thread. This must be done AFTER all recurrent tasks
+     * Starts the internal threads. This must be done AFTER all recurrent tasks
      * have been added.
      *
-     * @return True if the thread was started.
+     * @return True if the threads were started.
      * @see #addRecurrentTask(ITask)
      */
     bool start();
 
     /**
-     * Handshakes with the internal thread. If this method is called using the
-     * messenger thread, this will deadlock.
+     * Handshakes with all the internal threads. If this method is called using
+     * a messenger thread, this will deadlock.
      */
     void sync();
 
     /**
      * Convenience method to post a {@link MessageTask} to the queue of tasks to
-     * be executed.
+     * be executed by the routing thread.
      *
      * @param msg     The message to send.
      * @param handler The handler to send to.
      */
     void deliverMessage(Message::UP msg, IMessageHandler &handler);
 
+    /**
+     * Convenience method to post a {@link MessageTask} for a message that has
+     * arrived at the given session. Messages for one session with the same
+     * delivery key, or without one, are run by the same thread, in the order
+     * they were delivered.
+     *
+     * @param msg     The message to deliver.
+     * @param session The session to deliver to.
+     */
+    void deliverSessionMessage(Message::UP msg, IMessageHandler &session);
+
+    /**
+     * Convenience method to post a {@link ReplyTask} for a reply from a
+     * destination or intermediate session to the network. Such replies are
+     * independent of each other, so they are spread evenly across all
+     * threads.
+     *
+     * @param reply   The reply to return.
+     * @param handler The handler to return to.
+     */
+    void deliverSessionReply(Reply::UP reply, IReplyHandler &handler);
+
     /**
      * Convenience method to post a {@link ReplyTask} to the queue of tasks to
-     * be executed.
+     * be executed by the routing thread.
      *
      * @param reply   The reply to return.
      * @param handler The handler to return to.
@@ -109,20 +156,29 @@ public:
     void deliverReply(Reply::UP reply, IReplyHandler &handler);
 
     /**
-     * Enqueues the given task in the list of tasks that this worker is to
-     * process. If this thread has been destroyed previously, this method
-     * invokes {@link Messenger.Task#destroy()}.
+     * Enqueues the given task in the list of tasks that the first thread of
+     * this worker is to process. If this thread has been destroyed previously,
+     * this method invokes {@link Messenger.Task#destroy()}.
      *
      * @param task The task to enqueue.
      */
     void enqueue(ITask::UP task);
 
     /**
-     * Returns whether or not there are any tasks queued for execution.
+     * Returns whether or not there are any tasks queued for execution. When
+     * called by a messenger thread, the task currently being run by that
+     * thread is not counted.
      *
      * @return True if there are no tasks.
      */
     bool isEmpty() const;
+
+    /**
+     * Returns the number of threads used to run tasks.
+     *
+     * @return The number of threads.
+     */
+    uint32_t getNumThreads() const { return _shards.size(); }
 };
 
 } // namespace mbus
@@ -1,6 +1,7 @@
 // Copyright 2017 Yahoo Holdings. Licensed under the terms of the Apache 2.0 license. See LICENSE in the project root.
 #include "rpcnetwork.h"
 #include "rpcservicepool.h"
+#include "rpcsendbatch.h"
 #include "rpcsendv1.h"
 #include "rpcsendv2.h"
 #include "rpctargetpool.h"
@@ -124,10 +125,12 @@ RPCNetwork::RPCNetwork(const RPCNetworkParams &params) :
     _executor(std::make_unique<vespalib::ThreadStackExecutor>(params.getNumThreads(), 65536)),
     _sendV1(std::make_unique<RPCSendV1>()),
     _sendV2(std::make_unique<RPCSendV2>()),
+    _sendBatch(std::make_unique<RPCSendBatch>(*_sendV2, params.getMaxSendBatchSize(), params.getMaxSendBatchBytes())),
     _sendAdapters(),
     _compressionConfig(params.getCompressionConfig()),
     _allowDispatchForEncode(params.getDispatchOnEncode()),
-    _allowDispatchForDecode(params.getDispatchOnDecode())
+    _allowDispatchForDecode(params.getDispatchOnDecode()),
+    _batchSends(params.getMaxSendBatchSize() > 1)
 {
     _transport->SetMaxInputBufferSize(params.getMaxInputBufferSize());
     _transport->SetMaxOutputBufferSize(params.getMaxOutputBufferSize());
@@ -185,7 +188,13 @@ RPCNetwork::attach(INetworkOwner &owner)
     _sendV1->attach(*this);
     _sendV2->attach(*this);
     _sendAdapters[vespalib::Version(5)] = _sendV1.get();
-    _sendAdapters[vespalib::Version(6, 149)] = _sendV2.get();
+    if (_batchSends) {
+        // Whether a peer serves batches is found out when sending the first batch to it.
+        _sendBatch->attach(*this);
+        _sendAdapters[vespalib::Version(6, 149)] = _sendBatch.get();
+    } else {
+        _sendAdapters[vespalib::Version(6, 149)] = _sendV2.get();
+    }
 
     FRT_ReflectionBuilder builder(_orb.get());
     builder.DefineMethod("mbus.getVersion", "", "s", FRT_METHOD(RPCNetwork::invoke), this);
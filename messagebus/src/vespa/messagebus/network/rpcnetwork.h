@@ -27,6 +27,7 @@ class RPCServicePool;
 class RPCTargetPool;
 class RPCNetworkParams;
 class RPCServiceAddress;
+class RPCSendBatch;
 
 /**
  * Network implementation based on RPC. This class is responsible for
@@ -75,10 +76,12 @@ private:
     std::unique_ptr<vespalib::ThreadStackExecutor>  _executor;
     std::unique_ptr<RPCSendAdapter>                 _sendV1;
     std::unique_ptr<RPCSendAdapter>                 _sendV2;
+    std::unique_ptr<RPCSendBatch>                   _sendBatch;
     SendAdapterMap                                  _sendAdapters;
     CompressionConfig                               _compressionConfig;
     bool                                            _allowDispatchForEncode;
     bool                                            _allowDispatchForDecode;
+    bool                                            _batchSends;
 
 
     /**
@@ -18,7 +18,9 @@ RPCNetworkParams::RPCNetworkParams(config::ConfigUri configUri) :
     _dispatchOnEncode(true),
     _dispatchOnDecode(false),
     _connectionExpireSecs(600),
-    _compressionConfig(CompressionConfig::LZ4, 6, 90, 1024)
+    _compressionConfig(CompressionConfig::LZ4, 6, 90, 1024),
+    _maxSendBatchSize(1),
+    _maxSendBatchBytes(64*1024)
 { }
 
 RPCNetworkParams::~RPCNetworkParams() = default;
@@ -24,6 +24,8 @@ private:
     bool              _dispatchOnDecode;
     double            _connectionExpireSecs;
     CompressionConfig _compressionConfig;
+    uint32_t          _maxSendBatchSize;
+    uint32_t          _maxSendBatchBytes;
 
 public:
     RPCNetworkParams();
@@ -190,6 +192,36 @@ public:
     }
 
     uint32_t getDispatchOnEncode() const { return _dispatchOnEncode; }
+
+    /**
+     * Sets the maximum number of messages to the same target that are sent as a single RPC request. Using
+     * a value above 1 enables batching, both for sending and for serving batches. It is only used towards
+     * targets that have it enabled as well; messages to other targets, like the Java implementation which
+     * does not serve batches, are sent one by one. Batching is disabled by default.
+     *
+     * @param maxSendBatchSize The maximum number of messages.
+     * @return This, to allow chaining.
+     */
+    RPCNetworkParams &setMaxSendBatchSize(uint32_t maxSendBatchSize) {
+        _maxSendBatchSize = maxSendBatchSize;
+        return *this;
+    }
+
+    uint32_t getMaxSendBatchSize() const { return _maxSendBatchSize; }
+
+    /**
+     * Sets the number of payload bytes that causes a batch of messages to be sent right away, instead of
+     * waiting for more messages.
+     *
+     * @param maxSendBatchBytes The maximum number of bytes.
+     * @return This, to allow chaining.
+     */
+    RPCNetworkParams &setMaxSendBatchBytes(uint32_t maxSendBatchBytes) {
+        _maxSendBatchBytes = maxSendBatchBytes;
+        return *this;
+    }
+
+    uint32_t getMaxSendBatchBytes() const { return _maxSendBatchBytes; }
 };
 
 }
@@ -0,0 +1,851 @@
+// Copyright 2019 Oath Inc. Licensed under the terms of the Apache 2.0 license. See LICENSE in the project root.
+
+#include "rpcsendbatch.h"
+#include "rpcsend_private.h"
+#include "rpcnetwork.h"
+#include "rpcserviceaddress.h"
+#include <vespa/messagebus/emptyreply.h>
+#include <vespa/messagebus/errorcode.h>
+#include <vespa/messagebus/iprotocol.h>
+#include <vespa/messagebus/tracelevel.h>
+#include <vespa/fnet/channel.h>
+#include <vespa/fnet/frt/reflection.h>
+#include <vespa/fnet/frt/rpcrequest.h>
+#include <vespa/vespalib/data/databuffer.h>
+#include <vespa/vespalib/data/slime/slime.h>
+#include <vespa/vespalib/data/slime/inject.h>
+#include <vespa/vespalib/util/compressor.h>
+#include <vespa/vespalib/util/lambdatask.h>
+#include <vespa/vespalib/util/stringfmt.h>
+#include <cinttypes>
+#include <cstring>
+
+using vespalib::make_string;
+using vespalib::makeLambdaTask;
+using vespalib::compression::CompressionConfig;
+using vespalib::compression::decompress;
+using vespalib::compression::compress;
+using vespalib::DataBuffer;
+using vespalib::ConstBufferRef;
+using vespalib::stringref;
+using vespalib::Memory;
+using vespalib::Slime;
+using vespalib::Version;
+using namespace vespalib::slime;
+
+namespace mbus {
+
+using network::internal::SendContext;
+
+namespace {
+
+const char *METHOD_NAME   = "mbus.slime.batch";
+const char *METHOD_PARAMS = "bix";
+const char *METHOD_RETURN = "bix";
+const char *POLL_NAME     = "mbus.slime.batch.poll";
+const char *POLL_PARAMS   = "li";
+
+// How long the replies to a batch are kept for a client that has stopped polling.
+const std::chrono::seconds ABANDONED_BATCH_AGE(60);
+
+Memory BATCH_F("batch");
+Memory MESSAGES_F("messages");
+Memory REPLIES_F("replies");
+Memory FIRST_F("first");
+Memory INDEX_F("index");
+Memory VERSION_F("version");
+Memory ROUTE_F("route");
+Memory SESSION_F("session");
+Memory USERETRY_F("useretry");
+Memory RETRYDELAY_F("retrydelay");
+Memory RETRY_F("retry");
+Memory TIMELEFT_F("timeleft");
+Memory PROTOCOL_F("prot");
+Memory TRACELEVEL_F("tracelevel");
+Memory TRACE_F("trace");
+Memory BLOB_F("msg");
+Memory ERRORS_F("errors");
+Memory CODE_F("code");
+Memory MSG_F("msg");
+Memory SERVICE_F("service");
+
+class OutputBuf : public vespalib::Output {
+public:
+    explicit OutputBuf(size_t estimatedSize) : _buf(estimatedSize) { }
+    DataBuffer & getBuf() { return _buf; }
+private:
+    vespalib::WritableMemory reserve(size_t bytes) override {
+        _buf.ensureFree(bytes);
+        return vespalib::WritableMemory(_buf.getFree(), _buf.getFreeLen());
+    }
+    Output &commit(size_t bytes) override {
+        _buf.moveFreeToData(bytes);
+        return *this;
+    }
+    DataBuffer _buf;
+};
+
+void
+encodeSlime(const Slime &slime, CompressionConfig config, FRT_Values &values)
+{
+    OutputBuf rBuf(8192);
+    BinaryFormat::encode(slime, rBuf);
+    ConstBufferRef toCompress(rBuf.getBuf().getData(), rBuf.getBuf().getDataLen());
+    DataBuffer buf(vespalib::roundUp2inN(rBuf.getBuf().getDataLen()));
+    CompressionConfig::Type type = compress(config, toCompress, buf, false);
+
+    values.AddInt8(type);
+    values.AddInt32(toCompress.size());
+    const auto bufferLength = buf.getDataLen();
+    assert(bufferLength <= INT32_MAX);
+    values.AddData(buf.stealBuffer(), bufferLength);
+}
+
+void
+decodeSlime(const FRT_Values &values, Slime &slime)
+{
+    uint8_t encoding = values[0]._intval8;
+    uint32_t uncompressedSize = values[1]._intval32;
+    DataBuffer uncompressed(values[2]._data._buf, values[2]._data._len);
+    ConstBufferRef blob(values[2]._data._buf, values[2]._data._len);
+    decompress(CompressionConfig::toType(encoding), uncompressedSize, blob, uncompressed, true);
+    assert(uncompressedSize == uncompressed.getDataLen());
+    BinaryFormat::decode(Memory(uncompressed.getData(), uncompressed.getDataLen()), slime);
+}
+
+Error
+toError(FRT_RPCRequest &req, const string &serviceName, double timeout)
+{
+    switch (req.GetErrorCode()) {
+    case FRTE_RPC_TIMEOUT:
+        return Error(ErrorCode::TIMEOUT,
+                     make_string("A timeout occured while waiting for '%s' (%g seconds expired); %s",
+                                 serviceName.c_str(), timeout, req.GetErrorMessage()));
+    case FRTE_RPC_CONNECTION:
+        return Error(ErrorCode::CONNECTION_ERROR,
+                     make_string("A connection error occured for '%s'; %s",
+                                 serviceName.c_str(), req.GetErrorMessage()));
+    default:
+        return Error(ErrorCode::NETWORK_ERROR,
+                     make_string("A network error occured for '%s'; %s",
+                                 serviceName.c_str(), req.GetErrorMessage()));
+    }
+}
+
+const string &
+getServiceName(SendContext &ctx)
+{
+    return static_cast<RPCServiceAddress&>(ctx.getRecipient().getServiceAddress()).getServiceName();
+}
+
+Error
+timeoutError(SendContext &ctx)
+{
+    return Error(ErrorCode::TIMEOUT,
+                 make_string("A timeout occured while waiting for '%s' (%g seconds expired); "
+                             "no reply in the batch sent to it.",
+                             getServiceName(ctx).c_str(), ctx.getTimeout()));
+}
+
+}
+
+/**
+ * The messages that are being sent to a single target, encoded into a slime array. The send context of
+ * each message is kept at the same index, to match the replies up with their recipients. After it has
+ * been sent, a batch is only accessed by the thread that completes its current request.
+ */
+struct RPCSendBatch::Batch {
+    struct Entry {
+        SendContext::UP   context;
+        Version           version;
+        Clock::time_point deadline;
+        bool              done;
+    };
+    RPCTarget          &target;
+    uint64_t            id;
+    Slime               slime;
+    Cursor             &messages;
+    std::vector<Entry>  entries;
+    size_t              bytes;
+    uint32_t            received;
+    uint32_t            outstanding;
+
+    Batch(RPCTarget &target_in, uint64_t id_in)
+        : target(target_in),
+          id(id_in),
+          slime(),
+          messages(slime.setObject().setArray(MESSAGES_F)),
+          entries(),
+          bytes(0),
+          received(0),
+          outstanding(0)
+    {
+        slime.get().setLong(BATCH_F, id);
+    }
+
+    // Returns the seconds until the earliest deadline of the messages that are waiting for a reply.
+    double timeout(Clock::time_point now) const {
+        Clock::time_point earliest = Clock::time_point::max();
+        for (const Entry &entry : entries) {
+            if (!entry.done) {
+                earliest = std::min(earliest, entry.deadline);
+            }
+        }
+        return std::max(0.001, std::chrono::duration<double>(earliest - now).count());
+    }
+};
+
+/**
+ * The state of a batch request that has been received. Each message holds a pointer to its entry as
+ * context. The replies are encoded in the order they arrive, and kept until they have been returned
+ * to the client. All mutable state is guarded by the server lock of the adapter.
+ */
+struct RPCSendBatch::ServerBatch {
+    struct Entry {
+        ServerBatch *batch;
+        uint32_t     index;
+        Version      version;
+    };
+    uint64_t               id;
+    Slime                  params;
+    std::vector<Entry>     entries;
+    bool                   sequenced;
+    bool                   dispatched;
+    bool                   abandoned;
+    Slime                  done;
+    Cursor                &doneReplies;
+    FRT_RPCRequest        *waiting;
+    uint32_t               waitingFirst;
+    Clock::time_point      lastActive;
+
+    explicit ServerBatch(FRT_RPCRequest &request)
+        : id(0),
+          params(),
+          entries(),
+          sequenced(false),
+          dispatched(false),
+          abandoned(false),
+          done(),
+          doneReplies(done.setArray()),
+          waiting(&request),
+          waitingFirst(0),
+          lastActive(Clock::now())
+    { }
+
+    uint32_t numDone() const { return done.get().entries(); }
+};
+
+RPCSendBatch::RPCSendBatch(RPCSendAdapter &fallback, uint32_t maxBatchSize, uint32_t maxBatchBytes)
+    : _net(nullptr),
+      _fallback(fallback),
+      _maxBatchSize(maxBatchSize),
+      _maxBatchBytes(maxBatchBytes),
+      _clientIdent("client"),
+      _serverIdent("server"),
+      _lock(),
+      _batches(),
+      _flushScheduled(false),
+      _idGenerator(std::random_device()()),
+      _serverLock(),
+      _serverBatches(),
+      _nextSweep(Clock::now() + ABANDONED_BATCH_AGE)
+{ }
+
+RPCSendBatch::~RPCSendBatch() = default;
+
+bool
+RPCSendBatch::isCompatible(stringref method, stringref request, stringref response)
+{
+    return  (method == METHOD_NAME) &&
+            (request == METHOD_PARAMS) &&
+            (response == METHOD_RETURN);
+}
+
+void
+RPCSendBatch::attach(RPCNetwork &net)
+{
+    _net = &net;
+    const string &prefix = _net->getIdentity().getServicePrefix();
+    if (!prefix.empty()) {
+        _clientIdent = make_string("'%s'", prefix.c_str());
+        _serverIdent = _clientIdent;
+    }
+
+    FRT_ReflectionBuilder builder(&_net->getSupervisor());
+    builder.DefineMethod(METHOD_NAME, METHOD_PARAMS, METHOD_RETURN, FRT_METHOD(RPCSendBatch::invoke), this);
+    builder.MethodDesc("Send a batch of message bus slime requests and get the first replies back.");
+    builder.ParamDesc("encoding", "0=raw, 6=lz4");
+    builder.ParamDesc("decoded_size", "Uncompressed blob size");
+    builder.ParamDesc("payload", "The batch id and the messages in slime");
+    builder.ReturnDesc("encoding",  "0=raw, 6=lz4");
+    builder.ReturnDesc("decoded_size", "Uncompressed blob size");
+    builder.ReturnDesc("payload", "The replies that are ready in slime, each with the index of its message.");
+    builder.DefineMethod(POLL_NAME, POLL_PARAMS, METHOD_RETURN, FRT_METHOD(RPCSendBatch::invokePoll), this);
+    builder.MethodDesc("Wait for more replies to a batch of message bus slime requests.");
+    builder.ParamDesc("batch", "The id of the batch");
+    builder.ParamDesc("first", "The number of replies received so far");
+    builder.ReturnDesc("encoding",  "0=raw, 6=lz4");
+    builder.ReturnDesc("decoded_size", "Uncompressed blob size");
+    builder.ReturnDesc("payload", "The replies that are ready in slime, each with the index of its message.");
+}
+
+void
+RPCSendBatch::sendByHandover(RoutingNode &recipient, const Version &version, Blob payload, uint64_t timeRemaining)
+{
+    send(recipient, version, BlobRef(payload.data(), payload.size()), timeRemaining);
+}
+
+void
+RPCSendBatch::send(RoutingNode &recipient, const Version &version, BlobRef payload, uint64_t timeRemaining)
+{
+    Route route = recipient.getRoute();
+    Hop hop = route.removeHop(0);
+    RPCServiceAddress &address = static_cast<RPCServiceAddress&>(recipient.getServiceAddress());
+    if (hop.getIgnoreResult() || address.getTarget().isBatchingUnsupported()) {
+        _fallback.send(recipient, version, payload, timeRemaining);
+        return;
+    }
+    auto ctx = std::make_unique<SendContext>(recipient, timeRemaining);
+    const Message &msg = recipient.getMessage();
+    if (ctx->getTrace().shouldTrace(TraceLevel::SEND_RECEIVE)) {
+        ctx->getTrace().trace(TraceLevel::SEND_RECEIVE,
+                              make_string("Batching message (version %s) from %s to '%s' with %.2f seconds timeout.",
+                                          version.toString().c_str(), _clientIdent.c_str(),
+                                          address.getServiceName().c_str(), ctx->getTimeout()));
+    }
+    Clock::time_point deadline = Clock::now() + std::chrono::milliseconds(timeRemaining);
+    std::unique_ptr<Batch> full;
+    bool schedule = false;
+    {
+        std::lock_guard<std::mutex> guard(_lock);
+        std::unique_ptr<Batch> &batch = _batches[&address.getTarget()];
+        if ( ! batch) {
+            batch = std::make_unique<Batch>(address.getTarget(), _idGenerator());
+        }
+        Cursor &entry = batch->messages.addObject();
+        entry.setString(VERSION_F, version.toString());
+        entry.setString(ROUTE_F, route.toString());
+        entry.setString(SESSION_F, address.getSessionName());
+        entry.setBool(USERETRY_F, msg.getRetryEnabled());
+        entry.setLong(RETRY_F, msg.getRetry());
+        entry.setLong(TIMELEFT_F, timeRemaining);
+        entry.setString(PROTOCOL_F, msg.getProtocol());
+        entry.setLong(TRACELEVEL_F, recipient.getTrace().getLevel());
+        entry.setData(BLOB_F, Memory(payload.data(), payload.size()));
+        batch->bytes += payload.size();
+        batch->entries.push_back(Batch::Entry{std::move(ctx), version, deadline, false});
+        if ((batch->entries.size() >= _maxBatchSize) || (batch->bytes >= _maxBatchBytes)) {
+            full = std::move(batch);
+            _batches.erase(&address.getTarget());
+        } else if ( ! _flushScheduled) {
+            _flushScheduled = true;
+            schedule = true;
+        }
+    }
+    if (full) {
+        sendBatch(std::move(full));
+    } else if (schedule) {
+        auto rejected = _net->getExecutor().execute(makeLambdaTask([this]() { flush(); }));
+        if (rejected) {
+            flush();
+        }
+    }
+}
+
+void
+RPCSendBatch::flush()
+{
+    BatchMap batches;
+    {
+        std::lock_guard<std::mutex> guard(_lock);
+        batches.swap(_batches);
+        _flushScheduled = false;
+    }
+    for (auto &entry : batches) {
+        sendBatch(std::move(entry.second));
+    }
+}
+
+void
+RPCSendBatch::sendBatch(std::unique_ptr<Batch> batch)
+{
+    if (batch->target.isBatchingUnsupported()) {
+        sendFallback(std::move(batch));
+        return;
+    }
+    batch->outstanding = batch->entries.size();
+    FRT_RPCRequest *req = _net->allocRequest();
+    req->SetMethodName(METHOD_NAME);
+    encodeSlime(batch->slime, _net->getCompressionConfig(), *req->GetParams());
+    invokeTarget(std::move(batch), req);
+}
+
+void
+RPCSendBatch::sendFallback(std::unique_ptr<Batch> batch)
+{
+    Clock::time_point now = Clock::now();
+    for (uint32_t i = 0; i < batch->entries.size(); ++i) {
+        Batch::Entry &entry = batch->entries[i];
+        auto timeRemaining = std::chrono::duration_cast<std::chrono::milliseconds>(entry.deadline - now).count();
+        if (timeRemaining <= 0) {
+            deliverReply(*batch, i, std::make_unique<EmptyReply>(), timeoutError(*entry.context));
+        } else {
+            Memory payload = batch->messages[i][BLOB_F].asData();
+            _fallback.send(entry.context->getRecipient(), entry.version,
+                           BlobRef(payload.data, payload.size), timeRemaining);
+        }
+    }
+}
+
+void
+RPCSendBatch::poll(std::unique_ptr<Batch> batch)
+{
+    expireOverdue(*batch);
+    if (batch->outstanding == 0) {
+        return;
+    }
+    FRT_RPCRequest *req = _net->allocRequest();
+    req->SetMethodName(POLL_NAME);
+    req->GetParams()->AddInt64(batch->id);
+    req->GetParams()->AddInt32(batch->received);
+    invokeTarget(std::move(batch), req);
+}
+
+void
+RPCSendBatch::invokeTarget(std::unique_ptr<Batch> batch, FRT_RPCRequest *req)
+{
+    double timeout = batch->timeout(Clock::now());
+    Batch *ptr = batch.release();
+    req->SetContext(FNET_Context(ptr));
+    ptr->target.getFRTTarget().InvokeAsync(req, timeout, this);
+}
+
+void
+RPCSendBatch::RequestDone(FRT_RPCRequest *req)
+{
+    std::unique_ptr<Batch> batch(static_cast<Batch*>(req->GetContext()._value.VOIDP));
+    if (req->CheckReturnTypes(METHOD_RETURN)) {
+        handleReplies(*batch, *req);
+        req->SubRef();
+        poll(std::move(batch));
+        return;
+    }
+    if ((req->GetErrorCode() == FRTE_RPC_NO_SUCH_METHOD) && (strcmp(req->GetMethodName(), METHOD_NAME) == 0)) {
+        req->SubRef();
+        batch->target.setBatchingUnsupported();
+        sendFallback(std::move(batch));
+        return;
+    }
+    if (req->GetErrorCode() == FRTE_RPC_TIMEOUT) {
+        // Only the messages that have passed their own deadline have timed out.
+        req->SubRef();
+        poll(std::move(batch));
+        return;
+    }
+    for (uint32_t i = 0; i < batch->entries.size(); ++i) {
+        SendContext &ctx = *batch->entries[i].context;
+        if (!batch->entries[i].done) {
+            deliverReply(*batch, i, std::make_unique<EmptyReply>(), toError(*req, getServiceName(ctx), ctx.getTimeout()));
+        }
+    }
+    req->SubRef();
+}
+
+void
+RPCSendBatch::handleReplies(Batch &batch, FRT_RPCRequest &req)
+{
+    Slime slime;
+    decodeSlime(*req.GetReturn(), slime);
+    uint32_t first = slime.get()[FIRST_F].asLong();
+    Inspector &replies = slime.get()[REPLIES_F];
+    for (uint32_t i = 0; i < replies.entries(); ++i) {
+        Inspector &root = replies[i];
+        uint32_t idx = root[INDEX_F].asLong();
+        if ((first + i < batch.received) || (idx >= batch.entries.size()) || batch.entries[idx].done) {
+            continue;
+        }
+        const string &serviceName = getServiceName(*batch.entries[idx].context);
+        Error error;
+        Version version(root[VERSION_F].asString().make_string());
+        Memory payload = root[BLOB_F].asData();
+        Reply::UP reply;
+        if (payload.size > 0) {
+            reply = decodeReply(root[PROTOCOL_F].asString().make_stringref(), version,
+                                BlobRef(payload.data, payload.size), error);
+        }
+        if ( ! reply ) {
+            reply = std::make_unique<EmptyReply>();
+        }
+        reply->setRetryDelay(root[RETRYDELAY_F].asDouble());
+        Inspector &errors = root[ERRORS_F];
+        for (uint32_t j = 0; j < errors.entries(); ++j) {
+            Inspector &e = errors[j];
+            Memory service = e[SERVICE_F].asString();
+            reply->addError(Error(e[CODE_F].asLong(), e[MSG_F].asString().make_string(),
+                                  (service.size > 0) ? service.make_string() : serviceName));
+        }
+        batch.entries[idx].context->getTrace().getRoot().addChild(TraceNode::decode(root[TRACE_F].asString().make_string()));
+        deliverReply(batch, idx, std::move(reply), error);
+    }
+    batch.received = std::max(batch.received, first + uint32_t(replies.entries()));
+}
+
+void
+RPCSendBatch::expireOverdue(Batch &batch)
+{
+    Clock::time_point now = Clock::now();
+    for (uint32_t i = 0; i < batch.entries.size(); ++i) {
+        Batch::Entry &entry = batch.entries[i];
+        if (!entry.done && (entry.deadline <= now)) {
+            deliverReply(batch, i, std::make_unique<EmptyReply>(), timeoutError(*entry.context));
+        }
+    }
+}
+
+void
+RPCSendBatch::deliverReply(Batch &batch, uint32_t idx, Reply::UP reply, const Error &error)
+{
+    Batch::Entry &entry = batch.entries[idx];
+    entry.done = true;
+    if (batch.outstanding > 0) {
+        --batch.outstanding;
+    }
+    Trace &trace = entry.context->getTrace();
+    if (trace.shouldTrace(TraceLevel::SEND_RECEIVE)) {
+        trace.trace(TraceLevel::SEND_RECEIVE,
+                    make_string("Reply (type %d) received at %s.", reply->getType(), _clientIdent.c_str()));
+    }
+    reply->getTrace().swap(trace);
+    if (error.getCode() != ErrorCode::NONE) {
+        reply->addError(error);
+    }
+    _net->getOwner().deliverReply(std::move(reply), entry.context->getRecipient());
+}
+
+std::unique_ptr<Reply>
+RPCSendBatch::decodeReply(stringref protocolName, const Version &version, BlobRef payload, Error &error) const
+{
+    Reply::UP reply;
+    IProtocol * protocol = _net->getOwner().getProtocol(protocolName);
+    if (protocol == nullptr) {
+        error = Error(ErrorCode::UNKNOWN_PROTOCOL,
+                      make_string("Protocol '%s' is not known by %s.", vespalib::string(protocolName).c_str(), _serverIdent.c_str()));
+        return reply;
+    }
+    Routable::UP routable = protocol->decode(version, payload);
+    if ( ! routable) {
+        error = Error(ErrorCode::DECODE_ERROR,
+                      make_string("Protocol '%s' failed to decode routable.", vespalib::string(protocolName).c_str()));
+    } else if ( ! routable->isReply()) {
+        error = Error(ErrorCode::DECODE_ERROR, "Payload decoded to a message when expecting a reply.");
+    } else {
+        reply.reset(static_cast<Reply*>(routable.release()));
+    }
+    return reply;
+}
+
+void
+RPCSendBatch::invoke(FRT_RPCRequest *req)
+{
+    auto owner = std::make_unique<ServerBatch>(*req);
+    ServerBatch &batch = *owner;
+    decodeSlime(*req->GetParams(), batch.params);
+    req->DiscardBlobs();
+    batch.id = batch.params.get()[BATCH_F].asLong();
+    Inspector &messages = batch.params.get()[MESSAGES_F];
+    if (messages.entries() == 0) {
+        // There would never be a reply to answer the request with.
+        req->SetError(FRTE_RPC_BAD_REQUEST, make_string("Batch %" PRIu64 " holds no messages.", batch.id).c_str());
+        return;
+    }
+    req->Detach();
+    batch.entries.resize(messages.entries());
+    for (uint32_t i = 0; i < batch.entries.size(); ++i) {
+        batch.entries[i].batch = &batch;
+        batch.entries[i].index = i;
+        batch.entries[i].version = Version(messages[i][VERSION_F].asString().make_stringref());
+        const IProtocol *protocol = _net->getOwner().getProtocol(messages[i][PROTOCOL_F].asString().make_stringref());
+        if ((protocol != nullptr) && protocol->requireSequencing()) {
+            batch.sequenced = true;
+        }
+    }
+    std::vector<ParkedRequest> expired;
+    {
+        std::lock_guard<std::mutex> guard(_serverLock);
+        sweepAbandoned(batch.lastActive, expired);
+    }
+    returnEmpty(expired);
+    {
+        std::lock_guard<std::mutex> guard(_serverLock);
+        if (_serverBatches.find(batch.id) != _serverBatches.end()) {
+            req->SetError(FRTE_RPC_METHOD_FAILED, make_string("Batch %" PRIu64 " is already known by %s.",
+                                                              batch.id, _serverIdent.c_str()).c_str());
+            req->Return();
+            return;
+        }
+        _serverBatches.emplace(batch.id, std::move(owner));
+    }
+    if (batch.sequenced || !_net->allowDispatchForDecode()) {
+        doRequest(batch);
+    } else {
+        auto rejected = _net->getExecutor().execute(makeLambdaTask([this, &batch]() { doRequest(batch); }));
+        assert (!rejected);
+    }
+}
+
+void
+RPCSendBatch::invokePoll(FRT_RPCRequest *req)
+{
+    uint64_t id = req->GetParams()->GetValue(0)._intval64;
+    uint32_t first = req->GetParams()->GetValue(1)._intval32;
+    FRT_RPCRequest *replaced = nullptr;
+    FRT_RPCRequest *respond = nullptr;
+    Slime response;
+    std::unique_ptr<ServerBatch> finished;
+    {
+        std::lock_guard<std::mutex> guard(_serverLock);
+        auto it = _serverBatches.find(id);
+        if (it == _serverBatches.end()) {
+            req->SetError(FRTE_RPC_METHOD_FAILED, make_string("Batch %" PRIu64 " is not known by %s.",
+                                                              id, _serverIdent.c_str()).c_str());
+            return;
+        }
+        req->Detach();
+        ServerBatch &batch = *it->second;
+        // The client has given up on the request it sent before.
+        replaced = batch.waiting;
+        batch.waiting = req;
+        batch.waitingFirst = first;
+        batch.abandoned = false;
+        batch.lastActive = Clock::now();
+        respond = takeResponse(batch, response, finished);
+    }
+    if (replaced != nullptr) {
+        returnEmpty({ParkedRequest(replaced, first)});
+    }
+    if (respond != nullptr) {
+        encodeSlime(response, _net->getCompressionConfig(), *respond->GetReturn());
+        respond->Return();
+    }
+}
+
+void
+RPCSendBatch::doRequest(ServerBatch &batch)
+{
+    Inspector &messages = batch.params.get()[MESSAGES_F];
+    for (uint32_t i = 0; i < batch.entries.size(); ++i) {
+        Inspector &params = messages[i];
+        ServerBatch::Entry &entry = batch.entries[i];
+        uint32_t traceLevel = params[TRACELEVEL_F].asLong();
+        stringref protocolName = params[PROTOCOL_F].asString().make_stringref();
+        IProtocol * protocol = _net->getOwner().getProtocol(protocolName);
+        if (protocol == nullptr) {
+            replyError(batch, i, traceLevel,
+                       Error(ErrorCode::UNKNOWN_PROTOCOL, make_string("Protocol '%s' is not known by %s.",
+                                                                      vespalib::string(protocolName).c_str(), _serverIdent.c_str())));
+            continue;
+        }
+        Memory payload = params[BLOB_F].asData();
+        Routable::UP routable = protocol->decode(entry.version, BlobRef(payload.data, payload.size));
+        if ( ! routable ) {
+            replyError(batch, i, traceLevel,
+                       Error(ErrorCode::DECODE_ERROR,
+                             make_string("Protocol '%s' failed to decode routable.", vespalib::string(protocolName).c_str())));
+            continue;
+        }
+        if (routable->isReply()) {
+            replyError(batch, i, traceLevel,
+                       Error(ErrorCode::DECODE_ERROR, "Payload decoded to a reply when expecting a mesage."));
+            continue;
+        }
+        Message::UP msg(static_cast<Message*>(routable.release()));
+        stringref route = params[ROUTE_F].asString().make_stringref();
+        if (!route.empty()) {
+            msg->setRoute(Route::parse(route));
+        }
+        msg->setContext(Context(&entry));
+        msg->pushHandler(*this, *this);
+        msg->setRetryEnabled(params[USERETRY_F].asBool());
+        msg->setRetry(params[RETRY_F].asLong());
+        msg->setTimeReceivedNow();
+        msg->setTimeRemaining(params[TIMELEFT_F].asLong());
+        msg->getTrace().setLevel(traceLevel);
+        string session = params[SESSION_F].asString().make_string();
+        if (msg->getTrace().shouldTrace(TraceLevel::SEND_RECEIVE)) {
+            msg->getTrace().trace(TraceLevel::SEND_RECEIVE,
+                                  make_string("Message (type %d) received at %s for session '%s'.",
+                                              msg->getType(), _serverIdent.c_str(), session.c_str()));
+        }
+        _net->getOwner().deliverMessage(std::move(msg), session);
+    }
+    // Replies that arrived while dispatching are returned once all messages have been delivered.
+    FRT_RPCRequest *respond = nullptr;
+    Slime response;
+    std::unique_ptr<ServerBatch> finished;
+    {
+        std::lock_guard<std::mutex> guard(_serverLock);
+        batch.dispatched = true;
+        respond = takeResponse(batch, response, finished);
+    }
+    if (respond != nullptr) {
+        encodeSlime(response, _net->getCompressionConfig(), *respond->GetReturn());
+        respond->Return();
+    }
+}
+
+void
+RPCSendBatch::replyError(ServerBatch &batch, uint32_t idx, uint32_t traceLevel, const Error &err)
+{
+    Reply::UP reply(new EmptyReply());
+    reply->setContext(Context(&batch.entries[idx]));
+    reply->getTrace().setLevel(traceLevel);
+    reply->addError(err);
+    handleReply(std::move(reply));
+}
+
+void
+RPCSendBatch::handleReply(Reply::UP reply)
+{
+    ServerBatch::Entry &entry = *static_cast<ServerBatch::Entry*>(reply->getContext().value.PTR);
+    addReply(*entry.batch, entry.index, std::move(reply));
+}
+
+void
+RPCSendBatch::handleDiscard(Context ctx)
+{
+    ServerBatch::Entry &entry = *static_cast<ServerBatch::Entry*>(ctx.value.PTR);
+    addReply(*entry.batch, entry.index, Reply::UP());
+}
+
+void
+RPCSendBatch::addReply(ServerBatch &batch, uint32_t idx, Reply::UP reply)
+{
+    const Version &version = batch.entries[idx].version;
+    if ( ! reply) {
+        reply = std::make_unique<EmptyReply>();
+        reply->addError(Error(ErrorCode::NETWORK_SHUTDOWN,
+                              make_string("Message was discarded by %s.", _serverIdent.c_str())));
+    }
+    string versionString = version.toString();
+    if (reply->getTrace().shouldTrace(TraceLevel::SEND_RECEIVE)) {
+        reply->getTrace().trace(TraceLevel::SEND_RECEIVE, make_string("Sending reply (version %s) from %s.",
+                                                                      versionString.c_str(), _serverIdent.c_str()));
+    }
+    Blob payload(0);
+    if (reply->getType() != 0) {
+        const IProtocol * protocol = _net->getOwner().getProtocol(reply->getProtocol());
+        if (protocol != nullptr) {
+            payload = protocol->encode(version, *reply);
+        }
+        if (payload.size() == 0) {
+            reply->addError(Error(ErrorCode::ENCODE_ERROR, "An error occured while encoding the reply, see log."));
+        }
+    }
+    FRT_RPCRequest *respond = nullptr;
+    Slime response;
+    std::unique_ptr<ServerBatch> finished;
+    {
+        std::lock_guard<std::mutex> guard(_serverLock);
+        Cursor &root = batch.doneReplies.addObject();
+        root.setLong(INDEX_F, idx);
+        root.setString(VERSION_F, versionString);
+        root.setDouble(RETRYDELAY_F, reply->getRetryDelay());
+        root.setString(PROTOCOL_F, reply->getProtocol());
+        root.setData(BLOB_F, Memory(payload.data(), payload.size()));
+        if (reply->getTrace().getLevel() > 0) {
+            root.setString(TRACE_F, reply->getTrace().getRoot().encode());
+        }
+        if (reply->getNumErrors() > 0) {
+            Cursor &array = root.setArray(ERRORS_F);
+            for (uint32_t i = 0; i < reply->getNumErrors(); ++i) {
+                Cursor &error = array.addObject();
+                error.setLong(CODE_F, reply->getError(i).getCode());
+                error.setString(MSG_F, reply->getError(i).getMessage());
+                error.setString(SERVICE_F, reply->getError(i).getService().c_str());
+            }
+        }
+        batch.lastActive = Clock::now();
+        respond = takeResponse(batch, response, finished);
+    }
+    if (respond != nullptr) {
+        encodeSlime(response, _net->getCompressionConfig(), *respond->GetReturn());
+        respond->Return();
+    }
+}
+
+FRT_RPCRequest *
+RPCSendBatch::takeResponse(ServerBatch &batch, Slime &response, std::unique_ptr<ServerBatch> &finished)
+{
+    uint32_t numDone = batch.numDone();
+    if (batch.abandoned) {
+        // Nobody polls for the replies anymore, so the batch is dropped once it is no longer in use.
+        if (batch.dispatched && (numDone == batch.entries.size())) {
+            auto it = _serverBatches.find(batch.id);
+            finished = std::move(it->second);
+            _serverBatches.erase(it);
+        }
+        return nullptr;
+    }
+    if ((batch.waiting == nullptr) || !batch.dispatched || (numDone <= batch.waitingFirst)) {
+        return nullptr;
+    }
+    Cursor &root = response.setObject();
+    root.setLong(FIRST_F, batch.waitingFirst);
+    Cursor &replies = root.setArray(REPLIES_F);
+    for (uint32_t i = batch.waitingFirst; i < numDone; ++i) {
+        inject(batch.doneReplies[i], ArrayInserter(replies));
+    }
+    FRT_RPCRequest *req = batch.waiting;
+    batch.waiting = nullptr;
+    if (numDone == batch.entries.size()) {
+        auto it = _serverBatches.find(batch.id);
+        finished = std::move(it->second);
+        _serverBatches.erase(it);
+    }
+    return req;
+}
+
+void
+RPCSendBatch::sweepAbandoned(Clock::time_point now, std::vector<ParkedRequest> &expired)
+{
+    if (now < _nextSweep) {
+        return;
+    }
+    _nextSweep = now + ABANDONED_BATCH_AGE;
+    for (auto it = _serverBatches.begin(); it != _serverBatches.end(); ) {
+        ServerBatch &batch = *it->second;
+        if (batch.lastActive + ABANDONED_BATCH_AGE >= now) {
+            ++it;
+            continue;
+        }
+        // A client that is still around polls again well before this, so a poll request that has been
+        // parked for this long belongs to a client that is gone.
+        if (batch.waiting != nullptr) {
+            expired.emplace_back(batch.waiting, batch.waitingFirst);
+            batch.waiting = nullptr;
+        }
+        if (batch.dispatched && (batch.numDone() == batch.entries.size())) {
+            it = _serverBatches.erase(it);
+        } else {
+            // The messages still being processed refer to their entries, so the batch is removed by
+            // takeResponse() once the last of them has been replied to.
+            batch.abandoned = true;
+            ++it;
+        }
+    }
+}
+
+void
+RPCSendBatch::returnEmpty(const std::vector<ParkedRequest> &requests)
+{
+    for (const ParkedRequest &parked : requests) {
+        Slime empty;
+        Cursor &root = empty.setObject();
+        root.setLong(FIRST_F, parked.second);
+        root.setArray(REPLIES_F);
+        encodeSlime(empty, _net->getCompressionConfig(), *parked.first->GetReturn());
+        parked.first->Return();
+    }
+}
+
+} // namespace mbus
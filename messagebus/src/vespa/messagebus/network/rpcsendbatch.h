@@ -0,0 +1,119 @@
+// Copyright 2019 Oath Inc. Licensed under the terms of the Apache 2.0 license. See LICENSE in the project root.
+#pragma once
+
+#include "rpcsendadapter.h"
+#include <vespa/messagebus/idiscardhandler.h>
+#include <vespa/messagebus/ireplyhandler.h>
+#include <vespa/messagebus/common.h>
+#include <vespa/fnet/frt/invokable.h>
+#include <vespa/fnet/frt/invoker.h>
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <random>
+#include <vector>
+
+namespace vespalib { class Slime; }
+
+namespace mbus {
+
+class Error;
+class RPCTarget;
+
+/**
+ * Implements an RPC send adapter that packs the messages sent to the same {@link RPCTarget} into batches,
+ * and sends each batch as a single RPC request. The batch is encoded and compressed as a whole.
+ *
+ * A batch is sent as soon as it holds the maximum number of messages or bytes. Otherwise, sending it is
+ * left to a task in the network executor, so that all messages that are sent to a target while that task
+ * is pending are carried by the same request. Batches to different targets are flushed independently, so
+ * the order in which they are sent is not defined.
+ *
+ * The replies are returned in waves. The server answers the batch request as soon as any reply is ready,
+ * with all the replies that are ready at that point. The client then polls for the rest, passing the
+ * number of replies it has seen, and the server answers each poll once it has a reply that has not been
+ * returned. Each request times out at the earliest deadline of the messages still waiting for a reply,
+ * and those messages that have passed their own deadline get a timeout error.
+ *
+ * Batching is only used between peers that both have it enabled. A target that does not serve the batch
+ * method is marked as such, and the messages to it are sent through the fallback adapter from then on.
+ * Messages that are sent through a hop that ignores the result do not expect a reply, and are always
+ * passed on to the fallback adapter.
+ */
+class RPCSendBatch : public RPCSendAdapter,
+                     public FRT_Invokable,
+                     public FRT_IRequestWait,
+                     public IDiscardHandler,
+                     public IReplyHandler
+{
+private:
+    struct Batch;
+    struct ServerBatch;
+    using BatchMap = std::map<RPCTarget*, std::unique_ptr<Batch>>;
+    using ServerBatchMap = std::map<uint64_t, std::unique_ptr<ServerBatch>>;
+    // A poll request waiting for replies, with the number of replies the client already has.
+    using ParkedRequest = std::pair<FRT_RPCRequest *, uint32_t>;
+    using Clock = std::chrono::steady_clock;
+
+    RPCNetwork        *_net;
+    RPCSendAdapter    &_fallback;
+    uint32_t           _maxBatchSize;
+    uint32_t           _maxBatchBytes;
+    string             _clientIdent;
+    string             _serverIdent;
+    std::mutex         _lock;
+    BatchMap           _batches;
+    bool               _flushScheduled;
+    std::mt19937_64    _idGenerator;
+    std::mutex         _serverLock;
+    ServerBatchMap     _serverBatches;
+    Clock::time_point  _nextSweep;
+
+    void sendBatch(std::unique_ptr<Batch> batch);
+    void sendFallback(std::unique_ptr<Batch> batch);
+    void poll(std::unique_ptr<Batch> batch);
+    void invokeTarget(std::unique_ptr<Batch> batch, FRT_RPCRequest *req);
+    void handleReplies(Batch &batch, FRT_RPCRequest &req);
+    void expireOverdue(Batch &batch);
+    void deliverReply(Batch &batch, uint32_t idx, std::unique_ptr<Reply> reply, const Error &error);
+    std::unique_ptr<Reply> decodeReply(vespalib::stringref protocol, const vespalib::Version &version,
+                                       BlobRef payload, Error &error) const;
+    void doRequest(ServerBatch &batch);
+    void replyError(ServerBatch &batch, uint32_t idx, uint32_t traceLevel, const Error &err);
+    void addReply(ServerBatch &batch, uint32_t idx, std::unique_ptr<Reply> reply);
+    FRT_RPCRequest *takeResponse(ServerBatch &batch, vespalib::Slime &response,
+                                 std::unique_ptr<ServerBatch> &finished);
+    void sweepAbandoned(Clock::time_point now, std::vector<ParkedRequest> &expired);
+    void returnEmpty(const std::vector<ParkedRequest> &requests);
+
+public:
+    /**
+     * Constructs a new batch send adapter.
+     *
+     * @param fallback      The adapter to use for messages that do not expect a reply.
+     * @param maxBatchSize  The maximum number of messages to pack into one request.
+     * @param maxBatchBytes The maximum number of payload bytes to pack into one request.
+     */
+    RPCSendBatch(RPCSendAdapter &fallback, uint32_t maxBatchSize, uint32_t maxBatchBytes);
+    ~RPCSendBatch() override;
+
+    static bool isCompatible(vespalib::stringref method, vespalib::stringref request, vespalib::stringref response);
+
+    /**
+     * Sends all batches that are currently being filled.
+     */
+    void flush();
+
+    void invoke(FRT_RPCRequest *req);
+    void invokePoll(FRT_RPCRequest *req);
+    void attach(RPCNetwork &net) override;
+    void send(RoutingNode &recipient, const vespalib::Version &version,
+              BlobRef payload, uint64_t timeRemaining) override;
+    void sendByHandover(RoutingNode &recipient, const vespalib::Version &version,
+                        Blob payload, uint64_t timeRemaining) override;
+    void RequestDone(FRT_RPCRequest *req) override;
+    void handleReply(std::unique_ptr<Reply> reply) override;
+    void handleDiscard(Context ctx) override;
+};
+
+} // namespace mbus
@@ -6,6 +6,7 @@
 #include <vespa/fnet/frt/target.h>
 #include <vespa/vespalib/component/version.h>
 #include <vespa/vespalib/util/sync.h>
+#include <atomic>
 
 namespace mbus {
 
@@ -57,6 +58,7 @@ private:
     ResolveState      _state;
     Version_UP        _version;
     HandlerList       _versionHandlers;
+    std::atomic<bool> _batchingUnsupported;
 
 public:
     /**
@@ -112,6 +114,19 @@ public:
      */
     const vespalib::Version &getVersion() const { return *_version; }
 
+    /**
+     * Returns whether this target has turned out not to serve batched sends, in which case messages to it
+     * are sent one by one.
+     *
+     * @return True if batching is known to be unsupported.
+     */
+    bool isBatchingUnsupported() const { return _batchingUnsupported.load(std::memory_order_relaxed); }
+
+    /**
+     * Marks this target as not serving batched sends.
+     */
+    void setBatchingUnsupported() { _batchingUnsupported.store(true, std::memory_order_relaxed); }
+
     // Implements FRT_IRequestWait.
     void RequestDone(FRT_RPCRequest *req) override;
 };
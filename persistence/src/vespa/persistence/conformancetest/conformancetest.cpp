@@ -984,6 +984,57 @@ void ConformanceTest::testUpdate() {
     }
 }
 
+void ConformanceTest::testExecuteBatch() {
+    document::TestDocMan testDocMan;
+    _factory->clear();
+    PersistenceProvider::UP spi(getSpi(*_factory, testDocMan));
+    Context context(defaultLoadType, Priority(0), Trace::TraceLevel(0));
+
+    Bucket bucket(makeSpiBucket(BucketId(8, 0x01)));
+    Document::SP doc1 = testDocMan.createRandomDocumentAtLocation(0x01, 1);
+    Document::SP doc2 = testDocMan.createRandomDocumentAtLocation(0x01, 2);
+    Document::SP doc3 = testDocMan.createRandomDocumentAtLocation(0x01, 3);
+    spi->createBucket(bucket, context);
+
+    const document::DocumentType *docType(
+            testDocMan.getTypeRepo().getDocumentType("testdoctype1"));
+    document::DocumentUpdate::SP update(new DocumentUpdate(testDocMan.getTypeRepo(), *docType, doc2->getId()));
+    std::shared_ptr<document::AssignValueUpdate> assignUpdate(new document::AssignValueUpdate(document::IntFieldValue(42)));
+    document::FieldUpdate fieldUpdate(docType->getField("headerval"));
+    fieldUpdate.addUpdate(*assignUpdate);
+    update->addUpdate(fieldUpdate);
+
+    BatchOperationList operations;
+    operations.push_back(BatchOperation::put(Timestamp(1), doc1));
+    operations.push_back(BatchOperation::put(Timestamp(2), doc2));
+    operations.push_back(BatchOperation::remove(Timestamp(3), doc1->getId()));
+    operations.push_back(BatchOperation::update(Timestamp(4), update));
+    operations.push_back(BatchOperation::removeIfFound(Timestamp(5), doc3->getId()));
+
+    BatchResult result = spi->executeBatch(bucket, operations, context);
+    spi->flush(bucket, context);
+    CPPUNIT_ASSERT_EQUAL(Result(), Result(result));
+    CPPUNIT_ASSERT_EQUAL(operations.size(), result.size());
+    CPPUNIT_ASSERT_EQUAL(Result(), result.getResult(0));
+    CPPUNIT_ASSERT_EQUAL(Result(), result.getResult(1));
+    CPPUNIT_ASSERT_EQUAL(Result(), Result(result.getRemoveResult(2)));
+    CPPUNIT_ASSERT(result.getRemoveResult(2).wasFound());
+    CPPUNIT_ASSERT_EQUAL(Result(), Result(result.getUpdateResult(3)));
+    CPPUNIT_ASSERT_EQUAL(Timestamp(2), result.getUpdateResult(3).getExistingTimestamp());
+    CPPUNIT_ASSERT_EQUAL(Result(), Result(result.getRemoveResult(4)));
+    CPPUNIT_ASSERT(!result.getRemoveResult(4).wasFound());
+
+    const BucketInfo info = spi->getBucketInfo(bucket).getBucketInfo();
+    CPPUNIT_ASSERT_EQUAL(1, (int)info.getDocumentCount());
+
+    GetResult getResult = spi->get(bucket, document::AllFields(), doc2->getId(), context);
+    CPPUNIT_ASSERT_EQUAL(Result::NONE, getResult.getErrorCode());
+    CPPUNIT_ASSERT_EQUAL(Timestamp(4), getResult.getTimestamp());
+    CPPUNIT_ASSERT_EQUAL(document::IntFieldValue(42),
+                         static_cast<document::IntFieldValue&>(*getResult.getDocument().getValue("headerval")));
+    CPPUNIT_ASSERT(!spi->get(bucket, document::AllFields(), doc1->getId(), context).hasDocument());
+}
+
 void ConformanceTest::testGet() {
     document::TestDocMan testDocMan;
     _factory->clear();
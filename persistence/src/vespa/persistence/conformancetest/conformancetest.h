@@ -23,6 +23,7 @@
     CPPUNIT_TEST(testRemove); \
     CPPUNIT_TEST(testRemoveMerge); \
     CPPUNIT_TEST(testUpdate); \
+    CPPUNIT_TEST(testExecuteBatch); \
     CPPUNIT_TEST(testGet); \
     CPPUNIT_TEST(testIterateCreateIterator); \
     CPPUNIT_TEST(testIterateWithUnknownId); \
@@ -228,6 +229,12 @@ public:
     void testRemove();
     void testRemoveMerge();
     void testUpdate();
+
+    /**
+     * Test that a batch of operations is applied as if the operations were
+     * executed one by one, and that each operation gets its own result.
+     */
+    void testExecuteBatch();
     void testGet();
 
     /** Test that iterating special cases works. */
@@ -43,6 +43,34 @@ AbstractPersistenceProvider::update(const Bucket& bucket, Timestamp ts,
     return UpdateResult(updatedTs);
 }
 
+BatchResult
+AbstractPersistenceProvider::executeBatch(const Bucket& bucket, const BatchOperationList& operations,
+                                          Context& context)
+{
+    BatchResult::ResultList results;
+    results.reserve(operations.size());
+    for (const BatchOperation& op : operations) {
+        switch (op.getType()) {
+        case BatchOperation::Type::PUT:
+            results.push_back(std::make_unique<Result>(put(bucket, op.getTimestamp(), op.getDocument(), context)));
+            break;
+        case BatchOperation::Type::REMOVE:
+            results.push_back(std::make_unique<RemoveResult>(
+                    remove(bucket, op.getTimestamp(), op.getDocumentId(), context)));
+            break;
+        case BatchOperation::Type::REMOVE_IF_FOUND:
+            results.push_back(std::make_unique<RemoveResult>(
+                    removeIfFound(bucket, op.getTimestamp(), op.getDocumentId(), context)));
+            break;
+        case BatchOperation::Type::UPDATE:
+            results.push_back(std::make_unique<UpdateResult>(
+                    update(bucket, op.getTimestamp(), op.getUpdate(), context)));
+            break;
+        }
+    }
+    return BatchResult(std::move(results));
+}
+
 RemoveResult
 AbstractPersistenceProvider::removeIfFound(const Bucket& b, Timestamp timestamp,
                                            const DocumentId& id, Context& context)
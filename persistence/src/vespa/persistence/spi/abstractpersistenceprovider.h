@@ -25,6 +25,12 @@ public:
      */
     UpdateResult update(const Bucket&, Timestamp, const DocumentUpdateSP&, Context&) override;
 
+    /**
+     * Executes the operations one by one by calling put(), remove(),
+     * removeIfFound() and update().
+     */
+    BatchResult executeBatch(const Bucket&, const BatchOperationList&, Context&) override;
+
     /**
      * Default impl empty.
      */
@@ -0,0 +1,55 @@
+// Copyright 2019 Oath Inc. Licensed under the terms of the Apache 2.0 license. See LICENSE in the project root.
+
+#include "batchoperation.h"
+#include <vespa/document/fieldvalue/document.h>
+#include <vespa/document/update/documentupdate.h>
+
+namespace storage::spi {
+
+BatchOperation::BatchOperation(Type type, Timestamp timestamp)
+    : _type(type),
+      _timestamp(timestamp),
+      _doc(),
+      _id(),
+      _update()
+{ }
+
+BatchOperation::BatchOperation(const BatchOperation&) = default;
+BatchOperation& BatchOperation::operator=(const BatchOperation&) = default;
+BatchOperation::BatchOperation(BatchOperation&&) = default;
+BatchOperation& BatchOperation::operator=(BatchOperation&&) = default;
+BatchOperation::~BatchOperation() = default;
+
+BatchOperation
+BatchOperation::put(Timestamp timestamp, DocumentSP doc)
+{
+    BatchOperation op(Type::PUT, timestamp);
+    op._doc = std::move(doc);
+    return op;
+}
+
+BatchOperation
+BatchOperation::remove(Timestamp timestamp, const DocumentId& id)
+{
+    BatchOperation op(Type::REMOVE, timestamp);
+    op._id = id;
+    return op;
+}
+
+BatchOperation
+BatchOperation::removeIfFound(Timestamp timestamp, const DocumentId& id)
+{
+    BatchOperation op(Type::REMOVE_IF_FOUND, timestamp);
+    op._id = id;
+    return op;
+}
+
+BatchOperation
+BatchOperation::update(Timestamp timestamp, DocumentUpdateSP update)
+{
+    BatchOperation op(Type::UPDATE, timestamp);
+    op._update = std::move(update);
+    return op;
+}
+
+}
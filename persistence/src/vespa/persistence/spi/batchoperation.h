@@ -0,0 +1,54 @@
+// Copyright 2019 Oath Inc. Licensed under the terms of the Apache 2.0 license. See LICENSE in the project root.
+#pragma once
+
+#include <persistence/spi/types.h>
+#include <vespa/document/base/documentid.h>
+
+namespace storage::spi {
+
+/**
+ * A single put, remove or update operation, as part of a batch of operations
+ * against the same bucket (see PersistenceProvider::executeBatch()).
+ */
+class BatchOperation {
+public:
+    enum class Type {
+        PUT,
+        REMOVE,
+        REMOVE_IF_FOUND,
+        UPDATE
+    };
+
+    static BatchOperation put(Timestamp timestamp, DocumentSP doc);
+    static BatchOperation remove(Timestamp timestamp, const DocumentId& id);
+    static BatchOperation removeIfFound(Timestamp timestamp, const DocumentId& id);
+    static BatchOperation update(Timestamp timestamp, DocumentUpdateSP update);
+
+    BatchOperation(const BatchOperation&);
+    BatchOperation& operator=(const BatchOperation&);
+    BatchOperation(BatchOperation&&);
+    BatchOperation& operator=(BatchOperation&&);
+    ~BatchOperation();
+
+    Type getType() const { return _type; }
+    Timestamp getTimestamp() const { return _timestamp; }
+    /** Only set for PUT. */
+    const DocumentSP& getDocument() const { return _doc; }
+    /** Only set for REMOVE and REMOVE_IF_FOUND. */
+    const DocumentId& getDocumentId() const { return _id; }
+    /** Only set for UPDATE. */
+    const DocumentUpdateSP& getUpdate() const { return _update; }
+
+private:
+    BatchOperation(Type type, Timestamp timestamp);
+
+    Type             _type;
+    Timestamp        _timestamp;
+    DocumentSP       _doc;
+    DocumentId       _id;
+    DocumentUpdateSP _update;
+};
+
+using BatchOperationList = std::vector<BatchOperation>;
+
+}
@@ -1,6 +1,7 @@
 // Copyright 2017 Yahoo Holdings. Licensed under the terms of the Apache 2.0 license. See LICENSE in the project root.
 #pragma once
 
+#include "batchoperation.h"
 #include "bucket.h"
 #include "bucketinfo.h"
 #include "context.h"
@@ -203,6 +204,19 @@ struct PersistenceProvider
      */
     virtual UpdateResult update(const Bucket&, Timestamp timestamp, const DocumentUpdateSP& update, Context&) = 0;
 
+    /**
+     * Executes a batch of put, remove and update operations against the given
+     * bucket. The operations must be applied as if they were executed one by
+     * one in the given order, but the provider is free to overlap their
+     * execution and to amortize commits and other per-operation overhead
+     * across the batch.
+     * <p/>
+     * Each operation succeeds or fails on its own, and the batch result holds
+     * the result of each operation, in operation order. A batch level error
+     * means that none of the operations are known to have been applied.
+     */
+    virtual BatchResult executeBatch(const Bucket&, const BatchOperationList& operations, Context&) = 0;
+
     /**
      * The service layer may choose to batch certain commands. This means that
      * the service layer will lock the bucket only once, then perform several
@@ -22,6 +22,20 @@ operator << (std::ostream & os, const Result & r) {
     return os << r.toString();
 }
 
+BatchResult::BatchResult(ErrorType error, const vespalib::string& errorMessage)
+    : Result(error, errorMessage),
+      _results()
+{ }
+
+BatchResult::BatchResult(ResultList results)
+    : Result(),
+      _results(std::move(results))
+{ }
+
+BatchResult::BatchResult(BatchResult &&) = default;
+BatchResult & BatchResult::operator = (BatchResult &&) = default;
+BatchResult::~BatchResult() { }
+
 GetResult::GetResult(Document::UP doc, Timestamp timestamp)
     : Result(),
       _timestamp(timestamp),
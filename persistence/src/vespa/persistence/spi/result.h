@@ -146,6 +146,42 @@ private:
     bool _wasFound;
 };
 
+class BatchResult : public Result
+{
+public:
+    using ResultList = std::vector<std::unique_ptr<Result>>;
+
+    /**
+     * Constructor to use when the batch as a whole failed. None of the
+     * operations are then known to have been applied.
+     */
+    BatchResult(ErrorType error, const vespalib::string& errorMessage);
+
+    /**
+     * Constructor to use when the batch was executed. There must be one
+     * result per operation, in operation order. The result of a put is a
+     * Result, the result of a remove a RemoveResult and the result of an
+     * update an UpdateResult.
+     */
+    BatchResult(ResultList results);
+
+    BatchResult(BatchResult &&);
+    BatchResult & operator = (BatchResult &&);
+    ~BatchResult();
+
+    size_t size() const { return _results.size(); }
+    const Result& getResult(size_t i) const { return *_results[i]; }
+    const RemoveResult& getRemoveResult(size_t i) const {
+        return dynamic_cast<const RemoveResult&>(*_results[i]);
+    }
+    const UpdateResult& getUpdateResult(size_t i) const {
+        return dynamic_cast<const UpdateResult&>(*_results[i]);
+    }
+
+private:
+    ResultList _results;
+};
+
 class GetResult : public Result {
 public:
     /**
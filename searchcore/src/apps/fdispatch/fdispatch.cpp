@@ -4,11 +4,14 @@
 #include <vespa/vespalib/net/state_server.h>
 #include <vespa/vespalib/net/simple_health_producer.h>
 #include <vespa/vespalib/net/simple_metrics_producer.h>
+#include <vespa/vespalib/data/slime/slime.h>
 #include <vespa/searchlib/expression/forcelink.hpp>
 #include <vespa/searchlib/aggregation/forcelink.hpp>
 #include <vespa/vespalib/util/signalhandler.h>
 #include <vespa/fastos/app.h>
 #include <thread>
+#include <algorithm>
+#include <ctime>
 #include <getopt.h>
 
 #include <vespa/log/log.h>
@@ -21,6 +24,51 @@ using namespace std::literals;
 
 extern char FastS_VersionTag[];
 
+namespace {
+
+constexpr time_t METRICS_INTERVAL = 60;
+
+uint64_t
+countSince(uint64_t prev, uint64_t curr)
+{
+    // the counters restart when datasets are reconfigured
+    return (curr >= prev) ? (curr - prev) : curr;
+}
+
+void
+addCount(vespalib::slime::Cursor &values, const char *name, const char *desc,
+         uint64_t count, double snapLen)
+{
+    vespalib::slime::Cursor &value = values.addObject();
+    value.setString("name", name);
+    value.setString("description", desc);
+    vespalib::slime::Cursor &inner = value.setObject("values");
+    inner.setLong("count", count);
+    inner.setDouble("rate", count / snapLen);
+}
+
+vespalib::string
+makeSnapshot(const fdispatch::HedgeCounts &prev, const fdispatch::HedgeCounts &curr,
+             time_t prevTime, time_t currTime)
+{
+    vespalib::Slime data;
+    vespalib::slime::Cursor &metrics = data.setObject();
+    vespalib::slime::Cursor &snapshot = metrics.setObject("snapshot");
+    snapshot.setLong("from", prevTime);
+    snapshot.setLong("to", currTime);
+    vespalib::slime::Cursor &values = metrics.setArray("values");
+    double snapLen = std::max(double(currTime - prevTime), 1.0);
+    addCount(values, "fdispatch.hedge.queries",
+             "count of queries also sent to another node holding the same partition",
+             countSince(prev.numHedged, curr.numHedged), snapLen);
+    addCount(values, "fdispatch.hedge.wins",
+             "count of hedged queries answered by the hedge before the original node",
+             countSince(prev.numWins, curr.numWins), snapLen);
+    return data.toString();
+}
+
+}
+
 class FastS_FDispatchApp : public FastOS_Application
 {
 private:
@@ -95,11 +143,20 @@ FastS_FDispatchApp::Main()
             vespalib::SimpleHealthProducer health;
             vespalib::SimpleMetricsProducer metrics;
             vespalib::StateServer stateServer(myfdispatch->getHealthPort(), health, metrics, myfdispatch->getComponentConfig());
+            fdispatch::HedgeCounts lastCounts = myfdispatch->getHedgeCounts();
+            time_t lastSnapshot = time(nullptr);
             while (!CheckShutdownFlags()) {
                 if (myfdispatch->Failed()) {
                     throw std::runtime_error("myfdispatch->Failed()");
                 }
                 std::this_thread::sleep_for(100ms);
+                time_t now = time(nullptr);
+                if (now >= lastSnapshot + METRICS_INTERVAL) {
+                    fdispatch::HedgeCounts counts = myfdispatch->getHedgeCounts();
+                    metrics.setMetrics(makeSnapshot(lastCounts, counts, lastSnapshot, now));
+                    lastCounts = counts;
+                    lastSnapshot = now;
+                }
                 if (!myfdispatch->CheckTempFail())
                     break;
             }
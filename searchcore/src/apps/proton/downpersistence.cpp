@@ -98,6 +98,13 @@ UpdateResult DownPersistence::update(const Bucket&, Timestamp,
                         errorResult.getErrorMessage());
 }
 
+BatchResult
+DownPersistence::executeBatch(const Bucket&, const BatchOperationList&, Context&)
+{
+    return BatchResult(errorResult.getErrorCode(),
+                       errorResult.getErrorMessage());
+}
+
 Result
 DownPersistence::flush(const Bucket&, Context&)
 {
@@ -0,0 +1,78 @@
+// Copyright 2019 Oath Inc. Licensed under the terms of the Apache 2.0 license. See LICENSE in the project root.
+#include <vespa/vespalib/testkit/testapp.h>
+
+#include <vespa/searchcore/fdispatch/search/fnet_search.h>
+
+#include <vespa/log/log.h>
+LOG_SETUP("search_hedge_test");
+
+using namespace fdispatch;
+
+FastS_FNET_SearchNode *
+hedge(FastS_FNET_SearchNode & node) {
+    node._hedge = std::make_unique<FastS_FNET_SearchNode>(nullptr, node.getPartID());
+    node._hedge->_hedgeOf = &node;
+    node._hedge->_flags._pendingQuery = true;
+    return node._hedge.get();
+}
+
+void
+reply(FastS_FNET_SearchNode & node) {
+    node._flags._pendingQuery = false;
+}
+
+TEST("require that replies are learned by the hedge policy") {
+    HedgePolicy policy(1, 90.0, 0.1, 0.001);
+    FastS_FNET_SearchNode node(nullptr, 0);
+    for (size_t i = 0; i < HedgePolicy::MIN_SAMPLES; ++i) {
+        EXPECT_LESS(policy.getHedgeDelay(0), 0.0);
+        node._flags._pendingQuery = true;
+        reply(node);
+        EXPECT_TRUE(FastS_FNET_Search::hedgedQueryDone(&node, policy, 0.010) == nullptr);
+    }
+    EXPECT_GREATER_EQUAL(policy.getHedgeDelay(0), 0.010);
+    EXPECT_EQUAL(0u, policy.numWins());
+}
+
+TEST("require that a reply from the original node stops waiting for the hedge") {
+    HedgePolicy policy(1, 90.0, 0.1, 0.001);
+    FastS_FNET_SearchNode node(nullptr, 0);
+    node._flags._pendingQuery = true;
+    FastS_FNET_SearchNode *hedgeNode = hedge(node);
+    reply(node);
+    EXPECT_EQUAL(hedgeNode, FastS_FNET_Search::hedgedQueryDone(&node, policy, 0.010));
+    EXPECT_FALSE(hedgeNode->_flags._pendingQuery);
+    EXPECT_EQUAL(0u, policy.numWins());
+}
+
+TEST("require that a reply from the hedge stops waiting for the original node and counts as a win") {
+    HedgePolicy policy(1, 90.0, 0.1, 0.001);
+    FastS_FNET_SearchNode node(nullptr, 0);
+    node._flags._pendingQuery = true;
+    FastS_FNET_SearchNode *hedgeNode = hedge(node);
+    EXPECT_EQUAL(&node, hedgeNode->getPrimary());
+    reply(*hedgeNode);
+    EXPECT_EQUAL(&node, FastS_FNET_Search::hedgedQueryDone(hedgeNode, policy, 0.010));
+    EXPECT_FALSE(node._flags._pendingQuery);
+    EXPECT_EQUAL(1u, policy.numWins());
+}
+
+TEST("require that the hedge takes over when the original node fails") {
+    FastS_FNET_SearchNode node(nullptr, 0);
+    node._flags._pendingQuery = true;
+    FastS_FNET_SearchNode *hedgeNode = hedge(node);
+    EXPECT_TRUE(FastS_FNET_Search::hedgeTakesOver(&node));
+    EXPECT_FALSE(node._flags._pendingQuery);
+    EXPECT_TRUE(hedgeNode->_flags._pendingQuery);
+    EXPECT_FALSE(FastS_FNET_Search::hedgeTakesOver(hedgeNode));
+    EXPECT_TRUE(hedgeNode->_flags._pendingQuery);
+}
+
+TEST("require that nothing takes over for a node that is not hedged") {
+    FastS_FNET_SearchNode node(nullptr, 0);
+    node._flags._pendingQuery = true;
+    EXPECT_FALSE(FastS_FNET_Search::hedgeTakesOver(&node));
+    EXPECT_TRUE(node._flags._pendingQuery);
+}
+
+TEST_MAIN() { TEST_RUN_ALL(); }
@@ -0,0 +1,107 @@
+// Copyright 2019 Oath Inc. Licensed under the terms of the Apache 2.0 license. See LICENSE in the project root.
+
+#include <vespa/vespalib/testkit/test_kit.h>
+#include <vespa/searchcore/fdispatch/search/hedge_policy.h>
+
+using fdispatch::HedgeCounts;
+using fdispatch::HedgePolicy;
+using fdispatch::LatencyHistogram;
+
+TEST("require that latencies are mapped to increasing buckets") {
+    EXPECT_EQUAL(0u, LatencyHistogram::bucketOf(0.0));
+    EXPECT_EQUAL(0u, LatencyHistogram::bucketOf(LatencyHistogram::MIN_LATENCY));
+    EXPECT_EQUAL(4u, LatencyHistogram::bucketOf(LatencyHistogram::MIN_LATENCY * 2));
+    EXPECT_EQUAL(LatencyHistogram::NUM_BUCKETS - 1, LatencyHistogram::bucketOf(1000.0));
+    for (double latency = 0.001; latency < 10.0; latency *= 1.1) {
+        size_t bucket = LatencyHistogram::bucketOf(latency);
+        EXPECT_LESS_EQUAL(latency, LatencyHistogram::upperBound(bucket) * 1.000001);
+        EXPECT_GREATER(latency, LatencyHistogram::upperBound(bucket - 1));
+    }
+}
+
+TEST("require that percentiles are estimated from the histogram") {
+    LatencyHistogram hist;
+    for (size_t i = 0; i < 90; ++i) {
+        hist.add(0.010);
+    }
+    for (size_t i = 0; i < 10; ++i) {
+        hist.add(0.500);
+    }
+    EXPECT_EQUAL(100u, hist.numSamples());
+    double p50 = hist.percentile(50.0);
+    double p95 = hist.percentile(95.0);
+    EXPECT_GREATER_EQUAL(p50, 0.010);
+    EXPECT_LESS(p50, 0.012);
+    EXPECT_GREATER_EQUAL(p95, 0.500);
+    EXPECT_LESS(p95, 0.600);
+}
+
+TEST("require that old latencies decay") {
+    LatencyHistogram hist;
+    for (size_t i = 0; i < 1000; ++i) {
+        hist.add(0.500);
+    }
+    for (size_t i = 0; i < 5000; ++i) {
+        hist.add(0.010);
+    }
+    EXPECT_LESS(hist.percentile(95.0), 0.012);
+}
+
+TEST("require that hedging needs enough samples") {
+    HedgePolicy policy(2, 90.0, 0.1, 0.001);
+    EXPECT_TRUE(policy.enabled());
+    for (size_t i = 0; i + 1 < HedgePolicy::MIN_SAMPLES; ++i) {
+        policy.updateLatency(0, 0.010);
+    }
+    EXPECT_LESS(policy.getHedgeDelay(0), 0.0);
+    policy.updateLatency(0, 0.010);
+    EXPECT_GREATER_EQUAL(policy.getHedgeDelay(0), 0.010);
+    EXPECT_LESS(policy.getHedgeDelay(1), 0.0);
+    EXPECT_LESS(policy.getHedgeDelay(2), 0.0);
+    double delay = policy.getHedgeDelay(0);
+    policy.updateLatency(7, 0.500); // unknown partition
+    EXPECT_LESS(policy.getHedgeDelay(7), 0.0);
+    EXPECT_EQUAL(delay, policy.getHedgeDelay(0));
+}
+
+TEST("require that hedge delay is at least the minimum wait") {
+    HedgePolicy policy(1, 90.0, 0.1, 0.250);
+    for (size_t i = 0; i < HedgePolicy::MIN_SAMPLES; ++i) {
+        policy.updateLatency(0, 0.010);
+    }
+    EXPECT_EQUAL(0.250, policy.getHedgeDelay(0));
+}
+
+TEST("require that hedging is disabled by default config") {
+    HedgePolicy policy(1, 0.0, 0.05, 0.01);
+    EXPECT_FALSE(policy.enabled());
+    for (size_t i = 0; i < HedgePolicy::MIN_SAMPLES; ++i) {
+        policy.updateLatency(0, 0.010);
+    }
+    EXPECT_LESS(policy.getHedgeDelay(0), 0.0);
+}
+
+TEST("require that hedges are limited by the budget") {
+    HedgePolicy policy(1, 90.0, 0.1, 0.01);
+    EXPECT_FALSE(policy.tryHedge());
+    policy.countRequests(9);
+    EXPECT_FALSE(policy.tryHedge());
+    policy.countRequests(1);
+    EXPECT_TRUE(policy.tryHedge());
+    EXPECT_FALSE(policy.tryHedge());
+    policy.countRequests(1000);
+    size_t hedges = 0;
+    while (policy.tryHedge()) {
+        ++hedges;
+    }
+    EXPECT_EQUAL(size_t(HedgePolicy::MAX_BURST), hedges);
+    EXPECT_EQUAL(11u, policy.numHedged());
+    policy.countWin();
+    EXPECT_EQUAL(1u, policy.numWins());
+    HedgeCounts counts = policy.getCounts();
+    counts += policy.getCounts();
+    EXPECT_EQUAL(22u, counts.numHedged);
+    EXPECT_EQUAL(2u, counts.numWins);
+}
+
+TEST_MAIN() { TEST_RUN_ALL(); }
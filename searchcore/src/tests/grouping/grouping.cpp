@@ -11,6 +11,7 @@
 #include <vespa/searchcore/grouping/groupingsession.h>
 #include <vespa/searchcore/proton/matching/sessionmanager.h>
 #include <vespa/searchlib/test/mock_attribute_context.h>
+#include <vespa/vespalib/util/simple_thread_bundle.h>
 #include <iostream>
 
 #include <vespa/log/log.h>
@@ -465,6 +466,49 @@ TEST_F("test grouping fork/join", DoomFixture()) {
     EXPECT_EQUAL(expect.asString(), list[0]->asString());
 }
 
+Grouping::UP forkJoinAndPrune(const DoomFixture &f, MyWorld &world, const Grouping &request,
+                             vespalib::ThreadBundle *threadBundle)
+{
+    GroupingContext::GroupingPtr g1(new Grouping(request));
+    GroupingContext context(f.clock, f.timeOfDoom);
+    context.addGrouping(g1);
+    GroupingSession session(SessionId(), context, world.attributeContext);
+    session.prepareThreadContextCreation(3);
+    GroupingContext::UP ctx0 = session.createThreadContext(0, world.attributeContext);
+    GroupingContext::UP ctx1 = session.createThreadContext(1, world.attributeContext);
+    GroupingContext::UP ctx2 = session.createThreadContext(2, world.attributeContext);
+    doGrouping(*ctx0, 12, 30.0, 11, 20.0, 10, 10.0);
+    doGrouping(*ctx1, 22, 150.0, 21, 40.0, 20, 25.0);
+    doGrouping(*ctx2, 32, 100.0, 31, 15.0, 30, 5.0);
+    GroupingManager man(*ctx0);
+    man.merge(*ctx1);
+    man.merge(*ctx2);
+    if (threadBundle != nullptr) {
+        man.prune(*threadBundle);
+    } else {
+        man.prune();
+    }
+    return std::make_unique<Grouping>(*ctx0->getGroupingList()[0]);
+}
+
+TEST_F("require that parallel prune gives same result as serial prune", DoomFixture()) {
+    MyWorld world;
+    world.basicSetup();
+
+    Grouping request;
+    request.setRoot(Group().addResult(SumAggregationResult().setExpression(MU<AttributeNode>("attr0"))))
+           .addLevel(createGL(MU<AttributeNode>("attr1"), MU<AttributeNode>("attr0")))
+           .addLevel(createGL(2, MU<AttributeNode>("attr0")))
+           .setFirstLevel(0)
+           .setLastLevel(2);
+
+    vespalib::SimpleThreadBundle threadBundle(4);
+    Grouping::UP serial = forkJoinAndPrune(f1, world, request, nullptr);
+    Grouping::UP parallel = forkJoinAndPrune(f1, world, request, &threadBundle);
+    EXPECT_EQUAL(9u, parallel->getRoot().getChildrenSize());
+    EXPECT_EQUAL(serial->asString(), parallel->asString());
+}
+
 TEST_F("test session timeout", DoomFixture()) {
     MyWorld world;
     world.basicSetup();
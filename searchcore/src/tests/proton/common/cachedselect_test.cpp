@@ -10,6 +10,7 @@
 #include <vespa/document/select/cloningvisitor.h>
 #include <vespa/document/select/parser.h>
 #include <vespa/searchcore/proton/common/cachedselect.h>
+#include <vespa/searchcore/proton/common/compiledselect.h>
 #include <vespa/searchcore/proton/common/selectcontext.h>
 #include <vespa/searchlib/attribute/attributecontext.h>
 #include <vespa/searchlib/attribute/attributefactory.h>
@@ -22,6 +23,7 @@
 #include <vespa/searchlib/attribute/singlenumericpostattribute.hpp>
 #include <vespa/searchlib/test/mock_attribute_manager.h>
 #include <vespa/vespalib/testkit/testapp.h>
+#include <vespa/vespalib/util/stringfmt.h>
 
 #include <vespa/log/log.h>
 LOG_SETUP("cachedselect_test");
@@ -44,6 +46,7 @@ using document::select::Node;
 using document::select::Result;
 using document::select::ResultSet;
 using proton::CachedSelect;
+using proton::CompiledSelect;
 using proton::SelectContext;
 using search::AttributeContext;
 using search::AttributeFactory;
@@ -598,6 +601,59 @@ TEST_F("Test that single value attribute with complex attribute field results in
     TEST_DO(checkSelect(cs, f.db().getDoc(3u), Result::False));
 }
 
+void
+checkCompiledSelect(const CachedSelect &cs, const NodeUP &sel, uint32_t numDocs)
+{
+    ASSERT_TRUE(sel);
+    auto compiled = CompiledSelect::compile(*sel);
+    ASSERT_TRUE(compiled);
+    SelectContext ctx(cs);
+    ctx.getAttributeGuards();
+    for (uint32_t docId = 1; docId <= numDocs; ++docId) {
+        ctx._docId = docId;
+        TEST_STATE(vespalib::make_string("docId=%u", docId).c_str());
+        EXPECT_TRUE(sel->contains(ctx) == compiled->contains(docId));
+    }
+}
+
+TEST_F("Test that compiled attribute selection gives same result as expression tree", TestFixture)
+{
+    MyDB &db(*f._db);
+
+    db.addDoc(1u, "doc:test:1", "hello", "null", 45, 37);
+    db.addDoc(2u, "doc:test:2", "gotcha", "foo", 3, 25);
+    db.addDoc(3u, "doc:test:3", "gotcha", "foo", noIntVal, noIntVal);
+    db.addDoc(4u, "doc:test:4", "null", "foo", noIntVal, noIntVal);
+
+    std::vector<string> selections = {
+        "test.aa < 45", "test.aa <= 45", "test.aa > 3", "test.aa >= 3",
+        "test.aa == 3", "test.aa != 3", "45 > test.aa", "3 == test.aa",
+        "test.aa == 3.0", "test.aa < 44.5", "test.aa > 10 - 7",
+        "test.aa < 45 and test.aa > 3", "test.aa == 3 or test.aa == 45",
+        "not test.aa == 3", "not test.aa < 45", "test.aa < now()"
+    };
+    for (const auto &selection : selections) {
+        TEST_STATE(selection.c_str());
+        CachedSelect::SP cs = f.testParse(selection, "test");
+        TEST_DO(checkCompiledSelect(*cs, cs->preDocOnlySelect(), 4u));
+    }
+}
+
+TEST_F("Test that pre-document selection referencing non-attribute fields can be compiled", PreDocSelectFixture)
+{
+    CachedSelect::SP cs = f.testParse("test.aa == 3 AND test.ia == \"foo\"", "test");
+    TEST_DO(checkCompiledSelect(*cs, cs->preDocSelect(), 3u));
+}
+
+TEST_F("Test that selection not only referencing numeric attributes is not compiled", TestFixture)
+{
+    CachedSelect::SP cs = f.testParse("test.ia == \"hello\"", "test");
+    EXPECT_FALSE(CompiledSelect::compile(*cs->docSelect()));
+    cs = f.testParse("test.aa % 2 == 1", "test");
+    ASSERT_TRUE(cs->preDocOnlySelect());
+    EXPECT_FALSE(CompiledSelect::compile(*cs->preDocOnlySelect()));
+}
+
 TEST_F("Test performance when using attributes", TestFixture)
 {
     MyDB &db(*f._db);
@@ -189,7 +189,7 @@ Fixture::initViewSet(ViewSet &views)
     using IndexManager = proton::index::IndexManager;
     using IndexConfig = proton::index::IndexConfig;
     auto matchers = std::make_shared<Matchers>(_clock, _queryLimiter, _constantValueRepo);
-    auto indexMgr = make_shared<IndexManager>(BASE_DIR, IndexConfig(searchcorespi::index::WarmupConfig(), 2, 0), Schema(), 1,
+    auto indexMgr = make_shared<IndexManager>(BASE_DIR, IndexConfig(searchcorespi::index::WarmupConfig(), 2, 0, 1), Schema(), 1,
                                               views._reconfigurer, views._writeService, _summaryExecutor,
                                               TuneFileIndexManager(), TuneFileAttributes(), views._fileHeaderContext);
     auto attrMgr = make_shared<AttributeManager>(BASE_DIR, "test.subdb", TuneFileAttributes(), views._fileHeaderContext,
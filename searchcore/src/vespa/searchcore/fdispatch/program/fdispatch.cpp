@@ -5,6 +5,8 @@
 #include "rpc.h"
 #include <vespa/searchcore/fdispatch/search/querycacheutil.h>
 #include <vespa/searchcore/fdispatch/search/nodemanager.h>
+#include <vespa/searchcore/fdispatch/search/datasetcollection.h>
+#include <vespa/searchcore/fdispatch/search/plain_dataset.h>
 #include <vespa/searchcore/util/eventloop.h>
 #include <vespa/vespalib/util/exceptions.h>
 #include <vespa/config/helper/configgetter.hpp>
@@ -127,6 +129,27 @@ Fdispatch::GetDataSetCollection()
     return ( _nodeManager) ? _nodeManager->GetDataSetCollection() : nullptr;
 }
 
+HedgeCounts
+Fdispatch::getHedgeCounts()
+{
+    HedgeCounts counts;
+    FastS_DataSetCollection *dsc = GetDataSetCollection();
+    if (dsc == nullptr) {
+        return counts;
+    }
+    for (uint32_t i = 0; i < dsc->GetMaxNumDataSets(); i++) {
+        FastS_DataSetBase *ds;
+        FastS_PlainDataSet *ds_plain;
+        if ((ds = dsc->PeekDataSet(i)) == nullptr ||
+            (ds_plain = ds->GetPlainDataSet()) == nullptr)
+            continue;
+
+        counts += ds_plain->getHedgePolicy().getCounts();
+    }
+    dsc->subRef();
+    return counts;
+}
+
 FastOS_ThreadPool *
 Fdispatch::GetThreadPool()
 {
@@ -4,6 +4,7 @@
 
 #include <vespa/fnet/fnet.h>
 #include <vespa/searchcore/fdispatch/common/appcontext.h>
+#include <vespa/searchcore/fdispatch/search/hedge_policy.h>
 #include <vespa/searchlib/engine/transportserver.h>
 #include <vespa/searchcore/config/config-fdispatchrc.h>
 #include <vespa/config/subscription/configuri.h>
@@ -102,6 +103,11 @@ public:
     bool Init();
     int getHealthPort() const { return _healthPort; }
     vespalib::SimpleComponentConfigProducer &getComponentConfig() { return _componentConfig; }
+    /**
+     * Returns the hedging counters summed over all datasets. The
+     * counters restart from zero when datasets are reconfigured.
+     */
+    HedgeCounts getHedgeCounts();
 
     Fdispatch(const config::ConfigUri &configUri);
     ~Fdispatch();
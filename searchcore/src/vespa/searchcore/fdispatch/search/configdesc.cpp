@@ -52,6 +52,9 @@ FastS_DataSetDesc::FastS_DataSetDesc(uint32_t datasetid)
       _higherCoverageMinDocSumWait(0.1),
       _higherCoverageBaseDocSumWait(0.1),
       _minimalDocSumCoverage(100.0),
+      _hedgePercentile(0.0),
+      _hedgeBudget(0.05),
+      _hedgeMinWait(0.01),
       _engineCnt(0),
       _enginesHead(NULL),
       _enginesTail(NULL),
@@ -315,6 +318,9 @@ FastS_DataSetCollDesc::ReadConfig(const PartitionsConfig& partmap)
         dataset->setHigherCoverageMinDocSumWait(dsconfig.higherCoverageMindocsumwait);
         dataset->setHigherCoverageBaseDocSumWait(dsconfig.higherCoverageBasedocsumwait);
         dataset->setMinimalDocSumCoverage(dsconfig.minimalDocsumcoverage);
+        dataset->setHedgePercentile(dsconfig.hedgePercentile);
+        dataset->setHedgeBudget(dsconfig.hedgeBudget);
+        dataset->setHedgeMinWait(dsconfig.hedgeMinwait);
         FastS_DataSetDesc::QueryDistributionMode distMode(dsconfig.querydistribution,
                                                           dsconfig.minGroupCoverage,
                                                           dsconfig.latencyDecayRate);
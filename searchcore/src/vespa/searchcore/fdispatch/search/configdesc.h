@@ -155,6 +155,9 @@ private:
     double   _higherCoverageMinDocSumWait;
     double   _higherCoverageBaseDocSumWait;
     double   _minimalDocSumCoverage;
+    double   _hedgePercentile;
+    double   _hedgeBudget;
+    double   _hedgeMinWait;
 
     uint32_t          _engineCnt;    // number of search engines in dataset
     FastS_EngineDesc *_enginesHead;  // first engine in dataset
@@ -331,6 +334,13 @@ public:
         return _minimalDocSumCoverage;
     }
 
+    void setHedgePercentile(double value) { _hedgePercentile = value; }
+    double getHedgePercentile() const { return _hedgePercentile; }
+    void setHedgeBudget(double value) { _hedgeBudget = value; }
+    double getHedgeBudget() const { return _hedgeBudget; }
+    void setHedgeMinWait(double value) { _hedgeMinWait = value; }
+    double getHedgeMinWait() const { return _hedgeMinWait; }
+
     void FinalizeConfig();
 };
 
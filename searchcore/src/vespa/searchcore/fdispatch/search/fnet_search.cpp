@@ -44,6 +44,8 @@ FastS_FNET_SearchNode::FastS_FNET_SearchNode(FastS_FNET_Search *search, uint32_t
       _docsumTime(0.0),
       _gdx(nullptr),
       _docsum_offsets(),
+      _hedge(),
+      _hedgeOf(nullptr),
       _extraDocsumNodes(),
       _nextExtraDocsumNode(this),
       _prevExtraDocsumNode(this),
@@ -237,6 +239,12 @@ FastS_FNET_Search::Timeout::PerformTask()
     _search->HandleTimeout();
 }
 
+void
+FastS_FNET_Search::HedgeTask::PerformTask()
+{
+    _search->HandleHedge();
+}
+
 //---------------------------------------------------------------------
 
 void
@@ -539,6 +547,7 @@ FastS_FNET_Search::FastS_FNET_Search(FastS_DataSetCollection *dsc,
       _timeKeeper(timeKeeper),
       _startTime(timeKeeper->GetTime()),
       _timeout(dataset->GetAppContext()->GetFNETScheduler(), this),
+      _hedgeTask(dataset->GetAppContext()->GetFNETScheduler(), this),
       _util(),
       _dsc(dsc),
       _dataset(dataset),
@@ -567,6 +576,8 @@ FastS_FNET_Search::FastS_FNET_Search(FastS_DataSetCollection *dsc,
       _docSumStartTime(0.0),
       _adjustedDocSumTimeOut(0.0),
       _fixedRow(0),
+      _hedging(false),
+      _queryPacket(),
       _resbuf()
 {
     _util.GetQuery().SetDataSet(dataset->GetID());
@@ -577,6 +588,7 @@ FastS_FNET_Search::FastS_FNET_Search(FastS_DataSetCollection *dsc,
 
 FastS_FNET_Search::~FastS_FNET_Search()
 {
+    _hedgeTask.Kill();
     _timeout.Kill();
     _nodes.clear();
     _util.DropResult();
@@ -607,8 +619,9 @@ FastS_FNET_Search::GotQueryResult(FastS_FNET_SearchNode *node,
 
     if (_FNET_mode == FNET_QUERY &&
         node->_flags._pendingQuery) {
-        FastS_assert(node->_qresult == nullptr);
-        node->_qresult = qrx;
+        FastS_FNET_SearchNode *primary = node->getPrimary();
+        FastS_assert(primary->_qresult == nullptr);
+        primary->_qresult = qrx;
         EncodePartIDs(node->getPartID(), node->GetRowID(),
                       (qrx->_features & search::fs4transport::QRF_MLD) != 0,
                       qrx->_hits, qrx->_hits + qrx->_numDocs);
@@ -616,8 +629,15 @@ FastS_FNET_Search::GotQueryResult(FastS_FNET_SearchNode *node,
         node->_flags._pendingQuery = false;
         _pendingQueries--;
         double tnow = GetTimeKeeper()->GetTime();
-        node->_queryTime = tnow - _startTime;
-        node->GetEngine()->UpdateSearchTime(tnow, node->_queryTime, false);
+        primary->_queryTime = tnow - _startTime;
+        node->GetEngine()->UpdateSearchTime(tnow, primary->_queryTime, false);
+        if (_hedging) {
+            FastS_FNET_SearchNode *loser = hedgedQueryDone(node, _dataset->getHedgePolicy(), tnow - _queryStartTime);
+            if (loser == primary) {
+                // the slow node is not waited for, count it as timed out
+                primary->GetEngine()->UpdateSearchTime(tnow, primary->_queryTime, true);
+            }
+        }
         adjustQueryTimeout();
         node->dropCost();
     } else {
@@ -662,11 +682,13 @@ FastS_FNET_Search::LostSearchNode(FastS_FNET_SearchNode *node)
     }
 
     if (_FNET_mode == FNET_QUERY && node->_flags._pendingQuery) {
-        FastS_assert(_pendingQueries > 0);
-        _pendingQueries--;
-        node->_flags._pendingQuery = false;
-        adjustQueryTimeout();
-        node->dropCost();
+        if (!hedgeTakesOver(node)) {
+            FastS_assert(_pendingQueries > 0);
+            _pendingQueries--;
+            node->_flags._pendingQuery = false;
+            adjustQueryTimeout();
+            node->dropCost();
+        }
     } else if (_FNET_mode == FNET_DOCSUMS && node->_pendingDocsums > 0) {
         uint32_t nodePendingDocsums = node->_pendingDocsums;
         FastS_assert(_pendingDocsums >= nodePendingDocsums);
@@ -689,11 +711,13 @@ FastS_FNET_Search::GotEOL(FastS_FNET_SearchNode *node)
 
     LOG(spam, "Got EOL from row(%d), part(%d) = pendingQ(%d) pendingDocsum(%d)", node->GetRowID(), node->getPartID(), node->_flags._pendingQuery, node->_pendingDocsums);
     if (_FNET_mode == FNET_QUERY && node->_flags._pendingQuery) {
-        FastS_assert(_pendingQueries > 0);
-        _pendingQueries--;
-        node->_flags._pendingQuery = false;
-        adjustQueryTimeout();
-        node->dropCost();
+        if (!hedgeTakesOver(node)) {
+            FastS_assert(_pendingQueries > 0);
+            _pendingQueries--;
+            node->_flags._pendingQuery = false;
+            adjustQueryTimeout();
+            node->dropCost();
+        }
     } else if (_FNET_mode == FNET_DOCSUMS && node->_pendingDocsums > 0) {
         uint32_t nodePendingDocsums = node->_pendingDocsums;
         FastS_assert(_pendingDocsums >= nodePendingDocsums);
@@ -723,7 +747,9 @@ FastS_FNET_Search::GotError(FastS_FNET_SearchNode *node,
         node->_flags._pendingQuery,
         node->_pendingDocsums);
 
-    if (_FNET_mode == FNET_QUERY && node->_flags._pendingQuery) {
+    if (_FNET_mode == FNET_QUERY && node->_flags._pendingQuery && hedgeTakesOver(node)) {
+        LOG(debug, "Hedged query still pending for part(%d) after error from row(%d)", node->getPartID(), node->GetRowID());
+    } else if (_FNET_mode == FNET_QUERY && node->_flags._pendingQuery) {
         FastS_assert(_pendingQueries > 0);
         _pendingQueries--;
         node->_flags._pendingQuery = false;
@@ -760,10 +786,14 @@ FastS_FNET_Search::HandleTimeout()
 
     if (_FNET_mode == FNET_QUERY) {
         for (FastS_FNET_SearchNode & node : _nodes) {
-            if (node._flags._pendingQuery) {
+            bool hedgePending = (node._hedge && node._hedge->_flags._pendingQuery);
+            if (node._flags._pendingQuery || hedgePending) {
                 FastS_assert(_pendingQueries > 0);
                 _pendingQueries--;
                 node._flags._pendingQuery = false;
+                if (hedgePending) {
+                    node._hedge->_flags._pendingQuery = false;
+                }
                 node._flags._queryTimeout = true;
                 _queryNodesTimedOut++;
                 double tnow = GetTimeKeeper()->GetTime();
@@ -803,6 +833,118 @@ FastS_FNET_Search::HandleTimeout()
     EndFNETWork(std::move(searchGuard));
 }
 
+void
+FastS_FNET_Search::HandleHedge()
+{
+    fdispatch::HedgePolicy &policy = _dataset->getHedgePolicy();
+    std::vector<FastS_FNET_SearchNode *> slowNodes;
+    {
+        std::lock_guard<std::mutex> searchGuard(_lock);
+        if (_FNET_mode != FNET_QUERY) {
+            return;
+        }
+        double elapsed = GetTimeKeeper()->GetTime() - _queryStartTime;
+        for (FastS_FNET_SearchNode & node : _nodes) {
+            if (node._flags._pendingQuery && !node._flags._hedgeChecked) {
+                double delay = policy.getHedgeDelay(node.getPartID());
+                if (delay >= 0.0 && elapsed >= delay) {
+                    node._flags._hedgeChecked = true;
+                    slowNodes.push_back(&node);
+                }
+            }
+        }
+    }
+
+    // pick another engine for each slow node, as long as the budget allows
+    std::vector<FastS_FNET_SearchNode::UP> hedges;
+    {
+        auto dsGuard(_dataset->getDsGuard());
+        for (FastS_FNET_SearchNode *node : slowNodes) {
+            FastS_EngineBase *engine = _dataset->getHedgePartition(dsGuard, node->GetEngine());
+            if (engine == nullptr) {
+                continue;
+            }
+            if (engine->GetFNETEngine() == nullptr || !policy.tryHedge()) {
+                engine->SubCost();
+                continue;
+            }
+            FastS_FNET_SearchNode::UP hedge(new FastS_FNET_SearchNode(this, node->getPartID()));
+            hedge->_hedgeOf = node;
+            hedge->Connect_HasDSLock(engine->GetFNETEngine());
+            hedges.push_back(std::move(hedge));
+        }
+    }
+
+    // send the query again, unless the slow node replied in the meantime
+    {
+        std::lock_guard<std::mutex> searchGuard(_lock);
+        for (FastS_FNET_SearchNode::UP &hedge : hedges) {
+            FastS_FNET_SearchNode *node = hedge->_hedgeOf;
+            if (_FNET_mode == FNET_QUERY && node->_flags._pendingQuery) {
+                hedge->_flags._pendingQuery = true;
+                if (hedge->PostPacket(new FS4Packet_Shared(_queryPacket))) {
+                    LOG(debug, "Hedging query for part(%d) from row(%d) to row(%d)",
+                        node->getPartID(), node->GetRowID(), hedge->GetRowID());
+                    node->_hedge = std::move(hedge);
+                } else {
+                    hedge->_flags._pendingQuery = false;
+                }
+            }
+        }
+        if (_FNET_mode == FNET_QUERY) {
+            scheduleHedge();
+        }
+    }
+    hedges.clear(); // drop unused hedges without holding the search lock
+}
+
+void
+FastS_FNET_Search::scheduleHedge()
+{
+    fdispatch::HedgePolicy &policy = _dataset->getHedgePolicy();
+    double next = -1.0;
+    for (const FastS_FNET_SearchNode & node : _nodes) {
+        if (node._flags._pendingQuery && !node._flags._hedgeChecked) {
+            double delay = policy.getHedgeDelay(node.getPartID());
+            if (delay >= 0.0 && (next < 0.0 || delay < next)) {
+                next = delay;
+            }
+        }
+    }
+    if (next >= 0.0) {
+        double elapsed = GetTimeKeeper()->GetTime() - _queryStartTime;
+        _hedgeTask.Schedule(std::max(next - elapsed, 0.0));
+    }
+}
+
+FastS_FNET_SearchNode *
+FastS_FNET_Search::hedgedQueryDone(FastS_FNET_SearchNode *node, fdispatch::HedgePolicy &policy, double latency)
+{
+    policy.updateLatency(node->getPartID(), latency);
+    FastS_FNET_SearchNode *sibling = node->getHedgeSibling();
+    if (sibling == nullptr || !sibling->_flags._pendingQuery) {
+        return nullptr;
+    }
+    sibling->_flags._pendingQuery = false;
+    sibling->dropCost();
+    if (node != node->getPrimary()) {
+        policy.countWin();
+    }
+    return sibling;
+}
+
+bool
+FastS_FNET_Search::hedgeTakesOver(FastS_FNET_SearchNode *node)
+{
+    FastS_FNET_SearchNode *sibling = node->getHedgeSibling();
+    if (sibling == nullptr || !sibling->_flags._pendingQuery) {
+        return false;
+    }
+    node->_flags._pendingQuery = false;
+    node->dropCost();
+    return true;
+}
+
 std::unique_lock<std::mutex>
 FastS_FNET_Search::BeginFNETWork()
 {
@@ -1115,6 +1257,10 @@ FastS_FNET_Search::Search(uint32_t searchOffset,
         _timeout.Schedule(_adjustedQueryTimeOut);
     }
     FNET_Packet::SP shared(new FS4Packet_PreSerialized(*setupQueryPacket(hitsPerNode, qflags, _queryArgs->propertiesMap)));
+    _hedging = (_dataset->getHedgePolicy().enabled() && searchPath.empty() && !_util.IsEstimate());
+    if (_hedging) {
+        _queryPacket = shared;
+    }
     for (uint32_t i = 0; i < _nodes.size(); i++) {
         FastS_FNET_SearchNode & node = _nodes[i];
         if (node.IsConnected()) {
@@ -1129,6 +1275,10 @@ FastS_FNET_Search::Search(uint32_t searchOffset,
         }
     }
 
+    if (_hedging) {
+        _dataset->getHedgePolicy().countRequests(num_send_ok);
+    }
+
     // finalize setup and check if query is still in progress
     bool done;
     {
@@ -1154,6 +1304,8 @@ FastS_FNET_Search::Search(uint32_t searchOffset,
             if (all_down) {
                 SetError(search::engine::ECODE_ALL_PARTITIONS_DOWN, nullptr);
             }
+        } else if (_hedging) {
+            scheduleHedge();
         }
     }
 
@@ -1220,6 +1372,7 @@ FastS_FNET_Search::setupQueryPacket(uint32_t hitsPerNode, uint32_t qflags,
 FastS_ISearch::RetCode
 FastS_FNET_Search::ProcessQueryDone()
 {
+    _hedgeTask.Unschedule();
     CheckCoverage();
 
     if (_errorCode == search::engine::ECODE_NO_ERROR) {
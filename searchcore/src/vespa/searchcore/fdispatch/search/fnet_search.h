@@ -10,6 +10,7 @@
 #include <vespa/searchcore/fdispatch/search/search_path.h>
 #include <vespa/searchcore/fdispatch/search/querycacheutil.h>
 #include <vespa/searchcore/fdispatch/search/fnet_engine.h>
+#include <vespa/searchcore/fdispatch/search/hedge_policy.h>
 
 class FastS_FNET_Engine;
 class FastS_FNET_Search;
@@ -46,13 +47,15 @@ public:
             _docsumMld(false),
             _queryTimeout(false),
             _docsumTimeout(false),
-            _needSubCost(false)
+            _needSubCost(false),
+            _hedgeChecked(false)
         { }
         bool  _pendingQuery;   // is query pending ?
         bool  _docsumMld;
         bool  _queryTimeout;
         bool  _docsumTimeout;
         bool  _needSubCost;
+        bool  _hedgeChecked;   // has been considered for hedging ?
     };
 
     Flags       _flags;
@@ -66,6 +69,10 @@ public:
 
     FS4Packet_GETDOCSUMSX  *_gdx;
     std::vector<uint32_t>   _docsum_offsets;
+
+// Hedging related stuff.
+    UP                      _hedge;   // same query sent to another engine
+    FastS_FNET_SearchNode  *_hedgeOf; // node we are a hedge for
 private:
     std::vector<FastS_FNET_SearchNode::UP> _extraDocsumNodes;
     FastS_FNET_SearchNode *_nextExtraDocsumNode;
@@ -110,6 +117,8 @@ public:
     void Connect(FastS_FNET_Engine *engine);
     void Connect_HasDSLock(FastS_FNET_Engine *engine);
     FastS_EngineBase * getPartition(const std::unique_lock<std::mutex> &dsGuard, bool userow, FastS_FNET_DataSet *dataset);
+    FastS_FNET_SearchNode *getPrimary() { return (_hedgeOf != nullptr) ? _hedgeOf : this; }
+    FastS_FNET_SearchNode *getHedgeSibling() { return (_hedgeOf != nullptr) ? _hedgeOf : _hedge.get(); }
     void allocGDX(search::docsummary::GetDocsumArgs *args, const search::engine::PropertiesMap &properties);
     void postGDX(uint32_t *pendingDocsums, uint32_t *pendingDocsumNodes);
     vespalib::string toString() const;
@@ -201,6 +210,21 @@ public:
         void PerformTask() override;
     };
 
+    class HedgeTask : public FNET_Task
+    {
+    private:
+        HedgeTask(const HedgeTask &);
+        HedgeTask& operator=(const HedgeTask &);
+
+        FastS_FNET_Search *_search;
+
+    public:
+        HedgeTask(FNET_Scheduler *scheduler, FastS_FNET_Search *search)
+            : FNET_Task(scheduler),
+              _search(search) {}
+        void PerformTask() override;
+    };
+
     enum FNETMode {
         FNET_NONE    = 0x00,
         FNET_QUERY   = 0x01,
@@ -212,6 +236,7 @@ private:
     FastS_TimeKeeper        *_timeKeeper;
     double                   _startTime;
     Timeout                  _timeout;
+    HedgeTask                _hedgeTask;
     FastS_QueryCacheUtil     _util;
     std::unique_ptr<search::grouping::MergingManager> _groupMerger;
     FastS_DataSetCollection *_dsc;  // owner keeps this alive
@@ -245,6 +270,8 @@ private:
     double                   _docSumStartTime;
     double                   _adjustedDocSumTimeOut;
     uint32_t                 _fixedRow;
+    bool                     _hedging;
+    FNET_Packet::SP          _queryPacket;
 
     std::vector<FastS_fullresult>  _resbuf;
 
@@ -273,6 +300,8 @@ private:
     FastS_TimeKeeper *GetTimeKeeper() const { return _timeKeeper; }
 
     FastS_FNET_SearchNode * getNode(size_t i) { return &_nodes[i]; }
+
+    void scheduleHedge();
 public:
     FastS_FNET_Search(FastS_DataSetCollection *dsc, FastS_FNET_DataSet *dataset, FastS_TimeKeeper *timeKeeper);
     virtual ~FastS_FNET_Search();
@@ -284,12 +313,28 @@ public:
     void GotError(FastS_FNET_SearchNode *node, search::fs4transport::FS4Packet_ERROR *error);
 
     void HandleTimeout();
+    void HandleHedge();
 
     bool ShouldLimitHitsPerNode() const;
     void MergeHits();
     void CheckCoverage();
     static FastS_SearchInfo computeCoverage(const std::vector<FastS_FNET_SearchNode> & nodes,
                                             uint32_t numSearchableCopies, bool adaptiveTimeout);
+    /**
+     * Called when a node has replied to a hedged query. The latency of
+     * the reply is learned by the policy, and the other node querying
+     * the same partition, if any, is no longer waited for.
+     * @return the node that lost the race, or nullptr.
+     **/
+    static FastS_FNET_SearchNode *hedgedQueryDone(FastS_FNET_SearchNode *node, fdispatch::HedgePolicy &policy,
+                                                  double latency);
+    /**
+     * Called when a node fails to reply to a query. If the query to its
+     * partition was hedged and the other node is still pending, that node
+     * takes over and this one is no longer waited for.
+     * @return true if the other node took over.
+     **/
+    static bool hedgeTakesOver(FastS_FNET_SearchNode *node);
     void CheckQueryTimes();
     void CheckDocsumTimes();
     void CheckQueryTimeout();
@@ -0,0 +1,147 @@
+// Copyright 2019 Oath Inc. Licensed under the terms of the Apache 2.0 license. See LICENSE in the project root.
+
+#include "hedge_policy.h"
+#include <algorithm>
+#include <cmath>
+
+namespace fdispatch {
+
+// four buckets per doubling of the latency
+constexpr double BUCKETS_PER_DOUBLING = 4.0;
+// tolerate rounding when adding up fractions of a hedge
+constexpr double TOKEN_EPSILON = 1e-9;
+
+LatencyHistogram::LatencyHistogram()
+    : _buckets(NUM_BUCKETS, 0.0),
+      _total(0.0),
+      _numSamples(0)
+{ }
+
+size_t
+LatencyHistogram::bucketOf(double latency)
+{
+    if (latency <= MIN_LATENCY) {
+        return 0;
+    }
+    double bucket = std::ceil(std::log2(latency / MIN_LATENCY) * BUCKETS_PER_DOUBLING);
+    return std::min(static_cast<size_t>(bucket), NUM_BUCKETS - 1);
+}
+
+double
+LatencyHistogram::upperBound(size_t bucket)
+{
+    return MIN_LATENCY * std::exp2(bucket / BUCKETS_PER_DOUBLING);
+}
+
+void
+LatencyHistogram::add(double latency)
+{
+    if ((++_numSamples % DECAY_INTERVAL) == 0) {
+        for (double &count : _buckets) {
+            count *= 0.5;
+        }
+        _total *= 0.5;
+    }
+    _buckets[bucketOf(latency)] += 1.0;
+    _total += 1.0;
+}
+
+double
+LatencyHistogram::percentile(double percent) const
+{
+    double wanted = _total * percent / 100.0;
+    double accum = 0.0;
+    for (size_t i = 0; i < NUM_BUCKETS; ++i) {
+        accum += _buckets[i];
+        if (accum >= wanted) {
+            return upperBound(i);
+        }
+    }
+    return upperBound(NUM_BUCKETS - 1);
+}
+
+HedgePolicy::HedgePolicy(size_t numPartitions, double percentile, double budget, double minDelay)
+    : _lock(),
+      _partitions(numPartitions),
+      _percentile(std::min(percentile, 100.0)),
+      _budget(budget),
+      _minDelay(minDelay),
+      _tokens(0.0),
+      _numHedged(0),
+      _numWins(0)
+{ }
+
+HedgePolicy::~HedgePolicy() = default;
+
+void
+HedgePolicy::updateLatency(uint32_t partid, double latency)
+{
+    std::lock_guard<std::mutex> guard(_lock);
+    if (partid < _partitions.size()) {
+        _partitions[partid].add(latency);
+    }
+}
+
+double
+HedgePolicy::getHedgeDelay(uint32_t partid) const
+{
+    std::lock_guard<std::mutex> guard(_lock);
+    if (!enabled() || (partid >= _partitions.size()) ||
+        (_partitions[partid].numSamples() < MIN_SAMPLES))
+    {
+        return -1.0;
+    }
+    return std::max(_partitions[partid].percentile(_percentile), _minDelay);
+}
+
+void
+HedgePolicy::countRequests(uint32_t cnt)
+{
+    std::lock_guard<std::mutex> guard(_lock);
+    _tokens = std::min(_tokens + cnt * _budget, MAX_BURST);
+}
+
+bool
+HedgePolicy::tryHedge()
+{
+    std::lock_guard<std::mutex> guard(_lock);
+    if (_tokens < 1.0 - TOKEN_EPSILON) {
+        return false;
+    }
+    _tokens = std::max(_tokens - 1.0, 0.0);
+    ++_numHedged;
+    return true;
+}
+
+void
+HedgePolicy::countWin()
+{
+    std::lock_guard<std::mutex> guard(_lock);
+    ++_numWins;
+}
+
+uint64_t
+HedgePolicy::numHedged() const
+{
+    std::lock_guard<std::mutex> guard(_lock);
+    return _numHedged;
+}
+
+uint64_t
+HedgePolicy::numWins() const
+{
+    std::lock_guard<std::mutex> guard(_lock);
+    return _numWins;
+}
+
+HedgeCounts
+HedgePolicy::getCounts() const
+{
+    std::lock_guard<std::mutex> guard(_lock);
+    HedgeCounts counts;
+    counts.numHedged = _numHedged;
+    counts.numWins = _numWins;
+    return counts;
+}
+
+}
@@ -0,0 +1,93 @@
+// Copyright 2019 Oath Inc. Licensed under the terms of the Apache 2.0 license. See LICENSE in the project root.
+
+#pragma once
+
+#include <vector>
+#include <mutex>
+#include <cstdint>
+
+namespace fdispatch {
+
+/**
+ * LatencyHistogram keeps a decaying histogram of query latencies with
+ * logarithmically sized buckets, and is used to estimate latency
+ * percentiles. All counts are halved for each decay interval of
+ * samples, so that the estimate follows changes in node behavior.
+ **/
+class LatencyHistogram {
+public:
+    static constexpr size_t NUM_BUCKETS = 64;
+    static constexpr double MIN_LATENCY = 0.0005;
+    static constexpr uint32_t DECAY_INTERVAL = 1000;
+
+    LatencyHistogram();
+    void add(double latency);
+    uint64_t numSamples() const { return _numSamples; }
+    double percentile(double percent) const;
+    static size_t bucketOf(double latency);
+    static double upperBound(size_t bucket);
+private:
+    std::vector<double> _buckets;
+    double              _total;
+    uint64_t            _numSamples;
+};
+
+/**
+ * The number of queries hedged and the number of hedges that replied
+ * before the node they were a hedge for.
+ **/
+struct HedgeCounts {
+    uint64_t numHedged;
+    uint64_t numWins;
+
+    HedgeCounts() : numHedged(0), numWins(0) {}
+    HedgeCounts &operator+=(const HedgeCounts &rhs) {
+        numHedged += rhs.numHedged;
+        numWins += rhs.numWins;
+        return *this;
+    }
+};
+
+/**
+ * HedgePolicy decides when a query that has been sent to a node
+ * should also be sent to another node holding the same partition.
+ * The latency of each partition is learned from the replies, and a
+ * query that has been waiting for longer than the configured
+ * percentile of its partition is a candidate for hedging. The extra
+ * load is limited by a budget; each query sent to a node earns a
+ * fraction of a hedge, and each hedge spends a whole one.
+ * All methods are thread safe.
+ **/
+class HedgePolicy {
+public:
+    static constexpr uint64_t MIN_SAMPLES = 100;
+    static constexpr double MAX_BURST = 10.0;
+
+    HedgePolicy(size_t numPartitions, double percentile, double budget, double minDelay);
+    ~HedgePolicy();
+    bool enabled() const { return (_percentile > 0.0) && (_budget > 0.0); }
+    void updateLatency(uint32_t partid, double latency);
+    /**
+     * @return the number of seconds to wait for a reply from the
+     *         given partition before hedging, or a negative value
+     *         if not enough is known about the partition yet.
+     **/
+    double getHedgeDelay(uint32_t partid) const;
+    void countRequests(uint32_t cnt);
+    bool tryHedge();
+    void countWin();
+    uint64_t numHedged() const;
+    uint64_t numWins() const;
+    HedgeCounts getCounts() const;
+private:
+    mutable std::mutex            _lock;
+    std::vector<LatencyHistogram> _partitions;
+    const double                  _percentile;
+    const double                  _budget;
+    const double                  _minDelay;
+    double                        _tokens;
+    uint64_t                      _numHedged;
+    uint64_t                      _numWins;
+};
+
+}
@@ -196,6 +196,7 @@ FastS_PlainDataSet::FastS_PlainDataSet(FastS_AppContext *appCtx,
     : FastS_DataSetBase(appCtx, desc),
       _partMap(desc),
       _stateOfRows(_partMap.getNumRows(), 0.001, desc->GetQueryDistributionMode().getLatencyDecayRate()),
+      _hedgePolicy(_partMap._num_partitions, desc->getHedgePercentile(), desc->getHedgeBudget(), desc->getHedgeMinWait()),
       _MHPN_log(),
       _slowQueryLimitFactor(desc->GetSlowQueryLimitFactor()),
       _slowQueryLimitBias(desc->GetSlowQueryLimitBias()),
@@ -451,6 +452,37 @@ FastS_PlainDataSet::getPartitionMLD(const std::unique_lock<std::mutex> &dsGuard,
     return ret;
 }
 
+FastS_EngineBase *
+FastS_PlainDataSet::getHedgePartition(const std::unique_lock<std::mutex> &dsGuard, FastS_EngineBase *engine)
+{
+    (void) dsGuard;
+    FastS_EngineBase*  ret = nullptr;
+    unsigned int oldCount = 1;
+    uint32_t partindex = engine->GetPartID() - _partMap._first_partition;
+
+    if (IsValidPartIndex_HasLock(partindex)) {
+        for (FastS_EngineBase* iter = _partMap._partitions[partindex]._engines;
+             iter != nullptr;
+             iter = iter->_nextpart) {
+
+            // NB: cost race condition
+
+            if (iter != engine &&
+                !iter->IsRealBad() &&
+                EngineDocStampOK(iter->_reported._docstamp) &&
+                (!useFixedRowDistribution() || iter->_config._confRowID == engine->_config._confRowID) &&
+                (ret == nullptr || UseNewEngine(ret, iter, &oldCount)))
+            {
+                ret = iter;
+            }
+        }
+    }
+    if (ret != nullptr) {
+        ret->AddCost();
+    }
+    return ret;
+}
+
 void
 FastS_PlainDataSet::LinkInPart_HasLock(FastS_EngineBase *engine)
 {
@@ -9,6 +9,7 @@
 #include <vespa/searchlib/util/rand48.h>
 #include <vespa/searchcore/fdispatch/search/configdesc.h>
 #include <vespa/searchcore/fdispatch/search/rowstate.h>
+#include <vespa/searchcore/fdispatch/search/hedge_policy.h>
 #include <vespa/fnet/task.h>
 
 class FastS_EngineBase;
@@ -107,6 +108,7 @@ public:
 protected:
     FastS_PartitionMap     _partMap;
     fdispatch::StateOfRows _stateOfRows;
+    fdispatch::HedgePolicy _hedgePolicy;
     MHPN_log_t   _MHPN_log;
     double       _slowQueryLimitFactor;
     double       _slowQueryLimitBias;
@@ -179,6 +181,14 @@ public:
     FastS_EngineBase * getPartitionMLD(const std::unique_lock<std::mutex> &dsGuard, uint32_t partid, bool mld);
     FastS_EngineBase * getPartitionMLD(const std::unique_lock<std::mutex> &dsGuard, uint32_t partid, bool mld, uint32_t rowid);
 
+    /**
+     * Select another engine serving the same partition as the given
+     * one, to be used for a hedged query. With fixed row distribution
+     * the engine must be in the same row.
+     **/
+    FastS_EngineBase * getHedgePartition(const std::unique_lock<std::mutex> &dsGuard, FastS_EngineBase *engine);
+    fdispatch::HedgePolicy &getHedgePolicy() { return _hedgePolicy; }
+
     void LinkInPart_HasLock(FastS_EngineBase *engine);
     void LinkOutPart_HasLock(FastS_EngineBase *engine);
 
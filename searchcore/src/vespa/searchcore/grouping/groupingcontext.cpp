@@ -24,6 +24,7 @@ GroupingContext::deserialize(const char *groupSpec, uint32_t groupSpecLen)
             grouping->deserialize(nis);
             grouping->setClock(&_clock);
             grouping->setTimeOfDoom(_timeOfDoom);
+            grouping->setMaxGroupsInMemory(_maxGroupsInMemory);
             _groupingList.push_back(grouping);
         }
     }
@@ -53,6 +54,7 @@ GroupingContext::setDistributionKey(uint32_t distributionKey)
 GroupingContext::GroupingContext(const vespalib::Clock & clock, fastos::TimeStamp timeOfDoom, const char *groupSpec, uint32_t groupSpecLen) :
     _clock(clock),
     _timeOfDoom(timeOfDoom),
+    _maxGroupsInMemory(0),
     _os(),
     _groupingList()
 {
@@ -62,6 +64,7 @@ GroupingContext::GroupingContext(const vespalib::Clock & clock, fastos::TimeStam
 GroupingContext::GroupingContext(const vespalib::Clock & clock, fastos::TimeStamp timeOfDoom) :
     _clock(clock),
     _timeOfDoom(timeOfDoom),
+    _maxGroupsInMemory(0),
     _os(),
     _groupingList()
 {
@@ -70,6 +73,7 @@ GroupingContext::GroupingContext(const vespalib::Clock & clock, fastos::TimeStam
 GroupingContext::GroupingContext(const GroupingContext & rhs) :
     _clock(rhs._clock),
     _timeOfDoom(rhs._timeOfDoom),
+    _maxGroupsInMemory(rhs._maxGroupsInMemory),
     _os(),
     _groupingList()
 {
@@ -93,6 +97,15 @@ GroupingContext::serialize()
     }
 }
 
+void
+GroupingContext::setMaxGroupsInMemory(uint32_t maxGroupsInMemory)
+{
+    _maxGroupsInMemory = maxGroupsInMemory;
+    for (GroupingPtr & g : _groupingList) {
+        g->setMaxGroupsInMemory(maxGroupsInMemory);
+    }
+}
+
 bool
 GroupingContext::needRanking() const
 {
@@ -23,6 +23,7 @@ public:
 private:
     const vespalib::Clock     & _clock;
     fastos::TimeStamp           _timeOfDoom;
+    uint32_t                    _maxGroupsInMemory;
     vespalib::nbostream         _os;
     GroupingList                _groupingList;
 public:
@@ -106,6 +107,14 @@ public:
      * Obtain the time of doom.
      */
     fastos::TimeStamp getTimeOfDoom() const { return _timeOfDoom; }
+    /**
+     * Limit the number of top-level groups each grouping in this
+     * context keeps in memory while aggregating, spilling the rest to
+     * disk. Also applies to groupings deserialized later.
+     *
+     * @param maxGroupsInMemory the group limit, 0 means never spill.
+     */
+    void setMaxGroupsInMemory(uint32_t maxGroupsInMemory);
     /**
      * Figure out if ranking is necessary for any of the grouping requests here.
      * @return true if ranking is required.
@@ -5,6 +5,7 @@
 #include "groupingcontext.h"
 #include <vespa/searchlib/aggregation/fs4hit.h>
 #include <vespa/searchlib/expression/attributenode.h>
+#include <vespa/vespalib/util/thread_bundle.h>
 
 #include <vespa/log/log.h>
 LOG_SETUP(".groupingmanager");
@@ -117,6 +118,57 @@ GroupingManager::prune()
     }
 }
 
+namespace {
+
+/**
+ * Prunes every n'th top-level group, letting a bundle of threads
+ * share the groups of all groupings in a context.
+ **/
+class PruneTask : public vespalib::Runnable
+{
+    using GroupRef = std::pair<Grouping *, uint32_t>;
+    const std::vector<GroupRef> &_groups;
+    size_t                       _first;
+    size_t                       _stride;
+public:
+    PruneTask(const std::vector<GroupRef> &groups, size_t first, size_t stride)
+        : _groups(groups), _first(first), _stride(stride) {}
+    void run() override {
+        for (size_t i = _first; i < _groups.size(); i += _stride) {
+            _groups[i].first->postMergeAndSortGroup(_groups[i].second);
+        }
+    }
+};
+
+}
+
+void
+GroupingManager::prune(vespalib::ThreadBundle &threadBundle)
+{
+    GroupingContext::GroupingList &groupingList(_groupingContext.getGroupingList());
+    std::vector<std::pair<Grouping *, uint32_t>> groups;
+    for (size_t i = 0; i < groupingList.size(); ++i) {
+        Grouping &g = *groupingList[i];
+        g.postMergeTopLevel();
+        for (uint32_t j = 0; j < g.getRoot().getChildrenSize(); ++j) {
+            groups.emplace_back(&g, j);
+        }
+    }
+    size_t numTasks = std::min(threadBundle.size(), groups.size());
+    if (numTasks <= 1) {
+        PruneTask(groups, 0, 1).run();
+        return;
+    }
+    std::vector<PruneTask> tasks;
+    tasks.reserve(numTasks);
+    std::vector<vespalib::Runnable*> targets;
+    for (size_t i = 0; i < numTasks; ++i) {
+        tasks.emplace_back(groups, i, numTasks);
+        targets.push_back(&tasks.back());
+    }
+    threadBundle.run(targets);
+}
+
 void
 GroupingManager::convertToGlobalId(const search::IDocumentMetaStore &metaStore)
 {
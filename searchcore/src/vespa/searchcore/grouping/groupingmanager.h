@@ -8,6 +8,7 @@ namespace search {
     struct RankedHit;
     class BitVector;
 }
+namespace vespalib { struct ThreadBundle; }
 
 namespace search::grouping {
 
@@ -87,6 +88,14 @@ public:
      **/
     void prune();
 
+    /**
+     * Same as prune, but with the subtrees below the top-level groups
+     * pruned in parallel by the threads in the given bundle.
+     *
+     * @param threadBundle threads to share the pruning work
+     **/
+    void prune(vespalib::ThreadBundle &threadBundle);
+
     /**
      * Perform converting from local to global document id on all hits
      * in the underlying grouping trees.
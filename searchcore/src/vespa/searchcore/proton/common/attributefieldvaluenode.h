@@ -19,6 +19,7 @@ public:
     std::unique_ptr<document::select::Value> getValue(const Context &context) const override;
     std::unique_ptr<document::select::Value> traceValue(const Context &context, std::ostream& out) const override;
     document::select::ValueNode::UP clone() const override;
+    const std::shared_ptr<search::AttributeVector> &getAttribute() const { return _attribute; }
 };
 
 } // namespace proton
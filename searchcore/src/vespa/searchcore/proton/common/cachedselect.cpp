@@ -2,6 +2,7 @@
 
 #include "attributefieldvaluenode.h"
 #include "cachedselect.h"
+#include "compiledselect.h"
 #include "select_utils.h"
 #include "selectcontext.h"
 #include "selectpruner.h"
@@ -114,16 +115,27 @@ CachedSelect::Session::Session(std::unique_ptr<document::select::Node> docSelect
                                std::unique_ptr<document::select::Node> preDocSelect)
     : _docSelect(std::move(docSelect)),
       _preDocOnlySelect(std::move(preDocOnlySelect)),
-      _preDocSelect(std::move(preDocSelect))
+      _preDocSelect(std::move(preDocSelect)),
+      _compiledPreDocOnlySelect(_preDocOnlySelect ? CompiledSelect::compile(*_preDocOnlySelect) : std::unique_ptr<CompiledSelect>()),
+      _compiledPreDocSelect(_preDocSelect ? CompiledSelect::compile(*_preDocSelect) : std::unique_ptr<CompiledSelect>())
 {
 }
 
+CachedSelect::Session::~Session() = default;
+
 bool
 CachedSelect::Session::contains(const SelectContext &context) const
 {
-    if (_preDocSelect && (_preDocSelect->contains(context) == document::select::Result::False)) {
+    if (_compiledPreDocSelect) {
+        if (_compiledPreDocSelect->contains(context._docId) == document::select::Result::False) {
+            return false;
+        }
+    } else if (_preDocSelect && (_preDocSelect->contains(context) == document::select::Result::False)) {
         return false;
     }
+    if (_compiledPreDocOnlySelect) {
+        return (_compiledPreDocOnlySelect->contains(context._docId) == document::select::Result::True);
+    }
     return (!_preDocOnlySelect) ||
             (_preDocOnlySelect && (_preDocOnlySelect->contains(context) == document::select::Result::True));
 }
@@ -17,6 +17,7 @@ namespace search {
 
 namespace proton {
 
+class CompiledSelect;
 class SelectContext;
 class SelectPruner;
 
@@ -34,11 +35,15 @@ public:
         std::unique_ptr<document::select::Node> _docSelect;
         std::unique_ptr<document::select::Node> _preDocOnlySelect;
         std::unique_ptr<document::select::Node> _preDocSelect;
+        // Compiled forms of the above, if they only reference numeric attributes
+        std::unique_ptr<CompiledSelect> _compiledPreDocOnlySelect;
+        std::unique_ptr<CompiledSelect> _compiledPreDocSelect;
 
     public:
         Session(std::unique_ptr<document::select::Node> docSelect,
                 std::unique_ptr<document::select::Node> preDocOnlySelect,
                 std::unique_ptr<document::select::Node> preDocSelect);
+        ~Session();
         bool contains(const SelectContext &context) const;
         bool contains(const document::Document &doc) const;
         const document::select::Node &selectNode() const;
@@ -0,0 +1,361 @@
+// Copyright 2019 Oath Inc. Licensed under the terms of the Apache 2.0 license. See LICENSE in the project root.
+
+#include "compiledselect.h"
+#include "attributefieldvaluenode.h"
+#include <vespa/document/select/branch.h>
+#include <vespa/document/select/compare.h>
+#include <vespa/document/select/constant.h>
+#include <vespa/document/select/context.h>
+#include <vespa/document/select/invalidconstant.h>
+#include <vespa/document/select/operator.h>
+#include <vespa/document/select/valuenodes.h>
+#include <vespa/document/select/visitor.h>
+#include <vespa/searchlib/attribute/attributevector.h>
+#include <vespa/vespalib/util/exceptions.h>
+
+namespace proton {
+
+using document::select::And;
+using document::select::ArithmeticValueNode;
+using document::select::Compare;
+using document::select::Constant;
+using document::select::Context;
+using document::select::CurrentTimeValueNode;
+using document::select::DocType;
+using document::select::FieldValueNode;
+using document::select::FloatValue;
+using document::select::FloatValueNode;
+using document::select::FunctionOperator;
+using document::select::FunctionValueNode;
+using document::select::IdValueNode;
+using document::select::IntegerValue;
+using document::select::IntegerValueNode;
+using document::select::InvalidConstant;
+using document::select::InvalidValueNode;
+using document::select::Not;
+using document::select::NullValueNode;
+using document::select::Operator;
+using document::select::Or;
+using document::select::Result;
+using document::select::StringValueNode;
+using document::select::Value;
+using document::select::ValueNode;
+using document::select::VariableValueNode;
+using search::AttributeVector;
+using search::attribute::BasicType;
+
+using Evaluator = CompiledSelect::Evaluator;
+
+namespace {
+
+enum class CompareOp { LT, LEQ, GT, GEQ, EQ, NE };
+
+/*
+ * Mirrors how Value defines the comparison operators in terms of < and ==,
+ * so that e.g. comparisons involving NaN give the same result as when
+ * evaluating the expression tree.
+ */
+const Result &
+resultOf(CompareOp op, bool lt, bool eq)
+{
+    switch (op) {
+    case CompareOp::LT:  return Result::get(lt);
+    case CompareOp::LEQ: return Result::get(lt || eq);
+    case CompareOp::GT:  return Result::get(!lt && !eq);
+    case CompareOp::GEQ: return Result::get(!lt);
+    case CompareOp::EQ:  return Result::get(eq);
+    case CompareOp::NE:  return Result::get(!eq);
+    }
+    return Result::Invalid;
+}
+
+// Undefined attribute values are null values, which only compare for equality.
+const Result &
+resultOfNullComparison(CompareOp op)
+{
+    switch (op) {
+    case CompareOp::EQ: return Result::False;
+    case CompareOp::NE: return Result::True;
+    default:            return Result::Invalid;
+    }
+}
+
+bool
+isIntegerType(BasicType::Type type)
+{
+    switch (type) {
+    case BasicType::BOOL:
+    case BasicType::UINT2:
+    case BasicType::UINT4:
+    case BasicType::INT8:
+    case BasicType::INT16:
+    case BasicType::INT32:
+    case BasicType::INT64:
+        return true;
+    default:
+        return false;
+    }
+}
+
+bool
+isFloatType(BasicType::Type type)
+{
+    return (type == BasicType::FLOAT) || (type == BasicType::DOUBLE);
+}
+
+template <typename AttrT, typename ConstT>
+Evaluator
+makeComparison(std::shared_ptr<AttributeVector> attribute, ConstT constant,
+               CompareOp op, bool attributeOnLeft)
+{
+    return [attribute = std::move(attribute), constant, op, attributeOnLeft](uint32_t docId) -> const Result & {
+        if (attribute->isUndefined(docId)) {
+            return resultOfNullComparison(op);
+        }
+        AttrT value;
+        attribute->get(docId, &value, 1);
+        return (attributeOnLeft
+                ? resultOf(op, value < constant, value == constant)
+                : resultOf(op, constant < value, constant == value));
+    };
+}
+
+class Compiler : public document::select::Visitor
+{
+    bool _failed;
+    Evaluator _evaluator;
+
+    // Set when visiting value nodes.
+    const ValueNode *_constantNode;
+    std::shared_ptr<AttributeVector> _attribute;
+
+    void fail() { _failed = true; }
+
+    Evaluator compileBranch(const document::select::Node &node) {
+        node.visit(*this);
+        return std::move(_evaluator);
+    }
+
+    void resetValue() {
+        _constantNode = nullptr;
+        _attribute.reset();
+    }
+
+    bool getCompareOp(const Operator &op, CompareOp &result) const;
+    bool evaluateConstant(const ValueNode &node, std::unique_ptr<Value> &value) const;
+
+public:
+    Compiler()
+        : _failed(false),
+          _evaluator(),
+          _constantNode(nullptr),
+          _attribute()
+    {}
+    ~Compiler() override;
+
+    bool failed() const { return _failed; }
+    Evaluator stealEvaluator() { return std::move(_evaluator); }
+
+    void visitAndBranch(const And &expr) override;
+    void visitOrBranch(const Or &expr) override;
+    void visitNotBranch(const Not &expr) override;
+    void visitComparison(const Compare &expr) override;
+    void visitConstant(const Constant &expr) override;
+    void visitInvalidConstant(const InvalidConstant &) override;
+    void visitDocumentType(const DocType &) override { fail(); }
+    void visitArithmeticValueNode(const ArithmeticValueNode &expr) override;
+    void visitFunctionValueNode(const FunctionValueNode &) override { fail(); }
+    void visitIdValueNode(const IdValueNode &) override { fail(); }
+    void visitFieldValueNode(const FieldValueNode &expr) override;
+    void visitFloatValueNode(const FloatValueNode &expr) override { _constantNode = &expr; }
+    void visitVariableValueNode(const VariableValueNode &) override { fail(); }
+    void visitIntegerValueNode(const IntegerValueNode &expr) override { _constantNode = &expr; }
+    void visitCurrentTimeValueNode(const CurrentTimeValueNode &expr) override { _constantNode = &expr; }
+    void visitStringValueNode(const StringValueNode &) override { fail(); }
+    void visitNullValueNode(const NullValueNode &) override { fail(); }
+    void visitInvalidValueNode(const InvalidValueNode &) override { fail(); }
+};
+
+Compiler::~Compiler() = default;
+
+void
+Compiler::visitAndBranch(const And &expr)
+{
+    Evaluator lhs = compileBranch(expr.getLeft());
+    Evaluator rhs = compileBranch(expr.getRight());
+    _evaluator = [lhs = std::move(lhs), rhs = std::move(rhs)](uint32_t docId) -> const Result & {
+        const Result &lres = lhs(docId);
+        if (lres == Result::False) {
+            return Result::False;
+        }
+        return lres && rhs(docId);
+    };
+}
+
+void
+Compiler::visitOrBranch(const Or &expr)
+{
+    Evaluator lhs = compileBranch(expr.getLeft());
+    Evaluator rhs = compileBranch(expr.getRight());
+    _evaluator = [lhs = std::move(lhs), rhs = std::move(rhs)](uint32_t docId) -> const Result & {
+        const Result &lres = lhs(docId);
+        if (lres == Result::True) {
+            return Result::True;
+        }
+        return lres || rhs(docId);
+    };
+}
+
+void
+Compiler::visitNotBranch(const Not &expr)
+{
+    Evaluator child = compileBranch(expr.getChild());
+    _evaluator = [child = std::move(child)](uint32_t docId) -> const Result & {
+        return !child(docId);
+    };
+}
+
+void
+Compiler::visitConstant(const Constant &expr)
+{
+    const Result &result = Result::get(expr.getConstantValue());
+    _evaluator = [&result](uint32_t) -> const Result & { return result; };
+}
+
+void
+Compiler::visitInvalidConstant(const InvalidConstant &)
+{
+    _evaluator = [](uint32_t) -> const Result & { return Result::Invalid; };
+}
+
+void
+Compiler::visitArithmeticValueNode(const ArithmeticValueNode &expr)
+{
+    resetValue();
+    expr.getLeft().visit(*this);
+    bool constantLhs = (_constantNode != nullptr);
+    resetValue();
+    expr.getRight().visit(*this);
+    bool constantRhs = (_constantNode != nullptr);
+    resetValue();
+    if (constantLhs && constantRhs) {
+        _constantNode = &expr;
+    } else {
+        fail();
+    }
+}
+
+void
+Compiler::visitFieldValueNode(const FieldValueNode &expr)
+{
+    auto attrNode = dynamic_cast<const AttributeFieldValueNode *>(&expr);
+    if (attrNode == nullptr) {
+        fail();
+        return;
+    }
+    BasicType::Type type = attrNode->getAttribute()->getBasicType();
+    if (!isIntegerType(type) && !isFloatType(type)) {
+        fail();
+        return;
+    }
+    _attribute = attrNode->getAttribute();
+}
+
+bool
+Compiler::getCompareOp(const Operator &op, CompareOp &result) const
+{
+    if (op == FunctionOperator::LT) {
+        result = CompareOp::LT;
+    } else if (op == FunctionOperator::LEQ) {
+        result = CompareOp::LEQ;
+    } else if (op == FunctionOperator::GT) {
+        result = CompareOp::GT;
+    } else if (op == FunctionOperator::GEQ) {
+        result = CompareOp::GEQ;
+    } else if (op == FunctionOperator::EQ) {
+        result = CompareOp::EQ;
+    } else if (op == FunctionOperator::NE) {
+        result = CompareOp::NE;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+bool
+Compiler::evaluateConstant(const ValueNode &node, std::unique_ptr<Value> &value) const
+{
+    try {
+        value = node.getValue(Context());
+    } catch (vespalib::IllegalArgumentException &) {
+        return false;
+    }
+    return value && ((value->getType() == Value::Integer) || (value->getType() == Value::Float));
+}
+
+void
+Compiler::visitComparison(const Compare &expr)
+{
+    CompareOp op;
+    if (!getCompareOp(expr.getOperator(), op)) {
+        fail();
+        return;
+    }
+    resetValue();
+    expr.getLeft().visit(*this);
+    const ValueNode *lhsConstant = _constantNode;
+    std::shared_ptr<AttributeVector> lhsAttribute = std::move(_attribute);
+    resetValue();
+    expr.getRight().visit(*this);
+    const ValueNode *rhsConstant = _constantNode;
+    std::shared_ptr<AttributeVector> rhsAttribute = std::move(_attribute);
+    resetValue();
+    if (_failed) {
+        return;
+    }
+    bool attributeOnLeft = (lhsAttribute && rhsConstant != nullptr);
+    if (!attributeOnLeft && !(rhsAttribute && lhsConstant != nullptr)) {
+        fail();
+        return;
+    }
+    std::shared_ptr<AttributeVector> attribute = attributeOnLeft ? lhsAttribute : rhsAttribute;
+    std::unique_ptr<Value> constant;
+    if (!evaluateConstant(attributeOnLeft ? *rhsConstant : *lhsConstant, constant)) {
+        fail();
+        return;
+    }
+    bool integerAttribute = isIntegerType(attribute->getBasicType());
+    if (constant->getType() == Value::Integer) {
+        int64_t value = static_cast<const IntegerValue &>(*constant).getValue();
+        _evaluator = (integerAttribute
+                      ? makeComparison<AttributeVector::largeint_t>(std::move(attribute), value, op, attributeOnLeft)
+                      : makeComparison<double>(std::move(attribute), value, op, attributeOnLeft));
+    } else {
+        double value = static_cast<const FloatValue &>(*constant).getValue();
+        _evaluator = (integerAttribute
+                      ? makeComparison<AttributeVector::largeint_t>(std::move(attribute), value, op, attributeOnLeft)
+                      : makeComparison<double>(std::move(attribute), value, op, attributeOnLeft));
+    }
+}
+
+}
+
+CompiledSelect::CompiledSelect(Evaluator evaluator)
+    : _evaluator(std::move(evaluator))
+{
+}
+
+CompiledSelect::~CompiledSelect() = default;
+
+std::unique_ptr<CompiledSelect>
+CompiledSelect::compile(const document::select::Node &node)
+{
+    Compiler compiler;
+    node.visit(compiler);
+    if (compiler.failed()) {
+        return std::unique_ptr<CompiledSelect>();
+    }
+    return std::make_unique<CompiledSelect>(compiler.stealEvaluator());
+}
+
+}
@@ -0,0 +1,48 @@
+// Copyright 2019 Oath Inc. Licensed under the terms of the Apache 2.0 license. See LICENSE in the project root.
+#pragma once
+
+#include <vespa/document/select/result.h>
+#include <functional>
+#include <memory>
+
+namespace document::select { class Node; }
+
+namespace proton {
+
+/**
+ * Selection expression that only references single value numeric attributes,
+ * compiled to a tree of closures operating directly on local document ids.
+ *
+ * Evaluating the expression tree for each document allocates a Value object
+ * per value node and dispatches comparisons through them. A compiled
+ * selection instead compares raw attribute values with constants that are
+ * computed once at compile time, and short-circuits AND and OR as soon as
+ * the outcome is known. Results are identical to those of the expression
+ * tree it was compiled from.
+ *
+ * Since constant sub-expressions are folded when compiling, now() is
+ * evaluated once at compile time rather than once per document.
+ */
+class CompiledSelect
+{
+public:
+    using Result = document::select::Result;
+    using Evaluator = std::function<const Result &(uint32_t docId)>;
+
+    explicit CompiledSelect(Evaluator evaluator);
+    ~CompiledSelect();
+
+    /**
+     * Returns nullptr if the expression contains anything besides boolean
+     * branches, constants and comparisons between a single value numeric
+     * attribute and a constant numeric expression.
+     */
+    static std::unique_ptr<CompiledSelect> compile(const document::select::Node &node);
+
+    const Result &contains(uint32_t docId) const { return _evaluator(docId); }
+
+private:
+    Evaluator _evaluator;
+};
+
+}
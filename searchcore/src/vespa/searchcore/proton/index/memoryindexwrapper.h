@@ -29,6 +29,7 @@ public:
                        const search::TuneFileIndexing &tuneFileIndexing,
                        searchcorespi::index::IThreadingService &
                        threadingService,
+                       uint32_t numPushShards,
                        SerialNum serialNum);
 
     /**
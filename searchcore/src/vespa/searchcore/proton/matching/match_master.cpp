@@ -86,7 +86,7 @@ MatchMaster::match(search::engine::Trace & trace,
     }
     resultProcessor.prepareThreadContextCreation(threadBundle.size());
     threadBundle.run(targets);
-    ResultProcessor::Result::UP reply = resultProcessor.makeReply(threadState[0]->extract_result());
+    ResultProcessor::Result::UP reply = resultProcessor.makeReply(threadState[0]->extract_result(), threadBundle);
     query_latency_time.stop();
     double query_time_s = query_latency_time.elapsed().sec();
     double rerank_time_s = timedCommunicator.rerank_time.elapsed().sec();
@@ -30,6 +30,7 @@ using search::attribute::IAttributeContext;
 using search::fef::MatchDataLayout;
 using search::fef::MatchData;
 using search::fef::indexproperties::hitcollector::HeapSize;
+using search::fef::indexproperties::grouping::MaxGroupsInMemory;
 using search::queryeval::Blueprint;
 using search::queryeval::SearchIterator;
 using vespalib::Doom;
@@ -230,6 +231,8 @@ Matcher::match(const SearchRequest &request, vespalib::ThreadBundle &threadBundl
       // collateral time
         GroupingContext groupingContext(_clock, request.getTimeOfDoom(),
                                         &request.groupSpec[0], request.groupSpec.size());
+        groupingContext.setMaxGroupsInMemory(MaxGroupsInMemory::lookup(request.propertiesMap.rankProperties(),
+                                                                       _rankSetup->getMaxGroupsInMemory()));
         SessionId sessionId(&request.sessionId[0], request.sessionId.size());
         bool shouldCacheSearchSession = false;
         bool shouldCacheGroupingSession = false;
@@ -105,7 +105,7 @@ ResultProcessor::createThreadContext(const vespalib::Doom & hardDoom, size_t thr
 }
 
 ResultProcessor::Result::UP
-ResultProcessor::makeReply(PartialResultUP full_result)
+ResultProcessor::makeReply(PartialResultUP full_result, vespalib::ThreadBundle &threadBundle)
 {
     auto reply = std::make_unique<search::engine::SearchReply>();
     const search::IDocumentMetaStore &metaStore = _metaStore;
@@ -114,7 +114,7 @@ ResultProcessor::makeReply(PartialResultUP full_result)
     size_t numFs4Hits(0);
     if (_groupingSession) {
         if (_wasMerged) {
-            _groupingSession->getGroupingManager().prune();
+            _groupingSession->getGroupingManager().prune(threadBundle);
         }
         _groupingSession->getGroupingManager().convertToGlobalId(metaStore);
         _groupingSession->continueExecution(_groupingContext);
@@ -5,6 +5,8 @@
 #include <vespa/searchlib/common/sortresults.h>
 #include <vespa/vespalib/util/dual_merge_director.h>
 
+namespace vespalib { struct ThreadBundle; }
+
 namespace search {
     namespace engine {
         class SearchReply;
@@ -105,7 +107,7 @@ public:
     size_t countFS4Hits();
     void prepareThreadContextCreation(size_t num_threads);
     Context::UP createThreadContext(const vespalib::Doom & hardDoom, size_t thread_id, uint32_t distributionKey);
-    std::unique_ptr<Result> makeReply(PartialResultUP full_result);
+    std::unique_ptr<Result> makeReply(PartialResultUP full_result, vespalib::ThreadBundle &threadBundle);
 };
 
 }
@@ -0,0 +1,32 @@
+// Copyright 2019 Oath Inc. Licensed under the terms of the Apache 2.0 license. See LICENSE in the project root.
+
+#include "compile_cache_metrics.h"
+#include <vespa/eval/eval/llvm/disk_object_cache.h>
+
+namespace proton {
+
+CompileCacheMetrics::CompileCacheMetrics(metrics::MetricSet *parent)
+    : MetricSet("compile_cache", {}, "Metrics for the on-disk cache of compiled ranking expressions", parent),
+      loaded("loaded", {}, "The number of compiled functions loaded from the cache", this),
+      compiled("compiled", {}, "The number of cacheable functions that had to be compiled", this),
+      stored("stored", {}, "The number of compiled functions stored in the cache", this),
+      failed("failed", {}, "The number of compiled functions that could not be stored in the cache", this),
+      loadTime("load_time", {}, "Total time (in seconds) spent loading compiled functions from the cache", this),
+      compileTime("compile_time", {}, "Total time (in seconds) spent compiling cacheable functions", this)
+{
+}
+
+CompileCacheMetrics::~CompileCacheMetrics() = default;
+
+void
+CompileCacheMetrics::update(const vespalib::eval::DiskObjectCacheStats &stats)
+{
+    loaded.set(stats.num_loaded);
+    compiled.set(stats.num_compiled);
+    stored.set(stats.num_stored);
+    failed.set(stats.num_failed);
+    loadTime.set(stats.load_time_s);
+    compileTime.set(stats.compile_time_s);
+}
+
+} // namespace proton
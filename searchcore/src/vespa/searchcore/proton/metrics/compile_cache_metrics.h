@@ -0,0 +1,29 @@
+// Copyright 2019 Oath Inc. Licensed under the terms of the Apache 2.0 license. See LICENSE in the project root.
+
+#pragma once
+
+#include <vespa/metrics/metrics.h>
+
+namespace vespalib::eval { struct DiskObjectCacheStats; }
+
+namespace proton {
+
+/**
+ * Metrics for the on-disk cache of machine code generated when
+ * compiling ranking expressions.
+ */
+struct CompileCacheMetrics : metrics::MetricSet
+{
+    metrics::LongValueMetric loaded;
+    metrics::LongValueMetric compiled;
+    metrics::LongValueMetric stored;
+    metrics::LongValueMetric failed;
+    metrics::DoubleValueMetric loadTime;
+    metrics::DoubleValueMetric compileTime;
+
+    CompileCacheMetrics(metrics::MetricSet *parent);
+    ~CompileCacheMetrics();
+    void update(const vespalib::eval::DiskObjectCacheStats &stats);
+};
+
+} // namespace proton
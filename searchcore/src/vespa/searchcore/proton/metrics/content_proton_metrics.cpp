@@ -21,7 +21,9 @@ ContentProtonMetrics::ContentProtonMetrics()
     : metrics::MetricSet("content.proton", {}, "Search engine metrics", nullptr),
       transactionLog(this),
       resourceUsage(this),
-      executor(this)
+      executor(this),
+      compileCache(this),
+      rpcConnections("rpc_connections", "Connection metrics for the RPC port", this)
 {
 }
 
@@ -2,10 +2,12 @@
 
 #pragma once
 
+#include "compile_cache_metrics.h"
 #include "executor_metrics.h"
 #include "resource_usage_metrics.h"
 #include "trans_log_server_metrics.h"
 #include <vespa/metrics/metrics.h>
+#include <vespa/searchlib/engine/transport_metrics.h>
 
 namespace proton {
 
@@ -35,6 +37,8 @@ struct ContentProtonMetrics : metrics::MetricSet
     TransLogServerMetrics transactionLog;
     ResourceUsageMetrics resourceUsage;
     ProtonExecutorMetrics executor;
+    CompileCacheMetrics compileCache;
+    search::engine::TransportMetrics::ConnectionMetrics rpcConnections;
 
     ContentProtonMetrics();
     ~ContentProtonMetrics();
@@ -319,112 +319,190 @@ PersistenceEngine::getBucketInfo(const Bucket& b) const
 }
 
 
-Result
-PersistenceEngine::put(const Bucket& b, Timestamp t, const document::Document::SP& doc, Context&)
+std::unique_ptr<Result>
+PersistenceEngine::startPut(const Bucket& b, Timestamp t, const document::Document::SP& doc, TransportLatch& latch)
 {
     if (!_writeFilter.acceptWriteOperation()) {
         IResourceWriteFilter::State state = _writeFilter.getAcceptState();
         if (!state.acceptWriteOperation()) {
-            return Result(Result::RESOURCE_EXHAUSTED,
-                          make_string("Put operation rejected for document '%s': '%s'",
-                                      doc->getId().toString().c_str(), state.message().c_str()));
+            return make_unique<Result>(Result::RESOURCE_EXHAUSTED,
+                                       make_string("Put operation rejected for document '%s': '%s'",
+                                                   doc->getId().toString().c_str(), state.message().c_str()));
         }
     }
-    std::shared_lock<std::shared_timed_mutex> rguard(_rwMutex);
     DocTypeName docType(doc->getType());
     LOG(spam, "put(%s, %" PRIu64 ", (\"%s\", \"%s\"))", b.toString().c_str(), static_cast<uint64_t>(t.getValue()),
         docType.toString().c_str(), doc->getId().toString().c_str());
     if (!doc->getId().hasDocType()) {
-        return Result(Result::PERMANENT_ERROR,
-                      make_string("Old id scheme not supported in elastic mode (%s)", doc->getId().toString().c_str()));
+        return make_unique<Result>(Result::PERMANENT_ERROR,
+                                   make_string("Old id scheme not supported in elastic mode (%s)", doc->getId().toString().c_str()));
     }
     IPersistenceHandler::SP handler = getHandler(b.getBucketSpace(), docType);
     if (!handler) {
-        return Result(Result::PERMANENT_ERROR,
-                      make_string("No handler for document type '%s'", docType.toString().c_str()));
+        return make_unique<Result>(Result::PERMANENT_ERROR,
+                                   make_string("No handler for document type '%s'", docType.toString().c_str()));
     }
-    TransportLatch latch(1);
     handler->handlePut(feedtoken::make(latch), b, t, doc);
-    latch.await();
-    return latch.getResult();
+    return std::unique_ptr<Result>();
 }
 
-PersistenceEngine::RemoveResult
-PersistenceEngine::remove(const Bucket& b, Timestamp t, const DocumentId& did, Context&)
+std::unique_ptr<PersistenceEngine::RemoveResult>
+PersistenceEngine::startRemove(const Bucket& b, Timestamp t, const DocumentId& did, TransportLatch& latch)
 {
-    std::shared_lock<std::shared_timed_mutex> rguard(_rwMutex);
     LOG(spam, "remove(%s, %" PRIu64 ", \"%s\")", b.toString().c_str(),
         static_cast<uint64_t>(t.getValue()), did.toString().c_str());
     if (!did.hasDocType()) {
-        return RemoveResult(Result::PERMANENT_ERROR,
-                            make_string("Old id scheme not supported in elastic mode (%s)", did.toString().c_str()));
+        return make_unique<RemoveResult>(Result::PERMANENT_ERROR,
+                                         make_string("Old id scheme not supported in elastic mode (%s)", did.toString().c_str()));
     }
     DocTypeName docType(did.getDocType());
     IPersistenceHandler::SP handler = getHandler(b.getBucketSpace(), docType);
     if (!handler) {
-        return RemoveResult(Result::PERMANENT_ERROR,
-                            make_string("No handler for document type '%s'", docType.toString().c_str()));
+        return make_unique<RemoveResult>(Result::PERMANENT_ERROR,
+                                         make_string("No handler for document type '%s'", docType.toString().c_str()));
     }
-    TransportLatch latch(1);
     handler->handleRemove(feedtoken::make(latch), b, t, did);
-    latch.await();
-    return latch.getRemoveResult();
+    return std::unique_ptr<RemoveResult>();
 }
 
-
-PersistenceEngine::UpdateResult
-PersistenceEngine::update(const Bucket& b, Timestamp t, const DocumentUpdate::SP& upd, Context&)
+std::unique_ptr<PersistenceEngine::UpdateResult>
+PersistenceEngine::startUpdate(const Bucket& b, Timestamp t, const DocumentUpdate::SP& upd, TransportLatch& latch)
 {
     if (!_writeFilter.acceptWriteOperation()) {
         IResourceWriteFilter::State state = _writeFilter.getAcceptState();
         if (!state.acceptWriteOperation()) {
-            return UpdateResult(Result::RESOURCE_EXHAUSTED,
-                                make_string("Update operation rejected for document '%s': '%s'",
-                                            upd->getId().toString().c_str(), state.message().c_str()));
+            return make_unique<UpdateResult>(Result::RESOURCE_EXHAUSTED,
+                                             make_string("Update operation rejected for document '%s': '%s'",
+                                                         upd->getId().toString().c_str(), state.message().c_str()));
         }
     }
     try {
         upd->eagerDeserialize();
     } catch (document::FieldNotFoundException & e) {
-        return UpdateResult(Result::TRANSIENT_ERROR,
-                            make_string("Update operation rejected for document '%s' of type '%s': 'Field not found'",
-                                        upd->getId().toString().c_str(), upd->getType().getName().c_str()));
+        return make_unique<UpdateResult>(Result::TRANSIENT_ERROR,
+                                         make_string("Update operation rejected for document '%s' of type '%s': 'Field not found'",
+                                                     upd->getId().toString().c_str(), upd->getType().getName().c_str()));
     } catch (document::DocumentTypeNotFoundException & e) {
-        return UpdateResult(Result::TRANSIENT_ERROR,
-                            make_string("Update operation rejected for document '%s' of type '%s'.",
-                                        upd->getId().toString().c_str(), e.getDocumentTypeName().c_str()));
+        return make_unique<UpdateResult>(Result::TRANSIENT_ERROR,
+                                         make_string("Update operation rejected for document '%s' of type '%s'.",
+                                                     upd->getId().toString().c_str(), e.getDocumentTypeName().c_str()));
 
     } catch (document::WrongTensorTypeException &e) {
-        return UpdateResult(Result::TRANSIENT_ERROR,
-                            make_string("Update operation rejected for document '%s' of type '%s': 'Wrong tensor type: %s'",
-                                        upd->getId().toString().c_str(),
-                                        upd->getType().getName().c_str(),
-                                        e.getMessage().c_str()));
+        return make_unique<UpdateResult>(Result::TRANSIENT_ERROR,
+                                         make_string("Update operation rejected for document '%s' of type '%s': 'Wrong tensor type: %s'",
+                                                     upd->getId().toString().c_str(),
+                                                     upd->getType().getName().c_str(),
+                                                     e.getMessage().c_str()));
     }
-    std::shared_lock<std::shared_timed_mutex> rguard(_rwMutex);
     DocTypeName docType(upd->getType());
     LOG(spam, "update(%s, %" PRIu64 ", (\"%s\", \"%s\"), createIfNonExistent='%s')",
         b.toString().c_str(), static_cast<uint64_t>(t.getValue()), docType.toString().c_str(),
         upd->getId().toString().c_str(), (upd->getCreateIfNonExistent() ? "true" : "false"));
     if (!upd->getId().hasDocType()) {
-        return UpdateResult(Result::PERMANENT_ERROR,
-                            make_string("Old id scheme not supported in elastic mode (%s)", upd->getId().toString().c_str()));
+        return make_unique<UpdateResult>(Result::PERMANENT_ERROR,
+                                         make_string("Old id scheme not supported in elastic mode (%s)", upd->getId().toString().c_str()));
     }
     if (upd->getId().getDocType() != docType.getName()) {
-        return UpdateResult(Result::PERMANENT_ERROR,
-                            make_string("Update operation rejected due to bad id (%s, %s)", upd->getId().toString().c_str(), docType.getName().c_str()));
+        return make_unique<UpdateResult>(Result::PERMANENT_ERROR,
+                                         make_string("Update operation rejected due to bad id (%s, %s)", upd->getId().toString().c_str(), docType.getName().c_str()));
     }
     IPersistenceHandler::SP handler = getHandler(b.getBucketSpace(), docType);
+    if (!handler) {
+        return make_unique<UpdateResult>(Result::PERMANENT_ERROR,
+                                         make_string("No handler for document type '%s'", docType.toString().c_str()));
+    }
+    LOG(debug, "update = %s", upd->toXml().c_str());
+    handler->handleUpdate(feedtoken::make(latch), b, t, upd);
+    return std::unique_ptr<UpdateResult>();
+}
+
+Result
+PersistenceEngine::put(const Bucket& b, Timestamp t, const document::Document::SP& doc, Context&)
+{
+    std::shared_lock<std::shared_timed_mutex> rguard(_rwMutex);
+    TransportLatch latch(1);
+    std::unique_ptr<Result> rejected = startPut(b, t, doc, latch);
+    if (rejected) {
+        return *rejected;
+    }
+    latch.await();
+    return latch.getResult();
+}
+
+PersistenceEngine::RemoveResult
+PersistenceEngine::remove(const Bucket& b, Timestamp t, const DocumentId& did, Context&)
+{
+    std::shared_lock<std::shared_timed_mutex> rguard(_rwMutex);
+    TransportLatch latch(1);
+    std::unique_ptr<RemoveResult> rejected = startRemove(b, t, did, latch);
+    if (rejected) {
+        return *rejected;
+    }
+    latch.await();
+    return latch.getRemoveResult();
+}
+
+
+PersistenceEngine::UpdateResult
+PersistenceEngine::update(const Bucket& b, Timestamp t, const DocumentUpdate::SP& upd, Context&)
+{
+    std::shared_lock<std::shared_timed_mutex> rguard(_rwMutex);
+    TransportLatch latch(1);
+    std::unique_ptr<UpdateResult> rejected = startUpdate(b, t, upd, latch);
+    if (rejected) {
+        return *rejected;
+    }
+    latch.await();
+    return latch.getUpdateResult();
+}
 
-    if (handler) {
-        TransportLatch latch(1);
-        LOG(debug, "update = %s", upd->toXml().c_str());
-        handler->handleUpdate(feedtoken::make(latch), b, t, upd);
+
+PersistenceEngine::BatchResult
+PersistenceEngine::executeBatch(const Bucket& b, const BatchOperationList& operations, Context&)
+{
+    // All operations are handed over to the persistence handlers before
+    // waiting for any of them, so that their write threads can amortize
+    // commits and transaction log writes across the batch.
+    std::shared_lock<std::shared_timed_mutex> rguard(_rwMutex);
+    std::vector<std::unique_ptr<TransportLatch>> latches;
+    BatchResult::ResultList results(operations.size());
+    latches.reserve(operations.size());
+    for (size_t i = 0; i < operations.size(); ++i) {
+        const BatchOperation& op = operations[i];
+        latches.push_back(make_unique<TransportLatch>(1));
+        switch (op.getType()) {
+        case BatchOperation::Type::PUT:
+            results[i] = startPut(b, op.getTimestamp(), op.getDocument(), *latches[i]);
+            break;
+        case BatchOperation::Type::REMOVE:
+        case BatchOperation::Type::REMOVE_IF_FOUND:
+            results[i] = startRemove(b, op.getTimestamp(), op.getDocumentId(), *latches[i]);
+            break;
+        case BatchOperation::Type::UPDATE:
+            results[i] = startUpdate(b, op.getTimestamp(), op.getUpdate(), *latches[i]);
+            break;
+        }
+    }
+    for (size_t i = 0; i < operations.size(); ++i) {
+        if (results[i]) {
+            continue; // Rejected before reaching a handler.
+        }
+        TransportLatch& latch = *latches[i];
         latch.await();
-        return latch.getUpdateResult();
-    } else {
-        return UpdateResult(Result::PERMANENT_ERROR, make_string("No handler for document type '%s'", docType.toString().c_str()));
+        switch (operations[i].getType()) {
+        case BatchOperation::Type::PUT:
+            results[i] = make_unique<Result>(latch.getResult());
+            break;
+        case BatchOperation::Type::REMOVE:
+        case BatchOperation::Type::REMOVE_IF_FOUND:
+            results[i] = make_unique<RemoveResult>(latch.getRemoveResult());
+            break;
+        case BatchOperation::Type::UPDATE:
+            results[i] = make_unique<UpdateResult>(latch.getUpdateResult());
+            break;
+        }
     }
+    return BatchResult(std::move(results));
 }
 
 
@@ -15,12 +15,16 @@
 namespace proton {
 
 class IPersistenceEngineOwner;
+class TransportLatch;
 
 class PersistenceEngine : public storage::spi::AbstractPersistenceProvider {
 private:
     using PersistenceHandlerSequence = vespalib::Sequence<IPersistenceHandler *>;
     using HandlerSnapshot = PersistenceHandlerMap::HandlerSnapshot;
     using DocumentUpdate = document::DocumentUpdate;
+    using BatchOperation = storage::spi::BatchOperation;
+    using BatchOperationList = storage::spi::BatchOperationList;
+    using BatchResult = storage::spi::BatchResult;
     using Bucket = storage::spi::Bucket;
     using BucketIdListResult = storage::spi::BucketIdListResult;
     using BucketInfo = storage::spi::BucketInfo;
@@ -79,6 +83,17 @@ private:
     HandlerSnapshot::UP getHandlerSnapshot() const;
     HandlerSnapshot::UP getHandlerSnapshot(document::BucketSpace bucketSpace) const;
 
+    // The below hand the operation over to its persistence handler, which
+    // later delivers the result to the latch. If the operation is rejected
+    // up front, the error result is returned instead. Requires _rwMutex to be
+    // held for reading.
+    std::unique_ptr<Result> startPut(const Bucket&, Timestamp, const std::shared_ptr<document::Document>&,
+                                     TransportLatch&);
+    std::unique_ptr<RemoveResult> startRemove(const Bucket&, Timestamp, const document::DocumentId&,
+                                              TransportLatch&);
+    std::unique_ptr<UpdateResult> startUpdate(const Bucket&, Timestamp,
+                                              const std::shared_ptr<document::DocumentUpdate>&, TransportLatch&);
+
     void saveClusterState(BucketSpace bucketSpace, const ClusterState &calc);
     ClusterState::SP savedClusterState(BucketSpace bucketSpace) const;
 
@@ -104,6 +119,7 @@ public:
     RemoveResult remove(const Bucket&, Timestamp, const document::DocumentId&, Context&) override;
     UpdateResult update(const Bucket&, Timestamp,
                         const std::shared_ptr<document::DocumentUpdate>&, Context&) override;
+    BatchResult executeBatch(const Bucket&, const BatchOperationList&, Context&) override;
     GetResult get(const Bucket&, const document::FieldSet&, const document::DocumentId&, Context&) const override;
     CreateIteratorResult createIterator(const Bucket&, const document::FieldSet&, const Selection&,
                                         IncludedVersions, Context&) override;
@@ -27,12 +27,14 @@
 #include <vespa/document/base/exceptions.h>
 #include <vespa/document/datatype/documenttype.h>
 #include <vespa/document/repo/documenttyperepo.h>
+#include <vespa/eval/eval/llvm/compile_cache.h>
 #include <vespa/vespalib/io/fileutil.h>
 #include <vespa/vespalib/util/closuretask.h>
 #include <vespa/vespalib/util/lambdatask.h>
 #include <vespa/vespalib/util/host_name.h>
 #include <vespa/vespalib/util/random.h>
 #include <vespa/searchlib/engine/transportserver.h>
+#include <vespa/searchlib/engine/transport_server_explorer.h>
 #include <vespa/vespalib/net/state_server.h>
 
 #include <vespa/searchlib/aggregation/forcelink.hpp>
@@ -91,6 +93,14 @@ setFS4Compression(const ProtonConfig & proton)
     fs4.SetCompressionType(convert(proton.packetcompresstype));
 }
 
+void
+setupCompileCache(const ProtonConfig & proton)
+{
+    if (proton.compilecache.enabled) {
+        vespalib::eval::CompileCache::attach_disk_cache(proton.basedir + "/compilecache");
+    }
+}
+
 DiskMemUsageSampler::Config
 diskMemUsageSamplerConfig(const ProtonConfig &proton, const HwInfo &hwInfo)
 {
@@ -256,6 +266,7 @@ Proton::init(const BootstrapConfig::SP & configSnapshot)
 
     setBucketCheckSumType(protonConfig);
     setFS4Compression(protonConfig);
+    setupCompileCache(protonConfig);
     _diskMemUsageSampler = std::make_unique<DiskMemUsageSampler>(protonConfig.basedir,
                                                                  diskMemUsageSamplerConfig(protonConfig, hwInfo));
 
@@ -292,6 +303,8 @@ Proton::init(const BootstrapConfig::SP & configSnapshot)
                                                  strategy, flush.maxconcurrent, flush.idleinterval*1000);
     _fs4Server = std::make_unique<TransportServer>(*_matchEngine, *_summaryEngine, *this, protonConfig.ptport, TransportServer::DEBUG_ALL);
     _fs4Server->setTCPNoDelay(true);
+    _fs4Server->setSlowConsumerLimit(protonConfig.transport.slowconsumerlimit);
+    _fs4Server->setShedSlowConsumers(protonConfig.transport.shedslowconsumers);
     _metricsEngine->addExternalMetrics(_fs4Server->getMetrics());
     _metricsEngine->addExternalMetrics(_summaryEngine->getMetrics());
 
@@ -743,6 +756,7 @@ Proton::updateMetrics(const vespalib::MonitorGuard &)
         metrics.resourceUsage.memoryMappings.set(usageFilter.getMemoryStats().getMappingsCount());
         metrics.resourceUsage.openFileDescriptors.set(countOpenFiles());
         metrics.resourceUsage.feedingBlocked.set((usageFilter.acceptWriteOperation() ? 0.0 : 1.0));
+        metrics.compileCache.update(vespalib::eval::CompileCache::disk_cache_stats());
     }
     {
         ContentProtonMetrics::ProtonExecutorMetrics &metrics = _metricsEngine->root().executor;
@@ -763,6 +777,12 @@ Proton::updateMetrics(const vespalib::MonitorGuard &)
             metrics.warmup.update(_warmupExecutor->getStats());
         }
     }
+    if (_fs4Server) {
+        _fs4Server->updateMetrics();
+    }
+    if (_rpcHooks) {
+        _metricsEngine->root().rpcConnections.update(_rpcHooks->get_transport_stats());
+    }
 }
 
 void
@@ -846,6 +866,7 @@ const vespalib::string DOCUMENT_DB = "documentdb";
 const vespalib::string FLUSH_ENGINE = "flushengine";
 const vespalib::string TLS_NAME = "tls";
 const vespalib::string RESOURCE_USAGE = "resourceusage";
+const vespalib::string TRANSPORT = "transport";
 
 struct StateExplorerProxy : vespalib::StateExplorer {
     const StateExplorer &explorer;
@@ -891,7 +912,7 @@ Proton::get_state(const vespalib::slime::Inserter &, bool) const
 std::vector<vespalib::string>
 Proton::get_children_names() const
 {
-    std::vector<vespalib::string> names({DOCUMENT_DB, MATCH_ENGINE, FLUSH_ENGINE, TLS_NAME, RESOURCE_USAGE});
+    std::vector<vespalib::string> names({DOCUMENT_DB, MATCH_ENGINE, FLUSH_ENGINE, TLS_NAME, RESOURCE_USAGE, TRANSPORT});
     return names;
 }
 
@@ -909,6 +930,8 @@ Proton::get_child(vespalib::stringref name) const
         return std::make_unique<search::transactionlog::TransLogServerExplorer>(_tls->getTransLogServer());
     } else if (name == RESOURCE_USAGE && _diskMemUsageSampler) {
         return std::make_unique<ResourceUsageExplorer>(_diskMemUsageSampler->writeFilter());
+    } else if (name == TRANSPORT && _fs4Server) {
+        return std::make_unique<search::engine::TransportServerExplorer>(*_fs4Server);
     }
     return Explorer_UP(nullptr);
 }
@@ -6,6 +6,7 @@
 #include <vespa/searchcore/proton/matchengine/matchengine.h>
 #include <vespa/vespalib/util/closuretask.h>
 #include <vespa/fnet/frt/supervisor.h>
+#include <vespa/fnet/transport.h>
 
 #include <vespa/log/log.h>
 LOG_SETUP(".proton.server.rtchooks");
@@ -231,6 +232,12 @@ RPCHooksBase::close()
     _executor.sync();
 }
 
+FNET_TransportStats
+RPCHooksBase::get_transport_stats()
+{
+    return _orb->GetTransport()->get_stats(false);
+}
+
 void
 RPCHooksBase::letProtonDo(Closure::UP closure)
 {
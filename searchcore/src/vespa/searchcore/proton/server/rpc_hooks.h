@@ -9,6 +9,7 @@
 #include <vespa/vespalib/util/threadstackexecutor.h>
 #include <vespa/searchlib/common/packets.h>
 #include <vespa/searchlib/engine/proto_rpc_adapter.h>
+#include <vespa/fnet/transport_stats.h>
 #include <mutex>
 #include <condition_variable>
 
@@ -99,6 +100,12 @@ public:
     virtual ~RPCHooksBase();
     void close();
 
+    /**
+     * Statistics for the connections to the RPC port, without the
+     * individual connections.
+     **/
+    FNET_TransportStats get_transport_stats();
+
     void rpc_GetState(FRT_RPCRequest *req);
     void rpc_GetProtonStatus(FRT_RPCRequest *req);
     void rpc_getIncrementalState(FRT_RPCRequest *req);
@@ -6,9 +6,11 @@
 #include <vespa/searchlib/engine/searchapi.h>
 #include <vespa/searchlib/engine/docsumapi.h>
 #include <vespa/searchlib/engine/monitorapi.h>
+#include <vespa/searchlib/common/packets.h>
 #include <vespa/fnet/frt/frt.h>
 #include <vespa/vespalib/data/slime/slime.h>
 #include <vespa/vespalib/data/slime/binary_format.h>
+#include <vespa/vespalib/util/stringfmt.h>
 
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Winline"
@@ -125,6 +127,86 @@ TEST_F(ProtoRpcAdapterTest, require_that_proto_rpc_getDocsums_works) {
     target->SubRef();
 }
 
+TEST_F(ProtoRpcAdapterTest, require_that_framed_proto_rpc_search_works) {
+    auto target = connect();
+    auto *rpc = new FRT_RPCRequest();
+    ProtoSearchRequest req;
+    req.set_offset(42);
+    ProtoRpcAdapter::encode_search_request(req, *rpc, true);
+    EXPECT_EQ((*rpc->GetParams())[0]._intval8, ProtoRpcAdapter::FRAMED_LZ4);
+    target->InvokeSync(rpc, 60.0);
+    ProtoSearchReply reply;
+    EXPECT_TRUE(ProtoRpcAdapter::decode_search_reply(*rpc, reply));
+    // too small to gain anything from compression
+    EXPECT_NE((*rpc->GetReturn())[0]._intval8, ProtoRpcAdapter::FRAMED_LZ4);
+    EXPECT_EQ(reply.total_hit_count(), 42);
+    rpc->SubRef();
+    target->SubRef();
+}
+
+TEST_F(ProtoRpcAdapterTest, require_that_large_framed_proto_rpc_getDocsums_works) {
+    vespalib::string ranking;
+    for (size_t i = 0; ranking.size() < 1000000; ++i) {
+        ranking.append(vespalib::make_string("profile-%zu,", i));
+    }
+    auto target = connect();
+    auto *rpc = new FRT_RPCRequest();
+    ProtoDocsumRequest req;
+    req.set_rank_profile(ranking);
+    ProtoRpcAdapter::encode_docsum_request(req, *rpc, true);
+    target->InvokeSync(rpc, 60.0);
+    ProtoDocsumReply reply;
+    EXPECT_TRUE(ProtoRpcAdapter::decode_docsum_reply(*rpc, reply));
+    EXPECT_EQ((*rpc->GetReturn())[0]._intval8, ProtoRpcAdapter::FRAMED_LZ4);
+    EXPECT_LT((*rpc->GetReturn())[2]._data._len, ranking.size());
+    const auto &mem = reply.slime_summaries();
+    Slime slime;
+    EXPECT_EQ(BinaryFormat::decode(Memory(mem.data(), mem.size()), slime), mem.size());
+    EXPECT_EQ(slime.get()[1]["ranking"].asString().make_string(), ranking);
+    rpc->SubRef();
+    target->SubRef();
+}
+
+TEST_F(ProtoRpcAdapterTest, require_that_framed_replies_follow_the_compression_config) {
+    using search::fs4transport::FS4PersistentPacketStreamer;
+    vespalib::string ranking;
+    for (size_t i = 0; ranking.size() < 100000; ++i) {
+        ranking.append(vespalib::make_string("profile-%zu,", i));
+    }
+    auto &streamer = FS4PersistentPacketStreamer::Instance;
+    auto type = streamer.getCompressionType();
+    streamer.SetCompressionType(vespalib::compression::CompressionConfig::NONE);
+    auto target = connect();
+    auto *rpc = new FRT_RPCRequest();
+    ProtoDocsumRequest req;
+    req.set_rank_profile(ranking);
+    ProtoRpcAdapter::encode_docsum_request(req, *rpc, true);
+    target->InvokeSync(rpc, 60.0);
+    streamer.SetCompressionType(type);
+    ProtoDocsumReply reply;
+    EXPECT_TRUE(ProtoRpcAdapter::decode_docsum_reply(*rpc, reply));
+    EXPECT_EQ((*rpc->GetReturn())[0]._intval8, vespalib::compression::CompressionConfig::NONE);
+    const auto &mem = reply.slime_summaries();
+    Slime slime;
+    EXPECT_EQ(BinaryFormat::decode(Memory(mem.data(), mem.size()), slime), mem.size());
+    EXPECT_EQ(slime.get()[1]["ranking"].asString().make_string(), ranking);
+    rpc->SubRef();
+    target->SubRef();
+}
+
+TEST_F(ProtoRpcAdapterTest, require_that_unframed_request_gets_unframed_reply) {
+    auto target = connect();
+    auto *rpc = new FRT_RPCRequest();
+    ProtoDocsumRequest req;
+    ProtoRpcAdapter::encode_docsum_request(req, *rpc);
+    target->InvokeSync(rpc, 60.0);
+    ProtoDocsumReply reply;
+    EXPECT_TRUE(ProtoRpcAdapter::decode_docsum_reply(*rpc, reply));
+    EXPECT_NE((*rpc->GetReturn())[0]._intval8, ProtoRpcAdapter::FRAMED_LZ4);
+    rpc->SubRef();
+    target->SubRef();
+}
+
 TEST_F(ProtoRpcAdapterTest, require_that_proto_rpc_ping_works) {
     auto target = connect();
     auto *rpc = new FRT_RPCRequest();
@@ -4,6 +4,8 @@
 #include <vespa/document/base/documentid.h>
 #include <vespa/searchlib/common/packets.h>
 #include <vespa/searchlib/engine/transportserver.h>
+#include <vespa/searchlib/engine/transport_metrics.h>
+#include <vespa/fnet/transport_stats.h>
 #include <vespa/vespalib/util/stringfmt.h>
 #include <vespa/fnet/fnet.h>
 #include <vespa/searchlib/engine/errorcodes.h>
@@ -229,4 +231,25 @@ TEST("test SearchReply::Coverage set and get") {
     EXPECT_EQUAL(7u, SearchReply::Coverage().degradeAdaptiveTimeout().degradeTimeout().degradeMatchPhase().getDegradeReason());
 }
 
+TEST("require that connection metrics count what happened since the previous update") {
+    TransportMetrics::ConnectionMetrics metrics("connections", "Client connection metrics", nullptr);
+    FNET_TransportStats stats;
+    stats.num_connections = 3;
+    stats.bytes_read = 100;
+    stats.packets_written = 10;
+    metrics.update(stats);
+    EXPECT_EQUAL(3, metrics.count.getLast());
+    EXPECT_EQUAL(100u, metrics.bytesRead.getValue());
+    EXPECT_EQUAL(10u, metrics.packetsWritten.getValue());
+
+    metrics.reset();
+    stats.num_connections = 2;
+    stats.bytes_read = 250;
+    stats.packets_written = 12;
+    metrics.update(stats);
+    EXPECT_EQUAL(2, metrics.count.getLast());
+    EXPECT_EQUAL(150u, metrics.bytesRead.getValue());
+    EXPECT_EQUAL(2u, metrics.packetsWritten.getValue());
+}
+
 TEST_MAIN() { TEST_RUN_ALL(); }
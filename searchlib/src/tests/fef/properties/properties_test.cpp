@@ -403,6 +403,14 @@ TEST("test stuff") {
             p.clear().add("vespa.hitcollector.rankscoredroplimit", "123456789.12345");
             EXPECT_EQUAL(hitcollector::RankScoreDropLimit::lookup(p), 123456789.12345);
         }
+        { // vespa.grouping.maxgroupsinmemory
+            EXPECT_EQUAL(grouping::MaxGroupsInMemory::NAME, vespalib::string("vespa.grouping.maxgroupsinmemory"));
+            EXPECT_EQUAL(grouping::MaxGroupsInMemory::DEFAULT_VALUE, 0u);
+            Properties p;
+            EXPECT_EQUAL(grouping::MaxGroupsInMemory::lookup(p), 0u);
+            p.add("vespa.grouping.maxgroupsinmemory", "10000");
+            EXPECT_EQUAL(grouping::MaxGroupsInMemory::lookup(p), 10000u);
+        }
         { // vespa.fieldweight.
             EXPECT_EQUAL(FieldWeight::BASE_NAME, vespalib::string("vespa.fieldweight."));
             EXPECT_EQUAL(FieldWeight::DEFAULT_VALUE, 100u);
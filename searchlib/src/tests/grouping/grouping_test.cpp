@@ -163,12 +163,15 @@ public:
                    const Group &expect);
     bool testPartialMerge(const Grouping &a, const Grouping &b,
                    const Group &expect);
+    bool testSpilling(AggregationContext &ctx, const Grouping &request, uint32_t maxGroupsInMemory);
+    bool testCappedSpilling(AggregationContext &ctx, const Grouping &request, uint32_t maxGroupsInMemory);
     void testAggregationSimple();
     void testAggregationLevels();
     void testAggregationMaxGroups();
     void testAggregationGroupOrder();
     void testAggregationGroupRank();
     void testAggregationGroupCapping();
+    void testAggregationSpilling();
     void testMergeSimpleSum();
     void testMergeLevels();
     void testMergeGroups();
@@ -279,6 +282,57 @@ Test::testPartialMerge(const Grouping &a, const Grouping &b,
     return ok;
 }
 
+/**
+ * Run the given grouping request with and without a limit on the
+ * number of groups kept in memory and verify that the resulting group
+ * trees are equal.
+ **/
+bool
+Test::testSpilling(AggregationContext &ctx, const Grouping &request, uint32_t maxGroupsInMemory)
+{
+    Grouping expect = request; // create local copy
+    ctx.setup(expect);
+    expect.aggregate(ctx.result().hits(), ctx.result().size());
+    Grouping spilled = request; // create local copy
+    spilled.setMaxGroupsInMemory(maxGroupsInMemory);
+    ctx.setup(spilled);
+    spilled.aggregate(ctx.result().hits(), ctx.result().size());
+    EXPECT_LESS(maxGroupsInMemory, expect.getRoot().getChildrenSize());
+    return EXPECT_EQUAL(spilled.getRoot().asString(), expect.getRoot().asString());
+}
+
+/**
+ * Run the given grouping request, which does not limit its number of
+ * top-level groups, with and without a limit on the number of groups
+ * kept in memory. Verify that spilling keeps the best groups by rank
+ * only, each with the same subtree as without the limit.
+ **/
+bool
+Test::testCappedSpilling(AggregationContext &ctx, const Grouping &request, uint32_t maxGroupsInMemory)
+{
+    Grouping expect = request; // create local copy
+    ctx.setup(expect);
+    expect.aggregate(ctx.result().hits(), ctx.result().size());
+    Grouping spilled = request; // create local copy
+    spilled.setMaxGroupsInMemory(maxGroupsInMemory);
+    ctx.setup(spilled);
+    spilled.aggregate(ctx.result().hits(), ctx.result().size());
+    EXPECT_LESS(maxGroupsInMemory, expect.getRoot().getChildrenSize());
+    std::vector<const Group *> best;
+    for (size_t i(0); i < expect.getRoot().getChildrenSize(); i++) {
+        best.push_back(&expect.getRoot().getChild(i));
+    }
+    std::sort(best.begin(), best.end(), [](const Group *a, const Group *b) { return (a->cmpRank(*b) < 0); });
+    best.resize(maxGroupsInMemory);
+    std::sort(best.begin(), best.end(), [](const Group *a, const Group *b) { return (a->cmpId(*b) < 0); });
+    bool ok = EXPECT_TRUE(spilled.valid());
+    ok = ok && EXPECT_EQUAL(best.size(), spilled.getRoot().getChildrenSize());
+    for (size_t i(0); ok && (i < best.size()); i++) {
+        ok = EXPECT_EQUAL(best[i]->asString(), spilled.getRoot().getChild(i).asString());
+    }
+    return ok;
+}
+
 /**
  * Merge the given grouping requests and verify that the resulting
  * group tree matches the expected value.
@@ -740,6 +794,50 @@ Test::testAggregationGroupCapping()
 
 }
 
+/**
+ * Verify that spilling top-level groups to disk when aggregation
+ * exceeds its group budget gives the same result as keeping all
+ * groups in memory, except that a top level without a precision
+ * keeps no more groups than the budget.
+ **/
+void
+Test::testAggregationSpilling()
+{
+    AggregationContext ctx;
+    IntAttrBuilder attr1("attr1");
+    IntAttrBuilder attr2("attr2");
+    for (uint32_t docId(0); docId < 100; ++docId) {
+        attr1.add(docId % 13);
+        attr2.add(docId % 3);
+        ctx.result().add(docId, 100 - docId);
+    }
+    ctx.add(attr1.sp());
+    ctx.add(attr2.sp());
+
+    { // ordered aggregation without a precision, capped at the budget
+        Grouping request = Grouping().addLevel(createGL(MU<AttributeNode>("attr1"), MU<AttributeNode>("attr2")));
+        EXPECT_TRUE(testCappedSpilling(ctx, request, 2));
+        EXPECT_TRUE(testCappedSpilling(ctx, request, 5));
+    }
+    { // unordered aggregation pruned by rank
+        Grouping request;
+        request.setFirstLevel(0)
+               .setLastLevel(1)
+               .addLevel(std::move(GroupingLevel().setMaxGroups(3).setExpression(MU<AttributeNode>("attr1"))
+                                 .addAggregationResult(createAggr<SumAggregationResult>(MU<AttributeNode>("attr1")))
+                                 .addOrderBy(MU<AggregationRefNode>(0), false)));
+        EXPECT_TRUE(testSpilling(ctx, request, 2));
+        EXPECT_TRUE(testSpilling(ctx, request, 5));
+    }
+    { // nested levels
+        Grouping request = Grouping().setFirstLevel(0)
+                                     .setLastLevel(2)
+                                     .addLevel(createGL(MU<AttributeNode>("attr1"), MU<AttributeNode>("attr2")))
+                                     .addLevel(createGL(MU<AttributeNode>("attr2"), MU<AttributeNode>("attr1")));
+        EXPECT_TRUE(testCappedSpilling(ctx, request, 4));
+    }
+}
+
 //-----------------------------------------------------------------------------
 
 /**
@@ -1959,6 +2057,7 @@ Test::Main()
     testAggregationGroupOrder();
     testAggregationGroupRank();
     testAggregationGroupCapping();
+    testAggregationSpilling();
     testMergeSimpleSum();
     testMergeLevels();
     testMergeGroups();
@@ -17,6 +17,7 @@
 #include <vespa/searchlib/common/sequencedtaskexecutor.h>
 #include <vespa/searchlib/test/searchiteratorverifier.h>
 #include <vespa/vespalib/testkit/testapp.h>
+#include <vespa/vespalib/util/stringfmt.h>
 
 #include <vespa/log/log.h>
 LOG_SETUP("dictionary_test");
@@ -374,7 +375,7 @@ public:
         if (_documentInserter != nullptr) {
             _documentInserter->flush();
         }
-        _documentInserter = &_d.getFieldIndex(fieldId)->getInserter();
+        _documentInserter = &_d.getFieldIndex(fieldId, 0)->getInserter();
         _documentInserter->rewind();
         _mock.setNextField(fieldId);
     }
@@ -453,7 +454,7 @@ class WrapInserter
     OrderedDocumentInserter &_inserter;
 public:
     WrapInserter(Dictionary &d, uint32_t fieldId)
-        : _inserter(d.getFieldIndex(fieldId)->getInserter())
+        : _inserter(d.getFieldIndex(fieldId, 0)->getInserter())
     {
     }
 
@@ -509,7 +510,7 @@ public:
     virtual void remove(const vespalib::stringref, uint32_t) override { }
 
     MyDrainRemoves(Dictionary &d, uint32_t fieldId)
-        : _remover(d.getFieldIndex(fieldId)->getDocumentRemover())
+        : _remover(d.getFieldIndex(fieldId, 0)->getDocumentRemover())
     {
     }
 
@@ -529,13 +530,13 @@ myPushDocument(DocumentInverter &inv, Dictionary &d)
 const FeatureStore *
 featureStorePtr(const Dictionary &d, uint32_t fieldId)
 {
-    return &d.getFieldIndex(fieldId)->getFeatureStore();
+    return &d.getFieldIndex(fieldId, 0)->getFeatureStore();
 }
 
 const FeatureStore &
 featureStoreRef(const Dictionary &d, uint32_t fieldId)
 {
-    return d.getFieldIndex(fieldId)->getFeatureStore();
+    return d.getFieldIndex(fieldId, 0)->getFeatureStore();
 }
 
 
@@ -546,7 +547,7 @@ getFeatureStoreMemStats(const Dictionary &d)
     uint32_t numFields = d.getNumFields();
     for (uint32_t fieldId = 0; fieldId < numFields; ++fieldId) {
         DataStoreBase::MemStats stats =
-            d.getFieldIndex(fieldId)->getFeatureStore().getMemStats();
+            d.getFieldIndex(fieldId, 0)->getFeatureStore().getMemStats();
         res += stats;
     }
     return res;
@@ -1439,10 +1440,93 @@ insertAndAssertTuple(const vespalib::string &word, uint32_t fieldId, uint32_t do
     EntryRef wordRef = WrapInserter(dict, fieldId).rewind().word(word).
                        add(docId).flush().getWordRef();
     EXPECT_EQUAL(word,
-                 dict.getFieldIndex(fieldId)->getWordStore().getWord(wordRef));
+                 dict.getFieldIndex(fieldId, 0)->getWordStore().getWord(wordRef));
     MyDrainRemoves(dict, fieldId).drain(docId);
 }
 
+struct ShardedDictionaryFixture : public Fixture
+{
+    Dictionary _d1;
+    Dictionary _d3;
+    DocBuilder _b;
+    SequencedTaskExecutor _invertThreads;
+    SequencedTaskExecutor _pushThreads;
+    DocumentInverter _inv1;
+    DocumentInverter _inv3;
+
+    ShardedDictionaryFixture()
+        : Fixture(),
+          _d1(getSchema()),
+          _d3(getSchema(), 3),
+          _b(getSchema()),
+          _invertThreads(2),
+          _pushThreads(4),
+          _inv1(getSchema(), _invertThreads, _pushThreads),
+          _inv3(getSchema(), _invertThreads, _pushThreads)
+    {
+    }
+
+    void invertDocument(uint32_t docId) {
+        _b.startDocument(vespalib::make_string("doc::%u", docId));
+        _b.startIndexField("f0");
+        for (uint32_t i = 0; i < 20; ++i) {
+            _b.addStr(vespalib::make_string("w%u", (docId * 7 + i) % 31));
+        }
+        _b.endField();
+        _b.startIndexField("f1").addStr("common").addStr(vespalib::make_string("d%u", docId)).endField();
+        Document::UP doc = _b.endDocument();
+        _inv1.invertDocument(docId, *doc);
+        _inv3.invertDocument(docId, *doc);
+    }
+
+    void removeDocument(uint32_t docId) {
+        _inv1.removeDocument(docId);
+        _inv3.removeDocument(docId);
+    }
+
+    void push() {
+        _invertThreads.sync();
+        myPushDocument(_inv1, _d1);
+        myPushDocument(_inv3, _d3);
+        // sharded fields schedule their push from the invert threads
+        _invertThreads.sync();
+        _pushThreads.sync();
+    }
+
+    std::string dump(Dictionary &d) {
+        MyBuilder b(getSchema());
+        d.dump(b);
+        return b.toStr();
+    }
+};
+
+TEST_F("require that sharded dictionary gives same result as unsharded dictionary", ShardedDictionaryFixture)
+{
+    EXPECT_EQUAL(3u, f._d3.getNumShards());
+    EXPECT_EQUAL(12u, f._d3.getFieldIndexes().size());
+    for (uint32_t docId = 1; docId < 20; ++docId) {
+        f.invertDocument(docId);
+    }
+    f.push();
+    for (uint32_t docId = 5; docId < 10; ++docId) {
+        f.removeDocument(docId);
+    }
+    f.invertDocument(12);
+    f.invertDocument(25);
+    f.push();
+    EXPECT_EQUAL(f._d1.getNumUniqueWords(), f._d3.getNumUniqueWords());
+    EXPECT_EQUAL(f.dump(f._d1), f.dump(f._d3));
+    for (const char *word : { "w0", "w13", "w30", "common", "d5", "d12", "d25" }) {
+        uint32_t fieldId = (word[0] == 'w') ? 0 : 1;
+        std::vector<uint32_t> exp;
+        for (auto itr = f._d1.findFrozen(word, fieldId); itr.valid(); ++itr) {
+            exp.push_back(itr.getKey());
+        }
+        TEST_STATE(word);
+        EXPECT_TRUE(assertPostingList(exp, f._d3.findFrozen(word, fieldId)));
+    }
+}
+
 TEST_F("require that insert tells which word ref that was inserted", Fixture)
 {
     Dictionary d(f.getSchema());
@@ -1480,7 +1564,7 @@ struct RemoverFixture : public Fixture
         DocumentInverter inv(getSchema(), _invertThreads, _pushThreads);
         myremove(docId, inv, _d, _invertThreads);
         _pushThreads.sync();
-        EXPECT_FALSE(_d.getFieldIndex(0u)->getDocumentRemover().
+        EXPECT_FALSE(_d.getFieldIndex(0u, 0)->getDocumentRemover().
                      getStore().get(docId).valid());
     }
 };
@@ -510,6 +510,7 @@ void RankSetupTest::testRankSetup()
     env.getProperties().add(hitcollector::EstimatePoint::NAME, "70");
     env.getProperties().add(hitcollector::EstimateLimit::NAME, "80");
     env.getProperties().add(hitcollector::RankScoreDropLimit::NAME, "90.5");
+    env.getProperties().add(grouping::MaxGroupsInMemory::NAME, "100");
 
     RankSetup rs(_factory, env);
     rs.configure();
@@ -535,6 +536,7 @@ void RankSetupTest::testRankSetup()
     EXPECT_EQUAL(rs.getEstimatePoint(), 70u);
     EXPECT_EQUAL(rs.getEstimateLimit(), 80u);
     EXPECT_EQUAL(rs.getRankScoreDropLimit(), 90.5);
+    EXPECT_EQUAL(rs.getMaxGroupsInMemory(), 100u);
 }
 
 bool
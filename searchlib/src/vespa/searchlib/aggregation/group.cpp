@@ -306,6 +306,22 @@ Group::Value::addChild(Group * child)
     setChildrenSize(sz + 1);
 }
 
+std::vector<Group::UP>
+Group::Value::releaseChildren()
+{
+    assert(_childInfo._childMap == nullptr);
+    std::vector<UP> children;
+    children.reserve(getChildrenSize());
+    for (ChildP *it(_children), *mt(_children + getChildrenSize()); it != mt; ++it) {
+        children.emplace_back(*it);
+        reset(*it);
+    }
+    destruct(_children, getAllChildrenSize());
+    setChildrenSize(0);
+    _childInfo._allChildren = 0;
+    return children;
+}
+
 void
 Group::Value::select(const vespalib::ObjectPredicate &predicate, vespalib::ObjectOperation &operation) {
     uint32_t totalSize = getAggrSize() + getExprSize();
@@ -315,10 +331,11 @@ Group::Value::select(const vespalib::ObjectPredicate &predicate, vespalib::Objec
 }
 
 void
-Group::Value::preAggregate()
+Group::Value::preAggregate(size_t expectedChildren)
 {
     assert(_childInfo._childMap == nullptr);
-    _childInfo._childMap = new GroupHash(getChildrenSize()*2, GroupHasher(&_children), GroupEqual(&_children));
+    size_t reserved = std::max(static_cast<size_t>(getChildrenSize()), expectedChildren);
+    _childInfo._childMap = new GroupHash(reserved*2, GroupHasher(&_children), GroupEqual(&_children));
     GroupHash & childMap = *_childInfo._childMap;
     for (ChildP *it(_children), *mt(_children + getChildrenSize()); it != mt; ++it) {
         (*it)->preAggregate();
@@ -349,12 +366,18 @@ Group::Value::executeOrderBy()
 void
 Group::Value::sortById()
 {
-    std::sort(_children, _children + getChildrenSize(), SortByGroupId());
+    sortChildrenById();
     for (ChildP *it(_children), *mt(_children + getChildrenSize()); it != mt; ++it) {
         (*it)->sortById();
     }
 }
 
+void
+Group::Value::sortChildrenById()
+{
+    std::sort(_children, _children + getChildrenSize(), SortByGroupId());
+}
+
 void
 Group::Value::mergeCollectors(const Value &rhs) {
     for(size_t i(0), m(getAggrSize()); i < m; i++) {
@@ -472,6 +495,17 @@ Group::Value::mergePartial(const GroupingLevelList &levels, uint32_t firstLevel,
 
 void
 Group::Value::postMerge(const std::vector<GroupingLevel> &levels, uint32_t firstLevel, uint32_t currentLevel)
+{
+    if (!postMergeLevel(levels, firstLevel, currentLevel)) {
+        return;
+    }
+    for (ChildP *it(_children), *mt(_children + getChildrenSize()); it != mt; ++it) {
+        (*it)->postMerge(levels, firstLevel, currentLevel + 1);
+    }
+}
+
+bool
+Group::Value::postMergeLevel(const std::vector<GroupingLevel> &levels, uint32_t firstLevel, uint32_t currentLevel)
 {
     bool frozen = (currentLevel < firstLevel);    // is this level frozen ?
 
@@ -482,7 +516,7 @@ Group::Value::postMerge(const std::vector<GroupingLevel> &levels, uint32_t first
     }
     bool hasNext = (currentLevel < levels.size()); // is there a next level ?
     if (!hasNext) { // we have reached the bottom of the tree
-        return;
+        return false;
     }
     for (ChildP *it(_children), *mt(_children + getChildrenSize()); it != mt; ++it) {
         (*it)->executeOrderBy();
@@ -497,9 +531,7 @@ Group::Value::postMerge(const std::vector<GroupingLevel> &levels, uint32_t first
         std::sort(_children, _children + getChildrenSize(), SortByGroupRank());
         setChildrenSize(maxGroups);
     }
-    for (ChildP *it(_children), *mt(_children + getChildrenSize()); it != mt; ++it) {
-        (*it)->postMerge(levels, firstLevel, currentLevel + 1);
-    }
+    return true;
 }
 
 bool
@@ -77,10 +77,11 @@ private:
         void setupAggregationReferences();
         void addOrderBy(ExpressionNode::UP orderBy, bool ascending);
         void select(const vespalib::ObjectPredicate &predicate, vespalib::ObjectOperation &operation);
-        void preAggregate();
+        void preAggregate(size_t expectedChildren);
         void postAggregate();
         void executeOrderBy();
         void sortById();
+        void sortChildrenById();
         void mergeCollectors(const Value & rhs);
         void execute();
         bool needResort() const;
@@ -94,11 +95,13 @@ private:
         void merge(const GroupingLevelList & levels, uint32_t firstLevel, uint32_t currentLevel, const Value & rhs);
         void prune(const Value & b, uint32_t lastLevel, uint32_t currentLevel);
         void postMerge(const std::vector<GroupingLevel> &levels, uint32_t firstLevel, uint32_t currentLevel);
+        bool postMergeLevel(const std::vector<GroupingLevel> &levels, uint32_t firstLevel, uint32_t currentLevel);
         void partialCopy(const Value & rhs);
         VESPA_DLL_LOCAL Group * groupSingle(const ResultNode & selectResult, HitRank rank, const GroupingLevel & level);
 
         GroupList groups() const { return _children; }
         void addChild(Group * child);
+        std::vector<UP> releaseChildren();
         uint32_t getAggrSize()    const { return _packedLength & 0x0f; }
         uint32_t getOrderBySize() const { return (_packedLength >> 6) & 0x03; }
         uint32_t getChildrenSize()   const { return (_packedLength >> 8); }
@@ -209,6 +212,12 @@ public:
     Group &addChild(const Group &child) { _aggr.addChild(new Group(child)); return *this; }
     Group &addChild(Group::UP child) { _aggr.addChild(child.release()); return *this; }
 
+    /**
+     * Removes all children from this group, handing them over to the
+     * caller. Must not be called while aggregating.
+     **/
+    std::vector<Group::UP> releaseChildren() { return _aggr.releaseChildren(); }
+
     GroupList groups()               const { return _aggr.groups(); }
     uint32_t getAggrSize()           const { return _aggr.getAggrSize(); }
     uint32_t getOrderBySize()        const { return _aggr.getOrderBySize(); }
@@ -238,7 +247,7 @@ public:
 
     void selectMembers(const vespalib::ObjectPredicate &predicate, vespalib::ObjectOperation &operation) override;
 
-    void preAggregate() { return _aggr.preAggregate(); }
+    void preAggregate(size_t expectedChildren = 0) { return _aggr.preAggregate(expectedChildren); }
     template <typename Doc>
     VESPA_DLL_LOCAL void aggregate(const Grouping & grouping, uint32_t currentLevel, const Doc & docId, HitRank rank);
 
@@ -248,6 +257,7 @@ public:
     void merge(const std::vector<GroupingLevel> &levels, uint32_t firstLevel, uint32_t currentLevel, Group &b);
     void executeOrderBy() { _aggr.executeOrderBy(); }
     void sortById() { _aggr.sortById(); }
+    void sortChildrenById() { _aggr.sortChildrenById(); }
 
     /**
      * Merge children and results of another tree within the unfrozen parts of
@@ -263,6 +273,14 @@ public:
     void postMerge(const std::vector<GroupingLevel> &levels, uint32_t firstLevel, uint32_t currentLevel) {
         _aggr.postMerge(levels, firstLevel, currentLevel);
     }
+
+    /**
+     * Post-merge this group and prune its children like postMerge,
+     * but without descending into the children.
+     **/
+    void postMergeLevel(const std::vector<GroupingLevel> &levels, uint32_t firstLevel, uint32_t currentLevel) {
+        _aggr.postMergeLevel(levels, firstLevel, currentLevel);
+    }
 };
 
 }
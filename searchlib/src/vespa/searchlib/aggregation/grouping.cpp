@@ -1,6 +1,7 @@
 // Copyright 2017 Yahoo Holdings. Licensed under the terms of the Apache 2.0 license. See LICENSE in the project root.
 
 #include "grouping.h"
+#include "groupspill.h"
 #include "hitsaggregationresult.h"
 #include <vespa/searchlib/expression/stringresultnode.h>
 #include <vespa/searchlib/expression/enumresultnode.h>
@@ -116,12 +117,41 @@ Grouping::Grouping()
       _levels(),
       _root(),
       _clock(NULL),
-      _timeOfDoom(0)
+      _timeOfDoom(0),
+      _maxGroupsInMemory(0),
+      _spill()
 {
 }
 
-Grouping::Grouping(const Grouping &) = default;
-Grouping & Grouping::operator = (const Grouping &) = default;
+Grouping::Grouping(const Grouping & rhs)
+    : vespalib::Identifiable(rhs),
+      _id(rhs._id),
+      _valid(rhs._valid),
+      _all(rhs._all),
+      _topN(rhs._topN),
+      _firstLevel(rhs._firstLevel),
+      _lastLevel(rhs._lastLevel),
+      _levels(rhs._levels),
+      _root(rhs._root),
+      _clock(rhs._clock),
+      _timeOfDoom(rhs._timeOfDoom),
+      _maxGroupsInMemory(rhs._maxGroupsInMemory),
+      _spill()
+{
+}
+
+Grouping &
+Grouping::operator = (const Grouping & rhs)
+{
+    if (this != &rhs) {
+        Grouping tmp(rhs);
+        *this = std::move(tmp);
+    }
+    return *this;
+}
+
+Grouping::Grouping(Grouping &&) noexcept = default;
+Grouping & Grouping::operator = (Grouping &&) noexcept = default;
 
 Grouping::~Grouping() { }
 
@@ -144,6 +174,7 @@ Grouping::prune(const Grouping & b)
 void
 Grouping::mergePartial(const Grouping & b)
 {
+    _valid = _valid && b._valid;
     _root.mergePartial(_levels, _firstLevel, _lastLevel, 0, b._root);
 }
 
@@ -151,6 +182,7 @@ Grouping::mergePartial(const Grouping & b)
 void
 Grouping::merge(Grouping & b)
 {
+    _valid = _valid && b._valid;
     _root.merge(_levels, _firstLevel, 0, b._root);
 }
 
@@ -160,17 +192,57 @@ Grouping::postMerge()
     _root.postMerge(_levels, _firstLevel, 0);
 }
 
+void
+Grouping::postMergeTopLevel()
+{
+    _root.postMergeLevel(_levels, _firstLevel, 0);
+    _root.sortChildrenById();
+}
+
+void
+Grouping::postMergeAndSortGroup(uint32_t topLevelGroup)
+{
+    Group &group = *_root.groups()[topLevelGroup];
+    group.postMerge(_levels, _firstLevel, 1);
+    group.sortById();
+}
+
 void
 Grouping::preAggregate(bool isOrdered)
 {
     for (size_t i(0), m(_levels.size()); i < m; i++) {
         _levels[i].prepare(this, i, isOrdered);
     }
-    _root.preAggregate();
+    _root.preAggregate(_spill ? _maxGroupsInMemory : 0);
+}
+
+void
+Grouping::setupSpill(bool isOrdered)
+{
+    // Spilled runs are merged by group id and pruned by rank, which only
+    // gives the in-memory result if the top level may see all its groups.
+    if ((_maxGroupsInMemory > 0) && !_levels.empty() && (_firstLevel == 0) &&
+        (!isOrdered || (_levels[0].getPrecision() < 0)))
+    {
+        _spill = std::make_unique<GroupSpill>();
+    }
+}
+
+void
+Grouping::spillGroups()
+{
+    _root.postAggregate();
+    _root.sortById();
+    if ( ! _spill->spill(_root)) {
+        LOG(warning, "Failed spilling %u groups of grouping %u to disk, keeping further groups in memory",
+            _root.getChildrenSize(), _id);
+    }
+    _root.preAggregate(_maxGroupsInMemory);
 }
 
 void Grouping::aggregate(DocId from, DocId to)
 {
+    setupSpill(false);
     preAggregate(false);
     if (to > from) {
         for(DocId i(from), m(i + getMaxN(to-from)); i < m; i++) {
@@ -183,6 +255,20 @@ void Grouping::aggregate(DocId from, DocId to)
 void Grouping::postProcess()
 {
     postAggregate();
+    if (_spill) {
+        if (_spill->getNumRuns() > 0) {
+            sortById();
+            // An unbounded top level keeps no more groups than the budget, as
+            // all of them would otherwise be loaded back into memory.
+            int64_t precision = _levels[0].getPrecision();
+            uint64_t maxGroups = (precision >= 0) ? precision : _maxGroupsInMemory;
+            if ( ! _spill->merge(_root, _levels, _firstLevel, maxGroups)) {
+                LOG(warning, "Failed reading spilled groups of grouping %u from disk, invalidating the grouping", _id);
+                invalidate();
+            }
+        }
+        _spill.reset();
+    }
     postMerge();
     bool hasEnums(false);
     for (size_t i(0), m(_levels.size()); !hasEnums && (i < m); i++) {
@@ -219,6 +305,7 @@ void Grouping::aggregateWithClock(const RankedHit * rankedHit, unsigned int len)
 void Grouping::aggregate(const RankedHit * rankedHit, unsigned int len)
 {
     bool isOrdered(! needResort());
+    setupSpill(isOrdered);
     preAggregate(isOrdered);
     HitsAggregationResult::SetOrdered pred;
     select(pred, pred);
@@ -232,6 +319,7 @@ void Grouping::aggregate(const RankedHit * rankedHit, unsigned int len)
 
 void Grouping::aggregate(const RankedHit * rankedHit, unsigned int len, const BitVector * bVec)
 {
+    setupSpill(false);
     preAggregate(false);
     if (_clock == NULL) {
         aggregateWithoutClock(rankedHit, getMaxN(len));
@@ -268,6 +356,9 @@ void Grouping::aggregate(const RankedHit * rankedHit, unsigned int len, const Bi
 void Grouping::aggregate(DocId docId, HitRank rank)
 {
     _root.aggregate(*this, 0, docId, rank);
+    if (_spill && (_root.getChildrenSize() >= _maxGroupsInMemory) && ! _spill->hasFailed()) {
+        spillGroups();
+    }
 }
 
 void Grouping::aggregate(const document::Document & doc, HitRank rank)
@@ -15,6 +15,8 @@ namespace aggregation {
 /**
  * This class represents a top-level grouping request.
  **/
+class GroupSpill;
+
 class Grouping : public vespalib::Identifiable
 {
 public:
@@ -32,8 +34,12 @@ private:
     Group                  _root;       // the grouping tree
     const vespalib::Clock *_clock;      // An optional clock to be used for timeout handling.
     fastos::TimeStamp      _timeOfDoom; // Used if clock is specified. This is time when request expires.
+    uint32_t               _maxGroupsInMemory; // Spill top-level groups to disk above this limit, 0 means never.
+    std::unique_ptr<GroupSpill> _spill; // Spilled groups, only present while aggregating.
 
     bool hasExpired() const { return _clock->getTimeNS() >= _timeOfDoom; }
+    void setupSpill(bool isOrdered);
+    void spillGroups();
     void aggregateWithoutClock(const RankedHit * rankedHit, unsigned int len);
     void aggregateWithClock(const RankedHit * rankedHit, unsigned int len);
     void postProcess();
@@ -44,8 +50,8 @@ public:
     Grouping();
     Grouping(const Grouping &);
     Grouping & operator = (const Grouping &);
-    Grouping(Grouping &&) = default;
-    Grouping & operator = (Grouping &&) = default;
+    Grouping(Grouping &&) noexcept;
+    Grouping & operator = (Grouping &&) noexcept;
     ~Grouping();
 
     Grouping unchain() const { return *this; }
@@ -60,6 +66,7 @@ public:
     Grouping &setRoot(const Group &root_)       { _root = root_;            return *this; }
     Grouping &setClock(const vespalib::Clock * clock) { _clock = clock; return *this; }
     Grouping &setTimeOfDoom(fastos::TimeStamp timeOfDoom) { _timeOfDoom = timeOfDoom; return *this; }
+    Grouping &setMaxGroupsInMemory(uint32_t v) { _maxGroupsInMemory = v; return *this; }
 
     unsigned int getId()     const { return _id; }
     bool valid()             const { return _valid; }
@@ -68,6 +75,7 @@ public:
     size_t getMaxN(size_t n) const { return std::min(n, static_cast<size_t>(getTopN())); }
     uint32_t getFirstLevel() const { return _firstLevel; }
     uint32_t getLastLevel()  const { return _lastLevel; }
+    uint32_t getMaxGroupsInMemory() const { return _maxGroupsInMemory; }
     const GroupingLevelList &getLevels() const { return _levels; }
     const Group &getRoot()   const { return _root; }
     bool needResort() const;
@@ -81,6 +89,15 @@ public:
     void merge(Grouping & b);
     void mergePartial(const Grouping & b);
     void postMerge();
+
+    /**
+     * Performs postMerge() and sortById() for the root and its
+     * children only. The subtrees of the remaining top-level groups
+     * must then be completed with postMergeAndSortGroup(). These calls
+     * do not depend on each other and may run in parallel.
+     **/
+    void postMergeTopLevel();
+    void postMergeAndSortGroup(uint32_t topLevelGroup);
     void preAggregate(bool isOrdered);
     void prune(const Grouping & b);
     void aggregate(DocId from, DocId to);
@@ -0,0 +1,166 @@
+// Copyright 2019 Oath Inc. Licensed under the terms of the Apache 2.0 license. See LICENSE in the project root.
+
+#include "groupspill.h"
+#include "groupinglevel.h"
+#include <vespa/vespalib/objects/nbostream.h>
+#include <algorithm>
+#include <cstdio>
+
+namespace search::aggregation {
+
+namespace {
+
+void
+keepBest(std::vector<Group::UP> &groups, size_t maxGroups)
+{
+    if (groups.size() > maxGroups) {
+        std::nth_element(groups.begin(), groups.begin() + maxGroups, groups.end(),
+                         [](const Group::UP &a, const Group::UP &b) { return (a->cmpRank(*b) < 0); });
+        groups.resize(maxGroups);
+    }
+}
+
+}
+
+/**
+ * A temporary file holding length prefixed serialized groups.
+ **/
+class GroupSpill::Run
+{
+    FILE              *_file;
+    std::vector<char>  _buf;
+public:
+    explicit Run(FILE *file) : _file(file), _buf() { }
+    Run(const Run &) = delete;
+    Run & operator = (const Run &) = delete;
+    ~Run() { fclose(_file); }
+
+    static std::unique_ptr<Run> create() {
+        FILE *file = std::tmpfile();
+        return (file != nullptr) ? std::make_unique<Run>(file) : std::unique_ptr<Run>();
+    }
+
+    bool write(const Group &group) {
+        vespalib::nbostream os;
+        os << group;
+        uint32_t len = os.size();
+        return (fwrite(&len, sizeof(len), 1, _file) == 1) &&
+               (fwrite(os.peek(), 1, len, _file) == len);
+    }
+
+    void rewind() { ::rewind(_file); }
+
+    /**
+     * Read the next group, leaving it empty at the end of the run.
+     *
+     * @return false if the run could not be read.
+     **/
+    bool read(Group::UP &group) {
+        group.reset();
+        uint32_t len(0);
+        if (fread(&len, sizeof(len), 1, _file) != 1) {
+            return (feof(_file) != 0);
+        }
+        _buf.resize(len);
+        if (fread(&_buf[0], 1, len, _file) != len) {
+            return false;
+        }
+        try {
+            vespalib::nbostream is(&_buf[0], len);
+            group = std::make_unique<Group>();
+            is >> *group;
+        } catch (const std::exception &) {
+            group.reset();
+            return false;
+        }
+        return true;
+    }
+};
+
+GroupSpill::GroupSpill()
+    : _runs(),
+      _failed(false)
+{
+}
+
+GroupSpill::~GroupSpill() = default;
+
+bool
+GroupSpill::spill(Group &root)
+{
+    std::unique_ptr<Run> run(_failed ? std::unique_ptr<Run>() : Run::create());
+    for (size_t i(0), m(root.getChildrenSize()); run && (i < m); i++) {
+        if ( ! run->write(root.getChild(i))) {
+            run.reset();
+        }
+    }
+    if ( ! run) {
+        _failed = true;
+        return false;
+    }
+    root.releaseChildren();
+    _runs.push_back(std::move(run));
+    return true;
+}
+
+bool
+GroupSpill::merge(Group &root, const GroupingLevelList &levels, uint32_t firstLevel, uint64_t maxGroups)
+{
+    std::vector<Group::UP> inMemory(root.releaseChildren());
+    size_t nextInMemory(0);
+    bool ok(true);
+    // One source per run, with the groups still held in memory as the last source.
+    std::vector<Group::UP> heads(_runs.size() + 1);
+    auto advance = [&](size_t source) {
+        if (source < _runs.size()) {
+            ok = _runs[source]->read(heads[source]) && ok;
+        } else if (nextInMemory < inMemory.size()) {
+            heads[source] = std::move(inMemory[nextInMemory++]);
+        } else {
+            heads[source].reset();
+        }
+    };
+    for (size_t i(0); i < heads.size(); i++) {
+        if (i < _runs.size()) {
+            _runs[i]->rewind();
+        }
+        advance(i);
+    }
+    std::vector<Group::UP> best;
+    while (ok) {
+        size_t min(heads.size());
+        for (size_t i(0); i < heads.size(); i++) {
+            if (heads[i] && ((min == heads.size()) || (heads[i]->cmpId(*heads[min]) < 0))) {
+                min = i;
+            }
+        }
+        if (min == heads.size()) {
+            break;
+        }
+        Group::UP group(std::move(heads[min]));
+        advance(min);
+        for (size_t i(min + 1); i < heads.size(); i++) {
+            if (heads[i] && (heads[i]->cmpId(*group) == 0)) {
+                group->merge(levels, firstLevel, 1, *heads[i]);
+                advance(i);
+            }
+        }
+        group->executeOrderBy();
+        best.push_back(std::move(group));
+        if (best.size() > 2 * maxGroups) {
+            keepBest(best, maxGroups);
+        }
+    }
+    _runs.clear();
+    if ( ! ok) {
+        _failed = true;
+        return false;
+    }
+    keepBest(best, maxGroups);
+    for (Group::UP &group : best) {
+        root.addChild(std::move(group));
+    }
+    return true;
+}
+
+}
@@ -0,0 +1,61 @@
+// Copyright 2019 Oath Inc. Licensed under the terms of the Apache 2.0 license. See LICENSE in the project root.
+#pragma once
+
+#include "group.h"
+#include <memory>
+#include <vector>
+
+namespace search::aggregation {
+
+class GroupingLevel;
+
+/**
+ * Spills the top-level groups of a grouping tree to temporary files
+ * when aggregation exceeds its in-memory group budget, and merges the
+ * spilled runs back into the tree when aggregation is done.
+ *
+ * Each run holds the partial aggregates of a disjoint part of the
+ * hit stream, sorted by group id. Groups with the same id in
+ * different runs are merged during a k-way merge by id, and only the
+ * best groups by rank are kept for the final result.
+ **/
+class GroupSpill
+{
+public:
+    using GroupingLevelList = std::vector<GroupingLevel>;
+
+    GroupSpill();
+    GroupSpill(const GroupSpill &) = delete;
+    GroupSpill & operator = (const GroupSpill &) = delete;
+    ~GroupSpill();
+
+    /**
+     * Write the children of the given root to a new run and remove
+     * them from the root. The children must be sorted by id and not
+     * be aggregating. The root is left untouched if the run could not
+     * be written, and no further runs are written after a failure.
+     *
+     * @return true if the children were spilled.
+     **/
+    bool spill(Group &root);
+
+    /**
+     * Merge all spilled runs with the children still held by the
+     * given root, leaving the best merged groups by rank as the
+     * children of the root. The children of the root must be sorted
+     * by id. At most 2 * maxGroups merged groups are held in memory.
+     *
+     * @return false if a run could not be read, leaving the root
+     *         without children.
+     **/
+    bool merge(Group &root, const GroupingLevelList &levels, uint32_t firstLevel, uint64_t maxGroups);
+
+    size_t getNumRuns() const { return _runs.size(); }
+    bool hasFailed() const { return _failed; }
+private:
+    class Run;
+    std::vector<std::unique_ptr<Run>> _runs;
+    bool                              _failed;
+};
+
+}
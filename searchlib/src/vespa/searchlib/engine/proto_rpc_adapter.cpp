@@ -9,7 +9,14 @@
 #include <vespa/vespalib/util/compressor.h>
 #include <vespa/searchlib/util/slime_output_raw_buf_adapter.h>
 #include <vespa/vespalib/data/databuffer.h>
+#include <vespa/vespalib/data/lz4_output_encoder.h>
+#include <vespa/vespalib/data/lz4_input_decoder.h>
+#include <vespa/vespalib/data/memory_input.h>
+#include <vespa/vespalib/util/alloc.h>
 #include <vespa/searchlib/common/packets.h>
+#include <google/protobuf/io/zero_copy_stream.h>
+#include <algorithm>
+#include <climits>
 
 #include <vespa/log/log.h>
 LOG_SETUP(".engine.proto_rpc_adapter");
@@ -18,6 +25,7 @@ namespace search::engine {
 
 using vespalib::DataBuffer;
 using vespalib::ConstBufferRef;
+using vespalib::alloc::Alloc;
 using vespalib::compression::CompressionConfig;
 using ProtoSearchRequest = ProtoConverter::ProtoSearchRequest;
 using ProtoSearchReply = ProtoConverter::ProtoSearchReply;
@@ -34,22 +42,170 @@ CompressionConfig get_compression_config() {
     return CompressionConfig(streamer.getCompressionType(), streamer.getCompressionLevel(), 80, streamer.getCompressionLimit());
 }
 
+// uncompressed size of each lz4 frame in a framed message
+constexpr size_t frame_size = 64 * 1024;
+
+// Output collecting data in memory that can be handed over to an rpc
+// data value without copying.
+class AllocOutput : public vespalib::Output {
+private:
+    Alloc  _data;
+    size_t _used;
+public:
+    AllocOutput(size_t initial_size) : _data(Alloc::alloc(initial_size)), _used(0) {}
+    vespalib::WritableMemory reserve(size_t bytes) override {
+        if ((_used + bytes) > _data.size()) {
+            Alloc next = _data.create(std::max(_data.size() * 2, _used + bytes));
+            memcpy(next.get(), _data.get(), _used);
+            _data.swap(next);
+        }
+        return vespalib::WritableMemory(static_cast<char *>(_data.get()) + _used, _data.size() - _used);
+    }
+    vespalib::Output &commit(size_t bytes) override {
+        _used += bytes;
+        return *this;
+    }
+    size_t used() const { return _used; }
+    Alloc release() { return std::move(_data); }
+};
+
+// Lets protobuf serialize straight into a vespalib::Output.
+class ProtoOutputStream : public google::protobuf::io::ZeroCopyOutputStream {
+private:
+    vespalib::Output &_output;
+    size_t            _pending;
+    int64_t           _committed;
+public:
+    ProtoOutputStream(vespalib::Output &output) : _output(output), _pending(0), _committed(0) {}
+    ~ProtoOutputStream() override { flush(); }
+    bool Next(void **data, int *size) override {
+        flush();
+        auto mem = _output.reserve(1);
+        _pending = std::min(mem.size, size_t(INT_MAX));
+        *data = mem.data;
+        *size = _pending;
+        return true;
+    }
+    void BackUp(int count) override { _pending -= count; }
+    int64_t ByteCount() const override { return (_committed + _pending); }
+    void flush() {
+        if (_pending > 0) {
+            _output.commit(_pending);
+            _committed += _pending;
+            _pending = 0;
+        }
+    }
+};
+
+// Lets protobuf parse straight from a vespalib::Input.
+class ProtoInputStream : public google::protobuf::io::ZeroCopyInputStream {
+private:
+    vespalib::Input &_input;
+    size_t           _last;
+    int64_t          _consumed;
+public:
+    ProtoInputStream(vespalib::Input &input) : _input(input), _last(0), _consumed(0) {}
+    bool Next(const void **data, int *size) override {
+        _input.evict(_last);
+        _consumed += _last;
+        auto mem = _input.obtain();
+        _last = std::min(mem.size, size_t(INT_MAX));
+        *data = mem.data;
+        *size = _last;
+        return (_last > 0);
+    }
+    void BackUp(int count) override { _last -= count; }
+    bool Skip(int count) override {
+        const void *data;
+        int size;
+        while (count > 0) {
+            if (!Next(&data, &size)) {
+                return false;
+            }
+            if (size > count) {
+                BackUp(size - count);
+                return true;
+            }
+            count -= size;
+        }
+        return true;
+    }
+    int64_t ByteCount() const override { return (_consumed + _last); }
+};
+
+// same level mapping as the one-shot lz4 compressor
+int lz4_frame_level(const CompressionConfig &config) {
+    return (config.compressionLevel > 6) ? config.compressionLevel : 0;
+}
+
+// returns false (adding nothing) if the frames end up larger than max_len
 template <typename MSG>
-void encode_message(const MSG &src, FRT_Values &dst) {
+bool encode_framed_message(const MSG &src, size_t size, int level, size_t max_len, FRT_Values &dst) {
+    AllocOutput output(std::min(size, frame_size));
+    {
+        vespalib::Lz4OutputEncoder encoder(output, frame_size, level);
+        ProtoOutputStream stream(encoder);
+        bool ok = src.SerializeToZeroCopyStream(&stream);
+        assert(ok);
+        (void) ok;
+    } // flushes the last frame
+    size_t len = output.used();
+    if (len > max_len) {
+        return false;
+    }
+    dst.AddInt8(ProtoRpcAdapter::FRAMED_LZ4);
+    dst.AddInt32(size);
+    dst.AddData(output.release(), len);
+    return true;
+}
+
+// Requests are always framed when asked to, as a framed request is how
+// a client tells that it accepts framed replies. Replies are only
+// framed when the compression config selects lz4, and the message is
+// large enough and compresses well enough to be compressed at all.
+template <typename MSG>
+void encode_message(const MSG &src, FRT_Values &dst, bool framed = false, bool is_reply = true) {
     using vespalib::compression::compress;
+    CompressionConfig config = get_compression_config();
+    if (framed) {
+        size_t size = src.ByteSizeLong();
+        if (!is_reply) {
+            encode_framed_message(src, size, lz4_frame_level(config), SIZE_MAX, dst);
+            return;
+        }
+        if ((config.type == CompressionConfig::LZ4) && (size >= config.minSize) &&
+            encode_framed_message(src, size, lz4_frame_level(config), (size * config.threshold) / 100, dst))
+        {
+            return;
+        }
+    }
     auto output = src.SerializeAsString();
     ConstBufferRef buf(output.data(), output.size());
     DataBuffer compressed(output.data(), output.size());
-    CompressionConfig::Type type = compress(get_compression_config(), buf, compressed, true);
+    CompressionConfig::Type type = compress(config, buf, compressed, true);
     dst.AddInt8(type);
     dst.AddInt32(buf.size());
     dst.AddData(compressed.getData(), compressed.getDataLen());
 }
 
+template <typename MSG>
+bool decode_framed_message(const FRT_Values &src, MSG &dst) {
+    uint32_t uncompressed_size = src[1]._intval32;
+    vespalib::MemoryInput input(vespalib::Memory(src[2]._data._buf, src[2]._data._len));
+    vespalib::Lz4InputDecoder decoder(input, frame_size);
+    ProtoInputStream stream(decoder);
+    return (dst.ParseFromZeroCopyStream(&stream) &&
+            !decoder.failed() &&
+            (stream.ByteCount() == uncompressed_size));
+}
+
 template <typename MSG>
 bool decode_message(const FRT_Values &src, MSG &dst) {
     using vespalib::compression::decompress;
     uint8_t encoding = src[0]._intval8;
+    if (encoding == ProtoRpcAdapter::FRAMED_LZ4) {
+        return decode_framed_message(src, dst);
+    }
     uint32_t uncompressed_size = src[1]._intval32;
     DataBuffer uncompressed(src[2]._data._buf, src[2]._data._len);
     ConstBufferRef blob(src[2]._data._buf, src[2]._data._len);
@@ -58,6 +214,12 @@ bool decode_message(const FRT_Values &src, MSG &dst) {
     return dst.ParseFromArray(uncompressed.getData(), uncompressed.getDataLen());
 }
 
+// the client accepts framed replies if it sent a framed request
+bool is_framed(FRT_RPCRequest &req) {
+    return ((req.GetParams()->GetNumValues() > 0) &&
+            ((*req.GetParams())[0]._intval8 == ProtoRpcAdapter::FRAMED_LZ4));
+}
+
 //-----------------------------------------------------------------------------
 
 struct SearchRequestDecoder : SearchRequest::Source::Decoder {
@@ -84,11 +246,12 @@ std::unique_ptr<SearchRequest::Source::Decoder> search_request_decoder(FRT_RPCRe
 // allocated in the stash of the request it is completing; no self-delete needed
 struct SearchCompletionHandler : SearchClient {
     FRT_RPCRequest &req;
-    SearchCompletionHandler(FRT_RPCRequest &req_in) : req(req_in) {}
+    bool framed;
+    SearchCompletionHandler(FRT_RPCRequest &req_in) : req(req_in), framed(is_framed(req_in)) {}
     void searchDone(SearchReply::UP reply) override {
         ProtoSearchReply msg;
         ProtoConverter::search_reply_to_proto(*reply, msg);
-        encode_message(msg, *req.GetReturn());
+        encode_message(msg, *req.GetReturn(), framed);
         req.Return();
     }
 };
@@ -119,11 +282,13 @@ std::unique_ptr<DocsumRequest::Source::Decoder> docsum_request_decoder(FRT_RPCRe
 // allocated in the stash of the request it is completing; no self-delete needed
 struct GetDocsumsCompletionHandler : DocsumClient {
     FRT_RPCRequest &req;
-    GetDocsumsCompletionHandler(FRT_RPCRequest &req_in) : req(req_in) {}
+    bool framed;
+    GetDocsumsCompletionHandler(FRT_RPCRequest &req_in) : req(req_in), framed(is_framed(req_in)) {}
     void getDocsumsDone(DocsumReply::UP reply) override {
         ProtoDocsumReply msg;
         ProtoConverter::docsum_reply_to_proto(*reply, msg);
-        encode_message(msg, *req.GetReturn());
+        reply.reset(); // release the summaries before encoding them again
+        encode_message(msg, *req.GetReturn(), framed);
         req.Return();
     }
 };
@@ -145,10 +310,10 @@ struct PingCompletionHandler : MonitorClient {
 //-----------------------------------------------------------------------------
 
 void describe_bix_param_return(FRT_ReflectionBuilder &rb) {
-    rb.ParamDesc("encoding", "0=raw, 6=lz4, 7=zstd");
+    rb.ParamDesc("encoding", "0=raw, 6=lz4, 7=zstd, 134=framed lz4 (also accepted for the reply)");
     rb.ParamDesc("uncompressed_size", "uncompressed size of serialized request");
     rb.ParamDesc("request", "possibly compressed serialized request");
-    rb.ReturnDesc("encoding",  "0=raw, 6=lz4, 7=zstd");
+    rb.ReturnDesc("encoding",  "0=raw, 6=lz4, 7=zstd, 134=framed lz4");
     rb.ReturnDesc("uncompressed_size", "uncompressed size of serialized reply");
     rb.ReturnDesc("reply", "possibly compressed serialized reply");
 }
@@ -227,10 +392,10 @@ ProtoRpcAdapter::rpc_ping(FRT_RPCRequest *rpc)
 //-----------------------------------------------------------------------------
 
 void
-ProtoRpcAdapter::encode_search_request(const ProtoSearchRequest &src, FRT_RPCRequest &dst)
+ProtoRpcAdapter::encode_search_request(const ProtoSearchRequest &src, FRT_RPCRequest &dst, bool framed)
 {
     dst.SetMethodName("vespa.searchprotocol.search");
-    encode_message(src, *dst.GetParams());
+    encode_message(src, *dst.GetParams(), framed, false);
 }
 
 bool
@@ -240,10 +405,10 @@ ProtoRpcAdapter::decode_search_reply(FRT_RPCRequest &src, ProtoSearchReply &dst)
 }
 
 void
-ProtoRpcAdapter::encode_docsum_request(const ProtoDocsumRequest &src, FRT_RPCRequest &dst)
+ProtoRpcAdapter::encode_docsum_request(const ProtoDocsumRequest &src, FRT_RPCRequest &dst, bool framed)
 {
     dst.SetMethodName("vespa.searchprotocol.getDocsums");
-    encode_message(src, *dst.GetParams());
+    encode_message(src, *dst.GetParams(), framed, false);
 }
 
 bool
@@ -256,7 +421,7 @@ void
 ProtoRpcAdapter::encode_monitor_request(const ProtoMonitorRequest &src, FRT_RPCRequest &dst)
 {
     dst.SetMethodName("vespa.searchprotocol.ping");
-    encode_message(src, *dst.GetParams());
+    encode_message(src, *dst.GetParams(), false, false);
 }
 
 bool
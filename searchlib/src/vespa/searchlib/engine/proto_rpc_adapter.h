@@ -17,6 +17,15 @@ class MonitorServer;
  * Class adapting the internal search engine interfaces (SearchServer,
  * DocsumServer, MonitorServer) to the external searchprotocol api
  * (possibly compressed protobuf over frt rpc).
+ *
+ * Messages may also be encoded as a sequence of independent lz4
+ * frames (FRAMED_LZ4), which are produced while serializing and
+ * consumed while parsing without ever holding the complete
+ * uncompressed message in memory. A framed request tells that the
+ * client accepts framed replies. Search and docsum replies to framed
+ * requests are framed when the compression config selects lz4 and the
+ * reply is large enough and compresses well enough, using the
+ * configured compression level.
  **/
 class ProtoRpcAdapter : FRT_Invokable
 {
@@ -27,6 +36,7 @@ public:
     using ProtoDocsumReply = ProtoConverter::ProtoDocsumReply;
     using ProtoMonitorRequest = ProtoConverter::ProtoMonitorRequest;
     using ProtoMonitorReply = ProtoConverter::ProtoMonitorReply;
+    static constexpr uint8_t FRAMED_LZ4 = 134;
 private:
     SearchServer   &_search_server;
     DocsumServer   &_docsum_server;
@@ -42,10 +52,10 @@ public:
     void rpc_ping(FRT_RPCRequest *req);
 
     // convenience functions used for testing
-    static void encode_search_request(const ProtoSearchRequest &src, FRT_RPCRequest &dst);
+    static void encode_search_request(const ProtoSearchRequest &src, FRT_RPCRequest &dst, bool framed = false);
     static bool decode_search_reply(FRT_RPCRequest &src, ProtoSearchReply &dst);
 
-    static void encode_docsum_request(const ProtoDocsumRequest &src, FRT_RPCRequest &dst);
+    static void encode_docsum_request(const ProtoDocsumRequest &src, FRT_RPCRequest &dst, bool framed = false);
     static bool decode_docsum_reply(FRT_RPCRequest &src, ProtoDocsumReply &dst);
 
     static void encode_monitor_request(const ProtoMonitorRequest &src, FRT_RPCRequest &dst);
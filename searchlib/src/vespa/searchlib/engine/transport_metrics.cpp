@@ -1,6 +1,7 @@
 // Copyright 2017 Yahoo Holdings. Licensed under the terms of the Apache 2.0 license. See LICENSE in the project root.
 
 #include "transport_metrics.h"
+#include <vespa/fnet/transport_stats.h>
 
 namespace search::engine {
 
@@ -23,11 +24,67 @@ TransportMetrics::DocsumMetrics::DocsumMetrics(metrics::MetricSet *parent)
 
 TransportMetrics::DocsumMetrics::~DocsumMetrics() = default;
 
+namespace {
+
+uint64_t
+advance(uint64_t &last, uint64_t current)
+{
+    // Counters only go backwards if the transport has been replaced.
+    uint64_t delta = (current >= last) ? (current - last) : current;
+    last = current;
+    return delta;
+}
+
+}
+
+TransportMetrics::ConnectionMetrics::ConnectionMetrics(const vespalib::string &name,
+                                                       const vespalib::string &description,
+                                                       metrics::MetricSet *parent)
+    : metrics::MetricSet(name, {}, description, parent),
+      count("count", {}, "Number of open client connections", this),
+      queuedPackets("queued_packets", {}, "Packets queued for output, not yet written", this),
+      queuedBytes("queued_bytes", {}, "Bytes queued for output, not yet written", this),
+      maxOutputStall("max_output_stall", {}, "Longest time (in seconds) the output queue of a connection has been non-empty", this),
+      slowConsumers("slow_consumers", {}, "Number of connections currently flagged as slow consumers", this),
+      slowConsumerEvents("slow_consumer_events", {}, "Number of times a connection was flagged as a slow consumer", this),
+      shed("shed", {}, "Number of slow consumer connections closed", this),
+      bytesRead("bytes_read", {}, "Bytes read from client connections", this),
+      bytesWritten("bytes_written", {}, "Bytes written to client connections", this),
+      packetsRead("packets_read", {}, "Packets read from client connections", this),
+      packetsWritten("packets_written", {}, "Packets written to client connections", this),
+      _lastSlowConsumerEvents(0),
+      _lastShed(0),
+      _lastBytesRead(0),
+      _lastBytesWritten(0),
+      _lastPacketsRead(0),
+      _lastPacketsWritten(0)
+{
+}
+
+TransportMetrics::ConnectionMetrics::~ConnectionMetrics() = default;
+
+void
+TransportMetrics::ConnectionMetrics::update(const FNET_TransportStats &stats)
+{
+    count.set(stats.num_connections);
+    queuedPackets.set(stats.queued_packets);
+    queuedBytes.set(stats.queued_bytes);
+    maxOutputStall.set(stats.max_output_stall_ms / 1000.0);
+    slowConsumers.set(stats.slow_consumers);
+    slowConsumerEvents.inc(advance(_lastSlowConsumerEvents, stats.slow_consumer_events));
+    shed.inc(advance(_lastShed, stats.shed_connections));
+    bytesRead.inc(advance(_lastBytesRead, stats.bytes_read));
+    bytesWritten.inc(advance(_lastBytesWritten, stats.bytes_written));
+    packetsRead.inc(advance(_lastPacketsRead, stats.packets_read));
+    packetsWritten.inc(advance(_lastPacketsWritten, stats.packets_written));
+}
+
 TransportMetrics::TransportMetrics()
     : metrics::MetricSet("transport", {}, "Transport server metrics", nullptr),
       updateLock(),
       query(this),
-      docsum(this)
+      docsum(this),
+      connections("connections", "Client connection metrics", this)
 {
 }
 
@@ -5,6 +5,8 @@
 #include <vespa/metrics/metrics.h>
 #include <vespa/vespalib/util/sync.h>
 
+struct FNET_TransportStats;
+
 namespace search::engine {
 
 struct TransportMetrics : metrics::MetricSet
@@ -26,9 +28,42 @@ struct TransportMetrics : metrics::MetricSet
         ~DocsumMetrics();
     };
 
-    vespalib::Lock updateLock;
-    QueryMetrics   query;
-    DocsumMetrics  docsum;
+    /**
+     * Connection metrics for a single FNET transport. The counters are
+     * fed with what has happened since the previous update.
+     **/
+    struct ConnectionMetrics : metrics::MetricSet {
+        metrics::LongValueMetric   count;
+        metrics::LongValueMetric   queuedPackets;
+        metrics::LongValueMetric   queuedBytes;
+        metrics::DoubleValueMetric maxOutputStall;
+        metrics::LongValueMetric   slowConsumers;
+        metrics::LongCountMetric   slowConsumerEvents;
+        metrics::LongCountMetric   shed;
+        metrics::LongCountMetric   bytesRead;
+        metrics::LongCountMetric   bytesWritten;
+        metrics::LongCountMetric   packetsRead;
+        metrics::LongCountMetric   packetsWritten;
+
+        ConnectionMetrics(const vespalib::string &name, const vespalib::string &description,
+                          metrics::MetricSet *parent);
+        ~ConnectionMetrics();
+
+        void update(const FNET_TransportStats &stats);
+
+    private:
+        uint64_t _lastSlowConsumerEvents;
+        uint64_t _lastShed;
+        uint64_t _lastBytesRead;
+        uint64_t _lastBytesWritten;
+        uint64_t _lastPacketsRead;
+        uint64_t _lastPacketsWritten;
+    };
+
+    vespalib::Lock    updateLock;
+    QueryMetrics      query;
+    DocsumMetrics     docsum;
+    ConnectionMetrics connections;
 
     TransportMetrics();
     ~TransportMetrics() override;
@@ -0,0 +1,46 @@
+// Copyright 2019 Oath Inc. Licensed under the terms of the Apache 2.0 license. See LICENSE in the project root.
+
+#include "transport_server_explorer.h"
+#include "transportserver.h"
+#include <vespa/vespalib/data/slime/slime.h>
+
+using vespalib::slime::Inserter;
+using vespalib::slime::Cursor;
+
+namespace search::engine {
+
+void
+TransportServerExplorer::get_state(const Inserter &inserter, bool full) const
+{
+    Cursor &state = inserter.insertObject();
+    FNET_TransportStats stats = _server.getTransportStats(full);
+    state.setLong("connections", stats.num_connections);
+    state.setLong("queuedPackets", stats.queued_packets);
+    state.setLong("queuedBytes", stats.queued_bytes);
+    state.setDouble("maxOutputStallMs", stats.max_output_stall_ms);
+    state.setLong("slowConsumers", stats.slow_consumers);
+    state.setLong("slowConsumerEvents", stats.slow_consumer_events);
+    state.setLong("shedConnections", stats.shed_connections);
+    state.setLong("bytesRead", stats.bytes_read);
+    state.setLong("bytesWritten", stats.bytes_written);
+    state.setLong("packetsRead", stats.packets_read);
+    state.setLong("packetsWritten", stats.packets_written);
+    if (full) {
+        Cursor &array = state.setArray("connectionList");
+        for (const FNET_ConnectionStats &conn_in: stats.connections) {
+            Cursor &conn = array.addObject();
+            conn.setString("spec", conn_in.spec);
+            conn.setBool("slowConsumer", conn_in.slow_consumer);
+            conn.setLong("channels", conn_in.channels);
+            conn.setLong("queuedPackets", conn_in.queued_packets);
+            conn.setLong("queuedBytes", conn_in.queued_bytes);
+            conn.setDouble("outputStallMs", conn_in.output_stall_ms);
+            conn.setLong("bytesRead", conn_in.bytes_read);
+            conn.setLong("bytesWritten", conn_in.bytes_written);
+            conn.setLong("packetsRead", conn_in.packets_read);
+            conn.setLong("packetsWritten", conn_in.packets_written);
+        }
+    }
+}
+
+}
@@ -0,0 +1,24 @@
+// Copyright 2019 Oath Inc. Licensed under the terms of the Apache 2.0 license. See LICENSE in the project root.
+
+#pragma once
+
+#include <vespa/vespalib/net/state_explorer.h>
+
+namespace search::engine {
+
+class TransportServer;
+
+/**
+ * Class used to explore the client connections of a transport server.
+ */
+class TransportServerExplorer : public vespalib::StateExplorer
+{
+private:
+    TransportServer &_server;
+
+public:
+    TransportServerExplorer(TransportServer &server) : _server(server) {}
+    void get_state(const vespalib::slime::Inserter &inserter, bool full) const override;
+};
+
+}
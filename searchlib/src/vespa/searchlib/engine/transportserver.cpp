@@ -372,6 +372,14 @@ TransportServer::updateQueryMetrics(double latency_s)
     _metrics.query.latency.set(latency_s);
 }
 
+void
+TransportServer::updateMetrics()
+{
+    FNET_TransportStats stats = _transport.get_stats(false);
+    vespalib::LockGuard guard(_metrics.updateLock);
+    _metrics.connections.update(stats);
+}
+
 void
 TransportServer::updateDocsumMetrics(double latency_s, uint32_t numDocs)
 {
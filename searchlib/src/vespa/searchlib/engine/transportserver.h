@@ -305,6 +305,34 @@ public:
      **/
     void setIdleTimeout(double millisecs) { _transport.SetIOCTimeOut((uint32_t) millisecs); }
 
+    /**
+     * Set how many bytes may be queued for output on a connection
+     * before the client is flagged as a slow consumer.
+     *
+     * @param bytes output queue limit in bytes, 0 means unlimited
+     **/
+    void setSlowConsumerLimit(uint32_t bytes) { _transport.SetSlowConsumerLimit(bytes); }
+
+    /**
+     * Close client connections that are flagged as slow consumers.
+     *
+     * @param shed set to true to close slow consumers
+     **/
+    void setShedSlowConsumers(bool shed) { _transport.SetShedSlowConsumers(shed); }
+
+    /**
+     * Obtain statistics for the client connections of this server.
+     *
+     * @return connection statistics
+     * @param includeConnections list each connection
+     **/
+    FNET_TransportStats getTransportStats(bool includeConnections) { return _transport.get_stats(includeConnections); }
+
+    /**
+     * Update the connection metrics of this server.
+     **/
+    void updateMetrics();
+
     /**
      * Shut down this component. This method will block until the
      * transport server has been shut down. After this method returns,
@@ -464,6 +464,25 @@ RankScoreDropLimit::lookup(const Properties &props)
 
 } // namspace hitcollector
 
+namespace grouping {
+
+const vespalib::string MaxGroupsInMemory::NAME("vespa.grouping.maxgroupsinmemory");
+const uint32_t MaxGroupsInMemory::DEFAULT_VALUE(0);
+
+uint32_t
+MaxGroupsInMemory::lookup(const Properties &props)
+{
+    return lookup(props, DEFAULT_VALUE);
+}
+
+uint32_t
+MaxGroupsInMemory::lookup(const Properties &props, uint32_t defaultValue)
+{
+    return lookupUint32(props, NAME, defaultValue);
+}
+
+} // namespace grouping
+
 
 const vespalib::string FieldWeight::BASE_NAME("vespa.fieldweight.");
 const uint32_t FieldWeight::DEFAULT_VALUE(100);
@@ -379,6 +379,23 @@ namespace hitcollector {
 
 } // namespace hitcollector
 
+namespace grouping {
+
+    /**
+     * Property for the maximum number of top-level groups a grouping
+     * keeps in memory while aggregating. Groups above this limit are
+     * spilled to disk and merged back when aggregation is done. The
+     * default value is 0 (never spill).
+     **/
+    struct MaxGroupsInMemory {
+        static const vespalib::string NAME;
+        static const uint32_t DEFAULT_VALUE;
+        static uint32_t lookup(const Properties &props);
+        static uint32_t lookup(const Properties &props, uint32_t defaultValue);
+    };
+
+} // namespace grouping
+
 /**
  * Property for the field weight of a field.
  **/
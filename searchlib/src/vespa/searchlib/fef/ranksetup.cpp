@@ -41,6 +41,7 @@ RankSetup::RankSetup(const BlueprintFactory &factory, const IIndexEnvironment &i
       _arraySize(0),
       _estimatePoint(0),
       _estimateLimit(0),
+      _maxGroupsInMemory(0),
       _degradationMaxHits(0),
       _degradationMaxFilterCoverage(1.0),
       _degradationSamplePercentage(0.2),
@@ -95,6 +96,7 @@ RankSetup::configure()
     setEstimatePoint(hitcollector::EstimatePoint::lookup(_indexEnv.getProperties()));
     setEstimateLimit(hitcollector::EstimateLimit::lookup(_indexEnv.getProperties()));
     setRankScoreDropLimit(hitcollector::RankScoreDropLimit::lookup(_indexEnv.getProperties()));
+    setMaxGroupsInMemory(grouping::MaxGroupsInMemory::lookup(_indexEnv.getProperties()));
     setSoftTimeoutEnabled(softtimeout::Enabled::lookup(_indexEnv.getProperties()));
     setSoftTimeoutTailCost(softtimeout::TailCost::lookup(_indexEnv.getProperties()));
     setSoftTimeoutFactor(softtimeout::Factor::lookup(_indexEnv.getProperties()));
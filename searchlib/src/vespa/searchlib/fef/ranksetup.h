@@ -39,6 +39,7 @@ private:
     uint32_t                 _arraySize;
     uint32_t                 _estimatePoint;
     uint32_t                 _estimateLimit;
+    uint32_t                 _maxGroupsInMemory;
     uint32_t                 _degradationMaxHits;
     double                   _degradationMaxFilterCoverage;
     double                   _degradationSamplePercentage;
@@ -171,6 +172,22 @@ public:
      **/
     uint32_t getHeapSize() const { return _heapSize; }
 
+    /**
+     * Sets the maximum number of top-level groups a grouping keeps in
+     * memory before spilling to disk.
+     *
+     * @param maxGroupsInMemory the group limit, 0 means never spill
+     **/
+    void setMaxGroupsInMemory(uint32_t maxGroupsInMemory) { _maxGroupsInMemory = maxGroupsInMemory; }
+
+    /**
+     * Returns the maximum number of top-level groups a grouping keeps
+     * in memory before spilling to disk.
+     *
+     * @return the group limit
+     **/
+    uint32_t getMaxGroupsInMemory() const { return _maxGroupsInMemory; }
+
     /**
      * Sets the array size to be used in the hit collector.
      *
@@ -27,12 +27,20 @@ using index::Schema;
 namespace memoryindex {
 
 Dictionary::Dictionary(const Schema & schema)
+    : Dictionary(schema, 1)
+{
+}
+
+Dictionary::Dictionary(const Schema & schema, uint32_t numShards)
     : _fieldIndexes(),
-      _numFields(schema.getNumIndexFields())
+      _numFields(schema.getNumIndexFields()),
+      _numShards(std::max(numShards, 1u))
 {
     for (uint32_t fieldId = 0; fieldId < _numFields; ++fieldId) {
-        auto fieldIndex = std::make_unique<MemoryFieldIndex>(schema, fieldId);
-        _fieldIndexes.push_back(std::move(fieldIndex));
+        for (uint32_t shard = 0; shard < _numShards; ++shard) {
+            auto fieldIndex = std::make_unique<MemoryFieldIndex>(schema, fieldId);
+            _fieldIndexes.push_back(std::move(fieldIndex));
+        }
     }
 }
 
@@ -46,11 +54,39 @@ Dictionary::dump(search::index::IndexBuilder &indexBuilder)
 {
     for (uint32_t fieldId = 0; fieldId < _numFields; ++fieldId) {
         indexBuilder.startField(fieldId);
-        _fieldIndexes[fieldId]->dump(indexBuilder);
+        if (_numShards == 1) {
+            getFieldIndex(fieldId, 0)->dump(indexBuilder);
+        } else {
+            dumpShards(fieldId, indexBuilder);
+        }
         indexBuilder.endField();
     }
 }
 
+void
+Dictionary::dumpShards(uint32_t fieldId, search::index::IndexBuilder &indexBuilder)
+{
+    // A word belongs to a single shard, so merging the ordered words
+    // of all shards gives the ordered words of the field.
+    std::vector<std::unique_ptr<MemoryFieldIndex::WordDumper>> dumpers;
+    for (uint32_t shard = 0; shard < _numShards; ++shard) {
+        dumpers.push_back(std::make_unique<MemoryFieldIndex::WordDumper>(*getFieldIndex(fieldId, shard)));
+    }
+    for (;;) {
+        MemoryFieldIndex::WordDumper *next = nullptr;
+        for (auto &dumper : dumpers) {
+            if (dumper->valid() &&
+                (next == nullptr || strcmp(dumper->getWord(), next->getWord()) < 0)) {
+                next = dumper.get();
+            }
+        }
+        if (next == nullptr) {
+            break;
+        }
+        next->dumpWord(indexBuilder);
+    }
+}
+
 MemoryUsage
 Dictionary::getMemoryUsage() const
 {
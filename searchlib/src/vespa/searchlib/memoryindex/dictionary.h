@@ -3,12 +3,19 @@
 #pragma once
 
 #include "memoryfieldindex.h"
+#include "word_shard.h"
 
 namespace search::memoryindex {
 
 class IDocumentRemoveListener;
 class FieldInverter;
 
+/*
+ * The memory field indexes for all index fields.  The word dictionary
+ * of each field can be partitioned on word hash into several shards,
+ * each a separate memory field index, allowing the shards of a single
+ * field to be pushed in parallel.
+ */
 class Dictionary {
 public:
     using PostingList = MemoryFieldIndex::PostingList;
@@ -16,22 +23,27 @@ public:
 private:
     typedef vespalib::GenerationHandler GenerationHandler;
 
+    // Ordered by field id, then shard.
     std::vector<std::unique_ptr<MemoryFieldIndex> > _fieldIndexes;
     uint32_t                _numFields;
+    uint32_t                _numShards;
+
+    void dumpShards(uint32_t fieldId, search::index::IndexBuilder &indexBuilder);
 
 public:
     Dictionary(const index::Schema &schema);
+    Dictionary(const index::Schema &schema, uint32_t numShards);
     ~Dictionary();
     PostingList::Iterator find(const vespalib::stringref word,
                                uint32_t fieldId) const
     {
-        return _fieldIndexes[fieldId]->find(word);
+        return getFieldIndexForWord(fieldId, word)->find(word);
     }
 
     PostingList::ConstIterator
     findFrozen(const vespalib::stringref word, uint32_t fieldId) const
     {
-        return _fieldIndexes[fieldId]->findFrozen(word);
+        return getFieldIndexForWord(fieldId, word)->findFrozen(word);
     }
 
     uint64_t getNumUniqueWords() const {
@@ -46,14 +58,19 @@ public:
 
     MemoryUsage getMemoryUsage() const;
 
-    MemoryFieldIndex *getFieldIndex(uint32_t fieldId) const {
-        return _fieldIndexes[fieldId].get();
+    MemoryFieldIndex *getFieldIndex(uint32_t fieldId, uint32_t shard) const {
+        return _fieldIndexes[fieldId * _numShards + shard].get();
+    }
+
+    MemoryFieldIndex *getFieldIndexForWord(uint32_t fieldId, const vespalib::stringref word) const {
+        return getFieldIndex(fieldId, getWordShard(word, _numShards));
     }
 
     const std::vector<std::unique_ptr<MemoryFieldIndex> > &
     getFieldIndexes() const { return _fieldIndexes; }
 
     uint32_t getNumFields() const { return _numFields; }
+    uint32_t getNumShards() const { return _numShards; }
 };
 
 }
@@ -9,6 +9,7 @@
 #include <vespa/document/annotation/alternatespanlist.h>
 #include <vespa/searchlib/util/url.h>
 #include <stdexcept>
+#include <atomic>
 #include <vespa/vespalib/text/utf8.h>
 #include <vespa/vespalib/text/lowercase.h>
 #include <vespa/searchlib/common/sort.h>
@@ -181,6 +182,10 @@ DocumentInverter::pushDocuments(Dictionary &dict,
                                 const std::shared_ptr<IDestructorCallback> &
                                 onWriteDone)
 {
+    if (dict.getNumShards() > 1) {
+        pushShardedDocuments(dict, onWriteDone);
+        return;
+    }
     auto indexFieldIterator = dict.getFieldIndexes().begin();
     uint32_t fieldId = 0;
     for (auto &inverter : _inverters) {
@@ -198,5 +203,61 @@ DocumentInverter::pushDocuments(Dictionary &dict,
     }
 }
 
+
+void
+DocumentInverter::pushShardedDocuments(Dictionary &dict,
+                                       const std::shared_ptr<IDestructorCallback> &
+                                       onWriteDone)
+{
+    uint32_t numShards = dict.getNumShards();
+    uint32_t fieldId = 0;
+    // Apply removes and sort the inverted words on the invert thread
+    // owning each field. As soon as a field is sorted, that thread
+    // schedules the push of its shards, so fields are pushed as they
+    // become ready. Tasks for a field are scheduled from its invert
+    // thread only, which keeps them ordered across commits.
+    for (auto &inverter : _inverters) {
+        std::vector<DocumentRemover *> removers;
+        std::vector<MemoryFieldIndex *> fieldIndexes;
+        for (uint32_t shard = 0; shard < numShards; ++shard) {
+            MemoryFieldIndex *fieldIndex = dict.getFieldIndex(fieldId, shard);
+            removers.push_back(&fieldIndex->getDocumentRemover());
+            fieldIndexes.push_back(fieldIndex);
+        }
+        _invertThreads.execute(fieldId,
+                               [inverter(inverter.get()), removers(std::move(removers)),
+                                fieldIndexes(std::move(fieldIndexes)), &pushThreads = _pushThreads,
+                                fieldId, onWriteDone]()
+                               { inverter->applyRemoves(removers);
+                                   if (inverter->sortPositions()) {
+                                       inverter->partitionWords(fieldIndexes.size());
+                                   }
+                                   schedulePushShards(pushThreads, *inverter, fieldId, fieldIndexes, onWriteDone); });
+        ++fieldId;
+    }
+}
+
+void
+DocumentInverter::schedulePushShards(ISequencedTaskExecutor &pushThreads, FieldInverter &inverter,
+                                     uint32_t fieldId, const std::vector<MemoryFieldIndex *> &fieldIndexes,
+                                     const std::shared_ptr<IDestructorCallback> &onWriteDone)
+{
+    uint32_t numShards = fieldIndexes.size();
+    // The last shard to complete resets the inverter.
+    auto pendingShards = std::make_shared<std::atomic<uint32_t>>(numShards);
+    for (uint32_t shard = 0; shard < numShards; ++shard) {
+        MemoryFieldIndex &fieldIndex(*fieldIndexes[shard]);
+        OrderedDocumentInserter &inserter(fieldIndex.getInserter());
+        uint64_t componentId = (static_cast<uint64_t>(shard) << 32) | fieldId;
+        pushThreads.execute(componentId,
+                            [inverter(&inverter), &inserter, &fieldIndex,
+                             shard, pendingShards, onWriteDone]()
+                            { inverter->pushShard(inserter, shard);
+                                fieldIndex.commit();
+                                if (--(*pendingShards) == 0) {
+                                    inverter->reset();
+                                } });
+    }
 }
 
+}
@@ -23,6 +23,7 @@ namespace search::memoryindex {
 class FieldInverter;
 class UrlFieldInverter;
 class Dictionary;
+class MemoryFieldIndex;
 
 class DocumentInverter
 {
@@ -57,6 +58,11 @@ private:
      */
     const index::Schema &getSchema() const { return _schema; }
 
+    void pushShardedDocuments(Dictionary &dict, const std::shared_ptr<IDestructorCallback> &onWriteDone);
+    static void schedulePushShards(ISequencedTaskExecutor &pushThreads, FieldInverter &inverter,
+                                   uint32_t fieldId, const std::vector<MemoryFieldIndex *> &fieldIndexes,
+                                   const std::shared_ptr<IDestructorCallback> &onWriteDone);
+
 public:
     /**
      * Create a new memory index based on the given schema.
@@ -72,6 +78,12 @@ public:
     /**
      * Push inverted documents to memory index structure.
      *
+     * If the dictionary is sharded, removes are applied and words
+     * sorted on the invert threads, and each field then schedules its
+     * shards to be pushed in parallel on the push threads. Callers
+     * must sync the invert threads before the push threads to wait
+     * for the push to complete.
+     *
      * @param dict             dictionary
      */
     void pushDocuments(Dictionary &dict, const std::shared_ptr<IDestructorCallback> &onWriteDone);
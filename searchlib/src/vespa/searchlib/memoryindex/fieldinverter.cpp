@@ -2,6 +2,7 @@
 
 #include "fieldinverter.h"
 #include "ordereddocumentinserter.h"
+#include "word_shard.h"
 #include <vespa/document/datatype/urldatatype.h>
 #include <vespa/document/fieldvalue/arrayfieldvalue.h>
 #include <vespa/document/fieldvalue/stringfieldvalue.h>
@@ -177,6 +178,8 @@ FieldInverter::reset()
     _pendingDocs.clear();
     _abortedDocs.clear();
     _removeDocs.clear();
+    _wordStarts.clear();
+    _shardWords.clear();
     _oldPosSize = 0u;
 }
 
@@ -349,7 +352,9 @@ FieldInverter::FieldInverter(const Schema &schema, uint32_t fieldId)
       _terms(),
       _abortedDocs(),
       _pendingDocs(),
-      _removeDocs()
+      _removeDocs(),
+      _wordStarts(),
+      _shardWords()
 {
 }
 
@@ -491,13 +496,25 @@ FieldInverter::applyRemoves(DocumentRemover &remover)
 
 
 void
-FieldInverter::pushDocuments(IOrderedDocumentInserter &inserter)
+FieldInverter::applyRemoves(const std::vector<DocumentRemover *> &removers)
+{
+    for (auto docId : _removeDocs) {
+        for (auto remover : removers) {
+            remover->remove(docId, *this);
+        }
+    }
+    _removeDocs.clear();
+}
+
+
+bool
+FieldInverter::sortPositions()
 {
     trimAbortedDocs();
 
     if (_positions.empty()) {
         reset();
-        return;             // All documents with words aborted
+        return false;       // All documents with words aborted
     }
 
     sortWords();
@@ -505,7 +522,44 @@ FieldInverter::pushDocuments(IOrderedDocumentInserter &inserter)
     // Sort for terms.
     ShiftBasedRadixSorter<PosInfo, FullRadix, std::less<PosInfo>, 56, true>::
         radix_sort(FullRadix(), std::less<PosInfo>(), &_positions[0], _positions.size(), 16);
+    return true;
+}
+
+
+void
+FieldInverter::partitionWords(uint32_t numShards)
+{
+    uint32_t numWordIds = _wordRefs.size() - 1;
+    _wordStarts.clear();
+    _wordStarts.reserve(numWordIds + 2);
+    _wordStarts.push_back(0u);  // word number 0 is not used
+    uint32_t wordNum = 0;
+    for (uint32_t i = 0; i < _positions.size(); ++i) {
+        while (wordNum < _positions[i]._wordNum) {
+            _wordStarts.push_back(i);
+            ++wordNum;
+        }
+    }
+    while (wordNum <= numWordIds) {
+        _wordStarts.push_back(_positions.size());
+        ++wordNum;
+    }
+    _shardWords.clear();
+    _shardWords.resize(numShards);
+    for (wordNum = 1; wordNum <= numWordIds; ++wordNum) {
+        if (_wordStarts[wordNum] != _wordStarts[wordNum + 1]) {
+            uint32_t shard = getWordShard(getWordFromNum(wordNum), numShards);
+            _shardWords[shard].push_back(wordNum);
+        }
+    }
+}
+
 
+void
+FieldInverter::pushPositions(IOrderedDocumentInserter &inserter,
+                             index::DocIdAndPosOccFeatures &features,
+                             uint32_t begin, uint32_t end) const
+{
     constexpr uint32_t NO_ELEMENT_ID = std::numeric_limits<uint32_t>::max();
     constexpr uint32_t NO_WORD_POS = std::numeric_limits<uint32_t>::max();
     uint32_t lastWordNum = 0;
@@ -516,14 +570,13 @@ FieldInverter::pushDocuments(IOrderedDocumentInserter &inserter)
     vespalib::stringref word;
     bool emptyFeatures = true;
 
-    inserter.rewind();
-
-    for (auto &i : _positions) {
+    for (uint32_t idx = begin; idx < end; ++idx) {
+        const PosInfo &i = _positions[idx];
         assert(i._wordNum <= numWordIds);
         (void) numWordIds;
         if (lastWordNum != i._wordNum || lastDocId != i._docId) {
             if (!emptyFeatures) {
-                inserter.add(lastDocId, _features);
+                inserter.add(lastDocId, features);
                 emptyFeatures = true;
             }
             if (lastWordNum != i._wordNum) {
@@ -540,7 +593,7 @@ FieldInverter::pushDocuments(IOrderedDocumentInserter &inserter)
         if (emptyFeatures) {
             if (!i.removed()) {
                 emptyFeatures = false;
-                _features.clear(lastDocId);
+                features.clear(lastDocId);
                 lastElemId = NO_ELEMENT_ID;
                 lastWordPos = NO_WORD_POS;
             } else {
@@ -552,8 +605,8 @@ FieldInverter::pushDocuments(IOrderedDocumentInserter &inserter)
         }
         const ElemInfo &elem = _elems[i._elemRef];
         if (i._wordPos != lastWordPos || i._elemId != lastElemId) {
-            _features.addNextOcc(i._elemId, i._wordPos,
-                                 elem._weight, elem._len);
+            features.addNextOcc(i._elemId, i._wordPos,
+                                elem._weight, elem._len);
             lastElemId = i._elemId;
             lastWordPos = i._wordPos;
         } else {
@@ -562,13 +615,39 @@ FieldInverter::pushDocuments(IOrderedDocumentInserter &inserter)
     }
 
     if (!emptyFeatures) {
-        inserter.add(lastDocId, _features);
+        inserter.add(lastDocId, features);
+    }
+}
+
+
+void
+FieldInverter::pushDocuments(IOrderedDocumentInserter &inserter)
+{
+    if (!sortPositions()) {
+        return;
     }
+    inserter.rewind();
+    pushPositions(inserter, _features, 0u, _positions.size());
     inserter.flush();
     reset();
 }
 
 
+void
+FieldInverter::pushShard(IOrderedDocumentInserter &inserter, uint32_t shard) const
+{
+    if (_shardWords.empty()) {
+        return;             // All documents with words aborted
+    }
+    index::DocIdAndPosOccFeatures features;
+    inserter.rewind();
+    for (uint32_t wordNum : _shardWords[shard]) {
+        pushPositions(inserter, features, _wordStarts[wordNum], _wordStarts[wordNum + 1]);
+    }
+    inserter.flush();
+}
+
+
 } // namespace memoryindex
 
 } // namespace search
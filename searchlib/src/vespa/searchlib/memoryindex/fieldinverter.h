@@ -198,6 +198,10 @@ private:
     std::map<uint32_t, PositionRange> _pendingDocs;
     std::vector<uint32_t>             _removeDocs;
 
+    // Word partitioning used when pushing to a sharded dictionary.
+    std::vector<uint32_t>              _wordStarts; // word num -> first position
+    std::vector<std::vector<uint32_t>> _shardWords; // shard -> word nums
+
     void
     invertNormalDocTextField(const document::FieldValue &val);
 
@@ -334,12 +338,6 @@ private:
         return _schema;
     }
 
-    /**
-     * Clear internal memory structures.
-     */
-    void
-    reset();
-
     /**
      * Calculate word numbers and replace word references with word
      * numbers in internal memory structures.
@@ -362,6 +360,15 @@ private:
     void
     abortPendingDoc(uint32_t docId);
 
+    /*
+     * Push the sorted positions in the range [begin, end) to the
+     * inserter, using the given features as scratch area.
+     */
+    void
+    pushPositions(IOrderedDocumentInserter &inserter,
+                  index::DocIdAndPosOccFeatures &features,
+                  uint32_t begin, uint32_t end) const;
+
 public:
     /**
      * Create a new memory index based on the given schema.
@@ -379,6 +386,49 @@ public:
     void
     applyRemoves(DocumentRemover &remover);
 
+    /*
+     * Apply pending removes against all shards of a sharded field.
+     *
+     * @param removers   document remover for each shard
+     */
+    void
+    applyRemoves(const std::vector<DocumentRemover *> &removers);
+
+    /**
+     * Trim aborted documents and sort the remaining positions by
+     * (word, docId).  Returns false if there is nothing to push, in
+     * which case the inverter has been reset.
+     */
+    bool
+    sortPositions();
+
+    /**
+     * Partition the sorted words on dictionary shards, allowing
+     * pushShard() to be called concurrently for each shard.
+     *
+     * @param numShards  number of dictionary shards for the field
+     */
+    void
+    partitionWords(uint32_t numShards);
+
+    /**
+     * Push the words belonging to one shard.  Only reads the state of
+     * the inverter, and can thus run in parallel with pushing of the
+     * other shards.  The inverter must be reset after all shards have
+     * been pushed.
+     *
+     * @param inserter  ordered document inserter for the shard
+     * @param shard     shard to push
+     */
+    void
+    pushShard(IOrderedDocumentInserter &inserter, uint32_t shard) const;
+
+    /**
+     * Clear internal memory structures.
+     */
+    void
+    reset();
+
     /**
      * Push inverted documents to memory index structure.
      *
@@ -145,74 +145,82 @@ MemoryFieldIndex::compactFeatures()
     _featureStore.transferHoldLists(generation);
 }
 
+MemoryFieldIndex::WordDumper::WordDumper(MemoryFieldIndex &fieldIndex)
+    : _fieldIndex(fieldIndex),
+      _itr(fieldIndex._dict.begin()),
+      _decoder(NULL),
+      _features()
+{
+    _fieldIndex._featureStore.setupForField(_fieldIndex._fieldId, _decoder);
+    skipEmptyWords();
+}
+
+MemoryFieldIndex::WordDumper::~WordDumper() = default;
+
 void
-MemoryFieldIndex::dump(search::index::IndexBuilder & indexBuilder)
+MemoryFieldIndex::WordDumper::skipEmptyWords()
 {
-    vespalib::stringref word;
-    FeatureStore::DecodeContextCooked decoder(NULL);
-    DocIdAndFeatures features;
-    vespalib::Array<uint32_t> wordMap(_numUniqueWords + 1, 0);
-    _featureStore.setupForField(_fieldId, decoder);
-    for (DictionaryTree::Iterator itr = _dict.begin(); itr.valid(); ++itr) {
-        const WordKey & wk = itr.getKey();
-        PostingListStore::RefType plist(EntryRef(itr.getData()));
-        word = _wordStore.getWord(wk._wordRef);
-        if (!plist.valid())
-            continue;
-        indexBuilder.startWord(word);
-        uint32_t clusterSize = _postingListStore.getClusterSize(plist);
-        if (clusterSize == 0) {
-            const PostingList *tree = _postingListStore.getTreeEntry(plist);
-            PostingList::Iterator pitr = tree->begin(_postingListStore.getAllocator());
-            assert(pitr.valid());
-            for (; pitr.valid(); ++pitr) {
-                uint32_t docId = pitr.getKey();
-                EntryRef featureRef(pitr.getData());
-                indexBuilder.startDocument(docId);
-                _featureStore.setupForReadFeatures(featureRef, decoder);
-                decoder.readFeatures(features);
-                size_t poff = 0;
-                uint32_t wpIdx = 0u;
-                size_t numElements = features._elements.size();
-                for (size_t i = 0; i < numElements; ++i) {
-                    const WordDocElementFeatures & fef = features._elements[i];
-                    indexBuilder.startElement(fef.getElementId(), fef.getWeight(), fef.getElementLen());
-                    for (size_t j = 0; j < fef.getNumOccs(); ++j, ++wpIdx) {
-                        assert(wpIdx == poff + j);
-                        indexBuilder.addOcc(features._wordPositions[poff + j]);
-                    }
-                    poff += fef.getNumOccs();
-                    indexBuilder.endElement();
-                }
-                indexBuilder.endDocument();
-            }
-        } else {
-            const PostingListKeyDataType *kd =
-                _postingListStore.getKeyDataEntry(plist, clusterSize);
-            const PostingListKeyDataType *kde = kd + clusterSize;
-            for (; kd != kde; ++kd) {
-                uint32_t docId = kd->_key;
-                EntryRef featureRef(kd->getData());
-                indexBuilder.startDocument(docId);
-                _featureStore.setupForReadFeatures(featureRef, decoder);
-                decoder.readFeatures(features);
-                size_t poff = 0;
-                uint32_t wpIdx = 0u;
-                size_t numElements = features._elements.size();
-                for (size_t i = 0; i < numElements; ++i) {
-                    const WordDocElementFeatures & fef = features._elements[i];
-                    indexBuilder.startElement(fef.getElementId(), fef.getWeight(), fef.getElementLen());
-                    for (size_t j = 0; j < fef.getNumOccs(); ++j, ++wpIdx) {
-                        assert(wpIdx == poff + j);
-                        indexBuilder.addOcc(features._wordPositions[poff + j]);
-                    }
-                    poff += fef.getNumOccs();
-                    indexBuilder.endElement();
-                }
-                indexBuilder.endDocument();
-            }
+    while (_itr.valid() && !EntryRef(_itr.getData()).valid()) {
+        ++_itr;
+    }
+}
+
+void
+MemoryFieldIndex::WordDumper::dumpDocument(uint32_t docId, EntryRef featureRef,
+                                           search::index::IndexBuilder &indexBuilder)
+{
+    indexBuilder.startDocument(docId);
+    _fieldIndex._featureStore.setupForReadFeatures(featureRef, _decoder);
+    _decoder.readFeatures(_features);
+    size_t poff = 0;
+    uint32_t wpIdx = 0u;
+    size_t numElements = _features._elements.size();
+    for (size_t i = 0; i < numElements; ++i) {
+        const WordDocElementFeatures & fef = _features._elements[i];
+        indexBuilder.startElement(fef.getElementId(), fef.getWeight(), fef.getElementLen());
+        for (size_t j = 0; j < fef.getNumOccs(); ++j, ++wpIdx) {
+            assert(wpIdx == poff + j);
+            indexBuilder.addOcc(_features._wordPositions[poff + j]);
+        }
+        poff += fef.getNumOccs();
+        indexBuilder.endElement();
+    }
+    indexBuilder.endDocument();
+}
+
+void
+MemoryFieldIndex::WordDumper::dumpWord(search::index::IndexBuilder &indexBuilder)
+{
+    PostingListStore &postingListStore = _fieldIndex._postingListStore;
+    PostingListStore::RefType plist(EntryRef(_itr.getData()));
+    indexBuilder.startWord(getWord());
+    uint32_t clusterSize = postingListStore.getClusterSize(plist);
+    if (clusterSize == 0) {
+        const PostingList *tree = postingListStore.getTreeEntry(plist);
+        PostingList::Iterator pitr = tree->begin(postingListStore.getAllocator());
+        assert(pitr.valid());
+        for (; pitr.valid(); ++pitr) {
+            dumpDocument(pitr.getKey(), EntryRef(pitr.getData()), indexBuilder);
         }
-        indexBuilder.endWord();
+    } else {
+        const PostingListKeyDataType *kd =
+            postingListStore.getKeyDataEntry(plist, clusterSize);
+        const PostingListKeyDataType *kde = kd + clusterSize;
+        for (; kd != kde; ++kd) {
+            dumpDocument(kd->_key, EntryRef(kd->getData()), indexBuilder);
+        }
+    }
+    indexBuilder.endWord();
+    ++_itr;
+    skipEmptyWords();
+}
+
+void
+MemoryFieldIndex::dump(search::index::IndexBuilder & indexBuilder)
+{
+    WordDumper dumper(*this);
+    while (dumper.valid()) {
+        dumper.dumpWord(indexBuilder);
     }
 }
 
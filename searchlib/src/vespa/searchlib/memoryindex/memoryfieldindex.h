@@ -73,6 +73,35 @@ public:
     typedef btree::BTree<WordKey, PostingListPtr,
                          search::btree::NoAggregated,
                          const KeyComp> DictionaryTree;
+
+    /*
+     * Dumps the words of the field index one at a time, in word order.
+     * Used to merge the words from the shards of a sharded field.
+     */
+    class WordDumper {
+    private:
+        MemoryFieldIndex                 &_fieldIndex;
+        DictionaryTree::Iterator          _itr;
+        FeatureStore::DecodeContextCooked _decoder;
+        index::DocIdAndFeatures           _features;
+
+        void skipEmptyWords();
+        void dumpDocument(uint32_t docId, datastore::EntryRef featureRef,
+                          search::index::IndexBuilder &indexBuilder);
+    public:
+        WordDumper(MemoryFieldIndex &fieldIndex);
+        ~WordDumper();
+        bool valid() const { return _itr.valid(); }
+        const char *getWord() const {
+            return _fieldIndex._wordStore.getWord(_itr.getKey()._wordRef);
+        }
+
+        /*
+         * Dump the current word and step to the next word.
+         */
+        void dumpWord(search::index::IndexBuilder &indexBuilder);
+    };
+
 private:
     typedef vespalib::GenerationHandler GenerationHandler;
 
@@ -54,14 +54,15 @@ namespace search::memoryindex {
 
 MemoryIndex::MemoryIndex(const Schema &schema,
                          ISequencedTaskExecutor &invertThreads,
-                         ISequencedTaskExecutor &pushThreads)
+                         ISequencedTaskExecutor &pushThreads,
+                         uint32_t numPushShards)
     : _schema(schema),
       _invertThreads(invertThreads),
       _pushThreads(pushThreads),
       _inverter0(std::make_unique<DocumentInverter>(_schema, _invertThreads, _pushThreads)),
       _inverter1(std::make_unique<DocumentInverter>(_schema, _invertThreads, _pushThreads)),
       _inverter(_inverter0.get()),
-      _dictionary(std::make_unique<Dictionary>(_schema)),
+      _dictionary(std::make_unique<Dictionary>(_schema, numPushShards)),
       _frozen(false),
       _maxDocId(0), // docId 0 is reserved
       _numDocs(0),
@@ -207,7 +208,7 @@ public:
         const vespalib::string termStr = queryeval::termAsString(n);
         LOG(debug, "searching for '%s' in '%s'",
             termStr.c_str(), _field.getName().c_str());
-        MemoryFieldIndex *fieldIndex = _dictionary.getFieldIndex(_fieldId);
+        MemoryFieldIndex *fieldIndex = _dictionary.getFieldIndexForWord(_fieldId, termStr);
         GenerationHandler::Guard genGuard = fieldIndex->takeGenerationGuard();
         Dictionary::PostingList::ConstIterator pitr
             = fieldIndex->findFrozen(termStr);
@@ -75,10 +75,13 @@ public:
      * Create a new memory index based on the given schema.
      *
      * @param schema the index schema to use
+     * @param numPushShards number of hash partitions of the word
+     *        dictionary of each field, pushed in parallel on commit
      **/
     MemoryIndex(const index::Schema &schema,
                 ISequencedTaskExecutor &invertThreads,
-                ISequencedTaskExecutor &pushThreads);
+                ISequencedTaskExecutor &pushThreads,
+                uint32_t numPushShards = 1);
 
     /**
      * Class destructor.  Clean up washlist.
@@ -120,7 +123,8 @@ public:
      * them searchable. When commit is completed, onWriteDone goes out
      * of scope, scheduling completion callback.
      *
-     * Callers can call pushThreads.sync() to wait for push completion.
+     * Callers can call invertThreads.sync() followed by pushThreads.sync()
+     * to wait for push completion.
      **/
     void commit(const std::shared_ptr<IDestructorCallback> &onWriteDone);
 
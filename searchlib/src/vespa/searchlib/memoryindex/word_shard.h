@@ -0,0 +1,24 @@
+// Copyright 2019 Oath Inc. Licensed under the terms of the Apache 2.0 license. See LICENSE in the project root.
+
+#pragma once
+
+#include <vespa/vespalib/stllike/hash_fun.h>
+#include <vespa/vespalib/stllike/string.h>
+
+namespace search::memoryindex {
+
+/*
+ * Select which dictionary shard owns a word in a field whose
+ * dictionary is partitioned on word hash.  Pushing and lookup must
+ * agree on this.
+ */
+inline uint32_t
+getWordShard(vespalib::stringref word, uint32_t numShards)
+{
+    if (numShards <= 1) {
+        return 0u;
+    }
+    return vespalib::hash<vespalib::stringref>()(word) % numShards;
+}
+
+}
@@ -0,0 +1,147 @@
+// Copyright 2019 Oath Inc. Licensed under the terms of the Apache 2.0 license. See LICENSE in the project root.
+#include <vespa/vdstestlib/cppunit/macros.h>
+#include <vespa/storage/bucketdb/btree_bucket_database.h>
+#include <tests/distributor/bucketdatabasetest.h>
+
+namespace storage {
+namespace distributor {
+
+using document::BucketId;
+
+struct BTreeBucketDatabaseTest : public BucketDatabaseTest {
+    BTreeBucketDatabase _db;
+    BucketDatabase& db() override { return _db; };
+
+    CPPUNIT_TEST_SUITE(BTreeBucketDatabaseTest);
+    SETUP_DATABASE_TESTS();
+    CPPUNIT_TEST(read_guard_sees_snapshot_of_database);
+    CPPUNIT_TEST(read_guard_finds_parents_and_children);
+    CPPUNIT_TEST(single_entry_changes_are_visible_to_readers_once_committed);
+    CPPUNIT_TEST(single_entry_changes_are_committed_in_batches);
+    CPPUNIT_TEST_SUITE_END();
+
+    void read_guard_sees_snapshot_of_database();
+    void read_guard_finds_parents_and_children();
+    void single_entry_changes_are_visible_to_readers_once_committed();
+    void single_entry_changes_are_committed_in_batches();
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(BTreeBucketDatabaseTest);
+
+namespace {
+
+BucketDatabase::Entry
+entry(const BucketId& bucket, uint16_t node, uint32_t checksum)
+{
+    BucketInfo info;
+    info.addNode(BucketCopy(0, node, api::BucketInfo(checksum, 1, 1)), toVector<uint16_t>(0));
+    return BucketDatabase::Entry(bucket, info);
+}
+
+struct Collector : public BucketDatabase::EntryProcessor {
+    std::vector<BucketDatabase::Entry> _entries;
+
+    bool process(const BucketDatabase::Entry& e) override {
+        _entries.push_back(e);
+        return true;
+    }
+};
+
+}
+
+void
+BTreeBucketDatabaseTest::read_guard_sees_snapshot_of_database()
+{
+    _db.update(entry(BucketId(16, 1), 0, 10));
+    _db.update(entry(BucketId(16, 2), 1, 20));
+    _db.commit_pending_changes();
+
+    auto guard = _db.acquire_read_guard();
+
+    _db.update(entry(BucketId(16, 1), 0, 11));
+    _db.update(entry(BucketId(16, 3), 2, 30));
+    _db.remove(BucketId(16, 2));
+    _db.commit_pending_changes();
+
+    // The guard still observes the database as it was when acquired.
+    CPPUNIT_ASSERT_EQUAL(uint64_t(2), guard->size());
+    CPPUNIT_ASSERT_EQUAL(entry(BucketId(16, 1), 0, 10), guard->get(BucketId(16, 1)));
+    CPPUNIT_ASSERT_EQUAL(entry(BucketId(16, 2), 1, 20), guard->get(BucketId(16, 2)));
+    CPPUNIT_ASSERT(!guard->get(BucketId(16, 3)).valid());
+
+    Collector collector;
+    guard->forEach(collector);
+    CPPUNIT_ASSERT_EQUAL(size_t(2), collector._entries.size());
+
+    // A new guard observes all changes.
+    auto newGuard = _db.acquire_read_guard();
+    CPPUNIT_ASSERT(newGuard->generation() > guard->generation());
+    CPPUNIT_ASSERT_EQUAL(uint64_t(2), newGuard->size());
+    CPPUNIT_ASSERT_EQUAL(entry(BucketId(16, 1), 0, 11), newGuard->get(BucketId(16, 1)));
+    CPPUNIT_ASSERT(!newGuard->get(BucketId(16, 2)).valid());
+    CPPUNIT_ASSERT_EQUAL(entry(BucketId(16, 3), 2, 30), newGuard->get(BucketId(16, 3)));
+}
+
+void
+BTreeBucketDatabaseTest::read_guard_finds_parents_and_children()
+{
+    _db.update(entry(BucketId(16, 0x1234), 0, 1));
+    _db.update(entry(BucketId(18, 0x11234), 0, 2));
+    _db.update(entry(BucketId(20, 0x31234), 0, 3));
+    _db.update(entry(BucketId(16, 0x4321), 0, 4));
+    _db.commit_pending_changes();
+
+    auto guard = _db.acquire_read_guard();
+    std::vector<BucketDatabase::Entry> entries;
+    guard->getParents(BucketId(22, 0x31234), entries);
+    CPPUNIT_ASSERT_EQUAL(size_t(2), entries.size());
+    CPPUNIT_ASSERT_EQUAL(BucketId(16, 0x1234), entries[0].getBucketId());
+    CPPUNIT_ASSERT_EQUAL(BucketId(20, 0x31234), entries[1].getBucketId());
+
+    entries.clear();
+    guard->getAll(BucketId(17, 0x11234), entries);
+    CPPUNIT_ASSERT_EQUAL(size_t(3), entries.size());
+    CPPUNIT_ASSERT_EQUAL(BucketId(16, 0x1234), entries[0].getBucketId());
+    CPPUNIT_ASSERT_EQUAL(BucketId(18, 0x11234), entries[1].getBucketId());
+    CPPUNIT_ASSERT_EQUAL(BucketId(20, 0x31234), entries[2].getBucketId());
+}
+
+void
+BTreeBucketDatabaseTest::single_entry_changes_are_visible_to_readers_once_committed()
+{
+    _db.update(entry(BucketId(16, 1), 0, 10));
+    // The owner sees its own changes immediately.
+    CPPUNIT_ASSERT_EQUAL(entry(BucketId(16, 1), 0, 10), _db.get(BucketId(16, 1)));
+    CPPUNIT_ASSERT(!_db.acquire_read_guard()->get(BucketId(16, 1)).valid());
+
+    _db.commit_pending_changes();
+    CPPUNIT_ASSERT_EQUAL(entry(BucketId(16, 1), 0, 10), _db.acquire_read_guard()->get(BucketId(16, 1)));
+
+    _db.remove(BucketId(16, 1));
+    CPPUNIT_ASSERT_EQUAL(uint64_t(1), _db.acquire_read_guard()->size());
+    _db.commit_pending_changes();
+    CPPUNIT_ASSERT_EQUAL(uint64_t(0), _db.acquire_read_guard()->size());
+}
+
+void
+BTreeBucketDatabaseTest::single_entry_changes_are_committed_in_batches()
+{
+    const auto generation = _db.acquire_read_guard()->generation();
+    for (uint32_t i = 0; i < BTreeBucketDatabase::max_uncommitted_changes - 1; ++i) {
+        _db.update(entry(BucketId(16, i), 0, i));
+    }
+    CPPUNIT_ASSERT_EQUAL(generation, _db.acquire_read_guard()->generation());
+    CPPUNIT_ASSERT_EQUAL(uint64_t(0), _db.acquire_read_guard()->size());
+
+    _db.update(entry(BucketId(16, 0), 1, 0));
+    auto guard = _db.acquire_read_guard();
+    CPPUNIT_ASSERT_EQUAL(generation + 1, guard->generation());
+    CPPUNIT_ASSERT_EQUAL(uint64_t(BTreeBucketDatabase::max_uncommitted_changes - 1), guard->size());
+
+    // Nothing left to commit.
+    _db.commit_pending_changes();
+    CPPUNIT_ASSERT_EQUAL(generation + 1, _db.acquire_read_guard()->generation());
+}
+
+}
+}
@@ -1,8 +1,11 @@
 // Copyright 2017 Yahoo Holdings. Licensed under the terms of the Apache 2.0 license. See LICENSE in the project root.
 #include "bucketdatabasetest.h"
 #include <vespa/storageframework/defaultimplementation/clock/realclock.h>
+#include <vespa/vespalib/util/threadstackexecutor.h>
 #include <iomanip>
+#include <sstream>
 #include <algorithm>
+#include <stdexcept>
 
 namespace storage::distributor {
 
@@ -543,4 +546,170 @@ BucketDatabaseTest::testChildCount()
     CPPUNIT_ASSERT_EQUAL(0u, db().childCount(BucketId(3, 5)));
 }
 
+namespace {
+
+struct ListAllProcessor : public BucketDatabase::EntryProcessor {
+    std::ostringstream ost;
+
+    bool process(const BucketDatabase::Entry& e) override {
+        ost << e.getBucketId() << ":" << e->getLastGarbageCollectionTime() << "\n";
+        return true;
+    }
+};
+
+std::string
+dumpGcTimes(const BucketDatabase& db)
+{
+    ListAllProcessor proc;
+    db.forEach(proc);
+    return proc.ost.str();
+}
+
+struct TestMerger : public BucketDatabase::Merger {
+    std::vector<BucketDatabase::Entry> _toInsert;
+    bool _shardable = false;
+    std::vector<uint64_t> _shardFirstKeys;
+    std::vector<BucketId> _merged;
+
+    Result merge(BucketDatabase::Entry& e) override {
+        const auto raw = e.getBucketId().getRawId();
+        _merged.push_back(e.getBucketId());
+        if (raw == BucketId(16, 9).getRawId()) {
+            throw std::runtime_error("bucket 9 is bad");
+        }
+        e->setLastGarbageCollectionTime(1000);
+        // Buckets from fillWithSplitBuckets() get a mix of all results.
+        const uint64_t id = e.getBucketId().withoutCountBits();
+        if ((raw == BucketId(16, 1).getRawId()) || ((id >= 10) && (id % 4 == 3))) {
+            return Result::Update;
+        } else if ((raw == BucketId(16, 2).getRawId()) || ((id >= 10) && (id % 4 == 0))) {
+            return Result::Skip;
+        }
+        return Result::KeepUnchanged;
+    }
+
+    void insert_remaining_at_end(TrailingInserter& inserter) override {
+        for (const auto& e : _toInsert) {
+            inserter.insert_at_end(e);
+        }
+    }
+
+    std::unique_ptr<BucketDatabase::Merger> create_shard(uint64_t first_key) override {
+        if (!_shardable) {
+            return std::unique_ptr<BucketDatabase::Merger>();
+        }
+        _shardFirstKeys.push_back(first_key);
+        return std::make_unique<TestMerger>();
+    }
+
+    void join_shard(BucketDatabase::Merger& shard) override {
+        const auto& merged = static_cast<TestMerger&>(shard)._merged;
+        _merged.insert(_merged.end(), merged.begin(), merged.end());
+    }
+};
+
+BucketDatabase::Entry
+entryWithGcTime(const BucketId& bucket, uint32_t gcTime)
+{
+    BucketDatabase::Entry e(bucket, BI(1));
+    e->setLastGarbageCollectionTime(gcTime);
+    return e;
+}
+
+void
+fillWithSplitBuckets(BucketDatabase& db)
+{
+    // Buckets 16 and 17 bits deep, so that shards start in the middle of
+    // split buckets as well as between them.
+    for (uint32_t i = 10; i < 30; ++i) {
+        db.update(entryWithGcTime(BucketId(16, i), i));
+        db.update(entryWithGcTime(BucketId(17, i | 0x10000), i + 100));
+    }
+}
+
+}
+
+void
+BucketDatabaseTest::testMergeUpdatesKeepsAndRemovesEntries()
+{
+    db().update(entryWithGcTime(BucketId(16, 1), 1));
+    db().update(entryWithGcTime(BucketId(16, 2), 2));
+    db().update(entryWithGcTime(BucketId(16, 3), 3));
+
+    TestMerger merger;
+    db().merge(merger);
+
+    CPPUNIT_ASSERT_EQUAL(
+            std::string("BucketId(0x4000000000000001):1000\n"
+                        "BucketId(0x4000000000000003):3\n"),
+            dumpGcTimes(db()));
+}
+
+void
+BucketDatabaseTest::testParallelMergeGivesSameResultAsMerge()
+{
+    fillWithSplitBuckets(db());
+    TestMerger merger;
+    merger._toInsert.push_back(entryWithGcTime(BucketId(16, 4), 40));
+    db().merge(merger);
+    const std::string expected(dumpGcTimes(db()));
+    const auto expectedMerged(merger._merged);
+
+    vespalib::ThreadStackExecutor executor(3, 64 * 1024);
+    for (size_t shards : {1, 2, 4, 7, 100}) {
+        db().clear();
+        fillWithSplitBuckets(db());
+        TestMerger parallelMerger;
+        parallelMerger._shardable = true;
+        parallelMerger._toInsert.push_back(entryWithGcTime(BucketId(16, 4), 40));
+        const size_t expectedShards = (shards > 1) ? std::min(shards, db().size()) : 0;
+        db().parallel_merge(parallelMerger, executor, shards);
+
+        CPPUNIT_ASSERT_EQUAL(expected, dumpGcTimes(db()));
+        CPPUNIT_ASSERT(expectedMerged == parallelMerger._merged);
+        CPPUNIT_ASSERT_EQUAL(expectedShards, parallelMerger._shardFirstKeys.size());
+        CPPUNIT_ASSERT(std::is_sorted(parallelMerger._shardFirstKeys.begin(),
+                                      parallelMerger._shardFirstKeys.end()));
+    }
+}
+
+void
+BucketDatabaseTest::testParallelMergeRethrowsShardExceptionsWithoutChanges()
+{
+    fillWithSplitBuckets(db());
+    db().update(entryWithGcTime(BucketId(16, 9), 9));
+    const std::string before(dumpGcTimes(db()));
+
+    vespalib::ThreadStackExecutor executor(2, 64 * 1024);
+    TestMerger merger;
+    merger._shardable = true;
+    try {
+        db().parallel_merge(merger, executor, 4);
+        CPPUNIT_FAIL("Expected exception from shard");
+    } catch (std::runtime_error& e) {
+        CPPUNIT_ASSERT_EQUAL(std::string("bucket 9 is bad"), std::string(e.what()));
+    }
+    CPPUNIT_ASSERT_EQUAL(before, dumpGcTimes(db()));
+}
+
+void
+BucketDatabaseTest::testMergeInsertsTrailingEntries()
+{
+    db().update(entryWithGcTime(BucketId(16, 3), 3));
+
+    TestMerger merger;
+    // Inserted out of bucket key order, and one replaces an existing entry.
+    merger._toInsert.push_back(entryWithGcTime(BucketId(16, 4), 40));
+    merger._toInsert.push_back(entryWithGcTime(BucketId(16, 3), 30));
+    merger._toInsert.push_back(entryWithGcTime(BucketId(17, 0x10005), 50));
+    db().merge(merger);
+
+    CPPUNIT_ASSERT_EQUAL(uint64_t(3), db().size());
+    CPPUNIT_ASSERT_EQUAL(
+            std::string("BucketId(0x4000000000000004):40\n"
+                        "BucketId(0x4400000000010005):50\n"
+                        "BucketId(0x4000000000000003):30\n"),
+            dumpGcTimes(db()));
+}
+
 }
@@ -17,7 +17,11 @@
     CPPUNIT_TEST(testGetNext); \
     CPPUNIT_TEST(testGetNextReturnsUpperBoundBucket); \
     CPPUNIT_TEST(testUpperBoundReturnsNextInOrderGreaterBucket); \
-    CPPUNIT_TEST(testChildCount);
+    CPPUNIT_TEST(testChildCount); \
+    CPPUNIT_TEST(testMergeUpdatesKeepsAndRemovesEntries); \
+    CPPUNIT_TEST(testMergeInsertsTrailingEntries); \
+    CPPUNIT_TEST(testParallelMergeGivesSameResultAsMerge); \
+    CPPUNIT_TEST(testParallelMergeRethrowsShardExceptionsWithoutChanges);
 
 namespace storage {
 namespace distributor {
@@ -35,6 +39,10 @@ struct BucketDatabaseTest : public CppUnit::TestFixture {
     void testGetNextReturnsUpperBoundBucket();
     void testUpperBoundReturnsNextInOrderGreaterBucket();
     void testChildCount();
+    void testMergeUpdatesKeepsAndRemovesEntries();
+    void testMergeInsertsTrailingEntries();
+    void testParallelMergeGivesSameResultAsMerge();
+    void testParallelMergeRethrowsShardExceptionsWithoutChanges();
 
     void testBenchmark();
 
@@ -16,6 +16,7 @@
 #include <vespa/storage/distributor/distributor.h>
 #include <vespa/storage/distributor/distributor_bucket_space.h>
 #include <vespa/vespalib/text/stringtokenizer.h>
+#include <vespa/vespalib/util/threadstackexecutor.h>
 #include <sstream>
 #include <iomanip>
 
@@ -109,6 +110,9 @@ public:
     expandNodeVec(const std::vector<uint16_t> &nodes);
 
     std::vector<document::BucketSpace> _bucketSpaces;
+    // Used by mergeBucketLists() when merging pending cluster states
+    vespalib::Executor* _mergeExecutor;
+    size_t _mergeShards;
 
     size_t messageCount(size_t messagesPerBucketSpace) const {
         return messagesPerBucketSpace * _bucketSpaces.size();
@@ -547,7 +551,9 @@ public:
 
 BucketDBUpdaterTest::BucketDBUpdaterTest()
     : DistributorTestUtil(),
-      _bucketSpaces()
+      _bucketSpaces(),
+      _mergeExecutor(nullptr),
+      _mergeShards(1)
 {
 }
 
@@ -1665,7 +1671,7 @@ BucketDBUpdaterTest::mergeBucketLists(
                         cmd, outdatedNodesMap, beforeTime));
 
         parseInputData(existingData, beforeTime, *state, includeBucketInfo);
-        state->mergeIntoBucketDatabases();
+        state->mergeIntoBucketDatabases(_mergeExecutor, _mergeShards);
     }
 
     BucketDumper dumper_tmp(true);
@@ -1684,7 +1690,7 @@ BucketDBUpdaterTest::mergeBucketLists(
                         cmd, outdatedNodesMap, afterTime));
 
         parseInputData(newData, afterTime, *state, includeBucketInfo);
-        state->mergeIntoBucketDatabases();
+        state->mergeIntoBucketDatabases(_mergeExecutor, _mergeShards);
     }
 
     BucketDumper dumper(includeBucketInfo);
@@ -1777,6 +1783,25 @@ TEST_F(BucketDBUpdaterTest, testPendingClusterStateMerge) {
               mergeBucketLists("", "0:5/0/0/0|1:5/2/3/4", true));
 }
 
+TEST_F(BucketDBUpdaterTest, testPendingClusterStateMergeOnWorkerThreadsGivesSameResult) {
+    const lib::ClusterState upState("distributor:1 storage:3");
+    const lib::ClusterState diskDownState("distributor:1 storage:3 .0.d:3 .0.d.1.s:d");
+    const std::string existing("0:1,2,4,5,9,12,17|1:2,3,4,6,10,17|2:1,3,5,6,11,12");
+    const std::string expectedNewNode(mergeBucketLists(existing, "3:1,3,5,6,12"));
+    const std::string expectedChanged(mergeBucketLists(existing, "0:1,2,6,8,10"));
+    const std::string expectedDiskDown(mergeBucketLists(upState, existing, diskDownState, "0:1,2,17"));
+
+    vespalib::ThreadStackExecutor executor(3, 128 * 1024);
+    _mergeExecutor = &executor;
+    for (size_t shards : {2, 4, 64}) {
+        _mergeShards = shards;
+        EXPECT_EQ(expectedNewNode, mergeBucketLists(existing, "3:1,3,5,6,12"));
+        EXPECT_EQ(expectedChanged, mergeBucketLists(existing, "0:1,2,6,8,10"));
+        EXPECT_EQ(expectedDiskDown, mergeBucketLists(upState, existing, diskDownState, "0:1,2,17"));
+    }
+    _mergeExecutor = nullptr;
+}
+
 TEST_F(BucketDBUpdaterTest, testPendingClusterStateMergeReplicaChanged) {
     // Node went from initializing to up and non-invalid bucket changed.
     EXPECT_EQ(
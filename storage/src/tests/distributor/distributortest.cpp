@@ -41,6 +41,7 @@ class Distributor_Test : public CppUnit::TestFixture,
     CPPUNIT_TEST(testContainsTimeStatement);
     CPPUNIT_TEST(testUpdateBucketDatabase);
     CPPUNIT_TEST(testTickProcessesStatusRequests);
+    CPPUNIT_TEST(btree_bucket_db_status_is_reported_without_distributor_thread);
     CPPUNIT_TEST(testMetricUpdateHookUpdatesPendingMaintenanceMetrics);
     CPPUNIT_TEST(testPriorityConfigIsPropagatedToDistributorConfiguration);
     CPPUNIT_TEST(testNoDbResurrectionForBucketNotOwnedInPendingState);
@@ -80,6 +81,7 @@ protected:
     void testContainsTimeStatement();
     void testUpdateBucketDatabase();
     void testTickProcessesStatusRequests();
+    void btree_bucket_db_status_is_reported_without_distributor_thread();
     void testMetricUpdateHookUpdatesPendingMaintenanceMetrics();
     void testPriorityConfigIsPropagatedToDistributorConfiguration();
     void testNoDbResurrectionForBucketNotOwnedInPendingState();
@@ -472,6 +474,25 @@ Distributor_Test::testTickProcessesStatusRequests()
     CPPUNIT_ASSERT_CONTAIN("BucketId(0x4000000000000001)", thread.getResult());
 }
 
+void
+Distributor_Test::btree_bucket_db_status_is_reported_without_distributor_thread()
+{
+    close();
+    createLinks(true);
+    setupDistributor(Redundancy(1), NodeCount(1), "storage:1 distributor:1");
+    addNodesToBucketDB(document::BucketId(16, 1), "0=1/1/1/t");
+    // Publishes the batched database changes to concurrent readers.
+    tick();
+
+    // Reported from a snapshot in this thread, so no tick is needed to
+    // complete the request.
+    framework::HttpUrlPath path("/distributor?page=bucketdb");
+    std::ostringstream stream;
+    _distributor->_distributorStatusDelegate.reportStatus(stream, path);
+    CPPUNIT_ASSERT_CONTAIN("BucketId(0x4000000000000001)", stream.str());
+    CPPUNIT_ASSERT(_distributor->_statusToDo.empty());
+}
+
 void
 Distributor_Test::testMetricUpdateHookUpdatesPendingMaintenanceMetrics()
 {
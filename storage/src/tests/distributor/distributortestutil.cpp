@@ -20,7 +20,7 @@ DistributorTestUtil::DistributorTestUtil()
 DistributorTestUtil::~DistributorTestUtil() { }
 
 void
-DistributorTestUtil::createLinks()
+DistributorTestUtil::createLinks(bool useBTreeDatabase)
 {
     _node.reset(new TestDistributorApp(_config.getConfigId()));
     _threadPool = framework::TickingThreadPool::createDefault("distributor");
@@ -30,7 +30,8 @@ DistributorTestUtil::createLinks()
             *this,
             true,
             _hostInfo,
-            &_messageSender));
+            &_messageSender,
+            useBTreeDatabase));
     _component.reset(new storage::DistributorComponent(_node->getComponentRegister(), "distrtestutil"));
 };
 
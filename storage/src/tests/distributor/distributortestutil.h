@@ -34,7 +34,7 @@ public:
     /**
      * Sets up the storage link chain.
      */
-    void createLinks();
+    void createLinks(bool useBTreeDatabase = false);
     void setTypeRepo(const std::shared_ptr<const document::DocumentTypeRepo> &repo);
 
     void close();
@@ -4,6 +4,7 @@
 #include <vespa/storageapi/message/persistence.h>
 #include <vespa/storage/distributor/bucketdbupdater.h>
 #include <vespa/storage/distributor/distributor.h>
+#include <vespa/storage/distributor/distributor_bucket_space.h>
 #include <vespa/storage/distributor/operations/idealstate/mergeoperation.h>
 #include <vespa/storageapi/message/stat.h>
 #include <vespa/storageapi/message/visitor.h>
@@ -47,6 +48,7 @@ public:
     void testDisabledStateChecker();
     void testBlockIdealStateOpsOnFullRequestBucketInfo();
     void testBlockCheckForAllOperationsToSpecificBucket();
+    void testIdealStateIsPrefetchedForBucketsAheadOfScan();
 
     void setSystemState(const lib::ClusterState& systemState) {
         _distributor->enableClusterStateBundle(lib::ClusterStateBundle(systemState));
@@ -60,6 +62,7 @@ public:
     CPPUNIT_TEST(testDisabledStateChecker);
     CPPUNIT_TEST(testBlockIdealStateOpsOnFullRequestBucketInfo);
     CPPUNIT_TEST(testBlockCheckForAllOperationsToSpecificBucket);
+    CPPUNIT_TEST(testIdealStateIsPrefetchedForBucketsAheadOfScan);
     CPPUNIT_TEST_SUITE_END();
 private:
     std::vector<document::BucketSpace> _bucketSpaces;
@@ -269,6 +272,36 @@ IdealStateManagerTest::testBlockCheckForAllOperationsToSpecificBucket()
     }
 }
 
+void
+IdealStateManagerTest::testIdealStateIsPrefetchedForBucketsAheadOfScan()
+{
+    setupDistributor(2, 10, "distributor:1 storage:4");
+    std::vector<document::BucketId> buckets;
+    for (uint32_t i = 0; i < 10; ++i) {
+        buckets.push_back(document::BucketId(16, i));
+        insertBucketInfo(buckets.back(), 0, 0xff, 100, 200);
+    }
+    DistributorBucketSpace& bucketSpace(getDistributorBucketSpace());
+    const lib::IdealNodeCalculatorCache& cache(bucketSpace.getIdealNodesCache());
+    auto cached = [&](const document::BucketId& bucket) {
+        return cache.contains(lib::NodeType::STORAGE, bucketSpace.getDistribution(),
+                              bucketSpace.getClusterState(), bucket);
+    };
+    CPPUNIT_ASSERT(!cached(buckets.front()));
+
+    NodeMaintenanceStatsTracker statsTracker;
+    getIdealStateManager().prioritize(makeDocumentBucket(buckets.front()), statsTracker);
+    for (const auto& bucket : buckets) {
+        CPPUNIT_ASSERT(cached(bucket));
+        CPPUNIT_ASSERT_EQUAL(bucketSpace.getDistribution().getIdealStorageNodes(bucketSpace.getClusterState(), bucket),
+                             bucketSpace.getIdealStorageNodes(bucket));
+    }
+
+    // A new cluster state drops the ideal state of the old one
+    enableDistributorClusterState("distributor:1 storage:4 .1.s:d");
+    CPPUNIT_ASSERT(!cached(buckets.front()));
+}
+
 std::string
 IdealStateManagerTest::makeBucketStatusString(const std::string &defaultSpaceBucketStatus)
 {
@@ -35,10 +35,14 @@ class MockOperation : public MaintenanceOperation
     document::Bucket _bucket;
     std::string _reason;
     bool _shouldBlock;
+    Type _type;
+    std::vector<uint16_t> _nodes;
 public:
     MockOperation(const document::Bucket &bucket)
         : _bucket(bucket),
-          _shouldBlock(false)
+          _shouldBlock(false),
+          _type(MERGE_BUCKET),
+          _nodes()
     {}
 
     std::string toString() const override {
@@ -58,6 +62,10 @@ public:
     void setShouldBlock(bool shouldBlock) {
         _shouldBlock = shouldBlock;
     }
+    Type getType() const override { return _type; }
+    void setType(Type type) { _type = type; }
+    const std::vector<uint16_t>& getNodes() const override { return _nodes; }
+    void setNodes(const std::vector<uint16_t>& nodes) { _nodes = nodes; }
 };
 
 class MockMaintenanceOperationGenerator
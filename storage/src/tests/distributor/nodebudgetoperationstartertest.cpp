@@ -0,0 +1,202 @@
+// Copyright 2019 Oath Inc. Licensed under the terms of the Apache 2.0 license. See LICENSE in the project root.
+#include <vespa/vdstestlib/cppunit/macros.h>
+#include <vespa/storage/distributor/nodebudgetoperationstarter.h>
+#include <vespa/storage/distributor/nodeinfo.h>
+#include <tests/distributor/maintenancemocks.h>
+#include <vespa/document/test/make_document_bucket.h>
+
+using document::test::makeDocumentBucket;
+
+namespace storage {
+
+namespace distributor {
+
+using document::BucketId;
+
+class NodeBudgetOperationStarterTest : public CppUnit::TestFixture {
+    CPPUNIT_TEST_SUITE(NodeBudgetOperationStarterTest);
+    CPPUNIT_TEST(testOperationStartedWhenWithinBudget);
+    CPPUNIT_TEST(testOperationDeferredWhenAnyNodeIsOverBudget);
+    CPPUNIT_TEST(testBudgetsAreTrackedPerOperationType);
+    CPPUNIT_TEST(testUnbudgetedOperationTypesAreNotLimited);
+    CPPUNIT_TEST(testFinishingOperationsFreesBudget);
+    CPPUNIT_TEST(testOperationNotStartedByImplementationFreesBudget);
+    CPPUNIT_TEST(testBudgetScaledDownByLatency);
+    CPPUNIT_TEST(testBudgetScaledDownByQueueDepth);
+    CPPUNIT_TEST_SUITE_END();
+
+    std::shared_ptr<Operation> createMockOperation(MaintenanceOperation::Type type,
+                                                   const std::vector<uint16_t>& nodes)
+    {
+        auto op = std::make_shared<MockOperation>(makeDocumentBucket(BucketId(16, 1)));
+        op->setType(type);
+        op->setNodes(nodes);
+        return op;
+    }
+
+    framework::defaultimplementation::FakeClock _clock;
+    std::unique_ptr<NodeInfo> _nodeInfo;
+    std::unique_ptr<MockOperationStarter> _starterImpl;
+    std::unique_ptr<NodeBudgetOperationStarter> _operationStarter;
+
+public:
+    void testOperationStartedWhenWithinBudget();
+    void testOperationDeferredWhenAnyNodeIsOverBudget();
+    void testBudgetsAreTrackedPerOperationType();
+    void testUnbudgetedOperationTypesAreNotLimited();
+    void testFinishingOperationsFreesBudget();
+    void testOperationNotStartedByImplementationFreesBudget();
+    void testBudgetScaledDownByLatency();
+    void testBudgetScaledDownByQueueDepth();
+
+    void setUp() override;
+    void tearDown() override;
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(NodeBudgetOperationStarterTest);
+
+void
+NodeBudgetOperationStarterTest::setUp()
+{
+    _nodeInfo.reset(new NodeInfo(_clock));
+    _starterImpl.reset(new MockOperationStarter());
+    _operationStarter.reset(new NodeBudgetOperationStarter(*_nodeInfo, *_starterImpl));
+    _operationStarter->setMaxPendingPerNode(MaintenanceOperation::MERGE_BUCKET, 2);
+    _operationStarter->setMaxPendingPerNode(MaintenanceOperation::SPLIT_BUCKET, 1);
+}
+
+void
+NodeBudgetOperationStarterTest::tearDown()
+{
+    // Must clear before _operationStarter goes out of scope, or operation
+    // destructors will try to call method on destroyed object.
+    _starterImpl->getOperations().clear();
+}
+
+void
+NodeBudgetOperationStarterTest::testOperationStartedWhenWithinBudget()
+{
+    CPPUNIT_ASSERT(_operationStarter->start(
+            createMockOperation(MaintenanceOperation::MERGE_BUCKET, {0, 1}),
+            OperationStarter::Priority(0)));
+    CPPUNIT_ASSERT_EQUAL(size_t(1), _starterImpl->getOperations().size());
+    CPPUNIT_ASSERT_EQUAL(uint32_t(1), _operationStarter->getPendingCount(0, MaintenanceOperation::MERGE_BUCKET));
+    CPPUNIT_ASSERT_EQUAL(uint32_t(1), _operationStarter->getPendingCount(1, MaintenanceOperation::MERGE_BUCKET));
+    CPPUNIT_ASSERT_EQUAL(uint32_t(0), _operationStarter->getPendingCount(2, MaintenanceOperation::MERGE_BUCKET));
+}
+
+void
+NodeBudgetOperationStarterTest::testOperationDeferredWhenAnyNodeIsOverBudget()
+{
+    CPPUNIT_ASSERT(_operationStarter->start(
+            createMockOperation(MaintenanceOperation::MERGE_BUCKET, {0, 1}),
+            OperationStarter::Priority(0)));
+    CPPUNIT_ASSERT(_operationStarter->start(
+            createMockOperation(MaintenanceOperation::MERGE_BUCKET, {1, 2}),
+            OperationStarter::Priority(0)));
+    // Node 1 has used up its merge budget. The operation is reported as
+    // handled, but is never passed on to the implementation.
+    CPPUNIT_ASSERT(_operationStarter->start(
+            createMockOperation(MaintenanceOperation::MERGE_BUCKET, {2, 1}),
+            OperationStarter::Priority(0)));
+    CPPUNIT_ASSERT_EQUAL(size_t(2), _starterImpl->getOperations().size());
+    CPPUNIT_ASSERT_EQUAL(uint32_t(1), _operationStarter->getPendingCount(2, MaintenanceOperation::MERGE_BUCKET));
+
+    CPPUNIT_ASSERT(_operationStarter->start(
+            createMockOperation(MaintenanceOperation::MERGE_BUCKET, {2, 3}),
+            OperationStarter::Priority(0)));
+    CPPUNIT_ASSERT_EQUAL(size_t(3), _starterImpl->getOperations().size());
+}
+
+void
+NodeBudgetOperationStarterTest::testBudgetsAreTrackedPerOperationType()
+{
+    CPPUNIT_ASSERT(_operationStarter->start(
+            createMockOperation(MaintenanceOperation::SPLIT_BUCKET, {0}),
+            OperationStarter::Priority(0)));
+    CPPUNIT_ASSERT(_operationStarter->start(
+            createMockOperation(MaintenanceOperation::SPLIT_BUCKET, {0}),
+            OperationStarter::Priority(0)));
+    CPPUNIT_ASSERT_EQUAL(size_t(1), _starterImpl->getOperations().size());
+
+    CPPUNIT_ASSERT(_operationStarter->start(
+            createMockOperation(MaintenanceOperation::MERGE_BUCKET, {0}),
+            OperationStarter::Priority(0)));
+    CPPUNIT_ASSERT_EQUAL(size_t(2), _starterImpl->getOperations().size());
+}
+
+void
+NodeBudgetOperationStarterTest::testUnbudgetedOperationTypesAreNotLimited()
+{
+    _operationStarter->setMaxPendingPerNode(MaintenanceOperation::SET_BUCKET_STATE, 0);
+    for (uint32_t i = 0; i < 5; ++i) {
+        CPPUNIT_ASSERT(_operationStarter->start(
+                createMockOperation(MaintenanceOperation::SET_BUCKET_STATE, {0}),
+                OperationStarter::Priority(0)));
+    }
+    CPPUNIT_ASSERT_EQUAL(size_t(5), _starterImpl->getOperations().size());
+    CPPUNIT_ASSERT_EQUAL(uint32_t(0), _operationStarter->getPendingCount(0, MaintenanceOperation::SET_BUCKET_STATE));
+}
+
+void
+NodeBudgetOperationStarterTest::testFinishingOperationsFreesBudget()
+{
+    CPPUNIT_ASSERT(_operationStarter->start(
+            createMockOperation(MaintenanceOperation::SPLIT_BUCKET, {0}),
+            OperationStarter::Priority(0)));
+    CPPUNIT_ASSERT_EQUAL(uint32_t(1), _operationStarter->getPendingCount(0, MaintenanceOperation::SPLIT_BUCKET));
+
+    _starterImpl->getOperations().pop_back();
+    CPPUNIT_ASSERT_EQUAL(uint32_t(0), _operationStarter->getPendingCount(0, MaintenanceOperation::SPLIT_BUCKET));
+
+    CPPUNIT_ASSERT(_operationStarter->start(
+            createMockOperation(MaintenanceOperation::SPLIT_BUCKET, {0}),
+            OperationStarter::Priority(0)));
+    CPPUNIT_ASSERT_EQUAL(size_t(1), _starterImpl->getOperations().size());
+}
+
+void
+NodeBudgetOperationStarterTest::testOperationNotStartedByImplementationFreesBudget()
+{
+    _starterImpl->setShouldStartOperations(false);
+    CPPUNIT_ASSERT(!_operationStarter->start(
+            createMockOperation(MaintenanceOperation::SPLIT_BUCKET, {0}),
+            OperationStarter::Priority(0)));
+    CPPUNIT_ASSERT_EQUAL(uint32_t(0), _operationStarter->getPendingCount(0, MaintenanceOperation::SPLIT_BUCKET));
+}
+
+void
+NodeBudgetOperationStarterTest::testBudgetScaledDownByLatency()
+{
+    _operationStarter->setMaxPendingPerNode(MaintenanceOperation::MERGE_BUCKET, 8);
+    _operationStarter->setLatencyTarget(std::chrono::milliseconds(100));
+
+    _nodeInfo->addLatency(0, std::chrono::milliseconds(100));
+    CPPUNIT_ASSERT_EQUAL(uint32_t(8), _operationStarter->getBudget(0, MaintenanceOperation::MERGE_BUCKET));
+
+    _nodeInfo->addLatency(1, std::chrono::milliseconds(400));
+    CPPUNIT_ASSERT_EQUAL(uint32_t(2), _operationStarter->getBudget(1, MaintenanceOperation::MERGE_BUCKET));
+
+    // A node always has room for at least one operation of each type.
+    _nodeInfo->addLatency(2, std::chrono::milliseconds(100000));
+    CPPUNIT_ASSERT_EQUAL(uint32_t(1), _operationStarter->getBudget(2, MaintenanceOperation::MERGE_BUCKET));
+
+    _operationStarter->setLatencyTarget(std::chrono::milliseconds(0));
+    CPPUNIT_ASSERT_EQUAL(uint32_t(8), _operationStarter->getBudget(2, MaintenanceOperation::MERGE_BUCKET));
+}
+
+void
+NodeBudgetOperationStarterTest::testBudgetScaledDownByQueueDepth()
+{
+    _operationStarter->setMaxPendingPerNode(MaintenanceOperation::MERGE_BUCKET, 8);
+    _operationStarter->setQueueDepthTarget(2);
+
+    for (uint32_t i = 0; i < 4; ++i) {
+        _nodeInfo->incPending(0);
+    }
+    CPPUNIT_ASSERT_EQUAL(uint32_t(4), _operationStarter->getBudget(0, MaintenanceOperation::MERGE_BUCKET));
+    CPPUNIT_ASSERT_EQUAL(uint32_t(8), _operationStarter->getBudget(1, MaintenanceOperation::MERGE_BUCKET));
+}
+
+}
+}
@@ -26,9 +26,11 @@ namespace distributor {
 class NodeInfoTest : public CppUnit::TestFixture {
     CPPUNIT_TEST_SUITE(NodeInfoTest);
     CPPUNIT_TEST(testSimple);
+    CPPUNIT_TEST(testAverageLatency);
     CPPUNIT_TEST_SUITE_END();
 public:
     void testSimple();
+    void testAverageLatency();
 };
 
 CPPUNIT_TEST_SUITE_REGISTRATION(NodeInfoTest);
@@ -77,6 +79,24 @@ NodeInfoTest::testSimple()
 
 }
 
+void
+NodeInfoTest::testAverageLatency()
+{
+    framework::defaultimplementation::FakeClock clock;
+    NodeInfo info(clock);
+
+    CPPUNIT_ASSERT_EQUAL(int64_t(0), int64_t(info.getAverageLatency(3).count()));
+
+    info.addLatency(3, std::chrono::milliseconds(100));
+    CPPUNIT_ASSERT_EQUAL(int64_t(100), int64_t(info.getAverageLatency(3).count()));
+
+    // Each new sample moves the average 1/8 of the way towards it.
+    info.addLatency(3, std::chrono::milliseconds(900));
+    CPPUNIT_ASSERT_EQUAL(int64_t(200), int64_t(info.getAverageLatency(3).count()));
+
+    CPPUNIT_ASSERT_EQUAL(int64_t(0), int64_t(info.getAverageLatency(4).count()));
+}
+
 }
 
 }
@@ -27,6 +27,8 @@ class PendingMessageTrackerTest : public CppUnit::TestFixture {
     CPPUNIT_TEST(testGetAllMessagesForSingleBucket);
     CPPUNIT_TEST(busy_reply_marks_node_as_busy);
     CPPUNIT_TEST(busy_node_duration_can_be_adjusted);
+    CPPUNIT_TEST(client_operation_latency_is_tracked_per_node);
+    CPPUNIT_TEST(maintenance_operation_latency_is_not_tracked);
     CPPUNIT_TEST_SUITE_END();
 
 public:
@@ -38,6 +40,8 @@ public:
     void testGetAllMessagesForSingleBucket();
     void busy_reply_marks_node_as_busy();
     void busy_node_duration_can_be_adjusted();
+    void client_operation_latency_is_tracked_per_node();
+    void maintenance_operation_latency_is_not_tracked();
 
 private:
     void insertMessages(PendingMessageTracker& tracker);
@@ -122,6 +126,20 @@ public:
         sendPutReply(*put, RequestBuilder().atTime(1000ms + latency));
     }
 
+    void sendMergeAndReplyWithLatency(uint16_t node,
+                                      std::chrono::milliseconds latency)
+    {
+        assignMockedTime(1000ms);
+        std::vector<api::MergeBucketCommand::Node> nodes{node, uint16_t(node + 1)};
+        auto merge = std::make_shared<api::MergeBucketCommand>(
+                makeDocumentBucket(document::BucketId(16, 1234)), nodes, api::Timestamp(123456));
+        merge->setAddress(makeStorageAddress(node));
+        _tracker->insert(merge);
+        assignMockedTime(1000ms + latency);
+        auto reply = merge->makeReply();
+        _tracker->reply(*reply);
+    }
+
     PendingMessageTracker& tracker() { return *_tracker; }
     auto& clock() { return _clock; }
 
@@ -505,4 +523,20 @@ void PendingMessageTrackerTest::busy_node_duration_can_be_adjusted() {
     CPPUNIT_ASSERT(!f.tracker().getNodeInfo().isBusy(0));
 }
 
+void PendingMessageTrackerTest::client_operation_latency_is_tracked_per_node() {
+    Fixture f;
+    f.sendPutAndReplyWithLatency(0, 100ms);
+    f.sendPutAndReplyWithLatency(1, 500ms);
+    CPPUNIT_ASSERT_EQUAL(int64_t(100), int64_t(f.tracker().getNodeInfo().getAverageLatency(0).count()));
+    CPPUNIT_ASSERT_EQUAL(int64_t(500), int64_t(f.tracker().getNodeInfo().getAverageLatency(1).count()));
+}
+
+void PendingMessageTrackerTest::maintenance_operation_latency_is_not_tracked() {
+    Fixture f;
+    f.sendPutAndReplyWithLatency(0, 100ms);
+    f.sendMergeAndReplyWithLatency(0, 10000ms);
+    CPPUNIT_ASSERT_EQUAL(int64_t(100), int64_t(f.tracker().getNodeInfo().getAverageLatency(0).count()));
+    CPPUNIT_ASSERT_EQUAL(uint32_t(0), f.tracker().getNodeInfo().getPendingCount(0));
+}
+
 }
@@ -22,6 +22,7 @@ class SimpleBucketPriorityDatabaseTest : public CppUnit::TestFixture {
     CPPUNIT_TEST(testMultipleSetPriorityForOneBucket);
     CPPUNIT_TEST(testIterateOverMultipleBucketsWithMultiplePriorities);
     CPPUNIT_TEST(testNoMaintenanceNeededClearsBucketFromDatabase);
+    CPPUNIT_TEST(testChangingPriorityKeepsOtherBucketsAtOldPriority);
     CPPUNIT_TEST_SUITE_END();
 
     typedef SimpleBucketPriorityDatabase::const_iterator const_iterator;
@@ -33,6 +34,7 @@ public:
     void testMultipleSetPriorityForOneBucket();
     void testIterateOverMultipleBucketsWithMultiplePriorities();
     void testNoMaintenanceNeededClearsBucketFromDatabase();
+    void testChangingPriorityKeepsOtherBucketsAtOldPriority();
 };
 
 CPPUNIT_TEST_SUITE_REGISTRATION(SimpleBucketPriorityDatabaseTest);
@@ -112,6 +114,24 @@ SimpleBucketPriorityDatabaseTest::testNoMaintenanceNeededClearsBucketFromDatabas
     CPPUNIT_ASSERT(iter == queue.end());
 }
 
+void
+SimpleBucketPriorityDatabaseTest::testChangingPriorityKeepsOtherBucketsAtOldPriority()
+{
+    SimpleBucketPriorityDatabase queue;
+
+    queue.setPriority(PrioritizedBucket(makeDocumentBucket(BucketId(16, 1)), Priority::LOW));
+    queue.setPriority(PrioritizedBucket(makeDocumentBucket(BucketId(16, 2)), Priority::LOW));
+    queue.setPriority(PrioritizedBucket(makeDocumentBucket(BucketId(16, 2)), Priority::VERY_HIGH));
+    queue.setPriority(PrioritizedBucket(makeDocumentBucket(BucketId(16, 2)), Priority::MEDIUM));
+
+    const_iterator iter(queue.begin());
+    CPPUNIT_ASSERT_EQUAL(PrioritizedBucket(makeDocumentBucket(BucketId(16, 2)), Priority::MEDIUM), *iter);
+    ++iter;
+    CPPUNIT_ASSERT_EQUAL(PrioritizedBucket(makeDocumentBucket(BucketId(16, 1)), Priority::LOW), *iter);
+    ++iter;
+    CPPUNIT_ASSERT(iter == queue.end());
+}
+
 void
 SimpleBucketPriorityDatabaseTest::testIterateOverMultipleBucketsWithMultiplePriorities()
 {
@@ -0,0 +1,90 @@
+// Copyright 2019 Oath Inc. Licensed under the terms of the Apache 2.0 license. See LICENSE in the project root.
+
+#include <vespa/storage/distributor/superbucket_ideal_nodes_cache.h>
+#include <vespa/vdslib/distribution/distribution.h>
+#include <vespa/vdslib/state/clusterstate.h>
+#include <vespa/vdstestlib/cppunit/macros.h>
+
+namespace storage {
+namespace distributor {
+
+using document::BucketId;
+
+struct SuperbucketIdealNodesCacheTest : CppUnit::TestFixture {
+    void lookups_are_memoized_within_superbucket();
+    void lookups_match_distribution();
+    void too_few_bits_in_use_is_not_memoized();
+
+    CPPUNIT_TEST_SUITE(SuperbucketIdealNodesCacheTest);
+    CPPUNIT_TEST(lookups_are_memoized_within_superbucket);
+    CPPUNIT_TEST(lookups_match_distribution);
+    CPPUNIT_TEST(too_few_bits_in_use_is_not_memoized);
+    CPPUNIT_TEST_SUITE_END();
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(SuperbucketIdealNodesCacheTest);
+
+namespace {
+
+struct Fixture {
+    lib::Distribution distribution;
+    lib::ClusterState state;
+    SuperbucketIdealNodesCache cache;
+
+    Fixture()
+        : distribution(lib::Distribution::getDefaultDistributionConfig(2, 10)),
+          state("bits:8 distributor:10 storage:10 .3.s:d"),
+          cache(distribution, state, "uim", "uim")
+    {}
+};
+
+}
+
+void
+SuperbucketIdealNodesCacheTest::lookups_are_memoized_within_superbucket()
+{
+    Fixture f;
+    f.cache.getIdealDistributorNode(BucketId(16, 0x1234));
+    f.cache.getIdealDistributorNode(BucketId(17, 0x11234));
+    f.cache.getIdealStorageNodes(BucketId(16, 0x1234));
+    f.cache.getIdealStorageNodes(BucketId(17, 0x11234));
+    CPPUNIT_ASSERT_EQUAL(uint64_t(2), f.cache.getDistributionLookups());
+
+    // New superbucket
+    f.cache.getIdealDistributorNode(BucketId(16, 0x1235));
+    CPPUNIT_ASSERT_EQUAL(uint64_t(3), f.cache.getDistributionLookups());
+
+    // Buckets using more than 33 bits have a storage seed of their own
+    f.cache.getIdealStorageNodes(BucketId(40, 0x1235));
+    f.cache.getIdealStorageNodes(BucketId(40, 0x1235));
+    CPPUNIT_ASSERT_EQUAL(uint64_t(5), f.cache.getDistributionLookups());
+}
+
+void
+SuperbucketIdealNodesCacheTest::lookups_match_distribution()
+{
+    Fixture f;
+    for (uint32_t superbucket = 0; superbucket < 256; ++superbucket) {
+        for (uint32_t bits = 8; bits <= 40; bits += 4) {
+            BucketId bucket(bits, (uint64_t(bits * 0x3b5) << 8) | superbucket);
+            CPPUNIT_ASSERT_EQUAL(f.distribution.getIdealDistributorNode(f.state, bucket, "uim"),
+                                 f.cache.getIdealDistributorNode(bucket));
+            CPPUNIT_ASSERT_EQUAL(f.distribution.getIdealStorageNodes(f.state, bucket, "uim"),
+                                 f.cache.getIdealStorageNodes(bucket));
+        }
+    }
+}
+
+void
+SuperbucketIdealNodesCacheTest::too_few_bits_in_use_is_not_memoized()
+{
+    Fixture f;
+    f.cache.getIdealDistributorNode(BucketId(16, 0x1234));
+    CPPUNIT_ASSERT_THROW(f.cache.getIdealDistributorNode(BucketId(4, 0x4)),
+                         lib::TooFewBucketBitsInUseException);
+    CPPUNIT_ASSERT_THROW(f.cache.getIdealStorageNodes(BucketId(4, 0x4)),
+                         lib::TooFewBucketBitsInUseException);
+}
+
+}
+}
@@ -0,0 +1,148 @@
+// Copyright 2019 Oath Inc. Licensed under the terms of the Apache 2.0 license. See LICENSE in the project root.
+
+#include <tests/common/dummystoragelink.h>
+#include <tests/common/testhelper.h>
+#include <tests/common/teststorageapp.h>
+#include <tests/persistence/filestorage/forwardingmessagesender.h>
+#include <vespa/document/test/make_document_bucket.h>
+#include <vespa/documentapi/loadtypes/loadtypeset.h>
+#include <vespa/storage/persistence/filestorage/filestorhandler.h>
+#include <vespa/storage/persistence/filestorage/filestormetrics.h>
+#include <vespa/storageapi/message/persistence.h>
+#include <vespa/vespalib/util/document_runnable.h>
+#include <vespa/vespalib/util/stringfmt.h>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+using namespace storage;
+using document::test::makeDocumentBucket;
+
+/**
+ * Measures how fast operations can be scheduled to and fetched from the
+ * stripes of a FileStorHandler, with one fetching thread per stripe and a
+ * number of threads scheduling puts to distinct buckets.
+ */
+
+class BucketPusherThread : public document::Runnable {
+private:
+    FileStorHandler&      _handler;
+    document::Document::SP _doc;
+    const uint32_t        _threadIndex;
+    const uint32_t        _count;
+
+public:
+    BucketPusherThread(FileStorHandler& handler, document::Document::SP doc, uint32_t threadIndex, uint32_t count)
+        : _handler(handler), _doc(std::move(doc)), _threadIndex(threadIndex), _count(count)
+    {}
+
+    void run() override {
+        for (uint32_t i = 0; i < _count; ++i) {
+            document::BucketId bucket(16, (_threadIndex << 12) | (i & 0xfff));
+            auto cmd = std::make_shared<api::PutCommand>(makeDocumentBucket(bucket), _doc, i + 1);
+            _handler.schedule(cmd, 0);
+        }
+    }
+};
+
+class StripeDrainingThread : public document::Runnable {
+private:
+    FileStorHandler&        _handler;
+    const uint32_t          _stripeId;
+    std::atomic<uint32_t>&  _totalFetched;
+    const uint32_t          _expected;
+
+public:
+    StripeDrainingThread(FileStorHandler& handler, std::atomic<uint32_t>& totalFetched, uint32_t expected)
+        : _handler(handler), _stripeId(handler.getNextStripeId(0)), _totalFetched(totalFetched),
+          _expected(expected)
+    {}
+
+    void run() override {
+        while (_totalFetched.load() < _expected) {
+            FileStorHandler::LockedMessage msg = _handler.getNextMessage(0, _stripeId);
+            if (msg.second.get()) {
+                _totalFetched++;
+            }
+        }
+    }
+};
+
+double
+benchmark(TestServiceLayerApp& node, uint32_t numStripes, uint32_t numPushers, uint32_t perPusher)
+{
+    DummyStorageLink top;
+    DummyStorageLink *dummyManager;
+    top.push_back(std::unique_ptr<StorageLink>(dummyManager = new DummyStorageLink));
+    top.open();
+    ForwardingMessageSender messageSender(*dummyManager);
+
+    documentapi::LoadTypeSet loadTypes("raw:");
+    FileStorMetrics metrics(loadTypes.getMetricLoadTypes());
+    metrics.initDiskMetrics(node.getPartitions().size(), loadTypes.getMetricLoadTypes(), numStripes, 1);
+    FileStorHandler filestorHandler(numStripes, messageSender, metrics, node.getPartitions(),
+                                    node.getComponentRegister());
+    filestorHandler.setGetNextMessageTimeout(10);
+
+    document::Document::SP doc(node.getTestDocMan().createDocument("Here is some content",
+                                                                   "userdoc:footype:1234:bar").release());
+    std::atomic<uint32_t> totalFetched(0);
+    FastOS_ThreadPool pool(512 * 1024);
+    std::vector<std::unique_ptr<StripeDrainingThread>> fetchers;
+    for (uint32_t i = 0; i < numStripes; ++i) {
+        fetchers.push_back(std::make_unique<StripeDrainingThread>(filestorHandler, totalFetched,
+                                                                  numPushers * perPusher));
+    }
+    std::vector<std::unique_ptr<BucketPusherThread>> pushers;
+    for (uint32_t i = 0; i < numPushers; ++i) {
+        pushers.push_back(std::make_unique<BucketPusherThread>(filestorHandler, doc, i, perPusher));
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    for (auto& fetcher : fetchers) {
+        fetcher->start(pool);
+    }
+    for (auto& pusher : pushers) {
+        pusher->start(pool);
+    }
+    for (auto& pusher : pushers) {
+        pusher->join();
+    }
+    for (auto& fetcher : fetchers) {
+        fetcher->join();
+    }
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    if (totalFetched.load() != numPushers * perPusher) {
+        fprintf(stderr, "expected %u fetched operations, got %u\n", numPushers * perPusher, totalFetched.load());
+        exit(1);
+    }
+    return ms;
+}
+
+int
+main(int argc, char **argv)
+{
+    uint32_t numPushers = (argc > 1) ? atoi(argv[1]) : 4;
+    uint32_t perPusher = (argc > 2) ? atoi(argv[2]) : 20000;
+
+    std::string rootOfRoot = "filestorhandler_benchmark";
+    vdstestlib::DirConfig config(getStandardConfig(true, rootOfRoot));
+    std::string rootFolder = getRootFolder(config);
+    if ((system(vespalib::make_string("rm -rf %s", rootFolder.c_str()).c_str()) != 0) ||
+        (system(vespalib::make_string("mkdir -p %s/disks/d0", rootFolder.c_str()).c_str()) != 0))
+    {
+        fprintf(stderr, "could not create %s\n", rootFolder.c_str());
+        return 1;
+    }
+    TestServiceLayerApp node(DiskCount(1), NodeIndex(0), config.getConfigId());
+    node.setupDummyPersistence();
+
+    uint32_t numOps = numPushers * perPusher;
+    for (uint32_t numStripes : {1, 2, 4, 8}) {
+        double ms = benchmark(node, numStripes, numPushers, perPusher);
+        fprintf(stdout, "stripes=%u pushers=%u: %u operations in %.1f ms (%.0f ops/s)\n",
+                numStripes, numPushers, numOps, ms, (numOps * 1000.0) / ms);
+    }
+    return 0;
+}
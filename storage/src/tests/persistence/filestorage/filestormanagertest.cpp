@@ -21,6 +21,8 @@
 #include <vespa/config/common/exceptions.h>
 #include <vespa/fastos/file.h>
 #include <atomic>
+#include <mutex>
+#include <set>
 
 #include <vespa/log/log.h>
 LOG_SETUP(".filestormanagertest");
@@ -79,6 +81,7 @@ struct FileStorManagerTest : public CppUnit::TestFixture {
     void testHandlerTimeout();
     void testHandlerPause();
     void testHandlerPausedMultiThread();
+    void testHandlerConcurrentScheduleAndFetch();
     void testPriority();
     void testSplit1();
     void testSplitSingleGroup();
@@ -117,6 +120,7 @@ struct FileStorManagerTest : public CppUnit::TestFixture {
     CPPUNIT_TEST(testHandlerTimeout);
     CPPUNIT_TEST(testHandlerPause);
     CPPUNIT_TEST(testHandlerPausedMultiThread);
+    CPPUNIT_TEST(testHandlerConcurrentScheduleAndFetch);
     CPPUNIT_TEST(testPriority);
     CPPUNIT_TEST(testSplit1);
     CPPUNIT_TEST(testSplitSingleGroup);
@@ -780,6 +784,120 @@ FileStorManagerTest::testHandlerPausedMultiThread()
 }
 
 
+namespace {
+
+class BucketPusherThread : public document::Runnable {
+public:
+    FileStorHandler& _handler;
+    Document::SP _doc;
+    const uint32_t _threadIndex;
+    const uint32_t _count;
+
+    BucketPusherThread(FileStorHandler& handler, Document::SP doc, uint32_t threadIndex, uint32_t count)
+        : _handler(handler), _doc(std::move(doc)), _threadIndex(threadIndex), _count(count)
+    {}
+
+    void run() override {
+        for (uint32_t i = 0; i < _count; ++i) {
+            document::BucketId bucket(16, (_threadIndex << 12) | (i & 0xfff));
+            auto cmd = std::make_shared<api::PutCommand>(makeDocumentBucket(bucket), _doc, i + 1);
+            _handler.schedule(cmd, 0);
+        }
+    }
+};
+
+class StripeDrainingThread : public document::Runnable {
+public:
+    FileStorHandler& _handler;
+    const uint32_t _stripeId;
+    std::mutex& _lock;
+    std::set<api::StorageMessage::Id>& _fetched;
+    const uint32_t _expected;
+    std::atomic<uint32_t> _duplicates;
+
+    StripeDrainingThread(FileStorHandler& handler, std::mutex& lock,
+                         std::set<api::StorageMessage::Id>& fetched, uint32_t expected)
+        : _handler(handler), _stripeId(handler.getNextStripeId(0)), _lock(lock), _fetched(fetched),
+          _expected(expected), _duplicates(0)
+    {}
+
+    void run() override {
+        while (true) {
+            FileStorHandler::LockedMessage msg = _handler.getNextMessage(0, _stripeId);
+            std::lock_guard<std::mutex> guard(_lock);
+            if (msg.second.get() && !_fetched.insert(msg.second->getMsgId()).second) {
+                ++_duplicates;
+            }
+            if (_fetched.size() >= _expected) {
+                return;
+            }
+        }
+    }
+};
+
+}
+
+/**
+ * Schedules from several threads while every stripe is fetched from
+ * concurrently, and checks that each message is handed out exactly once.
+ * See filestorhandler_benchmark for a throughput benchmark of the same.
+ */
+void
+FileStorManagerTest::testHandlerConcurrentScheduleAndFetch()
+{
+    TestName testName("testHandlerConcurrentScheduleAndFetch");
+    DummyStorageLink top;
+    DummyStorageLink *dummyManager;
+    top.push_back(std::unique_ptr<StorageLink>(dummyManager = new DummyStorageLink));
+    top.open();
+    ForwardingMessageSender messageSender(*dummyManager);
+
+    documentapi::LoadTypeSet loadTypes("raw:");
+    FileStorMetrics metrics(loadTypes.getMetricLoadTypes());
+    const uint32_t numStripes = 4;
+    metrics.initDiskMetrics(_node->getPartitions().size(), loadTypes.getMetricLoadTypes(), numStripes, 1);
+
+    FileStorHandler filestorHandler(numStripes, messageSender, metrics, _node->getPartitions(),
+                                    _node->getComponentRegister());
+    filestorHandler.setGetNextMessageTimeout(10);
+
+    Document::SP doc(createDocument("Here is some content", "userdoc:footype:1234:bar").release());
+
+    const uint32_t numPushers = 4;
+    const uint32_t perPusher = 500;
+    std::mutex lock;
+    std::set<api::StorageMessage::Id> fetched;
+
+    FastOS_ThreadPool pool(512 * 1024);
+    std::vector<std::unique_ptr<StripeDrainingThread>> fetchers;
+    for (uint32_t i = 0; i < numStripes; ++i) {
+        fetchers.push_back(std::make_unique<StripeDrainingThread>(filestorHandler, lock, fetched,
+                                                                  numPushers * perPusher));
+    }
+    std::vector<std::unique_ptr<BucketPusherThread>> pushers;
+    for (uint32_t i = 0; i < numPushers; ++i) {
+        pushers.push_back(std::make_unique<BucketPusherThread>(filestorHandler, doc, i, perPusher));
+    }
+
+    for (auto& fetcher : fetchers) {
+        fetcher->start(pool);
+    }
+    for (auto& pusher : pushers) {
+        pusher->start(pool);
+    }
+    for (auto& pusher : pushers) {
+        pusher->join();
+    }
+    for (auto& fetcher : fetchers) {
+        fetcher->join();
+        CPPUNIT_ASSERT_EQUAL(0u, fetcher->_duplicates.load());
+    }
+
+    CPPUNIT_ASSERT_EQUAL(size_t(numPushers * perPusher), fetched.size());
+    CPPUNIT_ASSERT_EQUAL(0u, filestorHandler.getQueueSize());
+}
+
+
 void
 FileStorManagerTest::testHandlerPause()
 {
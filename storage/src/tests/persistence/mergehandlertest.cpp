@@ -8,7 +8,9 @@
 #include <tests/distributor/messagesenderstub.h>
 #include <vespa/document/test/make_document_bucket.h>
 #include <vespa/vespalib/objects/nbostream.h>
+#include <vespa/vespalib/util/stringfmt.h>
 #include <cmath>
+#include <set>
 
 #include <vespa/log/log.h>
 LOG_SETUP(".test.persistence.handler.merge");
@@ -50,6 +52,16 @@ struct MergeHandlerTest : public SingleDiskPersistenceTestUtils
         // Test that a simplistic merge with one thing to actually merge,
         // sends correct commands and finish.
     void testMasterMessageFlow();
+        // Test that nodes only list entries within ranges where the range
+        // hashes differ, and fall back to a full diff for nodes not
+        // diffing by range.
+    void testGetBucketDiffByRangeHashesChain(bool midChain);
+    void testGetBucketDiffByRangeHashesMidChain() { testGetBucketDiffByRangeHashesChain(true); }
+    void testGetBucketDiffByRangeHashesEndOfChain() { testGetBucketDiffByRangeHashesChain(false); }
+    void testMasterMessageFlowByRangeHashes();
+    void testMasterFallsBackToFullDiffWithoutRangeHashes();
+    void testHashRangesSpreadDocumentsInSameBucket();
+    void testGetBucketDiffListsOnlyDifferingRange();
         // Test that a simplistic merge with 1 doc to actually merge,
         // sends apply bucket diff through the entire chain of 3 nodes.
     void testApplyBucketDiffChain();
@@ -80,6 +92,12 @@ struct MergeHandlerTest : public SingleDiskPersistenceTestUtils
     CPPUNIT_TEST(testApplyBucketDiffMidChain);
     CPPUNIT_TEST(testApplyBucketDiffEndOfChain);
     CPPUNIT_TEST(testMasterMessageFlow);
+    CPPUNIT_TEST(testGetBucketDiffByRangeHashesMidChain);
+    CPPUNIT_TEST(testGetBucketDiffByRangeHashesEndOfChain);
+    CPPUNIT_TEST(testMasterMessageFlowByRangeHashes);
+    CPPUNIT_TEST(testMasterFallsBackToFullDiffWithoutRangeHashes);
+    CPPUNIT_TEST(testHashRangesSpreadDocumentsInSameBucket);
+    CPPUNIT_TEST(testGetBucketDiffListsOnlyDifferingRange);
     CPPUNIT_TEST(testMergeUnrevertableRemove);
     CPPUNIT_TEST(testChunkedApplyBucketDiff);
     CPPUNIT_TEST(testChunkLimitPartiallyFilledDiff);
@@ -424,6 +442,163 @@ MergeHandlerTest::testMasterMessageFlow()
     CPPUNIT_ASSERT(!fsHandler().isMerging(_bucket));
 }
 
+void
+MergeHandlerTest::testGetBucketDiffByRangeHashesChain(bool midChain)
+{
+    setUpChain(midChain ? MIDDLE : BACK);
+    MergeHandler handler(getPersistenceProvider(), getEnv(),
+                         getEnv()._config.bucketMergeChunkSize, 1);
+
+    // A single range whose hash cannot match our 17 entries.
+    api::GetBucketDiffCommand cmd(_bucket, _nodes, _maxTimestamp);
+    cmd.getRangeHashes().emplace_back(0, false);
+    MessageTracker::UP tracker1 = handler.handleGetBucketDiff(cmd, *_context);
+    api::StorageMessage::SP replySent = tracker1->getReply();
+
+    if (midChain) {
+        CPPUNIT_ASSERT(!replySent.get());
+        auto cmd2 = fetchSingleMessage<api::GetBucketDiffCommand>();
+        // Our metadata is withheld until we know which ranges differ.
+        CPPUNIT_ASSERT_EQUAL(size_t(0), cmd2->getDiff().size());
+        CPPUNIT_ASSERT_EQUAL(size_t(1), cmd2->getRangeHashes().size());
+        CPPUNIT_ASSERT(cmd2->getRangeHashes()[0]._differs);
+
+        api::GetBucketDiffReply::UP reply(new api::GetBucketDiffReply(*cmd2));
+        reply->getRangeHashes() = cmd2->getRangeHashes();
+        MessageSenderStub stub;
+        handler.handleGetBucketDiffReply(*reply, stub);
+        CPPUNIT_ASSERT_EQUAL(1, (int)stub.replies.size());
+        replySent = stub.replies[0];
+    }
+    auto reply2 = std::dynamic_pointer_cast<api::GetBucketDiffReply>(replySent);
+    CPPUNIT_ASSERT(reply2.get());
+    CPPUNIT_ASSERT_EQUAL(size_t(17), reply2->getDiff().size());
+    CPPUNIT_ASSERT_EQUAL(size_t(1), reply2->getRangeHashes().size());
+    CPPUNIT_ASSERT(reply2->getRangeHashes()[0]._differs);
+}
+
+void
+MergeHandlerTest::testMasterMessageFlowByRangeHashes()
+{
+    MergeHandler handler(getPersistenceProvider(), getEnv(),
+                         getEnv()._config.bucketMergeChunkSize, 1);
+
+    api::MergeBucketCommand cmd(_bucket, _nodes, _maxTimestamp);
+    handler.handleMergeBucket(cmd, *_context);
+    auto cmd2 = fetchSingleMessage<api::GetBucketDiffCommand>();
+    CPPUNIT_ASSERT_EQUAL(size_t(0), cmd2->getDiff().size());
+    CPPUNIT_ASSERT_EQUAL(size_t(1), cmd2->getRangeHashes().size());
+    CPPUNIT_ASSERT(!cmd2->getRangeHashes()[0]._differs);
+
+    // The other node has one entry we don't have, and lists all its
+    // entries in the differing range.
+    api::GetBucketDiffReply::UP reply(new api::GetBucketDiffReply(*cmd2));
+    reply->getRangeHashes() = cmd2->getRangeHashes();
+    reply->getRangeHashes()[0]._differs = true;
+    api::GetBucketDiffCommand::Entry e;
+    e._timestamp = _maxTimestamp - 1;
+    e._gid = document::GlobalId("0123456789ab");
+    e._hasMask = 2;
+    reply->getDiff().push_back(e);
+
+    handler.handleGetBucketDiffReply(*reply, messageKeeper());
+
+    // None of our entries are known to be on the other node.
+    CPPUNIT_ASSERT_EQUAL(size_t(18), fsHandler().editMergeStatus(_bucket).diff.size());
+    CPPUNIT_ASSERT_EQUAL(api::MessageType::APPLYBUCKETDIFF,
+                         messageKeeper()._msgs.back()->getType());
+}
+
+void
+MergeHandlerTest::testMasterFallsBackToFullDiffWithoutRangeHashes()
+{
+    MergeHandler handler(getPersistenceProvider(), getEnv(),
+                         getEnv()._config.bucketMergeChunkSize, 1);
+
+    api::MergeBucketCommand cmd(_bucket, _nodes, _maxTimestamp);
+    handler.handleMergeBucket(cmd, *_context);
+    auto cmd2 = fetchSingleMessage<api::GetBucketDiffCommand>();
+    CPPUNIT_ASSERT_EQUAL(size_t(1), cmd2->getRangeHashes().size());
+
+    // A node not diffing by range replies with all its entries and no hashes.
+    // Here it has all the entries we have, so there is nothing to merge.
+    std::vector<api::GetBucketDiffCommand::Entry> local;
+    handler.buildBucketInfoList(spi::Bucket(_bucket, spi::PartitionId(0)),
+                                documentapi::LoadType::DEFAULT,
+                                Timestamp(_maxTimestamp), 1, local, *_context);
+    api::GetBucketDiffReply::UP reply(new api::GetBucketDiffReply(*cmd2));
+    reply->getDiff() = local;
+
+    MessageSenderStub stub;
+    handler.handleGetBucketDiffReply(*reply, stub);
+
+    CPPUNIT_ASSERT_EQUAL(1, (int)stub.replies.size());
+    auto mergeReply = std::dynamic_pointer_cast<api::MergeBucketReply>(stub.replies[0]);
+    CPPUNIT_ASSERT(mergeReply.get());
+    CPPUNIT_ASSERT(mergeReply->getResult().success());
+    CPPUNIT_ASSERT(!fsHandler().isMerging(_bucket));
+}
+
+void
+MergeHandlerTest::testHashRangesSpreadDocumentsInSameBucket()
+{
+    // Documents of the same bucket share the location part of their gids.
+    const uint32_t rangeCount = 64;
+    std::set<uint32_t> ranges;
+    for (uint32_t i = 0; i < 256; ++i) {
+        document::DocumentId id(vespalib::make_string(
+                "id:mail:testdoctype1:n=%u:%u", _location, i));
+        ranges.insert(MergeHandler::hashRangeOf(id.getGlobalId(), rangeCount));
+    }
+    CPPUNIT_ASSERT(ranges.size() > rangeCount / 2);
+}
+
+void
+MergeHandlerTest::testGetBucketDiffListsOnlyDifferingRange()
+{
+    setUpChain(BACK);
+    MergeHandler handler(getPersistenceProvider(), getEnv(),
+                         getEnv()._config.bucketMergeChunkSize, 1);
+
+    std::vector<api::GetBucketDiffCommand::Entry> local;
+    handler.buildBucketInfoList(spi::Bucket(_bucket, spi::PartitionId(0)),
+                                documentapi::LoadType::DEFAULT,
+                                Timestamp(_maxTimestamp), 1, local, *_context);
+    CPPUNIT_ASSERT_EQUAL(size_t(17), local.size());
+
+    const uint32_t rangeCount = 8;
+    std::set<uint32_t> ranges;
+    for (const auto& e : local) {
+        ranges.insert(MergeHandler::hashRangeOf(e._gid, rangeCount));
+    }
+    CPPUNIT_ASSERT(ranges.size() > 1);
+
+    // Make the sender's view of a single range differ from ours.
+    uint32_t differing = MergeHandler::hashRangeOf(local[0]._gid, rangeCount);
+    api::GetBucketDiffCommand cmd(_bucket, _nodes, _maxTimestamp);
+    cmd.getRangeHashes() = MergeHandler::computeRangeHashes(local, rangeCount);
+    cmd.getRangeHashes()[differing]._hash += 1;
+    MessageTracker::UP tracker = handler.handleGetBucketDiff(cmd, *_context);
+
+    auto reply = std::dynamic_pointer_cast<api::GetBucketDiffReply>(tracker->getReply());
+    CPPUNIT_ASSERT(reply.get());
+    CPPUNIT_ASSERT_EQUAL(size_t(rangeCount), reply->getRangeHashes().size());
+    for (uint32_t i = 0; i < rangeCount; ++i) {
+        CPPUNIT_ASSERT_EQUAL(i == differing, reply->getRangeHashes()[i]._differs);
+    }
+    size_t expected = 0;
+    for (const auto& e : local) {
+        if (MergeHandler::hashRangeOf(e._gid, rangeCount) == differing) {
+            ++expected;
+        }
+    }
+    CPPUNIT_ASSERT(expected < local.size());
+    CPPUNIT_ASSERT_EQUAL(expected, reply->getDiff().size());
+    for (const auto& e : reply->getDiff()) {
+        CPPUNIT_ASSERT_EQUAL(differing, MergeHandler::hashRangeOf(e._gid, rangeCount));
+    }
+}
+
 void
 MergeHandlerTest::testMergeUnrevertableRemove()
 {
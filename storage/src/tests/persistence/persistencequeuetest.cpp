@@ -3,6 +3,7 @@
 #include <vespa/log/log.h>
 #include <vespa/vdstestlib/cppunit/macros.h>
 #include <vespa/storageapi/message/bucket.h>
+#include <vespa/storageapi/message/persistence.h>
 #include <tests/persistence/common/persistenceproviderwrapper.h>
 #include <vespa/persistence/dummyimpl/dummypersistence.h>
 #include <tests/persistence/common/filestortestfixture.h>
@@ -23,6 +24,8 @@ public:
     void shared_locked_operation_not_started_if_exclusive_op_active();
     void exclusive_locked_operation_not_started_if_exclusive_op_active();
     void operation_batching_not_allowed_across_different_lock_modes();
+    void batch_takes_queued_operations_for_locked_bucket_in_queue_order();
+    void batch_stops_at_operation_not_accepted_by_filter();
 
     std::shared_ptr<api::StorageMessage> createPut(uint64_t bucket, uint64_t docIdx);
     std::shared_ptr<api::StorageMessage> createGet(uint64_t bucket) const;
@@ -36,6 +39,8 @@ public:
     CPPUNIT_TEST(shared_locked_operation_not_started_if_exclusive_op_active);
     CPPUNIT_TEST(exclusive_locked_operation_not_started_if_exclusive_op_active);
     CPPUNIT_TEST(operation_batching_not_allowed_across_different_lock_modes);
+    CPPUNIT_TEST(batch_takes_queued_operations_for_locked_bucket_in_queue_order);
+    CPPUNIT_TEST(batch_stops_at_operation_not_accepted_by_filter);
     CPPUNIT_TEST_SUITE_END();
 
     struct Fixture {
@@ -201,4 +206,71 @@ void PersistenceQueueTest::operation_batching_not_allowed_across_different_lock_
     CPPUNIT_ASSERT(!lock0.second);
 }
 
+namespace {
+
+bool isPut(const api::StorageMessage& msg) {
+    return (msg.getType().getId() == api::MessageType::PUT_ID);
+}
+
+vespalib::string batchedDocIds(const std::vector<std::shared_ptr<api::StorageMessage>>& batch) {
+    vespalib::string ids;
+    for (const auto& msg : batch) {
+        ids += dynamic_cast<api::PutCommand&>(*msg).getDocumentId().toString() + " ";
+    }
+    return ids;
+}
+
+}
+
+void PersistenceQueueTest::batch_takes_queued_operations_for_locked_bucket_in_queue_order() {
+    Fixture f(*this);
+
+    f.filestorHandler->schedule(createPut(1234, 0), _disk);
+    f.filestorHandler->schedule(createPut(1234, 1), _disk);
+    f.filestorHandler->schedule(createPut(5432, 0), _disk);
+    f.filestorHandler->schedule(createPut(1234, 2), _disk);
+    f.filestorHandler->schedule(createPut(1234, 3), _disk);
+
+    auto lock0 = f.filestorHandler->getNextMessage(_disk, f.stripeId);
+    CPPUNIT_ASSERT(lock0.second);
+    std::vector<std::shared_ptr<api::StorageMessage>> batch;
+    batch.push_back(lock0.second);
+    f.filestorHandler->getNextBatch(_disk, f.stripeId, lock0, isPut, 3, batch);
+    CPPUNIT_ASSERT_EQUAL(vespalib::string("id:foo:testdoctype1:n=1234:0 id:foo:testdoctype1:n=1234:1 "
+                                          "id:foo:testdoctype1:n=1234:2 "),
+                         batchedDocIds(batch));
+
+    // The remaining operation for the bucket is left in the queue.
+    f.filestorHandler->getNextMessage(_disk, f.stripeId, lock0);
+    CPPUNIT_ASSERT(lock0.second);
+    CPPUNIT_ASSERT_EQUAL(vespalib::string("id:foo:testdoctype1:n=1234:3"),
+                         dynamic_cast<api::PutCommand&>(*lock0.second).getDocumentId().toString());
+    f.filestorHandler->getNextMessage(_disk, f.stripeId, lock0);
+    CPPUNIT_ASSERT(!lock0.second);
+}
+
+void PersistenceQueueTest::batch_stops_at_operation_not_accepted_by_filter() {
+    Fixture f(*this);
+
+    f.filestorHandler->schedule(createPut(1234, 0), _disk);
+    f.filestorHandler->schedule(createPut(1234, 1), _disk);
+    auto remove = std::make_shared<api::RemoveCommand>(
+            makeDocumentBucket(document::BucketId(16, 1234)),
+            document::DocumentId("id:foo:testdoctype1:n=1234:0"), 1235);
+    remove->setAddress(makeSelfAddress());
+    f.filestorHandler->schedule(remove, _disk);
+    f.filestorHandler->schedule(createPut(1234, 2), _disk);
+
+    auto lock0 = f.filestorHandler->getNextMessage(_disk, f.stripeId);
+    CPPUNIT_ASSERT(lock0.second);
+    std::vector<std::shared_ptr<api::StorageMessage>> batch;
+    batch.push_back(lock0.second);
+    f.filestorHandler->getNextBatch(_disk, f.stripeId, lock0, isPut, 64, batch);
+    CPPUNIT_ASSERT_EQUAL(size_t(2), batch.size());
+
+    f.filestorHandler->getNextMessage(_disk, f.stripeId, lock0);
+    CPPUNIT_ASSERT(lock0.second);
+    CPPUNIT_ASSERT_EQUAL(api::MessageType::REMOVE_ID, lock0.second->getType().getId());
+}
+
 } // namespace storage
@@ -0,0 +1,123 @@
+// Copyright 2019 Oath Inc. Licensed under the terms of the Apache 2.0 license. See LICENSE in the project root.
+
+#include <vespa/vdstestlib/cppunit/macros.h>
+#include <vespa/storage/visiting/adaptive_pending_window.h>
+#include <vector>
+
+namespace storage {
+
+class AdaptivePendingWindowTest : public CppUnit::TestFixture
+{
+    CPPUNIT_TEST_SUITE(AdaptivePendingWindowTest);
+    CPPUNIT_TEST(windowStartsAtMaxSize);
+    CPPUNIT_TEST(windowNeverLessThanOneMessage);
+    CPPUNIT_TEST(busyReplyHalvesWindow);
+    CPPUNIT_TEST(burstOfBusyRepliesHalvesWindowOnce);
+    CPPUNIT_TEST(windowGrowsByOneForEachFullWindowOfSuccessfulReplies);
+    CPPUNIT_TEST(windowDoesNotGrowBeyondMaxSize);
+    CPPUNIT_TEST(settingMaxSizeResetsWindow);
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    void windowStartsAtMaxSize();
+    void windowNeverLessThanOneMessage();
+    void busyReplyHalvesWindow();
+    void burstOfBusyRepliesHalvesWindowOnce();
+    void windowGrowsByOneForEachFullWindowOfSuccessfulReplies();
+    void windowDoesNotGrowBeyondMaxSize();
+    void settingMaxSizeResetsWindow();
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(AdaptivePendingWindowTest);
+
+void
+AdaptivePendingWindowTest::windowStartsAtMaxSize()
+{
+    AdaptivePendingWindow window(32);
+    CPPUNIT_ASSERT_EQUAL(uint32_t(32), window.size());
+    CPPUNIT_ASSERT_EQUAL(uint32_t(32), window.maxSize());
+}
+
+void
+AdaptivePendingWindowTest::windowNeverLessThanOneMessage()
+{
+    AdaptivePendingWindow window(0);
+    CPPUNIT_ASSERT_EQUAL(uint32_t(1), window.size());
+    window.onBusyReply(window.onSend());
+    CPPUNIT_ASSERT_EQUAL(uint32_t(1), window.size());
+}
+
+void
+AdaptivePendingWindowTest::busyReplyHalvesWindow()
+{
+    AdaptivePendingWindow window(32);
+    window.onBusyReply(window.onSend());
+    CPPUNIT_ASSERT_EQUAL(uint32_t(16), window.size());
+    window.onBusyReply(window.onSend());
+    CPPUNIT_ASSERT_EQUAL(uint32_t(8), window.size());
+}
+
+void
+AdaptivePendingWindowTest::burstOfBusyRepliesHalvesWindowOnce()
+{
+    AdaptivePendingWindow window(32);
+    std::vector<uint64_t> sent;
+    for (uint32_t i = 0; i < 32; ++i) {
+        sent.push_back(window.onSend());
+    }
+    // A client bouncing several messages of the same window only counts once.
+    for (uint32_t i = 0; i < 8; ++i) {
+        window.onBusyReply(sent[i]);
+        CPPUNIT_ASSERT_EQUAL(uint32_t(16), window.size());
+    }
+    // Messages sent after the decrease may shrink the window again.
+    uint64_t next = window.onSend();
+    window.onBusyReply(sent[8]);
+    CPPUNIT_ASSERT_EQUAL(uint32_t(16), window.size());
+    window.onBusyReply(next);
+    CPPUNIT_ASSERT_EQUAL(uint32_t(8), window.size());
+    window.onBusyReply(next);
+    CPPUNIT_ASSERT_EQUAL(uint32_t(8), window.size());
+}
+
+void
+AdaptivePendingWindowTest::windowGrowsByOneForEachFullWindowOfSuccessfulReplies()
+{
+    AdaptivePendingWindow window(8);
+    window.onBusyReply(window.onSend());
+    CPPUNIT_ASSERT_EQUAL(uint32_t(4), window.size());
+    for (uint32_t i = 0; i < 3; ++i) {
+        window.onSuccessfulReply();
+    }
+    CPPUNIT_ASSERT_EQUAL(uint32_t(4), window.size());
+    window.onSuccessfulReply();
+    CPPUNIT_ASSERT_EQUAL(uint32_t(5), window.size());
+    for (uint32_t i = 0; i < 5; ++i) {
+        window.onSuccessfulReply();
+    }
+    CPPUNIT_ASSERT_EQUAL(uint32_t(6), window.size());
+}
+
+void
+AdaptivePendingWindowTest::windowDoesNotGrowBeyondMaxSize()
+{
+    AdaptivePendingWindow window(2);
+    window.onBusyReply(window.onSend());
+    CPPUNIT_ASSERT_EQUAL(uint32_t(1), window.size());
+    for (uint32_t i = 0; i < 10; ++i) {
+        window.onSuccessfulReply();
+    }
+    CPPUNIT_ASSERT_EQUAL(uint32_t(2), window.size());
+}
+
+void
+AdaptivePendingWindowTest::settingMaxSizeResetsWindow()
+{
+    AdaptivePendingWindow window(8);
+    window.onBusyReply(window.onSend());
+    window.setMaxSize(16);
+    CPPUNIT_ASSERT_EQUAL(uint32_t(16), window.size());
+    CPPUNIT_ASSERT_EQUAL(uint32_t(16), window.maxSize());
+}
+
+} // storage
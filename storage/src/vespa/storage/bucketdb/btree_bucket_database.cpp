@@ -0,0 +1,537 @@
+// Copyright 2019 Oath Inc. Licensed under the terms of the Apache 2.0 license. See LICENSE in the project root.
+
+#include "btree_bucket_database.h"
+#include <vespa/searchlib/btree/btreebuilder.hpp>
+#include <vespa/searchlib/btree/btreeinserter.hpp>
+#include <vespa/searchlib/btree/btreenodeallocator.hpp>
+#include <vespa/searchlib/btree/btreenode.hpp>
+#include <vespa/searchlib/btree/btreenodestore.hpp>
+#include <vespa/searchlib/btree/btreeiterator.hpp>
+#include <vespa/searchlib/btree/btreeremover.hpp>
+#include <vespa/searchlib/btree/btreeroot.hpp>
+#include <vespa/searchlib/btree/btree.hpp>
+#include <vespa/searchlib/datastore/array_store.hpp>
+#include <vespa/vespalib/util/optimized.h>
+#include <algorithm>
+#include <cassert>
+#include <ostream>
+
+using document::BucketId;
+using search::datastore::EntryRef;
+using vespalib::ConstArrayRef;
+
+namespace storage {
+
+namespace {
+
+constexpr uint32_t max_small_replica_array_size = 128;
+constexpr size_t small_page_size = 4 * 1024;
+constexpr size_t min_arrays_for_new_buffer = 8 * 1024;
+constexpr float alloc_grow_factor = 0.2;
+
+search::datastore::ArrayStoreConfig
+make_replica_store_config()
+{
+    return search::datastore::ArrayStore<BucketCopy>::optimizedConfigForHugePage(
+            max_small_replica_array_size,
+            vespalib::alloc::MemoryAllocator::HUGEPAGE_SIZE,
+            small_page_size,
+            min_arrays_for_new_buffer,
+            alloc_grow_factor);
+}
+
+EntryRef
+entry_ref_from_value(uint64_t value)
+{
+    return EntryRef(value & 0xffffffffULL);
+}
+
+uint32_t
+gc_timestamp_from_value(uint64_t value)
+{
+    return (value >> 32u);
+}
+
+uint64_t
+value_from(uint32_t gc_timestamp, EntryRef ref)
+{
+    return ((uint64_t(gc_timestamp) << 32u) | ref.ref());
+}
+
+/**
+ * Returns the number of leading bucket bits (counted in bucket key order)
+ * that a and b have in common, never more than the bits used by either.
+ */
+uint32_t
+common_prefix_bits(const BucketId& a, const BucketId& b)
+{
+    const uint32_t min_bits = std::min(a.getUsedBits(), b.getUsedBits());
+    const uint64_t diff = (a.getRawId() ^ b.getRawId());
+    if (diff == 0) {
+        return min_bits;
+    }
+    return std::min(static_cast<uint32_t>(vespalib::Optimized::lsbIdx(diff)), min_bits);
+}
+
+/**
+ * Returns the largest key that any bucket contained in the given bucket
+ * (including itself) may have.
+ */
+uint64_t
+subtree_end_key(const BucketId& bucket)
+{
+    const uint32_t bits = bucket.getUsedBits();
+    if (bits == 0) {
+        return UINT64_MAX;
+    }
+    return (bucket.toKey() | ((1ULL << (64 - bits)) - 1));
+}
+
+/*
+ * The read operations below are shared between the writer, which reads the
+ * mutable tree directly, and ReadGuard readers, which only ever see a frozen
+ * view of the tree. TreeView is either the BTree itself or its FrozenView.
+ *
+ * Buckets are ordered by bucket key, which is a pre-order traversal of the
+ * implicit bucket split tree: a bucket sorts directly before all buckets it
+ * contains, and those buckets form a contiguous key range.
+ */
+
+template <typename TreeView, typename Decoder>
+BucketDatabase::Entry
+find_entry(const TreeView& tree, const Decoder& decode, const BucketId& bucket)
+{
+    auto iter = tree.find(bucket.toKey());
+    if (!iter.valid()) {
+        return BucketDatabase::Entry::createInvalid();
+    }
+    return decode(iter.getKey(), iter.getData());
+}
+
+template <typename TreeView, typename Decoder>
+void
+find_parents_and_self(const TreeView& tree, const Decoder& decode, const BucketId& bucket,
+                      std::vector<BucketDatabase::Entry>& entries)
+{
+    const uint32_t used_bits = bucket.getUsedBits();
+    uint32_t bits = BucketId::minNumBits;
+    while (bits <= used_bits) {
+        const BucketId candidate(bits, bucket.getRawId());
+        auto iter = tree.lowerBound(candidate.toKey());
+        if (!iter.valid()) {
+            break;
+        }
+        const BucketId found(BucketId::keyToBucketId(iter.getKey()));
+        if (found.contains(bucket)) {
+            entries.emplace_back(decode(iter.getKey(), iter.getData()));
+            bits = found.getUsedBits() + 1;
+        } else {
+            // No key exists between the candidate and the found bucket, so
+            // no parent can exist before the level where they diverge.
+            bits = std::max(bits, common_prefix_bits(found, bucket)) + 1;
+        }
+    }
+}
+
+template <typename TreeView, typename Decoder>
+void
+find_parents_self_and_children(const TreeView& tree, const Decoder& decode, const BucketId& bucket,
+                               std::vector<BucketDatabase::Entry>& entries)
+{
+    find_parents_and_self(tree, decode, bucket, entries);
+    auto iter = tree.upperBound(bucket.toKey());
+    for (; iter.valid(); ++iter) {
+        const BucketId found(BucketId::keyToBucketId(iter.getKey()));
+        if (!bucket.contains(found)) {
+            break;
+        }
+        entries.emplace_back(decode(iter.getKey(), iter.getData()));
+    }
+}
+
+template <typename Iterator, typename Decoder>
+void
+for_each_from(Iterator iter, const Decoder& decode, BucketDatabase::EntryProcessor& proc)
+{
+    for (; iter.valid(); ++iter) {
+        const BucketDatabase::Entry entry(decode(iter.getKey(), iter.getData()));
+        if (!proc.process(entry)) {
+            break;
+        }
+    }
+}
+
+BucketDatabase::Entry
+decode_entry(const search::datastore::ArrayStore<BucketCopy>& store, uint64_t key, uint64_t value)
+{
+    const auto replicas = store.get(entry_ref_from_value(value));
+    return BucketDatabase::Entry(BucketId(BucketId::keyToBucketId(key)),
+                                 BucketInfo(gc_timestamp_from_value(value),
+                                            std::vector<BucketCopy>(replicas.begin(), replicas.end())));
+}
+
+}
+
+BTreeBucketDatabase::BTreeBucketDatabase()
+    : _tree(),
+      _store(make_replica_store_config()),
+      _generation_handler(),
+      _uncommitted_changes(0)
+{
+}
+
+BTreeBucketDatabase::~BTreeBucketDatabase() = default;
+
+BucketDatabase::Entry
+BTreeBucketDatabase::entry_from_value(uint64_t key, uint64_t value) const
+{
+    return decode_entry(_store, key, value);
+}
+
+uint64_t
+BTreeBucketDatabase::value_from_entry(const Entry& entry)
+{
+    const auto& replicas = entry.getBucketInfo().getRawNodes();
+    const EntryRef ref = _store.add(ConstArrayRef<BucketCopy>(replicas.data(), replicas.size()));
+    return value_from(entry.getBucketInfo().getLastGarbageCollectionTime(), ref);
+}
+
+void
+BTreeBucketDatabase::release_value(uint64_t value)
+{
+    // Memory is put on hold until no readers can observe the old value.
+    _store.remove(entry_ref_from_value(value));
+}
+
+void
+BTreeBucketDatabase::commit_tree_changes()
+{
+    // Freezing publishes the new tree root to readers acquiring a guard for
+    // the next generation. Anything removed before the freeze is held until
+    // all readers of older generations are gone.
+    _tree.getAllocator().freeze();
+    const auto current_gen = _generation_handler.getCurrentGeneration();
+    _store.transferHoldLists(current_gen);
+    _tree.getAllocator().transferHoldLists(current_gen);
+    _generation_handler.incGeneration();
+    const auto used_gen = _generation_handler.getFirstUsedGeneration();
+    _store.trimHoldLists(used_gen);
+    _tree.getAllocator().trimHoldLists(used_gen);
+    _uncommitted_changes = 0;
+}
+
+void
+BTreeBucketDatabase::single_entry_changed()
+{
+    // Freezing the tree and cycling the generation for every single entry
+    // costs more than the change itself, so they are committed in batches.
+    if (++_uncommitted_changes >= max_uncommitted_changes) {
+        commit_tree_changes();
+    }
+}
+
+void
+BTreeBucketDatabase::commit_pending_changes()
+{
+    if (_uncommitted_changes > 0) {
+        commit_tree_changes();
+    }
+}
+
+std::unique_ptr<BTreeBucketDatabase::ReadGuard>
+BTreeBucketDatabase::acquire_read_guard() const
+{
+    return std::make_unique<ReadGuard>(*this);
+}
+
+BucketDatabase::Entry
+BTreeBucketDatabase::get(const BucketId& bucket) const
+{
+    auto decode = [this](uint64_t key, uint64_t value) { return entry_from_value(key, value); };
+    return find_entry(_tree, decode, bucket);
+}
+
+void
+BTreeBucketDatabase::remove(const BucketId& bucket)
+{
+    auto iter = _tree.find(bucket.toKey());
+    if (!iter.valid()) {
+        return;
+    }
+    release_value(iter.getData());
+    _tree.remove(iter);
+    single_entry_changed();
+}
+
+void
+BTreeBucketDatabase::getParents(const BucketId& childBucket, std::vector<Entry>& entries) const
+{
+    auto decode = [this](uint64_t key, uint64_t value) { return entry_from_value(key, value); };
+    find_parents_and_self(_tree, decode, childBucket, entries);
+}
+
+void
+BTreeBucketDatabase::getAll(const BucketId& bucket, std::vector<Entry>& entries) const
+{
+    auto decode = [this](uint64_t key, uint64_t value) { return entry_from_value(key, value); };
+    find_parents_self_and_children(_tree, decode, bucket, entries);
+}
+
+void
+BTreeBucketDatabase::update(const Entry& newEntry)
+{
+    assert(newEntry.valid());
+    const uint64_t key = newEntry.getBucketId().toKey();
+    const uint64_t new_value = value_from_entry(newEntry);
+    auto iter = _tree.lowerBound(key);
+    if (iter.valid() && (iter.getKey() == key)) {
+        release_value(iter.getData());
+        _tree.thaw(iter);
+        iter.writeData(new_value);
+    } else {
+        _tree.insert(iter, key, new_value);
+    }
+    single_entry_changed();
+}
+
+void
+BTreeBucketDatabase::forEach(EntryProcessor& proc, const BucketId& after) const
+{
+    auto decode = [this](uint64_t key, uint64_t value) { return entry_from_value(key, value); };
+    for_each_from(_tree.upperBound(after.toKey()), decode, proc);
+}
+
+void
+BTreeBucketDatabase::forEach(MutableEntryProcessor& proc, const BucketId& after)
+{
+    bool changed = false;
+    for (auto iter = _tree.upperBound(after.toKey()); iter.valid(); ++iter) {
+        const Entry original(entry_from_value(iter.getKey(), iter.getData()));
+        Entry entry(original);
+        const bool more = proc.process(entry);
+        if (!(entry == original)) {
+            assert(entry.getBucketId() == original.getBucketId());
+            const uint64_t new_value = value_from_entry(entry);
+            release_value(iter.getData());
+            _tree.thaw(iter);
+            iter.writeData(new_value);
+            changed = true;
+        }
+        if (!more) {
+            break;
+        }
+    }
+    if (changed) {
+        commit_tree_changes();
+    }
+}
+
+BucketDatabase::Entry
+BTreeBucketDatabase::upperBound(const BucketId& value) const
+{
+    auto iter = _tree.upperBound(value.toKey());
+    if (!iter.valid()) {
+        return Entry::createInvalid();
+    }
+    return entry_from_value(iter.getKey(), iter.getData());
+}
+
+namespace {
+
+struct CollectingInserter : BucketDatabase::Merger::TrailingInserter {
+    std::vector<BucketDatabase::Entry> _entries;
+
+    void insert_at_end(const BucketDatabase::Entry& e) override {
+        _entries.push_back(e);
+    }
+};
+
+}
+
+void
+BTreeBucketDatabase::merge(Merger& merger)
+{
+    // Build the resulting tree from scratch in a single ordered pass instead
+    // of changing the existing tree in place. Readers keep seeing the old
+    // tree until the new one is committed.
+    BTree::Builder builder(_tree.getAllocator());
+    for (auto iter = _tree.begin(); iter.valid(); ++iter) {
+        const uint64_t key = iter.getKey();
+        const uint64_t value = iter.getData();
+        Entry entry(entry_from_value(key, value));
+        switch (merger.merge(entry)) {
+        case Merger::Result::Update:
+            assert(entry.getBucketId().toKey() == key);
+            release_value(value);
+            builder.insert(key, value_from_entry(entry));
+            break;
+        case Merger::Result::KeepUnchanged:
+            builder.insert(key, value);
+            break;
+        case Merger::Result::Skip:
+            release_value(value);
+            break;
+        }
+    }
+    _tree.assign(builder);
+
+    CollectingInserter inserter;
+    merger.insert_remaining_at_end(inserter);
+    std::sort(inserter._entries.begin(), inserter._entries.end(),
+              [](const Entry& lhs, const Entry& rhs) {
+                  return (lhs.getBucketId().toKey() < rhs.getBucketId().toKey());
+              });
+    for (const auto& entry : inserter._entries) {
+        const uint64_t key = entry.getBucketId().toKey();
+        const uint64_t new_value = value_from_entry(entry);
+        auto iter = _tree.lowerBound(key);
+        if (iter.valid() && (iter.getKey() == key)) {
+            release_value(iter.getData());
+            _tree.thaw(iter);
+            iter.writeData(new_value);
+        } else {
+            _tree.insert(iter, key, new_value);
+        }
+    }
+    commit_tree_changes();
+}
+
+uint64_t
+BTreeBucketDatabase::size() const
+{
+    return _tree.size();
+}
+
+void
+BTreeBucketDatabase::clear()
+{
+    for (auto iter = _tree.begin(); iter.valid(); ++iter) {
+        release_value(iter.getData());
+    }
+    _tree.clear();
+    commit_tree_changes();
+}
+
+/*
+ * The appropriate bucket is the given bucket with enough used bits that it
+ * does not overlap any buckets in the database that diverge from it. The
+ * bucket that diverges from it at the deepest level is either the closest
+ * preceding bucket that is not one of its parents, or the first bucket after
+ * its own subtree.
+ */
+BucketId
+BTreeBucketDatabase::getAppropriateBucket(uint16_t minBits, const BucketId& bid)
+{
+    uint32_t bits = minBits;
+    auto iter = _tree.lowerBound(bid.toKey());
+    auto pred = iter;
+    for (--pred; pred.valid(); --pred) {
+        const BucketId found(BucketId::keyToBucketId(pred.getKey()));
+        if (!found.contains(bid)) {
+            bits = std::max(bits, common_prefix_bits(found, bid) + 1);
+            break;
+        }
+    }
+    auto succ = _tree.upperBound(subtree_end_key(bid));
+    if (succ.valid()) {
+        const BucketId found(BucketId::keyToBucketId(succ.getKey()));
+        bits = std::max(bits, common_prefix_bits(found, bid) + 1);
+    }
+    return BucketId(bits, bid.getRawId());
+}
+
+uint32_t
+BTreeBucketDatabase::childCount(const BucketId& bucket) const
+{
+    const uint32_t bits = bucket.getUsedBits();
+    if (bits >= BucketId::maxNumBits) {
+        return 0;
+    }
+    uint32_t count = 0;
+    for (uint64_t bit : {0ULL, 1ULL}) {
+        const BucketId child(bits + 1, bucket.getId() | (bit << bits));
+        auto iter = _tree.lowerBound(child.toKey());
+        if (iter.valid() && child.contains(BucketId(BucketId::keyToBucketId(iter.getKey())))) {
+            ++count;
+        }
+    }
+    return count;
+}
+
+namespace {
+
+struct Writer : public BucketDatabase::EntryProcessor {
+    std::ostream& _ost;
+    explicit Writer(std::ostream& ost) : _ost(ost) {}
+    bool process(const BucketDatabase::Entry& e) override {
+        _ost << e.toString() << "\n";
+        return true;
+    }
+};
+
+}
+
+void
+BTreeBucketDatabase::print(std::ostream& out, bool verbose, const std::string& indent) const
+{
+    (void) indent;
+    if (verbose) {
+        Writer writer(out);
+        forEach(writer);
+    } else {
+        out << "BTreeBucketDatabase(" << size() << " buckets)";
+    }
+}
+
+search::MemoryUsage
+BTreeBucketDatabase::getMemoryUsage() const
+{
+    search::MemoryUsage usage = _tree.getMemoryUsage();
+    usage.merge(_store.getMemoryUsage());
+    return usage;
+}
+
+BTreeBucketDatabase::ReadGuard::ReadGuard(const BTreeBucketDatabase& db)
+    : _guard(db._generation_handler.takeGuard()),
+      _frozen_view(db._tree.getFrozenView()),
+      _store(db._store)
+{
+}
+
+BTreeBucketDatabase::ReadGuard::~ReadGuard() = default;
+
+BucketDatabase::Entry
+BTreeBucketDatabase::ReadGuard::get(const BucketId& bucket) const
+{
+    auto decode = [this](uint64_t key, uint64_t value) { return decode_entry(_store, key, value); };
+    return find_entry(_frozen_view, decode, bucket);
+}
+
+void
+BTreeBucketDatabase::ReadGuard::getParents(const BucketId& childBucket, std::vector<Entry>& entries) const
+{
+    auto decode = [this](uint64_t key, uint64_t value) { return decode_entry(_store, key, value); };
+    find_parents_and_self(_frozen_view, decode, childBucket, entries);
+}
+
+void
+BTreeBucketDatabase::ReadGuard::getAll(const BucketId& bucket, std::vector<Entry>& entries) const
+{
+    auto decode = [this](uint64_t key, uint64_t value) { return decode_entry(_store, key, value); };
+    find_parents_self_and_children(_frozen_view, decode, bucket, entries);
+}
+
+void
+BTreeBucketDatabase::ReadGuard::forEach(EntryProcessor& proc, const BucketId& after) const
+{
+    auto decode = [this](uint64_t key, uint64_t value) { return decode_entry(_store, key, value); };
+    for_each_from(_frozen_view.upperBound(after.toKey()), decode, proc);
+}
+
+uint64_t
+BTreeBucketDatabase::ReadGuard::size() const
+{
+    return _frozen_view.size();
+}
+
+}
@@ -0,0 +1,100 @@
+// Copyright 2019 Oath Inc. Licensed under the terms of the Apache 2.0 license. See LICENSE in the project root.
+#pragma once
+
+#include "bucketdatabase.h"
+#include <vespa/searchlib/btree/btree.h>
+#include <vespa/searchlib/datastore/array_store.h>
+#include <vespa/vespalib/util/generationhandler.h>
+
+namespace storage {
+
+/**
+ * Bucket database implementation built around a B-tree keyed on the bucket
+ * key (i.e. the bucket id in reversed bit order), with the bucket replicas
+ * stored in a separate array store. The B-tree and array store are generation
+ * handled, which means that readers running in other threads than the owner
+ * of the database may acquire a ReadGuard and read a consistent snapshot of
+ * the database without taking any locks and without blocking the writer.
+ *
+ * All the BucketDatabase methods must be called from the owning (writer)
+ * thread. Single-entry updates and removals are batched, and only become
+ * visible to new readers once commit_pending_changes() has been called or
+ * enough of them have accumulated. Bulk changes (merge, clear and mutating
+ * forEach) are made visible as soon as they have completed.
+ *
+ * merge() builds an entirely new tree in a single pass, which is much cheaper
+ * than removing and updating many entries one by one, and readers keep
+ * seeing the old tree until the new one is complete.
+ */
+class BTreeBucketDatabase : public BucketDatabase {
+    // Value is the last GC time in the upper 32 bits and the entry ref to
+    // the replica array in the lower 32 bits.
+    using BTree = search::btree::BTree<uint64_t, uint64_t>;
+    using ReplicaStore = search::datastore::ArrayStore<BucketCopy>;
+    using GenerationHandler = vespalib::GenerationHandler;
+
+    BTree _tree;
+    ReplicaStore _store;
+    GenerationHandler _generation_handler;
+    uint32_t _uncommitted_changes;
+public:
+    // Upper bound on the number of single-entry changes that are batched
+    // before they are committed without an explicit commit_pending_changes().
+    static constexpr uint32_t max_uncommitted_changes = 1024;
+
+    class ReadGuard {
+        GenerationHandler::Guard _guard;
+        BTree::FrozenView _frozen_view;
+        const ReplicaStore& _store;
+    public:
+        ReadGuard(const BTreeBucketDatabase& db);
+        ReadGuard(const ReadGuard&) = delete;
+        ReadGuard& operator=(const ReadGuard&) = delete;
+        ~ReadGuard();
+
+        Entry get(const document::BucketId& bucket) const;
+        void getParents(const document::BucketId& childBucket, std::vector<Entry>& entries) const;
+        void getAll(const document::BucketId& bucket, std::vector<Entry>& entries) const;
+        void forEach(EntryProcessor&, const document::BucketId& after = document::BucketId()) const;
+        uint64_t size() const;
+        uint64_t generation() const { return _guard.getGeneration(); }
+    };
+
+    BTreeBucketDatabase();
+    ~BTreeBucketDatabase() override;
+
+    /**
+     * Returns a guard that gives a snapshot view of the database as it was
+     * when the guard was acquired. May be called from any thread, and
+     * memory referenced by the snapshot is not reclaimed until the guard
+     * is destroyed.
+     */
+    std::unique_ptr<ReadGuard> acquire_read_guard() const;
+
+    Entry get(const document::BucketId& bucket) const override;
+    void remove(const document::BucketId& bucket) override;
+    void getParents(const document::BucketId& childBucket, std::vector<Entry>& entries) const override;
+    void getAll(const document::BucketId& bucket, std::vector<Entry>& entries) const override;
+    void update(const Entry& newEntry) override;
+    void forEach(EntryProcessor&, const document::BucketId& after = document::BucketId()) const override;
+    void forEach(MutableEntryProcessor&, const document::BucketId& after = document::BucketId()) override;
+    Entry upperBound(const document::BucketId& value) const override;
+    void merge(Merger& merger) override;
+    uint64_t size() const override;
+    void clear() override;
+    document::BucketId getAppropriateBucket(uint16_t minBits, const document::BucketId& bid) override;
+    uint32_t childCount(const document::BucketId&) const override;
+    void commit_pending_changes() override;
+    void print(std::ostream& out, bool verbose, const std::string& indent) const override;
+
+    search::MemoryUsage getMemoryUsage() const;
+
+private:
+    Entry entry_from_value(uint64_t key, uint64_t value) const;
+    uint64_t value_from_entry(const Entry& entry);
+    void release_value(uint64_t value);
+    void commit_tree_changes();
+    void single_entry_changed();
+};
+
+}
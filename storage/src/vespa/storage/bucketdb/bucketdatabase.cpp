@@ -1,6 +1,12 @@
 // Copyright 2017 Yahoo Holdings. Licensed under the terms of the Apache 2.0 license. See LICENSE in the project root.
 #include "bucketdatabase.h"
+#include <vespa/vespalib/util/count_down_latch.h>
+#include <vespa/vespalib/util/executor.h>
+#include <vespa/vespalib/util/lambdatask.h>
+#include <algorithm>
+#include <exception>
 #include <sstream>
+#include <cassert>
 
 namespace storage {
 
@@ -13,6 +19,80 @@ namespace {
             return false;
         }
     };
+
+    struct MergingProcessor : public BucketDatabase::MutableEntryProcessor {
+        BucketDatabase::Merger& _merger;
+        std::vector<document::BucketId> _toRemove;
+
+        explicit MergingProcessor(BucketDatabase::Merger& merger)
+            : _merger(merger), _toRemove() {}
+
+        bool process(BucketDatabase::Entry& e) override {
+            BucketDatabase::Entry copy(e);
+            switch (_merger.merge(copy)) {
+            case BucketDatabase::Merger::Result::Update:
+                assert(copy.getBucketId() == e.getBucketId());
+                e = copy;
+                break;
+            case BucketDatabase::Merger::Result::KeepUnchanged:
+                break;
+            case BucketDatabase::Merger::Result::Skip:
+                _toRemove.push_back(e.getBucketId());
+                break;
+            }
+            return true;
+        }
+    };
+
+    struct UpdatingInserter : public BucketDatabase::Merger::TrailingInserter {
+        BucketDatabase& _db;
+
+        explicit UpdatingInserter(BucketDatabase& db) : _db(db) {}
+
+        void insert_at_end(const BucketDatabase::Entry& e) override {
+            _db.update(e);
+        }
+    };
+
+    struct CollectingProcessor : public BucketDatabase::EntryProcessor {
+        std::vector<BucketDatabase::Entry> _entries;
+
+        bool process(const BucketDatabase::Entry& e) override {
+            _entries.push_back(e);
+            return true;
+        }
+    };
+
+    /**
+     * Replays the decisions made by the shards of a parallel merge, which
+     * were made for the very same entries in the very same order.
+     */
+    struct ReplayingMerger : public BucketDatabase::Merger {
+        BucketDatabase::Merger& _merger;
+        std::vector<BucketDatabase::Entry>& _entries;
+        const std::vector<Result>& _results;
+        size_t _next;
+
+        ReplayingMerger(BucketDatabase::Merger& merger,
+                        std::vector<BucketDatabase::Entry>& entries,
+                        const std::vector<Result>& results)
+            : _merger(merger), _entries(entries), _results(results), _next(0) {}
+
+        Result merge(BucketDatabase::Entry& e) override {
+            assert(_next < _entries.size());
+            assert(_entries[_next].getBucketId() == e.getBucketId());
+            const Result result = _results[_next];
+            if (result == Result::Update) {
+                e = std::move(_entries[_next]);
+            }
+            ++_next;
+            return result;
+        }
+        void insert_remaining_at_end(TrailingInserter& inserter) override {
+            assert(_next == _entries.size());
+            _merger.insert_remaining_at_end(inserter);
+        }
+    };
 }
 
 BucketDatabase::Entry
@@ -21,6 +101,77 @@ BucketDatabase::getNext(const document::BucketId& last) const
     return upperBound(last);
 }
 
+void
+BucketDatabase::merge(Merger& merger)
+{
+    MergingProcessor proc(merger);
+    forEach(proc);
+    for (const auto& bucket : proc._toRemove) {
+        remove(bucket);
+    }
+    UpdatingInserter inserter(*this);
+    merger.insert_remaining_at_end(inserter);
+}
+
+void
+BucketDatabase::parallel_merge(Merger& merger, vespalib::Executor& executor, size_t num_shards)
+{
+    CollectingProcessor snapshot;
+    snapshot._entries.reserve(size());
+    forEach(snapshot);
+    std::vector<Entry>& entries(snapshot._entries);
+    num_shards = std::min(num_shards, entries.size());
+    if (num_shards <= 1) {
+        merge(merger);
+        return;
+    }
+    const size_t shard_size = (entries.size() + num_shards - 1) / num_shards;
+    std::vector<std::unique_ptr<Merger>> shards;
+    for (size_t first = 0; first < entries.size(); first += shard_size) {
+        shards.push_back(merger.create_shard(entries[first].getBucketId().toKey()));
+        if (!shards.back()) {
+            merge(merger);
+            return;
+        }
+    }
+
+    std::vector<Merger::Result> results(entries.size());
+    std::vector<std::exception_ptr> errors(shards.size());
+    vespalib::CountDownLatch done(shards.size());
+    for (size_t i = 0; i < shards.size(); ++i) {
+        auto task = vespalib::makeLambdaTask([&, i]() {
+            const size_t end = std::min((i + 1) * shard_size, entries.size());
+            try {
+                for (size_t j = i * shard_size; j < end; ++j) {
+                    Entry& entry(entries[j]);
+                    results[j] = shards[i]->merge(entry);
+                    if (results[j] != Merger::Result::Update) {
+                        entry.getBucketInfo() = BucketInfo(); // Only updated entries are needed later
+                    }
+                }
+            } catch (...) {
+                errors[i] = std::current_exception();
+            }
+            done.countDown();
+        });
+        if (auto rejected = executor.execute(std::move(task))) {
+            rejected->run();
+        }
+    }
+    done.await();
+    for (const auto& error : errors) {
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+
+    for (auto& shard : shards) {
+        merger.join_shard(*shard);
+    }
+    ReplayingMerger replay(merger, entries, results);
+    merge(replay);
+}
+
 BucketDatabase::Entry
 BucketDatabase::createAppropriateBucket(
         uint16_t minBits, const document::BucketId& bid)
@@ -7,6 +7,9 @@
 #include <vespa/vespalib/util/printable.h>
 #include <vespa/storage/bucketdb/bucketinfo.h>
 #include <vespa/document/bucket/bucketid.h>
+#include <memory>
+
+namespace vespalib { class Executor; }
 
 namespace storage {
 
@@ -48,6 +51,53 @@ public:
     typedef Processor<const Entry> EntryProcessor;
     typedef Processor<Entry> MutableEntryProcessor;
 
+    /**
+     * Used by merge() to decide the fate of every existing entry in a single
+     * pass over the database, and to add entries that do not yet exist.
+     */
+    struct Merger {
+        enum class Result {
+            Update,        // Entry has been changed and must be written back
+            KeepUnchanged, // Entry is kept as it was; any changes are ignored
+            Skip           // Entry is removed from the database
+        };
+
+        struct TrailingInserter {
+            virtual ~TrailingInserter() {}
+            /** Entries may be inserted in any order. */
+            virtual void insert_at_end(const Entry& e) = 0;
+        };
+
+        virtual ~Merger() {}
+        /**
+         * Invoked once per existing entry, in bucket key order. The bucket id
+         * of the entry must not be changed.
+         */
+        virtual Result merge(Entry& e) = 0;
+        /**
+         * Invoked once after all existing entries have been merged. Inserted
+         * entries replace any existing entry for the same bucket.
+         */
+        virtual void insert_remaining_at_end(TrailingInserter&) {}
+
+        /**
+         * Used by parallel_merge() to create a merger for the existing entries
+         * from the given bucket key and up to the first key of the next shard.
+         * Shards are created in key order and run concurrently with each other,
+         * and only get merge() calls. Returns an empty pointer if this merger
+         * can not be split, in which case the merge is not done in parallel.
+         */
+        virtual std::unique_ptr<Merger> create_shard(uint64_t first_key) {
+            (void) first_key;
+            return std::unique_ptr<Merger>();
+        }
+        /**
+         * Invoked for every shard, in key order, after all shards are done
+         * and before insert_remaining_at_end() is invoked on this merger.
+         */
+        virtual void join_shard(Merger& shard) { (void) shard; }
+    };
+
     virtual ~BucketDatabase() {}
 
     virtual Entry get(const document::BucketId& bucket) const = 0;
@@ -91,6 +141,24 @@ public:
      */
     virtual Entry upperBound(const document::BucketId& value) const = 0;
 
+    /**
+     * Applies the given merger to all entries in the database. This is meant
+     * for bulk changes such as the ones done on cluster state transitions,
+     * and implementations may use it to rebuild the database in one go rather
+     * than through a long sequence of single-entry updates and removals.
+     */
+    virtual void merge(Merger& merger);
+
+    /**
+     * Same as merge(), except that the existing entries are first split in
+     * num_shards consecutive key ranges, which shards of the merger decide
+     * the fate of in parallel on the given executor. The decisions are then
+     * applied in a single merge() pass by the calling thread, which waits for
+     * the shards to complete. Exceptions thrown by a shard are rethrown here,
+     * before the database has been changed.
+     */
+    void parallel_merge(Merger& merger, vespalib::Executor& executor, size_t num_shards);
+
     Entry getNext(const document::BucketId& last) const;
     
     virtual uint64_t size() const = 0;
@@ -112,6 +180,13 @@ public:
             const document::BucketId& bid);
 
     virtual uint32_t childCount(const document::BucketId&) const = 0;
+
+    /**
+     * Makes all changes done so far visible to readers in other threads than
+     * the owner of the database. Does nothing for databases that can only be
+     * read by their owner.
+     */
+    virtual void commit_pending_changes() {}
 };
 
 std::ostream& operator<<(std::ostream& o, const BucketDatabase::Entry& e);
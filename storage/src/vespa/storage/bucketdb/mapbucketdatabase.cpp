@@ -389,6 +389,75 @@ MapBucketDatabase::forEach(MutableEntryProcessor& processor,
     forEach(0, processor, 0, after, process);
 }
 
+/*
+ * Visits the entries in the same order as forEach, applying the merge result
+ * to each entry and freeing nodes that become empty along the way, the same
+ * way as remove() does. Returns true if the node at index was freed.
+ */
+bool
+MapBucketDatabase::mergeImpl(int index, Merger& merger)
+{
+    if (index == -1) {
+        return false;
+    }
+
+    // No nodes are allocated while merging, so the reference stays valid.
+    E& e = _db[index];
+    if (e.value != -1) {
+        Entry& entry = _values[e.value];
+        Entry copy(entry);
+        switch (merger.merge(copy)) {
+        case Merger::Result::Update:
+            assert(copy.getBucketId() == entry.getBucketId());
+            entry = std::move(copy);
+            break;
+        case Merger::Result::KeepUnchanged:
+            break;
+        case Merger::Result::Skip:
+            LOG_BUCKET_OPERATION_NO_LOCK(entry.getBucketId(), "REMOVING from bucket db!");
+            _freeValues.push_back(e.value);
+            e.value = -1;
+            break;
+        }
+    }
+
+    if (mergeImpl(e.e_0, merger)) {
+        e.e_0 = -1;
+    }
+    if (mergeImpl(e.e_1, merger)) {
+        e.e_1 = -1;
+    }
+
+    if (e.empty() && index > 0) {
+        _free.push_back(index);
+        return true;
+    } else {
+        return false;
+    }
+}
+
+namespace {
+
+struct UpdatingInserter : public BucketDatabase::Merger::TrailingInserter {
+    BucketDatabase& _db;
+
+    explicit UpdatingInserter(BucketDatabase& db) : _db(db) {}
+
+    void insert_at_end(const BucketDatabase::Entry& e) override {
+        _db.update(e);
+    }
+};
+
+}
+
+void
+MapBucketDatabase::merge(Merger& merger)
+{
+    mergeImpl(0, merger);
+    UpdatingInserter inserter(*this);
+    merger.insert_remaining_at_end(inserter);
+}
+
 void
 MapBucketDatabase::clear()
 {
@@ -19,6 +19,7 @@ public:
     void update(const Entry& newEntry) override;
     void forEach(EntryProcessor&, const document::BucketId& after = document::BucketId()) const override;
     void forEach(MutableEntryProcessor&, const document::BucketId& after = document::BucketId()) override;
+    void merge(Merger& merger) override;
     uint64_t size() const override { return _values.size() - _freeValues.size(); };
     void clear() override;
 
@@ -44,6 +45,7 @@ private:
 
     BucketDatabase::Entry* find(int idx, uint8_t bitCount, const document::BucketId& bid, bool create);
     bool remove(int index, uint8_t bitCount, const document::BucketId& bId);
+    bool mergeImpl(int index, Merger& merger);
     int findFirstInOrderNodeInclusive(int index) const;
     int upperBoundImpl(int index, uint8_t depth, const document::BucketId& value) const;
 
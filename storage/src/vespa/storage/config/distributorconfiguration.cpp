@@ -3,6 +3,7 @@
 #include <vespa/document/select/parser.h>
 #include <vespa/document/select/traversingvisitor.h>
 #include <vespa/vespalib/util/exceptions.h>
+#include <algorithm>
 #include <sstream>
 
 #include <vespa/log/log.h>
@@ -24,6 +25,13 @@ DistributorConfiguration::DistributorConfiguration(StorageComponent& component)
       _garbageCollectionInterval(0),
       _minPendingMaintenanceOps(100),
       _maxPendingMaintenanceOps(1000),
+      _maxPendingMergesPerNode(16),
+      _maxPendingSplitsPerNode(16),
+      _maxPendingJoinsPerNode(16),
+      _maxPendingGarbageCollectionsPerNode(16),
+      _maintenanceLatencyTarget(1000),
+      _maintenanceNodeQueueDepthTarget(100),
+      _bucketDbTransitionThreads(1),
       _maxVisitorsPerNodePerClientVisitor(4),
       _minBucketsPerVisitor(5),
       _maxClusterClockSkew(0),
@@ -157,6 +165,14 @@ DistributorConfiguration::configure(const vespa::config::content::core::StorDist
     if (config.inhibitMergeSendingOnBusyNodeDurationSec >= 0) {
         _inhibitMergeSendingOnBusyNodeDuration = std::chrono::seconds(config.inhibitMergeSendingOnBusyNodeDurationSec);
     }
+
+    _maxPendingMergesPerNode = std::max(1, config.maxPendingMergesPerNode);
+    _maxPendingSplitsPerNode = std::max(1, config.maxPendingSplitsPerNode);
+    _maxPendingJoinsPerNode = std::max(1, config.maxPendingJoinsPerNode);
+    _maxPendingGarbageCollectionsPerNode = std::max(1, config.maxPendingGarbageCollectionsPerNode);
+    _maintenanceLatencyTarget = std::chrono::milliseconds(std::max(0, config.maintenanceLatencyTargetMs));
+    _maintenanceNodeQueueDepthTarget = std::max(0, config.maintenanceNodeQueueDepthTarget);
+    _bucketDbTransitionThreads = std::max(1, config.bucketDbTransitionThreads);
     
     LOG(debug,
         "Distributor now using new configuration parameters. Split limits: %d docs/%d bytes. "
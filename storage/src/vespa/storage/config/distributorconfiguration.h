@@ -184,6 +184,25 @@ public:
         _maxPendingMaintenanceOps = maxPendingMaintenanceOps;
     }
 
+    uint32_t getMaxPendingMergesPerNode() const noexcept {
+        return _maxPendingMergesPerNode;
+    }
+    uint32_t getMaxPendingSplitsPerNode() const noexcept {
+        return _maxPendingSplitsPerNode;
+    }
+    uint32_t getMaxPendingJoinsPerNode() const noexcept {
+        return _maxPendingJoinsPerNode;
+    }
+    uint32_t getMaxPendingGarbageCollectionsPerNode() const noexcept {
+        return _maxPendingGarbageCollectionsPerNode;
+    }
+    std::chrono::milliseconds getMaintenanceLatencyTarget() const noexcept {
+        return _maintenanceLatencyTarget;
+    }
+    uint32_t getMaintenanceNodeQueueDepthTarget() const noexcept {
+        return _maintenanceNodeQueueDepthTarget;
+    }
+
     uint32_t getMaxVisitorsPerNodePerClientVisitor() const {
         return _maxVisitorsPerNodePerClientVisitor;
     }
@@ -242,6 +261,13 @@ public:
     void setAllowStaleReadsDuringClusterStateTransitions(bool allow) noexcept {
         _allowStaleReadsDuringClusterStateTransitions = allow;
     }
+
+    uint32_t getBucketDbTransitionThreads() const noexcept {
+        return _bucketDbTransitionThreads;
+    }
+    void setBucketDbTransitionThreads(uint32_t threads) noexcept {
+        _bucketDbTransitionThreads = threads;
+    }
     
 private:
     DistributorConfiguration(const DistributorConfiguration& other);
@@ -265,6 +291,13 @@ private:
 
     uint32_t _minPendingMaintenanceOps;
     uint32_t _maxPendingMaintenanceOps;
+    uint32_t _maxPendingMergesPerNode;
+    uint32_t _maxPendingSplitsPerNode;
+    uint32_t _maxPendingJoinsPerNode;
+    uint32_t _maxPendingGarbageCollectionsPerNode;
+    std::chrono::milliseconds _maintenanceLatencyTarget;
+    uint32_t _maintenanceNodeQueueDepthTarget;
+    uint32_t _bucketDbTransitionThreads;
 
     vespalib::hash_set<vespalib::string> _blockedStateCheckers;
 
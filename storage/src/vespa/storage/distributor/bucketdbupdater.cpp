@@ -27,7 +27,8 @@ BucketDBUpdater::BucketDBUpdater(Distributor& owner,
     : framework::StatusReporter("bucketdb", "Bucket DB Updater"),
       _distributorComponent(owner, bucketSpaceRepo, readOnlyBucketSpaceRepo, compReg, "Bucket DB Updater"),
       _sender(sender),
-      _transitionTimer(_distributorComponent.getClock())
+      _transitionTimer(_distributorComponent.getClock()),
+      _transitionExecutor()
 {
 }
 
@@ -135,21 +136,44 @@ BucketDBUpdater::removeSuperfluousBuckets(
                 *newState.getDerivedClusterState(elem.first),
                 _distributorComponent.getIndex(),
                 newDistribution,
-                _distributorComponent.getDistributor().getStorageNodeUpStates());
-        bucketDb.forEach(proc);
+                _distributorComponent.getDistributor().getStorageNodeUpStates(),
+                move_to_read_only_db);
+        mergeIntoBucketDatabase(bucketDb, proc);
 
-        for (const auto & bucket : proc.getBucketsToRemove()) {
-            bucketDb.remove(bucket);
-        }
-        // TODO vec of Entry instead to avoid lookup and remove? Uses more transient memory...
-        for (const auto& bucket : proc.getNonOwnedBuckets()) {
-            if (move_to_read_only_db) {
-                auto db_entry = bucketDb.get(bucket);
-                readOnlyDb.update(db_entry); // TODO Entry move support
-            }
-            bucketDb.remove(bucket);
+        for (const auto& entry : proc.getNonOwnedEntries()) {
+            readOnlyDb.update(entry);
         }
+    }
+}
 
+vespalib::Executor*
+BucketDBUpdater::transitionExecutor()
+{
+    const uint32_t threads = _distributorComponent.getDistributor().getConfig().getBucketDbTransitionThreads();
+    if (threads <= 1) {
+        _transitionExecutor.reset();
+        return nullptr;
+    }
+    if (!_transitionExecutor || (_transitionExecutor->getNumThreads() != threads)) {
+        _transitionExecutor = std::make_unique<vespalib::ThreadStackExecutor>(threads, 128 * 1024);
+    }
+    return _transitionExecutor.get();
+}
+
+size_t
+BucketDBUpdater::transitionShards() const
+{
+    return _distributorComponent.getDistributor().getConfig().getBucketDbTransitionThreads();
+}
+
+void
+BucketDBUpdater::mergeIntoBucketDatabase(BucketDatabase& db, BucketDatabase::Merger& merger)
+{
+    vespalib::Executor* executor = transitionExecutor();
+    if (executor != nullptr) {
+        db.parallel_merge(merger, *executor, transitionShards());
+    } else {
+        db.merge(merger);
     }
 }
 
@@ -579,7 +603,7 @@ BucketDBUpdater::processCompletedPendingClusterState()
 void
 BucketDBUpdater::activatePendingClusterState()
 {
-    _pendingClusterState->mergeIntoBucketDatabases();
+    _pendingClusterState->mergeIntoBucketDatabases(transitionExecutor(), transitionShards());
 
     if (_pendingClusterState->isVersionedTransition()) {
         LOG(debug, "Activating pending cluster state version %u", _pendingClusterState->clusterStateVersion());
@@ -729,11 +753,10 @@ BucketDBUpdater::NodeRemover::logRemove(const document::BucketId& bucketId, cons
 
 bool
 BucketDBUpdater::NodeRemover::distributorOwnsBucket(
-        const document::BucketId& bucketId) const
+        const document::BucketId& bucketId)
 {
     try {
-        uint16_t distributor(
-                _distribution.getIdealDistributorNode(_state, bucketId, "uim"));
+        uint16_t distributor(_idealNodes.getIdealDistributorNode(bucketId));
         if (distributor != _localIndex) {
             logRemove(bucketId, "bucket now owned by another distributor");
             return false;
@@ -750,12 +773,11 @@ BucketDBUpdater::NodeRemover::distributorOwnsBucket(
 void
 BucketDBUpdater::NodeRemover::setCopiesInEntry(
         BucketDatabase::Entry& e,
-        const std::vector<BucketCopy>& copies) const
+        const std::vector<BucketCopy>& copies)
 {
     e->clear();
 
-    std::vector<uint16_t> order =
-            _distribution.getIdealStorageNodes(_state, e.getBucketId(), _upStates);
+    const std::vector<uint16_t>& order(_idealNodes.getIdealStorageNodes(e.getBucketId()));
 
     e->addNodes(copies, order);
 
@@ -778,19 +800,21 @@ BucketDBUpdater::NodeRemover::removeEmptyBucket(const document::BucketId& bucket
     LOG_BUCKET_OPERATION_NO_LOCK(bucketId, "bucket now has no copies");
 }
 
-bool
-BucketDBUpdater::NodeRemover::process(BucketDatabase::Entry& e)
+BucketDatabase::Merger::Result
+BucketDBUpdater::NodeRemover::merge(BucketDatabase::Entry& e)
 {
     const document::BucketId& bucketId(e.getBucketId());
 
     LOG(spam, "Check for remove: bucket %s", e.toString().c_str());
     if (e->getNodeCount() == 0) {
         removeEmptyBucket(e.getBucketId());
-        return true;
+        return Result::Skip;
     }
     if (!distributorOwnsBucket(bucketId)) {
-        _nonOwnedBuckets.push_back(bucketId);
-        return true;
+        if (_trackNonOwnedEntries) {
+            _nonOwnedEntries.push_back(e);
+        }
+        return Result::Skip;
     }
 
     std::vector<BucketCopy> remainingCopies;
@@ -803,16 +827,36 @@ BucketDBUpdater::NodeRemover::process(BucketDatabase::Entry& e)
     }
 
     if (remainingCopies.size() == e->getNodeCount()) {
-        return true;
+        return Result::KeepUnchanged;
     }
 
     if (remainingCopies.empty()) {
         removeEmptyBucket(bucketId);
+        return Result::Skip;
     } else {
         setCopiesInEntry(e, remainingCopies);
+        return Result::Update;
     }
+}
 
-    return true;
+std::unique_ptr<BucketDatabase::Merger>
+BucketDBUpdater::NodeRemover::create_shard(uint64_t)
+{
+    return std::make_unique<NodeRemover>(_oldState, _state, _localIndex, _distribution,
+                                         _upStates, _trackNonOwnedEntries);
+}
+
+void
+BucketDBUpdater::NodeRemover::join_shard(BucketDatabase::Merger& merger)
+{
+    auto& shard = static_cast<NodeRemover&>(merger);
+    // Moved out, so that the removed buckets are only logged once.
+    _nonOwnedEntries.insert(_nonOwnedEntries.end(),
+                            std::make_move_iterator(shard._nonOwnedEntries.begin()),
+                            std::make_move_iterator(shard._nonOwnedEntries.end()));
+    _removedBuckets.insert(_removedBuckets.end(), shard._removedBuckets.begin(), shard._removedBuckets.end());
+    shard._nonOwnedEntries.clear();
+    shard._removedBuckets.clear();
 }
 
 BucketDBUpdater::NodeRemover::~NodeRemover()
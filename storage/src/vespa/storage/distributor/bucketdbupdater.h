@@ -7,6 +7,7 @@
 #include "distributormessagesender.h"
 #include "pendingclusterstate.h"
 #include "outdated_nodes_map.h"
+#include "superbucket_ideal_nodes_cache.h"
 #include <vespa/document/bucket/bucket.h>
 #include <vespa/storageapi/messageapi/returncode.h>
 #include <vespa/storageapi/message/bucket.h>
@@ -15,6 +16,7 @@
 #include <vespa/storageframework/generic/clock/timer.h>
 #include <vespa/storageframework/generic/status/statusreporter.h>
 #include <vespa/storageapi/messageapi/messagehandler.h>
+#include <vespa/vespalib/util/threadstackexecutor.h>
 #include <list>
 
 namespace vespalib::xml {
@@ -165,6 +167,15 @@ private:
 
     void removeSuperfluousBuckets(const lib::ClusterStateBundle& newState);
 
+    /**
+       Returns the executor that cluster state transitions are merged into
+       the bucket databases on, or nullptr if they are merged on the
+       distributor thread only.
+    */
+    vespalib::Executor* transitionExecutor();
+    size_t transitionShards() const;
+    void mergeIntoBucketDatabase(BucketDatabase& db, BucketDatabase::Merger& merger);
+
     void replyToPreviousPendingClusterStateIfAny();
     void replyToActivationWithActualVersion(
             const api::ActivateClusterStateVersionCommand& cmd,
@@ -193,46 +204,56 @@ private:
 
     /**
        Removes all copies of buckets that are on nodes that are down.
+       Buckets no longer owned by this distributor are removed as well and,
+       if requested, kept aside so that they can be moved to the read-only
+       bucket database. May be sharded to run in parallel.
     */
-    class NodeRemover : public BucketDatabase::MutableEntryProcessor
+    class NodeRemover : public BucketDatabase::Merger
     {
     public:
         NodeRemover(const lib::ClusterState& oldState,
                     const lib::ClusterState& s,
                     uint16_t localIndex,
                     const lib::Distribution& distribution,
-                    const char* upStates)
+                    const char* upStates,
+                    bool trackNonOwnedEntries)
             : _oldState(oldState),
               _state(s),
-              _nonOwnedBuckets(),
+              _nonOwnedEntries(),
               _removedBuckets(),
               _localIndex(localIndex),
               _distribution(distribution),
-              _upStates(upStates) {}
+              _idealNodes(distribution, _state, "uim", upStates),
+              _upStates(upStates),
+              _trackNonOwnedEntries(trackNonOwnedEntries) {}
 
         ~NodeRemover() override;
-        bool process(BucketDatabase::Entry& e) override;
+        Result merge(BucketDatabase::Entry& e) override;
+        std::unique_ptr<BucketDatabase::Merger> create_shard(uint64_t first_key) override;
+        void join_shard(BucketDatabase::Merger& shard) override;
         void logRemove(const document::BucketId& bucketId, const char* msg) const;
-        bool distributorOwnsBucket(const document::BucketId&) const;
+        bool distributorOwnsBucket(const document::BucketId&);
 
         const std::vector<document::BucketId>& getBucketsToRemove() const noexcept {
             return _removedBuckets;
         }
-        const std::vector<document::BucketId>& getNonOwnedBuckets() const noexcept {
-            return _nonOwnedBuckets;
+        const std::vector<BucketDatabase::Entry>& getNonOwnedEntries() const noexcept {
+            return _nonOwnedEntries;
         }
     private:
-        void setCopiesInEntry(BucketDatabase::Entry& e, const std::vector<BucketCopy>& copies) const;
+        void setCopiesInEntry(BucketDatabase::Entry& e, const std::vector<BucketCopy>& copies);
         void removeEmptyBucket(const document::BucketId& bucketId);
 
         const lib::ClusterState _oldState;
         const lib::ClusterState _state;
-        std::vector<document::BucketId> _nonOwnedBuckets;
+        std::vector<BucketDatabase::Entry> _nonOwnedEntries;
         std::vector<document::BucketId> _removedBuckets;
 
         uint16_t _localIndex;
         const lib::Distribution& _distribution;
+        SuperbucketIdealNodesCache _idealNodes;
         const char* _upStates;
+        bool _trackNonOwnedEntries;
     };
 
     std::deque<std::pair<framework::MilliSecTime, BucketRequest> > _delayedRequests;
@@ -243,6 +264,7 @@ private:
     std::set<EnqueuedBucketRecheck> _enqueuedRechecks;
     OutdatedNodesMap         _outdatedNodesMap;
     framework::MilliSecTimer _transitionTimer;
+    std::unique_ptr<vespalib::ThreadStackExecutor> _transitionExecutor;
 };
 
 }
@@ -2,11 +2,13 @@
 //
 #include "distributor.h"
 #include "blockingoperationstarter.h"
+#include "nodebudgetoperationstarter.h"
 #include "throttlingoperationstarter.h"
 #include "idealstatemetricsset.h"
 #include "ownership_transfer_safe_time_point_calculator.h"
 #include "distributor_bucket_space.h"
 #include "distributormetricsset.h"
+#include <vespa/storage/bucketdb/btree_bucket_database.h>
 #include <vespa/storage/distributor/maintenance/simplebucketprioritydatabase.h>
 #include <vespa/storage/common/nodestateupdater.h>
 #include <vespa/storage/common/hostreporter/hostinfo.h>
@@ -59,15 +61,16 @@ Distributor::Distributor(DistributorComponentRegister& compReg,
                          DoneInitializeHandler& doneInitHandler,
                          bool manageActiveBucketCopies,
                          HostInfo& hostInfoReporterRegistrar,
-                         ChainedMessageSender* messageSender)
+                         ChainedMessageSender* messageSender,
+                         bool useBTreeDatabase)
     : StorageLink("distributor"),
       DistributorInterface(),
       framework::StatusReporter("distributor", "Distributor"),
       _clusterStateBundle(lib::ClusterState()),
       _compReg(compReg),
       _component(compReg, "distributor"),
-      _bucketSpaceRepo(std::make_unique<DistributorBucketSpaceRepo>()),
-      _readOnlyBucketSpaceRepo(std::make_unique<DistributorBucketSpaceRepo>()),
+      _bucketSpaceRepo(std::make_unique<DistributorBucketSpaceRepo>(useBTreeDatabase)),
+      _readOnlyBucketSpaceRepo(std::make_unique<DistributorBucketSpaceRepo>(useBTreeDatabase)),
       _metrics(new DistributorMetricSet(_component.getLoadTypes()->getMetricLoadTypes())),
       _operationOwner(*this, _component.getClock()),
       _maintenanceOperationOwner(*this, _component.getClock()),
@@ -85,7 +88,8 @@ Distributor::Distributor(DistributorComponentRegister& compReg,
       _bucketPriorityDb(new SimpleBucketPriorityDatabase()),
       _scanner(new SimpleMaintenanceScanner(*_bucketPriorityDb, _idealStateManager, *_bucketSpaceRepo)),
       _throttlingStarter(new ThrottlingOperationStarter(_maintenanceOperationOwner)),
-      _blockingStarter(new BlockingOperationStarter(_pendingMessageTracker, *_throttlingStarter)),
+      _nodeBudgetStarter(new NodeBudgetOperationStarter(_pendingMessageTracker.getNodeInfo(), *_throttlingStarter)),
+      _blockingStarter(new BlockingOperationStarter(_pendingMessageTracker, *_nodeBudgetStarter)),
       _scheduler(new MaintenanceScheduler(_idealStateManager, *_bucketPriorityDb, *_blockingStarter)),
       _schedulingMode(MaintenanceScheduler::NORMAL_SCHEDULING_MODE),
       _recoveryTimeStarted(_component.getClock()),
@@ -788,6 +792,16 @@ Distributor::startNextMaintenanceOperation()
 {
     _throttlingStarter->setMaxPendingRange(getConfig().getMinPendingMaintenanceOps(),
                                            getConfig().getMaxPendingMaintenanceOps());
+    _nodeBudgetStarter->setMaxPendingPerNode(MaintenanceOperation::MERGE_BUCKET,
+                                             getConfig().getMaxPendingMergesPerNode());
+    _nodeBudgetStarter->setMaxPendingPerNode(MaintenanceOperation::SPLIT_BUCKET,
+                                             getConfig().getMaxPendingSplitsPerNode());
+    _nodeBudgetStarter->setMaxPendingPerNode(MaintenanceOperation::JOIN_BUCKET,
+                                             getConfig().getMaxPendingJoinsPerNode());
+    _nodeBudgetStarter->setMaxPendingPerNode(MaintenanceOperation::GARBAGE_COLLECTION,
+                                             getConfig().getMaxPendingGarbageCollectionsPerNode());
+    _nodeBudgetStarter->setLatencyTarget(getConfig().getMaintenanceLatencyTarget());
+    _nodeBudgetStarter->setQueueDepthTarget(getConfig().getMaintenanceNodeQueueDepthTarget());
     _scheduler->tick(_schedulingMode);
 }
 
@@ -799,6 +813,7 @@ Distributor::doCriticalTick(framework::ThreadIndex)
     enableNextConfig();
     fetchStatusRequests();
     fetchExternalMessages();
+    commitBucketDatabaseChanges();
     return _tickResult;
 }
 
@@ -816,6 +831,7 @@ Distributor::doNonCriticalTick(framework::ThreadIndex)
         }
     }
     _bucketDBUpdater.resendDelayedMessages();
+    commitBucketDatabaseChanges();
     return _tickResult;
 }
 
@@ -828,6 +844,18 @@ Distributor::enableNextConfig()
     _pendingMessageTracker.setNodeBusyDuration(getConfig().getInhibitMergesOnBusyNodeDuration());
 }
 
+void
+Distributor::commitBucketDatabaseChanges()
+{
+    // Single-entry changes are batched by the databases; publish them to
+    // concurrent readers once per tick.
+    for (auto* repo : {_bucketSpaceRepo.get(), _readOnlyBucketSpaceRepo.get()}) {
+        for (auto& space : *repo) {
+            space.second->getBucketDatabase().commit_pending_changes();
+        }
+    }
+}
+
 void
 Distributor::fetchStatusRequests()
 {
@@ -896,7 +924,8 @@ Distributor::reportStatus(std::ostream& out,
                 << "storage nodes</a><br><a href=\"?page=maintenance&show=50\">"
                 << "List maintenance queue (adjust show parameter to see more "
                 << "operations, -1 for all)</a><br>\n<a href=\"?page=buckets\">"
-                << "List all buckets, highlight non-ideal state</a><br>\n";
+                << "List all buckets, highlight non-ideal state</a><br>\n"
+                << "<a href=\"?page=bucketdb\">Dump the bucket databases</a><br>\n";
         } else {
             const_cast<IdealStateManager&>(_idealStateManager)
                 .getBucketStatus(out);
@@ -915,15 +944,83 @@ Distributor::reportStatus(std::ostream& out,
                         << XmlEndTag();
         } else if (page == "maintenance") {
             // Need new page
+        } else if (page == "bucketdb") {
+            reportBucketDatabases(xmlReporter.getStream());
         }
     }
 
     return true;
 }
 
+namespace {
+
+class XmlBucketEntryWriter : public BucketDatabase::EntryProcessor {
+    vespalib::xml::XmlOutputStream& _xos;
+public:
+    explicit XmlBucketEntryWriter(vespalib::xml::XmlOutputStream& xos) : _xos(xos) {}
+
+    bool process(const BucketDatabase::Entry& e) override {
+        using namespace vespalib::xml;
+        _xos << XmlTag("bucket")
+             << XmlAttribute("id", e.getBucketId().toString())
+             << XmlAttribute("info", e->toString())
+             << XmlEndTag();
+        return true;
+    }
+};
+
+bool
+isBucketDatabaseStatusRequest(const framework::HttpUrlPath& path)
+{
+    return (path.hasAttribute("page") && (path.getAttribute("page") == "bucketdb"));
+}
+
+}
+
+bool
+Distributor::canReportBucketDatabasesConcurrently() const
+{
+    for (auto& space : *_bucketSpaceRepo) {
+        if (dynamic_cast<const BTreeBucketDatabase*>(&space.second->getBucketDatabase()) == nullptr) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void
+Distributor::reportBucketDatabases(vespalib::xml::XmlOutputStream& xos) const
+{
+    using namespace vespalib::xml;
+    for (auto& space : *_bucketSpaceRepo) {
+        const BucketDatabase& db(space.second->getBucketDatabase());
+        XmlBucketEntryWriter writer(xos);
+        xos << XmlTag("bucketspace")
+            << XmlAttribute("name", document::FixedBucketSpaces::to_string(space.first));
+        if (auto* btreeDb = dynamic_cast<const BTreeBucketDatabase*>(&db)) {
+            // Reads a consistent snapshot and may thus run in any thread.
+            auto guard = btreeDb->acquire_read_guard();
+            xos << XmlAttribute("size", guard->size());
+            guard->forEach(writer);
+        } else {
+            xos << XmlAttribute("size", db.size());
+            db.forEach(writer);
+        }
+        xos << XmlEndTag();
+    }
+}
+
 bool
 Distributor::handleStatusRequest(const DelegatedStatusRequest& request) const
 {
+    if ((&request.reporter == this) && isBucketDatabaseStatusRequest(request.path)
+        && canReportBucketDatabasesConcurrently())
+    {
+        // Dumping a large database takes a while, so read it from a snapshot
+        // in the status thread rather than stalling the distributor thread.
+        request.reporter.reportStatus(request.outputStream, request.path);
+        return true;
+    }
     auto wrappedRequest = std::make_shared<Status>(request);
     {
         framework::TickingLockGuard guard(_threadPool.freezeCriticalTicks());
@@ -34,6 +34,7 @@ namespace distributor {
 class DistributorBucketSpaceRepo;
 class SimpleMaintenanceScanner;
 class BlockingOperationStarter;
+class NodeBudgetOperationStarter;
 class ThrottlingOperationStarter;
 class BucketPriorityDatabase;
 class OwnershipTransferSafeTimePointCalculator;
@@ -52,7 +53,8 @@ public:
                 DoneInitializeHandler&,
                 bool manageActiveBucketCopies,
                 HostInfo& hostInfoReporterRegistrar,
-                ChainedMessageSender* = nullptr);
+                ChainedMessageSender* = nullptr,
+                bool useBTreeDatabase = false);
 
     ~Distributor();
 
@@ -194,6 +196,9 @@ private:
     bool isMaintenanceReply(const api::StorageReply& reply) const;
 
     void handleStatusRequests();
+    bool canReportBucketDatabasesConcurrently() const;
+    void reportBucketDatabases(vespalib::xml::XmlOutputStream& xos) const;
+    void commitBucketDatabaseChanges();
     void send_shutdown_abort_reply(const std::shared_ptr<api::StorageMessage>&);
     void handle_or_propagate_message(const std::shared_ptr<api::StorageMessage>& msg);
     void startExternalOperations();
@@ -302,6 +307,7 @@ private:
     std::unique_ptr<BucketPriorityDatabase> _bucketPriorityDb;
     std::unique_ptr<SimpleMaintenanceScanner> _scanner;
     std::unique_ptr<ThrottlingOperationStarter> _throttlingStarter;
+    std::unique_ptr<NodeBudgetOperationStarter> _nodeBudgetStarter;
     std::unique_ptr<BlockingOperationStarter> _blockingStarter;
     std::unique_ptr<MaintenanceScheduler> _scheduler;
     MaintenanceScheduler::SchedulingMode _schedulingMode;
@@ -1,15 +1,59 @@
 // Copyright 2017 Yahoo Holdings. Licensed under the terms of the Apache 2.0 license. See LICENSE in the project root.
 
 #include "distributor_bucket_space.h"
+#include <vespa/storage/bucketdb/btree_bucket_database.h>
+#include <vespa/storage/bucketdb/mapbucketdatabase.h>
 #include <vespa/vdslib/state/clusterstate.h>
 #include <vespa/vdslib/distribution/distribution.h>
+#include <vespa/vdslib/state/nodetype.h>
 
 namespace storage::distributor {
 
+namespace {
+
+// Entries per bucket space. Keeps the buckets recently seen by the state
+// checkers and by bucket database updates, not the whole database.
+constexpr uint32_t IDEAL_NODES_CACHE_SIZE = 16384;
+
+struct IdealNodesPrefetchCollector : public BucketDatabase::EntryProcessor {
+    std::vector<document::BucketId>& _buckets;
+    size_t _maxBuckets;
+    uint32_t _minUsedBits;
+
+    IdealNodesPrefetchCollector(std::vector<document::BucketId>& buckets,
+                                size_t maxBuckets, uint32_t minUsedBits)
+        : _buckets(buckets), _maxBuckets(maxBuckets), _minUsedBits(minUsedBits) {}
+
+    bool process(const BucketDatabase::Entry& e) override {
+        // Buckets split less than the distribution bits have no ideal nodes
+        if (e.getBucketId().getUsedBits() >= _minUsedBits) {
+            _buckets.push_back(e.getBucketId());
+        }
+        return (_buckets.size() < _maxBuckets);
+    }
+};
+
+std::unique_ptr<BucketDatabase>
+createBucketDatabase(bool useBTreeDatabase)
+{
+    if (useBTreeDatabase) {
+        return std::make_unique<BTreeBucketDatabase>();
+    }
+    return std::make_unique<MapBucketDatabase>();
+}
+
+}
+
 DistributorBucketSpace::DistributorBucketSpace()
-    : _bucketDatabase(),
+    : DistributorBucketSpace(false)
+{
+}
+
+DistributorBucketSpace::DistributorBucketSpace(bool useBTreeDatabase)
+    : _bucketDatabase(createBucketDatabase(useBTreeDatabase)),
       _clusterState(),
-      _distribution()
+      _distribution(),
+      _idealNodesCache(IDEAL_NODES_CACHE_SIZE)
 {
 }
 
@@ -19,12 +63,51 @@ void
 DistributorBucketSpace::setClusterState(std::shared_ptr<const lib::ClusterState> clusterState)
 {
     _clusterState = std::move(clusterState);
+    _idealNodesCache.clear();
 }
 
 
 void
 DistributorBucketSpace::setDistribution(std::shared_ptr<const lib::Distribution> distribution) {
     _distribution = std::move(distribution);
+    _idealNodesCache.clear();
+}
+
+std::vector<uint16_t>
+DistributorBucketSpace::getIdealStorageNodes(const document::BucketId& bucket, const char* upStates) const
+{
+    return _idealNodesCache.getIdealNodes(lib::NodeType::STORAGE, *_distribution, *_clusterState,
+                                          bucket, upStates);
+}
+
+void
+DistributorBucketSpace::prefetchIdealStorageNodes(const document::BucketId& bucket, size_t maxBuckets,
+                                                  const char* upStates) const
+{
+    const uint32_t minUsedBits = _clusterState->getDistributionBitCount();
+    if ((maxBuckets == 0) || (bucket.getUsedBits() < minUsedBits)
+        || _idealNodesCache.contains(lib::NodeType::STORAGE, *_distribution, *_clusterState, bucket, upStates))
+    {
+        return;
+    }
+    std::vector<document::BucketId> buckets;
+    buckets.reserve(maxBuckets);
+    buckets.push_back(bucket);
+    if (maxBuckets > 1) {
+        IdealNodesPrefetchCollector collector(buckets, maxBuckets, minUsedBits);
+        _bucketDatabase->forEach(collector, bucket);
+    }
+    std::vector<std::vector<uint16_t>> nodes;
+    getIdealStorageNodes(buckets, nodes, upStates);
+}
+
+void
+DistributorBucketSpace::getIdealStorageNodes(const std::vector<document::BucketId>& buckets,
+                                             std::vector<std::vector<uint16_t>>& nodes,
+                                             const char* upStates) const
+{
+    _idealNodesCache.getIdealNodes(lib::NodeType::STORAGE, *_distribution, *_clusterState,
+                                   buckets, nodes, upStates);
 }
 
 }
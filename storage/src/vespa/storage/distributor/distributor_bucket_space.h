@@ -1,7 +1,8 @@
 // Copyright 2017 Yahoo Holdings. Licensed under the terms of the Apache 2.0 license. See LICENSE in the project root.
 #pragma once
 
-#include <vespa/storage/bucketdb/mapbucketdatabase.h>
+#include <vespa/storage/bucketdb/bucketdatabase.h>
+#include <vespa/vdslib/distribution/idealnodecalculatorcache.h>
 #include <memory>
 
 namespace storage::lib {
@@ -16,18 +17,24 @@ namespace storage::distributor {
  * keeping track of, and computing operations for, a single bucket space:
  *
  * Bucket database instance
- *   Each bucket space has its own entirely separate bucket database.
+ *   Each bucket space has its own entirely separate bucket database, which
+ *   is either the legacy trie-based database or the B-tree database.
  * Distribution config
  *   Each bucket space _may_ operate with its own distribution config, in
  *   particular so that redundancy, ready copies etc can differ across
  *   bucket spaces.
+ * Ideal nodes cache
+ *   Ideal storage nodes calculated for the current cluster state and
+ *   distribution config. Cleared whenever either of them is set.
  */
 class DistributorBucketSpace {
-    MapBucketDatabase _bucketDatabase;
+    std::unique_ptr<BucketDatabase> _bucketDatabase;
     std::shared_ptr<const lib::ClusterState> _clusterState;
     std::shared_ptr<const lib::Distribution> _distribution;
+    lib::IdealNodeCalculatorCache _idealNodesCache;
 public:
     DistributorBucketSpace();
+    explicit DistributorBucketSpace(bool useBTreeDatabase);
     ~DistributorBucketSpace();
 
     DistributorBucketSpace(const DistributorBucketSpace&) = delete;
@@ -36,10 +43,10 @@ public:
     DistributorBucketSpace& operator=(DistributorBucketSpace&&) = delete;
 
     BucketDatabase& getBucketDatabase() noexcept {
-        return _bucketDatabase;
+        return *_bucketDatabase;
     }
     const BucketDatabase& getBucketDatabase() const noexcept {
-        return _bucketDatabase;
+        return *_bucketDatabase;
     }
 
     void setClusterState(std::shared_ptr<const lib::ClusterState> clusterState);
@@ -53,6 +60,31 @@ public:
         return *_distribution;
     }
 
+    /**
+     * Ideal storage nodes of the bucket in the current cluster state, using
+     * the up states given.
+     *
+     * Precondition: setClusterState and setDistribution have been called.
+     */
+    std::vector<uint16_t> getIdealStorageNodes(const document::BucketId& bucket,
+                                               const char* upStates = "uim") const;
+    /** Batched version of getIdealStorageNodes(). */
+    void getIdealStorageNodes(const std::vector<document::BucketId>& buckets,
+                              std::vector<std::vector<uint16_t>>& nodes,
+                              const char* upStates = "uim") const;
+    /**
+     * Unless the ideal storage nodes of the bucket are already cached,
+     * calculates them for the bucket and up to maxBuckets - 1 buckets
+     * following it in the bucket database, in one batch. Used when
+     * iterating the database in order, such as when it is scanned for
+     * maintenance after a cluster state change.
+     */
+    void prefetchIdealStorageNodes(const document::BucketId& bucket, size_t maxBuckets,
+                                   const char* upStates = "uim") const;
+    const lib::IdealNodeCalculatorCache& getIdealNodesCache() const noexcept {
+        return _idealNodesCache;
+    }
+
 };
 
 }
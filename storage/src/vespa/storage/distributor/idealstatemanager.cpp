@@ -23,6 +23,12 @@ using storage::lib::NodeType;
 namespace storage {
 namespace distributor {
 
+namespace {
+
+constexpr size_t IDEAL_STATE_PREFETCH_BUCKETS = 128;
+
+}
+
 IdealStateManager::IdealStateManager(
         Distributor& owner,
         DistributorBucketSpaceRepo& bucketSpaceRepo,
@@ -168,6 +174,10 @@ IdealStateManager::prioritize(
         const document::Bucket &bucket,
         NodeMaintenanceStatsTracker& statsTracker) const
 {
+    // Buckets are prioritized in bucket database order by the maintenance
+    // scanner, so calculate the ideal state of the buckets ahead in batches.
+    _bucketSpaceRepo.get(bucket.getBucketSpace()).prefetchIdealStorageNodes(
+            bucket.getBucketId(), IDEAL_STATE_PREFETCH_BUCKETS);
     StateChecker::Result generated(
             generateHighestPriority(bucket, statsTracker));
     MaintenancePriority priority(generated.getPriority());
@@ -22,6 +22,16 @@ public:
     typedef std::shared_ptr<MaintenanceOperation> SP;
 
     virtual const std::string& getDetailedReason() const = 0;
+
+    /**
+       Returns the type of operation this is.
+    */
+    virtual Type getType() const = 0;
+
+    /**
+       Returns the content nodes this operation will send messages to.
+    */
+    virtual const std::vector<uint16_t>& getNodes() const = 0;
 };
 
 } // distributor
@@ -4,6 +4,7 @@
 #include "bucketprioritydatabase.h"
 #include <set>
 #include <map>
+#include <unordered_map>
 
 namespace storage {
 namespace distributor {
@@ -23,6 +24,7 @@ public:
 private:
     typedef std::set<document::Bucket> BucketSet;
     typedef std::map<Priority, BucketSet> PriorityMap;
+    typedef std::unordered_map<document::Bucket, Priority, document::Bucket::hash> BucketIndex;
 
     class SimpleConstIteratorImpl : public ConstIteratorImpl
     {
@@ -59,6 +61,9 @@ private:
     void clearAllEntriesForBucket(const document::Bucket &bucket);
 
     PriorityMap _prioritizedBuckets;
+    // Priority each bucket is currently stored at, so that changing the
+    // priority of a bucket does not have to visit every priority level.
+    BucketIndex _bucketPriorities;
 };
 
 }
@@ -0,0 +1,119 @@
+// Copyright 2019 Oath Inc. Licensed under the terms of the Apache 2.0 license. See LICENSE in the project root.
+
+#include "nodebudgetoperationstarter.h"
+#include "nodeinfo.h"
+#include <algorithm>
+#include <cassert>
+
+namespace storage::distributor {
+
+NodeBudgetOperationStarter::BudgetedOperation::~BudgetedOperation()
+{
+    _operationStarter.signalOperationFinished(_nodes, _type);
+}
+
+NodeBudgetOperationStarter::NodeBudgetOperationStarter(const NodeInfo& nodeInfo,
+                                                       OperationStarter& starterImpl)
+    : _nodeInfo(nodeInfo),
+      _starterImpl(starterImpl),
+      _maxPendingPerNode(),
+      _latencyTarget(0),
+      _queueDepthTarget(0),
+      _pending()
+{
+    _maxPendingPerNode.fill(UINT32_MAX);
+}
+
+NodeBudgetOperationStarter::~NodeBudgetOperationStarter() = default;
+
+bool
+NodeBudgetOperationStarter::isBudgeted(Type type)
+{
+    switch (type) {
+    case MaintenanceOperation::MERGE_BUCKET:
+    case MaintenanceOperation::SPLIT_BUCKET:
+    case MaintenanceOperation::JOIN_BUCKET:
+    case MaintenanceOperation::GARBAGE_COLLECTION:
+        return true;
+    default:
+        return false;
+    }
+}
+
+uint32_t
+NodeBudgetOperationStarter::getBudget(uint16_t node, Type type) const
+{
+    const uint32_t maxPending = _maxPendingPerNode[type];
+    double scale = 1.0;
+    const auto latency = _nodeInfo.getAverageLatency(node);
+    if (_latencyTarget.count() > 0 && latency > _latencyTarget) {
+        scale *= static_cast<double>(_latencyTarget.count()) / latency.count();
+    }
+    const uint32_t queueDepth = _nodeInfo.getPendingCount(node);
+    if (_queueDepthTarget > 0 && queueDepth > _queueDepthTarget) {
+        scale *= static_cast<double>(_queueDepthTarget) / queueDepth;
+    }
+    if (scale >= 1.0) {
+        return maxPending;
+    }
+    return std::max(uint32_t(1), static_cast<uint32_t>(maxPending * scale));
+}
+
+uint32_t
+NodeBudgetOperationStarter::getPendingCount(uint16_t node, Type type) const
+{
+    if (node >= _pending.size()) {
+        return 0;
+    }
+    return _pending[node][type];
+}
+
+bool
+NodeBudgetOperationStarter::withinBudget(const std::vector<uint16_t>& nodes, Type type) const
+{
+    for (uint16_t node : nodes) {
+        if (getPendingCount(node, type) >= getBudget(node, type)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void
+NodeBudgetOperationStarter::signalOperationStarted(const std::vector<uint16_t>& nodes, Type type)
+{
+    for (uint16_t node : nodes) {
+        if (node >= _pending.size()) {
+            _pending.resize(node + 1, PendingPerType());
+        }
+        ++_pending[node][type];
+    }
+}
+
+void
+NodeBudgetOperationStarter::signalOperationFinished(const std::vector<uint16_t>& nodes, Type type)
+{
+    for (uint16_t node : nodes) {
+        assert(node < _pending.size() && _pending[node][type] > 0);
+        --_pending[node][type];
+    }
+}
+
+bool
+NodeBudgetOperationStarter::start(const std::shared_ptr<Operation>& operation, Priority priority)
+{
+    auto* maintenanceOp = dynamic_cast<MaintenanceOperation*>(operation.get());
+    if (maintenanceOp == nullptr || !isBudgeted(maintenanceOp->getType())) {
+        return _starterImpl.start(operation, priority);
+    }
+    const Type type = maintenanceOp->getType();
+    const std::vector<uint16_t>& nodes = maintenanceOp->getNodes();
+    if (!withinBudget(nodes, type)) {
+        return true;
+    }
+    signalOperationStarted(nodes, type);
+    auto budgetedOp = std::make_shared<BudgetedOperation>(operation, type, nodes, *this);
+    return _starterImpl.start(budgetedOp, priority);
+}
+
+}
@@ -0,0 +1,129 @@
+// Copyright 2019 Oath Inc. Licensed under the terms of the Apache 2.0 license. See LICENSE in the project root.
+#pragma once
+
+#include "operationstarter.h"
+#include <vespa/storage/distributor/maintenance/maintenanceoperation.h>
+#include <vespa/vespalib/util/hdr_abort.h>
+#include <array>
+#include <chrono>
+#include <vector>
+
+namespace storage::distributor {
+
+class NodeInfo;
+
+/**
+ * Limits the number of pending merge, split, join and garbage collection
+ * operations towards each content node. Every node gets a budget per
+ * operation type, which is shrunk proportionally when the average latency
+ * observed towards the node exceeds the latency target, or when the number
+ * of messages pending towards the node exceeds the queue depth target. A
+ * node is always allowed at least one pending operation of each type, so
+ * maintenance makes progress even while the node is loaded by feed.
+ *
+ * An operation towards a node whose budget is exhausted is not started, but
+ * is reported as handled in the same way as a blocked operation. The bucket
+ * is then picked up again by the next database scan, and less important
+ * buckets towards other nodes are not held back in the meantime.
+ */
+class NodeBudgetOperationStarter : public OperationStarter
+{
+    using Type = MaintenanceOperation::Type;
+
+    class BudgetedOperation : public Operation
+    {
+    public:
+        BudgetedOperation(const Operation::SP& operation,
+                          Type type,
+                          const std::vector<uint16_t>& nodes,
+                          NodeBudgetOperationStarter& operationStarter)
+            : _operation(operation),
+              _type(type),
+              _nodes(nodes),
+              _operationStarter(operationStarter)
+        {}
+        BudgetedOperation(const BudgetedOperation&) = delete;
+        BudgetedOperation& operator=(const BudgetedOperation&) = delete;
+
+        ~BudgetedOperation();
+    private:
+        Operation::SP _operation;
+        Type _type;
+        std::vector<uint16_t> _nodes;
+        NodeBudgetOperationStarter& _operationStarter;
+
+        void onClose(DistributorMessageSender& sender) override {
+            _operation->onClose(sender);
+        }
+        const char* getName() const override {
+            return _operation->getName();
+        }
+        std::string getStatus() const override {
+            return _operation->getStatus();
+        }
+        std::string toString() const override {
+            return _operation->toString();
+        }
+        void start(DistributorMessageSender& sender, framework::MilliSecTime startTime) override {
+            _operation->start(sender, startTime);
+        }
+        void receive(DistributorMessageSender& sender, const std::shared_ptr<api::StorageReply> & msg) override {
+            _operation->receive(sender, msg);
+        }
+        void onStart(DistributorMessageSender&) override {
+            HDR_ABORT("should not be reached");
+        }
+        void onReceive(DistributorMessageSender&,
+                       const std::shared_ptr<api::StorageReply>&) override {
+            HDR_ABORT("should not be reached");
+        }
+    };
+
+    using PendingPerType = std::array<uint32_t, MaintenanceOperation::OPERATION_COUNT>;
+
+    const NodeInfo& _nodeInfo;
+    OperationStarter& _starterImpl;
+    PendingPerType _maxPendingPerNode;
+    std::chrono::milliseconds _latencyTarget;
+    uint32_t _queueDepthTarget;
+    std::vector<PendingPerType> _pending;
+public:
+    NodeBudgetOperationStarter(const NodeInfo& nodeInfo, OperationStarter& starterImpl);
+    NodeBudgetOperationStarter(const NodeBudgetOperationStarter&) = delete;
+    NodeBudgetOperationStarter& operator=(const NodeBudgetOperationStarter&) = delete;
+    ~NodeBudgetOperationStarter() override;
+
+    bool start(const std::shared_ptr<Operation>& operation, Priority priority) override;
+
+    /**
+     * Returns true if the given operation type is subject to per node
+     * budgets at all. Other operation types are always passed through.
+     */
+    static bool isBudgeted(Type type);
+
+    void setMaxPendingPerNode(Type type, uint32_t maxPending) {
+        _maxPendingPerNode[type] = maxPending;
+    }
+    /** Zero disables adjusting budgets by latency. */
+    void setLatencyTarget(std::chrono::milliseconds target) {
+        _latencyTarget = target;
+    }
+    /** Zero disables adjusting budgets by queue depth. */
+    void setQueueDepthTarget(uint32_t target) {
+        _queueDepthTarget = target;
+    }
+
+    /**
+     * Returns the number of operations of the given type that may currently
+     * be pending towards the node.
+     */
+    uint32_t getBudget(uint16_t node, Type type) const;
+    uint32_t getPendingCount(uint16_t node, Type type) const;
+
+private:
+    bool withinBudget(const std::vector<uint16_t>& nodes, Type type) const;
+    void signalOperationStarted(const std::vector<uint16_t>& nodes, Type type);
+    void signalOperationFinished(const std::vector<uint16_t>& nodes, Type type);
+};
+
+}
@@ -46,6 +46,21 @@ void NodeInfo::clearPending(uint16_t idx) {
     info._pending = 0;
 }
 
+void NodeInfo::addLatency(uint16_t idx, std::chrono::milliseconds latency) {
+    SingleNodeInfo& info = getNode(idx);
+    const double sample = latency.count();
+    if (info._averageLatencyMs == 0) {
+        info._averageLatencyMs = sample;
+    } else {
+        // Same smoothing as TCP uses for its round-trip time estimate.
+        info._averageLatencyMs += (sample - info._averageLatencyMs) / 8;
+    }
+}
+
+std::chrono::milliseconds NodeInfo::getAverageLatency(uint16_t idx) const {
+    return std::chrono::milliseconds(static_cast<int64_t>(getNode(idx)._averageLatencyMs));
+}
+
 NodeInfo::SingleNodeInfo& NodeInfo::getNode(uint16_t idx) {
     const auto index_lbound = static_cast<size_t>(idx) + 1;
     while (_nodes.size() < index_lbound) {
@@ -8,6 +8,7 @@
 #pragma once
 
 #include <vector>
+#include <chrono>
 #include <vespa/storageframework/generic/clock/time.h>
 
 namespace storage::distributor {
@@ -28,12 +29,22 @@ public:
 
     void clearPending(uint16_t idx);
 
+    /**
+     * Adds the observed round-trip latency of a client operation to the node
+     * to its moving average latency.
+     */
+    void addLatency(uint16_t idx, std::chrono::milliseconds latency);
+
+    /** Returns zero if no latency has been observed for the node. */
+    std::chrono::milliseconds getAverageLatency(uint16_t idx) const;
+
 private:
     struct SingleNodeInfo {
-        SingleNodeInfo() : _pending(0), _busyUntilTime() {}
+        SingleNodeInfo() : _pending(0), _busyUntilTime(), _averageLatencyMs(0) {}
 
         uint32_t _pending;
         mutable framework::MonotonicTimePoint _busyUntilTime;
+        double _averageLatencyMs;
     };
 
     mutable std::vector<SingleNodeInfo> _nodes;
@@ -135,7 +135,7 @@ public:
 
        @return The target nodes
     */
-    const std::vector<uint16_t>& getNodes() const { return _bucketAndNodes.getNodes(); }
+    const std::vector<uint16_t>& getNodes() const override { return _bucketAndNodes.getNodes(); }
 
     /**
        Returns the target bucket of the operation.
@@ -167,11 +167,6 @@ public:
     */
     void setIdealStateManager(IdealStateManager* manager);
 
-    /**
-       Returns the type of operation this is.
-    */
-    virtual Type getType() const = 0;
-
     /**
        Set the priority we should send messages from this operation with.
     */
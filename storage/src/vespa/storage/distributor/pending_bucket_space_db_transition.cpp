@@ -6,6 +6,7 @@
 #include "distributor_bucket_space.h"
 #include <vespa/storage/common/bucketoperationlogger.h>
 #include <algorithm>
+#include <cassert>
 
 #include <vespa/log/log.h>
 LOG_SETUP(".pendingbucketspacedbtransition");
@@ -24,9 +25,6 @@ PendingBucketSpaceDbTransition::PendingBucketSpaceDbTransition(const PendingClus
                                                                const lib::ClusterState &newClusterState,
                                                                api::Timestamp creationTimestamp)
     : _entries(),
-      _iter(0),
-      _removedBuckets(),
-      _missingEntries(),
       _clusterInfo(std::move(clusterInfo)),
       _outdatedNodes(newClusterState.getNodeCount(NodeType::STORAGE)),
       _prevClusterState(distributorBucketSpace.getClusterState()),
@@ -53,12 +51,62 @@ PendingBucketSpaceDbTransition::~PendingBucketSpaceDbTransition()
 {
 }
 
+/**
+ * Merges the sorted bucket info results into the bucket database, which is
+ * iterated in the same (bucket key) order. A shard starts at the first
+ * result at or after the first bucket key it is given, and results it does
+ * not reach are picked up as new buckets when the shards are joined.
+ */
+class PendingBucketSpaceDbTransition::DbMerger : public BucketDatabase::Merger {
+    const PendingBucketSpaceDbTransition& _transition;
+    const EntryList&                      _entries;
+    const uint32_t                        _first;
+    uint32_t                              _iter;
+    std::vector<Range>                    _missingEntries;
+    SuperbucketIdealNodesCache            _idealNodes;
+
+    /**
+     * Skips through all entries for the same bucket and returns
+     * the range in the entry list for which they were found.
+     * The range is [from, to>
+     */
+    Range skipAllForSameBucket();
+
+    void insertInfo(BucketDatabase::Entry& info, const Range& range);
+    void addToBucketDB(TrailingInserter& inserter, const Range& range);
+
+    // Helper methods for iterating over _entries
+    bool databaseIteratorHasPassedBucketInfoIterator(const document::BucketId& bucketId) const;
+    bool bucketInfoIteratorPointsToBucket(const document::BucketId& bucketId) const;
+public:
+    DbMerger(const PendingBucketSpaceDbTransition& transition, uint32_t first);
+    ~DbMerger() override;
+
+    Result merge(BucketDatabase::Entry& e) override;
+    void insert_remaining_at_end(TrailingInserter& inserter) override;
+    std::unique_ptr<BucketDatabase::Merger> create_shard(uint64_t first_key) override;
+    void join_shard(BucketDatabase::Merger& shard) override;
+};
+
+PendingBucketSpaceDbTransition::DbMerger::DbMerger(const PendingBucketSpaceDbTransition& transition, uint32_t first)
+    : _transition(transition),
+      _entries(transition._entries),
+      _first(first),
+      _iter(first),
+      _missingEntries(),
+      _idealNodes(transition._distributorBucketSpace.getDistribution(), transition._newClusterState,
+                  "uim", transition._clusterInfo->getStorageUpStates())
+{
+}
+
+PendingBucketSpaceDbTransition::DbMerger::~DbMerger() = default;
+
 PendingBucketSpaceDbTransition::Range
-PendingBucketSpaceDbTransition::skipAllForSameBucket()
+PendingBucketSpaceDbTransition::DbMerger::skipAllForSameBucket()
 {
     Range r(_iter, _iter);
 
-    for (document::BucketId& bid = _entries[_iter].bucketId;
+    for (const document::BucketId& bid = _entries[_iter].bucketId;
          _iter < _entries.size() && _entries[_iter].bucketId == bid;
          ++_iter)
     {
@@ -69,7 +117,7 @@ PendingBucketSpaceDbTransition::skipAllForSameBucket()
 }
 
 std::vector<BucketCopy>
-PendingBucketSpaceDbTransition::getCopiesThatAreNewOrAltered(BucketDatabase::Entry& info, const Range& range)
+PendingBucketSpaceDbTransition::getCopiesThatAreNewOrAltered(BucketDatabase::Entry& info, const Range& range) const
 {
     std::vector<BucketCopy> copiesToAdd;
     for (uint32_t i = range.first; i < range.second; ++i) {
@@ -84,17 +132,13 @@ PendingBucketSpaceDbTransition::getCopiesThatAreNewOrAltered(BucketDatabase::Ent
 }
 
 void
-PendingBucketSpaceDbTransition::insertInfo(BucketDatabase::Entry& info, const Range& range)
+PendingBucketSpaceDbTransition::DbMerger::insertInfo(BucketDatabase::Entry& info, const Range& range)
 {
     std::vector<BucketCopy> copiesToAddOrUpdate(
-            getCopiesThatAreNewOrAltered(info, range));
+            _transition.getCopiesThatAreNewOrAltered(info, range));
 
-    const auto &dist(_distributorBucketSpace.getDistribution());
-    std::vector<uint16_t> order(
-            dist.getIdealStorageNodes(
-                    _newClusterState,
-                    _entries[range.first].bucketId,
-                    _clusterInfo->getStorageUpStates()));
+    const std::vector<uint16_t>& order(
+            _idealNodes.getIdealStorageNodes(_entries[range.first].bucketId));
     info->addNodes(copiesToAddOrUpdate, order, TrustedUpdate::DEFER);
 
     LOG_BUCKET_OPERATION_NO_LOCK(
@@ -104,13 +148,13 @@ PendingBucketSpaceDbTransition::insertInfo(BucketDatabase::Entry& info, const Ra
 }
 
 std::string
-PendingBucketSpaceDbTransition::requestNodesToString()
+PendingBucketSpaceDbTransition::requestNodesToString() const
 {
     return _pendingClusterState.requestNodesToString();
 }
 
 bool
-PendingBucketSpaceDbTransition::removeCopiesFromNodesThatWereRequested(BucketDatabase::Entry& e, const document::BucketId& bucketId)
+PendingBucketSpaceDbTransition::removeCopiesFromNodesThatWereRequested(BucketDatabase::Entry& e, const document::BucketId& bucketId) const
 {
     bool updated = false;
     for (uint32_t i = 0; i < e->getNodeCount();) {
@@ -139,26 +183,26 @@ PendingBucketSpaceDbTransition::removeCopiesFromNodesThatWereRequested(BucketDat
 }
 
 bool
-PendingBucketSpaceDbTransition::databaseIteratorHasPassedBucketInfoIterator(const document::BucketId& bucketId) const
+PendingBucketSpaceDbTransition::DbMerger::databaseIteratorHasPassedBucketInfoIterator(const document::BucketId& bucketId) const
 {
     return (_iter < _entries.size()
             && _entries[_iter].bucketId.toKey() < bucketId.toKey());
 }
 
 bool
-PendingBucketSpaceDbTransition::bucketInfoIteratorPointsToBucket(const document::BucketId& bucketId) const
+PendingBucketSpaceDbTransition::DbMerger::bucketInfoIteratorPointsToBucket(const document::BucketId& bucketId) const
 {
     return _iter < _entries.size() && _entries[_iter].bucketId == bucketId;
 }
 
-bool
-PendingBucketSpaceDbTransition::process(BucketDatabase::Entry& e)
+BucketDatabase::Merger::Result
+PendingBucketSpaceDbTransition::DbMerger::merge(BucketDatabase::Entry& e)
 {
     document::BucketId bucketId(e.getBucketId());
 
     LOG(spam,
         "Before merging info from nodes [%s], bucket %s had info %s",
-        requestNodesToString().c_str(),
+        _transition.requestNodesToString().c_str(),
         bucketId.toString().c_str(),
         e.getBucketInfo().toString().c_str());
 
@@ -169,7 +213,7 @@ PendingBucketSpaceDbTransition::process(BucketDatabase::Entry& e)
         _missingEntries.push_back(skipAllForSameBucket());
     }
 
-    bool updated(removeCopiesFromNodesThatWereRequested(e, bucketId));
+    bool updated(_transition.removeCopiesFromNodesThatWereRequested(e, bucketId));
 
     if (bucketInfoIteratorPointsToBucket(bucketId)) {
         LOG(spam, "Updating bucket %s",
@@ -182,7 +226,7 @@ PendingBucketSpaceDbTransition::process(BucketDatabase::Entry& e)
     if (updated) {
         // Remove bucket if we've previously removed all nodes from it
         if (e->getNodeCount() == 0) {
-            _removedBuckets.push_back(bucketId);
+            return Result::Skip;
         } else {
             e.getBucketInfo().updateTrusted();
         }
@@ -190,15 +234,52 @@ PendingBucketSpaceDbTransition::process(BucketDatabase::Entry& e)
 
     LOG(spam,
         "After merging info from nodes [%s], bucket %s had info %s",
-        requestNodesToString().c_str(),
+        _transition.requestNodesToString().c_str(),
         bucketId.toString().c_str(),
         e.getBucketInfo().toString().c_str());
 
-    return true;
+    return (updated ? Result::Update : Result::KeepUnchanged);
+}
+
+void
+PendingBucketSpaceDbTransition::DbMerger::insert_remaining_at_end(TrailingInserter& inserter)
+{
+    // All of the remaining were not already in the bucket database.
+    while (_iter < _entries.size()) {
+        _missingEntries.push_back(skipAllForSameBucket());
+    }
+
+    for (uint32_t i = 0; i < _missingEntries.size(); ++i) {
+        addToBucketDB(inserter, _missingEntries[i]);
+    }
+}
+
+std::unique_ptr<BucketDatabase::Merger>
+PendingBucketSpaceDbTransition::DbMerger::create_shard(uint64_t first_key)
+{
+    auto first = std::lower_bound(_entries.begin(), _entries.end(), first_key,
+                                  [](const Entry& entry, uint64_t key) {
+                                      return (entry.bucketId.toKey() < key);
+                                  });
+    return std::make_unique<DbMerger>(_transition, first - _entries.begin());
+}
+
+void
+PendingBucketSpaceDbTransition::DbMerger::join_shard(BucketDatabase::Merger& merger)
+{
+    auto& shard = static_cast<DbMerger&>(merger);
+    // Results between where the previous shard stopped and where this one
+    // started were never reached by any shard.
+    assert(_iter <= shard._first);
+    while (_iter < shard._first) {
+        _missingEntries.push_back(skipAllForSameBucket());
+    }
+    _missingEntries.insert(_missingEntries.end(), shard._missingEntries.begin(), shard._missingEntries.end());
+    _iter = shard._iter;
 }
 
 void
-PendingBucketSpaceDbTransition::addToBucketDB(BucketDatabase& db, const Range& range)
+PendingBucketSpaceDbTransition::DbMerger::addToBucketDB(TrailingInserter& inserter, const Range& range)
 {
     LOG(spam, "Adding new bucket %s with %d copies",
         _entries[range.first].bucketId.toString().c_str(),
@@ -208,33 +289,24 @@ PendingBucketSpaceDbTransition::addToBucketDB(BucketDatabase& db, const Range& r
     insertInfo(e, range);
     if (e->getLastGarbageCollectionTime() == 0) {
         e->setLastGarbageCollectionTime(
-                framework::MicroSecTime(_creationTimestamp)
+                framework::MicroSecTime(_transition._creationTimestamp)
                     .getSeconds().getTime());
     }
     e.getBucketInfo().updateTrusted();
-    db.update(e);
+    inserter.insert_at_end(e);
 }
 
 void
-PendingBucketSpaceDbTransition::mergeIntoBucketDatabase()
+PendingBucketSpaceDbTransition::mergeIntoBucketDatabase(vespalib::Executor* executor, size_t numShards)
 {
     BucketDatabase &db(_distributorBucketSpace.getBucketDatabase());
     std::sort(_entries.begin(), _entries.end());
 
-    db.forEach(*this);
-
-    for (uint32_t i = 0; i < _removedBuckets.size(); ++i) {
-        db.remove(_removedBuckets[i]);
-    }
-    _removedBuckets.clear();
-
-    // All of the remaining were not already in the bucket database.
-    while (_iter < _entries.size()) {
-        _missingEntries.push_back(skipAllForSameBucket());
-    }
-
-    for (uint32_t i = 0; i < _missingEntries.size(); ++i) {
-        addToBucketDB(db, _missingEntries[i]);
+    DbMerger merger(*this, 0);
+    if ((executor != nullptr) && (numShards > 1)) {
+        db.parallel_merge(merger, *executor, numShards);
+    } else {
+        db.merge(merger);
     }
 }
 
@@ -3,9 +3,12 @@
 
 #include "pending_bucket_space_db_transition_entry.h"
 #include "outdated_nodes.h"
+#include "superbucket_ideal_nodes_cache.h"
 #include <vespa/storage/bucketdb/bucketdatabase.h>
+#include <memory>
 #include <unordered_map>
 
+namespace vespalib { class Executor; }
 namespace storage::api { class RequestBucketInfoReply; }
 namespace storage::lib { class ClusterState; class State; }
 
@@ -19,8 +22,12 @@ class DistributorBucketSpace;
  * Class used by PendingClusterState to track request bucket info
  * reply result within a bucket space and apply it to the distributor
  * bucket database when switching to the pending cluster state.
+ *
+ * The results are applied as a single BucketDatabase::merge() pass, with new
+ * buckets inserted at the end of it. The existing buckets may be merged with
+ * the results in parallel, by shards covering consecutive bucket key ranges.
  */
-class PendingBucketSpaceDbTransition : public BucketDatabase::MutableEntryProcessor
+class PendingBucketSpaceDbTransition
 {
 public:
     using Entry = dbtransition::Entry;
@@ -28,11 +35,9 @@ public:
     using OutdatedNodes = dbtransition::OutdatedNodes;
 private:
     using Range = std::pair<uint32_t, uint32_t>;
+    class DbMerger;
 
     EntryList                                 _entries;
-    uint32_t                                  _iter;
-    std::vector<document::BucketId>           _removedBuckets;
-    std::vector<Range>                        _missingEntries;
     std::shared_ptr<const ClusterInformation> _clusterInfo;
 
     // Set for all nodes that may have changed state since that previous
@@ -51,19 +56,7 @@ private:
     bool                                      _bucketOwnershipTransfer;
     std::unordered_map<uint16_t, size_t>      _rejectedRequests;
 
-    // BucketDataBase::MutableEntryProcessor API
-    bool process(BucketDatabase::Entry& e) override;
-
-    /**
-     * Skips through all entries for the same bucket and returns
-     * the range in the entry list for which they were found.
-     * The range is [from, to>
-     */
-    Range skipAllForSameBucket();
-
-    std::vector<BucketCopy> getCopiesThatAreNewOrAltered(BucketDatabase::Entry& info, const Range& range);
-    void insertInfo(BucketDatabase::Entry& info, const Range& range);
-    void addToBucketDB(BucketDatabase& db, const Range& range);
+    std::vector<BucketCopy> getCopiesThatAreNewOrAltered(BucketDatabase::Entry& info, const Range& range) const;
 
     bool nodeIsOutdated(uint16_t node) const {
         return (_outdatedNodes.find(node) != _outdatedNodes.end());
@@ -72,12 +65,9 @@ private:
     // Returns whether at least one replica was removed from the entry.
     // Does NOT implicitly update trusted status on remaining replicas; caller must do
     // this explicitly.
-    bool removeCopiesFromNodesThatWereRequested(BucketDatabase::Entry& e, const document::BucketId& bucketId);
+    bool removeCopiesFromNodesThatWereRequested(BucketDatabase::Entry& e, const document::BucketId& bucketId) const;
 
-    // Helper methods for iterating over _entries
-    bool databaseIteratorHasPassedBucketInfoIterator(const document::BucketId& bucketId) const;
-    bool bucketInfoIteratorPointsToBucket(const document::BucketId& bucketId) const;
-    std::string requestNodesToString();
+    std::string requestNodesToString() const;
 
     bool distributorChanged();
     static bool nodeWasUpButNowIsDown(const lib::State &old, const lib::State &nw);
@@ -101,8 +91,12 @@ public:
                                    api::Timestamp creationTimestamp);
     ~PendingBucketSpaceDbTransition();
 
-    // Merges all the results with the corresponding bucket database.
-    void mergeIntoBucketDatabase();
+    /**
+     * Merges all the results with the corresponding bucket database. If an
+     * executor is given, the existing buckets are merged by up to numShards
+     * shards running on it, while the calling thread waits.
+     */
+    void mergeIntoBucketDatabase(vespalib::Executor* executor = nullptr, size_t numShards = 1);
 
     // Adds the info from the reply to our list of information.
     void onRequestBucketInfoReply(const api::RequestBucketInfoReply &reply, uint16_t node);
@@ -315,10 +315,10 @@ PendingClusterState::requestNodesToString() const
 }
 
 void
-PendingClusterState::mergeIntoBucketDatabases()
+PendingClusterState::mergeIntoBucketDatabases(vespalib::Executor* executor, size_t numShards)
 {
     for (auto &elem : _pendingTransitions) {
-        elem.second->mergeIntoBucketDatabase();
+        elem.second->mergeIntoBucketDatabase(executor, numShards);
     }
 }
 
@@ -14,6 +14,8 @@
 #include <unordered_map>
 #include <deque>
 
+namespace vespalib { class Executor; }
+
 namespace storage::distributor {
 
 class DistributorMessageSender;
@@ -147,9 +149,11 @@ public:
     OutdatedNodesMap getOutdatedNodesMap() const;
 
     /**
-     * Merges all the results with the corresponding bucket databases.
+     * Merges all the results with the corresponding bucket databases. If an
+     * executor is given, each database is merged by up to numShards shards
+     * running on it.
      */
-    void mergeIntoBucketDatabases();
+    void mergeIntoBucketDatabases(vespalib::Executor* executor = nullptr, size_t numShards = 1);
     // Get pending transition for a specific bucket space. Only used by unit test.
     PendingBucketSpaceDbTransition &getPendingBucketSpaceDbTransition(document::BucketSpace bucketSpace);
 
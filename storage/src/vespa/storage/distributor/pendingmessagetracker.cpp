@@ -115,6 +115,7 @@ PendingMessageTracker::reply(const api::StorageReply& r)
     if (iter != msgs.end()) {
         bucket = iter->bucket;
         _nodeInfo.decPending(r.getAddress()->getIndex());
+        updateNodeStatsOnReply(*iter);
         api::ReturnCode::Result code = r.getResult().getResult();
         if (code == api::ReturnCode::BUSY || code == api::ReturnCode::TIMEOUT) {
             _nodeInfo.setBusy(r.getAddress()->getIndex(), _nodeBusyDuration);
@@ -128,6 +129,38 @@ PendingMessageTracker::reply(const api::StorageReply& r)
 
 namespace {
 
+/**
+ * Only client operations are expected to complete quickly on a healthy node.
+ * Maintenance operations such as merges routinely take seconds and would
+ * drown out the latency signal if they were included.
+ */
+bool
+isLatencySampled(uint32_t msgType)
+{
+    switch (msgType) {
+    case api::MessageType::GET_ID:
+    case api::MessageType::PUT_ID:
+    case api::MessageType::REMOVE_ID:
+    case api::MessageType::UPDATE_ID:
+        return true;
+    default:
+        return false;
+    }
+}
+
+}
+
+void
+PendingMessageTracker::updateNodeStatsOnReply(const MessageEntry& entry)
+{
+    const TimePoint now = currentTime();
+    if (isLatencySampled(entry.msgType) && (now >= entry.timeStamp)) {
+        _nodeInfo.addLatency(entry.nodeIdx, now - entry.timeStamp);
+    }
+}
+
+namespace {
+
 template <typename Range>
 void
 runCheckerOnRange(PendingMessageTracker::Checker& checker, const Range& range)
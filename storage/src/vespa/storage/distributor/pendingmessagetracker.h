@@ -155,12 +155,13 @@ private:
     mutable std::mutex _lock;
 
     /**
-     * Increment latency and operation count stats for the node the message
-     * was sent towards based on the registered send time and the current time.
+     * Update the average latency of the node the message was sent towards
+     * based on the registered send time and the current time. Only client
+     * operations (get, put, remove and update) are sampled, as long-running
+     * maintenance operations would skew the average.
      *
      * In the event that system time has moved backwards across sending a
-     * command and reciving its reply, the latency will not be recorded but
-     * the total number of messages will increase.
+     * command and reciving its reply, the latency will not be recorded.
      *
      * _lock MUST be held upon invocation.
      */
@@ -68,6 +68,7 @@ StateChecker::Context::Context(const DistributorComponent& c,
       systemState(distributorBucketSpace.getClusterState()),
       distributorConfig(c.getDistributor().getConfig()),
       distribution(distributorBucketSpace.getDistribution()),
+      bucketSpace(distributorBucketSpace),
       gcTimeCalculator(c.getDistributor().getBucketIdHasher(),
                        std::chrono::seconds(distributorConfig
                             .getGarbageCollectionInterval())),
@@ -75,8 +76,7 @@ StateChecker::Context::Context(const DistributorComponent& c,
       db(distributorBucketSpace.getBucketDatabase()),
       stats(statsTracker)
 {
-    idealState =
-        distribution.getIdealStorageNodes(systemState, bucket.getBucketId());
+    idealState = bucketSpace.getIdealStorageNodes(bucket.getBucketId());
     unorderedIdealState.insert(idealState.begin(), idealState.end());
 }
 
@@ -66,6 +66,7 @@ public:
         const lib::ClusterState& systemState;
         const DistributorConfiguration& distributorConfig;
         const lib::Distribution& distribution;
+        const DistributorBucketSpace& bucketSpace;
 
         BucketGcTimeCalculator gcTimeCalculator;
 
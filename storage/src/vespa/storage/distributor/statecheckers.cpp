@@ -2,6 +2,7 @@
 
 #include "statecheckers.h"
 #include "activecopy.h"
+#include "distributor_bucket_space.h"
 #include <vespa/storage/distributor/operations/idealstate/splitoperation.h>
 #include <vespa/storage/distributor/operations/idealstate/joinoperation.h>
 #include <vespa/storage/distributor/operations/idealstate/removebucketoperation.h>
@@ -182,8 +183,7 @@ bucketAndSiblingReplicaLocationsEqualIdealState(
         return false;
     }
     std::vector<uint16_t> siblingIdealState(
-            context.distribution.getIdealStorageNodes(
-                context.systemState, context.siblingBucket));
+            context.bucketSpace.getIdealStorageNodes(context.siblingBucket));
     if (!equalNodeSet(siblingIdealState, context.siblingEntry)) {
         return false;
     }
@@ -0,0 +1,73 @@
+// Copyright 2019 Oath Inc. Licensed under the terms of the Apache 2.0 license. See LICENSE in the project root.
+
+#include "superbucket_ideal_nodes_cache.h"
+#include <vespa/vdslib/distribution/distribution.h>
+#include <vespa/vdslib/state/clusterstate.h>
+
+namespace storage::distributor {
+
+namespace {
+
+// Buckets using more bits than this get additional storage seed bits
+// from the part of the bucket id that is above the superbucket.
+constexpr uint32_t MaxBitsWithSuperbucketStorageSeed = 33;
+
+}
+
+SuperbucketIdealNodesCache::SuperbucketIdealNodesCache(const lib::Distribution& distribution,
+                                                       const lib::ClusterState& state,
+                                                       const char* distributorUpStates,
+                                                       const char* storageUpStates)
+    : _distribution(distribution),
+      _state(state),
+      _distributorUpStates(distributorUpStates),
+      _storageUpStates(storageUpStates),
+      _distributionBits(state.getDistributionBitCount()),
+      _superbucketMask((uint64_t(1) << _distributionBits) - 1),
+      _distributorSuperbucket(0),
+      _distributor(0),
+      _hasDistributor(false),
+      _storageSuperbucket(0),
+      _storageNodes(),
+      _hasStorageNodes(false),
+      _distributionLookups(0)
+{
+}
+
+SuperbucketIdealNodesCache::~SuperbucketIdealNodesCache() = default;
+
+uint16_t
+SuperbucketIdealNodesCache::getIdealDistributorNode(const document::BucketId& bucket)
+{
+    if (!coveredBySuperbucket(bucket)) {
+        ++_distributionLookups;
+        return _distribution.getIdealDistributorNode(_state, bucket, _distributorUpStates);
+    }
+    const uint64_t superbucket = superbucketOf(bucket);
+    if (!_hasDistributor || (_distributorSuperbucket != superbucket)) {
+        _hasDistributor = false;
+        ++_distributionLookups;
+        _distributor = _distribution.getIdealDistributorNode(_state, bucket, _distributorUpStates);
+        _distributorSuperbucket = superbucket;
+        _hasDistributor = true;
+    }
+    return _distributor;
+}
+
+const std::vector<uint16_t>&
+SuperbucketIdealNodesCache::getIdealStorageNodes(const document::BucketId& bucket)
+{
+    const bool memoizable = (coveredBySuperbucket(bucket)
+                             && (bucket.getUsedBits() <= MaxBitsWithSuperbucketStorageSeed));
+    const uint64_t superbucket = superbucketOf(bucket);
+    if (!memoizable || !_hasStorageNodes || (_storageSuperbucket != superbucket)) {
+        _hasStorageNodes = false;
+        ++_distributionLookups;
+        _storageNodes = _distribution.getIdealStorageNodes(_state, bucket, _storageUpStates);
+        _storageSuperbucket = superbucket;
+        _hasStorageNodes = memoizable;
+    }
+    return _storageNodes;
+}
+
+}
@@ -0,0 +1,67 @@
+// Copyright 2019 Oath Inc. Licensed under the terms of the Apache 2.0 license. See LICENSE in the project root.
+#pragma once
+
+#include <vespa/document/bucket/bucketid.h>
+#include <vector>
+
+namespace storage::lib {
+class ClusterState;
+class Distribution;
+}
+
+namespace storage::distributor {
+
+/**
+ * Memoizes ideal node lookups for the buckets of a single superbucket while
+ * processing buckets in bucket key order, as is done when a new cluster state
+ * is applied to the bucket database.
+ *
+ * The ideal distributor of a bucket is given by its superbucket alone, and so
+ * are its ideal storage nodes as long as the bucket uses no more than 33 bits.
+ * Since the bucket key is the reversed bucket id, all buckets within the same
+ * superbucket are adjacent in key order, and remembering the result for the
+ * most recently seen superbucket is sufficient to avoid running the ideal
+ * state algorithm for every single bucket.
+ *
+ * Lookups throw the same exceptions as the corresponding lib::Distribution
+ * functions. Failed lookups are not memoized.
+ *
+ * Not thread safe, as lookups update the memoized superbucket. Each thread
+ * processing buckets must use its own instance.
+ */
+class SuperbucketIdealNodesCache {
+    const lib::Distribution& _distribution;
+    const lib::ClusterState& _state;
+    const char*              _distributorUpStates;
+    const char*              _storageUpStates;
+    uint32_t                 _distributionBits;
+    uint64_t                 _superbucketMask;
+    uint64_t                 _distributorSuperbucket;
+    uint16_t                 _distributor;
+    bool                     _hasDistributor;
+    uint64_t                 _storageSuperbucket;
+    std::vector<uint16_t>    _storageNodes;
+    bool                     _hasStorageNodes;
+    uint64_t                 _distributionLookups;
+
+    bool coveredBySuperbucket(const document::BucketId& bucket) const {
+        return (bucket.getUsedBits() >= _distributionBits);
+    }
+    uint64_t superbucketOf(const document::BucketId& bucket) const {
+        return (bucket.getRawId() & _superbucketMask);
+    }
+public:
+    SuperbucketIdealNodesCache(const lib::Distribution& distribution,
+                               const lib::ClusterState& state,
+                               const char* distributorUpStates,
+                               const char* storageUpStates);
+    ~SuperbucketIdealNodesCache();
+
+    uint16_t getIdealDistributorNode(const document::BucketId& bucket);
+    const std::vector<uint16_t>& getIdealStorageNodes(const document::BucketId& bucket);
+
+    /** Number of lookups that were forwarded to the distribution. */
+    uint64_t getDistributionLookups() const noexcept { return _distributionLookups; }
+};
+
+}
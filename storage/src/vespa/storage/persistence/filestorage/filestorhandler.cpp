@@ -70,6 +70,13 @@ FileStorHandler::getNextMessage(uint16_t disk, uint32_t stripeId, LockedMessage&
     return _impl->getNextMessage(disk, stripeId, lck);
 }
 
+void
+FileStorHandler::getNextBatch(uint16_t disk, uint32_t stripeId, const LockedMessage& lck, const BatchFilter& accept,
+                              size_t maxBatchSize, std::vector<std::shared_ptr<api::StorageMessage>>& batch)
+{
+    _impl->getNextBatch(disk, stripeId, lck, accept, maxBatchSize, batch);
+}
+
 FileStorHandler::BucketLockInterface::SP
 FileStorHandler::lock(const document::Bucket& bucket, uint16_t disk, api::LockingRequirements lockReq)
 {
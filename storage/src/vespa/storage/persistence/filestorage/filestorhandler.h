@@ -17,6 +17,8 @@
 #include <vespa/document/bucket/bucket.h>
 #include <vespa/storage/storageutil/resumeguard.h>
 #include <vespa/storage/common/messagesender.h>
+#include <functional>
+#include <vector>
 
 namespace storage {
 namespace api {
@@ -126,6 +128,18 @@ public:
      */
     LockedMessage & getNextMessage(uint16_t disk, uint32_t stripeId, LockedMessage& lock);
 
+    using BatchFilter = std::function<bool(const api::StorageMessage&)>;
+
+    /**
+     * Takes further messages queued for the bucket held by the given lock, in
+     * queue order, for as long as they are accepted by the filter and until
+     * the batch holds maxBatchSize messages. All of them are taken under a
+     * single acquisition of the queue lock. Messages that have timed out in
+     * the queue are replied to and skipped.
+     */
+    void getNextBatch(uint16_t disk, uint32_t stripeId, const LockedMessage& lock, const BatchFilter& accept,
+                      size_t maxBatchSize, std::vector<std::shared_ptr<api::StorageMessage>>& batch);
+
     /**
      * Lock a bucket. By default, each file stor thread has the locks of all
      * buckets in their area of responsibility. If they need to access buckets
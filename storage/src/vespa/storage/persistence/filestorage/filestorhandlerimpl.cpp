@@ -322,6 +322,20 @@ FileStorHandlerImpl::getNextMessage(uint16_t diskId, uint32_t stripeId, FileStor
     return disk.getNextMessage(stripeId, lck);
 }
 
+void
+FileStorHandlerImpl::getNextBatch(uint16_t diskId, uint32_t stripeId, const FileStorHandler::LockedMessage& lck,
+                                  const FileStorHandler::BatchFilter& accept, size_t maxBatchSize,
+                                  std::vector<std::shared_ptr<api::StorageMessage>>& batch)
+{
+    assert(diskId < _diskInfo.size());
+    Disk&  disk(_diskInfo[diskId]);
+
+    if (disk.isClosed()) {
+        return;
+    }
+    disk.getNextBatch(stripeId, lck, accept, maxBatchSize, batch);
+}
+
 bool
 FileStorHandlerImpl::tryHandlePause(uint16_t disk) const
 {
@@ -804,6 +818,7 @@ void
 FileStorHandlerImpl::Stripe::failOperations(const document::Bucket &bucket, const api::ReturnCode& err)
 {
     vespalib::MonitorGuard guard(_lock);
+    drainIntake();
 
     BucketIdx& idx(bmi::get<2>(_queue));
     std::pair<BucketIdx::iterator, BucketIdx::iterator> range(idx.equal_range(bucket));
@@ -923,6 +938,7 @@ FileStorHandlerImpl::Stripe::getNextMessage(uint32_t timeout, Disk & disk)
     // second attempt. This is key to allowing the run loop to register
     // ticks at regular intervals while not busy-waiting.
     for (int attempt = 0; (attempt < 2) && ! disk.isClosed() && !_owner.isPaused(); ++attempt) {
+        drainIntake();
         PriorityIdx& idx(bmi::get<1>(_queue));
         PriorityIdx::iterator iter(idx.begin()), end(idx.end());
 
@@ -933,7 +949,11 @@ FileStorHandlerImpl::Stripe::getNextMessage(uint32_t timeout, Disk & disk)
             return getMessage(guard, idx, iter);
         }
         if (attempt == 0) {
-            guard.wait(timeout);
+            _intake.registerWaiter();
+            if (_intake.size() == 0) {
+                guard.wait(timeout);
+            }
+            _intake.unregisterWaiter();
         }
     }
     return {}; // No message fetched.
@@ -944,6 +964,7 @@ FileStorHandlerImpl::Stripe::getNextMessage(FileStorHandler::LockedMessage& lck)
 {
     const document::Bucket & bucket = lck.second->getBucket();
     vespalib::MonitorGuard guard(_lock);
+    drainIntake();
     BucketIdx& idx = bmi::get<2>(_queue);
     std::pair<BucketIdx::iterator, BucketIdx::iterator> range = idx.equal_range(bucket);
 
@@ -982,6 +1003,44 @@ FileStorHandlerImpl::Stripe::getNextMessage(FileStorHandler::LockedMessage& lck)
     return lck;
 }
 
+void
+FileStorHandlerImpl::Stripe::getNextBatch(const FileStorHandler::LockedMessage& lck,
+                                          const FileStorHandler::BatchFilter& accept, size_t maxBatchSize,
+                                          std::vector<std::shared_ptr<api::StorageMessage>>& batch)
+{
+    const document::Bucket & bucket = lck.first->getBucket();
+    std::vector<std::shared_ptr<api::StorageReply>> timedOut;
+    vespalib::MonitorGuard guard(_lock);
+    drainIntake();
+    BucketIdx& idx = bmi::get<2>(_queue);
+    auto iter = idx.lower_bound(bucket);
+    size_t taken = 0;
+
+    while ((batch.size() < maxBatchSize) && (iter != idx.end()) && (iter->_bucket == bucket)) {
+        api::StorageMessage & m(*iter->_command);
+        // Same restriction as for getNextMessage() on batching across lock requirement modes.
+        if ((lck.first->lockingRequirements() != m.lockingRequirements()) || !accept(m)) {
+            break;
+        }
+        uint64_t waitTime(iter->_timer.stop(_metrics->averageQueueWaitingTime[m.getLoadType()]));
+        if (!messageTimedOutInQueue(m, waitTime)) {
+            batch.push_back(iter->_command);
+        } else {
+            timedOut.push_back(makeQueueTimeoutReply(m));
+        }
+        iter = idx.erase(iter);
+        ++taken;
+    }
+    if (taken == 0) {
+        return;
+    }
+    guard.broadcast();
+    guard.unlock();
+    for (auto & reply : timedOut) {
+        _messageSender.sendReply(reply);
+    }
+}
+
 FileStorHandler::LockedMessage
 FileStorHandlerImpl::Stripe::getMessage(vespalib::MonitorGuard & guard, PriorityIdx & idx, PriorityIdx::iterator iter) {
 
@@ -1065,6 +1124,7 @@ void FileStorHandlerImpl::Stripe::abort(std::vector<std::shared_ptr<api::Storage
                                         const AbortBucketOperationsCommand& cmd)
 {
     vespalib::MonitorGuard lockGuard(_lock);
+    drainIntake();
     for (auto it(_queue.begin()); it != _queue.end();) {
         api::StorageMessage& msg(*it->_command);
         if (messageMayBeAborted(msg) && cmd.shouldAbort(it->_bucket)) {
@@ -1078,19 +1138,54 @@ void FileStorHandlerImpl::Stripe::abort(std::vector<std::shared_ptr<api::Storage
 
 bool FileStorHandlerImpl::Stripe::schedule(MessageEntry messageEntry)
 {
-    vespalib::MonitorGuard lockGuard(_lock);
-    _queue.emplace_back(std::move(messageEntry));
-    lockGuard.broadcast();
+    if (_intake.push(std::move(messageEntry))) {
+        vespalib::MonitorGuard lockGuard(_lock);
+        lockGuard.broadcast();
+    }
     return true;
 }
 
+FileStorHandlerImpl::Stripe::Intake::~Intake() = default;
+
+bool
+FileStorHandlerImpl::Stripe::Intake::push(MessageEntry entry)
+{
+    {
+        vespalib::LockGuard guard(_lock);
+        _entries.emplace_back(std::move(entry));
+        _size.fetch_add(1);
+    }
+    // Pairs with the waiter registering before checking size(), so that
+    // either the waiter sees the new entry or we see the waiter.
+    return (_waiters.load() != 0);
+}
+
+void
+FileStorHandlerImpl::Stripe::Intake::drainTo(PriorityQueue & queue)
+{
+    if (_size.load(std::memory_order_relaxed) == 0) {
+        return;
+    }
+    std::vector<MessageEntry> entries;
+    {
+        vespalib::LockGuard guard(_lock);
+        entries.swap(_entries);
+        _size.store(0);
+    }
+    for (auto & entry : entries) {
+        queue.emplace_back(std::move(entry));
+    }
+}
+
 void
 FileStorHandlerImpl::Stripe::flush()
 {
     vespalib::MonitorGuard lockGuard(_lock);
+    drainIntake();
     while (!(_queue.empty() && _lockedBuckets.empty())) {
         LOG(debug, "Still %ld in queue and %ld locked buckets", _queue.size(), _lockedBuckets.size());
         lockGuard.wait(100);
+        drainIntake();
     }
 }
 
@@ -1225,6 +1320,7 @@ void
 FileStorHandlerImpl::Stripe::dumpQueueHtml(std::ostream & os) const
 {
     vespalib::MonitorGuard guard(_lock);
+    drainIntake();
 
     const PriorityIdx& idx = bmi::get<1>(_queue);
     for (const auto & entry : idx) {
@@ -1265,6 +1361,7 @@ void
 FileStorHandlerImpl::Stripe::dumpQueue(std::ostream & os) const
 {
     vespalib::MonitorGuard guard(_lock);
+    drainIntake();
 
     const PriorityIdx& idx = bmi::get<1>(_queue);
     for (const auto & entry : idx) {
@@ -110,7 +110,7 @@ public:
         }
         size_t getQueueSize() const {
             vespalib::MonitorGuard guard(_lock);
-            return _queue.size();
+            return _queue.size() + _intake.size();
         }
         void release(const document::Bucket & bucket, api::LockingRequirements reqOfReleasedLock,
                      api::StorageMessage::Id lockMsgId);
@@ -126,14 +126,47 @@ public:
 
         FileStorHandler::LockedMessage getNextMessage(uint32_t timeout, Disk & disk);
         FileStorHandler::LockedMessage & getNextMessage(FileStorHandler::LockedMessage& lock);
+        void getNextBatch(const FileStorHandler::LockedMessage& lock, const FileStorHandler::BatchFilter& accept,
+                          size_t maxBatchSize, std::vector<std::shared_ptr<api::StorageMessage>>& batch);
         void dumpQueue(std::ostream & os) const;
         void dumpActiveHtml(std::ostream & os) const;
         void dumpQueueHtml(std::ostream & os) const;
         vespalib::Monitor & exposeLock() { return _lock; }
-        PriorityQueue & exposeQueue() { return _queue; }
-        BucketIdx & exposeBucketIdx() { return bmi::get<2>(_queue); }
+        // Precondition for the below: the lock returned by exposeLock() is held.
+        PriorityQueue & exposeQueue() { drainIntake(); return _queue; }
+        BucketIdx & exposeBucketIdx() { drainIntake(); return bmi::get<2>(_queue); }
         void setMetrics(FileStorStripeMetrics * metrics) { _metrics = metrics; }
     private:
+        /**
+         * Messages scheduled since the queue was last drained. They are kept
+         * behind a lock of their own, so that scheduling does not contend with
+         * threads fetching from, remapping or aborting the queue, and the
+         * queue node allocations and index updates are done by those threads.
+         * Like vespalib::Monitor, a copy is a new, empty intake.
+         */
+        class Intake {
+            vespalib::Lock            _lock;
+            std::vector<MessageEntry> _entries;
+            std::atomic<size_t>       _size;
+            std::atomic<uint32_t>     _waiters;
+        public:
+            Intake() : _lock(), _entries(), _size(0), _waiters(0) {}
+            Intake(const Intake &) : Intake() {}
+            Intake & operator = (const Intake &) = delete;
+            ~Intake();
+
+            // Returns whether any thread is waiting for the intake.
+            bool push(MessageEntry entry);
+            void drainTo(PriorityQueue & queue);
+            size_t size() const noexcept { return _size.load(); }
+            // Waiters must check size() after registering and before waiting.
+            void registerWaiter() noexcept { _waiters.fetch_add(1); }
+            void unregisterWaiter() noexcept { _waiters.fetch_sub(1); }
+        };
+
+        // Precondition: _lock is held.
+        void drainIntake() const { _intake.drainTo(_queue); }
+
         bool hasActive(vespalib::MonitorGuard & monitor, const AbortBucketOperationsCommand& cmd) const;
         // Precondition: the bucket used by `iter`s operation is not locked in a way that conflicts
         // with its locking requirements.
@@ -144,7 +177,10 @@ public:
         MessageSender              &_messageSender;
         FileStorStripeMetrics      *_metrics;
         vespalib::Monitor           _lock;
-        PriorityQueue               _queue;
+        // Draining the intake into the queue does not change what is queued,
+        // so it is allowed from const member functions.
+        mutable PriorityQueue       _queue;
+        mutable Intake              _intake;
         LockedBuckets               _lockedBuckets;
     };
     struct Disk {
@@ -183,6 +219,11 @@ public:
         FileStorHandler::LockedMessage & getNextMessage(uint32_t stripeId, FileStorHandler::LockedMessage & lck) {
             return _stripes[stripeId].getNextMessage(lck);
         }
+        void getNextBatch(uint32_t stripeId, const FileStorHandler::LockedMessage & lck,
+                          const FileStorHandler::BatchFilter & accept, size_t maxBatchSize,
+                          std::vector<std::shared_ptr<api::StorageMessage>> & batch) {
+            _stripes[stripeId].getNextBatch(lck, accept, maxBatchSize, batch);
+        }
         std::shared_ptr<FileStorHandler::BucketLockInterface>
         lock(const document::Bucket & bucket, api::LockingRequirements lockReq) {
             return stripe(bucket).lock(bucket, lockReq);
@@ -246,6 +287,10 @@ public:
 
     FileStorHandler::LockedMessage & getNextMessage(uint16_t disk, uint32_t stripeId, FileStorHandler::LockedMessage& lock);
 
+    void getNextBatch(uint16_t disk, uint32_t stripeId, const FileStorHandler::LockedMessage& lock,
+                      const FileStorHandler::BatchFilter& accept, size_t maxBatchSize,
+                      std::vector<std::shared_ptr<api::StorageMessage>>& batch);
+
     enum Operation { MOVE, SPLIT, JOIN };
     void remapQueue(const RemapInfo& source, RemapInfo& target, Operation op);
 
@@ -11,7 +11,8 @@ MergeStatus::MergeStatus(framework::Clock& clock, const metrics::LoadType& lt,
                          api::StorageMessage::Priority priority,
                          uint32_t traceLevel)
     : reply(), nodeList(), maxTimestamp(0), diff(), pendingId(0),
-      pendingGetDiff(), pendingApplyDiff(), timeout(0), startTime(clock),
+      pendingGetDiff(), pendingApplyDiff(), rangeHashed(false), localDiff(),
+      timeout(0), startTime(clock),
       context(lt, priority, traceLevel)
 {}
 
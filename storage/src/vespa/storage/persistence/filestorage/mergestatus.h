@@ -24,6 +24,11 @@ public:
     api::StorageMessage::Id pendingId;
     std::shared_ptr<api::GetBucketDiffReply> pendingGetDiff;
     std::shared_ptr<api::ApplyBucketDiffReply> pendingApplyDiff;
+    // Set when the GetBucketDiff chain compares range hashes. Our own
+    // metadata is then kept in localDiff until the reply tells which
+    // ranges differ, rather than being sent down the chain.
+    bool rangeHashed;
+    std::vector<api::GetBucketDiffCommand::Entry> localDiff;
     uint32_t timeout;
     framework::MilliSecTimer startTime;
     spi::Context context;
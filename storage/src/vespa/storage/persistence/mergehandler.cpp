@@ -9,6 +9,7 @@
 #include <vespa/vespalib/objects/nbostream.h>
 #include <vespa/vespalib/util/exceptions.h>
 #include <algorithm>
+#include <cstring>
 
 #include <vespa/log/log.h>
 LOG_SETUP(".persistence.mergehandler");
@@ -19,16 +20,19 @@ MergeHandler::MergeHandler(spi::PersistenceProvider& spi,
                            PersistenceUtil& env)
     : _spi(spi),
       _env(env),
-      _maxChunkSize(env._config.bucketMergeChunkSize)
+      _maxChunkSize(env._config.bucketMergeChunkSize),
+      _rangeHashMinEntries(env._config.mergeRangeHashMinEntries)
 {
 }
 
 MergeHandler::MergeHandler(spi::PersistenceProvider& spi,
                            PersistenceUtil& env,
-                           uint32_t maxChunkSize)
+                           uint32_t maxChunkSize,
+                           uint32_t rangeHashMinEntries)
     : _spi(spi),
       _env(env),
-      _maxChunkSize(maxChunkSize)
+      _maxChunkSize(maxChunkSize),
+      _rangeHashMinEntries(rangeHashMinEntries)
 {
 }
 
@@ -947,6 +951,127 @@ public:
     void deactivate() { _active = false; }
 };
 
+namespace {
+
+    typedef api::GetBucketDiffCommand::RangeHash RangeHash;
+
+    // Aim for this many entries per range, as a trade-off between the size
+    // of the hashes and the number of entries listed per differing document.
+    const uint32_t ENTRIES_PER_HASH_RANGE = 64;
+    const uint32_t MAX_HASH_RANGES = 4096;
+
+    uint32_t
+    hashRangeCount(size_t entryCount)
+    {
+        uint32_t count = 1;
+        while (count < MAX_HASH_RANGES
+               && size_t(count) * ENTRIES_PER_HASH_RANGE < entryCount)
+        {
+            count <<= 1;
+        }
+        return count;
+    }
+
+    uint64_t
+    mixBits(uint64_t v)
+    {
+        v ^= v >> 33;
+        v *= 0xff51afd7ed558ccdULL;
+        v ^= v >> 33;
+        v *= 0xc4ceb53a1b5a3f39ULL;
+        v ^= v >> 33;
+        return v;
+    }
+
+    /**
+     * Hashes what is considered the same entry when diffing, which is why
+     * the header and body sizes are not part of the hash.
+     */
+    uint64_t
+    entryHash(const api::GetBucketDiffCommand::Entry& e)
+    {
+        uint64_t gidLow;
+        uint32_t gidHigh;
+        memcpy(&gidLow, e._gid.get(), sizeof(gidLow));
+        memcpy(&gidHigh, e._gid.get() + sizeof(gidLow), sizeof(gidHigh));
+        uint64_t deleted = ((e._flags & getDeleteFlag()) != 0 ? 1 : 0);
+        return mixBits(e._timestamp
+                       ^ mixBits(gidLow ^ mixBits((uint64_t(gidHigh) << 1) | deleted)));
+    }
+
+    /**
+     * Flags the ranges where our entries hash differently than the entries
+     * of the node that computed the given hashes.
+     */
+    void
+    flagDifferingRanges(const std::vector<api::GetBucketDiffCommand::Entry>& entries,
+                        std::vector<RangeHash>& hashes)
+    {
+        std::vector<RangeHash> own(MergeHandler::computeRangeHashes(entries, hashes.size()));
+        for (uint32_t i=0, n=hashes.size(); i<n; ++i) {
+            if (own[i]._hash != hashes[i]._hash) {
+                hashes[i]._differs = true;
+            }
+        }
+    }
+
+    /**
+     * Appends the entries within differing ranges. Without hashes we do not
+     * know what differs, in which case all entries are appended.
+     */
+    void
+    appendEntriesInDifferingRanges(
+            const std::vector<api::GetBucketDiffCommand::Entry>& entries,
+            const std::vector<RangeHash>& hashes,
+            std::vector<api::GetBucketDiffCommand::Entry>& output)
+    {
+        for (const auto& e : entries) {
+            if (hashes.empty()
+                || hashes[MergeHandler::hashRangeOf(e._gid, hashes.size())]._differs)
+            {
+                output.push_back(e);
+            }
+        }
+    }
+
+    uint32_t
+    countDifferingRanges(const std::vector<RangeHash>& hashes)
+    {
+        uint32_t count = 0;
+        for (const auto& hash : hashes) {
+            if (hash._differs) ++count;
+        }
+        return count;
+    }
+
+}
+
+uint32_t
+MergeHandler::hashRangeOf(const document::GlobalId& gid, uint32_t rangeCount)
+{
+    // The first 4 bytes of the gid hold the location of the document, which
+    // documents in the same bucket largely share, as the bucket id is made
+    // from its low bits. Bytes 4 to 11 are taken from the md5 hash of the
+    // document id, which spreads the documents of a bucket evenly while
+    // keeping all versions of a document in the same range.
+    uint64_t idHash;
+    memcpy(&idHash, gid.get() + 4, sizeof(idHash));
+    return mixBits(idHash) % rangeCount;
+}
+
+std::vector<api::GetBucketDiffCommand::RangeHash>
+MergeHandler::computeRangeHashes(
+        const std::vector<api::GetBucketDiffCommand::Entry>& entries,
+        uint32_t rangeCount)
+{
+    std::vector<RangeHash> hashes(rangeCount);
+    for (const auto& e : entries) {
+        // Summing makes the hash independent of entry order.
+        hashes[hashRangeOf(e._gid, rangeCount)]._hash += entryHash(e);
+    }
+    return hashes;
+}
+
 MessageTracker::UP
 MergeHandler::handleMergeBucket(api::MergeBucketCommand& cmd,
                                 spi::Context& context)
@@ -1024,12 +1149,21 @@ MergeHandler::handleMergeBucket(api::MergeBucketCommand& cmd,
     }
     _env._metrics.mergeMetadataReadLatency.addValue(
             s->startTime.getElapsedTimeAsDouble());
+    if (cmd2->getDiff().size() >= _rangeHashMinEntries) {
+        // Send range hashes rather than our metadata. The other nodes will
+        // only list entries within ranges where they differ from us.
+        cmd2->getRangeHashes() = computeRangeHashes(
+                cmd2->getDiff(), hashRangeCount(cmd2->getDiff().size()));
+        s->rangeHashed = true;
+        s->localDiff.swap(cmd2->getDiff());
+    }
     LOG(spam, "Sending GetBucketDiff %" PRIu64 " for %s to next node %u "
-        "with diff of %u entries.",
+        "with diff of %u entries and %u range hashes.",
         cmd2->getMsgId(),
         bucket.toString().c_str(),
         s->nodeList[1].index,
-        uint32_t(cmd2->getDiff().size()));
+        uint32_t(cmd2->getDiff().size()),
+        uint32_t(cmd2->getRangeHashes().size()));
     cmd2->setAddress(createAddress(_env._component.getClusterName(),
                                    s->nodeList[1].index));
     cmd2->setPriority(s->context.getPriority());
@@ -1171,6 +1305,30 @@ namespace {
         return !suspect;
     }
 
+    /**
+     * Returns the entries that not all nodes, except the source only ones,
+     * already have.
+     */
+    std::vector<api::GetBucketDiffCommand::Entry>
+    findMissingEntries(
+            const std::vector<api::MergeBucketCommand::Node>& nodes,
+            const std::vector<api::GetBucketDiffCommand::Entry>& entries)
+    {
+        uint16_t completeMask = 0;
+        for (uint32_t i=0; i<nodes.size(); ++i) {
+            if (!nodes[i].sourceOnly) {
+                completeMask |= (1 << i);
+            }
+        }
+        std::vector<api::GetBucketDiffCommand::Entry> missing;
+        for (uint32_t i=0, n=entries.size(); i<n; ++i) {
+            if ((entries[i]._hasMask & completeMask) != completeMask) {
+                missing.push_back(entries[i]);
+            }
+        }
+        return missing;
+    }
+
 }
 
 MessageTracker::UP
@@ -1209,21 +1367,26 @@ MergeHandler::handleGetBucketDiff(api::GetBucketDiffCommand& cmd,
     }
     _env._metrics.mergeMetadataReadLatency.addValue(
             startTime.getElapsedTimeAsDouble());
+    std::vector<api::GetBucketDiffCommand::RangeHash> rangeHashes(
+            cmd.getRangeHashes());
+    if (!rangeHashes.empty()) {
+        flagDifferingRanges(local, rangeHashes);
+    }
 
     // If last node in merge chain, we can send reply straight away
     if (index + 1u >= cmd.getNodes().size()) {
-        // Remove entries everyone has from list first.
-        uint16_t completeMask = 0;
-        for (uint32_t i=0; i<cmd.getNodes().size(); ++i) {
-            if (!cmd.getNodes()[i].sourceOnly) {
-                completeMask |= (1 << i);
-            }
-        }
         std::vector<api::GetBucketDiffCommand::Entry> final;
-        for (uint32_t i=0, n=local.size(); i<n; ++i) {
-            if ((local[i]._hasMask & completeMask) != completeMask) {
-                final.push_back(local[i]);
-            }
+        if (rangeHashes.empty()) {
+            // Remove entries everyone has from list first.
+            final = findMissingEntries(cmd.getNodes(), local);
+        } else {
+            // The metadata of the other nodes is not known here, so list all
+            // entries in differing ranges and let the first node filter.
+            appendEntriesInDifferingRanges(local, rangeHashes, final);
+            LOG(spam, "GetBucketDiff %" PRIu64 " for %s found %u of %zu "
+                      "ranges to differ.",
+                cmd.getMsgId(), bucket.toString().c_str(),
+                countDifferingRanges(rangeHashes), rangeHashes.size());
         }
         // Send reply
         LOG(spam, "Replying to GetBucketDiff %" PRIu64 " for %s to node %d"
@@ -1234,6 +1397,7 @@ MergeHandler::handleGetBucketDiff(api::GetBucketDiffCommand& cmd,
         api::GetBucketDiffReply* reply = new api::GetBucketDiffReply(cmd);
         tracker->setReply(api::StorageReply::SP(reply));
         reply->getDiff().swap(final);
+        reply->getRangeHashes().swap(rangeHashes);
     } else {
         // When not the last node in merge chain, we must save reply, and
         // send command on.
@@ -1256,7 +1420,12 @@ MergeHandler::handleGetBucketDiff(api::GetBucketDiffCommand& cmd,
                     bucket.getBucket(), cmd.getNodes(), cmd.getMaxTimestamp()));
         cmd2->setAddress(createAddress(_env._component.getClusterName(),
                                        cmd.getNodes()[index + 1].index));
+        if (!rangeHashes.empty()) {
+            s->rangeHashed = true;
+            s->localDiff.swap(local);
+        }
         cmd2->getDiff().swap(local);
+        cmd2->getRangeHashes().swap(rangeHashes);
         cmd2->setPriority(cmd.getPriority());
         cmd2->setTimeout(cmd.getTimeout());
         s->pendingId = cmd2->getMsgId();
@@ -1295,6 +1464,25 @@ namespace {
         }
     };
 
+    /**
+     * Merges the metadata we withheld from the GetBucketDiff chain into the
+     * diff of the reply, restricted to the ranges the reply flags as
+     * differing.
+     */
+    void
+    mergeLocalDiff(std::vector<api::GetBucketDiffCommand::Entry>& localDiff,
+                   api::GetBucketDiffReply& reply,
+                   const spi::Bucket& bucket)
+    {
+        std::vector<api::GetBucketDiffCommand::Entry> local;
+        appendEntriesInDifferingRanges(localDiff, reply.getRangeHashes(), local);
+        localDiff.clear();
+        if (!mergeLists(reply.getDiff(), local, reply.getDiff())) {
+            LOG(error, "Diffing %s found suspect entries.",
+                bucket.toString().c_str());
+        }
+    }
+
 } // End of anonymous namespace
 
 void
@@ -1336,6 +1524,11 @@ MergeHandler::handleGetBucketDiffReply(api::GetBucketDiffReply& reply,
 
                 // Get bucket diff should retrieve all info at once
                 assert(s.diff.size() == 0);
+                if (s.rangeHashed) {
+                    mergeLocalDiff(s.localDiff, reply, bucket);
+                    reply.getDiff() = findMissingEntries(s.nodeList,
+                                                         reply.getDiff());
+                }
                 s.diff.insert(s.diff.end(),
                               reply.getDiff().begin(),
                               reply.getDiff().end());
@@ -1353,6 +1546,10 @@ MergeHandler::handleGetBucketDiffReply(api::GetBucketDiffReply& reply,
         } else {
             // Exists in send on list, send on!
             replyToSend = s.pendingGetDiff;
+            if (s.rangeHashed && !reply.getResult().failed()) {
+                mergeLocalDiff(s.localDiff, reply, bucket);
+                s.pendingGetDiff->getRangeHashes().swap(reply.getRangeHashes());
+            }
             LOG(spam, "Received GetBucketDiffReply for %s with diff of "
                 "size %zu. Sending it on.",
                 bucket.toString().c_str(), reply.getDiff().size());
@@ -34,7 +34,8 @@ public:
     /** Used for unit testing */
     MergeHandler(spi::PersistenceProvider& spi,
                  PersistenceUtil& env,
-                 uint32_t maxChunkSize);
+                 uint32_t maxChunkSize,
+                 uint32_t rangeHashMinEntries = UINT32_MAX);
 
     bool buildBucketInfoList(
             const spi::Bucket& bucket,
@@ -64,10 +65,24 @@ public:
                                              spi::Context&);
     void handleApplyBucketDiffReply(api::ApplyBucketDiffReply&, MessageSender&);
 
+    /**
+     * Returns which of rangeCount gid ranges a document belongs to when
+     * diffing buckets by range hashes.
+     */
+    static uint32_t hashRangeOf(const document::GlobalId& gid, uint32_t rangeCount);
+    /**
+     * Computes the content hash of each of rangeCount gid ranges over the
+     * given bucket entries.
+     */
+    static std::vector<api::GetBucketDiffCommand::RangeHash> computeRangeHashes(
+            const std::vector<api::GetBucketDiffCommand::Entry>& entries,
+            uint32_t rangeCount);
+
 private:
     spi::PersistenceProvider& _spi;
     PersistenceUtil& _env;
     uint32_t _maxChunkSize;
+    uint32_t _rangeHashMinEntries;
 
     /** Returns a reply if merge is complete */
     api::StorageReply::SP processBucketMerge(const spi::Bucket& bucket,
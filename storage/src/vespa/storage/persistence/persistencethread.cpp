@@ -25,6 +25,7 @@ PersistenceThread::PersistenceThread(ServiceLayerComponentRegister& compReg,
     : _stripeId(filestorHandler.getNextStripeId(deviceIndex)),
       _env(configUri, compReg, filestorHandler, metrics, deviceIndex, provider),
       _warnOnSlowOperations(5000),
+      _maxFeedOpBatchSize(std::max(1, _env._config.maxFeedOpBatchSize)),
       _spi(provider),
       _processAllHandler(_env, provider),
       _mergeHandler(_spi, _env),
@@ -104,12 +105,60 @@ bool PersistenceThread::tasConditionMatches(const api::TestAndSetCommand & cmd,
     return true;
 }
 
+namespace {
+
+template <typename Metric>
 MessageTracker::UP
-PersistenceThread::handlePut(api::PutCommand& cmd)
+makeFeedTracker(Metric& metrics, const api::StorageCommand& cmd, framework::Clock& clock)
 {
-    auto& metrics = _env._metrics.put[cmd.getLoadType()];
-    auto tracker = std::make_unique<MessageTracker>(metrics, _env._component.getClock());
+    auto tracker = std::make_unique<MessageTracker>(metrics, clock);
     metrics.request_size.addValue(cmd.getApproxByteSize());
+    return tracker;
+}
+
+}
+
+MessageTracker::UP
+PersistenceThread::createFeedTracker(const api::StorageCommand& cmd)
+{
+    framework::Clock& clock(_env._component.getClock());
+    switch (cmd.getType().getId()) {
+    case api::MessageType::PUT_ID:
+        return makeFeedTracker(_env._metrics.put[cmd.getLoadType()], cmd, clock);
+    case api::MessageType::REMOVE_ID:
+        return makeFeedTracker(_env._metrics.remove[cmd.getLoadType()], cmd, clock);
+    default:
+        return makeFeedTracker(_env._metrics.update[cmd.getLoadType()], cmd, clock);
+    }
+}
+
+void
+PersistenceThread::handleRemoveResult(api::RemoveCommand& cmd, const spi::RemoveResult& response,
+                                      MessageTracker& tracker)
+{
+    if (checkForError(response, tracker)) {
+        tracker.setReply(std::make_shared<api::RemoveReply>(cmd, response.wasFound() ? cmd.getTimestamp() : 0));
+    }
+    if (!response.wasFound()) {
+        _env._metrics.remove[cmd.getLoadType()].notFound.inc();
+    }
+}
+
+void
+PersistenceThread::handleUpdateResult(api::UpdateCommand& cmd, const spi::UpdateResult& response,
+                                      MessageTracker& tracker)
+{
+    if (checkForError(response, tracker)) {
+        auto reply = std::make_shared<api::UpdateReply>(cmd);
+        reply->setOldTimestamp(response.getExistingTimestamp());
+        tracker.setReply(std::move(reply));
+    }
+}
+
+MessageTracker::UP
+PersistenceThread::handlePut(api::PutCommand& cmd)
+{
+    auto tracker = createFeedTracker(cmd);
 
     if (tasConditionExists(cmd) && !tasConditionMatches(cmd, *tracker)) {
         return tracker;
@@ -124,9 +173,7 @@ PersistenceThread::handlePut(api::PutCommand& cmd)
 MessageTracker::UP
 PersistenceThread::handleRemove(api::RemoveCommand& cmd)
 {
-    auto& metrics = _env._metrics.remove[cmd.getLoadType()];
-    auto tracker = std::make_unique<MessageTracker>(metrics,_env._component.getClock());
-    metrics.request_size.addValue(cmd.getApproxByteSize());
+    auto tracker = createFeedTracker(cmd);
 
     if (tasConditionExists(cmd) && !tasConditionMatches(cmd, *tracker)) {
         return tracker;
@@ -134,21 +181,14 @@ PersistenceThread::handleRemove(api::RemoveCommand& cmd)
 
     spi::RemoveResult response = _spi.removeIfFound(getBucket(cmd.getDocumentId(), cmd.getBucket()),
                                                     spi::Timestamp(cmd.getTimestamp()), cmd.getDocumentId(), _context);
-    if (checkForError(response, *tracker)) {
-        tracker->setReply(std::make_shared<api::RemoveReply>(cmd, response.wasFound() ? cmd.getTimestamp() : 0));
-    }
-    if (!response.wasFound()) {
-        _env._metrics.remove[cmd.getLoadType()].notFound.inc();
-    }
+    handleRemoveResult(cmd, response, *tracker);
     return tracker;
 }
 
 MessageTracker::UP
 PersistenceThread::handleUpdate(api::UpdateCommand& cmd)
 {
-    auto& metrics = _env._metrics.update[cmd.getLoadType()];
-    auto tracker = std::make_unique<MessageTracker>(metrics, _env._component.getClock());
-    metrics.request_size.addValue(cmd.getApproxByteSize());
+    auto tracker = createFeedTracker(cmd);
 
     if (tasConditionExists(cmd) && !tasConditionMatches(cmd, *tracker, cmd.getUpdate()->getCreateIfNonExistent())) {
         return tracker;
@@ -156,11 +196,7 @@ PersistenceThread::handleUpdate(api::UpdateCommand& cmd)
     
     spi::UpdateResult response = _spi.update(getBucket(cmd.getUpdate()->getId(), cmd.getBucket()),
                                              spi::Timestamp(cmd.getTimestamp()), cmd.getUpdate(), _context);
-    if (checkForError(response, *tracker)) {
-        auto reply = std::make_shared<api::UpdateReply>(cmd);
-        reply->setOldTimestamp(response.getExistingTimestamp());
-        tracker->setReply(std::move(reply));
-    }
+    handleUpdateResult(cmd, response, *tracker);
     return tracker;
 }
 
@@ -833,13 +869,7 @@ PersistenceThread::processMessage(api::StorageMessage& msg)
             if (!tracker.get()) {
                 LOG(debug, "Received unsupported command %s", msg.getType().getName().c_str());
             } else {
-                tracker->generateReply(initiatingCommand);
-                if ((tracker->getReply().get()
-                     && tracker->getReply()->getResult().failed())
-                    || tracker->getResult().failed())
-                {
-                    _env._metrics.failedOperations.inc();
-                }
+                generateReply(initiatingCommand, *tracker);
             }
 
             int64_t stopTime(_component->getClock().getTimeInMillis().getTime());
@@ -864,6 +894,19 @@ PersistenceThread::processMessage(api::StorageMessage& msg)
     return MessageTracker::UP();
 }
 
+bool
+PersistenceThread::generateReply(api::StorageCommand& cmd, MessageTracker& tracker)
+{
+    tracker.generateReply(cmd);
+    if ((tracker.getReply().get() && tracker.getReply()->getResult().failed())
+        || tracker.getResult().failed())
+    {
+        _env._metrics.failedOperations.inc();
+        return false;
+    }
+    return true;
+}
+
 namespace {
 
 
@@ -875,6 +918,33 @@ bool isBatchable(const api::StorageMessage& msg)
             msg.getType().getId() == api::MessageType::REVERT_ID);
 }
 
+// Whether the message can be part of a batch of operations handed to the
+// provider through a single SPI call. Test-and-set conditions must see the
+// effect of all earlier operations to the bucket, and traced messages need
+// a context of their own.
+bool isSpiBatchable(const api::StorageMessage& msg)
+{
+    switch (msg.getType().getId()) {
+    case api::MessageType::PUT_ID:
+    case api::MessageType::REMOVE_ID:
+    case api::MessageType::UPDATE_ID:
+        return (!static_cast<const api::TestAndSetCommand&>(msg).getCondition().isPresent()
+                && (msg.getTrace().getLevel() == 0));
+    default:
+        return false;
+    }
+}
+
+struct BatchedFeedOp {
+    api::StorageCommand& cmd;
+    MessageTracker::UP   tracker;
+    bool                 submitted;
+
+    BatchedFeedOp(api::StorageCommand& cmd_, MessageTracker::UP tracker_)
+        : cmd(cmd_), tracker(std::move(tracker_)), submitted(false)
+    {}
+};
+
 bool hasBucketInfo(const api::StorageMessage& msg)
 {
     return (isBatchable(msg) ||
@@ -943,6 +1013,110 @@ PersistenceThread::flushAllReplies(
     replies.clear();
 }
 
+bool
+PersistenceThread::processFeedBatch(const document::Bucket& bucket,
+                                    const std::vector<std::shared_ptr<api::StorageMessage>>& batch,
+                                    std::vector<MessageTracker::UP>& trackers)
+{
+    const api::StorageMessage& first(*batch.front());
+    _context = spi::Context(first.getLoadType(), first.getPriority(), first.getTrace().getLevel());
+
+    std::vector<BatchedFeedOp> ops;
+    spi::BatchOperationList operations;
+    ops.reserve(batch.size());
+    operations.reserve(batch.size());
+    for (const auto& msg : batch) {
+        _env._metrics.operations.inc();
+        auto& cmd = static_cast<api::StorageCommand&>(*msg);
+        ops.emplace_back(cmd, createFeedTracker(cmd));
+        BatchedFeedOp& op(ops.back());
+        try {
+            // getBucket() verifies that the document belongs in the bucket.
+            switch (cmd.getType().getId()) {
+            case api::MessageType::PUT_ID: {
+                auto& put = static_cast<api::PutCommand&>(cmd);
+                getBucket(put.getDocumentId(), put.getBucket());
+                operations.push_back(spi::BatchOperation::put(spi::Timestamp(put.getTimestamp()), put.getDocument()));
+                break;
+            }
+            case api::MessageType::REMOVE_ID: {
+                auto& remove = static_cast<api::RemoveCommand&>(cmd);
+                getBucket(remove.getDocumentId(), remove.getBucket());
+                operations.push_back(spi::BatchOperation::removeIfFound(spi::Timestamp(remove.getTimestamp()),
+                                                                        remove.getDocumentId()));
+                break;
+            }
+            default: {
+                auto& update = static_cast<api::UpdateCommand&>(cmd);
+                getBucket(update.getUpdate()->getId(), update.getBucket());
+                operations.push_back(spi::BatchOperation::update(spi::Timestamp(update.getTimestamp()),
+                                                                 update.getUpdate()));
+                break;
+            }
+            }
+            op.submitted = true;
+        } catch (std::exception& e) {
+            LOG(debug, "Caught exception for %s: %s", cmd.toString().c_str(), e.what());
+            op.tracker->fail(api::ReturnCode::INTERNAL_FAILURE, e.what());
+        }
+    }
+
+    if (!operations.empty()) {
+        try {
+            spi::BatchResult result = _spi.executeBatch(spi::Bucket(bucket, spi::PartitionId(_env._partition)),
+                                                        operations, _context);
+            size_t i = 0;
+            for (BatchedFeedOp& op : ops) {
+                if (!op.submitted) {
+                    continue;
+                }
+                if (result.hasError()) {
+                    checkForError(result, *op.tracker);
+                } else if (op.cmd.getType().getId() == api::MessageType::PUT_ID) {
+                    checkForError(result.getResult(i), *op.tracker);
+                } else if (op.cmd.getType().getId() == api::MessageType::REMOVE_ID) {
+                    handleRemoveResult(static_cast<api::RemoveCommand&>(op.cmd), result.getRemoveResult(i), *op.tracker);
+                } else {
+                    handleUpdateResult(static_cast<api::UpdateCommand&>(op.cmd), result.getUpdateResult(i), *op.tracker);
+                }
+                ++i;
+            }
+        } catch (std::exception& e) {
+            LOG(debug, "Caught exception for batch of %zu operations to %s: %s",
+                operations.size(), bucket.toString().c_str(), e.what());
+            for (BatchedFeedOp& op : ops) {
+                if (op.submitted) {
+                    op.tracker->fail(api::ReturnCode::INTERNAL_FAILURE, e.what());
+                }
+            }
+        }
+    }
+
+    bool allSucceeded = true;
+    bool anySucceeded = false;
+    for (BatchedFeedOp& op : ops) {
+        if (generateReply(op.cmd, *op.tracker)) {
+            anySucceeded = true;
+        } else {
+            allSucceeded = false;
+        }
+    }
+    if (anySucceeded) {
+        // The bucket info is fetched once for the whole batch, rather than once per operation.
+        api::BucketInfo info = _env.getBucketInfo(bucket);
+        _env.updateBucketDatabase(bucket, info);
+        for (BatchedFeedOp& op : ops) {
+            if (op.tracker->getReply()->getResult().success()) {
+                static_cast<api::BucketInfoReply&>(*op.tracker->getReply()).setBucketInfo(info);
+            }
+        }
+    }
+    for (BatchedFeedOp& op : ops) {
+        trackers.push_back(std::move(op.tracker));
+    }
+    return allSucceeded;
+}
+
 void PersistenceThread::processMessages(FileStorHandler::LockedMessage & lock)
 {
     std::vector<MessageTracker::UP> trackers;
@@ -951,6 +1125,21 @@ void PersistenceThread::processMessages(FileStorHandler::LockedMessage & lock)
     while (lock.second) {
         LOG(debug, "Inside while loop %d, nodeIndex %d, ptr=%p", _env._partition, _env._nodeIndex, lock.second.get());
         std::shared_ptr<api::StorageMessage> msg(lock.second);
+        if ((_maxFeedOpBatchSize > 1) && isSpiBatchable(*msg)) {
+            std::vector<std::shared_ptr<api::StorageMessage>> batch;
+            batch.push_back(msg);
+            _env._fileStorHandler.getNextBatch(_env._partition, _stripeId, lock, isSpiBatchable,
+                                               _maxFeedOpBatchSize, batch);
+            if (batch.size() > 1) {
+                LOG(spam, "Processing batch of %zu operations for bucket %s",
+                    batch.size(), bucket.getBucketId().toString().c_str());
+                if (!processFeedBatch(bucket, batch, trackers)) {
+                    break;
+                }
+                _env._fileStorHandler.getNextMessage(_env._partition, _stripeId, lock);
+                continue;
+            }
+        }
         bool batchable = isBatchable(*msg);
 
         // If the next operation wasn't batchable, we should flush
@@ -50,6 +50,7 @@ private:
     uint32_t                  _stripeId;
     PersistenceUtil           _env;
     uint32_t                  _warnOnSlowOperations;
+    uint32_t                  _maxFeedOpBatchSize;
     spi::PersistenceProvider& _spi;
     ProcessAllHandler         _processAllHandler;
     MergeHandler              _mergeHandler;
@@ -77,6 +78,25 @@ private:
 
     MessageTracker::UP processMessage(api::StorageMessage& msg);
     void processMessages(FileStorHandler::LockedMessage & lock);
+    /**
+     * Executes a batch of puts, removes and updates to the given bucket
+     * through a single SPI call, and adds their trackers to the given list.
+     * Returns whether all of them succeeded.
+     */
+    bool processFeedBatch(const document::Bucket& bucket,
+                          const std::vector<std::shared_ptr<api::StorageMessage>>& batch,
+                          std::vector<MessageTracker::UP>& trackers);
+
+    /**
+     * Generates the reply of a handled command, and counts it as a failed
+     * operation if it did not succeed. Returns whether it succeeded.
+     */
+    bool generateReply(api::StorageCommand& cmd, MessageTracker& tracker);
+
+    // Shared by the single operation handlers and processFeedBatch().
+    MessageTracker::UP createFeedTracker(const api::StorageCommand& cmd);
+    void handleRemoveResult(api::RemoveCommand& cmd, const spi::RemoveResult& response, MessageTracker& tracker);
+    void handleUpdateResult(api::UpdateCommand& cmd, const spi::UpdateResult& response, MessageTracker& tracker);
 
     // Thread main loop
     void run(framework::ThreadHandle&) override;
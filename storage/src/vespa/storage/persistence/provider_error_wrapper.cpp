@@ -9,12 +9,16 @@ template <typename ResultType>
 ResultType
 ProviderErrorWrapper::checkResult(ResultType&& result) const
 {
+    handle(result);
+    return std::forward<ResultType>(result);
+}
+
+void ProviderErrorWrapper::handle(const spi::Result& result) const {
     if (result.getErrorCode() == spi::Result::FATAL_ERROR) {
         trigger_shutdown_listeners(result.getErrorMessage());
     } else if (result.getErrorCode() == spi::Result::RESOURCE_EXHAUSTED) {
         trigger_resource_exhaustion_listeners(result.getErrorMessage());
     }
-    return std::forward<ResultType>(result);
 }
 
 void ProviderErrorWrapper::trigger_shutdown_listeners(vespalib::stringref reason) const {
@@ -109,6 +113,19 @@ ProviderErrorWrapper::update(const spi::Bucket& bucket,
     return checkResult(_impl.update(bucket, ts, docUpdate, context));
 }
 
+spi::BatchResult
+ProviderErrorWrapper::executeBatch(const spi::Bucket& bucket,
+                                   const spi::BatchOperationList& operations,
+                                   spi::Context& context)
+{
+    spi::BatchResult result(_impl.executeBatch(bucket, operations, context));
+    handle(result);
+    for (size_t i = 0; i < result.size(); ++i) {
+        handle(result.getResult(i));
+    }
+    return result;
+}
+
 spi::GetResult
 ProviderErrorWrapper::get(const spi::Bucket& bucket,
                              const document::FieldSet& fieldSet,
@@ -5,6 +5,7 @@
 #include "rpcrequestwrapper.h"
 #include <vespa/documentapi/messagebus/messages/wrongdistributionreply.h>
 #include <vespa/messagebus/emptyreply.h>
+#include <vespa/messagebus/messagebusparams.h>
 #include <vespa/messagebus/network/rpcnetworkparams.h>
 #include <vespa/messagebus/rpcmessagebus.h>
 #include <vespa/storage/common/bucket_resolver.h>
@@ -415,6 +416,8 @@ void CommunicationManager::configure(std::unique_ptr<CommunicationManagerConfig>
         params.setNumThreads(std::max(1, config->mbus.numThreads));
         params.setDispatchOnDecode(config->mbus.dispatchOnDecode);
         params.setDispatchOnEncode(config->mbus.dispatchOnEncode);
+        params.setMaxSendBatchSize(std::max(1, config->mbus.maxSendBatchSize));
+        params.setMaxSendBatchBytes(std::max(1, config->mbus.maxSendBatchBytes));
 
         params.setIdentity(mbus::Identity(_component.getIdentity()));
         if (config->mbusport != -1) {
@@ -428,12 +431,11 @@ void CommunicationManager::configure(std::unique_ptr<CommunicationManagerConfig>
                                                       90, config->mbus.compress.limit));
         // Configure messagebus here as we for legacy reasons have
         // config here.
-        _mbus = std::make_unique<mbus::RPCMessageBus>(
-                mbus::ProtocolSet()
-                        .add(std::make_shared<documentapi::DocumentProtocol>(*_component.getLoadTypes(), _component.getTypeRepo()))
-                        .add(std::make_shared<mbusprot::StorageProtocol>(_component.getTypeRepo(), *_component.getLoadTypes())),
-                params,
-                _configUri);
+        mbus::MessageBusParams mbusParams;
+        mbusParams.addProtocol(std::make_shared<documentapi::DocumentProtocol>(*_component.getLoadTypes(), _component.getTypeRepo()));
+        mbusParams.addProtocol(std::make_shared<mbusprot::StorageProtocol>(_component.getTypeRepo(), *_component.getLoadTypes()));
+        mbusParams.setNumMessengerThreads(std::max(1, config->mbus.numMessengerThreads));
+        _mbus = std::make_unique<mbus::RPCMessageBus>(mbusParams, params, _configUri);
 
         configureMessageBusLimits(*config);
     }
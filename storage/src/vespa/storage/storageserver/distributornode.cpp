@@ -108,7 +108,9 @@ DistributorNode::createChain()
             new storage::distributor::Distributor(
                 dcr, *_threadPool, getDoneInitializeHandler(),
                 _manageActiveBucketCopies,
-                stateManager->getHostInfo())));
+                stateManager->getHostInfo(),
+                nullptr,
+                _serverConfig->useBtreeBucketDb)));
 
     chain->push_back(StorageLink::UP(stateManager.release()));
     return chain;
@@ -0,0 +1,49 @@
+// Copyright 2019 Oath Inc. Licensed under the terms of the Apache 2.0 license. See LICENSE in the project root.
+
+#include "adaptive_pending_window.h"
+#include <algorithm>
+
+namespace storage {
+
+AdaptivePendingWindow::AdaptivePendingWindow(uint32_t maxSize)
+    : _maxSize(std::max(maxSize, 1u)),
+      _size(_maxSize),
+      _successfulRepliesInWindow(0),
+      _sendSequence(0),
+      _lastDecreaseSequence(0)
+{
+}
+
+void
+AdaptivePendingWindow::setMaxSize(uint32_t maxSize) noexcept
+{
+    _maxSize = std::max(maxSize, 1u);
+    _size = _maxSize;
+    _successfulRepliesInWindow = 0;
+    _lastDecreaseSequence = _sendSequence;
+}
+
+void
+AdaptivePendingWindow::onSuccessfulReply() noexcept
+{
+    if (_size >= _maxSize) {
+        return;
+    }
+    if (++_successfulRepliesInWindow >= _size) {
+        ++_size;
+        _successfulRepliesInWindow = 0;
+    }
+}
+
+void
+AdaptivePendingWindow::onBusyReply(uint64_t sendSequence) noexcept
+{
+    if (sendSequence <= _lastDecreaseSequence) {
+        return;
+    }
+    _size = std::max(_size / 2, 1u);
+    _successfulRepliesInWindow = 0;
+    _lastDecreaseSequence = _sendSequence;
+}
+
+} // storage
@@ -0,0 +1,54 @@
+// Copyright 2019 Oath Inc. Licensed under the terms of the Apache 2.0 license. See LICENSE in the project root.
+
+#pragma once
+
+#include <cstdint>
+
+namespace storage {
+
+/**
+ * Window of messages a visitor may have pending towards its client, adapted
+ * to how fast the client consumes data. The window starts out at the maximum
+ * number of pending messages requested by the client. When the client signals
+ * that it is busy the window is halved, and for every window's worth of
+ * successful replies it grows by one message again, until it is back at the
+ * maximum. A window never shrinks below a single message.
+ *
+ * Messages are numbered as they are sent. The window is halved at most once
+ * per window of messages; busy replies to messages sent before the last
+ * decrease are ignored, as they were sent under the larger window.
+ *
+ * This is the additive increase, multiplicative decrease scheme used for TCP
+ * congestion control, and keeps a visitor from queueing up more data at a
+ * slow client than it can handle while still letting it stream at full
+ * speed towards a fast one.
+ */
+class AdaptivePendingWindow {
+public:
+    explicit AdaptivePendingWindow(uint32_t maxSize);
+
+    /**
+     * Sets the maximum size of the window and resets the window to it.
+     */
+    void setMaxSize(uint32_t maxSize) noexcept;
+
+    /**
+     * Returns the sequence number of a message being sent, to be passed
+     * back with a busy reply to it.
+     */
+    uint64_t onSend() noexcept { return ++_sendSequence; }
+    void onSuccessfulReply() noexcept;
+    void onBusyReply(uint64_t sendSequence) noexcept;
+
+    uint32_t size() const noexcept { return _size; }
+    uint32_t maxSize() const noexcept { return _maxSize; }
+
+private:
+    uint32_t _maxSize;
+    uint32_t _size;
+    uint32_t _successfulRepliesInWindow;
+    uint64_t _sendSequence;
+    uint64_t _lastDecreaseSequence;
+};
+
+} // storage
@@ -113,6 +113,7 @@ Visitor::VisitorTarget::MessageMeta::MessageMeta(
         std::unique_ptr<documentapi::DocumentMessage> msg)
     : messageId(msgId),
       retryCount(0),
+      sendSequence(0),
       memoryUsage(msg->getApproxSize()),
       message(std::move(msg)),
       messageText(message->toString())
@@ -123,6 +124,7 @@ Visitor::VisitorTarget::MessageMeta::MessageMeta(
         Visitor::VisitorTarget::MessageMeta&& rhs) noexcept
     : messageId(rhs.messageId),
       retryCount(rhs.retryCount),
+      sendSequence(rhs.sendSequence),
       memoryUsage(rhs.memoryUsage),
       message(std::move(rhs.message)),
       messageText(std::move(rhs.messageText))
@@ -139,6 +141,7 @@ Visitor::VisitorTarget::MessageMeta::operator=(
 {
     messageId = rhs.messageId;
     retryCount = rhs.retryCount;
+    sendSequence = rhs.sendSequence;
     memoryUsage = rhs.memoryUsage;
     message = std::move(rhs.message);
     messageText = std::move(rhs.messageText);
@@ -240,6 +243,7 @@ Visitor::VisitorTarget::~VisitorTarget() {}
 Visitor::Visitor(StorageComponent& component)
     : _component(component),
       _visitorOptions(),
+      _pendingWindow(_visitorOptions._maxPending),
       _visitorTarget(),
       _state(STATE_NOT_STARTED),
       _buckets(),
@@ -304,13 +308,13 @@ void
 Visitor::sendDocumentApiMessage(VisitorTarget::MessageMeta& msgMeta) {
     documentapi::DocumentMessage& cmd(*msgMeta.message);
     // Just enqueue if it's not time to send this message yet
-    if (_messageSession->pending() >= _visitorOptions._maxPending
+    if (_messageSession->pending() >= _pendingWindow.size()
         && cmd.getType() != documentapi::DocumentProtocol::MESSAGE_VISITORINFO)
     {
         MBUS_TRACE(cmd.getTrace(), 5, vespalib::make_string(
                            "Enqueueing message because the visitor already "
                            "had %d pending messages",
-                           _visitorOptions._maxPending));
+                           _pendingWindow.size()));
 
         LOG(spam,
             "Visitor '%s' enqueueing message with id %" PRIu64,
@@ -325,6 +329,7 @@ Visitor::sendDocumentApiMessage(VisitorTarget::MessageMeta& msgMeta) {
             cmd.toString().c_str(),
             msgMeta.messageId);
         cmd.setContext(msgMeta.messageId);
+        msgMeta.sendSequence = _pendingWindow.onSend();
         mbus::Result res(_messageSession->send(std::move(msgMeta.message)));
         if (res.isAccepted()) {
             _visitorTarget._pendingMessages.insert(msgMeta.messageId);
@@ -691,6 +696,9 @@ Visitor::handleDocumentApiReply(mbus::Reply::UP reply,
     if (!reply->hasErrors()) {
         metrics.averageMessageSendTime[getLoadType()].addValue(
                 (message->getTimeRemaining() - message->getTimeRemainingNow()) / 1000.0);
+        if (message->getType() != documentapi::DocumentProtocol::MESSAGE_VISITORINFO) {
+            _pendingWindow.onSuccessfulReply();
+        }
         LOG(debug, "Visitor '%s' reply %s for message ID %" PRIu64 " was OK", _id.c_str(),
             reply->toString().c_str(), messageId);
 
@@ -723,6 +731,13 @@ Visitor::handleDocumentApiReply(mbus::Reply::UP reply,
         return;
     }
 
+    if (returnCode.isBusy()) {
+        // Client can't keep up; send it less data at a time until it can.
+        _pendingWindow.onBusyReply(meta.sendSequence);
+        LOG(debug, "Visitor '%s' client is busy. Reducing pending window to %u",
+            _id.c_str(), _pendingWindow.size());
+    }
+
     if (failed()) {
         LOG(debug, "Failed to send message from visitor '%s', due to "
             "%s. Not resending since visitor has failed",
@@ -909,7 +924,7 @@ Visitor::sendDueQueuedMessages(framework::MicroSecTime timeNow)
     // Assuming few messages in sent queue, so cheap to go through all.
     while (!_visitorTarget._queuedMessages.empty()
            && (_visitorTarget._pendingMessages.size()
-               < _visitorOptions._maxPending)) {
+               < _pendingWindow.size())) {
         VisitorTarget::MessageQueue::iterator it(
                 _visitorTarget._queuedMessages.begin());
         if (it->first < timeNow) {
@@ -944,12 +959,13 @@ Visitor::continueVisitor()
 
     // No need to do more work if we already have maximum pending towards data handler
     if (_messageSession->pending() + _visitorTarget._queuedMessages.size()
-        >= _visitorOptions._maxPending)
+        >= _pendingWindow.size())
     {
         LOG(spam, "Number of pending messages (%zu pending, %zu queued) "
-            "already >= max pending (%u)",
+            "already >= pending window (%u, max %u)",
             _visitorTarget._pendingMessages.size(),
             _visitorTarget._queuedMessages.size(),
+            _pendingWindow.size(),
             _visitorOptions._maxPending);
         return false;
     }
@@ -1039,6 +1055,9 @@ Visitor::getStatus(std::ostream& out, bool verbose) const
         out << "<tr><td>Max messages pending to client</td><td>"
             << _visitorOptions._maxPending
             << "</td></tr>\n";
+        out << "<tr><td>Current messages pending window</td><td>"
+            << _pendingWindow.size()
+            << "</td></tr>\n";
         out << "<tr><td>Max parallel buckets visited</td><td>"
             << _visitorOptions._maxParallel
             << "</td></tr>\n";
@@ -1229,7 +1248,7 @@ Visitor::getIterators()
     // start iterating a new bucket
     uint32_t sentCount = 0;
     while (_bucketStates.size() < _visitorOptions._maxParallel &&
-           _bucketStates.size() < _visitorOptions._maxPending &&
+           _bucketStates.size() < _pendingWindow.size() &&
            _currentBucket < _buckets.size())
     {
         document::Bucket bucket(_bucketSpace, _buckets[_currentBucket]);
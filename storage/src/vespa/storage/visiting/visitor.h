@@ -17,6 +17,7 @@
 #include <vespa/storageapi/message/visitor.h>
 #include <vespa/document/select/orderingspecification.h>
 #include <vespa/storage/common/storagecomponent.h>
+#include "adaptive_pending_window.h"
 #include <vespa/storage/common/visitorfactory.h>
 #include <vespa/documentapi/messagebus/messages/documentmessage.h>
 #include <vespa/persistence/spi/docentry.h>
@@ -219,6 +220,8 @@ private:
 
             uint64_t messageId;
             uint32_t retryCount;
+            // Pending window sequence number of the last send of the message.
+            uint64_t sendSequence;
             // Memory usage for message the meta object was created with.
             uint32_t memoryUsage;
             std::unique_ptr<documentapi::DocumentMessage> message;
@@ -274,6 +277,9 @@ protected:
 
 private:
     VisitorOptions _visitorOptions;
+    // Number of messages currently allowed pending towards the client, which
+    // never exceeds _visitorOptions._maxPending.
+    AdaptivePendingWindow _pendingWindow;
     VisitorTarget _visitorTarget;
     VisitorState _state;
 
@@ -362,8 +368,11 @@ public:
     const api::StorageMessageAddress* getDataDestination() const
         { return _dataDestination.get(); }  // Can't be null if attached
 
-    void setMaxPending(unsigned int maxPending)
-        { _visitorOptions._maxPending = maxPending; }
+    void setMaxPending(unsigned int maxPending) {
+        _visitorOptions._maxPending = maxPending;
+        _pendingWindow.setMaxSize(maxPending);
+    }
+    uint32_t getPendingWindowSize() const { return _pendingWindow.size(); }
 
     void setFieldSet(const std::string& fieldSet) { _visitorOptions._fieldSet = fieldSet; }
     void visitRemoves() { _visitorOptions._visitRemoves = true; }
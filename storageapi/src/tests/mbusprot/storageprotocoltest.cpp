@@ -44,6 +44,7 @@ struct StorageProtocolTest : public CppUnit::TestFixture {
     vespalib::Version _version5_1{5, 1, 0};
     vespalib::Version _version5_2{5, 93, 30};
     vespalib::Version _version6_0{6, 240, 0};
+    vespalib::Version _version7_0{7, 40, 0};
     documentapi::LoadTypeSet _loadTypes;
     mbusprot::StorageProtocol _protocol;
     static std::vector<std::string> _nonVerboseMessageStrings;
@@ -65,6 +66,8 @@ struct StorageProtocolTest : public CppUnit::TestFixture {
     std::shared_ptr<Command> copyCommand(const std::shared_ptr<Command>&, vespalib::Version);
     template<typename Reply>
     std::shared_ptr<Reply> copyReply(const std::shared_ptr<Reply>&);
+    template<typename Reply>
+    std::shared_ptr<Reply> copyReply(const std::shared_ptr<Reply>&, vespalib::Version);
     void recordOutput(const api::StorageMessage& msg);
 
     void recordSerialization50();
@@ -102,6 +105,9 @@ struct StorageProtocolTest : public CppUnit::TestFixture {
     void testCreateVisitorWithBucketSpace6_0();
     void testRequestBucketInfoWithBucketSpace6_0();
 
+    void testGetBucketDiffWithRangeHashes7_0();
+    void testGetBucketDiffRangeHashesNotSentToOlderVersions();
+
     void serialized_size_is_used_to_set_approx_size_of_storage_message();
 
     CPPUNIT_TEST_SUITE(StorageProtocolTest);
@@ -144,6 +150,10 @@ struct StorageProtocolTest : public CppUnit::TestFixture {
     CPPUNIT_TEST(testCreateVisitorWithBucketSpace6_0);
     CPPUNIT_TEST(testRequestBucketInfoWithBucketSpace6_0);
 
+    // 7.0 tests
+    CPPUNIT_TEST(testGetBucketDiffWithRangeHashes7_0);
+    CPPUNIT_TEST(testGetBucketDiffRangeHashesNotSentToOlderVersions);
+
     CPPUNIT_TEST(serialized_size_is_used_to_set_approx_size_of_storage_message);
 
     CPPUNIT_TEST_SUITE_END();
@@ -218,10 +228,16 @@ StorageProtocolTest::copyCommand(const std::shared_ptr<Command>& m, vespalib::Ve
 
 template<typename Reply> std::shared_ptr<Reply>
 StorageProtocolTest::copyReply(const std::shared_ptr<Reply>& m)
+{
+    return copyReply(m, _version5_1);
+}
+
+template<typename Reply> std::shared_ptr<Reply>
+StorageProtocolTest::copyReply(const std::shared_ptr<Reply>& m, vespalib::Version version)
 {
     mbus::Reply::UP mbusMessage(new mbusprot::StorageReply(m));
-    mbus::Blob blob = _protocol.encode(_version5_1, *mbusMessage);
-    mbus::Routable::UP copy(_protocol.decode(_version5_1, blob));
+    mbus::Blob blob = _protocol.encode(version, *mbusMessage);
+    mbus::Routable::UP copy(_protocol.decode(version, blob));
     CPPUNIT_ASSERT(copy.get());
     mbusprot::StorageReply* copy2(
             dynamic_cast<mbusprot::StorageReply*>(copy.get()));
@@ -918,6 +934,61 @@ StorageProtocolTest::testRequestBucketInfoWithBucketSpace6_0()
     CPPUNIT_ASSERT_EQUAL(ids, cmd2->getBuckets());
 }
 
+void
+StorageProtocolTest::testGetBucketDiffWithRangeHashes7_0()
+{
+    ScopedName test("testGetBucketDiffWithRangeHashes7_0");
+
+    std::vector<api::MergeBucketCommand::Node> nodes = {4, 13};
+    std::vector<GetBucketDiffCommand::RangeHash> hashes = {{0x1234, false}, {0xfedcba9876543210, true}};
+    auto cmd = std::make_shared<GetBucketDiffCommand>(_bucket, nodes, 1056);
+    cmd->getRangeHashes() = hashes;
+
+    auto cmd2 = copyCommand(cmd, _version7_0);
+    CPPUNIT_ASSERT_EQUAL(nodes, cmd2->getNodes());
+    CPPUNIT_ASSERT_EQUAL(Timestamp(1056), cmd2->getMaxTimestamp());
+    CPPUNIT_ASSERT(cmd2->getDiff().empty());
+    CPPUNIT_ASSERT(hashes == cmd2->getRangeHashes());
+
+    auto reply = std::make_shared<GetBucketDiffReply>(*cmd2);
+    CPPUNIT_ASSERT(reply->getRangeHashes().empty());
+    reply->getRangeHashes() = hashes;
+    reply->getRangeHashes()[0]._differs = true;
+    reply->getDiff().push_back(GetBucketDiffCommand::Entry());
+    reply->getDiff().back()._timestamp = 123456;
+    reply->getDiff().back()._hasMask = 2;
+
+    auto reply2 = copyReply(reply, _version7_0);
+    CPPUNIT_ASSERT(reply->getRangeHashes() == reply2->getRangeHashes());
+    CPPUNIT_ASSERT_EQUAL(reply->getDiff(), reply2->getDiff());
+}
+
+void
+StorageProtocolTest::testGetBucketDiffRangeHashesNotSentToOlderVersions()
+{
+    ScopedName test("testGetBucketDiffRangeHashesNotSentToOlderVersions");
+
+    std::vector<api::MergeBucketCommand::Node> nodes = {4, 13};
+    auto cmd = std::make_shared<GetBucketDiffCommand>(_bucket, nodes, 1056);
+    cmd->getRangeHashes().emplace_back(0x1234, false);
+
+    // Older nodes do not know about the hashes, and will merge as before.
+    auto cmd2 = copyCommand(cmd, _version6_0);
+    CPPUNIT_ASSERT(cmd2->getRangeHashes().empty());
+
+    // A reply decoded from an older node carries no hashes even if the
+    // command it is a reply to had them.
+    auto reply = std::make_shared<GetBucketDiffReply>(*cmd2);
+    reply->getRangeHashes().emplace_back(0x1234, true);
+    auto reply2 = copyReply(reply, _version6_0);
+    CPPUNIT_ASSERT(reply2->getRangeHashes().empty());
+
+    // Neither do 7 nodes released before the hashes were added.
+    vespalib::Version version7_39{7, 39, 99};
+    CPPUNIT_ASSERT(copyCommand(cmd, version7_39)->getRangeHashes().empty());
+    CPPUNIT_ASSERT(copyReply(reply, version7_39)->getRangeHashes().empty());
+}
+
 void
 StorageProtocolTest::serialized_size_is_used_to_set_approx_size_of_storage_message()
 {
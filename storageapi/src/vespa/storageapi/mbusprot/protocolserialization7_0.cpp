@@ -0,0 +1,72 @@
+// Copyright 2019 Oath Inc. Licensed under the terms of the Apache 2.0 license. See LICENSE in the project root.
+
+#include "protocolserialization7_0.h"
+#include "serializationhelper.h"
+
+namespace storage::mbusprot {
+
+ProtocolSerialization7_0::ProtocolSerialization7_0(const std::shared_ptr<const document::DocumentTypeRepo> &repo,
+                                                   const documentapi::LoadTypeSet &loadTypes)
+    : ProtocolSerialization6_0(repo, loadTypes)
+{
+}
+
+void
+ProtocolSerialization7_0::encodeRangeHashes(GBBuf & buf, const std::vector<api::GetBucketDiffCommand::RangeHash> & hashes)
+{
+    buf.putInt(hashes.size());
+    for (const auto & hash : hashes) {
+        buf.putLong(hash._hash);
+        buf.putBoolean(hash._differs);
+    }
+}
+
+void
+ProtocolSerialization7_0::decodeRangeHashes(BBuf & buf, std::vector<api::GetBucketDiffCommand::RangeHash> & hashes)
+{
+    if (buf.getRemaining() == 0) {
+        return; // Sent by a node not knowing about range hashes.
+    }
+    uint32_t hashCount = SH::getInt(buf);
+    if (hashCount > buf.getRemaining()) {
+            // Trigger out of bounds exception rather than out of memory error
+        buf.incPos(hashCount);
+    }
+    hashes.resize(hashCount);
+    for (auto & hash : hashes) {
+        hash._hash = SH::getLong(buf);
+        hash._differs = SH::getBoolean(buf);
+    }
+}
+
+void
+ProtocolSerialization7_0::onEncode(GBBuf & buf, const api::GetBucketDiffCommand & msg) const
+{
+    ProtocolSerialization4_2::onEncode(buf, msg);
+    encodeRangeHashes(buf, msg.getRangeHashes());
+}
+
+void
+ProtocolSerialization7_0::onEncode(GBBuf & buf, const api::GetBucketDiffReply & msg) const
+{
+    ProtocolSerialization5_0::onEncode(buf, msg);
+    encodeRangeHashes(buf, msg.getRangeHashes());
+}
+
+api::StorageCommand::UP
+ProtocolSerialization7_0::onDecodeGetBucketDiffCommand(BBuf & buf) const
+{
+    api::StorageCommand::UP cmd(ProtocolSerialization6_0::onDecodeGetBucketDiffCommand(buf));
+    decodeRangeHashes(buf, static_cast<api::GetBucketDiffCommand &>(*cmd).getRangeHashes());
+    return cmd;
+}
+
+api::StorageReply::UP
+ProtocolSerialization7_0::onDecodeGetBucketDiffReply(const SCmd & cmd, BBuf & buf) const
+{
+    api::StorageReply::UP reply(ProtocolSerialization6_0::onDecodeGetBucketDiffReply(cmd, buf));
+    decodeRangeHashes(buf, static_cast<api::GetBucketDiffReply &>(*reply).getRangeHashes());
+    return reply;
+}
+
+}
@@ -0,0 +1,32 @@
+// Copyright 2019 Oath Inc. Licensed under the terms of the Apache 2.0 license. See LICENSE in the project root.
+
+#pragma once
+
+#include "protocolserialization6_0.h"
+
+namespace storage::mbusprot {
+
+/**
+ * Protocol serialization version adding the per gid range content hashes of
+ * GetBucketDiff commands and replies. The hashes are appended after all
+ * fields known to earlier versions, which ignore them, and are decoded as
+ * absent if the sender did not append them.
+ */
+class ProtocolSerialization7_0 : public ProtocolSerialization6_0
+{
+public:
+    ProtocolSerialization7_0(const std::shared_ptr<const document::DocumentTypeRepo> &repo,
+                             const documentapi::LoadTypeSet &loadTypes);
+
+protected:
+    void onEncode(GBBuf &, const api::GetBucketDiffCommand &) const override;
+    void onEncode(GBBuf &, const api::GetBucketDiffReply &) const override;
+
+    SCmd::UP onDecodeGetBucketDiffCommand(BBuf &) const override;
+    SRep::UP onDecodeGetBucketDiffReply(const SCmd &, BBuf &) const override;
+
+    static void encodeRangeHashes(GBBuf & buf, const std::vector<api::GetBucketDiffCommand::RangeHash> & hashes);
+    static void decodeRangeHashes(BBuf & buf, std::vector<api::GetBucketDiffCommand::RangeHash> & hashes);
+};
+
+}
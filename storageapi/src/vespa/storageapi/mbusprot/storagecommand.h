@@ -21,6 +21,10 @@ public:
     api::StorageMessage::SP getInternalMessage() override { return _cmd; }
     api::StorageMessage::CSP getInternalMessage() const override { return _cmd; }
 
+    // Commands to the same bucket are delivered in order.
+    bool hasDeliveryKey() const override { return _cmd->hasSingleBucketId(); }
+    uint64_t getDeliveryKey() const override { return _cmd->getBucketId().getRawId(); }
+
     uint8_t priority() const override {
         return ((getInternalMessage()->getPriority()) / 255) * 16;
     }
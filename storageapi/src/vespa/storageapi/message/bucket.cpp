@@ -235,6 +235,9 @@ GetBucketDiffCommand::print(std::ostream& out, bool verbose,
         out << ", " << _diff.size() << " entries";
         out << ", id " << _msgId;
     }
+    if (!_rangeHashes.empty()) {
+        out << ", " << _rangeHashes.size() << " range hashes";
+    }
     out << ")";
     if (verbose) {
         out << " : ";
@@ -246,7 +249,8 @@ GetBucketDiffReply::GetBucketDiffReply(const GetBucketDiffCommand& cmd)
     : BucketReply(cmd),
       _nodes(cmd.getNodes()),
       _maxTimestamp(cmd.getMaxTimestamp()),
-      _diff(cmd.getDiff())
+      _diff(cmd.getDiff()),
+      _rangeHashes()
 {}
 
 GetBucketDiffReply::~GetBucketDiffReply() {}
@@ -273,6 +277,9 @@ GetBucketDiffReply::print(std::ostream& out, bool verbose,
         out << ", " << _diff.size() << " entries";
         out << ", id " << _msgId;
     }
+    if (!_rangeHashes.empty()) {
+        out << ", " << _rangeHashes.size() << " range hashes";
+    }
     out << ")";
     if (verbose) {
         out << " : ";
@@ -190,10 +190,27 @@ public:
         bool operator<(const Entry& e) const
             { return (_timestamp < e._timestamp); }
     };
+
+    /**
+     * Content hash of the entries of one gid range of the bucket, as seen by
+     * the first node in the merge chain. Nodes further down the chain flag
+     * the range as differing if their own copy hashes differently, such that
+     * only entries within differing ranges need to be listed in the diff.
+     */
+    struct RangeHash {
+        uint64_t _hash;
+        bool _differs;
+
+        RangeHash() : _hash(0), _differs(false) {}
+        RangeHash(uint64_t hash, bool differs) : _hash(hash), _differs(differs) {}
+        bool operator==(const RangeHash& other) const
+            { return (_hash == other._hash && _differs == other._differs); }
+    };
 private:
     std::vector<Node> _nodes;
     Timestamp _maxTimestamp;
     std::vector<Entry> _diff;
+    std::vector<RangeHash> _rangeHashes;
 
 public:
     GetBucketDiffCommand(const document::Bucket &bucket,
@@ -205,6 +222,9 @@ public:
     Timestamp getMaxTimestamp() const { return _maxTimestamp; }
     const std::vector<Entry>& getDiff() const { return _diff; }
     std::vector<Entry>& getDiff() { return _diff; }
+    /** Empty unless the merge diffs the bucket range by range. */
+    const std::vector<RangeHash>& getRangeHashes() const { return _rangeHashes; }
+    std::vector<RangeHash>& getRangeHashes() { return _rangeHashes; }
 
     void print(std::ostream& out, bool verbose, const std::string& indent) const override;
 
@@ -221,11 +241,13 @@ class GetBucketDiffReply : public BucketReply {
 public:
     typedef MergeBucketCommand::Node Node;
     typedef GetBucketDiffCommand::Entry Entry;
+    typedef GetBucketDiffCommand::RangeHash RangeHash;
 
 private:
     std::vector<Node> _nodes;
     Timestamp _maxTimestamp;
     std::vector<Entry> _diff;
+    std::vector<RangeHash> _rangeHashes;
 
 public:
     explicit GetBucketDiffReply(const GetBucketDiffCommand& cmd);
@@ -235,6 +257,12 @@ public:
     Timestamp getMaxTimestamp() const { return _maxTimestamp; }
     const std::vector<Entry>& getDiff() const { return _diff; }
     std::vector<Entry>& getDiff() { return _diff; }
+    /**
+     * Not inherited from the command. Set by the replying node to tell that
+     * the diff only lists entries within the ranges flagged as differing.
+     */
+    const std::vector<RangeHash>& getRangeHashes() const { return _rangeHashes; }
+    std::vector<RangeHash>& getRangeHashes() { return _rangeHashes; }
     void print(std::ostream& out, bool verbose, const std::string& indent) const override;
 
     DECLARE_STORAGEREPLY(GetBucketDiffReply, onGetBucketDiffReply)
@@ -58,6 +58,8 @@ struct DistributionTest : public CppUnit::TestFixture {
 
     void testEmptyAndCopy();
 
+    void testBatchedIdealNodesMatchSingleBucketLookups();
+
     CPPUNIT_TEST_SUITE(DistributionTest);
     CPPUNIT_TEST(testVerifyJavaDistributions);
     CPPUNIT_TEST(testVerifyJavaDistributions2);
@@ -84,6 +86,7 @@ struct DistributionTest : public CppUnit::TestFixture {
 
     CPPUNIT_TEST(testHighSplitBit);
     CPPUNIT_TEST(testActivePerGroup);
+    CPPUNIT_TEST(testBatchedIdealNodesMatchSingleBucketLookups);
 
     // Skew tests. Should probably be in separate test file.
     /*
@@ -1479,4 +1482,36 @@ DistributionTest::testEmptyAndCopy()
     CPPUNIT_ASSERT_EQUAL(uint16_t(1), d.getReadyCopies());
 }
 
+void
+DistributionTest::testBatchedIdealNodesMatchSingleBucketLookups()
+{
+    Distribution distr("redundancy 4\n" + groupConfig);
+    ClusterState state("bits:8 distributor:6 .2.s:d storage:6 .1.s:m .3.s:d .4.c:1.5");
+
+    std::vector<document::BucketId> buckets;
+    for (uint32_t i = 0; i < 64; ++i) {
+        buckets.push_back(document::BucketId(16, i * 17));
+        buckets.push_back(document::BucketId(20, (uint64_t(i) << 16) | (i * 17)));
+        buckets.push_back(document::BucketId(40, (uint64_t(i) << 34) | (i * 17)));
+    }
+
+    for (const NodeType* nodeType : {&NodeType::STORAGE, &NodeType::DISTRIBUTOR}) {
+        for (const char* upStates : {"ui", "uim"}) {
+            std::vector<std::vector<uint16_t>> batched;
+            distr.getIdealNodes(*nodeType, state, buckets, batched, upStates);
+            CPPUNIT_ASSERT_EQUAL(buckets.size(), batched.size());
+            for (size_t i = 0; i < buckets.size(); ++i) {
+                std::vector<uint16_t> single;
+                distr.getIdealNodes(*nodeType, state, buckets[i], single, upStates);
+                CPPUNIT_ASSERT_EQUAL(single, batched[i]);
+            }
+        }
+    }
+
+    std::vector<std::vector<uint16_t>> batched;
+    buckets.push_back(document::BucketId(4, 1));
+    CPPUNIT_ASSERT_THROW(distr.getIdealNodes(NodeType::STORAGE, state, buckets, batched),
+                         TooFewBucketBitsInUseException);
+}
+
 }
@@ -0,0 +1,191 @@
+// Copyright 2019 Oath Inc. Licensed under the terms of the Apache 2.0 license. See LICENSE in the project root.
+
+#include <vespa/vdslib/distribution/idealnodecalculatorcache.h>
+#include <vespa/vdslib/distribution/distribution.h>
+#include <vespa/vdslib/state/clusterstate.h>
+#include <vespa/config-stor-distribution.h>
+#include <vespa/vdstestlib/cppunit/macros.h>
+#include <thread>
+
+namespace storage {
+namespace lib {
+
+struct IdealNodeCalculatorCacheTest : public CppUnit::TestFixture {
+
+    void testCachedResultsMatchDistribution();
+    void testBatchedLookupsMatchDistribution();
+    void testNewClusterStateVersionIsNotServedOldEntries();
+    void testNewDistributionIsNotServedOldEntries();
+    void testClearDropsAllEntries();
+    void testLeastRecentlyUsedEntriesAreEvicted();
+    void testConcurrentLookupsMatchDistribution();
+
+    CPPUNIT_TEST_SUITE(IdealNodeCalculatorCacheTest);
+    CPPUNIT_TEST(testCachedResultsMatchDistribution);
+    CPPUNIT_TEST(testBatchedLookupsMatchDistribution);
+    CPPUNIT_TEST(testNewClusterStateVersionIsNotServedOldEntries);
+    CPPUNIT_TEST(testNewDistributionIsNotServedOldEntries);
+    CPPUNIT_TEST(testClearDropsAllEntries);
+    CPPUNIT_TEST(testLeastRecentlyUsedEntriesAreEvicted);
+    CPPUNIT_TEST(testConcurrentLookupsMatchDistribution);
+    CPPUNIT_TEST_SUITE_END();
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(IdealNodeCalculatorCacheTest);
+
+void
+IdealNodeCalculatorCacheTest::testCachedResultsMatchDistribution()
+{
+    ClusterState state("version:3 distributor:10 storage:10 .2.s:m");
+    Distribution distr(Distribution::getDefaultDistributionConfig(3, 10));
+    IdealNodeCalculatorCache cache(1000);
+
+    for (uint32_t round = 0; round < 2; ++round) {
+        for (uint32_t i = 0; i < 32; ++i) {
+            document::BucketId bucket(16, i);
+            for (const char* upStates : {"ui", "uim"}) {
+                CPPUNIT_ASSERT_EQUAL(distr.getIdealStorageNodes(state, bucket, upStates),
+                                     cache.getIdealNodes(NodeType::STORAGE, distr, state, bucket, upStates));
+                std::vector<uint16_t> distributor{distr.getIdealDistributorNode(state, bucket, upStates)};
+                CPPUNIT_ASSERT_EQUAL(distributor,
+                                     cache.getIdealNodes(NodeType::DISTRIBUTOR, distr, state, bucket, upStates));
+            }
+        }
+    }
+    CPPUNIT_ASSERT_EQUAL(uint64_t(128), cache.getMissCount());
+    CPPUNIT_ASSERT_EQUAL(uint64_t(128), cache.getHitCount());
+}
+
+void
+IdealNodeCalculatorCacheTest::testBatchedLookupsMatchDistribution()
+{
+    ClusterState state("version:3 distributor:10 storage:10 .4.s:d");
+    Distribution distr(Distribution::getDefaultDistributionConfig(3, 10));
+    IdealNodeCalculatorCache cache(1000);
+
+    std::vector<document::BucketId> buckets;
+    for (uint32_t i = 0; i < 16; ++i) {
+        buckets.push_back(document::BucketId(16, i));
+        buckets.push_back(document::BucketId(24, (uint64_t(i) << 16) | i));
+    }
+    // Half of the buckets are cached before the batched lookup
+    for (uint32_t i = 0; i < buckets.size(); i += 2) {
+        cache.getIdealNodes(NodeType::STORAGE, distr, state, buckets[i]);
+    }
+    std::vector<std::vector<uint16_t>> nodes;
+    cache.getIdealNodes(NodeType::STORAGE, distr, state, buckets, nodes);
+    CPPUNIT_ASSERT_EQUAL(buckets.size(), nodes.size());
+    for (size_t i = 0; i < buckets.size(); ++i) {
+        CPPUNIT_ASSERT_EQUAL(distr.getIdealStorageNodes(state, buckets[i]), nodes[i]);
+    }
+    CPPUNIT_ASSERT_EQUAL(uint64_t(32), cache.getMissCount());
+    CPPUNIT_ASSERT_EQUAL(uint64_t(16), cache.getHitCount());
+
+    cache.getIdealNodes(NodeType::STORAGE, distr, state, buckets, nodes);
+    CPPUNIT_ASSERT_EQUAL(uint64_t(32), cache.getMissCount());
+    CPPUNIT_ASSERT_EQUAL(uint64_t(48), cache.getHitCount());
+}
+
+void
+IdealNodeCalculatorCacheTest::testNewClusterStateVersionIsNotServedOldEntries()
+{
+    ClusterState state("version:1 storage:10");
+    ClusterState newState("version:2 storage:10 .8.s:d");
+    Distribution distr(Distribution::getDefaultDistributionConfig(3, 10));
+    IdealNodeCalculatorCache cache(100);
+
+    document::BucketId bucket(16, 5);
+    CPPUNIT_ASSERT_EQUAL(distr.getIdealStorageNodes(state, bucket),
+                         cache.getIdealNodes(NodeType::STORAGE, distr, state, bucket));
+    CPPUNIT_ASSERT_EQUAL(distr.getIdealStorageNodes(newState, bucket),
+                         cache.getIdealNodes(NodeType::STORAGE, distr, newState, bucket));
+    CPPUNIT_ASSERT(distr.getIdealStorageNodes(state, bucket) != distr.getIdealStorageNodes(newState, bucket));
+    CPPUNIT_ASSERT_EQUAL(uint64_t(2), cache.getMissCount());
+    CPPUNIT_ASSERT_EQUAL(uint64_t(0), cache.getHitCount());
+}
+
+void
+IdealNodeCalculatorCacheTest::testNewDistributionIsNotServedOldEntries()
+{
+    ClusterState state("version:1 storage:10");
+    Distribution distr(Distribution::getDefaultDistributionConfig(3, 10));
+    Distribution newDistr(Distribution::getDefaultDistributionConfig(2, 10));
+    IdealNodeCalculatorCache cache(100);
+
+    document::BucketId bucket(16, 5);
+    CPPUNIT_ASSERT_EQUAL(size_t(3), cache.getIdealNodes(NodeType::STORAGE, distr, state, bucket).size());
+    CPPUNIT_ASSERT_EQUAL(size_t(2), cache.getIdealNodes(NodeType::STORAGE, newDistr, state, bucket).size());
+    CPPUNIT_ASSERT_EQUAL(uint64_t(2), cache.getMissCount());
+}
+
+void
+IdealNodeCalculatorCacheTest::testClearDropsAllEntries()
+{
+    ClusterState state("storage:10");
+    Distribution distr(Distribution::getDefaultDistributionConfig(3, 10));
+    IdealNodeCalculatorCache cache(100);
+
+    cache.getIdealNodes(NodeType::STORAGE, distr, state, document::BucketId(16, 1));
+    cache.clear();
+    cache.getIdealNodes(NodeType::STORAGE, distr, state, document::BucketId(16, 1));
+    CPPUNIT_ASSERT_EQUAL(uint64_t(2), cache.getMissCount());
+    CPPUNIT_ASSERT_EQUAL(uint64_t(0), cache.getHitCount());
+}
+
+void
+IdealNodeCalculatorCacheTest::testLeastRecentlyUsedEntriesAreEvicted()
+{
+    ClusterState state("storage:10");
+    Distribution distr(Distribution::getDefaultDistributionConfig(3, 10));
+    IdealNodeCalculatorCache cache(2, 1);
+
+    cache.getIdealNodes(NodeType::STORAGE, distr, state, document::BucketId(16, 1));
+    cache.getIdealNodes(NodeType::STORAGE, distr, state, document::BucketId(16, 2));
+    cache.getIdealNodes(NodeType::STORAGE, distr, state, document::BucketId(16, 1));
+    cache.getIdealNodes(NodeType::STORAGE, distr, state, document::BucketId(16, 3));
+    CPPUNIT_ASSERT_EQUAL(uint64_t(3), cache.getMissCount());
+    CPPUNIT_ASSERT_EQUAL(uint64_t(1), cache.getHitCount());
+
+    // Bucket 2 was least recently used when bucket 3 was inserted
+    cache.getIdealNodes(NodeType::STORAGE, distr, state, document::BucketId(16, 1));
+    cache.getIdealNodes(NodeType::STORAGE, distr, state, document::BucketId(16, 2));
+    CPPUNIT_ASSERT_EQUAL(uint64_t(4), cache.getMissCount());
+    CPPUNIT_ASSERT_EQUAL(uint64_t(2), cache.getHitCount());
+}
+
+void
+IdealNodeCalculatorCacheTest::testConcurrentLookupsMatchDistribution()
+{
+    ClusterState state("version:7 distributor:10 storage:10 .3.s:m");
+    Distribution distr(Distribution::getDefaultDistributionConfig(3, 10));
+    IdealNodeCalculatorCache cache(64, 4);
+
+    std::vector<std::vector<uint16_t>> expected;
+    for (uint32_t i = 0; i < 256; ++i) {
+        expected.push_back(distr.getIdealStorageNodes(state, document::BucketId(16, i)));
+    }
+    std::vector<uint32_t> mismatches(4, 0);
+    std::vector<std::thread> threads;
+    for (uint32_t t = 0; t < mismatches.size(); ++t) {
+        threads.emplace_back([&, t]() {
+            for (uint32_t round = 0; round < 20; ++round) {
+                for (uint32_t i = 0; i < expected.size(); ++i) {
+                    uint32_t b = (i * (t + 1)) % expected.size();
+                    if (cache.getIdealNodes(NodeType::STORAGE, distr, state, document::BucketId(16, b)) != expected[b]) {
+                        ++mismatches[t];
+                    }
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    for (uint32_t count : mismatches) {
+        CPPUNIT_ASSERT_EQUAL(uint32_t(0), count);
+    }
+    CPPUNIT_ASSERT_EQUAL(uint64_t(4 * 20 * 256), cache.getHitCount() + cache.getMissCount());
+}
+
+} // lib
+} // storage
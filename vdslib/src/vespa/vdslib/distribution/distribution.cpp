@@ -6,12 +6,14 @@
 #include <vespa/vdslib/state/random.h>
 #include <vespa/vespalib/util/bobhash.h>
 #include <vespa/vespalib/stllike/asciistream.h>
+#include <vespa/vespalib/stllike/hash_fun.h>
 #include <vespa/config/config.h>
 #include <vespa/config/print/asciiconfigwriter.h>
 #include <vespa/config/print/asciiconfigreader.h>
 #include <vespa/vespalib/util/exceptions.h>
 #include <vespa/config-stor-distribution.h>
 #include <list>
+#include <unordered_map>
 #include <algorithm>
 #include <cmath>
 
@@ -107,7 +109,8 @@ Distribution::Distribution(const vespalib::string& serialized)
 Distribution&
 Distribution::operator=(const Distribution& d)
 {
-    vespalib::asciistream ist(d.serialize());
+    _serialized = d._serialized;
+    vespalib::asciistream ist(_serialized);
     config::AsciiConfigReader<vespa::config::content::StorDistributionConfig> reader(ist);
     configure(*reader.read());
     return *this;
@@ -140,6 +143,7 @@ namespace {
 void
 Distribution::configure(const vespa::config::content::StorDistributionConfig& config)
 {
+    _serializedHash = vespalib::hashValue(_serialized.data(), _serialized.size());
     typedef vespa::config::content::StorDistributionConfig::Group ConfigGroup;
     std::unique_ptr<Group> nodeGraph;
     for (uint32_t i=0, n=config.group.size(); i<n; ++i) {
@@ -414,6 +418,98 @@ namespace {
             }
         }
     }
+
+    /** A node in an ideal group that is in one of the requested up states. */
+    struct NodeCandidate {
+        uint16_t _index;
+        const NodeState* _state;
+
+        NodeCandidate(uint16_t index, const NodeState& state)
+            : _index(index), _state(&state) {}
+    };
+
+    void getNodeCandidates(const NodeType& nodeType,
+                           const ClusterState& clusterState,
+                           const std::vector<uint16_t>& nodes,
+                           const char* upStates,
+                           std::vector<NodeCandidate>& candidates)
+    {
+        candidates.clear();
+        candidates.reserve(nodes.size());
+        for (uint16_t node : nodes) {
+            // Verify that the node is legal target before starting to grab
+            // random number. Helps worst case of having to start new random
+            // seed if the node that is out of order is illegal anyways.
+            const NodeState& nodeState(clusterState.getNodeState(Node(nodeType, node)));
+            if (nodeState.getState().oneOf(upStates)) {
+                candidates.emplace_back(node, nodeState);
+            }
+        }
+    }
+
+    /**
+     * Scores the candidates of a single group and appends the ideal nodes
+     * among them to resultNodes. The random generator and its index are
+     * shared between all groups that the bucket has copies in.
+     */
+    void selectIdealNodes(const Distribution& distribution,
+                          const std::vector<NodeCandidate>& candidates,
+                          const document::BucketId& bucket,
+                          uint32_t seed,
+                          uint16_t groupRedundancy,
+                          RandomGen& random,
+                          uint32_t& randomIndex,
+                          std::vector<uint16_t>& resultNodes)
+    {
+        // Create temporary place to hold results. Use double linked list
+        // for cheap access to back(). Stuff in redundancy fake entries to
+        // avoid needing to check size during iteration.
+        std::list<ScoredNode> tmpResults(groupRedundancy, ScoredNode(0, 0, 0));
+        for (const NodeCandidate& candidate : candidates) {
+            const NodeState& nodeState(*candidate._state);
+            if (nodeState.isAnyDiskDown()) {
+                uint16_t idealDiskIndex(distribution.getIdealDisk(
+                        nodeState, candidate._index, bucket, Distribution::IDEAL_DISK_EVEN_IF_DOWN));
+                if (nodeState.getDiskState(idealDiskIndex).getState() != State::UP) {
+                    continue;
+                }
+            }
+            // Get the score from the random number generator. Make sure we
+            // pick correct random number. Optimize for the case where we
+            // pick in rising order.
+            if (candidate._index != randomIndex) {
+                if (candidate._index < randomIndex) {
+                    random.setSeed(seed);
+                    randomIndex = 0;
+                }
+                for (uint32_t k=randomIndex, o=candidate._index; k<o; ++k) {
+                    random.nextDouble();
+                }
+                randomIndex = candidate._index;
+            }
+            double score = random.nextDouble();
+            ++randomIndex;
+            if (nodeState.getCapacity() != vespalib::Double(1.0)) {
+                score = std::pow(score, 1.0 / nodeState.getCapacity().getValue());
+            }
+            if (score > tmpResults.back()._score) {
+                for (std::list<ScoredNode>::iterator it = tmpResults.begin();
+                     it != tmpResults.end(); ++it)
+                {
+                    if (score > it->_score) {
+                        tmpResults.insert(it, ScoredNode(candidate._index, nodeState.getReliability(), score));
+                        break;
+                    }
+                }
+                tmpResults.pop_back();
+            }
+        }
+        trimResult(tmpResults, groupRedundancy);
+        resultNodes.reserve(resultNodes.size() + tmpResults.size());
+        for (const auto & scored : tmpResults) {
+            resultNodes.push_back(scored._index);
+        }
+    }
 }
 
 void
@@ -523,17 +619,9 @@ Distribution::allDistributorsDown(const Group& g, const ClusterState& cs)
 }
 
 void
-Distribution::getIdealNodes(const NodeType& nodeType,
-                            const ClusterState& clusterState,
-                            const document::BucketId& bucket,
-                            std::vector<uint16_t>& resultNodes,
-                            const char* upStates,
-                            uint16_t redundancy) const
+Distribution::verifyEnoughBucketBitsInUse(const ClusterState& clusterState,
+                                          const document::BucketId& bucket) const
 {
-    if (redundancy == DEFAULT_REDUNDANCY) redundancy = _redundancy;
-    resultNodes.clear();
-    if (redundancy == 0) return;
-
     // If bucket is split less than distribution bit, we cannot distribute
     // it. Different nodes own various parts of the bucket.
     if (bucket.getUsedBits() < clusterState.getDistributionBitCount()) {
@@ -543,14 +631,18 @@ Distribution::getIdealNodes(const NodeType& nodeType,
             << clusterState.getDistributionBitCount() << " distribution bits.";
         throw TooFewBucketBitsInUseException(ost.str(), VESPA_STRLOC);
     }
-    // Find what hierarchical groups we should have copies in
-    std::vector<ResultGroup> _groupDistribution;
-    uint32_t seed;
+}
+
+void
+Distribution::getIdealGroupsForNodeType(const NodeType& nodeType,
+                                        const ClusterState& clusterState,
+                                        const document::BucketId& bucket,
+                                        uint16_t redundancy,
+                                        std::vector<ResultGroup>& results) const
+{
     if (nodeType == NodeType::STORAGE) {
-        seed = getStorageSeed(bucket, clusterState);
-        getIdealGroups(bucket, clusterState, *_nodeGraph, redundancy, _groupDistribution);
+        getIdealGroups(bucket, clusterState, *_nodeGraph, redundancy, results);
     } else {
-        seed = getDistributorSeed(bucket, clusterState);
         const Group* group(getIdealDistributorGroup(bucket, clusterState, *_nodeGraph));
         if (group == nullptr) {
             vespalib::asciistream ss;
@@ -558,63 +650,85 @@ Distribution::getIdealNodes(const NodeType& nodeType,
                << clusterState.getVersion();
             throw NoDistributorsAvailableException(ss.str(), VESPA_STRLOC);
         }
-        _groupDistribution.push_back(ResultGroup(*group, 1));
+        results.push_back(ResultGroup(*group, 1));
     }
+}
+
+void
+Distribution::getIdealNodes(const NodeType& nodeType,
+                            const ClusterState& clusterState,
+                            const document::BucketId& bucket,
+                            std::vector<uint16_t>& resultNodes,
+                            const char* upStates,
+                            uint16_t redundancy) const
+{
+    if (redundancy == DEFAULT_REDUNDANCY) redundancy = _redundancy;
+    resultNodes.clear();
+    if (redundancy == 0) return;
+
+    verifyEnoughBucketBitsInUse(clusterState, bucket);
+    // Find what hierarchical groups we should have copies in
+    std::vector<ResultGroup> _groupDistribution;
+    getIdealGroupsForNodeType(nodeType, clusterState, bucket, redundancy, _groupDistribution);
+    uint32_t seed(nodeType == NodeType::STORAGE
+                  ? getStorageSeed(bucket, clusterState)
+                  : getDistributorSeed(bucket, clusterState));
     RandomGen random(seed);
     uint32_t randomIndex = 0;
+    std::vector<NodeCandidate> candidates;
     for (uint32_t i=0, n=_groupDistribution.size(); i<n; ++i) {
-        uint16_t groupRedundancy(_groupDistribution[i]._redundancy);
-        const std::vector<uint16_t>& nodes(_groupDistribution[i]._group->getNodes());
-        // Create temporary place to hold results. Use double linked list
-        // for cheap access to back(). Stuff in redundancy fake entries to
-        // avoid needing to check size during iteration.
-        std::list<ScoredNode> tmpResults(groupRedundancy, ScoredNode(0, 0, 0));
-        for (uint32_t j=0, m=nodes.size(); j<m; ++j) {
-            // Verify that the node is legal target before starting to grab
-            // random number. Helps worst case of having to start new random
-            // seed if the node that is out of order is illegal anyways.
-            const NodeState& nodeState(clusterState.getNodeState(Node(nodeType, nodes[j])));
-            if (!nodeState.getState().oneOf(upStates)) continue;
-            if (nodeState.isAnyDiskDown()) {
-                uint16_t idealDiskIndex(getIdealDisk(nodeState, nodes[j], bucket, IDEAL_DISK_EVEN_IF_DOWN));
-                if (nodeState.getDiskState(idealDiskIndex).getState() != State::UP) {
-                    continue;
-                }
-            }
-            // Get the score from the random number generator. Make sure we
-            // pick correct random number. Optimize for the case where we
-            // pick in rising order.
-            if (nodes[j] != randomIndex) {
-                if (nodes[j] < randomIndex) {
-                    random.setSeed(seed);
-                    randomIndex = 0;
-                }
-                for (uint32_t k=randomIndex, o=nodes[j]; k<o; ++k) {
-                    random.nextDouble();
-                }
-                randomIndex = nodes[j];
-            }
-            double score = random.nextDouble();
-            ++randomIndex;
-            if (nodeState.getCapacity() != vespalib::Double(1.0)) {
-                score = std::pow(score, 1.0 / nodeState.getCapacity().getValue());
-            }
-            if (score > tmpResults.back()._score) {
-                for (std::list<ScoredNode>::iterator it = tmpResults.begin();
-                     it != tmpResults.end(); ++it)
-                {
-                    if (score > it->_score) {
-                        tmpResults.insert(it, ScoredNode(nodes[j], nodeState.getReliability(), score));
-                        break;
-                    }
-                }
-                tmpResults.pop_back();
-            }
+        getNodeCandidates(nodeType, clusterState, _groupDistribution[i]._group->getNodes(),
+                          upStates, candidates);
+        selectIdealNodes(*this, candidates, bucket, seed, _groupDistribution[i]._redundancy,
+                         random, randomIndex, resultNodes);
+    }
+}
+
+void
+Distribution::getIdealNodes(const NodeType& nodeType,
+                            const ClusterState& clusterState,
+                            const std::vector<document::BucketId>& buckets,
+                            std::vector<std::vector<uint16_t>>& resultNodes,
+                            const char* upStates,
+                            uint16_t redundancy) const
+{
+    if (redundancy == DEFAULT_REDUNDANCY) redundancy = _redundancy;
+    resultNodes.clear();
+    resultNodes.resize(buckets.size());
+    if (redundancy == 0) return;
+
+    // The up state filtering of the nodes in a group is the same for every
+    // bucket, and the ideal groups of a bucket only depend on its
+    // superbucket, so both are shared between the buckets of the batch.
+    std::unordered_map<const Group*, std::vector<NodeCandidate>> candidatesPerGroup;
+    std::vector<ResultGroup> groupDistribution;
+    uint32_t groupSuperbucket = 0;
+    bool hasGroups = false;
+    const uint32_t superbucketMask(_distributionBitMasks[clusterState.getDistributionBitCount()]);
+    for (size_t i = 0; i < buckets.size(); ++i) {
+        const document::BucketId& bucket(buckets[i]);
+        verifyEnoughBucketBitsInUse(clusterState, bucket);
+        const uint32_t superbucket(static_cast<uint32_t>(bucket.getRawId()) & superbucketMask);
+        if (!hasGroups || (superbucket != groupSuperbucket)) {
+            groupDistribution.clear();
+            getIdealGroupsForNodeType(nodeType, clusterState, bucket, redundancy, groupDistribution);
+            groupSuperbucket = superbucket;
+            hasGroups = true;
         }
-        trimResult(tmpResults, groupRedundancy);
-        resultNodes.reserve(resultNodes.size() + tmpResults.size());
-        for (const auto & scored : tmpResults) {
-            resultNodes.push_back(scored._index);
+        uint32_t seed(nodeType == NodeType::STORAGE
+                      ? getStorageSeed(bucket, clusterState)
+                      : getDistributorSeed(bucket, clusterState));
+        RandomGen random(seed);
+        uint32_t randomIndex = 0;
+        for (const ResultGroup& group : groupDistribution) {
+            auto candidates = candidatesPerGroup.find(group._group);
+            if (candidates == candidatesPerGroup.end()) {
+                candidates = candidatesPerGroup.emplace(group._group, std::vector<NodeCandidate>()).first;
+                getNodeCandidates(nodeType, clusterState, group._group->getNodes(),
+                                  upStates, candidates->second);
+            }
+            selectIdealNodes(*this, candidates->second, bucket, seed, group._redundancy,
+                             random, randomIndex, resultNodes[i]);
         }
     }
 }
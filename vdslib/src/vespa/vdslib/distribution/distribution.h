@@ -43,6 +43,7 @@ private:
     bool _distributorAutoOwnershipTransferOnWholeGroupDown;
     DiskDistribution _diskDistribution;
     vespalib::string _serialized;
+    size_t _serializedHash;
 
     struct ResultGroup {
         const Group* _group;
@@ -96,6 +97,15 @@ private:
                                           const ClusterState& clusterState,
                                           const Group& parent) const;
 
+    void getIdealGroupsForNodeType(const NodeType& nodeType,
+                                   const ClusterState& clusterState,
+                                   const document::BucketId& bucket,
+                                   uint16_t redundancy,
+                                   std::vector<ResultGroup>& results) const;
+
+    void verifyEnoughBucketBitsInUse(const ClusterState& clusterState,
+                                     const document::BucketId& bucket) const;
+
     /**
      * Since distribution object may be used often in ideal state calculations
      * we'd like to avoid locking using it. Thus we don't support live config.
@@ -125,6 +135,8 @@ public:
     Distribution& operator=(const Distribution&);
 
     const vespalib::string& serialize() const { return _serialized; }
+    /** Hash of the serialized config, cheap to use in cache keys. */
+    size_t getSerializedHash() const { return _serializedHash; }
 
     const Group& getNodeGraph() const { return *_nodeGraph; }
     uint16_t getRedundancy() const { return _redundancy; }
@@ -176,6 +188,22 @@ public:
                        const char* upStates = "uim",
                        uint16_t redundancy = DEFAULT_REDUNDANCY) const;
 
+    /**
+     * Batched version of getIdealNodes(), putting the ideal nodes of
+     * buckets[i] in nodes[i]. Cheaper than calculating the buckets one by
+     * one, as node states are looked up once per batch, and ideal groups are
+     * reused between consecutive buckets in the same superbucket. Passing
+     * the buckets in bucket key order keeps buckets of the same superbucket
+     * adjacent.
+     *
+     * @throws Same as the single bucket version, if thrown for any bucket.
+     */
+    void getIdealNodes(const NodeType&, const ClusterState&,
+                       const std::vector<document::BucketId>& buckets,
+                       std::vector<std::vector<uint16_t>>& nodes,
+                       const char* upStates = "uim",
+                       uint16_t redundancy = DEFAULT_REDUNDANCY) const;
+
     /**
      * Unit tests can use this function to get raw config for this class to use
      * with a really simple setup with no hierarchical grouping. This function
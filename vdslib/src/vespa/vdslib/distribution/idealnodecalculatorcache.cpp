@@ -0,0 +1,150 @@
+// Copyright 2019 Oath Inc. Licensed under the terms of the Apache 2.0 license. See LICENSE in the project root.
+
+#include "idealnodecalculatorcache.h"
+#include "distribution.h"
+#include <vespa/vdslib/state/clusterstate.h>
+#include <vespa/vespalib/stllike/lrucache_map.hpp>
+#include <cassert>
+
+namespace storage::lib {
+
+namespace {
+
+// Up states are given as a string of state characters, and are matched as
+// a set (see State::oneOf()), so a bit per character identifies them.
+uint32_t
+upStatesMask(const char* upStates)
+{
+    uint32_t mask = 0;
+    for (const char* c = upStates; *c != '\0'; ++c) {
+        assert(*c >= 'a' && *c <= 'z');
+        mask |= (1u << (*c - 'a'));
+    }
+    return mask;
+}
+
+}
+
+IdealNodeCalculatorCache::Key::Key(const NodeType& nodeType, const Distribution& distribution,
+                                   const ClusterState& clusterState, const document::BucketId& bucket,
+                                   const char* upStates)
+    : _bucket(bucket.getId()),
+      _distributionHash(distribution.getSerializedHash()),
+      _clusterStateVersion(clusterState.getVersion()),
+      _upStates(upStatesMask(upStates)),
+      _nodeType(static_cast<uint16_t>(nodeType))
+{
+}
+
+IdealNodeCalculatorCache::IdealNodeCalculatorCache(uint32_t cacheSize, uint32_t numStripes)
+    : _stripeSize(std::max(1u, cacheSize / std::max(1u, numStripes))),
+      _stripes(),
+      _hitCount(0),
+      _missCount(0)
+{
+    for (uint32_t i = 0; i < std::max(1u, numStripes); ++i) {
+        _stripes.push_back(std::make_unique<Stripe>());
+        _stripes.back()->_cache = std::make_unique<Cache>(_stripeSize);
+    }
+}
+
+IdealNodeCalculatorCache::~IdealNodeCalculatorCache() = default;
+
+IdealNodeCalculatorCache::Stripe&
+IdealNodeCalculatorCache::getStripe(const Key& key) const
+{
+    // The low bits of a bucket id hold the superbucket, which is what
+    // distributes buckets evenly between the stripes.
+    return *_stripes[key._bucket % _stripes.size()];
+}
+
+bool
+IdealNodeCalculatorCache::lookup(const Key& key, std::vector<uint16_t>& nodes) const
+{
+    Stripe& stripe(getStripe(key));
+    std::lock_guard<std::mutex> guard(stripe._lock);
+    if (!stripe._cache->hasKey(key)) {
+        return false;
+    }
+    nodes = (*stripe._cache)[key];
+    return true;
+}
+
+void
+IdealNodeCalculatorCache::insert(const Key& key, const std::vector<uint16_t>& nodes) const
+{
+    Stripe& stripe(getStripe(key));
+    std::lock_guard<std::mutex> guard(stripe._lock);
+    stripe._cache->insert(key, nodes);
+}
+
+std::vector<uint16_t>
+IdealNodeCalculatorCache::getIdealNodes(const NodeType& nodeType, const Distribution& distribution,
+                                        const ClusterState& clusterState,
+                                        const document::BucketId& bucket,
+                                        const char* upStates) const
+{
+    Key key(nodeType, distribution, clusterState, bucket, upStates);
+    std::vector<uint16_t> nodes;
+    if (lookup(key, nodes)) {
+        _hitCount.fetch_add(1, std::memory_order_relaxed);
+        return nodes;
+    }
+    _missCount.fetch_add(1, std::memory_order_relaxed);
+    distribution.getIdealNodes(nodeType, clusterState, bucket, nodes, upStates);
+    insert(key, nodes);
+    return nodes;
+}
+
+void
+IdealNodeCalculatorCache::getIdealNodes(const NodeType& nodeType, const Distribution& distribution,
+                                        const ClusterState& clusterState,
+                                        const std::vector<document::BucketId>& buckets,
+                                        std::vector<std::vector<uint16_t>>& nodes,
+                                        const char* upStates) const
+{
+    nodes.clear();
+    nodes.resize(buckets.size());
+    std::vector<document::BucketId> missing;
+    std::vector<size_t> missingIndexes;
+    for (size_t i = 0; i < buckets.size(); ++i) {
+        if (!lookup(Key(nodeType, distribution, clusterState, buckets[i], upStates), nodes[i])) {
+            missing.push_back(buckets[i]);
+            missingIndexes.push_back(i);
+        }
+    }
+    _hitCount.fetch_add(buckets.size() - missing.size(), std::memory_order_relaxed);
+    if (missing.empty()) {
+        return;
+    }
+    _missCount.fetch_add(missing.size(), std::memory_order_relaxed);
+    std::vector<std::vector<uint16_t>> calculated;
+    distribution.getIdealNodes(nodeType, clusterState, missing, calculated, upStates);
+    for (size_t i = 0; i < missing.size(); ++i) {
+        insert(Key(nodeType, distribution, clusterState, missing[i], upStates), calculated[i]);
+        nodes[missingIndexes[i]] = std::move(calculated[i]);
+    }
+}
+
+bool
+IdealNodeCalculatorCache::contains(const NodeType& nodeType, const Distribution& distribution,
+                                   const ClusterState& clusterState,
+                                   const document::BucketId& bucket,
+                                   const char* upStates) const
+{
+    Key key(nodeType, distribution, clusterState, bucket, upStates);
+    Stripe& stripe(getStripe(key));
+    std::lock_guard<std::mutex> guard(stripe._lock);
+    return stripe._cache->hasKey(key);
+}
+
+void
+IdealNodeCalculatorCache::clear()
+{
+    for (auto& stripe : _stripes) {
+        std::lock_guard<std::mutex> guard(stripe->_lock);
+        stripe->_cache = std::make_unique<Cache>(_stripeSize);
+    }
+}
+
+}
@@ -0,0 +1,108 @@
+// Copyright 2019 Oath Inc. Licensed under the terms of the Apache 2.0 license. See LICENSE in the project root.
+/**
+ * A cache of ideal nodes, for users that repeatedly ask for the ideal nodes
+ * of the same buckets, like the distributor state checkers and bucket
+ * database updates do. Entries are keyed on the bucket, the cluster state
+ * version, a hash of the distribution config, the node type and the up
+ * states, such that entries calculated for another cluster state or
+ * distribution are never returned. Old entries are evicted as the least
+ * recently used.
+ *
+ * Thread safe. The cache is split in stripes with a lock each, and ideal
+ * nodes are calculated without holding any lock.
+ *
+ * Cluster states of the same version are assumed to be equal. Owners that
+ * may see different states with the same version (like unit tests) should
+ * clear the cache whenever they change the state.
+ */
+#pragma once
+
+#include <vespa/document/bucket/bucketid.h>
+#include <vespa/vespalib/stllike/lrucache_map.h>
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+namespace storage::lib {
+
+class ClusterState;
+class Distribution;
+class NodeType;
+
+class IdealNodeCalculatorCache {
+    struct Key {
+        uint64_t _bucket;
+        uint64_t _distributionHash;
+        uint32_t _clusterStateVersion;
+        uint32_t _upStates;
+        uint16_t _nodeType;
+
+        Key() : _bucket(0), _distributionHash(0), _clusterStateVersion(0), _upStates(0), _nodeType(0) {}
+        Key(const NodeType& nodeType, const Distribution& distribution,
+            const ClusterState& clusterState, const document::BucketId& bucket,
+            const char* upStates);
+
+        bool operator==(const Key& other) const {
+            return ((_bucket == other._bucket)
+                    && (_distributionHash == other._distributionHash)
+                    && (_clusterStateVersion == other._clusterStateVersion)
+                    && (_upStates == other._upStates)
+                    && (_nodeType == other._nodeType));
+        }
+    };
+    struct KeyHash {
+        size_t operator()(const Key& key) const {
+            return (key._bucket ^ key._distributionHash ^ (uint64_t(key._clusterStateVersion) << 32)
+                    ^ (uint64_t(key._upStates) << 2) ^ key._nodeType);
+        }
+    };
+    using Cache = vespalib::lrucache_map<vespalib::LruParam<Key, std::vector<uint16_t>, KeyHash>>;
+
+    struct Stripe {
+        std::mutex _lock;
+        std::unique_ptr<Cache> _cache;
+    };
+
+    uint32_t _stripeSize;
+    std::vector<std::unique_ptr<Stripe>> _stripes;
+    mutable std::atomic<uint64_t> _hitCount;
+    mutable std::atomic<uint64_t> _missCount;
+
+    Stripe& getStripe(const Key& key) const;
+    bool lookup(const Key& key, std::vector<uint16_t>& nodes) const;
+    void insert(const Key& key, const std::vector<uint16_t>& nodes) const;
+
+public:
+    explicit IdealNodeCalculatorCache(uint32_t cacheSize, uint32_t numStripes = 16);
+    ~IdealNodeCalculatorCache();
+
+    /**
+     * Same as Distribution::getIdealNodes(), and throws the same exceptions.
+     * Failed calculations are not cached.
+     */
+    std::vector<uint16_t> getIdealNodes(const NodeType&, const Distribution&,
+                                        const ClusterState&, const document::BucketId&,
+                                        const char* upStates = "uim") const;
+
+    /**
+     * Batched version of getIdealNodes(), putting the ideal nodes of
+     * buckets[i] in nodes[i]. Buckets that are not cached are calculated
+     * with the batched Distribution::getIdealNodes().
+     */
+    void getIdealNodes(const NodeType&, const Distribution&, const ClusterState&,
+                       const std::vector<document::BucketId>& buckets,
+                       std::vector<std::vector<uint16_t>>& nodes,
+                       const char* upStates = "uim") const;
+
+    /** Tells if the ideal nodes are cached, without counting a hit or miss. */
+    bool contains(const NodeType&, const Distribution&, const ClusterState&,
+                  const document::BucketId&, const char* upStates = "uim") const;
+
+    /** Drops all cached entries. */
+    void clear();
+
+    uint64_t getHitCount() const { return _hitCount.load(std::memory_order_relaxed); }
+    uint64_t getMissCount() const { return _missCount.load(std::memory_order_relaxed); }
+};
+
+}
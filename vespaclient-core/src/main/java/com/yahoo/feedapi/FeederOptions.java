@@ -24,6 +24,7 @@ public class FeederOptions {
     private int maxPendingBytes = 0;
     private int maxPendingDocs = 0;
     private double maxFeedRate = 0.0;
+    private boolean gradientThrottling = false;
     private String documentManagerConfigId = "client";
     private String idPrefix = "";
     private String route = "default";
@@ -54,6 +55,7 @@ public class FeederOptions {
         maxPendingBytes = src.maxPendingBytes;
         maxPendingDocs = src.maxPendingDocs;
         maxFeedRate = src.maxFeedRate;
+        gradientThrottling = src.gradientThrottling;
         documentManagerConfigId = src.documentManagerConfigId;
         idPrefix = src.idPrefix;
         route = src.route;
@@ -80,6 +82,7 @@ public class FeederOptions {
         setMessageBusPort(config.mbusport());
         setDocprocChain(config.docprocchain());
         setMaxFeedRate(config.maxfeedrate());
+        setGradientThrottling(config.gradientthrottling());
     }
 
     public void setMaxFeedRate(double feedRate) {
@@ -91,6 +94,14 @@ public class FeederOptions {
         return maxFeedRate;
     }
 
+    public boolean getGradientThrottling() {
+        return gradientThrottling;
+    }
+
+    public void setGradientThrottling(boolean gradientThrottling) {
+        this.gradientThrottling = gradientThrottling;
+    }
+
     public boolean getRetryEnabled() {
         return retryEnabled;
     }
@@ -234,6 +245,8 @@ public class FeederOptions {
         StaticThrottlePolicy policy;
         if (maxFeedRate > 0.0) {
             policy = new RateThrottlingPolicy(maxFeedRate);
+        } else if (gradientThrottling) {
+            policy = new GradientThrottlePolicy();
         } else if ((maxPendingDocs == 0) && (maxPendingBytes == 0)) {
             policy = new DynamicThrottlePolicy();
         } else {
@@ -275,6 +288,7 @@ public class FeederOptions {
                ", timeout=" + timeout +
                ", maxPendingBytes=" + maxPendingBytes +
                ", maxPendingDocs=" + maxPendingDocs +
+               ", gradientThrottling=" + gradientThrottling +
                ", documentManagerConfigId='" + documentManagerConfigId + '\'' +
                ", idPrefix='" + idPrefix + '\'' +
                ", route='" + route + '\'' +
@@ -300,6 +314,7 @@ public class FeederOptions {
         if (maxPendingBytes != that.maxPendingBytes) return false;
         if (maxPendingDocs != that.maxPendingDocs) return false;
         if (maxFeedRate != that.maxFeedRate) return false;
+        if (gradientThrottling != that.gradientThrottling) return false;
         if (mbusPort != that.mbusPort) return false;
         if (priorityExplicitlySet != that.priorityExplicitlySet) return false;
         if (Double.compare(that.retryDelay, retryDelay) != 0) return false;
@@ -337,6 +352,7 @@ public class FeederOptions {
         result = 31 * result + maxPendingBytes;
         result = 31 * result + maxPendingDocs;
         result = 31 * result + ((int)(maxFeedRate * 1000));
+        result = 31 * result + (gradientThrottling ? 1 : 0);
         result = 31 * result + (documentManagerConfigId != null ? documentManagerConfigId.hashCode() : 0);
         result = 31 * result + (idPrefix != null ? idPrefix.hashCode() : 0);
         result = 31 * result + (route != null ? route.hashCode() : 0);
@@ -11,9 +11,12 @@ import com.yahoo.documentapi.messagebus.protocol.PutDocumentMessage;
 import com.yahoo.documentapi.messagebus.protocol.RemoveDocumentMessage;
 import com.yahoo.documentapi.messagebus.protocol.UpdateDocumentMessage;
 import com.yahoo.jdisc.Metric;
+import com.yahoo.messagebus.GradientThrottlePolicy;
 import com.yahoo.messagebus.Message;
 import com.yahoo.messagebus.ReplyHandler;
 import com.yahoo.messagebus.SourceSession;
+import com.yahoo.messagebus.SourceSessionParams;
+import com.yahoo.messagebus.ThrottlePolicy;
 import com.yahoo.messagebus.network.rpc.RPCNetworkParams;
 
 import java.util.Collections;
@@ -28,6 +31,9 @@ public class MessageBusSessionFactory implements SessionFactory {
         String NUM_PUTS = "num_puts";
         String NUM_REMOVES = "num_removes";
         String NUM_UPDATES = "num_updates";
+        String THROTTLE_WINDOW_SIZE = "throttle_window_size";
+        String THROTTLE_RTT = "throttle_rtt";
+        String THROTTLE_MIN_RTT = "throttle_min_rtt";
     }
 
     @SuppressWarnings("unused") // used from extensions
@@ -57,9 +63,9 @@ public class MessageBusSessionFactory implements SessionFactory {
 
     @Override
     public synchronized SendSession createSendSession(ReplyHandler handler, Metric metric) {
-        return new SourceSessionWrapper(
-                access.getMessageBus().createSourceSession(handler, processor.getFeederOptions().toSourceSessionParams()),
-                metric);
+        SourceSessionParams params = processor.getFeederOptions().toSourceSessionParams();
+        return new SourceSessionWrapper(access.getMessageBus().createSourceSession(handler, params),
+                                        params.getThrottlePolicy(), metric);
     }
 
     public void shutDown() {
@@ -78,11 +84,13 @@ public class MessageBusSessionFactory implements SessionFactory {
     private class SourceSessionWrapper extends SendSession {
 
         private final SourceSession session;
+        private final ThrottlePolicy throttlePolicy;
         private final Metric metric;
         private final Metric.Context context;
 
-        private SourceSessionWrapper(SourceSession session, Metric metric) {
+        private SourceSessionWrapper(SourceSession session, ThrottlePolicy throttlePolicy, Metric metric) {
             this.session = session;
+            this.throttlePolicy = throttlePolicy;
             this.metric = metric;
             this.context = metric.createContext(Collections.<String, String>emptyMap());
         }
@@ -107,6 +115,13 @@ public class MessageBusSessionFactory implements SessionFactory {
             } else if (m instanceof UpdateDocumentMessage) {
                 metric.add(Metrics.NUM_UPDATES, 1, context);
             }
+            if (throttlePolicy instanceof GradientThrottlePolicy) {
+                // Read without the session lock; these are gauges, so a slightly stale value is fine.
+                GradientThrottlePolicy policy = (GradientThrottlePolicy)throttlePolicy;
+                metric.set(Metrics.THROTTLE_WINDOW_SIZE, policy.getWindowSize(), context);
+                metric.set(Metrics.THROTTLE_RTT, policy.getRtt(), context);
+                metric.set(Metrics.THROTTLE_MIN_RTT, policy.getMinRtt(), context);
+            }
         }
 
         @Override
@@ -1,6 +1,12 @@
 // Copyright 2017 Yahoo Holdings. Licensed under the terms of the Apache 2.0 license. See LICENSE in the project root.
 package com.yahoo.feedapi;
 
+import com.yahoo.messagebus.DynamicThrottlePolicy;
+import com.yahoo.messagebus.GradientThrottlePolicy;
+import com.yahoo.messagebus.RateThrottlingPolicy;
+import com.yahoo.messagebus.ThrottlePolicy;
+import com.yahoo.vespaclient.config.FeederConfig;
+
 import static org.junit.Assert.*;
 import org.junit.Test;
 
@@ -86,6 +92,27 @@ public class FeederOptionsTestCase {
         assertFalse(f2.equals(f1));
         assertFalse(f1.equals(f2));
         assertTrue(f1.hashCode() != f2.hashCode());
+
+        f2.setMaxFeedRate(0.0);
+        f2.setGradientThrottling(true);
+        assertFalse(f2.equals(f1));
+        assertFalse(f1.equals(f2));
+        assertTrue(f1.hashCode() != f2.hashCode());
+    }
+
+    @Test
+    public void testGradientThrottlingFromConfig() {
+        FeederOptions options = new FeederOptions(new FeederConfig(new FeederConfig.Builder()));
+        assertTrue(options.toSourceSessionParams().getThrottlePolicy() instanceof DynamicThrottlePolicy);
+
+        options = new FeederOptions(new FeederConfig(new FeederConfig.Builder().gradientthrottling(true).maxpendingdocs(50)));
+        assertTrue(options.getGradientThrottling());
+        ThrottlePolicy policy = options.toSourceSessionParams().getThrottlePolicy();
+        assertTrue(policy instanceof GradientThrottlePolicy);
+        assertEquals(50.0, ((GradientThrottlePolicy)policy).getMaxWindowSize(), 0.0);
+
+        options.setMaxFeedRate(10.0);
+        assertTrue(options.toSourceSessionParams().getThrottlePolicy() instanceof RateThrottlingPolicy);
     }
 
 }
@@ -11,7 +11,9 @@ public enum CompressionType {
     // Do not change the type->ordinal association. The gap is due to historic types no longer supported.
     NONE((byte) 0),
     INCOMPRESSIBLE((byte) 5),
-    LZ4((byte) 6);
+    LZ4((byte) 6),
+    /** A sequence of lz4 frames, in the frame format of the lz4 library */
+    FRAMED_LZ4((byte) 134);
 
     private byte code;
 
@@ -38,6 +40,8 @@ public enum CompressionType {
                 return INCOMPRESSIBLE;
             case ((byte) 6):
                 return LZ4;
+            case ((byte) 134):
+                return FRAMED_LZ4;
             default:
                 throw new IllegalArgumentException("Unknown compression type ordinal " + value);
         }
@@ -3,6 +3,12 @@ package com.yahoo.compress;
 
 import net.jpountz.lz4.LZ4Compressor;
 import net.jpountz.lz4.LZ4Factory;
+import net.jpountz.lz4.LZ4SafeDecompressor;
+import net.jpountz.xxhash.XXHash32;
+import net.jpountz.xxhash.XXHashFactory;
+
+import java.nio.ByteBuffer;
+import java.nio.ByteOrder;
 import java.util.Arrays;
 import java.util.Optional;
 
@@ -19,7 +25,14 @@ public class Compressor {
     private final double compressionThresholdFactor;
     private final int compressMinSizeBytes;
 
+    private static final int LZ4_FRAME_MAGIC = 0x184D2204;
+    private static final byte LZ4_FRAME_FLAGS = 0x60; // version 01, independent blocks
+    private static final byte LZ4_FRAME_BLOCK_DESCRIPTOR = 0x40; // blocks of at most 64 KB
+    private static final int LZ4_FRAME_BLOCK_SIZE = 64 * 1024;
+    private static final int LZ4_FRAME_UNCOMPRESSED_BLOCK = 0x80000000;
+
     private final LZ4Factory factory = LZ4Factory.fastestInstance();
+    private final XXHash32 xxHash = XXHashFactory.fastestInstance().hash32();
 
     /** Creates a compressor with default settings. */
     public Compressor() {
@@ -84,6 +97,10 @@ public class Compressor {
                 if (compressedData.length + 8 >= dataSize * compressionThresholdFactor)
                     return new Compression(CompressionType.INCOMPRESSIBLE, dataSize, data);
                 return new Compression(CompressionType.LZ4, dataSize, compressedData);
+            case FRAMED_LZ4:
+                // Always framed, as this is also how a client tells that it accepts framed data in return
+                int frameDataSize = uncompressedSize.isPresent() ? uncompressedSize.get() : data.length;
+                return new Compression(CompressionType.FRAMED_LZ4, frameDataSize, compressFramed(data, frameDataSize));
             default:
                 throw new IllegalArgumentException(requestedCompression + " is not supported");
         }
@@ -120,6 +137,9 @@ public class Compressor {
                 if (expectedCompressedSize.isPresent() && compressedSize != expectedCompressedSize.get())
                     throw new IllegalStateException("Compressed size mismatch. Expected " + compressedSize + ". Got " + expectedCompressedSize.get());
                 return uncompressedLZ4Data;
+            case FRAMED_LZ4:
+                int framedLength = expectedCompressedSize.isPresent() ? expectedCompressedSize.get() : compressedData.length - compressedDataOffset;
+                return decompressFramed(compressedData, compressedDataOffset, framedLength, expectedUncompressedSize);
             default:
                 throw new IllegalArgumentException(compression + " is not supported");
         }
@@ -133,6 +153,75 @@ public class Compressor {
         return decompress(compression.type(), compression.data(), 0, compression.uncompressedSize(), Optional.empty());
     }
 
+    /** Compresses data into a single lz4 frame of independently compressed blocks */
+    private byte[] compressFramed(byte[] data, int dataSize) {
+        LZ4Compressor compressor = level < 7 ? factory.fastCompressor() : factory.highCompressor();
+        int numBlocks = (dataSize + LZ4_FRAME_BLOCK_SIZE - 1) / LZ4_FRAME_BLOCK_SIZE;
+        ByteBuffer frame = ByteBuffer.allocate(7 + numBlocks * (4 + compressor.maxCompressedLength(LZ4_FRAME_BLOCK_SIZE)) + 4)
+                                     .order(ByteOrder.LITTLE_ENDIAN);
+        frame.putInt(LZ4_FRAME_MAGIC);
+        frame.put(LZ4_FRAME_FLAGS);
+        frame.put(LZ4_FRAME_BLOCK_DESCRIPTOR);
+        frame.put((byte) (xxHash.hash(frame.array(), 4, 2, 0) >> 8));
+        for (int offset = 0; offset < dataSize; offset += LZ4_FRAME_BLOCK_SIZE) {
+            int length = Math.min(LZ4_FRAME_BLOCK_SIZE, dataSize - offset);
+            int sizePosition = frame.position();
+            int blockPosition = sizePosition + 4;
+            int compressedLength = compressor.compress(data, offset, length, frame.array(), blockPosition, frame.capacity() - blockPosition);
+            if (compressedLength < length) {
+                frame.putInt(sizePosition, compressedLength);
+                frame.position(blockPosition + compressedLength);
+            } else {
+                frame.putInt(sizePosition, length | LZ4_FRAME_UNCOMPRESSED_BLOCK);
+                frame.position(blockPosition);
+                frame.put(data, offset, length);
+            }
+        }
+        frame.putInt(0); // end mark
+        return Arrays.copyOf(frame.array(), frame.position());
+    }
+
+    /** Decompresses a sequence of lz4 frames, as produced by this or the lz4 library */
+    private byte[] decompressFramed(byte[] compressedData, int offset, int length, int expectedUncompressedSize) {
+        ByteBuffer input = ByteBuffer.wrap(compressedData, offset, length).order(ByteOrder.LITTLE_ENDIAN);
+        byte[] output = new byte[expectedUncompressedSize];
+        int outputPosition = 0;
+        LZ4SafeDecompressor decompressor = factory.safeDecompressor();
+        while (input.hasRemaining()) {
+            if (input.getInt() != LZ4_FRAME_MAGIC)
+                throw new IllegalArgumentException("Data is not an lz4 frame");
+            int flags = input.get() & 0xff;
+            input.get(); // block descriptor, the block sizes are given by each block
+            if ((flags & 0xc0) != 0x40)
+                throw new IllegalArgumentException("Unsupported lz4 frame version " + (flags >> 6));
+            boolean independentBlocks = (flags & 0x20) != 0;
+            boolean blockChecksums = (flags & 0x10) != 0;
+            boolean contentSize = (flags & 0x08) != 0;
+            boolean contentChecksum = (flags & 0x04) != 0;
+            boolean dictionaryId = (flags & 0x01) != 0;
+            input.position(input.position() + (contentSize ? 8 : 0) + (dictionaryId ? 4 : 0) + 1); // + header checksum
+            int numBlocks = 0;
+            for (int blockSize = input.getInt(); blockSize != 0; blockSize = input.getInt()) {
+                if ( ! independentBlocks && numBlocks++ > 0)
+                    throw new IllegalArgumentException("Linked lz4 frame blocks are not supported");
+                int blockLength = blockSize & ~LZ4_FRAME_UNCOMPRESSED_BLOCK;
+                if ((blockSize & LZ4_FRAME_UNCOMPRESSED_BLOCK) != 0) {
+                    input.get(output, outputPosition, blockLength);
+                    outputPosition += blockLength;
+                } else {
+                    outputPosition += decompressor.decompress(compressedData, input.position(), blockLength,
+                                                              output, outputPosition, output.length - outputPosition);
+                    input.position(input.position() + blockLength);
+                }
+                if (blockChecksums) input.position(input.position() + 4);
+            }
+            if (contentChecksum) input.position(input.position() + 4);
+        }
+        if (outputPosition != expectedUncompressedSize)
+            throw new IllegalStateException("Uncompressed size mismatch. Expected " + expectedUncompressedSize + ". Got " + outputPosition);
+        return output;
+    }
+
     public static class Compression {
 
         private final CompressionType compressionType;
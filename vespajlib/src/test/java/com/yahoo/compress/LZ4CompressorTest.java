@@ -5,7 +5,9 @@ import org.junit.Test;
 
 import java.util.Arrays;
 import java.util.Optional;
+import java.util.Random;
 
+import static org.junit.Assert.assertArrayEquals;
 import static org.junit.Assert.assertEquals;
 import static org.junit.Assert.assertTrue;
 
@@ -22,4 +24,46 @@ public class LZ4CompressorTest {
         assertTrue(Arrays.equals(decompressed, Arrays.copyOf(toCompress, compressBytes)));
     }
 
+    @Test
+    public void framed_lz4_has_the_frame_header_of_the_lz4_library() {
+        // As produced by LZ4F_compressFrame with independent blocks
+        byte[] emptyFrame = { 4, 34, 77, 24, 96, 64, -126, 0, 0, 0, 0 };
+        Compressor.Compression compressed = new Compressor().compress(CompressionType.FRAMED_LZ4, new byte[0], Optional.empty());
+        assertEquals(CompressionType.FRAMED_LZ4, compressed.type());
+        assertArrayEquals(emptyFrame, compressed.data());
+    }
+
+    @Test
+    public void can_decompress_frames_from_the_lz4_library() {
+        // As produced by LZ4F_compressFrame with content size and content checksum
+        byte[] frame = { 4, 34, 77, 24, 108, 64, 60, 0, 0, 0, 0, 0, 0, 0, 56, 21, 0, 0, 0, -65, 102, 114, 97, 109,
+                         101, 100, 32, 108, 122, 52, 32, 11, 0, 25, 80, 49, 50, 51, 52, 53, 0, 0, 0, 0, -11, 91, 10, 51 };
+        String expected = "framed lz4 framed lz4 framed lz4 framed lz4 framed lz4 12345";
+        Compressor compressor = new Compressor();
+        byte[] decompressed = compressor.decompress(CompressionType.FRAMED_LZ4, frame, 0, expected.length(), Optional.empty());
+        assertEquals(expected, new String(decompressed));
+
+        byte[] twoFrames = Arrays.copyOf(frame, 2 * frame.length);
+        System.arraycopy(frame, 0, twoFrames, frame.length, frame.length);
+        decompressed = compressor.decompress(CompressionType.FRAMED_LZ4, twoFrames, 0, 2 * expected.length(), Optional.empty());
+        assertEquals(expected + expected, new String(decompressed));
+    }
+
+    @Test
+    public void can_compress_and_decompress_framed_lz4_spanning_several_blocks() {
+        byte[] toCompress = new byte[200 * 1024];
+        for (int i = 0; i < 100 * 1024; i++)
+            toCompress[i] = (byte) (i % 17);
+        byte[] random = new byte[100 * 1024];
+        new Random(7).nextBytes(random); // stored as uncompressed blocks
+        System.arraycopy(random, 0, toCompress, 100 * 1024, random.length);
+
+        Compressor compressor = new Compressor();
+        Compressor.Compression compressed = compressor.compress(CompressionType.FRAMED_LZ4, toCompress, Optional.empty());
+        assertEquals(CompressionType.FRAMED_LZ4, compressed.type());
+        assertEquals(toCompress.length, compressed.uncompressedSize());
+        assertTrue(compressed.data().length < toCompress.length);
+        assertArrayEquals(toCompress, compressor.decompress(compressed));
+    }
+
 }
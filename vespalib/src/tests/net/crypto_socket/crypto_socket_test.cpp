@@ -4,17 +4,24 @@
 #include <vespa/vespalib/net/crypto_engine.h>
 #include <vespa/vespalib/net/tls/tls_crypto_engine.h>
 #include <vespa/vespalib/net/tls/maybe_tls_crypto_engine.h>
+#include <vespa/vespalib/net/tls/crypto_codec_adapter.h>
 #include <vespa/vespalib/net/crypto_socket.h>
 #include <vespa/vespalib/net/selector.h>
 #include <vespa/vespalib/net/server_socket.h>
+#include <vespa/vespalib/net/shm_crypto_socket.h>
 #include <vespa/vespalib/net/socket_handle.h>
 #include <vespa/vespalib/net/socket_spec.h>
 #include <vespa/vespalib/net/socket_utils.h>
 #include <vespa/vespalib/data/smart_buffer.h>
+#include <vespa/vespalib/util/stringfmt.h>
 #include <vespa/vespalib/test/make_tls_options_for_testing.h>
 #include <sys/types.h>
 #include <sys/socket.h>
+#include <sys/mman.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
 #include <fcntl.h>
+#include <unistd.h>
 
 using namespace vespalib;
 
@@ -29,6 +36,49 @@ struct SocketPair {
     }
 };
 
+// kernel TLS is only available for TCP sockets
+struct TcpSocketPair {
+    SocketHandle client;
+    SocketHandle server;
+    TcpSocketPair() : client(), server() {
+        ServerSocket listener("tcp/localhost:0");
+        client = SocketSpec(listener.address().spec()).client_address().connect();
+        server = listener.accept();
+    }
+};
+
+// not a real crypto engine; wraps both ends in shared memory sockets
+struct ShmCryptoEngine : CryptoEngine {
+    size_t ring_size;
+    ShmCryptoEngine(size_t ring_size_in = ShmCryptoSocket::default_ring_size) : ring_size(ring_size_in) {}
+    CryptoSocket::UP create_crypto_socket(SocketHandle socket, bool is_server) override {
+        return is_server
+            ? ShmCryptoSocket::create_server(std::move(socket))
+            : ShmCryptoSocket::create_client(std::move(socket), ring_size);
+    }
+};
+
+#ifndef TCP_ULP
+#define TCP_ULP 31
+#endif
+
+// the kernel supports TLS offload if the tls ULP can be attached to a connected TCP socket
+bool kernel_has_tls() {
+    TcpSocketPair sockets;
+    return (setsockopt(sockets.client.get(), SOL_TCP, TCP_ULP, "tls", sizeof("tls")) == 0);
+}
+
+vespalib::net::tls::TransportSecurityOptions make_kernel_tls_options() {
+    using vespalib::net::tls::TransportSecurityOptions;
+    auto opts = vespalib::test::make_tls_options_for_testing();
+    return TransportSecurityOptions(TransportSecurityOptions::Params()
+                                    .ca_certs_pem(opts.ca_certs_pem())
+                                    .cert_chain_pem(opts.cert_chain_pem())
+                                    .private_key_pem(opts.private_key_pem())
+                                    .authorized_peers(opts.authorized_peers())
+                                    .kernel_tls_offload(true));
+}
+
 //-----------------------------------------------------------------------------
 
 bool is_blocked(int res) {
@@ -200,7 +250,8 @@ void verify_handshake(CryptoSocket &socket) {
 
 //-----------------------------------------------------------------------------
 
-void verify_crypto_socket(SocketPair &sockets, CryptoEngine &engine, bool is_server) {
+template <typename Sockets>
+void verify_crypto_socket(Sockets &sockets, CryptoEngine &engine, bool is_server) {
     SocketHandle &my_handle = is_server ? sockets.server : sockets.client;
     my_handle.set_blocking(false);
     SmartBuffer read_buffer(4096);
@@ -231,6 +282,107 @@ TEST_MT_FFF("require that encrypted async socket io works with TlsCryptoEngine",
     TEST_DO(verify_crypto_socket(f1, f2, (thread_id == 0)));
 }
 
+void verify_kernel_tls_socket(TcpSocketPair &sockets, CryptoEngine &engine, bool is_server) {
+    SocketHandle &my_handle = is_server ? sockets.server : sockets.client;
+    my_handle.set_blocking(false);
+    SmartBuffer read_buffer(4096);
+    CryptoSocket::UP my_socket = engine.create_crypto_socket(std::move(my_handle), is_server);
+    TEST_DO(verify_handshake(*my_socket));
+    drain(*my_socket, read_buffer);
+    TEST_DO(verify_socket_io(*my_socket, read_buffer, is_server));
+    auto *adapter = dynamic_cast<vespalib::net::tls::CryptoCodecAdapter *>(my_socket.get());
+    ASSERT_TRUE(adapter != nullptr);
+    EXPECT_TRUE(adapter->kernel_send());
+    char ulp[16] = {};
+    socklen_t len = sizeof(ulp);
+    ASSERT_EQUAL(0, getsockopt(my_socket->get_fd(), SOL_TCP, TCP_ULP, ulp, &len));
+    EXPECT_EQUAL(vespalib::string("tls"), vespalib::string(ulp));
+    TEST_DO(verify_graceful_shutdown(*my_socket, read_buffer, is_server));
+}
+
+TEST_MT_FFF("require that encrypted async socket io works with TlsCryptoEngine using kernel TLS offload",
+            2, TcpSocketPair(), TlsCryptoEngine(make_kernel_tls_options()), TimeBomb(60))
+{
+    if (!kernel_has_tls()) {
+        if (thread_id == 0) {
+            fprintf(stderr, "kernel lacks TLS offload support, skipping test\n");
+        }
+        return;
+    }
+    TEST_DO(verify_kernel_tls_socket(f1, f2, (thread_id == 0)));
+}
+
+TEST_MT_FFF("require that kernel TLS offload falls back to user space for non-TCP sockets",
+            2, SocketPair(), TlsCryptoEngine(make_kernel_tls_options()), TimeBomb(60))
+{
+    TEST_DO(verify_crypto_socket(f1, f2, (thread_id == 0)));
+}
+
+TEST_MT_FFF("require that async socket io works with shared memory sockets",
+            2, SocketPair(), ShmCryptoEngine(), TimeBomb(60))
+{
+    TEST_DO(verify_crypto_socket(f1, f2, (thread_id == 0)));
+}
+
+TEST_MT_FFF("require that shared memory sockets keep data in order when the ring buffer is full",
+            2, SocketPair(), ShmCryptoEngine(4096), TimeBomb(60))
+{
+    bool is_server = (thread_id == 0);
+    SocketHandle &my_handle = is_server ? f1.server : f1.client;
+    my_handle.set_blocking(false);
+    SmartBuffer read_buffer(4096);
+    CryptoSocket::UP my_socket = f2.create_crypto_socket(std::move(my_handle), is_server);
+    TEST_DO(verify_handshake(*my_socket));
+    vespalib::string message;
+    for (size_t i = 0; message.size() < 1024 * 1024; ++i) {
+        message.append(vespalib::make_string("message number %zu;", i));
+    }
+    if (is_server) {
+        EXPECT_EQUAL(message, read_bytes(*my_socket, read_buffer, message.size()));
+        TEST_DO(write_bytes(*my_socket, message));
+    } else {
+        TEST_DO(write_bytes(*my_socket, message));
+        EXPECT_EQUAL(message, read_bytes(*my_socket, read_buffer, message.size()));
+    }
+    TEST_DO(verify_graceful_shutdown(*my_socket, read_buffer, is_server));
+}
+
+TEST("require that shared memory sockets refuse memory that can be resized") {
+    SocketPair pair;
+    int fd = memfd_create("unsealed", MFD_CLOEXEC);
+    ASSERT_TRUE(fd >= 0);
+    ASSERT_EQUAL(0, ftruncate(fd, 1024 * 1024));
+    char hello[13] = {'H'};
+    uint32_t magic = 0x56534d31;
+    uint64_t ring_size = 4096;
+    memcpy(hello + 1, &magic, sizeof(magic));
+    memcpy(hello + 5, &ring_size, sizeof(ring_size));
+    struct iovec data = { hello, sizeof(hello) };
+    char buf[CMSG_SPACE(sizeof(int))] = {};
+    struct msghdr msg = {};
+    msg.msg_iov = &data;
+    msg.msg_iovlen = 1;
+    msg.msg_control = buf;
+    msg.msg_controllen = sizeof(buf);
+    struct cmsghdr *hdr = CMSG_FIRSTHDR(&msg);
+    hdr->cmsg_level = SOL_SOCKET;
+    hdr->cmsg_type = SCM_RIGHTS;
+    hdr->cmsg_len = CMSG_LEN(sizeof(int));
+    memcpy(CMSG_DATA(hdr), &fd, sizeof(int));
+    ASSERT_EQUAL(ssize_t(sizeof(hello)), sendmsg(pair.client.get(), &msg, MSG_NOSIGNAL));
+    close(fd);
+    CryptoSocket::UP server = ShmCryptoSocket::create_server(std::move(pair.server));
+    EXPECT_TRUE(server->handshake() == CryptoSocket::HandshakeResult::FAIL);
+}
+
+TEST("require that local connection peers are checked for running as the same user") {
+    SocketPair pair;
+    EXPECT_TRUE(ShmCryptoSocket::is_peer_same_user(pair.client.get()));
+    EXPECT_TRUE(ShmCryptoSocket::is_peer_same_user(pair.server.get()));
+    TcpSocketPair tcp_pair;
+    EXPECT_TRUE(!ShmCryptoSocket::is_peer_same_user(tcp_pair.client.get()));
+}
+
 TEST_MT_FFF("require that encrypted async socket io works with MaybeTlsCryptoEngine(true)",
             2, SocketPair(), MaybeTlsCryptoEngine(std::make_shared<TlsCryptoEngine>(vespalib::test::make_tls_options_for_testing()), true), TimeBomb(60))
 {
@@ -40,7 +40,9 @@ struct Fixture {
     Selector<Context> selector;
     std::vector<SocketPair> sockets;
     std::vector<Context> contexts;
-    Fixture(size_t size, bool read_enabled, bool write_enabled) : wakeup(false), selector(), sockets(), contexts() {
+    Fixture(size_t size, bool read_enabled, bool write_enabled, SelectorBackend backend = SelectorBackend::EPOLL)
+        : wakeup(false), selector(backend), sockets(), contexts()
+    {
         for (size_t i = 0; i < size; ++i) {
             sockets.push_back(SocketPair::create());
             contexts.push_back(Context(sockets.back().a.get()));
@@ -167,6 +169,33 @@ TEST_F("require that filling the output buffer disables write events", Fixture(1
     TEST_DO(f1.reset().poll().verify(false, {in}));
 }
 
+bool io_uring_supported = bool(IoUringPoll::create(16));
+
+TEST_F("require that io_uring backend reports level triggered events like epoll",
+       Fixture(2, true, true, SelectorBackend::IO_URING))
+{
+    EXPECT_EQUAL(io_uring_supported, f1.selector.uses_io_uring());
+    if (!f1.selector.uses_io_uring()) {
+        fprintf(stderr, "WARNING: skipping io_uring test since io_uring is not supported\n");
+        return;
+    }
+    TEST_DO(f1.reset().poll().verify(false, {out, out}));
+    EXPECT_TRUE(f1.write(0, "test"));
+    TEST_DO(f1.reset().poll().verify(false, {both, out}));
+    TEST_DO(f1.reset().poll().verify(false, {both, out}));
+    f1.update(0, true, false);
+    f1.update(1, false, false);
+    TEST_DO(f1.reset().poll().verify(false, {in, none}));
+    EXPECT_TRUE(f1.read(0, strlen("test")));
+    TEST_DO(f1.reset().poll(10).verify(false, {none, none}));
+    f1.update(1, true, true);
+    f1.selector.wakeup();
+    TEST_DO(f1.reset().poll().verify(true, {none, out}));
+    f1.selector.remove(f1.contexts[1].fd);
+    EXPECT_TRUE(f1.write(0, "test"));
+    TEST_DO(f1.reset().poll().verify(false, {in, none}));
+}
+
 TEST_MT_FF("require that selector can be woken while waiting for events", 2, Fixture(0, true, false), TimeBomb(60)) {
     if (thread_id == 0) {
         TEST_DO(f1.reset().poll().verify(true, {}));
@@ -71,6 +71,9 @@ vespalib::string get_meta(const SocketAddress &addr) {
     if (addr.is_wildcard()) {
         meta += " wildcard";
     }
+    if (addr.is_loopback()) {
+        meta += " loopback";
+    }
     if (addr.is_abstract()) {
         meta += " abstract";
     }
@@ -137,6 +140,22 @@ TEST("my local address") {
     }
 }
 
+TEST("localhost address") {
+    auto list = SocketAddress::resolve(4080, "localhost");
+    fprintf(stderr, "resolve(4080, 'localhost'):\n");
+    for (const auto &addr: list) {
+        EXPECT_TRUE(addr.is_loopback());
+        EXPECT_TRUE(!addr.is_wildcard());
+        EXPECT_TRUE(addr.is_ipv4() || addr.is_ipv6());
+        EXPECT_EQUAL(addr.port(), 4080);
+        fprintf(stderr, "  %s (%s)\n", addr.spec().c_str(), get_meta(addr).c_str());
+    }
+    EXPECT_TRUE(SocketSpec("tcp/127.0.0.2:4080").client_address().is_loopback());
+    EXPECT_TRUE(SocketSpec("tcp/[::ffff:127.0.0.1]:4080").client_address().is_loopback());
+    EXPECT_TRUE(!SocketSpec("tcp/4080").server_address().is_loopback());
+    EXPECT_TRUE(!SocketAddress::from_name("my_socket").is_loopback());
+}
+
 TEST("yahoo.com address") {
     auto list = SocketAddress::resolve(80, "yahoo.com");
     fprintf(stderr, "resolve(80, 'yahoo.com'):\n");
@@ -157,6 +176,7 @@ TEST("ipc address (path)") {
     EXPECT_TRUE(addr.is_ipc());
     EXPECT_TRUE(!addr.is_abstract());
     EXPECT_TRUE(!addr.is_wildcard());
+    EXPECT_TRUE(!addr.is_loopback());
     EXPECT_EQUAL(addr.port(), -1);
     EXPECT_EQUAL(vespalib::string("my_socket"), addr.path());
     EXPECT_TRUE(addr.name().empty());
@@ -171,6 +191,7 @@ TEST("ipc address (name)") {
     EXPECT_TRUE(addr.is_ipc());
     EXPECT_TRUE(addr.is_abstract());
     EXPECT_TRUE(!addr.is_wildcard());
+    EXPECT_TRUE(!addr.is_loopback());
     EXPECT_EQUAL(addr.port(), -1);
     EXPECT_TRUE(addr.path().empty());
     EXPECT_EQUAL(vespalib::string("my_socket"), addr.name());
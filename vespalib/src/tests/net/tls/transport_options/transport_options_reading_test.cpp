@@ -155,6 +155,23 @@ TEST("accepted cipher list is populated if specified") {
     EXPECT_EQUAL("bar", ciphers[1]);
 }
 
+TEST("kernel TLS offload is disabled if not specified") {
+    const char* json = R"({"files":{"private-key":"dummy_privkey.txt",
+                                    "certificates":"dummy_certs.txt",
+                                    "ca-certificates":"dummy_ca_certs.txt"}})";
+    EXPECT_FALSE(read_options_from_json_string(json)->kernel_tls_offload());
+}
+
+TEST("kernel TLS offload can be enabled and survives copying without private key") {
+    const char* json = R"({"files":{"private-key":"dummy_privkey.txt",
+                                    "certificates":"dummy_certs.txt",
+                                    "ca-certificates":"dummy_ca_certs.txt"},
+                           "kernel-tls-offload":true})";
+    auto opts = read_options_from_json_string(json);
+    EXPECT_TRUE(opts->kernel_tls_offload());
+    EXPECT_TRUE(opts->copy_without_private_key().kernel_tls_offload());
+}
+
 // TODO test parsing of multiple policies
 
 TEST_MAIN() { TEST_RUN_ALL(); }
@@ -3,25 +3,30 @@
 #include "lz4_output_encoder.h"
 #include <lz4frame.h>
 #include <cassert>
+#include <cstring>
 
 namespace vespalib {
 
 void
 Lz4OutputEncoder::encode_frame()
 {
-    auto dst = _output.reserve(LZ4F_compressFrameBound(_used, nullptr));
-    size_t written = LZ4F_compressFrame(dst.data, dst.size, &_buffer[0], _used, nullptr);
+    LZ4F_preferences_t prefs;
+    memset(&prefs, 0, sizeof(prefs));
+    prefs.compressionLevel = _level;
+    auto dst = _output.reserve(LZ4F_compressFrameBound(_used, &prefs));
+    size_t written = LZ4F_compressFrame(dst.data, dst.size, &_buffer[0], _used, &prefs);
     assert(!LZ4F_isError(written));
     assert(written <= dst.size);
     _output.commit(written);
     _used = 0;
 }
 
-Lz4OutputEncoder::Lz4OutputEncoder(Output &output, size_t buffer_size)
+Lz4OutputEncoder::Lz4OutputEncoder(Output &output, size_t buffer_size, int level)
     : _output(output),
       _buffer(buffer_size, 0),
       _used(0),
-      _limit(buffer_size)
+      _limit(buffer_size),
+      _level(level)
 {
 }
 
@@ -19,10 +19,13 @@ private:
     std::vector<char> _buffer;
     size_t            _used;
     size_t            _limit;
+    int               _level;
 
     void encode_frame();
 public:
-    Lz4OutputEncoder(Output &output, size_t buffer_size);
+    // the level is passed on as the compression level of each lz4 frame;
+    // 0 gives the default fast compression
+    Lz4OutputEncoder(Output &output, size_t buffer_size, int level = 0);
     ~Lz4OutputEncoder();
     WritableMemory reserve(size_t bytes) override;
     Output &commit(size_t bytes) override;
@@ -1,9 +1,27 @@
 // Copyright 2018 Yahoo Holdings. Licensed under the terms of the Apache 2.0 license. See LICENSE in the project root.
 
 #include "crypto_socket.h"
+#include <sys/uio.h>
 
 namespace vespalib {
 
+ssize_t
+CryptoSocket::writev(const struct iovec *iov, int iovcnt)
+{
+    ssize_t written = 0;
+    for (int i = 0; i < iovcnt; ++i) {
+        ssize_t res = write(static_cast<const char *>(iov[i].iov_base), iov[i].iov_len);
+        if (res <= 0) {
+            return (written > 0) ? written : res;
+        }
+        written += res;
+        if (size_t(res) < iov[i].iov_len) {
+            break;
+        }
+    }
+    return written;
+}
+
 CryptoSocket::~CryptoSocket() = default;
 
 } // namespace vespalib
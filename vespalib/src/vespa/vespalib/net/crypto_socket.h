@@ -3,6 +3,9 @@
 #pragma once
 
 #include <memory>
+#include <sys/types.h>
+
+struct iovec;
 
 namespace vespalib {
 
@@ -84,6 +87,19 @@ struct CryptoSocket {
      **/
     virtual ssize_t write(const char *buf, size_t len) = 0;
 
+    /**
+     * Called when the application has data located in several
+     * buffers that it wants to write as a single stream. The
+     * semantics are the same as for write, with the return value
+     * being the number of bytes consumed across all buffers. The
+     * default implementation writes the buffers one by one using
+     * write, which is the natural fallback for sockets that need to
+     * copy the data anyway (encryption). Sockets writing directly to
+     * the underlying socket should override this to perform a single
+     * gathering write.
+     **/
+    virtual ssize_t writev(const struct iovec *iov, int iovcnt);
+
     /**
      * Try to flush data in the write pipeline that is not dependent
      * on data not yet written by the application into the underlying
@@ -0,0 +1,351 @@
+// Copyright 2019 Oath Inc. Licensed under the terms of the Apache 2.0 license. See LICENSE in the project root.
+
+#include "io_uring_poll.h"
+#include <algorithm>
+#include <cassert>
+#include <cerrno>
+
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#ifdef IORING_FEAT_EXT_ARG
+#define VESPA_HAVE_IO_URING 1
+#endif
+#endif
+
+#ifdef VESPA_HAVE_IO_URING
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <cstring>
+#endif
+
+namespace vespalib {
+
+#ifdef VESPA_HAVE_IO_URING
+
+namespace {
+
+template <typename T>
+T load_acquire(const T *p) { return __atomic_load_n(p, __ATOMIC_ACQUIRE); }
+
+template <typename T>
+void store_release(T *p, T value) { __atomic_store_n(p, value, __ATOMIC_RELEASE); }
+
+uint32_t maybe(uint32_t value, bool yes) { return yes ? value : 0; }
+
+uint32_t poll_to_epoll(uint32_t events) {
+    return (maybe(EPOLLIN, (events & POLLIN) != 0) |
+            maybe(EPOLLOUT, (events & POLLOUT) != 0) |
+            maybe(EPOLLERR, (events & POLLERR) != 0) |
+            maybe(EPOLLHUP, (events & POLLHUP) != 0));
+}
+
+} // namespace vespalib::<unnamed>
+
+/**
+ * The memory mapped submission and completion queues of an io_uring
+ * instance.
+ **/
+struct IoUringPoll::Ring {
+    int           fd;
+    void         *sq_ptr;
+    size_t        sq_len;
+    void         *cq_ptr;
+    size_t        cq_len;
+    io_uring_sqe *sqes;
+    size_t        sqes_len;
+    unsigned     *sq_head;
+    unsigned     *sq_tail;
+    unsigned     *sq_array;
+    unsigned      sq_mask;
+    unsigned      sq_entries;
+    unsigned     *cq_head;
+    unsigned     *cq_tail;
+    io_uring_cqe *cqes;
+    unsigned      cq_mask;
+    unsigned      local_tail; // includes prepared entries not yet published
+    unsigned      pending;    // published entries not yet submitted
+
+    Ring() { memset(this, 0, sizeof(Ring)); fd = -1; }
+    ~Ring() {
+        if (sqes != nullptr) {
+            munmap(sqes, sqes_len);
+        }
+        if ((cq_ptr != nullptr) && (cq_ptr != sq_ptr)) {
+            munmap(cq_ptr, cq_len);
+        }
+        if (sq_ptr != nullptr) {
+            munmap(sq_ptr, sq_len);
+        }
+        if (fd != -1) {
+            close(fd);
+        }
+    }
+
+    bool init(uint32_t entries) {
+        io_uring_params params;
+        memset(&params, 0, sizeof(params));
+        fd = syscall(__NR_io_uring_setup, entries, &params);
+        if (fd < 0) {
+            fd = -1;
+            return false;
+        }
+        if (((params.features & IORING_FEAT_EXT_ARG) == 0) ||
+            ((params.features & IORING_FEAT_NODROP) == 0))
+        {
+            return false;
+        }
+        sq_len = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        cq_len = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        bool single_mmap = ((params.features & IORING_FEAT_SINGLE_MMAP) != 0);
+        if (single_mmap) {
+            sq_len = cq_len = std::max(sq_len, cq_len);
+        }
+        sq_ptr = mmap(nullptr, sq_len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+        if (sq_ptr == MAP_FAILED) {
+            sq_ptr = nullptr;
+            return false;
+        }
+        if (single_mmap) {
+            cq_ptr = sq_ptr;
+        } else {
+            cq_ptr = mmap(nullptr, cq_len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+            if (cq_ptr == MAP_FAILED) {
+                cq_ptr = nullptr;
+                return false;
+            }
+        }
+        sqes_len = params.sq_entries * sizeof(io_uring_sqe);
+        void *sqes_ptr = mmap(nullptr, sqes_len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+        if (sqes_ptr == MAP_FAILED) {
+            return false;
+        }
+        sqes = static_cast<io_uring_sqe *>(sqes_ptr);
+        char *sq = static_cast<char *>(sq_ptr);
+        char *cq = static_cast<char *>(cq_ptr);
+        sq_head = reinterpret_cast<unsigned *>(sq + params.sq_off.head);
+        sq_tail = reinterpret_cast<unsigned *>(sq + params.sq_off.tail);
+        sq_array = reinterpret_cast<unsigned *>(sq + params.sq_off.array);
+        sq_mask = *reinterpret_cast<unsigned *>(sq + params.sq_off.ring_mask);
+        sq_entries = *reinterpret_cast<unsigned *>(sq + params.sq_off.ring_entries);
+        cq_head = reinterpret_cast<unsigned *>(cq + params.cq_off.head);
+        cq_tail = reinterpret_cast<unsigned *>(cq + params.cq_off.tail);
+        cqes = reinterpret_cast<io_uring_cqe *>(cq + params.cq_off.cqes);
+        cq_mask = *reinterpret_cast<unsigned *>(cq + params.cq_off.ring_mask);
+        local_tail = *sq_tail;
+        return true;
+    }
+
+    int enter(unsigned min_complete, int timeout_ms) {
+        store_release(sq_tail, local_tail);
+        unsigned to_submit = pending;
+        unsigned flags = IORING_ENTER_EXT_ARG;
+        __kernel_timespec ts;
+        io_uring_getevents_arg arg;
+        memset(&arg, 0, sizeof(arg));
+        if (min_complete > 0) {
+            flags |= IORING_ENTER_GETEVENTS;
+            if (timeout_ms >= 0) {
+                ts.tv_sec = timeout_ms / 1000;
+                ts.tv_nsec = (timeout_ms % 1000) * 1000000L;
+                arg.ts = reinterpret_cast<uint64_t>(&ts);
+            }
+        }
+        int res = syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags, &arg, sizeof(arg));
+        if (res > 0) {
+            pending -= std::min(pending, unsigned(res));
+        }
+        return res;
+    }
+
+    io_uring_sqe *next_sqe() {
+        if ((local_tail - load_acquire(sq_head)) >= sq_entries) {
+            enter(0, 0);
+            assert((local_tail - load_acquire(sq_head)) < sq_entries);
+        }
+        unsigned idx = local_tail & sq_mask;
+        sq_array[idx] = idx;
+        ++local_tail;
+        ++pending;
+        io_uring_sqe *sqe = &sqes[idx];
+        memset(sqe, 0, sizeof(*sqe));
+        return sqe;
+    }
+
+    void poll_add(int poll_fd, uint32_t events, uint64_t token) {
+        io_uring_sqe *sqe = next_sqe();
+        sqe->opcode = IORING_OP_POLL_ADD;
+        sqe->fd = poll_fd;
+        sqe->poll32_events = events;
+        sqe->user_data = token;
+    }
+
+    void poll_remove(uint64_t token) {
+        io_uring_sqe *sqe = next_sqe();
+        sqe->opcode = IORING_OP_POLL_REMOVE;
+        sqe->fd = -1;
+        sqe->addr = token;
+        sqe->user_data = 0;
+    }
+};
+
+IoUringPoll::IoUringPoll(std::unique_ptr<Ring> ring)
+    : _ring(std::move(ring)),
+      _entries(),
+      _tokens(),
+      _dirty(),
+      _next_token(1)
+{
+}
+
+IoUringPoll::~IoUringPoll() = default;
+
+std::unique_ptr<IoUringPoll>
+IoUringPoll::create(uint32_t entries)
+{
+    auto ring = std::make_unique<Ring>();
+    if (!ring->init(entries)) {
+        return std::unique_ptr<IoUringPoll>();
+    }
+    return std::unique_ptr<IoUringPoll>(new IoUringPoll(std::move(ring)));
+}
+
+void
+IoUringPoll::mark_dirty(int fd, Entry &entry)
+{
+    if (!entry.dirty) {
+        entry.dirty = true;
+        _dirty.push_back(fd);
+    }
+}
+
+void
+IoUringPoll::arm_dirty()
+{
+    for (int fd: _dirty) {
+        auto pos = _entries.find(fd);
+        if (pos == _entries.end()) {
+            continue; // removed
+        }
+        Entry &entry = pos->second;
+        entry.dirty = false;
+        if ((entry.token != 0) && (entry.armed_events != entry.events)) {
+            _ring->poll_remove(entry.token);
+            _tokens.erase(entry.token);
+            entry.token = 0;
+        }
+        if (entry.token == 0) {
+            entry.token = _next_token++;
+            entry.armed_events = entry.events;
+            _tokens[entry.token] = fd;
+            _ring->poll_add(fd, entry.events, entry.token);
+        }
+    }
+    _dirty.clear();
+}
+
+void
+IoUringPoll::add(int fd, void *ctx, bool read, bool write)
+{
+    Entry &entry = _entries[fd];
+    entry.ctx = ctx;
+    entry.events = maybe(POLLIN, read) | maybe(POLLOUT, write);
+    entry.armed_events = 0;
+    entry.token = 0;
+    entry.dirty = false;
+    mark_dirty(fd, entry);
+}
+
+void
+IoUringPoll::update(int fd, void *ctx, bool read, bool write)
+{
+    auto pos = _entries.find(fd);
+    assert(pos != _entries.end());
+    Entry &entry = pos->second;
+    entry.ctx = ctx;
+    entry.events = maybe(POLLIN, read) | maybe(POLLOUT, write);
+    if (entry.events != entry.armed_events) {
+        mark_dirty(fd, entry);
+    }
+}
+
+void
+IoUringPoll::remove(int fd)
+{
+    auto pos = _entries.find(fd);
+    if (pos == _entries.end()) {
+        return;
+    }
+    if (pos->second.token != 0) {
+        _ring->poll_remove(pos->second.token);
+        _tokens.erase(pos->second.token);
+    }
+    _entries.erase(pos);
+    if (_ring->pending > 0) {
+        _ring->enter(0, 0);
+    }
+}
+
+size_t
+IoUringPoll::wait(epoll_event *events, size_t max_events, int timeout_ms)
+{
+    arm_dirty();
+    unsigned head = *_ring->cq_head;
+    if ((timeout_ms != 0) && (head == load_acquire(_ring->cq_tail))) {
+        _ring->enter(1, timeout_ms); // submit and wait with a single call
+    } else if (_ring->pending > 0) {
+        _ring->enter(0, 0);
+    }
+    size_t num_events = 0;
+    unsigned tail = load_acquire(_ring->cq_tail);
+    while ((head != tail) && (num_events < max_events)) {
+        const io_uring_cqe &cqe = _ring->cqes[head & _ring->cq_mask];
+        ++head;
+        auto token = _tokens.find(cqe.user_data);
+        if (token == _tokens.end()) {
+            continue; // removal, or poll request that was replaced
+        }
+        int fd = token->second;
+        _tokens.erase(token);
+        Entry &entry = _entries.find(fd)->second;
+        entry.token = 0;
+        mark_dirty(fd, entry); // re-arm on next wait
+        if (cqe.res < 0) {
+            continue;
+        }
+        epoll_event &evt = events[num_events++];
+        evt.events = poll_to_epoll(cqe.res);
+        evt.data.ptr = entry.ctx;
+    }
+    store_release(_ring->cq_head, head);
+    return num_events;
+}
+
+#else // VESPA_HAVE_IO_URING
+
+struct IoUringPoll::Ring {};
+
+IoUringPoll::IoUringPoll(std::unique_ptr<Ring> ring)
+    : _ring(std::move(ring)), _entries(), _tokens(), _dirty(), _next_token(1)
+{
+}
+
+IoUringPoll::~IoUringPoll() = default;
+
+std::unique_ptr<IoUringPoll>
+IoUringPoll::create(uint32_t)
+{
+    return std::unique_ptr<IoUringPoll>();
+}
+
+void IoUringPoll::mark_dirty(int, Entry &) {}
+void IoUringPoll::arm_dirty() {}
+void IoUringPoll::add(int, void *, bool, bool) {}
+void IoUringPoll::update(int, void *, bool, bool) {}
+void IoUringPoll::remove(int) {}
+size_t IoUringPoll::wait(epoll_event *, size_t, int) { return 0; }
+
+#endif // VESPA_HAVE_IO_URING
+
+}
@@ -0,0 +1,74 @@
+// Copyright 2019 Oath Inc. Licensed under the terms of the Apache 2.0 license. See LICENSE in the project root.
+
+#pragma once
+
+#ifdef __APPLE__
+#include "emulated_epoll.h"
+#else
+#include "native_epoll.h"
+#endif
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace vespalib {
+
+/**
+ * An alternative to the Epoll class built on io_uring. Interest in
+ * file descriptors is expressed as one-shot poll requests that are
+ * re-armed after each reported event, which gives the same
+ * level-triggered behavior as epoll. Adding sources, changing
+ * interest and re-arming are batched and submitted together with the
+ * wait for events, using a single system call per poll. Removal is
+ * submitted right away, since the kernel holds a reference to the
+ * polled file until the poll request is cancelled.
+ *
+ * The ring is only used for readiness polling. Reads and writes are
+ * still done by the caller with regular system calls once a file
+ * descriptor is reported ready, so the saving compared to epoll is
+ * limited to the system calls used to change interest.
+ *
+ * Unlike Epoll, this class is not thread-safe; all functions must be
+ * called by the thread waiting for events.
+ **/
+class IoUringPoll
+{
+private:
+    struct Ring;
+    struct Entry {
+        void     *ctx;
+        uint32_t  events;       // wanted poll events
+        uint32_t  armed_events; // events of the armed poll request
+        uint64_t  token;        // armed poll request, 0 if none
+        bool      dirty;        // needs to be (re-)armed
+    };
+
+    std::unique_ptr<Ring>                 _ring;
+    std::unordered_map<int, Entry>        _entries;
+    std::unordered_map<uint64_t, int>     _tokens;
+    std::vector<int>                      _dirty;
+    uint64_t                              _next_token;
+
+    IoUringPoll(std::unique_ptr<Ring> ring);
+    void mark_dirty(int fd, Entry &entry);
+    void arm_dirty();
+public:
+    IoUringPoll(const IoUringPoll &) = delete;
+    IoUringPoll &operator=(const IoUringPoll &) = delete;
+    ~IoUringPoll();
+
+    /**
+     * Create an io_uring based poller with the given number of
+     * submission queue entries. Returns an empty pointer if io_uring
+     * (with the features needed) is not supported by the kernel or
+     * the platform.
+     **/
+    static std::unique_ptr<IoUringPoll> create(uint32_t entries);
+
+    void add(int fd, void *ctx, bool read, bool write);
+    void update(int fd, void *ctx, bool read, bool write);
+    void remove(int fd);
+    size_t wait(epoll_event *events, size_t max_events, int timeout_ms);
+};
+
+}
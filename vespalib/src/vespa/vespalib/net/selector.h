@@ -8,6 +8,8 @@
 #else
 #include "native_epoll.h"
 #endif
+#include "io_uring_poll.h"
+#include <memory>
 #include <vector>
 
 namespace vespalib {
@@ -22,8 +24,9 @@ private:
     size_t                   _num_events;
 public:
     EpollEvents(size_t max_events) : _epoll_events(max_events), _num_events(0) {}
-    void extract(Epoll &epoll, int timeout_ms) {
-        _num_events = epoll.wait(&_epoll_events[0], _epoll_events.size(), timeout_ms);
+    template <typename Poller>
+    void extract(Poller &poller, int timeout_ms) {
+        _num_events = poller.wait(&_epoll_events[0], _epoll_events.size(), timeout_ms);
     }
     const epoll_event *begin() const { return &_epoll_events[0]; }
     const epoll_event *end() const { return &_epoll_events[_num_events]; }
@@ -32,27 +35,59 @@ public:
 
 //-----------------------------------------------------------------------------
 
+/**
+ * The kernel interface used by a Selector to wait for events. Both
+ * backends only report readiness; io is done by the caller either
+ * way. The io_uring backend falls back to epoll when not supported.
+ * Note that with io_uring, sources may only be added, updated and
+ * removed by the thread polling the selector.
+ **/
+enum class SelectorBackend { EPOLL, IO_URING };
+
 template <typename Context>
 class Selector
 {
 private:
-    Epoll       _epoll;
-    WakeupPipe  _wakeup_pipe;
-    EpollEvents _events;
+    Epoll                        _epoll;
+    std::unique_ptr<IoUringPoll> _uring;
+    WakeupPipe                   _wakeup_pipe;
+    EpollEvents                  _events;
 public:
-    Selector()
-        : _epoll(), _wakeup_pipe(), _events(4096)
+    Selector(SelectorBackend backend = SelectorBackend::EPOLL)
+        : _epoll(),
+          _uring((backend == SelectorBackend::IO_URING) ? IoUringPoll::create(4096) : std::unique_ptr<IoUringPoll>()),
+          _wakeup_pipe(),
+          _events(4096)
     {
-        _epoll.add(_wakeup_pipe.get_read_fd(), nullptr, true, false);    
+        add_fd(_wakeup_pipe.get_read_fd(), nullptr, true, false);
     }
     ~Selector() {
-        _epoll.remove(_wakeup_pipe.get_read_fd());
+        remove(_wakeup_pipe.get_read_fd());
+    }
+    bool uses_io_uring() const { return bool(_uring); }
+    void add(int fd, Context &ctx, bool read, bool write) { add_fd(fd, &ctx, read, write); }
+    void update(int fd, Context &ctx, bool read, bool write) {
+        if (_uring) {
+            _uring->update(fd, &ctx, read, write);
+        } else {
+            _epoll.update(fd, &ctx, read, write);
+        }
+    }
+    void remove(int fd) {
+        if (_uring) {
+            _uring->remove(fd);
+        } else {
+            _epoll.remove(fd);
+        }
     }
-    void add(int fd, Context &ctx, bool read, bool write) { _epoll.add(fd, &ctx, read, write); }
-    void update(int fd, Context &ctx, bool read, bool write) { _epoll.update(fd, &ctx, read, write); }
-    void remove(int fd) { _epoll.remove(fd); }
     void wakeup() { _wakeup_pipe.write_token(); }
-    void poll(int timeout_ms) { _events.extract(_epoll, timeout_ms); }
+    void poll(int timeout_ms) {
+        if (_uring) {
+            _events.extract(*_uring, timeout_ms);
+        } else {
+            _events.extract(_epoll, timeout_ms);
+        }
+    }
     size_t num_events() const { return _events.size(); }
     template <typename Handler>
     void dispatch(Handler &handler) {
@@ -68,6 +103,14 @@ public:
             }
         }
     }
+private:
+    void add_fd(int fd, void *ctx, bool read, bool write) {
+        if (_uring) {
+            _uring->add(fd, ctx, read, write);
+        } else {
+            _epoll.add(fd, ctx, read, write);
+        }
+    }
 };
 
 //-----------------------------------------------------------------------------
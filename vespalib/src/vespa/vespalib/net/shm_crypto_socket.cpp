@@ -0,0 +1,523 @@
+// Copyright 2019 Oath Inc. Licensed under the terms of the Apache 2.0 license. See LICENSE in the project root.
+
+#include "shm_crypto_socket.h"
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <vespa/log/log.h>
+LOG_SETUP(".vespalib.net.shm_crypto_socket");
+
+namespace vespalib {
+
+/**
+ * Shared state for one direction of the connection. 'head' and
+ * 'tail' count the total number of bytes written to and read from
+ * the ring. 'inline_done' counts the bytes passed inline on the
+ * socket that have been read; the writer does not use the ring again
+ * until all inline data has been read, which keeps the data in
+ * order. 'reader_waiting' is set by the reader before it waits for
+ * the socket to become readable, telling the writer to wake it up.
+ **/
+struct ShmCryptoSocket::Ring {
+    alignas(64) std::atomic<uint64_t> head;
+    alignas(64) std::atomic<uint64_t> tail;
+    alignas(64) std::atomic<uint64_t> inline_done;
+    alignas(64) std::atomic<uint32_t> reader_waiting;
+    Ring() : head(0), tail(0), inline_done(0), reader_waiting(1) {}
+};
+
+namespace {
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free);
+static_assert(std::atomic<uint32_t>::is_always_lock_free);
+
+constexpr char token_hello = 'H';
+constexpr char token_inline = 'd';
+constexpr char token_wakeup = 'w';
+constexpr uint32_t hello_magic = 0x56534d31;
+constexpr size_t min_ring_size = 4096;
+constexpr size_t max_ring_size = 1024 * 1024 * 1024;
+constexpr size_t max_inline_size = 1024 * 1024 * 1024;
+
+bool is_blocked(ssize_t res, int error) {
+    return ((res < 0) && ((error == EWOULDBLOCK) || (error == EAGAIN)));
+}
+
+#ifdef __linux__
+
+constexpr int required_seals = (F_SEAL_SHRINK | F_SEAL_GROW);
+
+int create_memory_fd() {
+    return memfd_create("vespa-shm-socket", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+}
+
+bool seal_memory_fd(int fd) {
+    return (fcntl(fd, F_ADD_SEALS, required_seals | F_SEAL_SEAL) == 0);
+}
+
+// memory that can not be resized can not be truncated under our feet after it is mapped
+bool is_memory_fd_sealed(int fd) {
+    int seals = fcntl(fd, F_GET_SEALS);
+    return ((seals >= 0) && ((seals & required_seals) == required_seals));
+}
+
+#else
+
+int create_memory_fd() {
+    errno = ENOTSUP;
+    return -1;
+}
+
+bool seal_memory_fd(int) { return false; }
+bool is_memory_fd_sealed(int) { return false; }
+
+#endif
+
+template <typename T>
+void encode(char *dst, T value) { memcpy(dst, &value, sizeof(value)); }
+
+template <typename T>
+T decode(const char *src) {
+    T value;
+    memcpy(&value, src, sizeof(value));
+    return value;
+}
+
+} // namespace vespalib::<unnamed>
+
+bool
+ShmCryptoSocket::is_supported()
+{
+#ifdef __linux__
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool
+ShmCryptoSocket::is_peer_same_user(int fd)
+{
+#ifdef __linux__
+    struct ucred cred;
+    socklen_t len = sizeof(cred);
+    if (getsockopt(fd, SOL_SOCKET, SO_PEERCRED, &cred, &len) != 0) {
+        return false;
+    }
+    return ((len == sizeof(cred)) && (cred.uid == geteuid()));
+#else
+    (void) fd;
+    return false;
+#endif
+}
+
+size_t
+ShmCryptoSocket::memory_size(size_t ring_size)
+{
+    return 2 * (sizeof(Ring) + ring_size);
+}
+
+ShmCryptoSocket::ShmCryptoSocket(SocketHandle socket, bool is_server, size_t ring_size)
+    : _socket(std::move(socket)),
+      _is_server(is_server),
+      _handshake_done(false),
+      _mem_fd(-1),
+      _mem(nullptr),
+      _mem_size(0),
+      _ring_size(ring_size),
+      _rx(nullptr),
+      _tx(nullptr),
+      _rx_data(nullptr),
+      _tx_data(nullptr),
+      _in_hdr(),
+      _in_hdr_used(0),
+      _in_inline(false),
+      _in_inline_pos(0),
+      _in_inline_left(0),
+      _in_eof(false),
+      _out_hdr(),
+      _out_hdr_used(0),
+      _out_hdr_sent(0),
+      _out_inline_left(0),
+      _out_inline_total(0)
+{
+}
+
+ShmCryptoSocket::~ShmCryptoSocket()
+{
+    if (_mem != nullptr) {
+        munmap(_mem, _mem_size);
+    }
+    if (_mem_fd >= 0) {
+        close(_mem_fd);
+    }
+}
+
+CryptoSocket::UP
+ShmCryptoSocket::create_client(SocketHandle socket, size_t ring_size)
+{
+    std::unique_ptr<ShmCryptoSocket> result(new ShmCryptoSocket(std::move(socket), false, ring_size));
+    int fd = create_memory_fd();
+    if (fd < 0) {
+        LOG(warning, "could not create shared memory for local connection: %s", strerror(errno));
+        return result;
+    }
+    result->_mem_fd = fd;
+    if (ftruncate(fd, memory_size(ring_size)) != 0) {
+        LOG(warning, "could not size shared memory for local connection: %s", strerror(errno));
+        return result;
+    }
+    if (!seal_memory_fd(fd)) {
+        LOG(warning, "could not seal shared memory for local connection: %s", strerror(errno));
+        return result;
+    }
+    if (result->map(fd, ring_size)) {
+        new (result->_tx) Ring();
+        new (result->_rx) Ring();
+    }
+    return result;
+}
+
+CryptoSocket::UP
+ShmCryptoSocket::create_server(SocketHandle socket)
+{
+    return CryptoSocket::UP(new ShmCryptoSocket(std::move(socket), true, 0));
+}
+
+bool
+ShmCryptoSocket::map(int fd, size_t ring_size)
+{
+    size_t size = memory_size(ring_size);
+    void *mem = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (mem == MAP_FAILED) {
+        LOG(warning, "could not map shared memory for local connection: %s", strerror(errno));
+        return false;
+    }
+    _mem = mem;
+    _mem_size = size;
+    _ring_size = ring_size;
+    Ring *rings = static_cast<Ring *>(mem);
+    char *data = reinterpret_cast<char *>(rings + 2);
+    // the client writes to the first ring, the server to the second
+    _tx = _is_server ? &rings[1] : &rings[0];
+    _rx = _is_server ? &rings[0] : &rings[1];
+    _tx_data = _is_server ? (data + ring_size) : data;
+    _rx_data = _is_server ? data : (data + ring_size);
+    return true;
+}
+
+CryptoSocket::HandshakeResult
+ShmCryptoSocket::send_memory()
+{
+    if (_mem == nullptr) {
+        return HandshakeResult::FAIL;
+    }
+    if (!is_peer_same_user(_socket.get())) {
+        LOG(warning, "local connection peer is owned by another user; not sharing memory with it");
+        return HandshakeResult::FAIL;
+    }
+    char hello[header_size];
+    hello[0] = token_hello;
+    encode<uint32_t>(hello + 1, hello_magic);
+    encode<uint64_t>(hello + 5, _ring_size);
+    struct iovec data;
+    data.iov_base = hello;
+    data.iov_len = sizeof(hello);
+    char buf[CMSG_SPACE(sizeof(int))];
+    memset(buf, 0, sizeof(buf));
+    struct msghdr msg = {};
+    msg.msg_iov = &data;
+    msg.msg_iovlen = 1;
+    msg.msg_control = buf;
+    msg.msg_controllen = sizeof(buf);
+    struct cmsghdr *hdr = CMSG_FIRSTHDR(&msg);
+    hdr->cmsg_level = SOL_SOCKET;
+    hdr->cmsg_type = SCM_RIGHTS;
+    hdr->cmsg_len = CMSG_LEN(sizeof(int));
+    memcpy(CMSG_DATA(hdr), &_mem_fd, sizeof(int));
+    ssize_t res = sendmsg(_socket.get(), &msg, MSG_NOSIGNAL);
+    if (is_blocked(res, errno)) {
+        return HandshakeResult::NEED_WRITE;
+    }
+    if (res != ssize_t(sizeof(hello))) {
+        return HandshakeResult::FAIL;
+    }
+    close(_mem_fd);
+    _mem_fd = -1;
+    return HandshakeResult::DONE;
+}
+
+CryptoSocket::HandshakeResult
+ShmCryptoSocket::receive_memory()
+{
+    if (!is_peer_same_user(_socket.get())) {
+        LOG(warning, "local connection peer is owned by another user; rejecting it");
+        return HandshakeResult::FAIL;
+    }
+    char hello[header_size];
+    struct iovec data;
+    data.iov_base = hello;
+    data.iov_len = sizeof(hello);
+    char buf[CMSG_SPACE(sizeof(int))];
+    memset(buf, 0, sizeof(buf));
+    struct msghdr msg = {};
+    msg.msg_iov = &data;
+    msg.msg_iovlen = 1;
+    msg.msg_control = buf;
+    msg.msg_controllen = sizeof(buf);
+#ifdef MSG_CMSG_CLOEXEC
+    ssize_t res = recvmsg(_socket.get(), &msg, MSG_CMSG_CLOEXEC);
+#else
+    ssize_t res = recvmsg(_socket.get(), &msg, 0);
+#endif
+    if (is_blocked(res, errno)) {
+        return HandshakeResult::NEED_READ;
+    }
+    struct cmsghdr *hdr = (res > 0) ? CMSG_FIRSTHDR(&msg) : nullptr;
+    if ((hdr != nullptr) && (hdr->cmsg_level == SOL_SOCKET) && (hdr->cmsg_type == SCM_RIGHTS) &&
+        (hdr->cmsg_len == CMSG_LEN(sizeof(int))))
+    {
+        memcpy(&_mem_fd, CMSG_DATA(hdr), sizeof(int));
+    }
+    if ((res != ssize_t(sizeof(hello))) || (_mem_fd < 0) || ((msg.msg_flags & MSG_CTRUNC) != 0) ||
+        (hello[0] != token_hello) || (decode<uint32_t>(hello + 1) != hello_magic))
+    {
+        LOG(debug, "invalid handshake on local connection");
+        return HandshakeResult::FAIL;
+    }
+    uint64_t ring_size = decode<uint64_t>(hello + 5);
+    struct stat st;
+    if ((ring_size < min_ring_size) || (ring_size > max_ring_size) ||
+        !is_memory_fd_sealed(_mem_fd) || (fstat(_mem_fd, &st) != 0) ||
+        (size_t(st.st_size) < memory_size(ring_size)))
+    {
+        LOG(debug, "invalid shared memory received on local connection");
+        return HandshakeResult::FAIL;
+    }
+    if (!map(_mem_fd, ring_size)) {
+        return HandshakeResult::FAIL;
+    }
+    close(_mem_fd);
+    _mem_fd = -1;
+    return HandshakeResult::DONE;
+}
+
+CryptoSocket::HandshakeResult
+ShmCryptoSocket::handshake()
+{
+    if (_handshake_done) {
+        return HandshakeResult::DONE;
+    }
+    HandshakeResult res = _is_server ? receive_memory() : send_memory();
+    _handshake_done = (res == HandshakeResult::DONE);
+    return res;
+}
+
+uint64_t
+ShmCryptoSocket::readable_limit() const
+{
+    return _in_inline ? _in_inline_pos : _rx->head.load(std::memory_order_acquire);
+}
+
+size_t
+ShmCryptoSocket::copy_from_ring(char *buf, size_t len, uint64_t limit)
+{
+    uint64_t tail = _rx->tail.load(std::memory_order_relaxed);
+    size_t n = std::min(len, size_t(limit - tail));
+    size_t offset = (tail % _ring_size);
+    size_t first = std::min(n, _ring_size - offset);
+    memcpy(buf, _rx_data + offset, first);
+    memcpy(buf + first, _rx_data, n - first);
+    _rx->tail.store(tail + n, std::memory_order_release);
+    return n;
+}
+
+bool
+ShmCryptoSocket::wait_for_data()
+{
+    // pairs with the head update and wakeup check in write
+    _rx->reader_waiting.store(1);
+    if (_rx->head.load() != _rx->tail.load(std::memory_order_relaxed)) {
+        _rx->reader_waiting.store(0, std::memory_order_relaxed);
+        return false;
+    }
+    return true;
+}
+
+ssize_t
+ShmCryptoSocket::read_header()
+{
+    if (_in_hdr_used == 0) {
+        ssize_t res = _socket.read(_in_hdr, 1);
+        if (res <= 0) {
+            return res;
+        }
+        _in_hdr_used = 1;
+    }
+    if (_in_hdr[0] == token_wakeup) {
+        _in_hdr_used = 0;
+        return 1;
+    }
+    if (_in_hdr[0] != token_inline) {
+        errno = EIO;
+        return -1;
+    }
+    while (_in_hdr_used < header_size) {
+        ssize_t res = _socket.read(_in_hdr + _in_hdr_used, header_size - _in_hdr_used);
+        if (res <= 0) {
+            if (res == 0) {
+                errno = EIO;
+                return -1;
+            }
+            return res;
+        }
+        _in_hdr_used += res;
+    }
+    _in_hdr_used = 0;
+    uint64_t pos = decode<uint64_t>(_in_hdr + 1);
+    uint32_t len = decode<uint32_t>(_in_hdr + 9);
+    if ((pos < _rx->tail.load(std::memory_order_relaxed)) || (pos > _rx->head.load(std::memory_order_acquire))) {
+        errno = EIO;
+        return -1;
+    }
+    if (len > 0) {
+        _in_inline = true;
+        _in_inline_pos = pos;
+        _in_inline_left = len;
+    }
+    return 1;
+}
+
+ssize_t
+ShmCryptoSocket::read(char *buf, size_t len)
+{
+    for (;;) {
+        uint64_t limit = readable_limit();
+        if (limit != _rx->tail.load(std::memory_order_relaxed)) {
+            return copy_from_ring(buf, len, limit);
+        }
+        if (_in_inline) {
+            ssize_t res = _socket.read(buf, std::min(len, _in_inline_left));
+            if (res > 0) {
+                _in_inline_left -= res;
+                _in_inline = (_in_inline_left > 0);
+                _rx->inline_done.fetch_add(res, std::memory_order_release);
+            } else if (res == 0) {
+                errno = EIO;
+                res = -1;
+            }
+            return res;
+        }
+        if (_in_eof) {
+            return 0;
+        }
+        ssize_t res = read_header();
+        if (res == 0) {
+            _in_eof = true; // data written before EOF may still be in the ring
+        } else if (res < 0) {
+            int error = errno;
+            if (!is_blocked(res, error) || wait_for_data()) {
+                errno = error;
+                return res;
+            }
+        }
+    }
+}
+
+ssize_t
+ShmCryptoSocket::drain(char *buf, size_t len)
+{
+    uint64_t limit = readable_limit();
+    if (limit != _rx->tail.load(std::memory_order_relaxed)) {
+        return copy_from_ring(buf, len, limit);
+    }
+    if (!_in_inline && !_in_eof && !wait_for_data()) {
+        return copy_from_ring(buf, len, readable_limit());
+    }
+    return 0;
+}
+
+ssize_t
+ShmCryptoSocket::flush_header()
+{
+    while (_out_hdr_sent < _out_hdr_used) {
+        ssize_t res = _socket.write(_out_hdr + _out_hdr_sent, _out_hdr_used - _out_hdr_sent);
+        if (res <= 0) {
+            return -1;
+        }
+        _out_hdr_sent += res;
+    }
+    _out_hdr_used = 0;
+    _out_hdr_sent = 0;
+    return 0;
+}
+
+ssize_t
+ShmCryptoSocket::write(const char *buf, size_t len)
+{
+    if (flush_header() < 0) {
+        return -1;
+    }
+    if (_out_inline_left == 0) {
+        uint64_t head = _tx->head.load(std::memory_order_relaxed);
+        size_t space = _ring_size - size_t(head - _tx->tail.load(std::memory_order_acquire));
+        if (_tx->inline_done.load(std::memory_order_acquire) != _out_inline_total) {
+            space = 0;
+        }
+        if (space > 0) {
+            size_t n = std::min(len, space);
+            size_t offset = (head % _ring_size);
+            size_t first = std::min(n, _ring_size - offset);
+            memcpy(_tx_data + offset, buf, first);
+            memcpy(_tx_data, buf + first, n - first);
+            _tx->head.store(head + n);
+            if (_tx->reader_waiting.exchange(0) != 0) {
+                // a full socket buffer already wakes up the reader
+                char token = token_wakeup;
+                (void) _socket.write(&token, 1);
+            }
+            return n;
+        }
+        // ring is full (or inline data is still unread); pass the data inline on the socket
+        _out_inline_left = std::min(len, max_inline_size);
+        _out_inline_total += _out_inline_left;
+        _out_hdr[0] = token_inline;
+        encode<uint64_t>(_out_hdr + 1, head);
+        encode<uint32_t>(_out_hdr + 9, _out_inline_left);
+        _out_hdr_used = header_size;
+        if (flush_header() < 0) {
+            return -1;
+        }
+    }
+    ssize_t res = _socket.write(buf, std::min(len, _out_inline_left));
+    if (res > 0) {
+        _out_inline_left -= res;
+    }
+    return res;
+}
+
+ssize_t
+ShmCryptoSocket::flush()
+{
+    if (_out_hdr_used == 0) {
+        return 0;
+    }
+    return (flush_header() < 0) ? -1 : 1;
+}
+
+ssize_t
+ShmCryptoSocket::half_close()
+{
+    if (flush_header() < 0) {
+        return -1;
+    }
+    return _socket.half_close();
+}
+
+} // namespace vespalib
@@ -0,0 +1,107 @@
+// Copyright 2019 Oath Inc. Licensed under the terms of the Apache 2.0 license. See LICENSE in the project root.
+
+#pragma once
+
+#include "crypto_socket.h"
+#include "socket_handle.h"
+
+namespace vespalib {
+
+/**
+ * A CryptoSocket for connections between processes on the same host
+ * that moves application data through a pair of ring buffers in
+ * shared memory instead of through the kernel socket buffers. The
+ * underlying socket must be a unix domain socket; it is used to pass
+ * the shared memory to the server end during the handshake, to wake
+ * up a reader that is waiting for data and to signal EOF. When the
+ * outgoing ring buffer is full, data is written inline on the socket
+ * instead, which also gives normal flow control when the reader falls
+ * behind. No encryption is performed.
+ *
+ * Both ends verify that the peer process runs as the same user
+ * before any memory is shared. The shared memory is sealed against
+ * resizing before it is passed to the server, and the server refuses
+ * memory that is not sealed, so that the client can not truncate it
+ * after it has been mapped. Only supported on Linux.
+ **/
+class ShmCryptoSocket : public CryptoSocket
+{
+public:
+    static constexpr size_t default_ring_size = 1024 * 1024;
+
+    /**
+     * Whether shared memory sockets can be used on this platform.
+     **/
+    static bool is_supported();
+
+    /**
+     * Whether the process at the other end of the given unix domain
+     * socket runs as the same user as this process.
+     **/
+    static bool is_peer_same_user(int fd);
+
+    /**
+     * Wrap the client end of a unix domain socket. The client
+     * creates the shared memory used by both directions.
+     **/
+    static CryptoSocket::UP create_client(SocketHandle socket, size_t ring_size = default_ring_size);
+
+    /**
+     * Wrap the server end of a unix domain socket. The shared memory
+     * is received from the client during the handshake.
+     **/
+    static CryptoSocket::UP create_server(SocketHandle socket);
+
+    ~ShmCryptoSocket() override;
+    int get_fd() const override { return _socket.get(); }
+    HandshakeResult handshake() override;
+    void do_handshake_work() override {}
+    size_t min_read_buffer_size() const override { return 1; }
+    ssize_t read(char *buf, size_t len) override;
+    ssize_t drain(char *buf, size_t len) override;
+    ssize_t write(const char *buf, size_t len) override;
+    ssize_t flush() override;
+    ssize_t half_close() override;
+
+private:
+    struct Ring;
+    static constexpr size_t header_size = 13;
+
+    SocketHandle _socket;
+    bool         _is_server;
+    bool         _handshake_done;
+    int          _mem_fd;
+    void        *_mem;
+    size_t       _mem_size;
+    size_t       _ring_size;
+    Ring        *_rx;
+    Ring        *_tx;
+    char        *_rx_data;
+    char        *_tx_data;
+    // input state
+    char         _in_hdr[header_size];
+    size_t       _in_hdr_used;
+    bool         _in_inline;
+    uint64_t     _in_inline_pos;
+    size_t       _in_inline_left;
+    bool         _in_eof;
+    // output state
+    char         _out_hdr[header_size];
+    size_t       _out_hdr_used;
+    size_t       _out_hdr_sent;
+    size_t       _out_inline_left;
+    uint64_t     _out_inline_total;
+
+    ShmCryptoSocket(SocketHandle socket, bool is_server, size_t ring_size);
+    static size_t memory_size(size_t ring_size);
+    bool map(int fd, size_t ring_size);
+    HandshakeResult send_memory();
+    HandshakeResult receive_memory();
+    uint64_t readable_limit() const;
+    size_t copy_from_ring(char *buf, size_t len, uint64_t limit);
+    bool wait_for_data();
+    ssize_t read_header();
+    ssize_t flush_header();
+};
+
+} // namespace vespalib
@@ -41,6 +41,21 @@ SocketAddress::is_wildcard() const
     return false;
 }
 
+bool
+SocketAddress::is_loopback() const
+{
+    if (is_ipv4()) {
+        return ((ntohl(addr_in()->sin_addr.s_addr) >> 24) == IN_LOOPBACKNET);
+    }
+    if (is_ipv6()) {
+        if (IN6_IS_ADDR_V4MAPPED(&addr_in6()->sin6_addr)) {
+            return (addr_in6()->sin6_addr.s6_addr[12] == IN_LOOPBACKNET);
+        }
+        return IN6_IS_ADDR_LOOPBACK(&addr_in6()->sin6_addr);
+    }
+    return false;
+}
+
 bool
 SocketAddress::is_abstract() const
 {
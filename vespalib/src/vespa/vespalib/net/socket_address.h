@@ -40,6 +40,7 @@ public:
     bool is_ipv6() const { return (valid() && (_addr.ss_family == AF_INET6)); }
     bool is_ipc() const { return (valid() && (_addr.ss_family == AF_UNIX)); }
     bool is_wildcard() const;
+    bool is_loopback() const;
     bool is_abstract() const;
     int port() const;
     vespalib::string ip_address() const;
@@ -2,10 +2,16 @@
 #include "crypto_codec.h"
 #include <vespa/vespalib/net/tls/impl/openssl_crypto_codec_impl.h>
 #include <vespa/vespalib/net/tls/impl/openssl_tls_context_impl.h>
+#include <vespa/vespalib/net/tls/transport_security_options.h>
 #include <cassert>
 
 namespace vespalib::net::tls {
 
+TrafficKeys::~TrafficKeys() {
+    secure_memzero(key, sizeof(key));
+    secure_memzero(iv, sizeof(iv));
+}
+
 std::unique_ptr<CryptoCodec> CryptoCodec::create_default_codec(std::shared_ptr<TlsContext> ctx, Mode mode) {
     auto ctx_impl = std::dynamic_pointer_cast<impl::OpenSslTlsContextImpl>(ctx); // only takes by const ref
     assert(ctx_impl);
@@ -2,6 +2,7 @@
 #pragma once
 
 #include <memory>
+#include <cstdint>
 
 namespace vespalib::net::tls {
 
@@ -49,6 +50,30 @@ struct DecodeResult {
     bool frame_decoded_ok() const noexcept { return (state == State::OK); }
 };
 
+/*
+ * Symmetric key material for one direction of an established session,
+ * as needed to move its record protection out of the codec (e.g. into
+ * the kernel). The sequence number is that of the next record to be
+ * protected with these keys.
+ */
+struct TrafficKeys {
+    enum class Cipher {
+        Aes128Gcm,
+        Aes256Gcm,
+        ChaCha20Poly1305
+    };
+    Cipher   cipher = Cipher::Aes128Gcm;
+    uint8_t  key[32] = {};
+    size_t   key_size = 0;
+    uint8_t  iv[12] = {};
+    uint64_t sequence_number = 0;
+
+    TrafficKeys() noexcept = default;
+    TrafficKeys(const TrafficKeys&) = delete;
+    TrafficKeys& operator=(const TrafficKeys&) = delete;
+    ~TrafficKeys();
+};
+
 struct TlsContext;
 
 // TODO move to different namespace, not dependent on TLS?
@@ -172,6 +197,22 @@ public:
      */
     virtual EncodeResult half_close(char* ciphertext, size_t ciphertext_size) noexcept = 0;
 
+    /*
+     * Exports the traffic keys of the established session, allowing the caller to
+     * perform record protection for either direction by other means. Returns false
+     * if the session can not be exported, in which case encode()/decode() must be
+     * used as usual. Exporting does not alter the state of the codec; a direction
+     * the caller does not take over must still go through encode()/decode().
+     *
+     * Precondition:  handshake must be completed
+     * Precondition:  encode() and decode() have not been called
+     */
+    virtual bool export_traffic_keys(TrafficKeys& to_peer, TrafficKeys& from_peer) noexcept {
+        (void) to_peer;
+        (void) from_peer;
+        return false;
+    }
+
     /*
      * Creates an implementation defined CryptoCodec that provides at least TLSv1.2
      * compliant handshaking and full duplex data transfer.
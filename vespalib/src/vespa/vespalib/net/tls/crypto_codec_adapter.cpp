@@ -1,6 +1,7 @@
 // Copyright 2018 Yahoo Holdings. Licensed under the terms of the Apache 2.0 license. See LICENSE in the project root.
 
 #include "crypto_codec_adapter.h"
+#include "kernel_tls.h"
 #include <assert.h>
 
 namespace vespalib::net::tls {
@@ -56,6 +57,23 @@ CryptoCodecAdapter::flush_all()
     return res;
 }
 
+void
+CryptoCodecAdapter::try_kernel_offload()
+{
+    _offload_checked = true;
+    TrafficKeys to_peer;
+    TrafficKeys from_peer;
+    if (!_codec->export_traffic_keys(to_peer, from_peer) || !ktls_attach(_socket.get())) {
+        return;
+    }
+    _kernel_send = ktls_install_send_keys(_socket.get(), to_peer);
+    // ciphertext already read past the handshake is out of reach for the
+    // kernel; keep decoding in user space in that case.
+    if (_input.obtain().size == 0) {
+        _kernel_receive = ktls_install_receive_keys(_socket.get(), from_peer);
+    }
+}
+
 void
 CryptoCodecAdapter::inject_read_data(const char *buf, size_t len)
 {
@@ -77,7 +95,13 @@ CryptoCodecAdapter::handshake()
         _output.commit(hs_res.bytes_produced);
         switch (hs_res.state) {
         case ::vespalib::net::tls::HandshakeResult::State::Failed: return HandshakeResult::FAIL;
-        case ::vespalib::net::tls::HandshakeResult::State::Done: return hs_try_flush();
+        case ::vespalib::net::tls::HandshakeResult::State::Done: {
+            auto flush_res = hs_try_flush();
+            if ((flush_res == HandshakeResult::DONE) && !_offload_checked) {
+                try_kernel_offload();
+            }
+            return flush_res;
+        }
         case ::vespalib::net::tls::HandshakeResult::State::NeedsWork: return HandshakeResult::NEED_WORK;
         case ::vespalib::net::tls::HandshakeResult::State::NeedsMorePeerData:
             auto flush_res = hs_try_flush();
@@ -102,6 +126,17 @@ CryptoCodecAdapter::do_handshake_work()
 ssize_t
 CryptoCodecAdapter::read(char *buf, size_t len)
 {
+    if (_kernel_receive) {
+        if (_got_tls_close) {
+            return 0;
+        }
+        auto res = ktls_read(_socket.get(), buf, len, _got_tls_close);
+        if ((res == 0) && !_got_tls_close) {
+            res = -1;
+            errno = EIO;
+        }
+        return res;
+    }
     auto drain_res = drain(buf, len);
     if ((drain_res != 0) || _got_tls_close) {
         return drain_res;
@@ -125,6 +160,9 @@ CryptoCodecAdapter::read(char *buf, size_t len)
 ssize_t
 CryptoCodecAdapter::drain(char *buf, size_t len)
 {
+    if (_kernel_receive) {
+        return 0; // nothing is buffered in user space
+    }
     auto src = _input.obtain();
     auto res = _codec->decode(src.data, src.size, buf, len);
     if (res.failed()) {
@@ -141,6 +179,9 @@ CryptoCodecAdapter::drain(char *buf, size_t len)
 ssize_t
 CryptoCodecAdapter::write(const char *buf, size_t len)
 {
+    if (_kernel_send) {
+        return _socket.write(buf, len);
+    }
     if (_output.obtain().size >= _codec->min_encode_buffer_size()) {
         if (flush() < 0) {
             return -1;
@@ -160,6 +201,15 @@ CryptoCodecAdapter::write(const char *buf, size_t len)
     return res.bytes_consumed;
 }
 
+ssize_t
+CryptoCodecAdapter::writev(const struct iovec *iov, int iovcnt)
+{
+    if (_kernel_send) {
+        return _socket.writev(iov, iovcnt);
+    }
+    return CryptoSocket::writev(iov, iovcnt);
+}
+
 ssize_t
 CryptoCodecAdapter::flush()
 {
@@ -184,6 +234,12 @@ CryptoCodecAdapter::half_close()
     if (flush_res < 0) {
         return flush_res;
     }
+    if (!_encoded_tls_close && _kernel_send) {
+        if (ktls_send_close_notify(_socket.get()) < 0) {
+            return -1;
+        }
+        _encoded_tls_close = true;
+    }
     if (!_encoded_tls_close) {
         auto dst = _output.reserve(_codec->min_encode_buffer_size());
         auto res = _codec->half_close(dst.data, dst.size);
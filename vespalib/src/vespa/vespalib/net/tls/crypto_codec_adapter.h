@@ -12,6 +12,10 @@ namespace vespalib::net::tls {
 /**
  * Component adapting an underlying CryptoCodec to the CryptoSocket
  * interface by performing buffer and socket management.
+ *
+ * When the codec exports its traffic keys after the handshake, record
+ * protection is handed over to the kernel (kTLS) where possible, and
+ * data for that direction goes straight to/from the socket.
  **/
 class CryptoCodecAdapter : public TlsCryptoSocket
 {
@@ -22,6 +26,9 @@ private:
     std::unique_ptr<CryptoCodec> _codec;
     bool                         _got_tls_close;
     bool                         _encoded_tls_close;
+    bool                         _offload_checked;
+    bool                         _kernel_send;
+    bool                         _kernel_receive;
 
     bool is_blocked(ssize_t res, int error) const {
         return ((res < 0) && ((error == EWOULDBLOCK) || (error == EAGAIN)));
@@ -30,10 +37,12 @@ private:
     HandshakeResult hs_try_fill();
     ssize_t fill_input(); // -1/0/1 -> error/eof/ok
     ssize_t flush_all();  // -1/0 -> error/ok
+    void try_kernel_offload();
 public:
     CryptoCodecAdapter(SocketHandle socket, std::unique_ptr<CryptoCodec> codec)
         : _input(64 * 1024), _output(64 * 1024), _socket(std::move(socket)), _codec(std::move(codec)),
-          _got_tls_close(false), _encoded_tls_close(false) {}
+          _got_tls_close(false), _encoded_tls_close(false),
+          _offload_checked(false), _kernel_send(false), _kernel_receive(false) {}
     void inject_read_data(const char *buf, size_t len) override;
     int get_fd() const override { return _socket.get(); }
     HandshakeResult handshake() override;
@@ -42,8 +51,12 @@ public:
     ssize_t read(char *buf, size_t len) override;
     ssize_t drain(char *, size_t) override;
     ssize_t write(const char *buf, size_t len) override;
+    ssize_t writev(const struct iovec *iov, int iovcnt) override;
     ssize_t flush() override;
     ssize_t half_close() override;
+    // whether record protection has been handed over to the kernel (kTLS)
+    bool kernel_send() const { return _kernel_send; }
+    bool kernel_receive() const { return _kernel_receive; }
 };
 
 } // namespace vespalib::net::tls
@@ -11,11 +11,18 @@
 #include <vector>
 #include <memory>
 #include <stdexcept>
+#include <string>
+#include <cstring>
 
 #include <openssl/ssl.h>
 #include <openssl/crypto.h>
 #include <openssl/err.h>
 #include <openssl/pem.h>
+#if (OPENSSL_VERSION_NUMBER >= 0x10101000L)
+#  include <openssl/kdf.h>
+#  include <openssl/evp.h>
+#  include <openssl/tls1.h>
+#endif
 
 #include <vespa/log/log.h>
 LOG_SETUP(".vespalib.net.tls.openssl_crypto_codec_impl");
@@ -153,6 +160,63 @@ BioPtr new_tls_frame_const_memory_bio() {
     return bio;
 }
 
+#if (OPENSSL_VERSION_NUMBER >= 0x10101000L)
+
+// HKDF-Expand-Label from RFC 8446 section 7.1, with an empty context.
+bool hkdf_expand_label(const ::EVP_MD* md, const std::vector<unsigned char>& secret,
+                       const char* label, unsigned char* out, size_t out_len) noexcept
+{
+    const std::string full_label = std::string("tls13 ") + label;
+    std::vector<unsigned char> info;
+    info.push_back(static_cast<unsigned char>(out_len >> 8));
+    info.push_back(static_cast<unsigned char>(out_len & 0xff));
+    info.push_back(static_cast<unsigned char>(full_label.size()));
+    info.insert(info.end(), full_label.begin(), full_label.end());
+    info.push_back(0); // context length
+    std::unique_ptr<::EVP_PKEY_CTX, decltype(&::EVP_PKEY_CTX_free)>
+        pctx(::EVP_PKEY_CTX_new_id(EVP_PKEY_HKDF, nullptr), &::EVP_PKEY_CTX_free);
+    size_t derived_len = out_len;
+    return (pctx
+            && (::EVP_PKEY_derive_init(pctx.get()) > 0)
+            && (EVP_PKEY_CTX_hkdf_mode(pctx.get(), EVP_PKEY_HKDEF_MODE_EXPAND_ONLY) > 0)
+            && (EVP_PKEY_CTX_set_hkdf_md(pctx.get(), md) > 0)
+            && (EVP_PKEY_CTX_set1_hkdf_key(pctx.get(), secret.data(), static_cast<int>(secret.size())) > 0)
+            && (EVP_PKEY_CTX_add1_hkdf_info(pctx.get(), info.data(), static_cast<int>(info.size())) > 0)
+            && (::EVP_PKEY_derive(pctx.get(), out, &derived_len) > 0)
+            && (derived_len == out_len));
+}
+
+bool derive_traffic_keys(const ::EVP_MD* md, const std::vector<unsigned char>& secret,
+                         TrafficKeys::Cipher cipher, size_t key_size, TrafficKeys& keys) noexcept
+{
+    keys.cipher = cipher;
+    keys.key_size = key_size;
+    keys.sequence_number = 0; // first record protected by application traffic keys
+    return (hkdf_expand_label(md, secret, "key", keys.key, key_size)
+            && hkdf_expand_label(md, secret, "iv", keys.iv, sizeof(keys.iv)));
+}
+
+bool decode_hex(const char* hex, std::vector<unsigned char>& out) {
+    auto nibble = [](char c) -> int {
+        if ((c >= '0') && (c <= '9')) return (c - '0');
+        if ((c >= 'a') && (c <= 'f')) return (c - 'a' + 10);
+        if ((c >= 'A') && (c <= 'F')) return (c - 'A' + 10);
+        return -1;
+    };
+    out.clear();
+    for (; (hex[0] != '\0') && (hex[1] != '\0'); hex += 2) {
+        int hi = nibble(hex[0]);
+        int lo = nibble(hex[1]);
+        if ((hi < 0) || (lo < 0)) {
+            return false;
+        }
+        out.push_back(static_cast<unsigned char>((hi << 4) | lo));
+    }
+    return (hex[0] == '\0');
+}
+
+#endif
+
 vespalib::string ssl_error_from_stack() {
     char buf[256];
     ERR_error_string_n(ERR_get_error(), buf, sizeof(buf));
@@ -209,6 +273,16 @@ OpenSslCryptoCodecImpl::OpenSslCryptoCodecImpl(std::shared_ptr<OpenSslTlsContext
 #endif
     _input_bio  = tmp_input_bio.release();
     _output_bio = tmp_output_bio.release();
+    if (_ctx->transport_security_options().kernel_tls_offload()) {
+        // Lets the context's key logging callback find its way back to us
+        SSL_set_app_data(_ssl.get(), this);
+#if (OPENSSL_VERSION_NUMBER >= 0x10101000L)
+        // TLSv1.3 still sends (stateful) tickets with SSL_OP_NO_TICKET set. A ticket
+        // sent after the handshake would be protected with the application traffic
+        // keys in user space, and put the kernel's record sequence numbers out of step.
+        SSL_set_num_tickets(_ssl.get(), 0);
+#endif
+    }
     if (_mode == Mode::Client) {
         ::SSL_set_connect_state(_ssl.get());
     } else {
@@ -216,7 +290,9 @@ OpenSslCryptoCodecImpl::OpenSslCryptoCodecImpl(std::shared_ptr<OpenSslTlsContext
     }
 }
 
-OpenSslCryptoCodecImpl::~OpenSslCryptoCodecImpl() = default;
+OpenSslCryptoCodecImpl::~OpenSslCryptoCodecImpl() {
+    forget_traffic_secrets();
+}
 
 HandshakeResult OpenSslCryptoCodecImpl::handshake(const char* from_peer, size_t from_peer_buf_size,
                                                   char* to_peer, size_t to_peer_buf_size) noexcept
@@ -411,6 +487,83 @@ EncodeResult OpenSslCryptoCodecImpl::half_close(char* ciphertext, size_t ciphert
     return encoded_bytes(0, static_cast<size_t>(pending_after - pending_before));
 }
 
+void OpenSslCryptoCodecImpl::capture_traffic_secret(const char* keylog_line) noexcept {
+    // Line format: <label> <client random hex> <secret hex>
+    std::vector<unsigned char>* target = nullptr;
+    const char client_label[] = "CLIENT_TRAFFIC_SECRET_0 ";
+    const char server_label[] = "SERVER_TRAFFIC_SECRET_0 ";
+    if (strncmp(keylog_line, client_label, sizeof(client_label) - 1) == 0) {
+        target = &_client_traffic_secret;
+    } else if (strncmp(keylog_line, server_label, sizeof(server_label) - 1) == 0) {
+        target = &_server_traffic_secret;
+    } else {
+        return; // handshake secrets are of no interest
+    }
+#if (OPENSSL_VERSION_NUMBER >= 0x10101000L)
+    const char* secret_hex = strrchr(keylog_line, ' ');
+    if ((secret_hex == nullptr) || !decode_hex(secret_hex + 1, *target)) {
+        secure_memzero(target->data(), target->size());
+        target->clear();
+    }
+#endif
+}
+
+void OpenSslCryptoCodecImpl::forget_traffic_secrets() noexcept {
+    secure_memzero(_client_traffic_secret.data(), _client_traffic_secret.size());
+    secure_memzero(_server_traffic_secret.data(), _server_traffic_secret.size());
+    _client_traffic_secret.clear();
+    _server_traffic_secret.clear();
+}
+
+bool OpenSslCryptoCodecImpl::export_traffic_keys(TrafficKeys& to_peer, TrafficKeys& from_peer) noexcept {
+#if (OPENSSL_VERSION_NUMBER >= 0x10101000L)
+    // Only TLSv1.3 is supported, as its traffic keys are derived from the logged
+    // secrets alone and no records have been protected with them when the handshake
+    // completes (we send no session tickets and nothing has been encoded/decoded yet).
+    bool ok = (SSL_is_init_finished(_ssl.get())
+               && (::SSL_version(_ssl.get()) == TLS1_3_VERSION)
+               && !::SSL_has_pending(_ssl.get())
+               && !_client_traffic_secret.empty()
+               && !_server_traffic_secret.empty());
+    const ::SSL_CIPHER* cipher = ok ? ::SSL_get_current_cipher(_ssl.get()) : nullptr;
+    const ::EVP_MD* md = (cipher != nullptr) ? ::SSL_CIPHER_get_handshake_digest(cipher) : nullptr;
+    ok = (md != nullptr);
+    TrafficKeys::Cipher traffic_cipher = TrafficKeys::Cipher::Aes128Gcm;
+    size_t key_size = 0;
+    if (ok) {
+        switch (::SSL_CIPHER_get_id(cipher)) {
+        case TLS1_3_CK_AES_128_GCM_SHA256:
+            traffic_cipher = TrafficKeys::Cipher::Aes128Gcm;
+            key_size = 16;
+            break;
+        case TLS1_3_CK_AES_256_GCM_SHA384:
+            traffic_cipher = TrafficKeys::Cipher::Aes256Gcm;
+            key_size = 32;
+            break;
+        case TLS1_3_CK_CHACHA20_POLY1305_SHA256:
+            traffic_cipher = TrafficKeys::Cipher::ChaCha20Poly1305;
+            key_size = 32;
+            break;
+        default:
+            ok = false;
+        }
+    }
+    if (ok) {
+        const bool is_client = (_mode == Mode::Client);
+        const auto& own_secret  = is_client ? _client_traffic_secret : _server_traffic_secret;
+        const auto& peer_secret = is_client ? _server_traffic_secret : _client_traffic_secret;
+        ok = (derive_traffic_keys(md, own_secret, traffic_cipher, key_size, to_peer)
+              && derive_traffic_keys(md, peer_secret, traffic_cipher, key_size, from_peer));
+    }
+    forget_traffic_secrets();
+    return ok;
+#else
+    (void) to_peer;
+    (void) from_peer;
+    return false;
+#endif
+}
+
 }
 
 // External references:
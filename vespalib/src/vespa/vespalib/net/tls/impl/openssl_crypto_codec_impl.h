@@ -6,6 +6,7 @@
 #include <vespa/vespalib/net/tls/crypto_codec.h>
 #include <memory>
 #include <optional>
+#include <vector>
 
 namespace vespalib::net::tls { struct TlsContext; }
 
@@ -51,6 +52,9 @@ class OpenSslCryptoCodecImpl : public CryptoCodec {
     Mode _mode;
     std::optional<DeferredHandshakeParams> _deferred_handshake_params;
     std::optional<HandshakeResult> _deferred_handshake_result;
+    // TLSv1.3 application traffic secrets, only captured when kernel TLS offload is enabled
+    std::vector<unsigned char> _client_traffic_secret;
+    std::vector<unsigned char> _server_traffic_secret;
 public:
     OpenSslCryptoCodecImpl(std::shared_ptr<OpenSslTlsContextImpl> ctx, Mode mode);
     ~OpenSslCryptoCodecImpl() override;
@@ -85,7 +89,13 @@ public:
     DecodeResult decode(const char* ciphertext, size_t ciphertext_size,
                         char* plaintext, size_t plaintext_size) noexcept override;
     EncodeResult half_close(char* ciphertext, size_t ciphertext_size) noexcept override;
+    bool export_traffic_keys(TrafficKeys& to_peer, TrafficKeys& from_peer) noexcept override;
+
+    // Invoked by the context's key logging callback with an NSS key log format line
+    // for the SSL instance owned by this codec.
+    void capture_traffic_secret(const char* keylog_line) noexcept;
 private:
+    void forget_traffic_secrets() noexcept;
     HandshakeResult do_handshake_and_consume_peer_input_bytes() noexcept;
     DecodeResult drain_and_produce_plaintext_from_ssl(char* plaintext, size_t plaintext_size) noexcept;
     // Precondition: read_result < 0
@@ -2,6 +2,7 @@
 #include "iana_cipher_map.h"
 #include "openssl_typedefs.h"
 #include "openssl_tls_context_impl.h"
+#include "openssl_crypto_codec_impl.h"
 #include <vespa/vespalib/net/tls/crypto_exception.h>
 #include <vespa/vespalib/net/tls/statistics.h>
 #include <vespa/vespalib/net/tls/transport_security_options.h>
@@ -219,6 +220,9 @@ OpenSslTlsContextImpl::OpenSslTlsContextImpl(
     } else {
         set_accepted_cipher_suites(modern_iana_cipher_suites());
     }
+    if (ts_opts.kernel_tls_offload()) {
+        enable_traffic_secret_capture();
+    }
 }
 
 OpenSslTlsContextImpl::~OpenSslTlsContextImpl() {
@@ -508,4 +512,20 @@ void OpenSslTlsContextImpl::set_accepted_cipher_suites(const std::vector<vespali
     }
 }
 
+void OpenSslTlsContextImpl::keylog_cb_wrapper(const ::SSL* ssl, const char* line) {
+    // Only codecs that want their secrets captured register themselves as app data.
+    auto* codec = static_cast<OpenSslCryptoCodecImpl*>(SSL_get_app_data(ssl));
+    if (codec) {
+        codec->capture_traffic_secret(line);
+    }
+}
+
+void OpenSslTlsContextImpl::enable_traffic_secret_capture() {
+#if (OPENSSL_VERSION_NUMBER >= 0x10101000L)
+    SSL_CTX_set_keylog_callback(_ctx.get(), keylog_cb_wrapper);
+#else
+    LOG(warning, "Kernel TLS offload requires OpenSSL 1.1.1 or newer; using user space TLS only");
+#endif
+}
+
 }
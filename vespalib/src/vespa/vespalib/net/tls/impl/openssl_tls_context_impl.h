@@ -45,10 +45,14 @@ private:
     void enforce_peer_certificate_verification();
     void set_ssl_ctx_self_reference();
     void set_accepted_cipher_suites(const std::vector<vespalib::string>& ciphers);
+    // Capture TLSv1.3 traffic secrets per codec so that established sessions
+    // can be handed over to kernel TLS.
+    void enable_traffic_secret_capture();
 
     bool verify_trusted_certificate(::X509_STORE_CTX* store_ctx);
 
     static int verify_cb_wrapper(int preverified_ok, ::X509_STORE_CTX* store_ctx);
+    static void keylog_cb_wrapper(const ::SSL* ssl, const char* line);
 };
 
 }
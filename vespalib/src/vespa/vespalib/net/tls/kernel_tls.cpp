@@ -0,0 +1,186 @@
+// Copyright 2019 Oath Inc. Licensed under the terms of the Apache 2.0 license. See LICENSE in the project root.
+
+#include "kernel_tls.h"
+#include "crypto_codec.h"
+#include "transport_security_options.h"
+#include <cerrno>
+#include <cstring>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+
+#if defined(__linux__) && __has_include(<linux/tls.h>)
+#include <linux/tls.h>
+#if defined(TLS_1_3_VERSION) && defined(TLS_GET_RECORD_TYPE)
+#define VESPA_HAVE_KTLS 1
+#endif
+#endif
+
+#include <vespa/log/log.h>
+LOG_SETUP(".vespalib.net.tls.kernel_tls");
+
+#ifdef VESPA_HAVE_KTLS
+
+#ifndef SOL_TLS
+#define SOL_TLS 282
+#endif
+#ifndef TCP_ULP
+#define TCP_ULP 31
+#endif
+
+namespace vespalib::net::tls {
+
+namespace {
+
+constexpr uint8_t record_type_alert = 21;
+constexpr uint8_t record_type_handshake = 22;
+constexpr uint8_t record_type_application_data = 23;
+constexpr uint8_t alert_level_warning = 1;
+constexpr uint8_t alert_close_notify = 0;
+constexpr uint8_t handshake_new_session_ticket = 4;
+
+void encode_sequence_number(uint64_t seq, unsigned char* dst) noexcept {
+    for (int i = 7; i >= 0; --i) {
+        dst[i] = static_cast<unsigned char>(seq & 0xff);
+        seq >>= 8;
+    }
+}
+
+// TLSv1.3 uses the first 4 bytes of the static IV as the kernel's 'salt'
+// and the remaining 8 bytes as its 'iv', except for ChaCha20-Poly1305
+// where the whole IV is passed as-is.
+template <typename CryptoInfo>
+bool install_aead_keys(int fd, int direction, const TrafficKeys& keys, uint16_t cipher_type) noexcept {
+    CryptoInfo info;
+    memset(&info, 0, sizeof(info));
+    if (keys.key_size != sizeof(info.key)) {
+        return false;
+    }
+    info.info.version = TLS_1_3_VERSION;
+    info.info.cipher_type = cipher_type;
+    static_assert(sizeof(info.salt) + sizeof(info.iv) == sizeof(keys.iv));
+    memcpy(info.salt, keys.iv, sizeof(info.salt));
+    memcpy(info.iv, keys.iv + sizeof(info.salt), sizeof(info.iv));
+    memcpy(info.key, keys.key, sizeof(info.key));
+    encode_sequence_number(keys.sequence_number, info.rec_seq);
+    int res = ::setsockopt(fd, SOL_TLS, direction, &info, sizeof(info));
+    int error = errno;
+    secure_memzero(&info, sizeof(info));
+    if (res != 0) {
+        LOG(debug, "Failed to install kernel TLS %s keys: %s",
+            (direction == TLS_TX) ? "send" : "receive", strerror(error));
+        return false;
+    }
+    return true;
+}
+
+bool install_keys(int fd, int direction, const TrafficKeys& keys) noexcept {
+    switch (keys.cipher) {
+    case TrafficKeys::Cipher::Aes128Gcm:
+        return install_aead_keys<tls12_crypto_info_aes_gcm_128>(fd, direction, keys, TLS_CIPHER_AES_GCM_128);
+    case TrafficKeys::Cipher::Aes256Gcm:
+        return install_aead_keys<tls12_crypto_info_aes_gcm_256>(fd, direction, keys, TLS_CIPHER_AES_GCM_256);
+    case TrafficKeys::Cipher::ChaCha20Poly1305:
+#ifdef TLS_CIPHER_CHACHA20_POLY1305
+        return install_aead_keys<tls12_crypto_info_chacha20_poly1305>(fd, direction, keys, TLS_CIPHER_CHACHA20_POLY1305);
+#else
+        return false;
+#endif
+    }
+    return false;
+}
+
+ssize_t send_record(int fd, uint8_t record_type, const void* data, size_t len) noexcept {
+    char cmsg_buf[CMSG_SPACE(sizeof(record_type))];
+    struct iovec iov;
+    iov.iov_base = const_cast<void*>(data);
+    iov.iov_len = len;
+    struct msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = cmsg_buf;
+    msg.msg_controllen = sizeof(cmsg_buf);
+    struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+    cmsg->cmsg_level = SOL_TLS;
+    cmsg->cmsg_type = TLS_SET_RECORD_TYPE;
+    cmsg->cmsg_len = CMSG_LEN(sizeof(record_type));
+    memcpy(CMSG_DATA(cmsg), &record_type, sizeof(record_type));
+    return ::sendmsg(fd, &msg, MSG_NOSIGNAL);
+}
+
+} // anon ns
+
+bool ktls_attach(int fd) noexcept {
+    if (::setsockopt(fd, SOL_TCP, TCP_ULP, "tls", sizeof("tls")) != 0) {
+        LOG(debug, "Kernel TLS not available: %s", strerror(errno));
+        return false;
+    }
+    return true;
+}
+
+bool ktls_install_send_keys(int fd, const TrafficKeys& keys) noexcept {
+    return install_keys(fd, TLS_TX, keys);
+}
+
+bool ktls_install_receive_keys(int fd, const TrafficKeys& keys) noexcept {
+    return install_keys(fd, TLS_RX, keys);
+}
+
+ssize_t ktls_read(int fd, char* buf, size_t len, bool& got_close) noexcept {
+    for (;;) {
+        char cmsg_buf[CMSG_SPACE(sizeof(uint8_t))];
+        struct iovec iov;
+        iov.iov_base = buf;
+        iov.iov_len = len;
+        struct msghdr msg;
+        memset(&msg, 0, sizeof(msg));
+        msg.msg_iov = &iov;
+        msg.msg_iovlen = 1;
+        msg.msg_control = cmsg_buf;
+        msg.msg_controllen = sizeof(cmsg_buf);
+        ssize_t res = ::recvmsg(fd, &msg, 0);
+        if (res <= 0) {
+            return res;
+        }
+        struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+        if ((cmsg == nullptr) || (cmsg->cmsg_level != SOL_TLS) || (cmsg->cmsg_type != TLS_GET_RECORD_TYPE)) {
+            return res;
+        }
+        uint8_t record_type = *CMSG_DATA(cmsg);
+        if (record_type == record_type_application_data) {
+            return res;
+        }
+        if ((record_type == record_type_alert) && (res >= 2) && (static_cast<uint8_t>(buf[1]) == alert_close_notify)) {
+            got_close = true;
+            return 0;
+        }
+        if ((record_type == record_type_handshake) && (static_cast<uint8_t>(buf[0]) == handshake_new_session_ticket)) {
+            continue; // we never resume sessions
+        }
+        LOG(debug, "Unexpected TLS record of type %u received with kernel TLS", record_type);
+        errno = EIO;
+        return -1;
+    }
+}
+
+ssize_t ktls_send_close_notify(int fd) noexcept {
+    const uint8_t alert[2] = { alert_level_warning, alert_close_notify };
+    return send_record(fd, record_type_alert, alert, sizeof(alert));
+}
+
+}
+
+#else // VESPA_HAVE_KTLS
+
+namespace vespalib::net::tls {
+
+bool ktls_attach(int) noexcept { return false; }
+bool ktls_install_send_keys(int, const TrafficKeys&) noexcept { return false; }
+bool ktls_install_receive_keys(int, const TrafficKeys&) noexcept { return false; }
+ssize_t ktls_read(int, char*, size_t, bool&) noexcept { errno = EIO; return -1; }
+ssize_t ktls_send_close_notify(int) noexcept { errno = EIO; return -1; }
+
+}
+
+#endif // VESPA_HAVE_KTLS
@@ -0,0 +1,39 @@
+// Copyright 2019 Oath Inc. Licensed under the terms of the Apache 2.0 license. See LICENSE in the project root.
+
+#pragma once
+
+#include <sys/types.h>
+
+namespace vespalib::net::tls {
+
+struct TrafficKeys;
+
+/*
+ * Helpers for handing the TLSv1.3 record layer of an established
+ * session over to the Linux kernel (kTLS). Once keys are installed
+ * for a direction, plain socket reads/writes carry application data
+ * for that direction and the kernel does the encryption/decryption.
+ *
+ * All functions fail cleanly (returning false/-1) when the kernel or
+ * the build environment lacks kTLS support.
+ */
+
+// Attach the TLS upper layer protocol to a connected TCP socket.
+// Must succeed before any keys can be installed.
+bool ktls_attach(int fd) noexcept;
+
+// Install keys for records sent (to_peer) or received (from_peer)
+// on a socket that has the TLS upper layer protocol attached.
+bool ktls_install_send_keys(int fd, const TrafficKeys& keys) noexcept;
+bool ktls_install_receive_keys(int fd, const TrafficKeys& keys) noexcept;
+
+// Read application data from a socket with receive keys installed.
+// Post-handshake messages that can be ignored are skipped. Returns 0
+// and sets got_close if the peer sent a close_notify alert, -1 with
+// errno set to EIO on any other alert or unexpected record.
+ssize_t ktls_read(int fd, char* buf, size_t len, bool& got_close) noexcept;
+
+// Send a close_notify alert on a socket with send keys installed.
+ssize_t ktls_send_close_notify(int fd) noexcept;
+
+}
@@ -11,7 +11,8 @@ TransportSecurityOptions::TransportSecurityOptions(Params params)
       _cert_chain_pem(std::move(params._cert_chain_pem)),
       _private_key_pem(std::move(params._private_key_pem)),
       _authorized_peers(std::move(params._authorized_peers)),
-      _accepted_ciphers(std::move(params._accepted_ciphers))
+      _accepted_ciphers(std::move(params._accepted_ciphers)),
+      _kernel_tls_offload(params._kernel_tls_offload)
 {
 }
 
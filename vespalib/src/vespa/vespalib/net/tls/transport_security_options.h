@@ -14,6 +14,7 @@ class TransportSecurityOptions {
     vespalib::string _private_key_pem;
     AuthorizedPeers  _authorized_peers;
     std::vector<vespalib::string> _accepted_ciphers;
+    bool             _kernel_tls_offload = false;
 public:
     TransportSecurityOptions() = default;
 
@@ -23,6 +24,7 @@ public:
         vespalib::string _private_key_pem;
         AuthorizedPeers  _authorized_peers;
         std::vector<vespalib::string> _accepted_ciphers;
+        bool             _kernel_tls_offload = false;
 
         Params();
         ~Params();
@@ -35,6 +37,7 @@ public:
             _accepted_ciphers = std::move(ciphers);
             return *this;
         }
+        Params& kernel_tls_offload(bool enable) { _kernel_tls_offload = enable; return *this; }
     };
 
     explicit TransportSecurityOptions(Params params);
@@ -56,9 +59,14 @@ public:
     const AuthorizedPeers& authorized_peers() const noexcept { return _authorized_peers; }
 
     TransportSecurityOptions copy_without_private_key() const {
-        return TransportSecurityOptions(_ca_certs_pem, _cert_chain_pem, "", _authorized_peers);
+        TransportSecurityOptions copy(_ca_certs_pem, _cert_chain_pem, "", _authorized_peers);
+        copy._kernel_tls_offload = _kernel_tls_offload;
+        return copy;
     }
     const std::vector<vespalib::string>& accepted_ciphers() const noexcept { return _accepted_ciphers; }
+    // Whether the record layer of established TLSv1.3 sessions should be handed
+    // over to the kernel (kTLS) when supported. Falls back to user space otherwise.
+    bool kernel_tls_offload() const noexcept { return _kernel_tls_offload; }
 };
 
 // Zeroes out `size` bytes in `buf` in a way that shall never be optimized
@@ -26,7 +26,8 @@ namespace vespalib::net::tls {
       ],
       "name": "funky config servers"
     }
-  ]
+  ],
+  "kernel-tls-offload": true
 }
 
  */
@@ -123,6 +124,7 @@ std::unique_ptr<TransportSecurityOptions> load_from_input(Input& input) {
     auto priv_key = load_file_referenced_by_field(files, "private-key");
     auto authorized_peers = parse_authorized_peers(root["authorized-peers"]);
     auto accepted_ciphers = parse_accepted_ciphers(root["accepted-ciphers"]);
+    bool kernel_tls_offload = root["kernel-tls-offload"].asBool();
 
     auto options = std::make_unique<TransportSecurityOptions>(
             TransportSecurityOptions::Params()
@@ -130,7 +132,8 @@ std::unique_ptr<TransportSecurityOptions> load_from_input(Input& input) {
                 .cert_chain_pem(certs)
                 .private_key_pem(priv_key)
                 .authorized_peers(std::move(authorized_peers))
-                .accepted_ciphers(std::move(accepted_ciphers)));
+                .accepted_ciphers(std::move(accepted_ciphers))
+                .kernel_tls_offload(kernel_tls_offload));
     secure_memzero(&priv_key[0], priv_key.size());
     return options;
 }